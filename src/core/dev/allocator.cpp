@@ -40,6 +40,7 @@
 #include "ib_ctx_handler_collection.h"
 #include "util/hugepage_mgr.h"
 #include "util/vtypes.h"
+#include "util/instrumentation.h"
 #include "xlio.h"
 
 #define MODULE_NAME "allocator"
@@ -415,7 +416,7 @@ static lock_mutex s_heap_lock;
 static size_t s_pagesize;
 
 /*static*/
-xlio_heap *xlio_heap::get(alloc_t alloc_func, free_t free_func, bool hw)
+xlio_heap *xlio_heap::get(alloc_t alloc_func, free_t free_func, bool hw, bool async /*=false*/)
 {
     std::lock_guard<decltype(s_heap_lock)> lock(s_heap_lock);
 
@@ -429,12 +430,18 @@ xlio_heap *xlio_heap::get(alloc_t alloc_func, free_t free_func, bool hw)
     xlio_heap *heap = (item == s_heap_map.end()) ? nullptr : item->second;
 
     if (!heap) {
-        heap = new xlio_heap(alloc_func, free_func, hw);
+        heap = new xlio_heap(alloc_func, free_func, hw, async);
         s_heap_map[key] = heap;
     }
     return heap;
 }
 
+/*static*/
+void xlio_heap::prefetch(alloc_t alloc_func, free_t free_func)
+{
+    get(alloc_func, free_func, true, true);
+}
+
 /*static*/
 void xlio_heap::initialize()
 {
@@ -455,23 +462,55 @@ void xlio_heap::finalize()
     s_heap_map.clear();
 }
 
-xlio_heap::xlio_heap(alloc_t alloc_func, free_t free_func, bool hw)
-    : m_latest_offset(0)
+xlio_heap::xlio_heap(alloc_t alloc_func, free_t free_func, bool hw, bool async)
+    : m_b_init_pending(false)
+    , m_b_init_failed(false)
+    , m_latest_offset(0)
+    , m_registered_size(0)
     , m_b_hw(hw)
+    , m_b_elastic(hw && safe_mce_sys().memory_block)
     , m_p_alloc_func(alloc_func)
     , m_p_free_func(free_func)
 {
-    if (!expand()) {
+    // In elastic mode, HW memory is allocated by blocks on demand.
+    if (m_b_elastic) {
+        return;
+    }
+    if (async && m_b_hw) {
+        // Registration pins and pre-faults the whole memory which takes time for large limits.
+        m_b_init_pending = true;
+        m_init_thread = std::thread([this]() {
+            startup_phase phase("heap registration");
+            try {
+                m_b_init_failed = !expand();
+            } catch (...) {
+                m_b_init_failed = true;
+            }
+        });
+    } else if (!expand()) {
         throw_xlio_exception("Couldn't allocate or register memory for XLIO heap.");
     }
 }
 
 xlio_heap::~xlio_heap()
 {
+    if (m_init_thread.joinable()) {
+        m_init_thread.join();
+    }
     for (auto &block : m_blocks) {
         delete block;
     }
     m_blocks.clear();
+    for (auto &block : m_elastic_blocks) {
+        delete block;
+    }
+    m_elastic_blocks.clear();
+}
+
+size_t xlio_heap::get_memory_limit() const
+{
+    return (m_p_alloc_func && safe_mce_sys().memory_limit_user) ? safe_mce_sys().memory_limit_user
+                                                                : safe_mce_sys().memory_limit;
 }
 
 bool xlio_heap::expand(size_t size /*=0*/)
@@ -480,9 +519,7 @@ bool xlio_heap::expand(size_t size /*=0*/)
     xlio_allocator_hw *block;
 
     if (!size && m_b_hw) {
-        size = (m_p_alloc_func && safe_mce_sys().memory_limit_user)
-            ? safe_mce_sys().memory_limit_user
-            : safe_mce_sys().memory_limit;
+        size = get_memory_limit();
     }
     size = size ?: safe_mce_sys().heap_metadata_block;
 
@@ -504,6 +541,9 @@ bool xlio_heap::expand(size_t size /*=0*/)
 
     m_blocks.push_back(block);
     m_latest_offset = 0;
+    if (m_b_hw) {
+        m_registered_size += block->size();
+    }
 
     if (m_b_hw && g_user_memory_cb) {
         g_user_memory_cb(data, size, block->page_size());
@@ -518,15 +558,34 @@ error:
     return false;
 }
 
+void xlio_heap::wait_ready()
+{
+    if (unlikely(m_b_init_pending)) {
+        std::lock_guard<decltype(m_init_lock)> lock(m_init_lock);
+
+        if (m_init_thread.joinable()) {
+            m_init_thread.join();
+            m_b_init_pending = false;
+            if (m_b_init_failed) {
+                // Report the failure once, further requests fail on the empty heap.
+                throw_xlio_exception("Couldn't allocate or register memory for XLIO heap.");
+            }
+        }
+    }
+}
+
 void *xlio_heap::alloc(size_t &size)
 {
+    wait_ready();
     std::lock_guard<decltype(m_lock)> lock(m_lock);
 
     size_t actual_size = (size + s_pagesize - 1) & ~(s_pagesize - 1U);
     void *data = nullptr;
 
 repeat:
-    if (actual_size + m_latest_offset <= m_blocks.back()->size()) {
+    if (m_blocks.empty()) {
+        // Elastic HW heap serves memory only by blocks.
+    } else if (actual_size + m_latest_offset <= m_blocks.back()->size()) {
         data = (void *)((uintptr_t)m_blocks.back()->data() + m_latest_offset);
         m_latest_offset += actual_size;
     } else if (!m_b_hw) {
@@ -541,15 +600,71 @@ repeat:
     return data;
 }
 
+xlio_allocator_hw *xlio_heap::alloc_block(size_t size)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    xlio_allocator_hw *block;
+
+    if (!m_b_elastic || m_registered_size + size > get_memory_limit()) {
+        return nullptr;
+    }
+
+    block = new xlio_allocator_hw(m_p_alloc_func, m_p_free_func);
+    if (!block->alloc(size) || !block->register_memory(nullptr)) {
+        delete block;
+        return nullptr;
+    }
+
+    m_elastic_blocks.insert(block);
+    m_registered_size += block->size();
+    __log_info_dbg("Allocated block %p size=%zu registered=%zu", block->data(), block->size(),
+                   m_registered_size);
+
+    if (g_user_memory_cb) {
+        g_user_memory_cb(block->data(), block->size(), block->page_size());
+    }
+    return block;
+}
+
+void xlio_heap::free_block(xlio_allocator_hw *block)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    if (m_elastic_blocks.erase(block)) {
+        m_registered_size -= block->size();
+        __log_info_dbg("Freeing block %p size=%zu registered=%zu", block->data(), block->size(),
+                       m_registered_size);
+        // Destructor deregisters and frees the memory.
+        delete block;
+    }
+}
+
 bool xlio_heap::register_memory(ib_ctx_handler *p_ib_ctx_h)
 {
+    wait_ready();
     std::lock_guard<decltype(m_lock)> lock(m_lock);
+    bool ret;
+
+    if (!m_b_hw) {
+        return false;
+    }
+    if (!m_b_elastic) {
+        return m_blocks.size() ? m_blocks.back()->register_memory(p_ib_ctx_h) : false;
+    }
 
-    return m_b_hw && m_blocks.size() ? m_blocks.back()->register_memory(p_ib_ctx_h) : false;
+    ret = true;
+    for (auto &block : m_elastic_blocks) {
+        // Pools share the heap, so the block can be already registered on the device.
+        if (block->find_lkey_by_ib_ctx(p_ib_ctx_h) == LKEY_ERROR) {
+            ret = block->register_memory(p_ib_ctx_h) && ret;
+        }
+    }
+    return ret;
 }
 
-uint32_t xlio_heap::find_lkey_by_ib_ctx(ib_ctx_handler *p_ib_ctx_h) const
+uint32_t xlio_heap::find_lkey_by_ib_ctx(ib_ctx_handler *p_ib_ctx_h)
 {
+    wait_ready();
     // Current implementation doesn't support runtime registrations, lock is not necessary.
     return m_b_hw && m_blocks.size() ? m_blocks.back()->find_lkey_by_ib_ctx(p_ib_ctx_h)
                                      : LKEY_ERROR;
@@ -36,8 +36,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "utils/lock_wrapper.h"
 #include "util/sys_vars.h" // alloc_mode_t, alloc_t, free_t
@@ -111,26 +115,46 @@ public:
 
 class xlio_heap {
 public:
-    static xlio_heap *get(alloc_t alloc_func, free_t free_func, bool hw);
+    static xlio_heap *get(alloc_t alloc_func, free_t free_func, bool hw, bool async = false);
     static void initialize();
     static void finalize();
+    // Start allocation and registration of the HW heap memory in background.
+    static void prefetch(alloc_t alloc_func, free_t free_func);
 
     void *alloc(size_t &size);
     bool register_memory(ib_ctx_handler *p_ib_ctx_h);
-    uint32_t find_lkey_by_ib_ctx(ib_ctx_handler *p_ib_ctx_h) const;
+    uint32_t find_lkey_by_ib_ctx(ib_ctx_handler *p_ib_ctx_h);
 
     bool is_hw() const { return m_b_hw; }
+    bool is_elastic() const { return m_b_elastic; }
+
+    /*
+     * Elastic mode: allocate a separately registered block which the caller owns and can
+     * return to the system with free_block(). Total size is capped by the memory limit.
+     */
+    xlio_allocator_hw *alloc_block(size_t size);
+    void free_block(xlio_allocator_hw *block);
+    size_t get_registered_size() const { return m_registered_size; }
 
 private:
-    xlio_heap(alloc_t alloc_func, free_t free_func, bool hw);
+    xlio_heap(alloc_t alloc_func, free_t free_func, bool hw, bool async);
     ~xlio_heap();
     bool expand(size_t size = 0);
+    size_t get_memory_limit() const;
+    void wait_ready();
 
     lock_mutex m_lock;
+    std::thread m_init_thread;
+    std::mutex m_init_lock;
+    std::atomic<bool> m_b_init_pending;
+    bool m_b_init_failed;
     std::vector<xlio_allocator_hw *> m_blocks;
+    std::unordered_set<xlio_allocator_hw *> m_elastic_blocks;
     unsigned long m_latest_offset;
+    size_t m_registered_size;
 
     bool m_b_hw;
+    bool m_b_elastic;
     alloc_t m_p_alloc_func;
     free_t m_p_free_func;
 };
@@ -146,6 +170,8 @@ public:
     bool register_memory(ib_ctx_handler *p_ib_ctx_h);
     uint32_t find_lkey_by_ib_ctx(ib_ctx_handler *p_ib_ctx_h) const;
 
+    xlio_heap *get_heap() const { return m_p_heap; }
+
 private:
     xlio_heap *m_p_heap;
     /* Currently we don't support free, so no need to track allocated blocks */
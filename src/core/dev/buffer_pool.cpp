@@ -33,15 +33,20 @@
 #include <mutex>
 #include "buffer_pool.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "utils/bullseye.h"
 #include "vlogger/vlogger.h"
 #include "util/sys_vars.h"
 #include "proto/mem_buf_desc.h"
+#include "event/event_handler_manager.h"
+#include "ring_slave.h"
 
 #define MODULE_NAME "bpool"
 
+#define BUFFER_POOL_RECLAIM_INTERVAL_MSEC 1000
+
 // A pointer to differentiate between g_buffer_pool_rx_stride and g_buffer_pool_rx_rwqe
 // and create an abstraction to the layers above device layer for cases when Striding RQ is on/off.
 // When Striding RQ is on, it points to g_buffer_pool_rx_stride since the upper layers work with
@@ -86,6 +91,9 @@ inline void buffer_pool::put_buffer_helper(mem_buf_desc_t *buff)
            g_buffer_pool_zc == NULL);
     free_lwip_pbuf(&buff->lwip_pbuf);
     m_p_head = buff;
+    if (buff->p_block) {
+        buff->p_block->n_free++;
+    }
     m_n_buffers++;
     m_p_bpool_stat->n_buffer_pool_size++;
 }
@@ -100,6 +108,10 @@ bool buffer_pool::expand(size_t count)
     __log_info_dbg("Expanding %s%s pool", m_buf_size ? "" : "zcopy ",
                    m_p_bpool_stat->is_rx ? "Rx" : "Tx");
 
+    if (m_b_elastic) {
+        return expand_block(count);
+    }
+
     if (size && m_buf_size) {
         data_ptr = (uint8_t *)m_allocator_data.alloc(size);
         if (!data_ptr) {
@@ -132,6 +144,120 @@ bool buffer_pool::expand(size_t count)
     return true;
 }
 
+bool buffer_pool::expand_block(size_t count)
+{
+    xlio_heap *heap = m_allocator_data.get_heap();
+    size_t block_size = safe_mce_sys().memory_block;
+    size_t size = m_buf_size * count;
+    xlio_allocator_hw *data;
+    bpool_block *block;
+    uint8_t *data_ptr;
+    uint8_t *desc_ptr;
+
+    // Round up to the block size, a large request gets a bigger block.
+    size = (size + block_size - 1) / block_size * block_size;
+    data = heap->alloc_block(size);
+    if (!data) {
+        return false;
+    }
+
+    block = new bpool_block(data);
+    // Allocator can allocate more than requested.
+    count = data->size() / m_buf_size;
+    desc_ptr = (uint8_t *)block->metadata.alloc(count * sizeof(mem_buf_desc_t));
+    if (!desc_ptr) {
+        heap->free_block(data);
+        delete block;
+        return false;
+    }
+
+    data_ptr = (uint8_t *)data->data();
+    for (size_t i = 0; i < count; ++i) {
+        mem_buf_desc_t *desc = new (desc_ptr) mem_buf_desc_t(data_ptr, m_buf_size, PBUF_RAM);
+        desc->p_block = block;
+        put_buffer_helper(desc);
+        desc_ptr += sizeof(mem_buf_desc_t);
+        data_ptr += m_buf_size;
+    }
+    block->n_buffers = count;
+    m_blocks.push_back(block);
+    m_n_buffers_created += count;
+    m_p_bpool_stat->n_buffer_pool_registered += data->size();
+    return true;
+}
+
+void buffer_pool::reclaim()
+{
+    size_t idle = m_n_buffers * m_buf_size;
+    size_t n_reclaim = 0;
+
+    if (idle <= safe_mce_sys().memory_reclaim_high) {
+        return;
+    }
+
+    // Prefer the latest blocks, the first block is never reclaimed to keep ring lkeys valid.
+    for (size_t i = m_blocks.size(); i > 1; --i) {
+        bpool_block *block = m_blocks[i - 1];
+        size_t block_idle = block->n_buffers * m_buf_size;
+
+        if (block->n_free == block->n_buffers &&
+            idle - block_idle >= safe_mce_sys().memory_reclaim_low) {
+            block->b_reclaim = true;
+            idle -= block_idle;
+            ++n_reclaim;
+        }
+    }
+    if (!n_reclaim) {
+        return;
+    }
+
+    // Unlink buffers of the reclaimed blocks from the free list.
+    mem_buf_desc_t **pp_desc = &m_p_head;
+    while (*pp_desc) {
+        if ((*pp_desc)->p_block->b_reclaim) {
+            *pp_desc = (*pp_desc)->p_next_desc;
+        } else {
+            pp_desc = &(*pp_desc)->p_next_desc;
+        }
+    }
+
+    xlio_heap *heap = m_allocator_data.get_heap();
+    for (auto iter = m_blocks.begin(); iter != m_blocks.end();) {
+        bpool_block *block = *iter;
+
+        if (!block->b_reclaim) {
+            ++iter;
+            continue;
+        }
+        m_n_buffers -= block->n_buffers;
+        m_n_buffers_created -= block->n_buffers;
+        m_p_bpool_stat->n_buffer_pool_size -= block->n_buffers;
+        m_p_bpool_stat->n_buffer_pool_registered -= block->p_data->size();
+        heap->free_block(block->p_data);
+        delete block;
+        iter = m_blocks.erase(iter);
+    }
+    m_n_blocks_reclaimed += n_reclaim;
+    m_p_bpool_stat->n_buffer_pool_reclaims += n_reclaim;
+    // Returned memory can satisfy a new expand.
+    m_b_degraded = false;
+
+    __log_info_dbg("Reclaimed %zu blocks from %s pool, %zu blocks left", n_reclaim,
+                   m_p_bpool_stat->is_rx ? "Rx" : "Tx", m_blocks.size());
+}
+
+void buffer_pool::reclaim_thread_safe()
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    reclaim();
+}
+
+void buffer_pool::handle_timer_expired(void *user_data)
+{
+    NOT_IN_USE(user_data);
+    reclaim_thread_safe();
+}
+
 /**
  * Free-callback function to free a 'struct pbuf_custom_ref', called by pbuf_free.
  */
@@ -155,17 +281,21 @@ buffer_pool::buffer_pool(buffer_pool_type type, size_t buf_size, alloc_t alloc_f
     , m_n_buffers_created(0)
     , m_p_head(nullptr)
     , m_b_degraded(false)
+    , m_n_blocks_reclaimed(0)
+    , m_timer_handle(nullptr)
     , m_allocator_data(m_buf_size ? xlio_allocator_heap(alloc_func, free_func, true)
                                   : xlio_allocator_heap(false))
     , m_allocator_metadata(false)
 {
+    m_b_elastic = m_buf_size && m_allocator_data.get_heap()->is_elastic();
+
     size_t initial_pool_size;
 
     m_p_bpool_stat = &m_bpool_stat_static;
     memset(m_p_bpool_stat, 0, sizeof(*m_p_bpool_stat));
     m_p_bpool_stat->is_rx = type == BUFFER_POOL_RX;
     m_p_bpool_stat->is_tx = type == BUFFER_POOL_TX;
-    xlio_stats_instance_create_bpool_block(m_p_bpool_stat);
+    m_p_bpool_stat = xlio_stats_instance_create_bpool_block(m_p_bpool_stat);
 
     if (type == BUFFER_POOL_RX) {
         m_compensation_level =
@@ -186,13 +316,27 @@ buffer_pool::buffer_pool(buffer_pool_type type, size_t buf_size, alloc_t alloc_f
             throw_xlio_exception("Failed to allocate buffers");
         }
     }
+    if (m_b_elastic && safe_mce_sys().memory_reclaim_high && g_p_event_handler_manager) {
+        m_timer_handle = g_p_event_handler_manager->register_timer_event(
+            BUFFER_POOL_RECLAIM_INTERVAL_MSEC, this, PERIODIC_TIMER, nullptr);
+    }
     print_val_tbl();
 }
 
 buffer_pool::~buffer_pool()
 {
-    __log_info_dbg("count %lu, missing %lu", m_n_buffers, m_n_buffers_created - m_n_buffers);
-    xlio_stats_instance_remove_bpool_block(m_p_bpool_stat);
+    if (m_timer_handle) {
+        g_p_event_handler_manager->unregister_timer_event(this, m_timer_handle);
+        m_timer_handle = nullptr;
+    }
+    __log_info_dbg("count %lu, missing %lu, reclaimed blocks %zu", m_n_buffers,
+                   m_n_buffers_created - m_n_buffers, m_n_blocks_reclaimed);
+    // Block memory is released by the heap finalization, only metadata is freed here.
+    for (auto &block : m_blocks) {
+        delete block;
+    }
+    m_blocks.clear();
+    m_p_bpool_stat = xlio_stats_instance_remove_bpool_block(m_p_bpool_stat);
 }
 
 void buffer_pool::register_memory(ib_ctx_handler *p_ib_ctx_h)
@@ -221,6 +365,27 @@ void buffer_pool::print_report(vlog_levels_t log_level /*=VLOG_DEBUG*/)
                 option_size::to_str(m_buf_size, str2, sizeof(str2)));
     vlog_printf(log_level, "  Requests: %u unsatisfied buffer requests\n",
                 m_p_bpool_stat->n_buffer_pool_no_bufs);
+    if (m_b_elastic) {
+        xlio_heap *heap = m_allocator_data.get_heap();
+        long rss_pages = 0;
+        FILE *fp = fopen("/proc/self/statm", "r");
+
+        if (fp) {
+            if (fscanf(fp, "%*s %ld", &rss_pages) != 1) {
+                rss_pages = 0;
+            }
+            fclose(fp);
+        }
+        vlog_printf(log_level, "  Blocks: %zu allocated, %zu reclaimed\n", m_blocks.size(),
+                    m_n_blocks_reclaimed);
+        vlog_printf(
+            log_level, "  Registered memory: %s (heap %s)\n",
+            option_size::to_str(m_p_bpool_stat->n_buffer_pool_registered, str1, sizeof(str1)),
+            option_size::to_str(heap->get_registered_size(), str2, sizeof(str2)));
+        vlog_printf(log_level, "  Process RSS: %s\n",
+                    option_size::to_str((size_t)rss_pages * sysconf(_SC_PAGESIZE), str1,
+                                        sizeof(str1)));
+    }
 }
 
 /* static */
@@ -256,6 +421,8 @@ bool buffer_pool::get_buffers_thread_safe(descq_t &pDeque, ring_slave *desc_owne
     std::lock_guard<decltype(m_lock)> lock(m_lock);
 
     mem_buf_desc_t *head;
+    bpool_block *last_block = m_blocks.empty() ? nullptr : m_blocks.front();
+    uint32_t last_lkey = lkey;
 
     __log_info_funcall("requested %lu, present %lu, created %lu", count, m_n_buffers,
                        m_n_buffers_created);
@@ -284,7 +451,18 @@ bool buffer_pool::get_buffers_thread_safe(descq_t &pDeque, ring_slave *desc_owne
         head->p_next_desc = nullptr;
 
         // Init
-        head->lkey = lkey;
+        if (unlikely(head->p_block)) {
+            head->p_block->n_free--;
+            // Ring lkey belongs to the first block, other blocks have own registrations.
+            if (head->p_block != last_block && lkey) {
+                last_block = head->p_block;
+                last_lkey =
+                    find_block_lkey(last_block, desc_owner ? desc_owner->get_ctx(0) : nullptr);
+            }
+            head->lkey = last_block == m_blocks.front() ? lkey : last_lkey;
+        } else {
+            head->lkey = lkey;
+        }
         head->p_desc_owner = desc_owner;
 
         // Push to queue
@@ -297,9 +475,18 @@ bool buffer_pool::get_buffers_thread_safe(descq_t &pDeque, ring_slave *desc_owne
 uint32_t buffer_pool::find_lkey_by_ib_ctx_thread_safe(ib_ctx_handler *p_ib_ctx_h)
 {
     std::lock_guard<decltype(m_lock)> lock(m_lock);
+    if (m_b_elastic) {
+        return m_blocks.empty() ? LKEY_ERROR
+                                : m_blocks.front()->p_data->find_lkey_by_ib_ctx(p_ib_ctx_h);
+    }
     return m_allocator_data.find_lkey_by_ib_ctx(p_ib_ctx_h);
 }
 
+uint32_t buffer_pool::find_block_lkey(bpool_block *block, ib_ctx_handler *p_ib_ctx_h)
+{
+    return p_ib_ctx_h ? block->p_data->find_lkey_by_ib_ctx(p_ib_ctx_h) : LKEY_ERROR;
+}
+
 #if _BullseyeCoverage
 #pragma BullseyeCoverage off
 #endif
@@ -40,10 +40,34 @@
 #include "util/xlio_list.h"
 #include "proto/mapping.h"
 #include "proto/mem_desc.h"
+#include "event/timer_handler.h"
+
+#include <vector>
 
 // Forward declarations
 class ib_ctx_handler;
 
+/**
+ * Separately registered memory block of an elastic buffer pool. The block can be
+ * returned to the system once all its buffers are back in the pool.
+ */
+struct bpool_block {
+    bpool_block(xlio_allocator_hw *data)
+        : p_data(data)
+        , metadata(ALLOC_TYPE_ANON)
+        , n_buffers(0)
+        , n_free(0)
+        , b_reclaim(false)
+    {
+    }
+
+    xlio_allocator_hw *p_data; // Owned by the heap, returned with xlio_heap::free_block()
+    xlio_allocator metadata; // Descriptors of the block buffers
+    size_t n_buffers;
+    size_t n_free;
+    bool b_reclaim;
+};
+
 enum buffer_pool_type {
     BUFFER_POOL_RX = 1,
     BUFFER_POOL_TX,
@@ -70,11 +94,11 @@ inline static void free_lwip_pbuf(struct pbuf *lwip_pbuf)
 /**
  * A buffer pool which internally sorts the buffers.
  */
-class buffer_pool {
+class buffer_pool : public timer_handler {
 public:
     buffer_pool(buffer_pool_type type, size_t buf_size, alloc_t alloc_func = nullptr,
                 free_t free_func = nullptr);
-    ~buffer_pool();
+    ~buffer_pool() override;
 
     void register_memory(ib_ctx_handler *p_ib_ctx_h);
     void print_val_tbl();
@@ -115,6 +139,18 @@ public:
      */
     size_t get_free_count();
 
+    /**
+     * Return idle blocks to the system if the pool is above the high watermark.
+     */
+    void reclaim_thread_safe();
+    void handle_timer_expired(void *user_data) override;
+
+protected:
+    // Elastic mode internals, assume locked pool
+    bool expand_block(size_t count);
+    void reclaim();
+    uint32_t find_block_lkey(bpool_block *block, ib_ctx_handler *p_ib_ctx_h);
+
 private:
     /**
      * Add a buffer to the pool
@@ -138,6 +174,12 @@ private:
     // After an allocation failure, don't try to expand the pool anymore.
     bool m_b_degraded;
 
+    // Elastic mode: the pool grows by registered blocks and the first block is never reclaimed.
+    bool m_b_elastic;
+    std::vector<bpool_block *> m_blocks;
+    size_t m_n_blocks_reclaimed;
+    void *m_timer_handle;
+
     bpool_stats_t *m_p_bpool_stat;
     bpool_stats_t m_bpool_stat_static;
     xlio_allocator_heap m_allocator_data;
@@ -128,7 +128,7 @@ void cq_mgr_rx::configure(int cq_size)
     BULLSEYE_EXCLUDE_BLOCK_END
     VALGRIND_MAKE_MEM_DEFINED(m_p_ibv_cq, sizeof(ibv_cq));
 
-    xlio_stats_instance_create_cq_block(m_p_cq_stat);
+    m_p_cq_stat = xlio_stats_instance_create_cq_block(m_p_cq_stat);
 
     m_b_is_rx_hw_csum_on = xlio_is_rx_hw_csum_supported(m_p_ib_ctx_handler->get_ibv_device_attr());
 
@@ -167,7 +167,7 @@ cq_mgr_rx::~cq_mgr_rx()
     VALGRIND_MAKE_MEM_UNDEFINED(m_p_ibv_cq, sizeof(ibv_cq));
 
     statistics_print();
-    xlio_stats_instance_remove_cq_block(m_p_cq_stat);
+    m_p_cq_stat = xlio_stats_instance_remove_cq_block(m_p_cq_stat);
 
     cq_logdbg("Destroying Rx CQ done");
 }
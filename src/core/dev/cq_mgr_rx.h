@@ -69,6 +69,7 @@ class cq_mgr_rx {
     friend class ring_simple; // need to expose the m_n_global_sn_rx only to ring
     friend class ring_bond; // need to expose the m_n_global_sn_rx only to ring
     friend class rfs_uc_tcp_gro; // need for stats
+    friend class rfs_uc_udp_gro; // need for stats
 
 public:
     enum buff_status_e {
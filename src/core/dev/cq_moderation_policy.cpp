@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include "cq_moderation_policy.h"
+
+// Additive increase step of the AIMD count as a fraction of the maximal count
+#define CQ_AIMD_STEP_DIVISOR 32
+
+cq_moderation_policy *cq_moderation_policy::create(cq_moderation_policy_t type,
+                                                   const cq_moderation_config &config)
+{
+    switch (type) {
+    case CQ_MODERATION_POLICY_AIMD:
+        return new cq_moderation_policy_aimd(config);
+    default:
+        return new cq_moderation_policy_rate(config);
+    }
+}
+
+cq_moderation_params cq_moderation_policy_rate::update(const cq_moderation_sample &sample)
+{
+    if (sample.packets == 0 || sample.interval_usec == 0) {
+        return m_config.defaults;
+    }
+
+    uint32_t avg_packet_size = sample.bytes / sample.packets;
+    uint32_t avg_packet_rate = (sample.packets * 1000000UL) / sample.interval_usec;
+
+    uint32_t ir_rate = m_config.interrupts_rate_per_sec;
+
+    if (avg_packet_size < 1024 && avg_packet_rate < 450000) {
+        // latency mode
+        return {0, 0};
+    }
+
+    // throughput mode
+    cq_moderation_params params;
+    params.count = std::min(avg_packet_rate / ir_rate, m_config.max_count);
+    params.period = std::min<uint32_t>(
+        m_config.max_period,
+        ((1000000UL / ir_rate) - (1000000UL / std::max(avg_packet_rate, ir_rate))));
+    return params;
+}
+
+cq_moderation_policy_aimd::cq_moderation_policy_aimd(const cq_moderation_config &config)
+    : cq_moderation_policy(config)
+    , m_count(config.defaults.count)
+{
+}
+
+cq_moderation_params cq_moderation_policy_aimd::update(const cq_moderation_sample &sample)
+{
+    if (sample.packets == 0 || sample.interval_usec == 0) {
+        // Idle ring, start over from the configured moderation
+        m_count = m_config.defaults.count;
+        return m_config.defaults;
+    }
+
+    uint32_t period = std::min(m_config.latency_target_usec, m_config.max_period);
+    uint32_t step = std::max(m_config.max_count / CQ_AIMD_STEP_DIVISOR, 1U);
+    uint64_t avg_batch = sample.packets / std::max<uint64_t>(sample.batches, 1);
+    // Time to accumulate the given number of completions at the observed rate
+    auto fill_usec = [&sample](uint64_t count) {
+        return count * sample.interval_usec / sample.packets;
+    };
+
+    /* Batches well below the count mean the timer raises the interrupts,
+     * batches which reach the count mean the count raises them and more
+     * completions can be coalesced if the rate fills them within the target.
+     */
+    if (fill_usec(m_count) > period || avg_batch * 2 < m_count) {
+        m_count /= 2;
+    } else if (avg_batch >= m_count && fill_usec(m_count + step) <= period) {
+        m_count += step;
+    }
+    m_count = std::min(m_count, m_config.max_count);
+
+    if (m_count <= 1) {
+        // Too sparse to coalesce anything within the target
+        m_count = 1;
+        return {0, 0};
+    }
+    return {period, m_count};
+}
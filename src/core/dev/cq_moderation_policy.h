@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CQ_MODERATION_POLICY_H
+#define CQ_MODERATION_POLICY_H
+
+#include <stdint.h>
+
+/*
+ * Adaptive CQ interrupt moderation policies (XLIO_CQ_AIM_POLICY).
+ * The policies are plain computations over per interval counters and do not
+ * touch the device, so the same code runs in the ring and in the offline
+ * simulator (tests/cq_moderation_sim).
+ */
+
+typedef enum {
+    CQ_MODERATION_POLICY_RATE = 0,
+    CQ_MODERATION_POLICY_AIMD,
+} cq_moderation_policy_t;
+
+// Ring activity during one adaptation interval
+struct cq_moderation_sample {
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t batches; // Rx CQ polls which returned at least one completion
+    uint64_t interval_usec;
+};
+
+struct cq_moderation_params {
+    uint32_t period; // usec
+    uint32_t count;
+};
+
+struct cq_moderation_config {
+    cq_moderation_params defaults;
+    uint32_t max_period;
+    uint32_t max_count;
+    uint32_t interrupts_rate_per_sec;
+    uint32_t latency_target_usec;
+};
+
+class cq_moderation_policy {
+public:
+    virtual ~cq_moderation_policy() {}
+
+    // Returns the moderation for the next interval
+    virtual cq_moderation_params update(const cq_moderation_sample &sample) = 0;
+
+    static cq_moderation_policy *create(cq_moderation_policy_t type,
+                                        const cq_moderation_config &config);
+
+protected:
+    cq_moderation_policy(const cq_moderation_config &config)
+        : m_config(config)
+    {
+    }
+
+    const cq_moderation_config m_config;
+};
+
+/**
+ * Targets XLIO_CQ_AIM_INTERRUPTS_RATE_PER_SEC for bulk traffic and disables
+ * moderation for small packets at moderate rates.
+ */
+class cq_moderation_policy_rate : public cq_moderation_policy {
+public:
+    cq_moderation_policy_rate(const cq_moderation_config &config)
+        : cq_moderation_policy(config)
+    {
+    }
+
+    cq_moderation_params update(const cq_moderation_sample &sample) override;
+};
+
+/**
+ * Bounds the time a completion is held by XLIO_CQ_AIM_LATENCY_TARGET_USEC and
+ * adapts the count with additive increase and multiplicative decrease:
+ * the count grows while the observed completion batches fill it within the
+ * target and is halved when it cannot be reached within the target, so the
+ * interrupt would always be raised by the timer after the maximal delay.
+ */
+class cq_moderation_policy_aimd : public cq_moderation_policy {
+public:
+    cq_moderation_policy_aimd(const cq_moderation_config &config);
+
+    cq_moderation_params update(const cq_moderation_sample &sample) override;
+
+private:
+    uint32_t m_count;
+};
+
+#endif /* CQ_MODERATION_POLICY_H */
@@ -31,7 +31,8 @@
  */
 
 #include "dev/gro_mgr.h"
-#include "dev/rfs_uc_tcp_gro.h"
+#include "vlogger/vlogger.h"
+#include "utils/bullseye.h"
 
 #define MODULE_NAME "gro_mgr"
 
@@ -40,7 +41,7 @@ gro_mgr::gro_mgr(uint32_t flow_max, uint32_t buf_max)
     , m_n_buf_max(buf_max)
     , m_n_flow_count(0)
 {
-    m_p_rfs_arr = new rfs_uc_tcp_gro *[flow_max];
+    m_p_rfs_arr = new gro_stream *[flow_max];
     BULLSEYE_EXCLUDE_BLOCK_START
     if (!m_p_rfs_arr) {
         __log_panic("could not allocate memory");
@@ -53,13 +54,13 @@ gro_mgr::~gro_mgr()
     delete[] m_p_rfs_arr;
 }
 
-bool gro_mgr::reserve_stream(rfs_uc_tcp_gro *rfs_uc_tcp_gro)
+bool gro_mgr::reserve_stream(gro_stream *stream)
 {
     if (is_stream_max()) {
         return false;
     }
 
-    m_p_rfs_arr[m_n_flow_count] = rfs_uc_tcp_gro;
+    m_p_rfs_arr[m_n_flow_count] = stream;
     m_n_flow_count++;
     return true;
 }
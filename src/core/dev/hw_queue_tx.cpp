@@ -38,6 +38,7 @@
 #include "dev/cq_mgr_rx_regrq.h"
 #include "proto/tls.h"
 #include "util/valgrind.h"
+#include "util/instrumentation.h"
 
 #undef MODULE_NAME
 #define MODULE_NAME "hw_queue_tx"
@@ -506,7 +507,7 @@ void hw_queue_tx::init_device_memory()
     if (m_p_ib_ctx_handler->get_on_device_memory_size() > 0 &&
         is_bf(m_p_ib_ctx_handler->get_ibv_context())) {
         m_dm_enabled =
-            m_dm_mgr.allocate_resources(m_p_ib_ctx_handler, m_p_ring->m_p_ring_stat.get());
+            m_dm_mgr.allocate_resources(m_p_ib_ctx_handler, m_p_ring->m_p_ring_stat);
     }
 }
 
@@ -532,7 +533,6 @@ cq_mgr_tx *hw_queue_tx::init_tx_cq_mgr()
 
 inline void hw_queue_tx::ring_doorbell(int num_wqebb, bool skip_comp /*=false*/)
 {
-    uint64_t *dst = (uint64_t *)m_mlx5_qp.bf.reg;
     uint64_t *src = reinterpret_cast<uint64_t *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *ctrl = reinterpret_cast<struct xlio_mlx5_wqe_ctrl_seg *>(src);
 
@@ -554,6 +554,20 @@ inline void hw_queue_tx::ring_doorbell(int num_wqebb, bool skip_comp /*=false*/)
 
     m_sq_wqe_counter = (m_sq_wqe_counter + num_wqebb) & 0xFFFF;
 
+    // The doorbell of the last WQE covers all the WQEs posted before it
+    if (m_b_doorbell_defer) {
+        m_p_doorbell_pending = src;
+        return;
+    }
+    write_doorbell(src);
+}
+
+inline void hw_queue_tx::write_doorbell(uint64_t *src)
+{
+    uint64_t *dst = (uint64_t *)m_mlx5_qp.bf.reg;
+
+    m_p_doorbell_pending = nullptr;
+
     // Make sure that descriptors are written before
     // updating doorbell record and ringing the doorbell
     wmb();
@@ -568,6 +582,15 @@ inline void hw_queue_tx::ring_doorbell(int num_wqebb, bool skip_comp /*=false*/)
      * sfence instruction affects only the WC buffers of the CPU that executes it
      */
     wc_wmb();
+
+    lat_stats_doorbell();
+}
+
+void hw_queue_tx::ring_pending_doorbell()
+{
+    if (unlikely(m_p_doorbell_pending)) {
+        write_doorbell(m_p_doorbell_pending);
+    }
 }
 
 inline int hw_queue_tx::fill_inl_segment(sg_array &sga, uint8_t *cur_seg, uint8_t *data_addr,
@@ -867,7 +890,9 @@ void hw_queue_tx::send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_a
     store_current_wqe_prop(reinterpret_cast<mem_buf_desc_t *>(p_send_wqe->wr_id), credits, tis);
 
     /* Complete WQE */
+    m_b_doorbell_defer = is_set(attr, XLIO_TX_PACKET_MORE);
     int wqebbs = fill_wqe(p_send_wqe);
+    m_b_doorbell_defer = false;
     assert(wqebbs > 0 && (unsigned)wqebbs <= credits);
     NOT_IN_USE(wqebbs);
 
@@ -1492,7 +1517,7 @@ void hw_queue_tx::trigger_completion_for_all_sent_packets()
         ibv_sge sge[1];
         sge[0].length = sizeof(ethhdr) + sizeof(iphdr);
         sge[0].addr = (uintptr_t)(p_mem_buf_desc->p_buffer);
-        sge[0].lkey = m_p_ring->m_tx_lkey;
+        sge[0].lkey = p_mem_buf_desc->lkey;
 
         // Prepare send wr for (does not care if it is UD/IB or RAW/ETH)
         // UD requires AH+qkey, RAW requires minimal payload instead of MAC header.
@@ -90,6 +90,8 @@ public:
 
     void send_wqe(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr, xlio_tis *tis,
                   unsigned credits);
+    // Rings the doorbell deferred by XLIO_TX_PACKET_MORE, if any
+    void ring_pending_doorbell();
 
     struct ibv_qp *get_ibv_qp() const { return m_mlx5_qp.qp; };
 
@@ -265,6 +267,7 @@ private:
     inline int fill_inl_segment(sg_array &sga, uint8_t *cur_seg, uint8_t *data_addr,
                                 int max_inline_len, int inline_len);
     inline void ring_doorbell(int num_wqebb, bool skip_comp = false);
+    inline void write_doorbell(uint64_t *src);
 
     struct xlio_rate_limit_t m_rate_limit;
     xlio_ib_mlx5_qp_t m_mlx5_qp;
@@ -288,6 +291,9 @@ private:
     uint16_t m_sq_wqe_counter = 0U;
     uint8_t m_port_num;
     bool m_b_fence_needed = false;
+    bool m_b_doorbell_defer = false;
+    // Control segment of the last WQE whose doorbell is deferred
+    uint64_t *m_p_doorbell_pending = nullptr;
     bool m_dm_enabled = false;
     bool m_hw_dummy_send_support = false;
     dm_mgr m_dm_mgr;
@@ -53,6 +53,7 @@
 #include "proto/L2_address.h"
 #include "dev/ib_ctx_handler_collection.h"
 #include "dev/ring_tap.h"
+#include "dev/ring_xdp.h"
 #include "dev/ring_simple.h"
 #include "dev/ring_slave.h"
 #include "dev/ring_bond.h"
@@ -255,6 +256,14 @@ net_device_val::net_device_val(struct net_device_val_desc *desc)
         break;
     default:
         valid = (bool)(ib_ctx && verify_eth_qp_creation(get_ifname_link()));
+#ifdef DEFINED_XDP
+        /* Interfaces w/o verbs support can be served by AF_XDP ring */
+        if (!ib_ctx && get_type() == ARPHRD_ETHER &&
+            safe_mce_sys().xdp_mode != option_xdp::XDP_DISABLE) {
+            valid = true;
+            m_b_xdp = true;
+        }
+#endif /* DEFINED_XDP */
         break;
     }
 
@@ -292,7 +301,7 @@ net_device_val::net_device_val(struct net_device_val_desc *desc)
                   get_port_from_ifname(get_ifname_link()),
                   (ib_ctx->is_active(get_port_from_ifname(get_ifname_link())) ? "Up" : "Down"));
     } else {
-        nd_logdbg("%s ==> none", get_ifname());
+        nd_logdbg("%s ==> %s", get_ifname(), (m_b_xdp ? "AF_XDP" : "none"));
     }
 }
 
@@ -1104,9 +1113,10 @@ int net_device_val::release_ring(resource_allocation_key *key)
  */
 resource_allocation_key *net_device_val::ring_key_redirection_reserve(resource_allocation_key *key)
 {
+    int ring_limit = get_ring_limit();
+
     // if allocation logic is usr idx feature disabled
-    if (!safe_mce_sys().ring_limit_per_interface ||
-        key->get_ring_alloc_logic() == RING_LOGIC_PER_USER_ID) {
+    if (!ring_limit || (key->get_ring_alloc_logic() == RING_LOGIC_PER_USER_ID && !m_b_xdp)) {
         return key;
     }
 
@@ -1119,7 +1129,7 @@ resource_allocation_key *net_device_val::ring_key_redirection_reserve(resource_a
     }
 
     int ring_map_size = (int)m_h_ring_map.size();
-    if (safe_mce_sys().ring_limit_per_interface > ring_map_size) {
+    if (ring_limit > ring_map_size) {
         resource_allocation_key *key2 = new resource_allocation_key(*key);
         // replace key to redirection key
         key2->set_user_id_key(ring_map_size);
@@ -1147,7 +1157,7 @@ resource_allocation_key *net_device_val::ring_key_redirection_reserve(resource_a
 
 resource_allocation_key *net_device_val::get_ring_key_redirection(resource_allocation_key *key)
 {
-    if (!safe_mce_sys().ring_limit_per_interface) {
+    if (!get_ring_limit()) {
         return key;
     }
 
@@ -1161,7 +1171,7 @@ resource_allocation_key *net_device_val::get_ring_key_redirection(resource_alloc
 
 void net_device_val::ring_key_redirection_release(resource_allocation_key *key)
 {
-    if (safe_mce_sys().ring_limit_per_interface &&
+    if (get_ring_limit() &&
         m_h_ring_key_redirection_map.find(key) != m_h_ring_key_redirection_map.end() &&
         --m_h_ring_key_redirection_map[key].second == 0) {
         // this is allocated in ring_key_redirection_reserve
@@ -1173,6 +1183,15 @@ void net_device_val::ring_key_redirection_release(resource_allocation_key *key)
     }
 }
 
+/*
+ * AF_XDP socket is bound to a single queue of the interface, so all the
+ * sockets share one ring regardless of the ring allocation logic.
+ */
+int net_device_val::get_ring_limit() const
+{
+    return (m_b_xdp ? 1 : safe_mce_sys().ring_limit_per_interface);
+}
+
 int net_device_val::global_ring_poll_and_process_element(uint64_t *p_poll_sn_rx,
                                                          uint64_t *p_poll_sn_tx,
                                                          void *pv_fd_ready_array /*=NULL*/)
@@ -1285,7 +1304,7 @@ void net_device_val::register_to_ibverbs_events(event_handler_ibverbs *handler)
                 break;
             }
         }
-        if (found) {
+        if (found || !m_slaves[i]->p_ib_ctx) {
             continue;
         }
         nd_logfunc("registering slave to ibverbs events slave=%p", m_slaves[i]);
@@ -1306,7 +1325,7 @@ void net_device_val::unregister_to_ibverbs_events(event_handler_ibverbs *handler
                 break;
             }
         }
-        if (found) {
+        if (found || !m_slaves[i]->p_ib_ctx) {
             continue;
         }
         nd_logfunc("unregistering slave to ibverbs events slave=%p", m_slaves[i]);
@@ -1413,6 +1432,12 @@ ring *net_device_val_eth::create_ring(resource_allocation_key *key)
     try {
         switch (m_bond) {
         case NO_BOND:
+#ifdef DEFINED_XDP
+            if (m_b_xdp) {
+                ring = new ring_xdp(get_if_idx());
+                break;
+            }
+#endif /* DEFINED_XDP */
             ring = new ring_eth(get_if_idx(), nullptr, RING_ETH, true,
                                 (key ? key->get_use_locks() : true));
             break;
@@ -248,6 +248,7 @@ public:
     L2_address *get_l2_address() { return m_p_L2_addr; };
     L2_address *get_br_address() { return m_p_br_addr; };
     inline bond_type get_is_bond() { return m_bond; }
+    inline bool is_xdp() const { return m_b_xdp; }
     inline bond_xmit_hash_policy get_bond_xmit_hash_policy() { return m_bond_xmit_hash_policy; }
     bool update_active_slaves();
     void update_netvsc_slaves(int if_index, int if_flags);
@@ -276,6 +277,7 @@ protected:
     bond_xmit_hash_policy m_bond_xmit_hash_policy;
     int m_bond_fail_over_mac;
     tc_class_priority_map m_class_prio_map;
+    bool m_b_xdp = false; /* device is served by AF_XDP ring instead of verbs */
 
 private:
     void verify_bonding_mode();
@@ -286,6 +288,7 @@ private:
     resource_allocation_key *ring_key_redirection_reserve(resource_allocation_key *key);
     resource_allocation_key *get_ring_key_redirection(resource_allocation_key *key);
     void ring_key_redirection_release(resource_allocation_key *key);
+    int get_ring_limit() const;
     void print_ips();
     bool get_up_and_active_slaves(bool *up_and_active_slaves, size_t size);
 
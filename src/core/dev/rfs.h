@@ -123,7 +123,7 @@ protected:
     bool create_flow(); // Attach flow to all queues
     bool destroy_flow(); // Detach flow from all queues
     bool add_sink(sockinfo *p_sink);
-    bool del_sink(sockinfo *p_sink);
+    virtual bool del_sink(sockinfo *p_sink);
     void prepare_flow_spec_eth_ip(const ip_address &dst_ip, const ip_address &src_ip);
     void prepare_flow_spec_tcp_udp();
     virtual void prepare_flow_spec() = 0;
@@ -49,6 +49,9 @@
 #define rfs_logfunc    __log_info_func
 #define rfs_logfuncall __log_info_funcall
 
+#define RFS_SYN_OWNERS        1024U
+#define RFS_SYN_OWNERS_BUCKET 4U
+
 rfs_uc::rfs_uc(flow_tuple *flow_spec_5t, ring_slave *p_ring, rfs_rule_filter *rule_filter,
                uint32_t flow_tag_id)
     : rfs(flow_spec_5t, p_ring, rule_filter, flow_tag_id)
@@ -62,6 +65,10 @@ rfs_uc::rfs_uc(flow_tuple *flow_spec_5t, ring_slave *p_ring, rfs_rule_filter *ru
     if (m_p_ring->is_simple()) {
         prepare_flow_spec();
     }
+
+    // Application specific sharding keeps a 4-tuple rule per worker
+    m_b_reuseport_group = safe_mce_sys().tcp_reuseport_sharding && m_flow_tuple.is_tcp() &&
+        m_flow_tuple.is_3_tuple();
 }
 
 void rfs_uc::prepare_flow_spec()
@@ -117,9 +124,117 @@ void rfs_uc::prepare_flow_spec()
                 m_flow_tag_id);
 }
 
+static inline uint64_t reuseport_score(size_t flow_hash, const sockinfo *p_sink)
+{
+    uint64_t val = flow_hash ^ (reinterpret_cast<uintptr_t>(p_sink) * 0x9E3779B97F4A7C15ULL);
+
+    val ^= val >> 33;
+    val *= 0xFF51AFD7ED558CCDULL;
+    val ^= val >> 33;
+    val *= 0xC4CEB9FE1A85EC53ULL;
+    val ^= val >> 33;
+    return val;
+}
+
+rfs_uc::syn_owner *rfs_uc::find_syn_owner(const sock_addr &src, size_t flow_hash)
+{
+    syn_owner *p_bucket = &m_syn_owners[(flow_hash * RFS_SYN_OWNERS_BUCKET) % RFS_SYN_OWNERS];
+
+    for (uint32_t i = 0; i < RFS_SYN_OWNERS_BUCKET; ++i) {
+        if (p_bucket[i].p_sink && p_bucket[i].src == src) {
+            return &p_bucket[i];
+        }
+    }
+    return nullptr;
+}
+
+void rfs_uc::set_syn_owner(const sock_addr &src, size_t flow_hash, sockinfo *p_sink)
+{
+    if (m_syn_owners.empty()) {
+        m_syn_owners.resize(RFS_SYN_OWNERS);
+    }
+
+    // A retransmitted SYN can be handled on another CPU
+    syn_owner *p_entry = find_syn_owner(src, flow_hash);
+    if (!p_entry) {
+        syn_owner *p_bucket = &m_syn_owners[(flow_hash * RFS_SYN_OWNERS_BUCKET) % RFS_SYN_OWNERS];
+        p_entry = &p_bucket[0];
+        for (uint32_t i = 1; i < RFS_SYN_OWNERS_BUCKET && p_entry->p_sink; ++i) {
+            if (!p_bucket[i].p_sink || p_bucket[i].seq - p_entry->seq > (1U << 31)) {
+                p_entry = &p_bucket[i];
+            }
+        }
+        p_entry->src = src;
+    }
+    p_entry->p_sink = p_sink;
+    p_entry->seq = m_syn_owners_seq++;
+}
+
+bool rfs_uc::del_sink(sockinfo *p_sink)
+{
+    for (syn_owner &entry : m_syn_owners) {
+        if (entry.p_sink == p_sink) {
+            entry.p_sink = nullptr;
+        }
+    }
+    return rfs::del_sink(p_sink);
+}
+
+sockinfo *rfs_uc::select_reuseport_sink(mem_buf_desc_t *p_rx_wc_buf_desc)
+{
+    const sock_addr &src = p_rx_wc_buf_desc->rx.src;
+    const tcphdr *p_tcp_h = p_rx_wc_buf_desc->rx.tcp.p_tcp_h;
+    size_t flow_hash = src.hash();
+
+    if (p_tcp_h->syn && !p_tcp_h->ack) {
+        // Same as the kernel, prefer a listener bound to the CPU which handles the SYN
+        int cpu = sched_getcpu();
+        for (uint32_t i = 0; i < m_n_sinks_list_entries; ++i) {
+            if (unlikely(m_sinks_list[i]->get_incoming_cpu() == cpu)) {
+                set_syn_owner(src, flow_hash, m_sinks_list[i]);
+                return m_sinks_list[i];
+            }
+        }
+        // A reused source address goes to the hashed listener now
+        syn_owner *p_entry = m_syn_owners.empty() ? nullptr : find_syn_owner(src, flow_hash);
+        if (unlikely(p_entry)) {
+            p_entry->p_sink = nullptr;
+        }
+    } else if (unlikely(!m_syn_owners.empty())) {
+        // The rest of the handshake can be polled on another CPU
+        syn_owner *p_entry = find_syn_owner(src, flow_hash);
+        if (p_entry) {
+            return p_entry->p_sink;
+        }
+    }
+
+    /* Rendezvous hashing: the listener with the highest score takes the connection.
+     * When a listener leaves the group only its own connections are moved, so
+     * handshakes in progress on the other listeners are not affected.
+     */
+    sockinfo *p_sink = m_sinks_list[0];
+    uint64_t max_score = reuseport_score(flow_hash, p_sink);
+    for (uint32_t i = 1; i < m_n_sinks_list_entries; ++i) {
+        uint64_t score = reuseport_score(flow_hash, m_sinks_list[i]);
+        if (score > max_score) {
+            max_score = score;
+            p_sink = m_sinks_list[i];
+        }
+    }
+
+    return p_sink;
+}
+
 bool rfs_uc::rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd_ready_array)
 {
     p_rx_wc_buf_desc->reset_ref_count();
+    if (m_b_reuseport_group && m_n_sinks_list_entries > 1) {
+        sockinfo *p_sink = select_reuseport_sink(p_rx_wc_buf_desc);
+        rfs_logfunc("reuseport group of %u listeners, dispatch to fd=%d",
+                    m_n_sinks_list_entries, p_sink->get_fd());
+        // The sink will be responsible to return the buffer to CQ for reuse
+        return p_sink->rx_input_cb(p_rx_wc_buf_desc, pv_fd_ready_array);
+    }
     for (uint32_t i = 0; i < m_n_sinks_list_entries; ++i) {
         if (likely(m_sinks_list[i])) {
             bool consumed = m_sinks_list[i]->rx_input_cb(p_rx_wc_buf_desc, pv_fd_ready_array);
@@ -33,6 +33,8 @@
 #ifndef RFS_UC_H
 #define RFS_UC_H
 
+#include <vector>
+
 #include "dev/rfs.h"
 
 /**
@@ -40,6 +42,8 @@
  *
  * Object to manages the sink list of a UC flow
  * This object is used for maintaining the sink list and dispatching packets
+ * Sinks of a TCP 3-tuple flow are listeners of a SO_REUSEPORT group, each
+ * connection is dispatched to a single member of the group.
  *
  */
 
@@ -53,6 +57,26 @@ public:
 
 protected:
     virtual void prepare_flow_spec() override;
+    virtual bool del_sink(sockinfo *p_sink) override;
+
+private:
+    struct syn_owner {
+        sock_addr src;
+        sockinfo *p_sink;
+        uint32_t seq; // the oldest entry of a bucket is replaced
+    };
+
+    sockinfo *select_reuseport_sink(mem_buf_desc_t *p_rx_wc_buf_desc);
+    syn_owner *find_syn_owner(const sock_addr &src, size_t flow_hash);
+    void set_syn_owner(const sock_addr &src, size_t flow_hash, sockinfo *p_sink);
+
+    bool m_b_reuseport_group;
+    uint32_t m_syn_owners_seq = 0U;
+    /* Listeners which got a SYN by SO_INCOMING_CPU, by the source address. The rest of the
+     * handshake follows the SYN. Allocated on the first such SYN, accessed under the ring
+     * rx lock as the dispatch itself.
+     */
+    std::vector<syn_owner> m_syn_owners;
 };
 
 #endif /* RFS_UC_H */
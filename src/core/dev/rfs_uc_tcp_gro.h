@@ -34,6 +34,7 @@
 #define RFS_UC_TCP_GRO_H
 
 #include "dev/rfs_uc.h"
+#include "dev/gro_mgr.h"
 #include <netinet/tcp.h>
 
 #define IP_H_LEN_NO_OPTIONS    5
@@ -56,8 +57,6 @@ struct gro_mem_buf_desc {
     uint16_t wnd;
 } typedef gro_mem_buf_desc_t;
 
-class gro_mgr;
-
 /**
  * @class rfs_uc_tcp_gro
  *
@@ -65,14 +64,14 @@ class gro_mgr;
  * This object is used for maintaining the sink list and dispatching packets
  *
  */
-class rfs_uc_tcp_gro : public rfs_uc {
+class rfs_uc_tcp_gro : public rfs_uc, public gro_stream {
 public:
     rfs_uc_tcp_gro(flow_tuple *flow_spec_5t, ring_slave *p_ring,
                    rfs_rule_filter *rule_filter = nullptr, uint32_t flow_tag_id = 0);
 
     virtual bool rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd_ready_array);
 
-    void flush(void *pv_fd_ready_array);
+    void flush(void *pv_fd_ready_array) override;
 
 private:
     inline void flush_gro_desc(void *pv_fd_ready_array);
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "utils/bullseye.h"
+#include "dev/rfs_uc_udp_gro.h"
+#include "dev/ring_simple.h"
+#include <sock/sockinfo_udp.h>
+
+#define MODULE_NAME "rfs_uc_udp_gro"
+
+#define rfs_logpanic __log_info_panic
+
+rfs_uc_udp_gro::rfs_uc_udp_gro(flow_tuple *flow_spec_5t, ring_slave *p_ring,
+                               rfs_rule_filter *rule_filter, uint32_t flow_tag_id)
+    : rfs_uc(flow_spec_5t, p_ring, rule_filter, flow_tag_id)
+    , m_b_active(false)
+    , m_b_reserved(false)
+{
+    m_p_ring_simple = dynamic_cast<ring_simple *>(p_ring);
+
+    if (!m_p_ring_simple) {
+        rfs_logpanic("Incompatible ring type");
+    }
+
+    m_p_gro_mgr = &(m_p_ring_simple->m_gro_mgr);
+    m_n_buf_max = m_p_gro_mgr->get_buf_max();
+    m_n_byte_max = m_p_gro_mgr->get_byte_max();
+    memset(&m_gro_desc, 0, sizeof(m_gro_desc));
+}
+
+bool rfs_uc_udp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info,
+                                        void *pv_fd_ready_array /* = NULL */)
+{
+    if (!m_b_active) {
+        if (!m_b_reserved && m_p_gro_mgr->is_stream_max()) {
+            goto out;
+        }
+    }
+
+    if (unlikely(!udp_check(p_rx_pkt_mem_buf_desc_info))) {
+        goto out;
+    }
+
+    if (likely(m_b_active)) {
+        if (add_packet(p_rx_pkt_mem_buf_desc_info)) {
+            /* A shorter datagram closes the chain, the same as the last segment of
+             * a UDP GSO send. Also flush immediately in case total number of
+             * aggregated packets exceeds limit
+             */
+            if (p_rx_pkt_mem_buf_desc_info->rx.sz_payload < m_gro_desc.gro_size ||
+                m_gro_desc.buf_count >= m_n_buf_max) {
+                flush_gro_desc(pv_fd_ready_array);
+            }
+            return true;
+        }
+        flush_gro_desc(pv_fd_ready_array);
+    }
+
+    if (!m_b_reserved) {
+        m_b_reserved = m_p_gro_mgr->reserve_stream(this);
+    }
+    init_gro_desc(p_rx_pkt_mem_buf_desc_info);
+    m_b_active = true;
+
+    return true;
+
+out:
+    if (likely(m_b_active)) {
+        flush_gro_desc(pv_fd_ready_array);
+    }
+
+    return rfs_uc::rx_dispatch_packet(p_rx_pkt_mem_buf_desc_info, pv_fd_ready_array);
+}
+
+bool rfs_uc_udp_gro::add_packet(mem_buf_desc_t *mem_buf_desc)
+{
+    uint32_t tot_len = m_gro_desc.tot_len + mem_buf_desc->rx.sz_payload;
+
+    /* Do not aggregate a bigger datagram, a datagram of another source or
+     * if total payload exceeds maximum value
+     */
+    if (mem_buf_desc->rx.sz_payload > m_gro_desc.gro_size || tot_len > m_n_byte_max ||
+        !(mem_buf_desc->rx.src == m_gro_desc.p_first->rx.src)) {
+        return false;
+    }
+
+    m_gro_desc.buf_count++;
+    m_gro_desc.tot_len = tot_len;
+
+    mem_buf_desc->reset_ref_count();
+    mem_buf_desc->p_next_desc = nullptr;
+
+    m_gro_desc.p_last->p_next_desc = mem_buf_desc;
+    m_gro_desc.p_last = mem_buf_desc;
+
+    return true;
+}
+
+void rfs_uc_udp_gro::flush(void *pv_fd_ready_array)
+{
+    flush_gro_desc(pv_fd_ready_array);
+    m_b_reserved = false;
+}
+
+void rfs_uc_udp_gro::flush_gro_desc(void *pv_fd_ready_array)
+{
+    if (!m_b_active) {
+        return;
+    }
+
+    mem_buf_desc_t *p_first = m_gro_desc.p_first;
+
+    // The chain is delivered the same way as a reassembled IP datagram
+    if (m_gro_desc.buf_count > 1) {
+        p_first->rx.sz_payload = m_gro_desc.tot_len;
+        p_first->rx.n_frags = static_cast<int8_t>(m_gro_desc.buf_count);
+        p_first->rx.udp.gro_size = m_gro_desc.gro_size;
+        p_first->rx.is_xlio_thr = m_gro_desc.p_last->rx.is_xlio_thr;
+    }
+
+    __log_func("Rx GRO UDP datagram info: src_port=%d, dst_port=%d, gro_size=%u, tot_len=%u, "
+               "num_bufs=%u",
+               ntohs(p_first->rx.src.get_in_port()), ntohs(p_first->rx.dst.get_in_port()),
+               m_gro_desc.gro_size, m_gro_desc.tot_len, m_gro_desc.buf_count);
+
+    cq_stats_t &cq_stats = *m_p_ring_simple->m_p_cq_mgr_rx->m_p_cq_stat;
+    cq_stats.n_rx_gro_packets++;
+    cq_stats.n_rx_gro_frags += m_gro_desc.buf_count;
+    cq_stats.n_rx_gro_bytes += m_gro_desc.tot_len;
+
+    m_b_active = false;
+
+    if (!rfs_uc::rx_dispatch_packet(p_first, pv_fd_ready_array)) {
+        m_p_ring_simple->reclaim_recv_buffers_no_lock(p_first);
+    }
+}
+
+void rfs_uc_udp_gro::init_gro_desc(mem_buf_desc_t *mem_buf_desc)
+{
+    mem_buf_desc->p_next_desc = nullptr;
+    m_gro_desc.p_first = m_gro_desc.p_last = mem_buf_desc;
+    m_gro_desc.buf_count = 1;
+    m_gro_desc.tot_len = static_cast<uint32_t>(mem_buf_desc->rx.sz_payload);
+    m_gro_desc.gro_size = static_cast<uint16_t>(mem_buf_desc->rx.sz_payload);
+}
+
+bool rfs_uc_udp_gro::udp_check(mem_buf_desc_t *mem_buf_desc)
+{
+    // IP fragments and empty datagrams are delivered as is
+    if (mem_buf_desc->rx.n_frags != 1 || mem_buf_desc->rx.sz_payload == 0 ||
+        mem_buf_desc->rx.sz_payload != mem_buf_desc->rx.frag.iov_len) {
+        return false;
+    }
+
+    // Only a single receiver which enabled UDP_GRO can take a chain
+    if (m_n_sinks_list_entries != 1 || unlikely(!m_sinks_list[0])) {
+        return false;
+    }
+
+    return static_cast<sockinfo_udp *>(m_sinks_list[0])->is_udp_gro();
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RFS_UC_UDP_GRO_H
+#define RFS_UC_UDP_GRO_H
+
+#include "dev/rfs_uc.h"
+#include "dev/gro_mgr.h"
+
+struct udp_gro_desc {
+    mem_buf_desc_t *p_first;
+    mem_buf_desc_t *p_last;
+    uint32_t buf_count;
+    uint32_t tot_len;
+    uint16_t gro_size;
+} typedef udp_gro_desc_t;
+
+/**
+ * @class rfs_uc_udp_gro
+ *
+ * Object to manages the sink list of a UC UDP GRO flow
+ * Consecutive datagrams of the same source and the same size are chained into a
+ * single delivery for sockets that enabled UDP_GRO. The chain is closed by a
+ * shorter datagram or at the end of the CQ poll.
+ *
+ */
+class rfs_uc_udp_gro : public rfs_uc, public gro_stream {
+public:
+    rfs_uc_udp_gro(flow_tuple *flow_spec_5t, ring_slave *p_ring,
+                   rfs_rule_filter *rule_filter = nullptr, uint32_t flow_tag_id = 0);
+
+    virtual bool rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc,
+                                    void *pv_fd_ready_array) override;
+
+    void flush(void *pv_fd_ready_array) override;
+
+private:
+    inline void flush_gro_desc(void *pv_fd_ready_array);
+    inline bool add_packet(mem_buf_desc_t *mem_buf_desc);
+    inline void init_gro_desc(mem_buf_desc_t *mem_buf_desc);
+    inline bool udp_check(mem_buf_desc_t *mem_buf_desc);
+
+    gro_mgr *m_p_gro_mgr;
+    ring_simple *m_p_ring_simple;
+    bool m_b_active;
+    bool m_b_reserved;
+    struct udp_gro_desc m_gro_desc;
+    uint32_t m_n_buf_max;
+    uint32_t m_n_byte_max;
+};
+
+#endif /* RFS_UC_UDP_GRO_H */
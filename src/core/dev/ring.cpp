@@ -126,7 +126,10 @@ static inline void put_obj_list(cached_obj_pool<T> *obj_pool, T *&obj_list_to, T
 
     obj_list_from->next = obj_temp;
     if (unlikely(++obj_count > return_treshold)) {
-        obj_pool->put_objs(obj_pool->split_obj_list(obj_count / 2, obj_list_to, obj_count));
+        uint32_t count = obj_count / 2;
+        T *tail = nullptr;
+        T *head = obj_pool->split_obj_list(count, obj_list_to, obj_count, &tail);
+        obj_pool->put_obj_list(head, tail, count);
     }
 }
 
@@ -37,6 +37,7 @@
 #include "ib/base/verbs_extra.h"
 #include "dev/buffer_pool.h"
 #include "dev/xlio_ti.h"
+#include "dev/txtime_queue.h"
 #include "proto/flow_tuple.h"
 #include "proto/xlio_lwip.h"
 #include "proto/L2_address.h"
@@ -100,6 +101,14 @@ public:
                                   xlio_wr_tx_packet_attr attr) = 0;
     virtual int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
                                  xlio_wr_tx_packet_attr attr, xlio_tis *tis) = 0;
+    // Sends the buffer at its launch time (SO_TXTIME), rings without a queue send it immediately
+    virtual void send_ring_buffer_at(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                     xlio_wr_tx_packet_attr attr, const xlio_txtime &txtime)
+    {
+        NOT_IN_USE(txtime);
+        send_ring_buffer(id, p_send_wqe,
+                         (xlio_wr_tx_packet_attr)(attr & ~XLIO_TX_PACKET_TXTIME));
+    }
 
     virtual int get_num_resources() const = 0;
     virtual int *get_rx_channel_fds(size_t &length) const
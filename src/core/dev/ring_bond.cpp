@@ -441,6 +441,28 @@ void ring_bond::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe
     }
 }
 
+void ring_bond::send_ring_buffer_at(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                    xlio_wr_tx_packet_attr attr, const xlio_txtime &txtime)
+{
+    mem_buf_desc_t *p_mem_buf_desc = (mem_buf_desc_t *)(p_send_wqe->wr_id);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    if (is_active_member(p_mem_buf_desc->p_desc_owner, id)) {
+        // The launch time queue belongs to the slave which owns the buffer
+        m_xmit_rings[id]->send_ring_buffer_at(id, p_send_wqe, attr, txtime);
+    } else {
+        ring_logfunc("active ring=%p, silent packet drop (%p), (HA event?)", m_xmit_rings[id],
+                     p_mem_buf_desc);
+        p_mem_buf_desc->p_next_desc = nullptr;
+        if (likely(p_mem_buf_desc->p_desc_owner == m_bond_rings[id])) {
+            m_bond_rings[id]->mem_buf_tx_release(p_mem_buf_desc, true);
+        } else {
+            mem_buf_tx_release(p_mem_buf_desc, true);
+        }
+    }
+}
+
 int ring_bond::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
                                 xlio_wr_tx_packet_attr attr, xlio_tis *tis)
 {
@@ -35,6 +35,7 @@
 
 #include "util/valgrind.h"
 #include "util/sg_array.h"
+#include "util/instrumentation.h"
 #include "sock/fd_collection.h"
 
 #undef MODULE_NAME
@@ -120,6 +121,20 @@ ring_simple::ring_simple(int if_index, ring *parent, ring_type_t type, bool use_
     m_mtu = p_ndev->get_mtu();
 
     memset(&m_cq_moderation_info, 0, sizeof(m_cq_moderation_info));
+    if (safe_mce_sys().cq_aim_interval_msec != MCE_CQ_ADAPTIVE_MODERATION_DISABLED) {
+        cq_moderation_config config;
+        config.defaults.period = safe_mce_sys().cq_moderation_period_usec;
+        config.defaults.count = safe_mce_sys().cq_moderation_count;
+        config.max_period = safe_mce_sys().cq_aim_max_period_usec;
+        config.max_count = safe_mce_sys().cq_aim_max_count;
+        config.interrupts_rate_per_sec = safe_mce_sys().cq_aim_interrupts_rate_per_sec;
+        config.latency_target_usec = safe_mce_sys().cq_aim_latency_target_usec;
+        m_p_cq_moderation_policy.reset(cq_moderation_policy::create(
+            safe_mce_sys().cq_aim_policy == option_cq_aim_policy::CQ_AIM_AIMD
+                ? CQ_MODERATION_POLICY_AIMD
+                : CQ_MODERATION_POLICY_RATE,
+            config));
+    }
     memset(&m_tso, 0, sizeof(m_tso));
 #ifdef DEFINED_UTLS
     memset(&m_tls, 0, sizeof(m_tls));
@@ -137,6 +152,8 @@ ring_simple::~ring_simple()
     flow_del_all_rfs();
     m_lock_ring_rx.unlock();
 
+    txtime_flush();
+
     // Allow last few post sends to be sent by HCA.
     // Was done in order to allow iperf's FIN packet to be sent.
     usleep(25000);
@@ -419,15 +436,22 @@ int ring_simple::poll_and_process_element_rx(uint64_t *p_cq_poll_sn,
                                              void *pv_fd_ready_array /*NULL*/)
 {
     int ret = 0;
+    tscval_t trace_tsc = trace_start();
+    txtime_poll();
     RING_TRY_LOCK_RUN_AND_UPDATE_RET(
         m_lock_ring_rx,
         m_p_cq_mgr_rx->poll_and_process_element_rx(p_cq_poll_sn, pv_fd_ready_array));
+    if (ret > 0) {
+        ++m_cq_moderation_info.batches;
+        trace_event(TRACE_CQ_POLL, trace_tsc, ret);
+    }
     return ret;
 }
 
 int ring_simple::poll_and_process_element_tx(uint64_t *p_cq_poll_sn)
 {
     int ret = 0;
+    txtime_poll();
     RING_TRY_LOCK_RUN_AND_UPDATE_RET(m_lock_ring_tx,
                                      m_p_cq_mgr_tx->poll_and_process_element_tx(p_cq_poll_sn));
     return ret;
@@ -493,6 +517,9 @@ int ring_simple::wait_for_notification_and_process_element(int cq_channel_fd,
                                          m_p_cq_mgr_rx->wait_for_notification_and_process_element(
                                              p_cq_poll_sn, pv_fd_ready_array);
                                          ++m_p_ring_stat->simple.n_rx_interrupt_received);
+        if (ret > 0) {
+            ++m_cq_moderation_info.batches;
+        }
     } else {
         ring_logerr("Can't find rx_cq for the rx_comp_event_channel_fd (= %d)", cq_channel_fd);
     }
@@ -567,6 +594,7 @@ void ring_simple::mem_buf_desc_return_single_locked(mem_buf_desc_t *buff)
 int ring_simple::drain_and_proccess()
 {
     int ret = 0;
+    txtime_poll();
     RING_TRY_LOCK_RUN_AND_UPDATE_RET(m_lock_ring_rx, m_p_cq_mgr_rx->drain_and_proccess());
     return ret;
 }
@@ -781,6 +809,9 @@ bool ring_simple::is_available_qp_wr(bool b_block, unsigned credits)
 
     // TODO credits_get() does TX polling. Call current method only for bocking mode?
 
+    // The completions which free the SQ may wait for a deferred doorbell
+    m_hqtx->ring_pending_doorbell();
+
     do {
         // Try to poll once in the hope that we get space in SQ
         ret = m_p_cq_mgr_tx->poll_and_process_element_tx(&poll_sn);
@@ -1036,56 +1067,43 @@ void ring_simple::modify_cq_moderation(uint32_t period, uint32_t count)
 
 void ring_simple::adapt_cq_moderation()
 {
+    if (!m_p_cq_moderation_policy) {
+        return;
+    }
+
     if (m_lock_ring_rx.trylock()) {
         ++m_cq_moderation_info.missed_rounds;
         return; // todo try again sooner?
     }
 
-    uint32_t missed_rounds = m_cq_moderation_info.missed_rounds;
-
-    // todo collect bytes and packets from all rings ??
     int64_t interval_bytes = m_cq_moderation_info.bytes - m_cq_moderation_info.prev_bytes;
     int64_t interval_packets = m_cq_moderation_info.packets - m_cq_moderation_info.prev_packets;
+    int64_t interval_batches = m_cq_moderation_info.batches - m_cq_moderation_info.prev_batches;
+    uint32_t missed_rounds = m_cq_moderation_info.missed_rounds;
 
     m_cq_moderation_info.prev_bytes = m_cq_moderation_info.bytes;
     m_cq_moderation_info.prev_packets = m_cq_moderation_info.packets;
+    m_cq_moderation_info.prev_batches = m_cq_moderation_info.batches;
     m_cq_moderation_info.missed_rounds = 0;
 
     BULLSEYE_EXCLUDE_BLOCK_START
-    if (interval_bytes < 0 || interval_packets < 0) {
+    if (interval_bytes < 0 || interval_packets < 0 || interval_batches < 0) {
         // rare wrap-around of 64 bit, just ignore
         m_lock_ring_rx.unlock();
         return;
     }
     BULLSEYE_EXCLUDE_BLOCK_END
 
-    if (interval_packets == 0) {
-        // todo if no traffic, set moderation to default?
-        modify_cq_moderation(safe_mce_sys().cq_moderation_period_usec,
-                             safe_mce_sys().cq_moderation_count);
-        m_lock_ring_rx.unlock();
-        return;
-    }
+    // The policy sees the activity of this ring only, bond slaves adapt independently
+    cq_moderation_sample sample;
+    sample.bytes = interval_bytes;
+    sample.packets = interval_packets;
+    sample.batches = interval_batches;
+    sample.interval_usec =
+        (uint64_t)safe_mce_sys().cq_aim_interval_msec * 1000U * (1 + missed_rounds);
 
-    uint32_t avg_packet_size = interval_bytes / interval_packets;
-    uint32_t avg_packet_rate =
-        (interval_packets * 1000) / (safe_mce_sys().cq_aim_interval_msec * (1 + missed_rounds));
-
-    uint32_t ir_rate = safe_mce_sys().cq_aim_interrupts_rate_per_sec;
-
-    uint32_t count = std::min(avg_packet_rate / ir_rate, safe_mce_sys().cq_aim_max_count);
-    uint32_t period = std::min<uint32_t>(
-        safe_mce_sys().cq_aim_max_period_usec,
-        ((1000000UL / ir_rate) - (1000000UL / std::max(avg_packet_rate, ir_rate))));
-
-    if (avg_packet_size < 1024 && avg_packet_rate < 450000) {
-        modify_cq_moderation(0, 0); // latency mode
-        // todo latency for big messages is not good
-        // the rate is affected by the moderation and the moderation by the rate..
-        // so each cycle change from 0 to max, and max to 0, ..
-    } else {
-        modify_cq_moderation(period, count); // throughput mode
-    }
+    cq_moderation_params params = m_p_cq_moderation_policy->update(sample);
+    modify_cq_moderation(params.period, params.count);
 
     m_lock_ring_rx.unlock();
 }
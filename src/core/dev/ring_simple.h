@@ -35,10 +35,12 @@
 
 #include "ring_slave.h"
 
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
 #include "dev/gro_mgr.h"
+#include "dev/cq_moderation_policy.h"
 #include "dev/hw_queue_tx.h"
 #include "dev/hw_queue_rx.h"
 #include "dev/net_device_table_mgr.h"
@@ -48,8 +50,10 @@ struct cq_moderation_info {
     uint32_t count;
     uint64_t packets;
     uint64_t bytes;
+    uint64_t batches;
     uint64_t prev_packets;
     uint64_t prev_bytes;
+    uint64_t prev_batches;
     uint32_t missed_rounds;
 };
 
@@ -296,6 +300,7 @@ public:
     friend class rfs;
     friend class rfs_uc;
     friend class rfs_uc_tcp_gro;
+    friend class rfs_uc_udp_gro;
     friend class rfs_mc;
     friend class ring_bond;
 
@@ -333,6 +338,7 @@ protected:
     hw_queue_tx *m_hqtx = nullptr;
     hw_queue_rx *m_hqrx = nullptr;
     struct cq_moderation_info m_cq_moderation_info;
+    std::unique_ptr<cq_moderation_policy> m_p_cq_moderation_policy;
     cq_mgr_rx *m_p_cq_mgr_rx = nullptr;
     cq_mgr_tx *m_p_cq_mgr_tx = nullptr;
     std::unordered_map<void *, uint32_t> m_user_lkey_map;
@@ -36,14 +36,20 @@
 #include "proto/ip_frag.h"
 #include "dev/rfs_mc.h"
 #include "dev/rfs_uc_tcp_gro.h"
+#include "dev/rfs_uc_udp_gro.h"
 #include "sock/fd_collection.h"
 #include "sock/sockinfo.h"
+#include "event/event_handler_manager.h"
+#include "util/instrumentation.h"
 
 #undef MODULE_NAME
 #define MODULE_NAME "ring_slave"
 #undef MODULE_HDR
 #define MODULE_HDR MODULE_NAME "%d:%s() "
 
+// Period of the SO_TXTIME queue release by the internal thread
+#define TXTIME_TIMER_MSEC 1
+
 // AF_INET address 0.0.0.0:0, used for 3T flow spec keys.
 static const sock_addr s_sock_addrany;
 
@@ -62,11 +68,17 @@ ring_slave::ring_slave(int if_index, ring *parent, ring_type_t type, bool use_lo
     , m_steering_ipv6(*this)
     , m_lock_ring_rx(get_new_lock("ring_slave:lock_rx", use_locks))
     , m_lock_ring_tx(get_new_lock("ring_slave:lock_tx", use_locks))
-    , m_p_ring_stat(new ring_stats_t)
+    , m_ring_stat_local(new ring_stats_t)
+    , m_p_ring_stat(m_ring_stat_local.get())
     , m_vlan(0)
     , m_flow_tag_enabled(false)
     , m_b_sysvar_eth_mc_l2_only_rules(safe_mce_sys().eth_mc_l2_only_rules)
     , m_b_sysvar_mc_force_flowtag(safe_mce_sys().mc_force_flowtag)
+    , m_lock_txtime(get_new_lock("ring_slave:lock_txtime", use_locks))
+    , m_b_txtime_pending(false)
+    , m_txtime_drop_late_nsec((uint64_t)safe_mce_sys().tx_txtime_drop_late_usec * 1000U)
+    , m_b_txtime_timer(use_locks)
+    , m_txtime_timer_handle(nullptr)
     , m_type(type)
 {
     net_device_val *p_ndev = nullptr;
@@ -94,7 +106,7 @@ ring_slave::ring_slave(int if_index, ring *parent, ring_type_t type, bool use_lo
     m_active = p_slave ? p_slave->active : p_ndev->get_slave_array().empty();
 
     // use local copy of stats by default
-    memset(m_p_ring_stat.get(), 0, sizeof(ring_stats_t));
+    memset(m_p_ring_stat, 0, sizeof(ring_stats_t));
     m_p_ring_stat->n_type = m_type;
     if (m_parent != this) {
         m_p_ring_stat->p_ring_master = m_parent;
@@ -103,7 +115,7 @@ ring_slave::ring_slave(int if_index, ring *parent, ring_type_t type, bool use_lo
     m_tx_pool.set_id("ring_slave (%p) : m_tx_pool", this);
     m_zc_pool.set_id("ring_slave (%p) : m_zc_pool", this);
 
-    xlio_stats_instance_create_ring_block(m_p_ring_stat.get());
+    m_p_ring_stat = xlio_stats_instance_create_ring_block(m_p_ring_stat);
 
     print_val();
 }
@@ -113,7 +125,7 @@ ring_slave::~ring_slave()
     print_val();
 
     if (m_p_ring_stat) {
-        xlio_stats_instance_remove_ring_block(m_p_ring_stat.get());
+        m_p_ring_stat = xlio_stats_instance_remove_ring_block(m_p_ring_stat);
     }
 
     /* Release TX buffer poll */
@@ -159,6 +171,108 @@ void ring_slave::inc_tx_retransmissions_stats(ring_user_id_t)
     m_p_ring_stat->n_tx_retransmits++;
 }
 
+void ring_slave::send_ring_buffer_at(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                     xlio_wr_tx_packet_attr attr, const xlio_txtime &txtime)
+{
+    // Packets which leave from the queue one by one ring their own doorbell
+    attr = (xlio_wr_tx_packet_attr)(attr & ~(XLIO_TX_PACKET_TXTIME | XLIO_TX_PACKET_MORE));
+
+    // Sockets may use different clocks, the queue keeps all the launch times in CLOCK_MONOTONIC
+    uint64_t now = txtime_clock_now(CLOCK_MONOTONIC);
+    int64_t delay = (int64_t)(txtime.time_ns -
+                              (txtime.clockid == CLOCK_MONOTONIC ? now
+                                                                 : txtime_clock_now(txtime.clockid)));
+
+    if (delay <= 0 || txtime.deadline_mode) {
+        if (m_txtime_drop_late_nsec && delay < 0 && (uint64_t)(-delay) > m_txtime_drop_late_nsec) {
+            txtime_drop((mem_buf_desc_t *)p_send_wqe->wr_id);
+            return;
+        }
+        // Queued packets which are due leave first
+        txtime_poll();
+        send_ring_buffer(id, p_send_wqe, attr);
+        return;
+    }
+
+    if (unlikely(p_send_wqe->num_sge > (int)(sizeof(txtime_wqe::sge) / sizeof(ibv_sge)))) {
+        ring_logdbg("SO_TXTIME is not supported for %d sges, sending now", p_send_wqe->num_sge);
+        send_ring_buffer(id, p_send_wqe, attr);
+        return;
+    }
+
+    // The TX path releases the packets which are due as well
+    txtime_poll();
+
+    txtime_wqe entry;
+    entry.id = id;
+    entry.attr = attr;
+    entry.wqe = *p_send_wqe;
+    entry.wqe.next = nullptr;
+    entry.wqe.sg_list = nullptr; // Points to the copied sges when the entry is released
+    memcpy(entry.sge, p_send_wqe->sg_list, p_send_wqe->num_sge * sizeof(ibv_sge));
+
+    m_lock_txtime.lock();
+    m_txtime_queue.push(now + (uint64_t)delay, entry);
+    m_b_txtime_pending.store(true, std::memory_order_release);
+    if (m_b_txtime_timer && !m_txtime_timer_handle && g_p_event_handler_manager) {
+        m_txtime_timer_handle = g_p_event_handler_manager->register_timer_event(
+            TXTIME_TIMER_MSEC, this, PERIODIC_TIMER, nullptr);
+    }
+    m_lock_txtime.unlock();
+    m_p_ring_stat->n_tx_txtime_queued++;
+}
+
+void ring_slave::txtime_release(bool flush)
+{
+    if (flush) {
+        m_lock_txtime.lock();
+    } else if (m_lock_txtime.trylock()) {
+        // Another thread is releasing the queue
+        return;
+    }
+
+    uint64_t now = flush ? UINT64_MAX : txtime_clock_now(CLOCK_MONOTONIC);
+    uint64_t txtime;
+    txtime_wqe entry;
+
+    while (m_txtime_queue.pop_expired(now, txtime, entry)) {
+        // Released late when the application did not poll XLIO in time
+        if (flush || (m_txtime_drop_late_nsec && now - txtime > m_txtime_drop_late_nsec)) {
+            txtime_drop((mem_buf_desc_t *)entry.wqe.wr_id);
+            continue;
+        }
+        entry.wqe.sg_list = entry.sge;
+        send_ring_buffer(entry.id, &entry.wqe, entry.attr);
+    }
+    m_b_txtime_pending.store(!m_txtime_queue.empty(), std::memory_order_release);
+
+    m_lock_txtime.unlock();
+}
+
+void ring_slave::txtime_flush()
+{
+    // The timer must not release the queue of a ring which is being destroyed
+    if (m_txtime_timer_handle) {
+        g_p_event_handler_manager->unregister_timer_event(this, m_txtime_timer_handle);
+        m_txtime_timer_handle = nullptr;
+    }
+    txtime_release(true);
+}
+
+void ring_slave::handle_timer_expired(void *user_data)
+{
+    NOT_IN_USE(user_data);
+    txtime_poll();
+}
+
+void ring_slave::txtime_drop(mem_buf_desc_t *p_mem_buf_desc)
+{
+    ring_logfunc("SO_TXTIME launch time missed, dropping buffer %p", p_mem_buf_desc);
+    p_mem_buf_desc->p_next_desc = nullptr;
+    mem_buf_tx_release(p_mem_buf_desc, true);
+    m_p_ring_stat->n_tx_txtime_dropped++;
+}
+
 template <typename KEY4T, typename KEY2T, typename HDR>
 bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t, sockinfo *sink,
                                                       bool force_5t)
@@ -205,6 +319,14 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
                         si);
         }
 
+        // The flow tag fast path bypasses the rfs, so UDP GRO flows must not use it
+        bool udp_gro = safe_mce_sys().udp_gro && safe_mce_sys().gro_streams_max &&
+            m_ring.is_simple();
+        if (flow_tag_id && udp_gro) {
+            flow_tag_id = FLOW_TAG_MASK;
+            ring_logdbg("UC flow tag for socketinfo=%p is disabled: UDP GRO is enabled", si);
+        }
+
         auto itr = m_flow_udp_uc_map.find(rfs_key);
         if (itr == end(m_flow_udp_uc_map)) {
             // No rfs object exists so a new one must be created and inserted in the flow map
@@ -216,8 +338,13 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
                     new rfs_rule_filter(m_ring.m_udp_uc_dst_port_attach_map, rule_key, udp_3t_only);
             }
             try {
-                p_tmp_rfs =
-                    new (std::nothrow) rfs_uc(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                if (udp_gro) {
+                    p_tmp_rfs = new (std::nothrow)
+                        rfs_uc_udp_gro(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                } else {
+                    p_tmp_rfs = new (std::nothrow)
+                        rfs_uc(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                }
             } catch (xlio_exception &e) {
                 ring_logerr("%s", e.message);
                 return false;
@@ -587,6 +714,7 @@ bool ring_slave::rx_process_buffer(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd
     }
 
     inc_cq_moderation_stats(sz_data);
+    p_rx_wc_buf_desc->rx.poll_tsc = lat_stats_start();
 
     m_p_ring_stat->n_rx_byte_count += sz_data;
     ++m_p_ring_stat->n_rx_pkt_count;
@@ -680,6 +808,7 @@ bool ring_slave::rx_process_buffer(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd
                 p_rx_wc_buf_desc->rx.sz_payload = ntohs(p_udp_h->len) - sizeof(struct udphdr);
 
                 p_rx_wc_buf_desc->rx.udp.ifindex = m_parent->get_if_index();
+                p_rx_wc_buf_desc->rx.udp.gro_size = 0U;
                 p_rx_wc_buf_desc->rx.n_frags = 1;
 
                 ring_logfunc("FAST PATH Rx UDP datagram info: src_port=%d, dst_port=%d, "
@@ -1025,6 +1154,7 @@ bool steering_handler<KEY4T, KEY2T, HDR>::rx_process_buffer_no_flow_id(
 
         // Update the protocol info
         p_rx_wc_buf_desc->rx.udp.ifindex = m_ring.m_parent->get_if_index();
+        p_rx_wc_buf_desc->rx.udp.gro_size = 0U;
 
         // Find the relevant hash map and pass the packet to the rfs for dispatching
         if (!p_rx_wc_buf_desc->rx.dst.is_mc()) { // This is UDP UC packet
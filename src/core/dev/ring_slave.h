@@ -34,7 +34,9 @@
 #define RING_SLAVE_H_
 
 #include "ring.h"
+#include <atomic>
 #include <memory>
+#include "event/timer_handler.h"
 #include "dev/net_device_table_mgr.h"
 #include "util/sock_addr.h"
 
@@ -271,7 +273,7 @@ private:
     ring_slave &m_ring;
 };
 
-class ring_slave : public ring {
+class ring_slave : public ring, public timer_handler {
 public:
     ring_slave(int if_index, ring *parent, ring_type_t type, bool use_locks);
     virtual ~ring_slave();
@@ -295,12 +297,16 @@ public:
     virtual bool attach_flow(flow_tuple &flow_spec_5t, sockinfo *sink, bool force_5t = false);
     virtual bool detach_flow(flow_tuple &flow_spec_5t, sockinfo *sink);
 
+    virtual void send_ring_buffer_at(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                     xlio_wr_tx_packet_attr attr, const xlio_txtime &txtime);
+    void handle_timer_expired(void *user_data) override;
+
 #ifdef DEFINED_UTLS
     /* Call this method in an RX ring. */
     rfs_rule *tls_rx_create_rule(const flow_tuple &flow_spec_5t, xlio_tir *tir);
 #endif /* DEFINED_UTLS */
 
-    inline bool is_simple() const { return m_type != RING_TAP; }
+    inline bool is_simple() const { return m_type == RING_ETH; }
     transport_type_t get_transport_type() const { return m_transport_type; }
     inline ring_type_t get_type() const { return m_type; }
 
@@ -310,6 +316,17 @@ protected:
     bool request_more_tx_buffers(pbuf_type type, uint32_t count, uint32_t lkey);
     void flow_del_all_rfs();
 
+    // Sends the SO_TXTIME packets whose launch time has come, called from the RX and TX polling
+    // paths and from the internal thread timer
+    inline void txtime_poll()
+    {
+        if (unlikely(m_b_txtime_pending.load(std::memory_order_acquire))) {
+            txtime_release(false);
+        }
+    }
+    // Drops the packets which are still queued, called before the send queue is destroyed
+    void txtime_flush();
+
     steering_handler<flow_spec_4t_key_ipv4, flow_spec_2t_key_ipv4, iphdr> m_steering_ipv4;
     steering_handler<flow_spec_4t_key_ipv6, flow_spec_2t_key_ipv6, ip6_hdr> m_steering_ipv6;
 
@@ -327,15 +344,35 @@ protected:
     descq_t m_tx_pool;
     descq_t m_zc_pool;
     transport_type_t m_transport_type; /* transport ETH/IB */
-    std::unique_ptr<ring_stats_t> m_p_ring_stat;
+    std::unique_ptr<ring_stats_t> m_ring_stat_local;
+    ring_stats_t *m_p_ring_stat; /* shared memory block or the local one */
     uint16_t m_vlan;
     bool m_flow_tag_enabled;
     const bool m_b_sysvar_eth_mc_l2_only_rules;
     const bool m_b_sysvar_mc_force_flowtag;
 
+    // Buffers held until their launch time, the send request is copied with its sges
+    struct txtime_wqe {
+        ring_user_id_t id;
+        xlio_wr_tx_packet_attr attr;
+        xlio_ibv_send_wr wqe;
+        ibv_sge sge[2];
+    };
+    multilock m_lock_txtime;
+    txtime_queue<txtime_wqe> m_txtime_queue; // Launch times in CLOCK_MONOTONIC
+    std::atomic<bool> m_b_txtime_pending;
+    const uint64_t m_txtime_drop_late_nsec;
+    // Releases the queue when the application does not poll, only a locked ring is shared with
+    // the internal thread
+    const bool m_b_txtime_timer;
+    void *m_txtime_timer_handle;
+
     template <typename KEY4T, typename KEY2T, typename HDR> friend class steering_handler;
 
 private:
+    void txtime_release(bool flush);
+    void txtime_drop(mem_buf_desc_t *p_mem_buf_desc);
+
     ring_type_t m_type; /* ring type */
 };
 
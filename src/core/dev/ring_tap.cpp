@@ -92,6 +92,8 @@ ring_tap::~ring_tap()
     flow_del_all_rfs();
     m_lock_ring_rx.unlock();
 
+    txtime_flush();
+
     g_p_event_handler_manager->update_epfd(m_tap_fd, EPOLL_CTL_DEL,
                                            EPOLLIN | EPOLLPRI | EPOLLONESHOT);
 
@@ -276,6 +278,7 @@ bool ring_tap::detach_flow(flow_tuple &flow_spec_5t, sockinfo *sink)
 
 int ring_tap::poll_and_process_element_rx(uint64_t *, void *pv_fd_ready_array)
 {
+    txtime_poll();
     return process_element_rx(pv_fd_ready_array);
 }
 
@@ -286,6 +289,7 @@ int ring_tap::wait_for_notification_and_process_element(int, uint64_t *, void *p
 
 int ring_tap::drain_and_proccess()
 {
+    txtime_poll();
     return process_element_rx(nullptr);
 }
 
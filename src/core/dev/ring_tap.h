@@ -48,6 +48,7 @@ public:
     virtual int poll_and_process_element_tx(uint64_t *p_cq_poll_sn)
     {
         NOT_IN_USE(p_cq_poll_sn);
+        txtime_poll();
         return 0;
     }
     virtual int wait_for_notification_and_process_element(int cq_channel_fd, uint64_t *p_cq_poll_sn,
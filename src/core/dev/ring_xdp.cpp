@@ -0,0 +1,1080 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ring_xdp.h"
+
+#ifdef DEFINED_XDP
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/rtnetlink.h>
+#include <netinet/ip.h>
+#include <net/ethernet.h>
+
+#include "util/sg_array.h"
+#include "util/utils.h"
+#include "util/instrumentation.h"
+#include "dev/allocator.h"
+#include "sock/fd_collection.h"
+
+#undef MODULE_NAME
+#define MODULE_NAME "ring_xdp"
+#undef MODULE_HDR
+#define MODULE_HDR MODULE_NAME "%d:%s() "
+
+/* AF_XDP supports 2KB and 4KB chunks in aligned mode, 4KB covers jumbo-less MTUs */
+#define XDP_FRAME_SIZE    4096U
+#define XDP_FLOW_MAP_SIZE 16384U
+#define XDP_XSK_MAP_SIZE  64U
+
+/*
+ * Minimal BPF assembler with forward labels, enough to build the steering program
+ * without a dependency on libbpf or clang at build time.
+ */
+class xdp_prog_builder {
+public:
+    void emit(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm)
+    {
+        struct bpf_insn insn;
+
+        memset(&insn, 0, sizeof(insn));
+        insn.code = code;
+        insn.dst_reg = dst;
+        insn.src_reg = src;
+        insn.off = off;
+        insn.imm = imm;
+        m_insns.push_back(insn);
+    }
+    void mov_reg(uint8_t dst, uint8_t src) { emit(BPF_ALU64 | BPF_MOV | BPF_X, dst, src, 0, 0); }
+    void mov_imm(uint8_t dst, int32_t imm) { emit(BPF_ALU64 | BPF_MOV | BPF_K, dst, 0, 0, imm); }
+    void alu_reg(uint8_t op, uint8_t dst, uint8_t src)
+    {
+        emit(BPF_ALU64 | op | BPF_X, dst, src, 0, 0);
+    }
+    void alu_imm(uint8_t op, uint8_t dst, int32_t imm)
+    {
+        emit(BPF_ALU64 | op | BPF_K, dst, 0, 0, imm);
+    }
+    void ldx(uint8_t size, uint8_t dst, uint8_t src, int16_t off)
+    {
+        emit(BPF_LDX | BPF_MEM | size, dst, src, off, 0);
+    }
+    void stx(uint8_t size, uint8_t dst, uint8_t src, int16_t off)
+    {
+        emit(BPF_STX | BPF_MEM | size, dst, src, off, 0);
+    }
+    void st(uint8_t size, uint8_t dst, int16_t off, int32_t imm)
+    {
+        emit(BPF_ST | BPF_MEM | size, dst, 0, off, imm);
+    }
+    void ld_map_fd(uint8_t dst, int fd)
+    {
+        emit(BPF_LD | BPF_DW | BPF_IMM, dst, BPF_PSEUDO_MAP_FD, 0, fd);
+        emit(0, 0, 0, 0, 0);
+    }
+    void call(int32_t func) { emit(BPF_JMP | BPF_CALL, 0, 0, 0, func); }
+    void exit() { emit(BPF_JMP | BPF_EXIT, 0, 0, 0, 0); }
+    void jmp_imm(uint8_t op, uint8_t dst, int32_t imm, int label)
+    {
+        m_fixups.push_back(std::make_pair(m_insns.size(), label));
+        emit(BPF_JMP | op | BPF_K, dst, 0, 0, imm);
+    }
+    void jmp_reg(uint8_t op, uint8_t dst, uint8_t src, int label)
+    {
+        m_fixups.push_back(std::make_pair(m_insns.size(), label));
+        emit(BPF_JMP | op | BPF_X, dst, src, 0, 0);
+    }
+    void label(int label) { m_labels[label] = m_insns.size(); }
+
+    const std::vector<struct bpf_insn> &finalize()
+    {
+        for (auto &fixup : m_fixups) {
+            m_insns[fixup.first].off = (int16_t)(m_labels[fixup.second] - (fixup.first + 1));
+        }
+        m_fixups.clear();
+        return m_insns;
+    }
+
+private:
+    std::vector<struct bpf_insn> m_insns;
+    std::vector<std::pair<size_t, int>> m_fixups;
+    std::unordered_map<int, size_t> m_labels;
+};
+
+static inline uint64_t ptr_to_u64(const void *ptr)
+{
+    return (uint64_t)(uintptr_t)ptr;
+}
+
+static int sys_bpf(int cmd, union bpf_attr *attr)
+{
+    return (int)syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int bpf_map_create(uint32_t map_type, uint32_t key_size, uint32_t value_size,
+                          uint32_t max_entries)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = map_type;
+    attr.key_size = key_size;
+    attr.value_size = value_size;
+    attr.max_entries = max_entries;
+    return sys_bpf(BPF_MAP_CREATE, &attr);
+}
+
+static int bpf_map_update(int fd, const void *key, const void *value)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = fd;
+    attr.key = ptr_to_u64(key);
+    attr.value = ptr_to_u64(value);
+    attr.flags = BPF_ANY;
+    return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+static int bpf_map_delete(int fd, const void *key)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = fd;
+    attr.key = ptr_to_u64(key);
+    return sys_bpf(BPF_MAP_DELETE_ELEM, &attr);
+}
+
+static int bpf_prog_load_xdp(const std::vector<struct bpf_insn> &insns, char *log, size_t log_sz)
+{
+    static const char license[] = "Dual BSD/GPL";
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = ptr_to_u64(insns.data());
+    attr.insn_cnt = (uint32_t)insns.size();
+    attr.license = ptr_to_u64(license);
+    if (log && log_sz) {
+        attr.log_buf = ptr_to_u64(log);
+        attr.log_size = (uint32_t)log_sz;
+        attr.log_level = 1;
+    }
+    return sys_bpf(BPF_PROG_LOAD, &attr);
+}
+
+/* Attach (prog_fd >= 0) or detach (prog_fd == -1) XDP program using RTM_SETLINK */
+static int xdp_link_set(int if_index, int prog_fd, uint32_t flags)
+{
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifi;
+        char attrbuf[64];
+    } req;
+    struct rtattr *nest, *attr;
+    char buf[512];
+    int fd, rc;
+
+    memset(&req, 0, sizeof(req));
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    req.nh.nlmsg_type = RTM_SETLINK;
+    req.ifi.ifi_family = AF_UNSPEC;
+    req.ifi.ifi_index = if_index;
+
+    nest = (struct rtattr *)((char *)&req + NLMSG_ALIGN(req.nh.nlmsg_len));
+    nest->rta_type = NLA_F_NESTED | IFLA_XDP;
+    nest->rta_len = RTA_LENGTH(0);
+
+    attr = (struct rtattr *)((char *)nest + nest->rta_len);
+    attr->rta_type = IFLA_XDP_FD;
+    attr->rta_len = RTA_LENGTH(sizeof(int));
+    memcpy(RTA_DATA(attr), &prog_fd, sizeof(int));
+    nest->rta_len += RTA_ALIGN(attr->rta_len);
+
+    if (flags) {
+        attr = (struct rtattr *)((char *)nest + nest->rta_len);
+        attr->rta_type = IFLA_XDP_FLAGS;
+        attr->rta_len = RTA_LENGTH(sizeof(uint32_t));
+        memcpy(RTA_DATA(attr), &flags, sizeof(uint32_t));
+        nest->rta_len += RTA_ALIGN(attr->rta_len);
+    }
+    req.nh.nlmsg_len += RTA_ALIGN(nest->rta_len);
+
+    fd = SYSCALL(socket, AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    rc = 0;
+    if (SYSCALL(send, fd, &req, req.nh.nlmsg_len, 0) < 0) {
+        rc = -errno;
+    } else {
+        ssize_t len = SYSCALL(recv, fd, buf, sizeof(buf), 0);
+        struct nlmsghdr *nh = (struct nlmsghdr *)buf;
+
+        if (len < 0) {
+            rc = -errno;
+        } else if (NLMSG_OK(nh, (size_t)len) && nh->nlmsg_type == NLMSG_ERROR) {
+            rc = ((struct nlmsgerr *)NLMSG_DATA(nh))->error;
+        }
+    }
+
+    SYSCALL(close, fd);
+    return rc;
+}
+
+ring_xdp::ring_xdp(int if_index, ring *parent)
+    : ring_slave(if_index, parent, RING_XDP, true)
+    , m_xsk_fd(-1)
+    , m_prog_fd(-1)
+    , m_flow_map_fd(-1)
+    , m_xsk_map_fd(-1)
+    , m_xdp_flags(0)
+    , m_queue_id(safe_mce_sys().xdp_queue_id)
+    , m_sysvar_qp_compensation_level(safe_mce_sys().qp_compensation_level)
+    , m_sysvar_cq_poll_batch_max(safe_mce_sys().cq_poll_batch_max)
+    , m_frame_size(XDP_FRAME_SIZE)
+    , m_num_frames(safe_mce_sys().xdp_num_frames)
+    , m_umem(nullptr)
+    , m_umem_size(0)
+    , m_tx_outstanding(0)
+{
+    char if_name[IFNAMSIZ] = {0};
+
+    memset(&m_fill, 0, sizeof(m_fill));
+    memset(&m_comp, 0, sizeof(m_comp));
+    memset(&m_rx, 0, sizeof(m_rx));
+    memset(&m_tx, 0, sizeof(m_tx));
+
+    if (!xsk_create() || !prog_create()) {
+        prog_destroy();
+        xsk_destroy();
+        throw_xlio_exception("AF_XDP ring creation failed");
+    }
+
+    /* XSK fd becomes readable when Rx ring is not empty */
+    m_p_n_rx_channel_fds = new int[1];
+    m_p_n_rx_channel_fds[0] = m_xsk_fd;
+    g_p_fd_collection->add_cq_channel_fd(m_xsk_fd, this);
+
+    /* Initialize RX buffer poll */
+    request_more_rx_buffers();
+    m_rx_pool.set_id("ring_xdp (%p) : m_rx_pool", this);
+
+    /* Initialize TX buffer poll */
+    request_more_tx_buffers(PBUF_RAM, m_sysvar_qp_compensation_level, 0);
+
+    /* Update ring statistics */
+    if_indextoname(get_if_index(), if_name);
+    memcpy(m_p_ring_stat->xdp.s_if_name, if_name, IFNAMSIZ);
+    m_p_ring_stat->xdp.n_xsk_fd = m_xsk_fd;
+    m_p_ring_stat->xdp.n_queue_id = m_queue_id;
+    m_p_ring_stat->xdp.n_tx_free_frames = m_tx_frames.size();
+
+    ring_logdbg("AF_XDP ring on %s queue %u (%s mode, %u frames)", if_name, m_queue_id,
+                (m_xdp_flags & XDP_FLAGS_SKB_MODE ? "generic" : "native"), m_num_frames);
+}
+
+ring_xdp::~ring_xdp()
+{
+    m_lock_ring_rx.lock();
+    flow_del_all_rfs();
+    m_flow_map.clear();
+    m_lock_ring_rx.unlock();
+
+    txtime_flush();
+
+    if (g_p_fd_collection) {
+        g_p_fd_collection->del_cq_channel_fd(m_xsk_fd, true);
+    }
+
+    /* Release RX buffer poll */
+    g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, m_rx_pool.size());
+
+    delete[] m_p_n_rx_channel_fds;
+
+    prog_destroy();
+    xsk_destroy();
+}
+
+bool ring_xdp::xsk_map_ring(xsk_ring &r, const struct xdp_ring_offset &off, uint32_t size,
+                            size_t desc_size, off_t pgoff)
+{
+    r.map_len = off.desc + size * desc_size;
+    r.map = mmap(nullptr, r.map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_xsk_fd,
+                 pgoff);
+    if (r.map == MAP_FAILED) {
+        ring_logerr("mmap of XSK ring (pgoff=0x%lx) failed (errno=%d %m)", (unsigned long)pgoff,
+                    errno);
+        r.map = nullptr;
+        return false;
+    }
+
+    r.producer = (uint32_t *)((uint8_t *)r.map + off.producer);
+    r.consumer = (uint32_t *)((uint8_t *)r.map + off.consumer);
+    r.flags = (uint32_t *)((uint8_t *)r.map + off.flags);
+    r.descs = (uint8_t *)r.map + off.desc;
+    r.size = size;
+    r.mask = size - 1;
+
+    return true;
+}
+
+void ring_xdp::xsk_unmap_ring(xsk_ring &r)
+{
+    if (r.map) {
+        munmap(r.map, r.map_len);
+        r.map = nullptr;
+    }
+}
+
+bool ring_xdp::xsk_create()
+{
+    struct xdp_umem_reg umem_reg;
+    struct xdp_mmap_offsets off;
+    struct sockaddr_xdp sxdp;
+    socklen_t optlen = sizeof(off);
+    uint32_t ring_size = m_num_frames / 2;
+
+    /* UMEM is owned by the ring and released in xsk_destroy() */
+    m_umem_size = (size_t)m_num_frames * m_frame_size;
+    m_umem = (uint8_t *)m_umem_allocator.alloc_aligned(m_umem_size,
+                                                       (size_t)sysconf(_SC_PAGESIZE));
+    if (!m_umem) {
+        ring_logerr("Failed to allocate %zu bytes UMEM", m_umem_size);
+        return false;
+    }
+
+    m_xsk_fd = SYSCALL(socket, AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (m_xsk_fd < 0) {
+        ring_logerr("AF_XDP socket creation failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    memset(&umem_reg, 0, sizeof(umem_reg));
+    umem_reg.addr = ptr_to_u64(m_umem);
+    umem_reg.len = m_umem_size;
+    umem_reg.chunk_size = m_frame_size;
+    umem_reg.headroom = 0;
+    if (SYSCALL(setsockopt, m_xsk_fd, SOL_XDP, XDP_UMEM_REG, &umem_reg, sizeof(umem_reg)) ||
+        SYSCALL(setsockopt, m_xsk_fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size,
+                sizeof(ring_size)) ||
+        SYSCALL(setsockopt, m_xsk_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size,
+                sizeof(ring_size)) ||
+        SYSCALL(setsockopt, m_xsk_fd, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size)) ||
+        SYSCALL(setsockopt, m_xsk_fd, SOL_XDP, XDP_TX_RING, &ring_size, sizeof(ring_size))) {
+        ring_logerr("AF_XDP UMEM/rings setup failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    if (SYSCALL(getsockopt, m_xsk_fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen)) {
+        ring_logerr("XDP_MMAP_OFFSETS failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    if (!xsk_map_ring(m_fill, off.fr, ring_size, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) ||
+        !xsk_map_ring(m_comp, off.cr, ring_size, sizeof(uint64_t),
+                      XDP_UMEM_PGOFF_COMPLETION_RING) ||
+        !xsk_map_ring(m_rx, off.rx, ring_size, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) ||
+        !xsk_map_ring(m_tx, off.tx, ring_size, sizeof(struct xdp_desc), XDP_PGOFF_TX_RING)) {
+        return false;
+    }
+
+    /* Lower half of UMEM serves Rx, upper half serves Tx */
+    m_fill_pending.reserve(ring_size);
+    m_tx_frames.reserve(ring_size);
+    for (uint32_t i = 0; i < ring_size; i++) {
+        m_fill_pending.push_back((uint64_t)i * m_frame_size);
+        m_tx_frames.push_back((uint64_t)(ring_size + i) * m_frame_size);
+    }
+    fill_ring_refill();
+
+    /* Let the kernel choose zero copy mode and fall back to copy mode */
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = get_if_index();
+    sxdp.sxdp_queue_id = m_queue_id;
+    sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP;
+    if (SYSCALL(bind, m_xsk_fd, (struct sockaddr *)&sxdp, sizeof(sxdp))) {
+        ring_logerr("AF_XDP bind to if_index=%d queue=%u failed (errno=%d %m)", get_if_index(),
+                    m_queue_id, errno);
+        return false;
+    }
+
+    return true;
+}
+
+void ring_xdp::xsk_destroy()
+{
+    xsk_unmap_ring(m_tx);
+    xsk_unmap_ring(m_rx);
+    xsk_unmap_ring(m_comp);
+    xsk_unmap_ring(m_fill);
+
+    if (m_xsk_fd >= 0) {
+        SYSCALL(close, m_xsk_fd);
+        m_xsk_fd = -1;
+    }
+
+    /* The kernel unpins UMEM pages when the socket is closed */
+    m_umem_allocator.dealloc();
+    m_umem = nullptr;
+    m_umem_size = 0;
+}
+
+bool ring_xdp::prog_create()
+{
+    enum { LABEL_L4, LABEL_REDIRECT, LABEL_PASS };
+    const int key_off = -(int)sizeof(xdp_flow_key);
+    xdp_prog_builder prog;
+    int rc;
+
+    if (m_queue_id >= XDP_XSK_MAP_SIZE) {
+        ring_logerr("%s=%u is out of range", SYS_VAR_XDP_QUEUE, m_queue_id);
+        return false;
+    }
+
+    m_flow_map_fd = bpf_map_create(BPF_MAP_TYPE_HASH, sizeof(xdp_flow_key), sizeof(uint32_t),
+                                   XDP_FLOW_MAP_SIZE);
+    m_xsk_map_fd = bpf_map_create(BPF_MAP_TYPE_XSKMAP, sizeof(uint32_t), sizeof(int),
+                                  XDP_XSK_MAP_SIZE);
+    if (m_flow_map_fd < 0 || m_xsk_map_fd < 0) {
+        ring_logerr("BPF map creation failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    /*
+     * Redirect IPv4 TCP/UDP packets whose {daddr, dport, proto} (or {0, dport, proto}
+     * for wildcard listeners) is found in the flow map, pass everything else to the
+     * kernel. IP fragments are passed to the kernel as well.
+     */
+    prog.mov_reg(BPF_REG_6, BPF_REG_1);
+    prog.ldx(BPF_W, BPF_REG_2, BPF_REG_1, offsetof(struct xdp_md, data));
+    prog.ldx(BPF_W, BPF_REG_3, BPF_REG_1, offsetof(struct xdp_md, data_end));
+    prog.mov_reg(BPF_REG_4, BPF_REG_2);
+    prog.alu_imm(BPF_ADD, BPF_REG_4, ETH_HLEN + sizeof(struct iphdr));
+    prog.jmp_reg(BPF_JGT, BPF_REG_4, BPF_REG_3, LABEL_PASS);
+    prog.ldx(BPF_H, BPF_REG_5, BPF_REG_2, offsetof(struct ether_header, ether_type));
+    prog.jmp_imm(BPF_JNE, BPF_REG_5, htons(ETH_P_IP), LABEL_PASS);
+    prog.ldx(BPF_H, BPF_REG_5, BPF_REG_2, ETH_HLEN + offsetof(struct iphdr, frag_off));
+    prog.alu_imm(BPF_AND, BPF_REG_5, htons(IP_MF | IP_OFFMASK));
+    prog.jmp_imm(BPF_JNE, BPF_REG_5, 0, LABEL_PASS);
+    prog.ldx(BPF_B, BPF_REG_5, BPF_REG_2, ETH_HLEN + offsetof(struct iphdr, protocol));
+    prog.jmp_imm(BPF_JEQ, BPF_REG_5, IPPROTO_TCP, LABEL_L4);
+    prog.jmp_imm(BPF_JNE, BPF_REG_5, IPPROTO_UDP, LABEL_PASS);
+    prog.label(LABEL_L4);
+    prog.stx(BPF_B, BPF_REG_10, BPF_REG_5, key_off + (int)offsetof(xdp_flow_key, protocol));
+    prog.st(BPF_B, BPF_REG_10, key_off + (int)offsetof(xdp_flow_key, pad), 0);
+    prog.ldx(BPF_W, BPF_REG_5, BPF_REG_2, ETH_HLEN + offsetof(struct iphdr, daddr));
+    prog.stx(BPF_W, BPF_REG_10, BPF_REG_5, key_off + (int)offsetof(xdp_flow_key, dst_ip));
+    /* L4 header offset is ihl * 4 */
+    prog.ldx(BPF_B, BPF_REG_5, BPF_REG_2, ETH_HLEN);
+    prog.alu_imm(BPF_AND, BPF_REG_5, 0x0f);
+    prog.alu_imm(BPF_LSH, BPF_REG_5, 2);
+    prog.alu_reg(BPF_ADD, BPF_REG_2, BPF_REG_5);
+    prog.mov_reg(BPF_REG_4, BPF_REG_2);
+    prog.alu_imm(BPF_ADD, BPF_REG_4, ETH_HLEN + 2 * sizeof(uint16_t));
+    prog.jmp_reg(BPF_JGT, BPF_REG_4, BPF_REG_3, LABEL_PASS);
+    /* Destination port has the same offset in TCP and UDP headers */
+    prog.ldx(BPF_H, BPF_REG_5, BPF_REG_2, ETH_HLEN + sizeof(uint16_t));
+    prog.stx(BPF_H, BPF_REG_10, BPF_REG_5, key_off + (int)offsetof(xdp_flow_key, dst_port));
+    prog.ld_map_fd(BPF_REG_1, m_flow_map_fd);
+    prog.mov_reg(BPF_REG_2, BPF_REG_10);
+    prog.alu_imm(BPF_ADD, BPF_REG_2, key_off);
+    prog.call(BPF_FUNC_map_lookup_elem);
+    prog.jmp_imm(BPF_JNE, BPF_REG_0, 0, LABEL_REDIRECT);
+    prog.st(BPF_W, BPF_REG_10, key_off + (int)offsetof(xdp_flow_key, dst_ip), 0);
+    prog.ld_map_fd(BPF_REG_1, m_flow_map_fd);
+    prog.mov_reg(BPF_REG_2, BPF_REG_10);
+    prog.alu_imm(BPF_ADD, BPF_REG_2, key_off);
+    prog.call(BPF_FUNC_map_lookup_elem);
+    prog.jmp_imm(BPF_JEQ, BPF_REG_0, 0, LABEL_PASS);
+    prog.label(LABEL_REDIRECT);
+    prog.ldx(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(struct xdp_md, rx_queue_index));
+    prog.ld_map_fd(BPF_REG_1, m_xsk_map_fd);
+    /* Lower bits of flags are the action when the queue has no XSK bound */
+    prog.mov_imm(BPF_REG_3, XDP_PASS);
+    prog.call(BPF_FUNC_redirect_map);
+    prog.exit();
+    prog.label(LABEL_PASS);
+    prog.mov_imm(BPF_REG_0, XDP_PASS);
+    prog.exit();
+
+    const std::vector<struct bpf_insn> &insns = prog.finalize();
+    m_prog_fd = bpf_prog_load_xdp(insns, nullptr, 0);
+    if (m_prog_fd < 0) {
+        std::vector<char> log(65536, '\0');
+        ring_logerr("XDP program load failed (errno=%d %m)", errno);
+        if (bpf_prog_load_xdp(insns, log.data(), log.size()) < 0) {
+            ring_logdbg("verifier log:\n%s", log.data());
+        }
+        return false;
+    }
+
+    if (bpf_map_update(m_xsk_map_fd, &m_queue_id, &m_xsk_fd)) {
+        ring_logerr("Failed to add XSK to xskmap (errno=%d %m)", errno);
+        return false;
+    }
+
+    /* Do not replace a program installed by somebody else */
+    rc = -EINVAL;
+    switch (safe_mce_sys().xdp_mode) {
+    case option_xdp::XDP_AUTO:
+    case option_xdp::XDP_NATIVE:
+        m_xdp_flags = XDP_FLAGS_UPDATE_IF_NOEXIST | XDP_FLAGS_DRV_MODE;
+        rc = xdp_link_set(get_if_index(), m_prog_fd, m_xdp_flags);
+        if (rc == 0 || safe_mce_sys().xdp_mode == option_xdp::XDP_NATIVE) {
+            break;
+        }
+        ring_logdbg("Native XDP attach failed (rc=%d), fall back to generic mode", rc);
+        /* Fall through */
+    case option_xdp::XDP_GENERIC:
+        m_xdp_flags = XDP_FLAGS_UPDATE_IF_NOEXIST | XDP_FLAGS_SKB_MODE;
+        rc = xdp_link_set(get_if_index(), m_prog_fd, m_xdp_flags);
+        break;
+    default:
+        break;
+    }
+    if (rc) {
+        ring_logerr("XDP program attach to if_index=%d failed (rc=%d)", get_if_index(), rc);
+        m_xdp_flags = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void ring_xdp::prog_destroy()
+{
+    if (m_xdp_flags) {
+        int rc = xdp_link_set(get_if_index(), -1, m_xdp_flags & XDP_FLAGS_MODES);
+        if (rc) {
+            ring_logdbg("XDP program detach failed (rc=%d)", rc);
+        }
+        m_xdp_flags = 0;
+    }
+
+    if (m_prog_fd >= 0) {
+        SYSCALL(close, m_prog_fd);
+        m_prog_fd = -1;
+    }
+    if (m_xsk_map_fd >= 0) {
+        SYSCALL(close, m_xsk_map_fd);
+        m_xsk_map_fd = -1;
+    }
+    if (m_flow_map_fd >= 0) {
+        SYSCALL(close, m_flow_map_fd);
+        m_flow_map_fd = -1;
+    }
+}
+
+bool ring_xdp::flow_key_get(flow_tuple &flow_spec_5t, xdp_flow_key &key)
+{
+    if (!flow_spec_5t.is_tcp() && flow_spec_5t.get_protocol() != PROTO_UDP) {
+        return false;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.dst_ip = flow_spec_5t.get_dst_ip().get_in4_addr().s_addr;
+    key.dst_port = flow_spec_5t.get_dst_port();
+    key.protocol = (flow_spec_5t.is_tcp() ? IPPROTO_TCP : IPPROTO_UDP);
+
+    return true;
+}
+
+bool ring_xdp::flow_map_update(const xdp_flow_key &key, bool add)
+{
+    uint32_t value = 1;
+    int rc = (add ? bpf_map_update(m_flow_map_fd, &key, &value)
+                  : bpf_map_delete(m_flow_map_fd, &key));
+
+    if (rc) {
+        ring_logdbg("XDP flow map %s failed (errno=%d %m)", (add ? "update" : "delete"), errno);
+    }
+    return rc == 0;
+}
+
+bool ring_xdp::attach_flow(flow_tuple &flow_spec_5t, sockinfo *sink, bool force_5t)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+    xdp_flow_key key;
+
+    /* Only IPv4 is steered by the XDP program, let the kernel serve other flows */
+    if (flow_spec_5t.get_family() != AF_INET) {
+        ring_logdbg("Flow %s is not supported by AF_XDP ring", flow_spec_5t.to_str().c_str());
+        return false;
+    }
+
+    bool ret = ring_slave::attach_flow(flow_spec_5t, sink, force_5t);
+    if (ret && flow_key_get(flow_spec_5t, key)) {
+        int &refs = m_flow_map[key];
+        if (refs == 0 && !flow_map_update(key, true)) {
+            m_flow_map.erase(key);
+            ring_slave::detach_flow(flow_spec_5t, sink);
+            return false;
+        }
+        refs++;
+    }
+
+    return ret;
+}
+
+bool ring_xdp::detach_flow(flow_tuple &flow_spec_5t, sockinfo *sink)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+    xdp_flow_key key;
+
+    bool ret = ring_slave::detach_flow(flow_spec_5t, sink);
+    if (flow_spec_5t.get_family() == AF_INET && flow_key_get(flow_spec_5t, key)) {
+        xdp_flow_map_t::iterator iter = m_flow_map.find(key);
+        if (iter != m_flow_map.end() && --iter->second == 0) {
+            flow_map_update(key, false);
+            m_flow_map.erase(iter);
+        }
+    }
+
+    return ret;
+}
+
+int ring_xdp::poll_and_process_element_rx(uint64_t *, void *pv_fd_ready_array)
+{
+    tscval_t trace_tsc = trace_start();
+    txtime_poll();
+    int ret = process_element_rx(pv_fd_ready_array);
+    if (ret > 0) {
+        trace_event(TRACE_CQ_POLL, trace_tsc, ret);
+    }
+    return ret;
+}
+
+int ring_xdp::poll_and_process_element_tx(uint64_t *)
+{
+    txtime_poll();
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    return (int)tx_reap_completions();
+}
+
+int ring_xdp::wait_for_notification_and_process_element(int, uint64_t *, void *pv_fd_ready_array)
+{
+    return process_element_rx(pv_fd_ready_array);
+}
+
+int ring_xdp::drain_and_proccess()
+{
+    txtime_poll();
+    return process_element_rx(nullptr);
+}
+
+void ring_xdp::fill_ring_refill()
+{
+    if (m_fill_pending.empty()) {
+        return;
+    }
+
+    uint32_t prod = *m_fill.producer;
+    uint32_t cons = __atomic_load_n(m_fill.consumer, __ATOMIC_ACQUIRE);
+    uint32_t n = std::min<uint32_t>(m_fill.size - (prod - cons), m_fill_pending.size());
+    uint64_t *addrs = (uint64_t *)m_fill.descs;
+
+    for (uint32_t i = 0; i < n; i++) {
+        addrs[(prod + i) & m_fill.mask] = m_fill_pending.back();
+        m_fill_pending.pop_back();
+    }
+    __atomic_store_n(m_fill.producer, prod + n, __ATOMIC_RELEASE);
+
+    /* Driver stopped Rx processing due to empty fill ring */
+    if (n && (__atomic_load_n(m_fill.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP)) {
+        SYSCALL(recvfrom, m_xsk_fd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        m_p_ring_stat->xdp.n_wakeups++;
+    }
+}
+
+int ring_xdp::process_element_rx(void *pv_fd_ready_array)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+    struct xdp_desc *descs = (struct xdp_desc *)m_rx.descs;
+    uint32_t cons = *m_rx.consumer;
+    uint32_t prod = __atomic_load_n(m_rx.producer, __ATOMIC_ACQUIRE);
+    uint32_t n = std::min<uint32_t>(prod - cons, m_sysvar_cq_poll_batch_max);
+    int ret = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        struct xdp_desc *desc = &descs[(cons + i) & m_rx.mask];
+        mem_buf_desc_t *buff = nullptr;
+
+        if ((m_rx_pool.size() || request_more_rx_buffers()) &&
+            likely(desc->len <= m_rx_pool.front()->sz_buffer)) {
+            buff = m_rx_pool.get_and_pop_front();
+            memcpy(buff->p_buffer, m_umem + desc->addr, desc->len);
+            buff->sz_data = desc->len;
+            buff->rx.is_sw_csum_need = 1;
+            if (rx_process_buffer(buff, pv_fd_ready_array)) {
+                m_p_ring_stat->xdp.n_rx_buffers--;
+                ret++;
+            } else {
+                m_rx_pool.push_front(buff);
+            }
+        } else {
+            m_p_ring_stat->xdp.n_rx_dropped++;
+        }
+        /* Descriptor address may carry the XDP headroom offset */
+        m_fill_pending.push_back(desc->addr & ~((uint64_t)m_frame_size - 1));
+    }
+    __atomic_store_n(m_rx.consumer, cons + n, __ATOMIC_RELEASE);
+
+    fill_ring_refill();
+
+    return ret;
+}
+
+bool ring_xdp::request_more_rx_buffers()
+{
+    ring_logfuncall("Allocating additional %d buffers for internal use",
+                    m_sysvar_qp_compensation_level);
+
+    bool res = g_buffer_pool_rx_ptr->get_buffers_thread_safe(m_rx_pool, this,
+                                                             m_sysvar_qp_compensation_level, 0);
+    if (!res) {
+        ring_logfunc("Out of mem_buf_desc from RX free pool for internal object pool");
+        return false;
+    }
+
+    m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+
+    return true;
+}
+
+bool ring_xdp::reclaim_recv_buffers(descq_t *rx_reuse)
+{
+    while (!rx_reuse->empty()) {
+        mem_buf_desc_t *buff = rx_reuse->get_and_pop_front();
+        reclaim_recv_buffers(buff);
+    }
+
+    if (m_rx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int buff_to_rel = m_rx_pool.size() - m_sysvar_qp_compensation_level;
+
+        g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, buff_to_rel);
+        m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+    }
+
+    return true;
+}
+
+bool ring_xdp::reclaim_recv_buffers(mem_buf_desc_t *buff)
+{
+    if (buff && (buff->dec_ref_count() <= 1)) {
+        mem_buf_desc_t *temp = nullptr;
+        while (buff) {
+            if (buff->lwip_pbuf_dec_ref_count() <= 0) {
+                temp = buff;
+                buff = temp->p_next_desc;
+                temp->clear_transport_data();
+                temp->p_next_desc = nullptr;
+                temp->p_prev_desc = nullptr;
+                temp->reset_ref_count();
+                free_lwip_pbuf(&temp->lwip_pbuf);
+                m_rx_pool.push_back(temp);
+            } else {
+                buff->reset_ref_count();
+                buff = buff->p_next_desc;
+            }
+        }
+        m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+        return true;
+    }
+    return false;
+}
+
+void ring_xdp::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                xlio_wr_tx_packet_attr attr)
+{
+    NOT_IN_USE(id);
+    compute_tx_checksum((mem_buf_desc_t *)(p_send_wqe->wr_id), attr & XLIO_TX_PACKET_L3_CSUM,
+                        attr & XLIO_TX_PACKET_L4_CSUM);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe, is_set(attr, XLIO_TX_PACKET_MORE));
+    send_status_handler(ret, p_send_wqe);
+}
+
+int ring_xdp::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                               xlio_wr_tx_packet_attr attr, xlio_tis *tis)
+{
+    NOT_IN_USE(id);
+    NOT_IN_USE(tis);
+    compute_tx_checksum((mem_buf_desc_t *)(p_send_wqe->wr_id), attr & XLIO_TX_PACKET_L3_CSUM,
+                        attr & XLIO_TX_PACKET_L4_CSUM);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe, false);
+    send_status_handler(ret, p_send_wqe);
+    return ret;
+}
+
+uint32_t ring_xdp::tx_reap_completions()
+{
+    uint64_t *addrs = (uint64_t *)m_comp.descs;
+    uint32_t cons = *m_comp.consumer;
+    uint32_t prod = __atomic_load_n(m_comp.producer, __ATOMIC_ACQUIRE);
+    uint32_t n = prod - cons;
+
+    for (uint32_t i = 0; i < n; i++) {
+        m_tx_frames.push_back(addrs[(cons + i) & m_comp.mask]);
+    }
+    if (n) {
+        __atomic_store_n(m_comp.consumer, cons + n, __ATOMIC_RELEASE);
+        m_tx_outstanding -= n;
+        m_p_ring_stat->xdp.n_tx_free_frames = m_tx_frames.size();
+    }
+
+    return n;
+}
+
+void ring_xdp::tx_kick()
+{
+    lat_stats_doorbell();
+    if (!(__atomic_load_n(m_tx.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP)) {
+        return;
+    }
+
+    m_p_ring_stat->xdp.n_wakeups++;
+    if (SYSCALL(sendto, m_xsk_fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0) {
+        /* These mean the kernel is busy with the ring, the frame is still queued */
+        if (errno != ENOBUFS && errno != EAGAIN && errno != EBUSY && errno != ENETDOWN) {
+            ring_logdbg("sendto: xsk_fd %d, errno: %d", m_xsk_fd, errno);
+        }
+    }
+}
+
+int ring_xdp::send_buffer(xlio_ibv_send_wr *wr, bool more)
+{
+    sg_array sga(wr->sg_list, wr->num_sge);
+    uint32_t len = (uint32_t)sga.length();
+    struct xdp_desc *desc;
+    uint8_t *frame;
+    uint64_t addr;
+    uint32_t prod;
+
+    if (unlikely(len > m_frame_size)) {
+        ring_logdbg("Packet of %u bytes exceeds UMEM frame size", len);
+        goto drop;
+    }
+
+    if (unlikely(m_tx_frames.empty())) {
+        tx_reap_completions();
+        if (m_tx_frames.empty()) {
+            tx_kick();
+            tx_reap_completions();
+            if (m_tx_frames.empty()) {
+                goto drop;
+            }
+        }
+    }
+
+    addr = m_tx_frames.back();
+    m_tx_frames.pop_back();
+    frame = m_umem + addr;
+    for (int i = 0; i < wr->num_sge; i++) {
+        memcpy(frame, (void *)wr->sg_list[i].addr, wr->sg_list[i].length);
+        frame += wr->sg_list[i].length;
+    }
+
+    /* Tx ring has room for every Tx frame, so it can't overflow here */
+    prod = *m_tx.producer;
+    desc = &((struct xdp_desc *)m_tx.descs)[prod & m_tx.mask];
+    desc->addr = addr;
+    desc->len = len;
+    desc->options = 0;
+    __atomic_store_n(m_tx.producer, prod + 1, __ATOMIC_RELEASE);
+    m_tx_outstanding++;
+    m_p_ring_stat->xdp.n_tx_free_frames = m_tx_frames.size();
+
+    // The last frame of a send wakes the kernel up for all of them
+    if (!more) {
+        tx_kick();
+    }
+
+    return (int)len;
+
+drop:
+    m_p_ring_stat->xdp.n_tx_dropped++;
+    // Frames queued before with the more hint must not wait for the next send
+    tx_kick();
+    return -1;
+}
+
+void ring_xdp::send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe)
+{
+    // Non positive value of ret means that we are on error flow (same as ring_tap).
+    if (p_send_wqe) {
+        mem_buf_desc_t *p_mem_buf_desc = (mem_buf_desc_t *)(p_send_wqe->wr_id);
+
+        if (likely(ret > 0)) {
+            // Update TX statistics
+            m_p_ring_stat->n_tx_byte_count += ret;
+            ++m_p_ring_stat->n_tx_pkt_count;
+        }
+
+        mem_buf_tx_release(p_mem_buf_desc, true);
+    }
+}
+
+mem_buf_desc_t *ring_xdp::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                         int n_num_mem_bufs)
+{
+    mem_buf_desc_t *head = nullptr;
+
+    NOT_IN_USE(id);
+    NOT_IN_USE(b_block);
+    NOT_IN_USE(type);
+
+    ring_logfuncall("n_num_mem_bufs=%d", n_num_mem_bufs);
+
+    m_lock_ring_tx.lock();
+
+    if (unlikely((int)m_tx_pool.size() < n_num_mem_bufs)) {
+        request_more_tx_buffers(PBUF_RAM, m_sysvar_qp_compensation_level, 0);
+
+        if (unlikely((int)m_tx_pool.size() < n_num_mem_bufs)) {
+            m_lock_ring_tx.unlock();
+            return head;
+        }
+    }
+
+    head = m_tx_pool.get_and_pop_back();
+    head->lwip_pbuf.ref = 1;
+    n_num_mem_bufs--;
+
+    mem_buf_desc_t *next = head;
+    while (n_num_mem_bufs) {
+        next->p_next_desc = m_tx_pool.get_and_pop_back();
+        next = next->p_next_desc;
+        next->lwip_pbuf.ref = 1;
+        n_num_mem_bufs--;
+    }
+
+    m_lock_ring_tx.unlock();
+
+    return head;
+}
+
+inline void ring_xdp::return_to_global_pool()
+{
+    if (m_tx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_tx_pool.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_tx->put_buffers_thread_safe(&m_tx_pool, return_bufs);
+    }
+}
+
+void ring_xdp::mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc)
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    if (likely(p_mem_buf_desc)) {
+        if (likely(p_mem_buf_desc->lwip_pbuf.ref)) {
+            p_mem_buf_desc->lwip_pbuf.ref--;
+        } else {
+            ring_logerr("ref count of %p is already zero, double free??", p_mem_buf_desc);
+        }
+
+        if (p_mem_buf_desc->lwip_pbuf.ref == 0) {
+            p_mem_buf_desc->p_next_desc = nullptr;
+            if (unlikely(p_mem_buf_desc->lwip_pbuf.type == PBUF_ZEROCOPY)) {
+                g_buffer_pool_zc->put_buffers_thread_safe(p_mem_buf_desc);
+                return;
+            }
+            free_lwip_pbuf(&p_mem_buf_desc->lwip_pbuf);
+            m_tx_pool.push_back(p_mem_buf_desc);
+        }
+    }
+
+    return_to_global_pool();
+}
+
+void ring_xdp::mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc, unsigned ref)
+{
+    if (unlikely(ref == 0)) {
+        return;
+    }
+
+    m_lock_ring_tx.lock();
+    p_mem_buf_desc->lwip_pbuf.ref -= std::min<unsigned>(p_mem_buf_desc->lwip_pbuf.ref, ref - 1);
+    m_lock_ring_tx.unlock();
+    mem_buf_desc_return_single_to_owner_tx(p_mem_buf_desc);
+}
+
+int ring_xdp::mem_buf_tx_release(mem_buf_desc_t *buff_list, bool b_accounting, bool trylock)
+{
+    int count = 0;
+    mem_buf_desc_t *next;
+
+    NOT_IN_USE(b_accounting);
+
+    if (!trylock) {
+        m_lock_ring_tx.lock();
+    } else if (m_lock_ring_tx.trylock()) {
+        return 0;
+    }
+
+    while (buff_list) {
+        next = buff_list->p_next_desc;
+        buff_list->p_next_desc = nullptr;
+
+        if (likely(buff_list->lwip_pbuf.ref)) {
+            buff_list->lwip_pbuf.ref--;
+        } else {
+            ring_logerr("ref count of %p is already zero, double free??", buff_list);
+        }
+
+        if (buff_list->lwip_pbuf.ref == 0) {
+            free_lwip_pbuf(&buff_list->lwip_pbuf);
+            m_tx_pool.push_back(buff_list);
+        }
+        count++;
+        buff_list = next;
+    }
+
+    return_to_global_pool();
+    m_lock_ring_tx.unlock();
+
+    return count;
+}
+
+#endif /* DEFINED_XDP */
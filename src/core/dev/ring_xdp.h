@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef RING_XDP_H_
+#define RING_XDP_H_
+
+#include "ring_slave.h"
+#include "dev/allocator.h"
+
+#ifdef DEFINED_XDP
+
+#include <linux/if_xdp.h>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Ring over an AF_XDP socket for interfaces which are not backed by a mlx5 device.
+ *
+ * The UMEM is taken from the XLIO heap and is split in two halves: Rx frames which
+ * circulate between the fill and Rx rings, and Tx frames which circulate between
+ * the Tx and completion rings. Packets are copied between UMEM frames and regular
+ * mem_buf_desc_t buffers, so the rest of the stack is not aware of the UMEM.
+ * An XDP program redirects only offloaded flows (see attach_flow()) to the socket.
+ */
+class ring_xdp : public ring_slave {
+public:
+    ring_xdp(int if_index, ring *parent = nullptr);
+    virtual ~ring_xdp();
+
+    virtual bool is_up() { return m_active && m_xsk_fd >= 0; }
+    virtual bool attach_flow(flow_tuple &flow_spec_5t, sockinfo *sink, bool force_5t = false);
+    virtual bool detach_flow(flow_tuple &flow_spec_5t, sockinfo *sink);
+    virtual int poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd_ready_array = NULL);
+    virtual int poll_and_process_element_tx(uint64_t *p_cq_poll_sn);
+    virtual int wait_for_notification_and_process_element(int cq_channel_fd, uint64_t *p_cq_poll_sn,
+                                                          void *pv_fd_ready_array = nullptr);
+    virtual int drain_and_proccess();
+    virtual bool reclaim_recv_buffers(descq_t *rx_reuse);
+    virtual bool reclaim_recv_buffers(mem_buf_desc_t *buff);
+    virtual int reclaim_recv_single_buffer(mem_buf_desc_t *rx_reuse)
+    {
+        NOT_IN_USE(rx_reuse);
+        return -1;
+    }
+    virtual void send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                  xlio_wr_tx_packet_attr attr);
+    virtual int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                 xlio_wr_tx_packet_attr attr, xlio_tis *tis);
+    virtual void mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc);
+    virtual void mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc, unsigned ref);
+    virtual mem_buf_desc_t *mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                           int n_num_mem_bufs = 1);
+    virtual int mem_buf_tx_release(mem_buf_desc_t *p_mem_buf_desc_list, bool b_accounting,
+                                   bool trylock = false);
+    virtual bool get_hw_dummy_send_support(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe)
+    {
+        NOT_IN_USE(id);
+        NOT_IN_USE(p_send_wqe);
+        return false;
+    }
+    /* The XSK fd is level triggered on the Rx ring, so it is always armed */
+    virtual int request_notification(cq_type_t cq_type, uint64_t poll_sn)
+    {
+        NOT_IN_USE(cq_type);
+        NOT_IN_USE(poll_sn);
+        return 0;
+    }
+    virtual void adapt_cq_moderation() {}
+
+    virtual int socketxtreme_poll(struct xlio_socketxtreme_completion_t *xlio_completions,
+                                  unsigned int ncompletions, int flags)
+    {
+        NOT_IN_USE(xlio_completions);
+        NOT_IN_USE(ncompletions);
+        NOT_IN_USE(flags);
+        return 0;
+    }
+
+    virtual int modify_ratelimit(struct xlio_rate_limit_t &rate_limit)
+    {
+        NOT_IN_USE(rate_limit);
+        return 0;
+    }
+    void inc_cq_moderation_stats(size_t sz_data) { NOT_IN_USE(sz_data); }
+    virtual uint32_t get_tx_user_lkey(void *addr, size_t length)
+    {
+        NOT_IN_USE(addr);
+        NOT_IN_USE(length);
+        return LKEY_ERROR;
+    }
+    virtual uint32_t get_max_inline_data() { return 0; }
+    ib_ctx_handler *get_ctx(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return nullptr;
+    }
+    virtual uint32_t get_max_send_sge(void) { return 1; }
+    virtual uint32_t get_max_payload_sz(void) { return 0; }
+    virtual uint16_t get_max_header_sz(void) { return 0; }
+    virtual uint32_t get_tx_lkey(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return 0;
+    }
+    virtual bool is_tso(void) { return false; }
+
+private:
+    /* Producer/consumer ring shared with the kernel */
+    struct xsk_ring {
+        uint32_t *producer;
+        uint32_t *consumer;
+        uint32_t *flags;
+        void *descs;
+        void *map;
+        size_t map_len;
+        uint32_t size;
+        uint32_t mask;
+    };
+
+    /* Key of the XDP steering map, must match the layout used by the XDP program */
+    struct xdp_flow_key {
+        uint32_t dst_ip;
+        uint16_t dst_port;
+        uint8_t protocol;
+        uint8_t pad;
+    };
+
+    struct xdp_flow_key_hash {
+        size_t operator()(const xdp_flow_key &key) const
+        {
+            return std::hash<uint64_t>()(((uint64_t)key.dst_ip << 32) |
+                                         ((uint64_t)key.dst_port << 8) | key.protocol);
+        }
+    };
+
+    struct xdp_flow_key_equal {
+        bool operator()(const xdp_flow_key &a, const xdp_flow_key &b) const
+        {
+            return a.dst_ip == b.dst_ip && a.dst_port == b.dst_port && a.protocol == b.protocol;
+        }
+    };
+
+    typedef std::unordered_map<xdp_flow_key, int, xdp_flow_key_hash, xdp_flow_key_equal>
+        xdp_flow_map_t;
+
+    bool xsk_create();
+    void xsk_destroy();
+    bool xsk_map_ring(xsk_ring &r, const struct xdp_ring_offset &off, uint32_t size,
+                      size_t desc_size, off_t pgoff);
+    void xsk_unmap_ring(xsk_ring &r);
+    bool prog_create();
+    void prog_destroy();
+    bool flow_key_get(flow_tuple &flow_spec_5t, xdp_flow_key &key);
+    bool flow_map_update(const xdp_flow_key &key, bool add);
+
+    int process_element_rx(void *pv_fd_ready_array);
+    bool request_more_rx_buffers();
+    void fill_ring_refill();
+    uint32_t tx_reap_completions();
+    void tx_kick();
+    int send_buffer(xlio_ibv_send_wr *p_send_wqe, bool more);
+    void send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe);
+    inline void return_to_global_pool();
+
+    int m_xsk_fd;
+    int m_prog_fd;
+    int m_flow_map_fd;
+    int m_xsk_map_fd;
+    uint32_t m_xdp_flags;
+    uint32_t m_queue_id;
+    const uint32_t m_sysvar_qp_compensation_level;
+    const uint32_t m_sysvar_cq_poll_batch_max;
+    uint32_t m_frame_size;
+    uint32_t m_num_frames;
+    xlio_allocator m_umem_allocator;
+    uint8_t *m_umem;
+    size_t m_umem_size;
+
+    xsk_ring m_fill;
+    xsk_ring m_comp;
+    xsk_ring m_rx;
+    xsk_ring m_tx;
+
+    /* Rx frames returned to the kernel but not submitted to the fill ring yet */
+    std::vector<uint64_t> m_fill_pending;
+    /* UMEM frames available for Tx */
+    std::vector<uint64_t> m_tx_frames;
+    uint32_t m_tx_outstanding;
+
+    descq_t m_rx_pool;
+    xdp_flow_map_t m_flow_map;
+};
+
+#endif /* DEFINED_XDP */
+
+#endif /* RING_XDP_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TXTIME_QUEUE_H
+#define TXTIME_QUEUE_H
+
+#include <stdint.h>
+#include <time.h>
+#include <queue>
+#include <vector>
+
+#define TXTIME_NSEC_PER_SEC 1000000000ULL
+
+// Launch time of a packet, SO_TXTIME socket option and SCM_TXTIME control message
+struct xlio_txtime {
+    uint64_t time_ns; // In clockid
+    clockid_t clockid;
+    bool deadline_mode; // SOF_TXTIME_DEADLINE_MODE, time_ns is the latest send time
+};
+
+static inline uint64_t txtime_clock_now(clockid_t clockid)
+{
+    struct timespec ts;
+    clock_gettime(clockid, &ts);
+    return (uint64_t)ts.tv_sec * TXTIME_NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @class txtime_queue
+ *
+ * Time ordered transmit queue of the packets scheduled with SO_TXTIME.
+ * Packets with the same launch time keep their send order. The queue does not
+ * read a clock, the owner passes the current time so a software clock can drive it.
+ *
+ * Not thread safe.
+ */
+template <typename T> class txtime_queue {
+public:
+    bool empty() const { return m_queue.empty(); }
+    size_t size() const { return m_queue.size(); }
+
+    // Launch time of the earliest packet, the queue must not be empty
+    uint64_t next_txtime() const { return m_queue.top().txtime; }
+
+    void push(uint64_t txtime, const T &item) { m_queue.push(entry {txtime, m_seq++, item}); }
+
+    /**
+     * Pops the earliest packet if its launch time has come.
+     * @param now Current time in the clock of the launch times.
+     * @param txtime Launch time of the popped packet.
+     * @param item The popped packet.
+     * @return false if the queue is empty or the earliest packet is not due yet.
+     */
+    bool pop_expired(uint64_t now, uint64_t &txtime, T &item)
+    {
+        if (m_queue.empty() || m_queue.top().txtime > now) {
+            return false;
+        }
+        txtime = m_queue.top().txtime;
+        item = m_queue.top().item;
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    struct entry {
+        uint64_t txtime;
+        uint64_t seq;
+        T item;
+    };
+
+    struct later {
+        bool operator()(const entry &a, const entry &b) const
+        {
+            return a.txtime > b.txtime || (a.txtime == b.txtime && a.seq > b.seq);
+        }
+    };
+
+    std::priority_queue<entry, std::vector<entry>, later> m_queue;
+    uint64_t m_seq = 0U;
+};
+
+#endif /* TXTIME_QUEUE_H */
@@ -37,6 +37,7 @@
 #include "vlogger/vlogger.h"
 #include "core/util/sys_vars.h"
 #include "core/util/utils.h"
+#include "core/util/instrumentation.h"
 #include "delta_timer.h"
 #include "timer_handler.h"
 
@@ -228,7 +229,10 @@ void timer::process_registered_timers()
 {
     timer_node_t *iter = m_list_head;
     timer_node_t *next_iter;
+    tscval_t trace_tsc = trace_start();
+    uint32_t expired = 0;
     while (iter && (iter->delta_time_msec == 0)) {
+        expired++;
         tmr_logfuncall("timer expired on %p", iter->handler);
 
         /* Special check is need to protect
@@ -266,13 +270,19 @@ void timer::process_registered_timers()
         BULLSEYE_EXCLUDE_BLOCK_END
         iter = next_iter;
     }
+    if (expired) {
+        trace_event(TRACE_TIMER_TICK, trace_tsc, expired);
+    }
 }
 
 void timer::process_registered_timers_uncond()
 {
     timer_node_t *iter = m_list_head;
     timer_node_t *next_iter;
+    tscval_t trace_tsc = trace_start();
+    uint32_t expired = 0;
     while (iter) {
+        expired++;
         tmr_logfuncall("timer executed on %p", iter->handler);
 
         iter->handler->handle_timer_expired(iter->user_data);
@@ -297,6 +307,9 @@ void timer::process_registered_timers_uncond()
         BULLSEYE_EXCLUDE_BLOCK_END
         iter = next_iter;
     }
+    if (expired) {
+        trace_event(TRACE_TIMER_TICK, trace_tsc, expired);
+    }
 }
 
 // insert allocated node to the list
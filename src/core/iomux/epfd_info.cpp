@@ -32,6 +32,7 @@
 
 #include <sock/fd_collection.h>
 #include <iomux/epfd_info.h>
+#include <iomux/os_uring_poller.h>
 
 #define MODULE_NAME "epfd_info:"
 
@@ -41,7 +42,8 @@
 #define NUM_LOG_INVALID_EVENTS 10
 #define EPFD_MAX_OFFLOADED_STR 150
 
-#define CQ_FD_MARK 0xabcd
+#define CQ_FD_MARK        0xabcd
+#define OS_POLLER_FD_MARK 0xabce
 
 int epfd_info::remove_fd_from_epoll_os(int fd)
 {
@@ -62,6 +64,8 @@ epfd_info::epfd_info(int epfd, int size)
     , m_lock_poll_os(MULTILOCK_NON_RECURSIVE, "epfd_lock_poll_os")
     , m_sysvar_thread_mode(safe_mce_sys().thread_mode)
     , m_b_os_data_available(false)
+    , m_p_os_poller(nullptr)
+    , m_os_poller_sleepers(0)
 {
     __log_funcall("");
     int max_sys_fd = get_sys_max_fd_num();
@@ -87,13 +91,34 @@ epfd_info::epfd_info(int epfd, int size)
 
     m_log_invalid_events = NUM_LOG_INVALID_EVENTS;
 
-    xlio_stats_instance_create_epoll_block(m_epfd, &(m_stats->stats));
+    m_stats = xlio_stats_instance_create_epoll_block(m_epfd, m_stats);
 
     // Register this socket to read nonoffloaded data
     g_p_event_handler_manager->update_epfd(m_epfd, EPOLL_CTL_ADD,
                                            EPOLLIN | EPOLLPRI | EPOLLONESHOT);
 
     wakeup_set_epoll_fd(m_epfd);
+
+#ifdef DEFINED_IO_URING
+    if (safe_mce_sys().epoll_os_uring) {
+        m_p_os_poller = new os_uring_poller();
+        if (m_p_os_poller->is_valid()) {
+            // Blocking waits are woken up by the poller eventfd
+            epoll_event evt = {0, {nullptr}};
+            evt.events = EPOLLIN;
+            evt.data.u64 = (((uint64_t)OS_POLLER_FD_MARK << 32) | m_p_os_poller->get_notify_fd());
+            if (SYSCALL(epoll_ctl, m_epfd, EPOLL_CTL_ADD, m_p_os_poller->get_notify_fd(), &evt)) {
+                __log_dbg("failed to add io_uring notify fd to epfd=%d (errno=%d %m)", m_epfd,
+                          errno);
+                delete m_p_os_poller;
+                m_p_os_poller = nullptr;
+            }
+        } else {
+            delete m_p_os_poller;
+            m_p_os_poller = nullptr;
+        }
+    }
+#endif /* DEFINED_IO_URING */
 }
 
 epfd_info::~epfd_info()
@@ -138,8 +163,11 @@ epfd_info::~epfd_info()
 
     unlock();
 
-    xlio_stats_instance_remove_epoll_block(&m_stats->stats);
+    m_stats = xlio_stats_instance_remove_epoll_block(m_stats);
     delete[] m_p_offloaded_fds;
+#ifdef DEFINED_IO_URING
+    delete m_p_os_poller;
+#endif /* DEFINED_IO_URING */
 }
 
 int epfd_info::ctl(int op, int fd, epoll_event *event)
@@ -197,6 +225,94 @@ bool epfd_info::is_cq_fd(uint64_t data)
     return true;
 }
 
+bool epfd_info::is_os_poller_fd(uint64_t data)
+{
+    if ((data >> 32) != OS_POLLER_FD_MARK) {
+        return false;
+    }
+
+#ifdef DEFINED_IO_URING
+    lock();
+    if (m_p_os_poller) {
+        m_p_os_poller->drain_notify_fd();
+    }
+    unlock();
+#endif /* DEFINED_IO_URING */
+
+    return true;
+}
+
+int epfd_info::os_poller_reap(epoll_event *events, int max)
+{
+#ifdef DEFINED_IO_URING
+    // add_fd(), mod_fd() and del_fd() submit their requests, so an idle ring needs no lock
+    if (!m_p_os_poller || max <= 0 || !m_p_os_poller->has_pending()) {
+        return 0;
+    }
+
+    lock();
+    int n = m_p_os_poller->reap(events, max);
+    int ready = 0;
+    for (int i = 0; i < n; ++i) {
+        // Translate to the user data and mask, the same way the OS epoll reports the fd
+        fd_info_map_t::iterator iter = m_fd_non_offloaded_map.find(events[i].data.fd);
+        if (iter == m_fd_non_offloaded_map.end()) {
+            continue;
+        }
+        uint32_t revents = events[i].events & (iter->second.events | EPOLLERR | EPOLLHUP);
+        if (revents) {
+            events[ready].events = revents;
+            events[ready].data = iter->second.epdata;
+            ++ready;
+        }
+    }
+    unlock();
+
+    return ready;
+#else
+    NOT_IN_USE(events);
+    NOT_IN_USE(max);
+    return 0;
+#endif /* DEFINED_IO_URING */
+}
+
+bool epfd_info::os_poller_going_to_sleep()
+{
+#ifdef DEFINED_IO_URING
+    if (!m_p_os_poller) {
+        return true;
+    }
+
+    lock();
+    ++m_os_poller_sleepers;
+    bool pending = m_p_os_poller->prepare_to_sleep();
+    if (pending) {
+        os_poller_return_from_sleep();
+    }
+    unlock();
+
+    return !pending;
+#else
+    return true;
+#endif /* DEFINED_IO_URING */
+}
+
+void epfd_info::os_poller_return_from_sleep()
+{
+#ifdef DEFINED_IO_URING
+    if (!m_p_os_poller) {
+        return;
+    }
+
+    lock();
+    // Notifications stay enabled while another thread sleeps on this set
+    if (--m_os_poller_sleepers == 0) {
+        m_p_os_poller->return_from_sleep();
+    }
+    unlock();
+#endif /* DEFINED_IO_URING */
+}
+
 int epfd_info::add_fd(int fd, epoll_event *event)
 {
     int ret;
@@ -316,6 +432,14 @@ int epfd_info::add_fd(int fd, epoll_event *event)
     } else {
         fd_rec.offloaded_index = -1;
         m_fd_non_offloaded_map[fd] = fd_rec;
+#ifdef DEFINED_IO_URING
+        // The OS epoll validated the fd, move plain OS fds to the io_uring poller.
+        // The fd stays in the OS epoll if the poller cannot watch it.
+        if (m_p_os_poller && !temp_sock_fd_api &&
+            m_p_os_poller->add_fd(fd, event->events) == 0) {
+            remove_fd_from_epoll_os(fd);
+        }
+#endif /* DEFINED_IO_URING */
     }
 
     __log_func("fd %d added in epfd %d with events=%#x and data=%#x", fd, m_epfd, event->events,
@@ -406,6 +530,10 @@ int epfd_info::del_fd(int fd, bool passthrough)
     sockinfo *temp_sock_fd_api = fd_collection_get_sockfd(fd);
     if (temp_sock_fd_api && temp_sock_fd_api->skip_os_select()) {
         __log_dbg("fd=%d must be skipped from os epoll()", fd);
+#ifdef DEFINED_IO_URING
+    } else if (m_p_os_poller && m_p_os_poller->is_registered(fd)) {
+        m_p_os_poller->del_fd(fd);
+#endif /* DEFINED_IO_URING */
     } else if (!passthrough) {
         remove_fd_from_epoll_os(fd);
     }
@@ -498,6 +626,27 @@ int epfd_info::mod_fd(int fd, epoll_event *event)
 
     if (temp_sock_fd_api && temp_sock_fd_api->skip_os_select()) {
         __log_dbg("fd=%d must be skipped from os epoll()", fd);
+#ifdef DEFINED_IO_URING
+    } else if (m_p_os_poller && m_p_os_poller->is_registered(fd) &&
+               m_p_os_poller->can_watch(event->events)) {
+        ret = m_p_os_poller->mod_fd(fd, event->events);
+        if (ret < 0) {
+            __log_err("failed to modify fd=%d in io_uring of epfd=%d (errno=%d %m)", fd, m_epfd,
+                      errno);
+            return ret;
+        }
+    } else if (m_p_os_poller && m_p_os_poller->is_registered(fd)) {
+        // The poller cannot watch the new mask, move the fd back to the OS epoll
+        evt.events = event->events;
+        evt.data.u64 = 0; // zero all data
+        evt.data.fd = fd;
+        ret = SYSCALL(epoll_ctl, m_epfd, EPOLL_CTL_ADD, fd, &evt);
+        if (ret < 0) {
+            __log_err("failed to move fd=%d to epoll epfd=%d (errno=%d %m)", fd, m_epfd, errno);
+            return ret;
+        }
+        m_p_os_poller->del_fd(fd);
+#endif /* DEFINED_IO_URING */
     } else {
         // modify fd
         evt.events = event->events;
@@ -43,6 +43,8 @@ typedef std::unordered_map<int, epoll_fd_rec> fd_info_map_t;
 typedef std::unordered_map<ring *, int /*ref count*/> ring_map_t;
 typedef std::deque<int> ready_cq_fd_q_t;
 
+class os_uring_poller;
+
 class epfd_info : public lock_mutex_recursive, public cleanable_obj, public wakeup_pipe {
 public:
     epfd_info(int epfd, int size);
@@ -69,6 +71,30 @@ public:
      */
     bool is_cq_fd(uint64_t data);
 
+    /**
+     * check if fd is the notification fd of the io_uring OS poller according to the data.
+     * if it is, consume the notification.
+     * @param data field from event data
+     * @return true if fd is the OS poller fd
+     */
+    bool is_os_poller_fd(uint64_t data);
+
+    /**
+     * Reap the non offloaded fds watched by the io_uring OS poller (XLIO_EPOLL_OS_URING).
+     * No system call is issued unless requests must be rearmed.
+     * @param events Array to fill with the user data of the ready fds.
+     * @param max Size of the array.
+     * @return Number of filled events.
+     */
+    int os_poller_reap(epoll_event *events, int max);
+
+    /**
+     * Arm the OS poller notification before blocking on the OS epoll fd.
+     * @return false if completions are already pending and the caller must not block.
+     */
+    bool os_poller_going_to_sleep();
+    void os_poller_return_from_sleep();
+
     /**
      * Get the original user data posted with this fd.
      * @param fd File descriptor.
@@ -87,6 +113,11 @@ public:
      */
     epoll_stats_t *stats();
 
+    /**
+     * @return Spin, yield or block controller of epoll_wait() on this set
+     */
+    adaptive_poll *get_adaptive_poll() { return &m_adaptive_poll; }
+
     int ring_poll_and_process_element(uint64_t *p_poll_sn_rx, uint64_t *p_poll_sn_tx,
                                       void *pv_fd_ready_array = nullptr);
 
@@ -152,5 +183,8 @@ private:
     epoll_stats_t *m_stats;
     int m_log_invalid_events;
     bool m_b_os_data_available; // true when non offloaded data is available
+    adaptive_poll m_adaptive_poll;
+    os_uring_poller *m_p_os_poller; // Watches non offloaded fds, nullptr if not in use
+    int m_os_poller_sleepers;
 };
 #endif /* _EPFD_INFO_H */
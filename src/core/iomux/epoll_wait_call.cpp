@@ -191,7 +191,7 @@ bool epoll_wait_call::_wait(int timeout)
 
     if (timeout) {
         lock();
-        if (m_epfd_info->m_ready_fds.empty()) {
+        if (m_epfd_info->m_ready_fds.empty() && m_epfd_info->os_poller_going_to_sleep()) {
             m_epfd_info->going_to_sleep();
         } else {
             timeout = 0;
@@ -208,6 +208,7 @@ bool epoll_wait_call::_wait(int timeout)
     if (timeout) {
         lock();
         m_epfd_info->return_from_sleep();
+        m_epfd_info->os_poller_return_from_sleep();
         unlock();
     }
 
@@ -234,6 +235,11 @@ bool epoll_wait_call::_wait(int timeout)
             continue;
         }
 
+        // io_uring OS poller notification, its fds are reaped below
+        if (m_epfd_info->is_os_poller_fd(m_p_ready_events[i].data.u64)) {
+            continue;
+        }
+
         if (m_p_ready_events[i].events & EPOLLIN) {
             sockinfo *temp_sock_fd_api = fd_collection_get_sockfd(fd);
             if (temp_sock_fd_api) {
@@ -255,6 +261,9 @@ bool epoll_wait_call::_wait(int timeout)
         }
     }
 
+    m_n_all_ready_fds += m_epfd_info->os_poller_reap(m_events + m_n_all_ready_fds,
+                                                     m_maxevents - m_n_all_ready_fds);
+
     return cq_ready;
 }
 
@@ -370,6 +379,15 @@ bool epoll_wait_call::handle_os_countdown(int &poll_os_countdown)
 {
     NOT_IN_USE(poll_os_countdown);
 
+    // Non offloaded fds watched by io_uring are reaped from memory without a system call
+    int os_ready = m_epfd_info->os_poller_reap(m_events, m_maxevents);
+    if (os_ready) {
+        m_n_all_ready_fds = os_ready;
+        m_p_stats->n_iomux_os_rx_ready += os_ready;
+        check_all_offloaded_sockets();
+        return true;
+    }
+
     if (!m_epfd_info->get_os_data_available() || !m_epfd_info->get_and_unset_os_data_available()) {
         return false;
     }
@@ -417,3 +435,12 @@ int epoll_wait_call::ring_wait_for_notification_and_process_element(void *pv_fd_
     return m_epfd_info->ring_wait_for_notification_and_process_element(&m_poll_sn_rx,
                                                                        pv_fd_ready_array);
 }
+
+adaptive_poll *epoll_wait_call::get_adaptive_poll()
+{
+    // A zero timeout call never waits, so there is nothing to learn from it
+    if (!safe_mce_sys().adaptive_poll || m_timeout == 0) {
+        return nullptr;
+    }
+    return m_epfd_info->get_adaptive_poll();
+}
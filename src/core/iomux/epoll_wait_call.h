@@ -111,6 +111,8 @@ protected:
 
     virtual bool handle_os_countdown(int &poll_os_countdown);
 
+    virtual adaptive_poll *get_adaptive_poll();
+
 private:
     bool _wait(int timeout);
 
@@ -286,6 +286,7 @@ void io_mux_call::polling_loops()
     int check_timer_countdown = 1; // Poll once before checking the time
     int poll_os_countdown = 0;
     bool multiple_polling_loops, finite_polling;
+    adaptive_poll *p_adaptive_poll;
     timeval before_polling_timer = TIMEVAL_INITIALIZER, after_polling_timer = TIMEVAL_INITIALIZER,
             delta;
 
@@ -297,6 +298,24 @@ void io_mux_call::polling_loops()
     finite_polling = m_n_sysvar_select_poll_num != -1;
     multiple_polling_loops = m_n_sysvar_select_poll_num != 0;
 
+    // The adaptive controller replaces the fixed polling duration
+    p_adaptive_poll = get_adaptive_poll();
+    if (p_adaptive_poll) {
+        switch (p_adaptive_poll->begin_wait()) {
+        case ADAPTIVE_POLL_SPIN:
+            ++m_p_stats->n_iomux_adaptive_spin;
+            break;
+        case ADAPTIVE_POLL_YIELD:
+            ++m_p_stats->n_iomux_adaptive_yield;
+            break;
+        default:
+            ++m_p_stats->n_iomux_adaptive_block;
+            break;
+        }
+        finite_polling = false;
+        multiple_polling_loops = true;
+    }
+
     timeval poll_duration;
     tv_clear(&poll_duration);
     poll_duration.tv_usec = m_n_sysvar_select_poll_num;
@@ -376,6 +395,10 @@ void io_mux_call::polling_loops()
             errno = EINTR;
             xlio_throw_object(io_mux_call::io_error);
         }
+
+        if (p_adaptive_poll && !p_adaptive_poll->keep_polling()) {
+            break;
+        }
     } while (m_n_all_ready_fds == 0 && multiple_polling_loops);
 
     if (m_b_sysvar_select_handle_cpu_usage_stats) {
@@ -509,6 +532,11 @@ int io_mux_call::call()
 
 done:
 
+    adaptive_poll *p_adaptive_poll = get_adaptive_poll();
+    if (p_adaptive_poll && p_adaptive_poll->is_waiting()) {
+        p_adaptive_poll->end_wait();
+    }
+
     if (m_n_all_ready_fds == 0) { // TODO: check
         // An error throws an exception
         ++m_p_stats->n_iomux_timeouts;
@@ -248,6 +248,11 @@ protected:
 
     virtual bool handle_os_countdown(int &poll_os_countdown);
 
+    /**
+     * @return Controller which replaces XLIO_SELECT_POLL_NUM for this call or nullptr
+     */
+    virtual adaptive_poll *get_adaptive_poll() { return nullptr; }
+
     /// Pointer to an array of all offloaded fd's
     int *m_p_all_offloaded_fds;
     offloaded_mode_t *m_p_offloaded_modes;
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "os_uring_poller.h"
+
+#ifdef DEFINED_IO_URING
+
+#include <algorithm>
+#include <errno.h>
+#include <endian.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "vlogger/vlogger.h"
+#include "util/vtypes.h"
+#include "sock/sock-redirect.h"
+
+#define MODULE_NAME "os_uring_poller"
+
+// Multishot poll (Linux 5.13), older kernels reject it with EINVAL
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE (1U << 1)
+#endif
+
+#define OS_URING_SQ_ENTRIES 256
+#define OS_URING_CQ_ENTRIES 4096
+// user_data of remove requests, their completions are ignored
+#define OS_URING_REMOVE_DATA (~0ULL)
+// Flags of the epoll interface which are emulated and must not reach the poll request
+#define OS_URING_EPOLL_FLAGS (EPOLLET | EPOLLONESHOT | EPOLLEXCLUSIVE | EPOLLWAKEUP)
+
+static inline int io_uring_setup(unsigned entries, io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static inline int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static inline uint64_t os_uring_data(int fd, uint32_t gen)
+{
+    return ((uint64_t)gen << 32) | (uint32_t)fd;
+}
+
+os_uring_poller::os_uring_poller()
+{
+    if (!setup()) {
+        __log_dbg("io_uring is not available (errno=%d), using OS epoll for non offloaded fds",
+                  errno);
+        cleanup();
+    }
+}
+
+os_uring_poller::~os_uring_poller()
+{
+    cleanup();
+}
+
+void os_uring_poller::cleanup()
+{
+    // Closing the ring cancels all the poll requests
+    if (m_ring_fd >= 0) {
+        SYSCALL(close, m_ring_fd);
+        m_ring_fd = -1;
+    }
+    if (m_notify_fd >= 0) {
+        SYSCALL(close, m_notify_fd);
+        m_notify_fd = -1;
+    }
+    if (m_sqes) {
+        munmap(m_sqes, m_sqes_size);
+        m_sqes = nullptr;
+    }
+    if (m_cq_ptr && m_cq_ptr != m_sq_ptr) {
+        munmap(m_cq_ptr, m_cq_size);
+    }
+    if (m_sq_ptr) {
+        munmap(m_sq_ptr, m_sq_size);
+    }
+    m_cq_ptr = m_sq_ptr = nullptr;
+}
+
+bool os_uring_poller::setup()
+{
+    io_uring_params p;
+
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = OS_URING_CQ_ENTRIES;
+    m_ring_fd = io_uring_setup(OS_URING_SQ_ENTRIES, &p);
+    if (m_ring_fd < 0) {
+        return false;
+    }
+
+    // Overflowed completions must not be lost and the eventfd must be switchable (5.8+)
+    if (!(p.features & IORING_FEAT_NODROP) || !p.cq_off.flags) {
+        errno = ENOTSUP;
+        return false;
+    }
+
+    m_sq_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+    }
+
+    m_sq_ptr = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ptr == MAP_FAILED) {
+        m_sq_ptr = nullptr;
+        return false;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        m_cq_ptr = m_sq_ptr;
+    } else {
+        m_cq_ptr = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ring_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ptr == MAP_FAILED) {
+            m_cq_ptr = nullptr;
+            return false;
+        }
+    }
+    m_sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = (io_uring_sqe *)mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED) {
+        m_sqes = nullptr;
+        return false;
+    }
+
+    uint8_t *sq = (uint8_t *)m_sq_ptr;
+    uint8_t *cq = (uint8_t *)m_cq_ptr;
+    m_sq_head = (uint32_t *)(sq + p.sq_off.head);
+    m_sq_tail = (uint32_t *)(sq + p.sq_off.tail);
+    m_sq_flags = (uint32_t *)(sq + p.sq_off.flags);
+    m_sq_mask = *(uint32_t *)(sq + p.sq_off.ring_mask);
+    m_sq_entries = *(uint32_t *)(sq + p.sq_off.ring_entries);
+    m_sq_local_tail = *m_sq_tail;
+    uint32_t *sq_array = (uint32_t *)(sq + p.sq_off.array);
+    for (uint32_t i = 0; i < m_sq_entries; ++i) {
+        sq_array[i] = i;
+    }
+    m_cq_head = (uint32_t *)(cq + p.cq_off.head);
+    m_cq_tail = (uint32_t *)(cq + p.cq_off.tail);
+    m_cq_flags = (uint32_t *)(cq + p.cq_off.flags);
+    m_cq_mask = *(uint32_t *)(cq + p.cq_off.ring_mask);
+    m_cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    m_notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_notify_fd < 0 ||
+        io_uring_register(m_ring_fd, IORING_REGISTER_EVENTFD, &m_notify_fd, 1) < 0) {
+        return false;
+    }
+    __atomic_store_n(m_cq_flags, IORING_CQ_EVENTFD_DISABLED, __ATOMIC_RELEASE);
+
+    m_multishot = probe_multishot();
+    if (!m_multishot) {
+        static bool s_logged = false;
+        if (!s_logged) {
+            s_logged = true;
+            __log_info("io_uring has no multishot poll, EPOLLET fds are watched by the OS epoll");
+        }
+    }
+
+    __log_dbg("io_uring fd=%d with %u sq and %u cq entries, multishot=%d", m_ring_fd,
+              p.sq_entries, p.cq_entries, m_multishot);
+    return true;
+}
+
+/* Kernels without multishot poll fail the request when it is submitted, otherwise it
+ * waits on the idle eventfd and is removed right away. The eventfd is not a watched fd,
+ * so reap() drops the completions of the probe.
+ */
+bool os_uring_poller::probe_multishot()
+{
+    fd_entry probe = {EPOLLIN | EPOLLET, 0U, 0U, 0};
+
+    m_multishot = true;
+    prep_poll_add(m_notify_fd, probe);
+    if (submit() < 0) {
+        return false;
+    }
+
+    uint32_t head = *m_cq_head;
+    if (head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+        bool rejected = (m_cqes[head & m_cq_mask].res == -EINVAL);
+        __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+        if (rejected) {
+            return false;
+        }
+    }
+
+    prep_poll_remove(m_notify_fd, probe);
+    submit();
+    return true;
+}
+
+io_uring_sqe *os_uring_poller::get_sqe()
+{
+    if (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+        submit();
+        if (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+            return nullptr;
+        }
+    }
+
+    io_uring_sqe *sqe = &m_sqes[m_sq_local_tail & m_sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++m_sq_local_tail;
+    // Read without the owner lock by has_pending()
+    __atomic_store_n(&m_to_submit, m_to_submit + 1, __ATOMIC_RELAXED);
+    return sqe;
+}
+
+void os_uring_poller::prep_poll_add(int fd, const fd_entry &entry)
+{
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) {
+        __log_dbg("no free sqe to poll fd=%d", fd);
+        return;
+    }
+
+    uint32_t poll_mask = entry.events & ~OS_URING_EPOLL_FLAGS;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    poll_mask = (poll_mask << 16) | (poll_mask >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = poll_mask;
+    if ((entry.events & EPOLLET) && m_multishot) {
+        sqe->len = IORING_POLL_ADD_MULTI;
+    }
+    sqe->user_data = os_uring_data(fd, entry.gen);
+}
+
+void os_uring_poller::prep_poll_remove(int fd, const fd_entry &entry)
+{
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) {
+        __log_dbg("no free sqe to stop polling fd=%d", fd);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = os_uring_data(fd, entry.gen);
+    sqe->user_data = OS_URING_REMOVE_DATA;
+}
+
+int os_uring_poller::submit()
+{
+    if (!m_to_submit) {
+        return 0;
+    }
+
+    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+    int ret = io_uring_enter(m_ring_fd, m_to_submit, 0, 0);
+    if (ret < 0) {
+        __log_dbg("io_uring_enter failed (errno=%d)", errno);
+        return ret;
+    }
+    __atomic_store_n(&m_to_submit, m_to_submit - std::min<uint32_t>(ret, m_to_submit),
+                     __ATOMIC_RELAXED);
+    return ret;
+}
+
+int os_uring_poller::add_fd(int fd, uint32_t events)
+{
+    if (is_registered(fd)) {
+        errno = EEXIST;
+        return -1;
+    }
+    if (!can_watch(events)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    fd_entry &entry = m_fds[fd];
+    entry.events = events;
+    entry.gen = ++m_gen;
+    entry.reap_seq = 0;
+    entry.reap_idx = 0;
+    prep_poll_add(fd, entry);
+    if (submit() < 0) {
+        m_fds.erase(fd);
+        return -1;
+    }
+    return 0;
+}
+
+int os_uring_poller::mod_fd(int fd, uint32_t events)
+{
+    auto iter = m_fds.find(fd);
+    if (iter == m_fds.end()) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (!can_watch(events)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    prep_poll_remove(fd, iter->second);
+    iter->second.events = events;
+    iter->second.gen = ++m_gen;
+    prep_poll_add(fd, iter->second);
+    return submit() < 0 ? -1 : 0;
+}
+
+int os_uring_poller::del_fd(int fd)
+{
+    auto iter = m_fds.find(fd);
+    if (iter == m_fds.end()) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    // The request holds a file reference, remove it before the fd can be closed
+    prep_poll_remove(fd, iter->second);
+    m_fds.erase(iter);
+    return submit() < 0 ? -1 : 0;
+}
+
+bool os_uring_poller::has_pending() const
+{
+    return __atomic_load_n(&m_to_submit, __ATOMIC_RELAXED) ||
+        __atomic_load_n(m_cq_head, __ATOMIC_RELAXED) !=
+        __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) ||
+        (__atomic_load_n(m_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW);
+}
+
+int os_uring_poller::reap(epoll_event *events, int max)
+{
+    /* Rearm the requests of the previous reap now that the caller handled the events,
+     * a still ready fd completes inline like a level triggered epoll_wait() reports it.
+     */
+    submit();
+
+    if (unlikely(__atomic_load_n(m_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW)) {
+        // Flush the completions which the kernel kept aside
+        io_uring_enter(m_ring_fd, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+
+    uint32_t head = *m_cq_head;
+    uint32_t tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+    int n = 0;
+
+    if (head == tail) {
+        return 0;
+    }
+
+    ++m_reap_seq;
+    while (head != tail && n < max) {
+        io_uring_cqe *cqe = &m_cqes[head & m_cq_mask];
+        ++head;
+
+        if (cqe->user_data == OS_URING_REMOVE_DATA) {
+            continue;
+        }
+        int fd = (int)(uint32_t)cqe->user_data;
+        auto iter = m_fds.find(fd);
+        if (iter == m_fds.end() || iter->second.gen != (uint32_t)(cqe->user_data >> 32)) {
+            continue; // Completion of a removed or modified request
+        }
+        fd_entry &entry = iter->second;
+
+        uint32_t revents = (cqe->res < 0) ? EPOLLERR : (uint32_t)cqe->res;
+
+        // Level triggered and terminated multishot requests are rearmed by the next reap
+        if (!(cqe->flags & IORING_CQE_F_MORE) && !(entry.events & EPOLLONESHOT)) {
+            prep_poll_add(fd, entry);
+        }
+
+        if (entry.reap_seq == m_reap_seq) {
+            events[entry.reap_idx].events |= revents;
+        } else {
+            entry.reap_seq = m_reap_seq;
+            entry.reap_idx = n;
+            events[n].events = revents;
+            events[n].data.u64 = 0;
+            events[n].data.fd = fd;
+            ++n;
+        }
+    }
+    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+bool os_uring_poller::prepare_to_sleep()
+{
+    submit();
+    __atomic_store_n(m_cq_flags, 0, __ATOMIC_RELEASE);
+    // Completions posted before the notification was enabled did not signal the eventfd
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return *m_cq_head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) ||
+        (__atomic_load_n(m_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW);
+}
+
+void os_uring_poller::return_from_sleep()
+{
+    __atomic_store_n(m_cq_flags, IORING_CQ_EVENTFD_DISABLED, __ATOMIC_RELEASE);
+}
+
+void os_uring_poller::drain_notify_fd()
+{
+    uint64_t value;
+    if (SYSCALL(read, m_notify_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        __log_dbg("failed to read eventfd=%d (errno=%d)", m_notify_fd, errno);
+    }
+}
+
+#endif /* DEFINED_IO_URING */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OS_URING_POLLER_H
+#define OS_URING_POLLER_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <unordered_map>
+
+#include "config.h"
+
+#ifdef DEFINED_IO_URING
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @class os_uring_poller
+ *
+ * Watches non offloaded fds of an epoll set with io_uring poll requests
+ * (XLIO_EPOLL_OS_URING). Readiness is reaped from the shared completion ring
+ * without a system call, io_uring_enter() is called only to (re)arm requests.
+ * Level triggered fds use single shot requests which are rearmed after every
+ * report, so a still ready fd completes again, EPOLLET fds use multishot
+ * requests and EPOLLONESHOT fds are not rearmed until they are modified.
+ * Rearmed requests would report EPOLLET fds as level triggered, so without
+ * multishot poll (Linux < 5.13) these fds are refused and stay in the OS epoll.
+ *
+ * The notification eventfd is registered in the OS epoll fd for blocking waits.
+ * Its notifications are disabled while the caller polls.
+ *
+ * Not thread safe, the owner serializes the calls.
+ */
+class os_uring_poller {
+public:
+    os_uring_poller();
+    ~os_uring_poller();
+
+    // Whether the ring was set up, otherwise the owner falls back to the OS epoll
+    bool is_valid() const { return m_ring_fd >= 0; }
+    int get_notify_fd() const { return m_notify_fd; }
+    bool is_registered(int fd) const { return m_fds.find(fd) != m_fds.end(); }
+    bool can_watch(uint32_t events) const { return m_multishot || !(events & EPOLLET); }
+
+    int add_fd(int fd, uint32_t events);
+    int mod_fd(int fd, uint32_t events);
+    int del_fd(int fd);
+
+    /**
+     * Whether reap() has completions to report or requests to rearm. Unlike the rest of
+     * the methods it may be called without the owner lock, to skip idle poll iterations.
+     */
+    bool has_pending() const;
+
+    /**
+     * Reaps ready fds into events (data.fd is set) and rearms the requests.
+     * @return Number of filled events.
+     */
+    int reap(epoll_event *events, int max);
+
+    // Enables the eventfd notification and returns whether completions are already pending
+    bool prepare_to_sleep();
+    void return_from_sleep();
+    void drain_notify_fd();
+
+private:
+    struct fd_entry {
+        uint32_t events;
+        uint32_t gen; // Distinguishes completions of a removed request
+        uint32_t reap_seq;
+        int reap_idx;
+    };
+
+    bool setup();
+    void cleanup();
+    bool probe_multishot();
+    io_uring_sqe *get_sqe();
+    void prep_poll_add(int fd, const fd_entry &entry);
+    void prep_poll_remove(int fd, const fd_entry &entry);
+    int submit();
+
+    int m_ring_fd = -1;
+    int m_notify_fd = -1;
+    void *m_sq_ptr = nullptr;
+    size_t m_sq_size = 0;
+    void *m_cq_ptr = nullptr;
+    size_t m_cq_size = 0;
+    io_uring_sqe *m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+
+    uint32_t *m_sq_head = nullptr;
+    uint32_t *m_sq_tail = nullptr;
+    uint32_t *m_sq_flags = nullptr;
+    uint32_t m_sq_mask = 0;
+    uint32_t m_sq_entries = 0;
+    uint32_t m_sq_local_tail = 0;
+    uint32_t *m_cq_head = nullptr;
+    uint32_t *m_cq_tail = nullptr;
+    uint32_t *m_cq_flags = nullptr;
+    uint32_t m_cq_mask = 0;
+    io_uring_cqe *m_cqes = nullptr;
+
+    uint32_t m_to_submit = 0;
+    uint32_t m_gen = 0;
+    uint32_t m_reap_seq = 0;
+    bool m_multishot = true;
+    std::unordered_map<int, fd_entry> m_fds;
+};
+
+#endif /* DEFINED_IO_URING */
+
+#endif /* OS_URING_POLLER_H */
@@ -57,8 +57,7 @@ poll_call::poll_call(int *off_rfds_buffer, offloaded_mode_t *off_modes_buffer, i
     m_fds = nullptr;
 
     // create stats
-    m_p_stats = &g_poll_stats;
-    xlio_stats_instance_get_poll_block(m_p_stats);
+    m_p_stats = xlio_stats_instance_get_poll_block(&g_poll_stats);
 
     // Collect offloaded fds and remove all tcp (skip_os) sockets from m_fds
     for (i = 0; i < m_nfds; ++i) {
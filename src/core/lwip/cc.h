@@ -89,7 +89,7 @@ struct tcp_pcb;
 #include <stdint.h>
 
 /* types of different cc algorithms */
-enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE };
+enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE, CC_MOD_DCTCP };
 
 /* ACK types passed to the ack_received() hook. */
 #define CC_ACK        0x0001 /* Regular in sequence ACK. */
@@ -111,6 +111,9 @@ enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE };
 
 #define TCP_CA_NAME_MAX 16 /* max congestion control name length */
 
+/* cc_algo flags. */
+#define CC_ALGO_NEEDS_ECN 0x0001 /* Negotiate ECN and echo every CE mark (RFC 8257). */
+
 /*
  * Structure to hold data and function pointers that together represent a
  * congestion control algorithm.
@@ -138,11 +141,15 @@ struct cc_algo {
 
     /* Called when data transfer resumes after an idle period. */
     void (*after_idle)(struct tcp_pcb *pcb);
+
+    /* CC_ALGO_* flags. */
+    uint32_t flags;
 };
 
 extern struct cc_algo lwip_cc_algo;
 extern struct cc_algo cubic_cc_algo;
 extern struct cc_algo none_cc_algo;
+extern struct cc_algo dctcp_cc_algo;
 
 void cc_init(struct tcp_pcb *pcb);
 void cc_destroy(struct tcp_pcb *pcb);
@@ -270,6 +270,19 @@ static void cubic_cong_signal(struct tcp_pcb *pcb, uint32_t type)
         cubic_data->t_last_cong = ticks;
 
         break;
+
+    case CC_ECN:
+        /* React as to a loss, but without a recovery phase */
+        if (!tcp_ecn_in_cwr(pcb)) {
+            cubic_ssthresh_update(pcb);
+            cubic_data->num_cong_events++;
+            cubic_data->prev_max_cwnd = cubic_data->max_cwnd;
+            cubic_data->max_cwnd = pcb->cwnd;
+            pcb->cwnd = LWIP_MAX(pcb->ssthresh, 2U * pcb->mss);
+            cubic_data->t_last_cong = ticks;
+            cubic_data->K = cubic_k(cubic_data->max_cwnd / pcb->mss);
+        }
+        break;
     }
 }
 
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Data Center TCP (RFC 8257).
+ * The sender estimates the fraction of bytes which experienced congestion once
+ * per window of data and reduces cwnd in proportion to it on ECN-Echo, instead
+ * of halving it. The window growth and the loss reaction follow the lwip
+ * algorithm, so DCTCP behaves as it when the peer does not negotiate ECN.
+ */
+
+#include "core/lwip/cc.h"
+#include "core/lwip/tcp.h"
+#include "core/lwip/tcp_impl.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if TCP_CC_ALGO_MOD
+
+#define DCTCP_SHIFT     10 /* Fixed point precision of alpha */
+#define DCTCP_MAX_ALPHA (1U << DCTCP_SHIFT)
+#define DCTCP_SHIFT_G   4 /* Estimation gain g = 1/16 */
+
+static int dctcp_cb_init(struct tcp_pcb *pcb);
+static void dctcp_cb_destroy(struct tcp_pcb *pcb);
+static void dctcp_ack_received(struct tcp_pcb *pcb, uint16_t type);
+static void dctcp_cong_signal(struct tcp_pcb *pcb, uint32_t type);
+static void dctcp_conn_init(struct tcp_pcb *pcb);
+static void dctcp_post_recovery(struct tcp_pcb *pcb);
+
+struct dctcp {
+    /* Estimated fraction of marked bytes, DCTCP_MAX_ALPHA stands for 1. */
+    uint32_t alpha;
+    /* Bytes acknowledged in the current observation window. */
+    uint32_t bytes_acked;
+    /* Bytes acknowledged with ECN-Echo in the current observation window. */
+    uint32_t bytes_marked;
+    /* The observation window ends when this sequence number is acknowledged. */
+    uint32_t window_end;
+    /* The ACK being processed carries ECN-Echo. */
+    int ece;
+};
+
+struct cc_algo dctcp_cc_algo = {.name = "dctcp",
+                                .init = dctcp_cb_init,
+                                .destroy = dctcp_cb_destroy,
+                                .ack_received = dctcp_ack_received,
+                                .cong_signal = dctcp_cong_signal,
+                                .conn_init = dctcp_conn_init,
+                                .post_recovery = dctcp_post_recovery,
+                                .flags = CC_ALGO_NEEDS_ECN};
+
+static int dctcp_cb_init(struct tcp_pcb *pcb)
+{
+    struct dctcp *dctcp_data;
+
+    dctcp_data = malloc(sizeof(struct dctcp));
+    if (dctcp_data == NULL) {
+        return (ENOMEM);
+    }
+    memset(dctcp_data, 0, sizeof(*dctcp_data));
+
+    /* Start conservatively, the first reduction halves the window. */
+    dctcp_data->alpha = DCTCP_MAX_ALPHA;
+    dctcp_data->window_end = pcb->snd_nxt;
+
+    pcb->cc_data = dctcp_data;
+
+    return (0);
+}
+
+static void dctcp_cb_destroy(struct tcp_pcb *pcb)
+{
+    if (pcb->cc_data != NULL) {
+        free(pcb->cc_data);
+        pcb->cc_data = NULL;
+    }
+}
+
+static void dctcp_conn_init(struct tcp_pcb *pcb)
+{
+    struct dctcp *dctcp_data = pcb->cc_data;
+
+    lwip_cc_algo.conn_init(pcb);
+    dctcp_data->bytes_acked = 0;
+    dctcp_data->bytes_marked = 0;
+    dctcp_data->window_end = pcb->snd_nxt;
+}
+
+/*
+ * alpha = (1 - g) * alpha + g * F, where F is the fraction of bytes
+ * acknowledged with ECN-Echo during the last window of data.
+ */
+static void dctcp_update_alpha(struct tcp_pcb *pcb)
+{
+    struct dctcp *dctcp_data = pcb->cc_data;
+    uint32_t alpha = dctcp_data->alpha;
+    uint32_t decay = alpha >> DCTCP_SHIFT_G;
+
+    /* Let alpha reach 0 when the decay underflows. */
+    alpha -= decay ? decay : alpha;
+    if (dctcp_data->bytes_marked && dctcp_data->bytes_acked) {
+        alpha += (uint32_t)(((uint64_t)dctcp_data->bytes_marked << (DCTCP_SHIFT - DCTCP_SHIFT_G)) /
+                            dctcp_data->bytes_acked);
+    }
+    dctcp_data->alpha = LWIP_MIN(alpha, DCTCP_MAX_ALPHA);
+
+    dctcp_data->bytes_acked = 0;
+    dctcp_data->bytes_marked = 0;
+    dctcp_data->window_end = pcb->snd_nxt;
+}
+
+static void dctcp_ack_received(struct tcp_pcb *pcb, uint16_t type)
+{
+    struct dctcp *dctcp_data = pcb->cc_data;
+
+    lwip_cc_algo.ack_received(pcb, type);
+
+    if (type == CC_ACK) {
+        dctcp_data->bytes_acked += pcb->acked;
+        if (dctcp_data->ece) {
+            dctcp_data->bytes_marked += pcb->acked;
+        }
+        if (TCP_SEQ_GEQ(pcb->lastack, dctcp_data->window_end)) {
+            dctcp_update_alpha(pcb);
+        }
+    }
+    dctcp_data->ece = 0;
+}
+
+/*
+ * ECN-Echo is signalled for every marked ACK before the ACK itself is
+ * processed. The window is reduced at most once per window of data.
+ */
+static void dctcp_cong_signal(struct tcp_pcb *pcb, uint32_t type)
+{
+    struct dctcp *dctcp_data = pcb->cc_data;
+
+    switch (type) {
+    case CC_ECN:
+        dctcp_data->ece = 1;
+        if (!tcp_ecn_in_cwr(pcb)) {
+            /* cwnd = cwnd * (1 - alpha / 2) */
+            u32_t reduction =
+                (u32_t)(((uint64_t)pcb->cwnd * dctcp_data->alpha) >> (DCTCP_SHIFT + 1));
+            pcb->cwnd = LWIP_MAX(pcb->cwnd - reduction, 2U * pcb->mss);
+            pcb->ssthresh = pcb->cwnd;
+        }
+        break;
+
+    default:
+        lwip_cc_algo.cong_signal(pcb, type);
+        break;
+    }
+}
+
+static void dctcp_post_recovery(struct tcp_pcb *pcb)
+{
+    lwip_cc_algo.post_recovery(pcb);
+}
+
+#endif // TCP_CC_ALGO_MOD
@@ -82,6 +82,7 @@
 
 #include "core/lwip/cc.h"
 #include "core/lwip/tcp.h"
+#include "core/lwip/tcp_impl.h"
 
 #if TCP_CC_ALGO_MOD
 
@@ -107,16 +108,16 @@ static void lwip_ack_received(struct tcp_pcb *pcb, uint16_t type)
             pcb->cwnd += pcb->mss;
         }
     } else if (type == CC_ACK) {
+        /* A stretch ACK counts as the delayed ACKs for every second segment it replaces,
+           so a receiver which acknowledges less often does not slow the window growth. */
+        u64_t acks = LWIP_MAX(1U, pcb->acked / (2U * pcb->mss));
+
         if (pcb->cwnd < pcb->ssthresh) {
-            if ((u32_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
-                pcb->cwnd += pcb->mss;
-            }
+            pcb->cwnd = (u32_t)LWIP_MIN(pcb->cwnd + acks * pcb->mss, 0xffffffffULL);
             LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: slow start cwnd %" U32_F "\n", pcb->cwnd));
         } else {
-            u32_t new_cwnd = (pcb->cwnd + ((u32_t)pcb->mss * (u32_t)pcb->mss) / pcb->cwnd);
-            if (new_cwnd > pcb->cwnd) {
-                pcb->cwnd = new_cwnd;
-            }
+            pcb->cwnd = (u32_t)LWIP_MIN(pcb->cwnd + acks * pcb->mss * pcb->mss / pcb->cwnd,
+                                        0xffffffffULL);
             LWIP_DEBUGF(TCP_CWND_DEBUG,
                         ("tcp_receive: congestion avoidance cwnd %" U32_F "\n", pcb->cwnd));
         }
@@ -125,6 +126,11 @@ static void lwip_ack_received(struct tcp_pcb *pcb, uint16_t type)
 
 static void lwip_cong_signal(struct tcp_pcb *pcb, uint32_t type)
 {
+    /* ECN halves the window once per window of data, as a loss would */
+    if (type == CC_ECN && tcp_ecn_in_cwr(pcb)) {
+        return;
+    }
+
     /* Set ssthresh to half of the minimum of the current
      * cwnd and the advertised window */
     if (pcb->cwnd > pcb->snd_wnd) {
@@ -146,6 +152,8 @@ static void lwip_cong_signal(struct tcp_pcb *pcb, uint32_t type)
         pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
     } else if (type == CC_RTO) {
         pcb->cwnd = pcb->mss;
+    } else if (type == CC_ECN) {
+        pcb->cwnd = pcb->ssthresh;
     }
 }
 
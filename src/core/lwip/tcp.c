@@ -57,6 +57,8 @@ tcp_seg_alloc_fn external_tcp_seg_alloc;
 tcp_seg_free_fn external_tcp_seg_free;
 /* allow user to be notified upon tcp_state changes */
 tcp_state_observer_fn external_tcp_state_observer;
+/* TCP Fast Open cookie generator, server side TFO is disabled if not set */
+tcp_fastopen_cookie_fn external_tcp_fastopen_cookie;
 
 void register_tcp_tx_pbuf_alloc(tcp_tx_pbuf_alloc_fn fn)
 {
@@ -88,6 +90,11 @@ void register_tcp_state_observer(tcp_state_observer_fn fn)
     external_tcp_state_observer = fn;
 }
 
+void register_tcp_fastopen_cookie(tcp_fastopen_cookie_fn fn)
+{
+    external_tcp_fastopen_cookie = fn;
+}
+
 enum cc_algo_mod lwip_cc_algo_module = CC_MOD_LWIP;
 
 u16_t lwip_tcp_mss = CONST_TCP_MSS;
@@ -95,6 +102,11 @@ u8_t enable_push_flag = 1;
 u8_t enable_ts_option = 0;
 u32_t lwip_tcp_snd_buf = 0;
 u32_t lwip_tcp_nodelay_treshold = 0;
+u32_t lwip_tcp_cork_timeout = 0;
+/* Delayed ACK policy, an ACK is sent once any enabled limit is reached */
+u32_t lwip_tcp_ack_segs = 2;
+u32_t lwip_tcp_ack_bytes = 0;
+u32_t lwip_tcp_ecn = TCP_ECN_OFF;
 
 /* slow timer value */
 static u32_t slow_tmr_interval;
@@ -513,6 +525,21 @@ void tcp_recved(struct tcp_pcb *pcb, u32_t len)
  */
 err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
                   tcp_connected_fn connected)
+{
+    return tcp_connect_fastopen(pcb, ipaddr, port, is_ipv6, connected, NULL, 0);
+}
+
+/**
+ * Connects to another host with TCP Fast Open. Behaves as tcp_connect(), but
+ * if pcb->tfo_flags has TCP_TFO_CLIENT, the SYN carries the cookie from pcb->tfo_cookie
+ * together with the data from iov or a cookie request if the cookie is empty.
+ * Number of bytes sent within SYN is stored in pcb->tfo_syn_len.
+ *
+ * @param iov data to send within SYN, or NULL
+ * @param iovcnt number of elements in iov
+ */
+err_t tcp_connect_fastopen(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
+                           tcp_connected_fn connected, const struct iovec *iov, u32_t iovcnt)
 {
     err_t ret;
     u32_t iss;
@@ -551,9 +578,14 @@ err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool
     pcb->cwnd = 1;
     pcb->ssthresh = pcb->mss * 10;
     pcb->connected = connected;
+    if (tcp_ecn_request(pcb)) {
+        /* Cleared unless the SYN-ACK confirms ECN */
+        pcb->flags |= TF_ECN;
+    }
 
     /* Send a SYN together with the MSS option. */
-    ret = tcp_enqueue_flags(pcb, TCP_SYN);
+    pcb->tfo_syn_len = 0;
+    ret = tcp_enqueue_syn_data(pcb, iov, iovcnt);
     if (ret == ERR_OK) {
         /* SYN segment was enqueued, changed the pcbs state now */
         set_tcp_state(pcb, SYN_SENT);
@@ -792,10 +824,18 @@ void tcp_fasttmr(struct tcp_pcb *pcb)
         /* send delayed ACKs */
         if (pcb->flags & TF_ACK_DELAY) {
             LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: delayed ACK\n"));
+            /* The stride was not reached within a tick, the peer may wait for this ACK */
+            tcp_ack_stride_reduce(pcb);
             tcp_ack_now(pcb);
             tcp_output(pcb);
             pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
         }
+        /* send a partial segment which is corked for too long */
+        if ((pcb->flags & TF_CORK_HELD) &&
+            (u32_t)(sys_now() - pcb->cork_time) >= lwip_tcp_cork_timeout) {
+            LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: cork timeout\n"));
+            tcp_output(pcb);
+        }
     }
 }
 
@@ -938,6 +978,9 @@ void tcp_pcb_init(struct tcp_pcb *pcb, u8_t prio, void *container)
     case CC_MOD_NONE:
         pcb->cc_algo = &none_cc_algo;
         break;
+    case CC_MOD_DCTCP:
+        pcb->cc_algo = &dctcp_cc_algo;
+        break;
     case CC_MOD_LWIP:
     default:
         pcb->cc_algo = &lwip_cc_algo;
@@ -968,6 +1011,8 @@ void tcp_pcb_init(struct tcp_pcb *pcb, u8_t prio, void *container)
 
     pcb->keep_cnt_sent = 0;
     pcb->quickack = 0;
+    pcb->ack_stride = TCP_ACK_STRIDE_INIT;
+    pcb->ack_stride_acks = 0;
     pcb->is_in_input = 0;
     pcb->enable_ts_opt = enable_ts_option;
     pcb->seg_alloc = NULL;
@@ -1011,10 +1056,15 @@ void tcp_pcb_recycle(struct tcp_pcb *pcb)
     pcb->recv = tcp_recv_null;
     pcb->keep_cnt_sent = 0;
     pcb->quickack = 0;
+    pcb->ack_stride = TCP_ACK_STRIDE_INIT;
+    pcb->ack_stride_acks = 0;
     pcb->is_in_input = 0;
     pcb->snd_queuelen = 0;
     pcb->snd_scale = 0;
     pcb->rcv_scale = 0;
+    pcb->tfo_flags = 0;
+    pcb->tfo_cookie_len = 0;
+    pcb->tfo_syn_len = 0;
     pcb->last_unsent = NULL;
     pcb->last_unacked = NULL;
     pcb->unsent_oversize = 0;
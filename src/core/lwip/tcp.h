@@ -51,6 +51,10 @@ void register_sys_now(sys_now_fn fn);
 extern u16_t lwip_tcp_mss;
 extern u32_t lwip_tcp_snd_buf;
 extern u32_t lwip_tcp_nodelay_treshold;
+extern u32_t lwip_tcp_cork_timeout;
+extern u32_t lwip_tcp_ack_segs;
+extern u32_t lwip_tcp_ack_bytes;
+extern u32_t lwip_tcp_ecn;
 
 struct tcp_seg;
 typedef err_t (*ip_output_fn)(struct pbuf *p, struct tcp_seg *seg, void *p_conn, u16_t flags);
@@ -198,6 +202,13 @@ typedef void (*tcp_state_observer_fn)(void *pcb_container, enum tcp_state new_st
 void register_tcp_state_observer(tcp_state_observer_fn fn);
 extern tcp_state_observer_fn external_tcp_state_observer;
 
+/* TCP Fast Open (RFC 7413) server cookie generator.
+ * Fills TCP_TFO_COOKIE_LEN bytes of cookie for the given client address.
+ */
+typedef void (*tcp_fastopen_cookie_fn)(const ip_addr_t *addr, bool is_ipv6, u8_t *cookie);
+void register_tcp_fastopen_cookie(tcp_fastopen_cookie_fn fn);
+extern tcp_fastopen_cookie_fn external_tcp_fastopen_cookie;
+
 /*
  * Option flags per-socket. These are the same like SO_XXX.
  */
@@ -218,6 +229,11 @@ extern tcp_state_observer_fn external_tcp_state_observer;
 #define SOF_INHERITED                                                                              \
     (SOF_REUSEADDR | SOF_KEEPALIVE | SOF_LINGER /*|SOF_DEBUG|SOF_DONTROUTE|SOF_OOBINLINE*/)
 
+/* TCP Fast Open cookie sizes (RFC 7413) */
+#define TCP_TFO_COOKIE_MIN 4U
+#define TCP_TFO_COOKIE_MAX 16U
+#define TCP_TFO_COOKIE_LEN 8U /* Size of cookies generated by a listener */
+
 #define RCV_WND_SCALE(pcb, wnd) (((wnd) >> (pcb)->rcv_scale))
 #define SND_WND_SCALE(pcb, wnd) ((u32_t)(wnd) << (pcb)->snd_scale)
 #define TCPWND_MIN16(x)         ((u16_t)LWIP_MIN((x), 0xFFFF))
@@ -269,16 +285,42 @@ struct tcp_pcb {
     u16_t remote_port;
 
     u16_t flags;
-#define TF_ACK_DELAY ((u16_t)0x0001U) /* Delayed ACK. */
-#define TF_ACK_NOW   ((u16_t)0x0002U) /* Immediate ACK. */
-#define TF_INFR      ((u16_t)0x0004U) /* In fast recovery. */
-#define TF_TIMESTAMP ((u16_t)0x0008U) /* Timestamp option enabled */
-#define TF_RXCLOSED  ((u16_t)0x0010U) /* rx closed by tcp_shutdown */
-#define TF_FIN       ((u16_t)0x0020U) /* Connection was closed locally (FIN segment enqueued). */
-#define TF_NODELAY   ((u16_t)0x0040U) /* Disable Nagle algorithm */
+#define TF_ACK_DELAY   ((u16_t)0x0001U) /* Delayed ACK. */
+#define TF_ACK_NOW     ((u16_t)0x0002U) /* Immediate ACK. */
+#define TF_INFR        ((u16_t)0x0004U) /* In fast recovery. */
+#define TF_TIMESTAMP   ((u16_t)0x0008U) /* Timestamp option enabled */
+#define TF_RXCLOSED    ((u16_t)0x0010U) /* rx closed by tcp_shutdown */
+#define TF_FIN         ((u16_t)0x0020U) /* Connection was closed locally (FIN segment enqueued). */
+#define TF_NODELAY     ((u16_t)0x0040U) /* Disable Nagle algorithm */
 #define TF_NAGLEMEMERR                                                                             \
     ((u16_t)0x0080U) /* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
-#define TF_WND_SCALE ((u16_t)0x0100U) /* Window Scale option enabled */
+#define TF_WND_SCALE   ((u16_t)0x0100U) /* Window Scale option enabled */
+#define TF_CORK        ((u16_t)0x0200U) /* Hold partial segments (TCP_CORK or MSG_MORE) */
+#define TF_CORK_HELD   ((u16_t)0x0400U) /* A partial segment is held since cork_time */
+#define TF_ECN         ((u16_t)0x0800U) /* ECN requested in SYN or negotiated */
+#define TF_ECN_SND_ECE ((u16_t)0x1000U) /* Set ECE in the outgoing segments */
+#define TF_ECN_SND_CWR ((u16_t)0x2000U) /* Set CWR in the next new data segment */
+
+    /* TCP Fast Open state */
+    u8_t tfo_flags;
+#define TCP_TFO_SERVER      ((u8_t)0x01U) /* Listener accepts SYN data */
+#define TCP_TFO_CLIENT      ((u8_t)0x02U) /* SYN carries a cookie or a cookie request */
+#define TCP_TFO_SYN_DATA    ((u8_t)0x04U) /* SYN carries data */
+#define TCP_TFO_ACCEPTED    ((u8_t)0x08U) /* Passive pcb was accepted on SYN */
+#define TCP_TFO_COOKIE_SEND ((u8_t)0x10U) /* SYN-ACK carries a cookie */
+#define TCP_TFO_COOKIE_RCVD ((u8_t)0x20U) /* SYN-ACK carried a cookie */
+    u8_t tfo_cookie_len;
+    u8_t tfo_cookie[TCP_TFO_COOKIE_MAX];
+    u16_t tfo_mss; /* Peer MSS cached together with the cookie */
+    u32_t tfo_syn_len; /* Data bytes sent within SYN */
+
+    u32_t cork_time; /* sys_now() when cork started to hold the last unsent segment */
+
+    /* Delayed ACK policy state, the pending counters are valid while TF_ACK_DELAY is set */
+    u16_t ack_stride; /* segments to ACK at once, grows up to lwip_tcp_ack_segs */
+    u16_t ack_stride_acks; /* ACKs sent with the current stride */
+    u16_t ack_pending_segs; /* in-order segments received since the last ACK */
+    u32_t ack_pending_bytes; /* in-order bytes received since the last ACK */
 
     /* the rest of the fields are in host byte order
        as we have to do some math with them */
@@ -320,6 +362,7 @@ struct tcp_pcb {
 #endif
     u32_t cwnd;
     u32_t ssthresh;
+    u32_t ecn_recover; /* snd_nxt at the last window reduction on ECE */
 
     /* sender variables */
     u32_t snd_nxt; /* next new seqno to be sent */
@@ -447,6 +490,9 @@ void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
 #define tcp_nagle_disable(pcb)  ((pcb)->flags |= TF_NODELAY)
 #define tcp_nagle_enable(pcb)   ((pcb)->flags &= ~TF_NODELAY)
 #define tcp_nagle_disabled(pcb) (((pcb)->flags & TF_NODELAY) != 0)
+#define tcp_cork_enable(pcb)    ((pcb)->flags |= TF_CORK)
+#define tcp_cork_disable(pcb)   ((pcb)->flags &= ~TF_CORK)
+#define tcp_corked(pcb)         (((pcb)->flags & TF_CORK) != 0)
 
 #define tcp_tso(pcb) ((pcb)->tso.max_payload_sz)
 
@@ -458,6 +504,8 @@ void tcp_recved(struct tcp_pcb *pcb, u32_t len);
 err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6);
 err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
                   tcp_connected_fn connected);
+err_t tcp_connect_fastopen(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
+                           tcp_connected_fn connected, const struct iovec *iov, u32_t iovcnt);
 
 err_t tcp_listen(struct tcp_pcb *listen_pcb, struct tcp_pcb *conn_pcb);
 
@@ -468,6 +516,7 @@ err_t tcp_shutdown(struct tcp_pcb *pcb, int shut_rx, int shut_tx);
 /* Flags for "apiflags" parameter in tcp_write */
 #define TCP_WRITE_FLAG_COPY 0x01
 #define TCP_WRITE_FLAG_MORE 0x02
+#define TCP_WRITE_ECT       0x04 /* Send the segment ECN capable, ECT(0) */
 #define TCP_WRITE_REXMIT    0x08
 #define TCP_WRITE_DUMMY     0x10
 #define TCP_WRITE_TSO       0x20
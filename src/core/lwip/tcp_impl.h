@@ -72,6 +72,8 @@ void set_tmr_resolution(u32_t v);
 #pragma GCC visibility pop
 #endif
 
+extern sys_now_fn sys_now;
+
 #define tcp_nodelay_treshold(tpcb)                                                                 \
     (((tpcb)->unsent != NULL) && ((tpcb)->unsent->len >= lwip_tcp_nodelay_treshold))
 
@@ -115,6 +117,30 @@ void set_tmr_resolution(u32_t v);
 
 #define TCP_FLAGS 0x3fU
 
+/* ECN field of the IP header (RFC 3168) */
+#define IP_ECN_MASK  0x03U
+#define IP_ECN_ECT_0 0x02U
+#define IP_ECN_CE    0x03U
+
+/* lwip_tcp_ecn values, as the tcp_ecn sysctl of Linux */
+#define TCP_ECN_OFF     0 /* Neither request nor accept ECN */
+#define TCP_ECN_ON      1 /* Request ECN on outgoing and accept on incoming connections */
+#define TCP_ECN_PASSIVE 2 /* Accept ECN on incoming connections only */
+
+#if TCP_CC_ALGO_MOD
+#define tcp_ecn_needed(pcb) ((pcb)->cc_algo->flags & CC_ALGO_NEEDS_ECN)
+#else
+#define tcp_ecn_needed(pcb) 0
+#endif
+/* DCTCP sends pure ACKs and retransmissions ECN capable too, as Linux does */
+#define tcp_ecn_ect_all(pcb) (((pcb)->flags & TF_ECN) && tcp_ecn_needed(pcb))
+#define tcp_ecn_request(pcb) (lwip_tcp_ecn == TCP_ECN_ON || tcp_ecn_needed(pcb))
+#define tcp_ecn_accept(pcb)  (lwip_tcp_ecn != TCP_ECN_OFF || tcp_ecn_needed(pcb))
+
+/* The window was already reduced for the current window of data or by a loss */
+#define tcp_ecn_in_cwr(pcb)                                                                        \
+    (((pcb)->flags & TF_INFR) || TCP_SEQ_LT((pcb)->lastack, (pcb)->ecn_recover))
+
 /* Length of the TCP header, excluding options. */
 #ifndef TCP_HLEN
 #define TCP_HLEN 20
@@ -163,6 +189,7 @@ PACK_STRUCT_END
 #define TCPH_OFFSET(phdr) (ntohs((phdr)->_hdrlen_rsvd_flags) >> 8)
 #define TCPH_HDRLEN(phdr) (ntohs((phdr)->_hdrlen_rsvd_flags) >> 12)
 #define TCPH_FLAGS(phdr)  (ntohs((phdr)->_hdrlen_rsvd_flags) & TCP_FLAGS)
+#define TCPH_ECN(phdr)    (ntohs((phdr)->_hdrlen_rsvd_flags) & (TCP_ECE | TCP_CWR))
 
 #define TCPH_OFFSET_SET(phdr, offset)                                                              \
     (phdr)->_hdrlen_rsvd_flags = htons(((offset) << 8) | TCPH_FLAGS(phdr))
@@ -178,6 +205,10 @@ PACK_STRUCT_END
     (phdr)->_hdrlen_rsvd_flags = ((phdr)->_hdrlen_rsvd_flags | htons(flags))
 #define TCPH_UNSET_FLAG(phdr, flags)                                                               \
     (phdr)->_hdrlen_rsvd_flags = (phdr)->_hdrlen_rsvd_flags & (~htons((flags) & (TCP_FLAGS)))
+#define TCPH_ECN_SET(phdr, flags)                                                                  \
+    (phdr)->_hdrlen_rsvd_flags =                                                                   \
+        (((phdr)->_hdrlen_rsvd_flags & PP_HTONS((u16_t)(~(u16_t)(TCP_ECE | TCP_CWR)))) |           \
+         htons(flags))
 
 #define TCP_TCPLEN(seg)                                                                            \
     ((seg)->len + (((TCPH_FLAGS((seg)->tcphdr) & (TCP_FIN | TCP_SYN)) != 0) ? 1U : 0U))
@@ -287,6 +318,7 @@ struct tcp_seg {
     u8_t flags;
 #define TF_SEG_OPTS_MSS       (u8_t)0x01U /* Include MSS option. */
 #define TF_SEG_OPTS_TS        (u8_t)0x02U /* Include timestamp option. */
+#define TF_SEG_OPTS_TFO       (u8_t)0x04U /* Include TCP Fast Open option */
 #define TF_SEG_OPTS_WNDSCALE  (u8_t)0x08U /* Include window scaling option */
 #define TF_SEG_OPTS_DUMMY_MSG (u8_t) TCP_WRITE_DUMMY /* Include dummy send option */
 #define TF_SEG_OPTS_TSO       (u8_t) TCP_WRITE_TSO /* Use TSO send mode */
@@ -318,6 +350,17 @@ struct tcp_seg {
     (flags & TF_SEG_OPTS_MSS ? 4 : 0) + (flags & TF_SEG_OPTS_WNDSCALE ? 1 + 3 : 0) +               \
         (flags & TF_SEG_OPTS_TS ? 12 : 0)
 
+/* TCP Fast Open option: kind, length and cookie, NOP-padded to 32 bits */
+#define LWIP_TCP_OPT_KIND_TFO        34U
+#define LWIP_TCP_OPT_LEN_TFO(cookie) ((2U + (cookie) + 3U) & ~3U)
+
+/* Length of options for a SYN or SYN-ACK segment. Unlike LWIP_TCP_OPT_LENGTH it accounts
+ * for TCP Fast Open option which size depends on the cookie stored in the pcb.
+ */
+#define LWIP_TCP_SYN_OPT_LENGTH(pcb, flags)                                                        \
+    (LWIP_TCP_OPT_LENGTH(flags) +                                                                  \
+     ((flags) & TF_SEG_OPTS_TFO ? LWIP_TCP_OPT_LEN_TFO((pcb)->tfo_cookie_len) : 0))
+
 /* This macro calculates total length of tcp header including
  * additional options
  */
@@ -355,23 +398,27 @@ void tcp_tx_segs_free(struct tcp_pcb *pcb, struct tcp_seg *seg);
 void tcp_tx_seg_free(struct tcp_pcb *pcb, struct tcp_seg *seg);
 struct tcp_seg *tcp_seg_copy(struct tcp_pcb *pcb, struct tcp_seg *seg);
 
-#define tcp_ack(pcb)                                                                               \
+#define tcp_ack_now(pcb)                                                                           \
     do {                                                                                           \
-        if ((pcb)->flags & TF_ACK_DELAY) {                                                         \
-            (pcb)->flags &= ~TF_ACK_DELAY;                                                         \
-            (pcb)->flags |= TF_ACK_NOW;                                                            \
-        } else {                                                                                   \
-            (pcb)->flags |= TF_ACK_DELAY;                                                          \
-        }                                                                                          \
+        (pcb)->flags |= TF_ACK_NOW;                                                                \
     } while (0)
 
-#define tcp_ack_now(pcb)                                                                           \
+/* Pending bytes which force an ACK, as a fraction of the advertised window */
+#define TCP_ACK_WND_DIV 8U
+
+/* Initial delayed ACK stride, as RFC 1122 recommends */
+#define TCP_ACK_STRIDE_INIT ((u16_t)LWIP_MIN(2U, lwip_tcp_ack_segs))
+
+/* The peer may be short of window, so the delayed ACK stride is halved */
+#define tcp_ack_stride_reduce(pcb)                                                                 \
     do {                                                                                           \
-        (pcb)->flags |= TF_ACK_NOW;                                                                \
+        (pcb)->ack_stride = LWIP_MAX((u16_t)((pcb)->ack_stride >> 1), TCP_ACK_STRIDE_INIT);        \
+        (pcb)->ack_stride_acks = 0;                                                                \
     } while (0)
 
 err_t tcp_send_fin(struct tcp_pcb *pcb);
 err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags);
+err_t tcp_enqueue_syn_data(struct tcp_pcb *pcb, const struct iovec *iov, u32_t iovcnt);
 
 void tcp_rst(u32_t seqno, u32_t ackno, u16_t local_port, u16_t remote_port, struct tcp_pcb *pcb);
 
@@ -51,6 +51,7 @@
 
 typedef struct parsed_ip_hdr {
     bool is_ipv6;
+    u8_t ecn;
     s16_t header_length;
     u16_t total_length;
     const void *src, *dest;
@@ -66,6 +67,8 @@ typedef struct tcp_in_data {
     u16_t tcplen;
     u8_t flags;
     u8_t recv_flags;
+    s8_t tfo_cookie_len; /* TCP Fast Open cookie length in SYN, -1 if there is no option */
+    const u8_t *tfo_cookie;
     struct tcp_seg inseg;
 } tcp_in_data;
 
@@ -78,6 +81,10 @@ static void tcp_parseopt(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static err_t tcp_timewait_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static s8_t tcp_quickack(struct tcp_pcb *pcb, tcp_in_data *in_data);
+static void tcp_ack_policy(struct tcp_pcb *pcb, u32_t segs, u32_t len);
+static void tcp_ecn_syn_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
+static void tcp_ecn_established(struct tcp_pcb *pcb);
+static void tcp_ecn_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
 
 /**
  * Send quickack if TCP_QUICKACK is enabled
@@ -94,6 +101,95 @@ s8_t tcp_quickack(struct tcp_pcb *pcb, tcp_in_data *in_data)
 #endif
 }
 
+/**
+ * Delayed ACK policy for in-order data.
+ * The ACK is delayed until ack_stride segments or lwip_tcp_ack_bytes bytes are
+ * received. tcp_fasttmr() bounds the delay in any case. The stride grows by one
+ * every stride ACKs up to lwip_tcp_ack_segs and is halved when the timer has to
+ * send the ACK, so a peer with a small congestion window is not left waiting for
+ * the timer. As in Linux __tcp_ack_snd_check(), more than one segment is not held
+ * once it takes 1/TCP_ACK_WND_DIV of the window advertised to the peer, which
+ * would otherwise run out of window while the ACK is delayed.
+ *
+ * @param segs number of segments received, GRO passes several segments at once
+ * @param len number of bytes received
+ */
+static void tcp_ack_policy(struct tcp_pcb *pcb, u32_t segs, u32_t len)
+{
+    u32_t ann_wnd_left = 0;
+
+    if (!(pcb->flags & TF_ACK_DELAY)) {
+        pcb->ack_pending_segs = 0;
+        pcb->ack_pending_bytes = 0;
+    }
+    pcb->ack_pending_segs = (u16_t)LWIP_MIN(pcb->ack_pending_segs + segs, 0xffffU);
+    pcb->ack_pending_bytes += len;
+    if (TCP_SEQ_GT(pcb->rcv_ann_right_edge, pcb->rcv_nxt)) {
+        ann_wnd_left = pcb->rcv_ann_right_edge - pcb->rcv_nxt;
+    }
+
+    if (pcb->ack_pending_segs >= pcb->ack_stride) {
+        if (pcb->ack_stride < lwip_tcp_ack_segs && ++pcb->ack_stride_acks >= pcb->ack_stride) {
+            pcb->ack_stride++;
+            pcb->ack_stride_acks = 0;
+        }
+        tcp_ack_now(pcb);
+    } else if (lwip_tcp_ack_bytes && pcb->ack_pending_bytes >= lwip_tcp_ack_bytes) {
+        tcp_ack_now(pcb);
+    } else if (pcb->ack_pending_segs > 1 &&
+               pcb->ack_pending_bytes >=
+                   (pcb->ack_pending_bytes + ann_wnd_left) / TCP_ACK_WND_DIV) {
+        tcp_ack_now(pcb);
+    } else {
+        pcb->flags |= TF_ACK_DELAY;
+    }
+}
+
+/**
+ * A SYN requests ECN with both ECE and CWR set (RFC 3168 6.1.1).
+ */
+static void tcp_ecn_syn_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    if (TCPH_ECN(in_data->tcphdr) == (TCP_ECE | TCP_CWR) && tcp_ecn_accept(pcb)) {
+        pcb->flags |= TF_ECN;
+    }
+}
+
+/**
+ * Once ECN is negotiated, new data segments are sent ECN capable, see tcp_output_segment().
+ */
+static void tcp_ecn_established(struct tcp_pcb *pcb)
+{
+    if (pcb->flags & TF_ECN) {
+        pcb->ecn_recover = pcb->lastack;
+    }
+}
+
+/**
+ * Reports the congestion experienced by a received segment to the sender.
+ * RFC 3168 repeats ECE until the sender confirms the window reduction with CWR.
+ * DCTCP echoes the CE state of every segment, so a delayed ACK never covers
+ * segments of both states (RFC 8257 3.2).
+ */
+static void tcp_ecn_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    u16_t ce = in_data->iphdr.ecn == IP_ECN_CE ? TF_ECN_SND_ECE : 0;
+
+    if (tcp_ecn_needed(pcb)) {
+        if (ce != (pcb->flags & TF_ECN_SND_ECE)) {
+            if (pcb->flags & TF_ACK_DELAY) {
+                tcp_send_empty_ack(pcb);
+            }
+            pcb->flags ^= TF_ECN_SND_ECE;
+        }
+    } else {
+        if (TCPH_ECN(in_data->tcphdr) & TCP_CWR) {
+            pcb->flags &= ~TF_ECN_SND_ECE;
+        }
+        pcb->flags |= ce;
+    }
+}
+
 static inline void fill_parsed_ip_hdr(const void *payload, parsed_ip_hdr_t *iphdr)
 {
     const u8_t *view_8bit = (const u8_t *)payload;
@@ -101,11 +197,13 @@ static inline void fill_parsed_ip_hdr(const void *payload, parsed_ip_hdr_t *iphd
 
     iphdr->is_ipv6 = (view_8bit[0] >> 4U) == IPV6_VERSION;
     if (iphdr->is_ipv6) {
+        iphdr->ecn = (view_8bit[1] >> 4U) & IP_ECN_MASK;
         iphdr->src = (void *)&view_8bit[8];
         iphdr->dest = (void *)&view_8bit[24];
         iphdr->header_length = 40;
         iphdr->total_length = ntohs(view_16bit[2U]) + iphdr->header_length;
     } else {
+        iphdr->ecn = view_8bit[1] & IP_ECN_MASK;
         iphdr->src = (const void *)&view_8bit[12];
         iphdr->dest = (const void *)&view_8bit[16];
         iphdr->header_length = ((view_8bit[0] & 0x0f) * 4);
@@ -263,8 +361,14 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
             }
         } else if (PCB_IN_LISTEN_STATE(pcb)) {
             LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for LISTENing connection.\n"));
+            /* tcp_listen_input() sets in_data.inseg.p to NULL if it passes SYN data
+               (TCP Fast Open) to the application */
+            in_data.inseg.p = p;
+            in_data.tfo_cookie_len = -1;
             tcp_listen_input(pcb, &in_data);
-            pbuf_free(p);
+            if (in_data.inseg.p != NULL) {
+                pbuf_free(p);
+            }
         } else if (PCB_IN_TIME_WAIT_STATE(pcb)) {
             LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for TIME_WAITing connection.\n"));
             tcp_timewait_input(pcb, &in_data);
@@ -286,6 +390,39 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
     }
 }
 
+/**
+ * Handles TCP Fast Open option of a SYN which arrived for a listening pcb.
+ *
+ * A valid cookie allows to accept data carried by the SYN. Otherwise, a cookie
+ * request or an invalid cookie makes the SYN-ACK carry a valid cookie and SYN data
+ * is left for the client to retransmit.
+ *
+ * @param pcb the listen tcp_pcb
+ * @param npcb the new pcb created for the SYN
+ * @return number of SYN data bytes which can be accepted
+ */
+static u32_t tcp_listen_fastopen(struct tcp_pcb *pcb, struct tcp_pcb *npcb, tcp_in_data *in_data)
+{
+    u8_t cookie[TCP_TFO_COOKIE_LEN];
+    u32_t len = in_data->inseg.p->tot_len;
+
+    if (!(pcb->tfo_flags & TCP_TFO_SERVER) || in_data->tfo_cookie_len < 0 ||
+        !external_tcp_fastopen_cookie) {
+        return 0;
+    }
+
+    external_tcp_fastopen_cookie(&npcb->remote_ip, npcb->is_ipv6, cookie);
+    if (in_data->tfo_cookie_len == TCP_TFO_COOKIE_LEN &&
+        memcmp(in_data->tfo_cookie, cookie, TCP_TFO_COOKIE_LEN) == 0) {
+        return len <= npcb->rcv_wnd ? len : 0;
+    }
+
+    memcpy(npcb->tfo_cookie, cookie, TCP_TFO_COOKIE_LEN);
+    npcb->tfo_cookie_len = TCP_TFO_COOKIE_LEN;
+    npcb->tfo_flags |= TCP_TFO_COOKIE_SEND;
+    return 0;
+}
+
 /**
  * Called by L3_level_tcp_input() when a segment arrives for a listening
  * connection (from L3_level_tcp_input()).
@@ -299,6 +436,7 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
 static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
 {
     struct tcp_pcb *npcb = NULL;
+    u32_t tfo_len;
     err_t rc;
 
     if (in_data->flags & (TCP_RST | TCP_FIN)) {
@@ -354,6 +492,16 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
         /* Parse any options in the SYN. */
         tcp_parseopt(npcb, in_data);
 
+#if TCP_CC_ALGO_MOD
+        /* The congestion control of the listener applies to its connections */
+        if (npcb->cc_algo != pcb->cc_algo) {
+            cc_destroy(npcb);
+            npcb->cc_algo = pcb->cc_algo;
+            cc_init(npcb);
+        }
+#endif
+        tcp_ecn_syn_input(npcb, in_data);
+
         npcb->rcv_wnd = TCP_WND_SCALED(npcb);
         npcb->rcv_ann_wnd = TCP_WND_SCALED(npcb);
         npcb->rcv_wnd_max = TCP_WND_SCALED(npcb);
@@ -367,6 +515,8 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
         UPDATE_PCB_BY_MSS(npcb, LWIP_MIN(npcb->mss, npcb->advtsd_mss));
 #endif /* TCP_CALCULATE_EFF_SEND_MSS */
 
+        tfo_len = tcp_listen_fastopen(pcb, npcb, in_data);
+
         /* Register the new PCB so that we can begin sending segments
          for it. */
         TCP_EVENT_SYN_RECEIVED(pcb, npcb, rc);
@@ -374,11 +524,40 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
             return;
         }
 
+        if (tfo_len) {
+            /* Accept the connection before the handshake completes, so the application
+               can read SYN data right away (TCP Fast Open). */
+            TCP_EVENT_ACCEPT(npcb, ERR_OK, rc);
+            if (rc == ERR_OK) {
+                npcb->tfo_flags |= TCP_TFO_ACCEPTED;
+                npcb->rcv_nxt += tfo_len;
+                npcb->rcv_ann_right_edge = npcb->rcv_nxt;
+                npcb->rcv_wnd -= tfo_len;
+            } else {
+                tfo_len = 0;
+            }
+        }
+
         /* Send a SYN|ACK together with the MSS option. */
         if (ERR_OK == tcp_enqueue_flags(npcb, TCP_SYN | TCP_ACK)) {
             tcp_output(npcb);
         } else {
             tcp_abandon(npcb, 0);
+            tfo_len = 0;
+        }
+
+        if (tfo_len) {
+            struct pbuf *p = in_data->inseg.p;
+
+            in_data->inseg.p = NULL;
+            if (in_data->flags & TCP_PSH) {
+                p->flags |= PBUF_FLAG_PUSH;
+            }
+            TCP_EVENT_RECV(npcb, p, ERR_OK, rc);
+            if (rc != ERR_OK && rc != ERR_ABRT) {
+                npcb->rcv_wnd += tfo_len;
+                pbuf_free(p);
+            }
         }
 
         TCP_EVENT_ACCEPTED_PCB(pcb, npcb);
@@ -400,6 +579,7 @@ static err_t tcp_pcb_reuse(struct tcp_pcb *pcb, tcp_in_data *in_data)
     pcb->mss = pcb->advtsd_mss = tcp_send_mss(pcb);
     /* Parse any options in the SYN. */
     tcp_parseopt(pcb, in_data);
+    tcp_ecn_syn_input(pcb, in_data);
     pcb->rcv_wnd = TCP_WND_SCALED(pcb);
     pcb->rcv_ann_wnd = TCP_WND_SCALED(pcb);
     pcb->rcv_wnd_max = TCP_WND_SCALED(pcb);
@@ -502,6 +682,36 @@ static err_t tcp_timewait_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
  * @note the segment which arrived is saved in global variables, therefore only the pcb
  *       involved is passed as a parameter to this function
  */
+/**
+ * Completes TCP Fast Open exchange on the client side when SYN-ACK arrives.
+ * If the server didn't acknowledge data sent within SYN, the data is queued again
+ * as a regular segment.
+ *
+ * @param pcb the tcp_pcb in SYN_SENT state which has just become ESTABLISHED
+ * @param rseg the SYN segment which is acknowledged
+ * @param ackno acknowledgement number of the SYN-ACK
+ * @return ERR_OK or an error if the data couldn't be queued
+ */
+static err_t tcp_fastopen_synack(struct tcp_pcb *pcb, struct tcp_seg *rseg, u32_t ackno)
+{
+    u32_t len = pcb->tfo_syn_len;
+
+    pcb->tfo_flags &= ~TCP_TFO_SYN_DATA;
+    if (ackno == rseg->seqno + 1 + len) {
+        pcb->snd_buf += len;
+        pcb->acked = len;
+        return ERR_OK;
+    }
+
+    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_process: SYN data is not acknowledged\n"));
+    pcb->tfo_syn_len = 0;
+    pcb->snd_nxt = ackno;
+    pcb->snd_lbb = ackno;
+    pcb->snd_buf += len;
+    return tcp_write(pcb, (u8_t *)rseg->tcphdr + LWIP_TCP_HDRLEN(rseg->tcphdr), len,
+                     TCP_WRITE_FLAG_COPY, NULL);
+}
+
 static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
 {
     struct tcp_seg *rseg;
@@ -559,9 +769,11 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
         LWIP_DEBUGF(TCP_INPUT_DEBUG,
                     ("SYN-SENT: ackno %" U32_F " pcb->snd_nxt %" U32_F " unacked %" U32_F "\n",
                      in_data->ackno, pcb->snd_nxt, ntohl(pcb->unacked->tcphdr->seqno)));
-        /* received SYN ACK with expected sequence number? */
+        /* received SYN ACK with expected sequence number? With TCP Fast Open the server
+           either acknowledges SYN data or the SYN only. */
         if ((in_data->flags & TCP_ACK) && (in_data->flags & TCP_SYN) &&
-            in_data->ackno == pcb->unacked->seqno + 1) {
+            (in_data->ackno == pcb->unacked->seqno + 1 ||
+             in_data->ackno == pcb->unacked->seqno + 1 + pcb->tfo_syn_len)) {
             // pcb->snd_buf++; SND_BUF_FOR_SYN_FIN
             pcb->rcv_nxt = in_data->seqno + 1;
             pcb->rcv_ann_right_edge = pcb->rcv_nxt;
@@ -570,6 +782,11 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 pcb, in_data->tcphdr->wnd); // Which means: tcphdr->wnd << pcb->snd_scale;
             pcb->snd_wnd_max = pcb->snd_wnd;
             pcb->snd_wl1 = in_data->seqno - 1; /* initialise to seqno - 1 to force window update */
+            /* A SYN-ACK confirms ECN with ECE only */
+            if (TCPH_ECN(in_data->tcphdr) != TCP_ECE) {
+                pcb->flags &= ~TF_ECN;
+            }
+            tcp_ecn_established(pcb);
             set_tcp_state(pcb, ESTABLISHED);
 
 #if TCP_CALCULATE_EFF_SEND_MSS
@@ -604,6 +821,14 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 pcb->nrtx = 0;
             }
 
+            if (pcb->tfo_flags & TCP_TFO_SYN_DATA) {
+                err = tcp_fastopen_synack(pcb, rseg, in_data->ackno);
+                if (err != ERR_OK) {
+                    tcp_tx_seg_free(pcb, rseg);
+                    tcp_abort(pcb);
+                    return ERR_ABRT;
+                }
+            }
             tcp_tx_seg_free(pcb, rseg);
 
             /* Call the user specified function to call when sucessfully
@@ -626,13 +851,18 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
             /* expected ACK number? */
             if (TCP_SEQ_BETWEEN(in_data->ackno, pcb->lastack + 1, pcb->snd_nxt)) {
                 u32_t old_cwnd;
+                tcp_ecn_established(pcb);
                 set_tcp_state(pcb, ESTABLISHED);
                 LWIP_DEBUGF(TCP_DEBUG,
                             ("TCP connection established %" U16_F " -> %" U16_F ".\n",
                              in_data->inseg.tcphdr->src, in_data->inseg.tcphdr->dest));
                 LWIP_ASSERT("pcb->accept != NULL", pcb->accept != NULL);
-                /* Call the accept function. */
-                TCP_EVENT_ACCEPT(pcb, ERR_OK, err);
+                /* Call the accept function, unless TCP Fast Open accepted the pcb on SYN. */
+                if (pcb->tfo_flags & TCP_TFO_ACCEPTED) {
+                    err = ERR_OK;
+                } else {
+                    TCP_EVENT_ACCEPT(pcb, ERR_OK, err);
+                }
                 if (err != ERR_OK) {
                     /* If the accept function returns with an error, we abort
                      * the connection. */
@@ -1105,6 +1335,18 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
             pcb->dupacks = 0;
             pcb->lastack = in_data->ackno;
 
+#if TCP_CC_ALGO_MOD
+            /* Every ECE is passed to the congestion control, which reduces the window
+               at most once per window of data. CWR confirms the reduction. */
+            if ((pcb->flags & TF_ECN) && (TCPH_ECN(in_data->tcphdr) & TCP_ECE)) {
+                cc_cong_signal(pcb, CC_ECN);
+                if (!tcp_ecn_in_cwr(pcb)) {
+                    pcb->ecn_recover = pcb->snd_nxt;
+                    pcb->flags |= TF_ECN_SND_CWR;
+                }
+            }
+#endif
+
             /* Update the congestion control variables (cwnd and
                ssthresh). */
             if (get_tcp_state(pcb) >= ESTABLISHED) {
@@ -1284,6 +1526,10 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
        (RFC 793, chapter 3.9, "SEGMENT ARRIVES" in states CLOSE-WAIT, CLOSING,
        LAST-ACK and TIME-WAIT: "Ignore the segment text.") */
     if ((in_data->tcplen > 0) && (get_tcp_state(pcb) < CLOSE_WAIT)) {
+        if (pcb->flags & TF_ECN) {
+            tcp_ecn_input(pcb, in_data);
+        }
+
         /* This code basically does three things:
 
         +) If the incoming segment contains data that is the next
@@ -1376,6 +1622,17 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
            processed. */
         if (TCP_SEQ_BETWEEN(in_data->seqno, pcb->rcv_nxt, pcb->rcv_nxt + pcb->rcv_wnd - 1)) {
             if (pcb->rcv_nxt == in_data->seqno) {
+                /* A segment which fills a hole is acknowledged immediately, so the
+                   sender learns about the repaired sequence without delay. */
+                bool fills_hole = false;
+#if TCP_QUEUE_OOSEQ
+                fills_hole = pcb->ooseq != NULL;
+                if (fills_hole) {
+                    /* The peer reduces its window after a loss */
+                    tcp_ack_stride_reduce(pcb);
+                }
+#endif /* TCP_QUEUE_OOSEQ */
+
                 /* The incoming segment is the next in sequence. We check if
                    we have to trim the end of the segment and update rcv_nxt
                    and pass the data to the application. */
@@ -1525,12 +1782,13 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 }
 #endif /* TCP_QUEUE_OOSEQ */
 
-                /* Acknowledge the segment(s). */
-                if ((in_data->recv_data && in_data->recv_data->next) ||
-                    tcp_quickack(pcb, in_data)) {
+                /* Acknowledge the segment(s). Congestion marks are reported at once. */
+                if (fills_hole || tcp_quickack(pcb, in_data) ||
+                    in_data->iphdr.ecn == IP_ECN_CE) {
                     tcp_ack_now(pcb);
                 } else {
-                    tcp_ack(pcb);
+                    tcp_ack_policy(pcb, in_data->recv_data ? pbuf_clen(in_data->recv_data) : 1U,
+                                   in_data->tcplen);
                 }
 
             } else {
@@ -1740,8 +1998,8 @@ static bool tcp_parseopt_ts(u8_t *opts, u16_t opts_len, u32_t *tsval)
  * Parses the options contained in the incoming segment.
  *
  * Called from tcp_listen_input(), tcp_process() and tcp_pcb_reuse().
- * Currently, only the MSS, window scaling and TIMESTAMP options are
- * supported!
+ * Currently, only the MSS, window scaling, TIMESTAMP and TCP Fast Open
+ * options are supported!
  *
  * @param pcb the tcp_pcb for which a segment arrived
  */
@@ -1831,6 +2089,29 @@ static void tcp_parseopt(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 c += 0x0A;
                 break;
 #endif
+            case LWIP_TCP_OPT_KIND_TFO:
+                LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: TFO\n"));
+                if (opts[c + 1] < 2 || opts[c + 1] > 2 + TCP_TFO_COOKIE_MAX ||
+                    c + opts[c + 1] > max_c) {
+                    /* Bad length */
+                    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+                    return;
+                }
+                if ((in_data->flags & (TCP_SYN | TCP_ACK)) == TCP_SYN) {
+                    /* Cookie or cookie request, validated by tcp_listen_input() */
+                    in_data->tfo_cookie = &opts[c + 2];
+                    in_data->tfo_cookie_len = opts[c + 1] - 2;
+                } else if ((in_data->flags & TCP_SYN) && (pcb->tfo_flags & TCP_TFO_CLIENT) &&
+                           get_tcp_state(pcb) == SYN_SENT &&
+                           opts[c + 1] - 2 >= (int)TCP_TFO_COOKIE_MIN) {
+                    /* Cookie for the next connections */
+                    pcb->tfo_cookie_len = opts[c + 1] - 2;
+                    memcpy(pcb->tfo_cookie, &opts[c + 2], pcb->tfo_cookie_len);
+                    pcb->tfo_flags |= TCP_TFO_COOKIE_RCVD;
+                }
+                /* Advance to next option */
+                c += opts[c + 1];
+                break;
             default:
                 LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: other\n"));
                 if (opts[c + 1] == 0) {
@@ -169,7 +169,7 @@ static struct tcp_seg *tcp_create_segment(struct tcp_pcb *pcb, struct pbuf *p, u
                                           u32_t seqno, u8_t optflags)
 {
     struct tcp_seg *seg;
-    u8_t optlen = LWIP_TCP_OPT_LENGTH(optflags);
+    u8_t optlen = LWIP_TCP_SYN_OPT_LENGTH(pcb, optflags);
 
     if (!pcb->seg_alloc) {
         // seg_alloc is not valid, we should allocate a new segment.
@@ -896,19 +896,21 @@ memerr:
 /**
  * Enqueue TCP options for transmission.
  *
- * Called by tcp_connect(), tcp_listen_input(), and tcp_send_ctrl().
+ * Called by tcp_enqueue_flags() and tcp_enqueue_syn_data().
  *
  * @param pcb Protocol control block for the TCP connection.
  * @param flags TCP header flags to set in the outgoing segment.
- * @param optdata pointer to TCP options, or NULL.
- * @param optlen length of TCP options in bytes.
+ * @param iov data to put into a SYN segment (TCP Fast Open), or NULL.
+ * @param iovcnt number of elements in iov.
  */
-err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
+static err_t tcp_enqueue_flags_data(struct tcp_pcb *pcb, u8_t flags, const struct iovec *iov,
+                                    u32_t iovcnt)
 {
     struct pbuf *p;
     struct tcp_seg *seg;
     u8_t optflags = 0;
     u8_t optlen = 0;
+    u32_t datalen = 0;
 
     LWIP_DEBUGF(TCP_QLEN_DEBUG,
                 ("tcp_enqueue_flags: queuelen: %" U16_F "\n", (u16_t)pcb->snd_queuelen));
@@ -943,20 +945,57 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
             optflags |= TF_SEG_OPTS_TS;
         }
 #endif
+        /* A SYN carries either a cookie or an empty cookie request, a SYN-ACK carries
+           a cookie only if the client requested it or presented an invalid one. */
+        if (pcb->tfo_flags & ((flags & TCP_ACK) ? TCP_TFO_COOKIE_SEND : TCP_TFO_CLIENT)) {
+            optflags |= TF_SEG_OPTS_TFO;
+        }
+        /* A SYN requests ECN with ECE and CWR, a SYN-ACK confirms it with ECE */
+        if (pcb->flags & TF_ECN) {
+            flags |= (flags & TCP_ACK) ? TCP_ECE : (TCP_ECE | TCP_CWR);
+        }
     }
 #if LWIP_TCP_TIMESTAMPS
     if ((pcb->flags & TF_TIMESTAMP)) {
         optflags |= TF_SEG_OPTS_TS;
     }
 #endif /* LWIP_TCP_TIMESTAMPS */
-    optlen = LWIP_TCP_OPT_LENGTH(optflags);
+    optlen = LWIP_TCP_SYN_OPT_LENGTH(pcb, optflags);
+
+    /* Data is sent within SYN only if we have a cookie for the server. */
+    if (iov && (optflags & TF_SEG_OPTS_TFO) && pcb->tfo_cookie_len) {
+        u32_t i;
+        /* Peer MSS is not known yet, use the one cached together with the cookie. */
+        u32_t mss = pcb->tfo_mss ? LWIP_MIN(pcb->mss, pcb->tfo_mss) : pcb->mss;
+        u32_t max_len = mss > optlen ? mss - optlen : 0;
+
+        max_len = LWIP_MIN(max_len, (u32_t)LWIP_MAX(pcb->snd_buf, 0));
+
+        for (i = 0; i < iovcnt && datalen < max_len; ++i) {
+            datalen += LWIP_MIN((u32_t)iov[i].iov_len, max_len - datalen);
+        }
+    }
 
     /* Allocate pbuf with room for TCP header + options */
-    if ((p = tcp_tx_pbuf_alloc(pcb, optlen, PBUF_RAM, NULL, NULL)) == NULL) {
+    if ((p = tcp_tx_pbuf_alloc(pcb, optlen + datalen, PBUF_RAM, NULL, NULL)) == NULL) {
         pcb->flags |= TF_NAGLEMEMERR;
         return ERR_MEM;
     }
 
+    if (datalen) {
+        u8_t *data = (u8_t *)p->payload + optlen;
+        u32_t left = datalen;
+        u32_t i;
+
+        for (i = 0; left; ++i) {
+            u32_t copy = LWIP_MIN((u32_t)iov[i].iov_len, left);
+
+            memcpy(data, iov[i].iov_base, copy);
+            data += copy;
+            left -= copy;
+        }
+    }
+
     /* Allocate memory for tcp_seg, and fill in fields. */
     if ((seg = tcp_create_segment(pcb, p, flags, pcb->snd_lbb, optflags)) == NULL) {
         pcb->flags |= TF_NAGLEMEMERR;
@@ -990,6 +1029,12 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
     if (flags & TCP_FIN) {
         pcb->flags |= TF_FIN;
     }
+    if (datalen) {
+        pcb->snd_lbb += datalen;
+        pcb->snd_buf -= datalen;
+        pcb->tfo_flags |= TCP_TFO_SYN_DATA;
+        pcb->tfo_syn_len = datalen;
+    }
 
     /* update number of segments on the queues */
     pcb->snd_queuelen += pbuf_clen(seg->p);
@@ -999,6 +1044,34 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
     return ERR_OK;
 }
 
+/**
+ * Enqueue TCP options for transmission.
+ *
+ * Called by tcp_connect(), tcp_listen_input(), and tcp_send_ctrl().
+ *
+ * @param pcb Protocol control block for the TCP connection.
+ * @param flags TCP header flags to set in the outgoing segment.
+ */
+err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
+{
+    return tcp_enqueue_flags_data(pcb, flags, NULL, 0);
+}
+
+/**
+ * Enqueue a SYN segment which carries data (TCP Fast Open).
+ *
+ * Data is put into the SYN only if pcb holds a cookie for the server, otherwise
+ * the SYN requests a cookie. Number of enqueued bytes is stored in pcb->tfo_syn_len.
+ *
+ * @param pcb Protocol control block for the TCP connection.
+ * @param iov data to send within SYN.
+ * @param iovcnt number of elements in iov.
+ */
+err_t tcp_enqueue_syn_data(struct tcp_pcb *pcb, const struct iovec *iov, u32_t iovcnt)
+{
+    return tcp_enqueue_flags_data(pcb, TCP_SYN, iov, iovcnt);
+}
+
 #if LWIP_TCP_TIMESTAMPS
 /* Build a timestamp option (12 bytes long) at the specified options pointer)
  *
@@ -1040,6 +1113,9 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
     LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_output: sending ACK for %" U32_F "\n", pcb->rcv_nxt));
     /* remove ACK flags from the PCB, as we send an empty ACK now */
     pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
+    if (pcb->flags & TF_ECN_SND_ECE) {
+        TCPH_SET_FLAG(tcphdr, TCP_ECE);
+    }
 
     opts = (u32_t *)(void *)(tcphdr + 1);
 
@@ -1052,7 +1128,7 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
         opts += 3;
     }
 #endif
-    pcb->ip_output(p, NULL, pcb, 0);
+    pcb->ip_output(p, NULL, pcb, tcp_ecn_ect_all(pcb) ? TCP_WRITE_ECT : 0);
     tcp_tx_pbuf_free(pcb, p);
 
     (void)opts; /* Fix warning -Wunused-but-set-variable */
@@ -1729,6 +1805,33 @@ s32_t tcp_is_wnd_available(struct tcp_pcb *pcb, u32_t data_len)
     return ((wnd - tot_unacked_len) >= (tot_unsent_len + (tot_opts_hdrs_len + (s32_t)data_len)));
 }
 
+/**
+ * Checks whether cork holds a segment (TCP_CORK or MSG_MORE). Only the last partial
+ * segment is held, until more data fills it up to MSS, the cork is removed or
+ * lwip_tcp_cork_timeout milliseconds pass. Cork takes precedence over TF_NODELAY.
+ *
+ * @param pcb the tcp_pcb
+ * @param seg the unsent segment which is going to be sent
+ * @return 1 if the segment must be held, 0 otherwise
+ */
+static int tcp_cork_hold(struct tcp_pcb *pcb, struct tcp_seg *seg)
+{
+    /* Same limit as tcp_xmit_size_goal() for a full segment */
+    u32_t full_len = LWIP_MIN((u32_t)pcb->mss, pcb->snd_wnd_max >> 1);
+
+    if (!(pcb->flags & TF_CORK) || !lwip_tcp_cork_timeout || seg->next ||
+        seg->len + LWIP_TCP_OPT_LENGTH(seg->flags) >= full_len || LWIP_IS_DUMMY_SEGMENT(seg) ||
+        (seg->tcp_flags & (TCP_SYN | TCP_FIN))) {
+        return 0;
+    }
+    if (!(pcb->flags & TF_CORK_HELD)) {
+        pcb->flags |= TF_CORK_HELD;
+        pcb->cork_time = sys_now();
+        return 1;
+    }
+    return (u32_t)(sys_now() - pcb->cork_time) < lwip_tcp_cork_timeout;
+}
+
 /**
  * Find out what we can send and send it
  *
@@ -1812,16 +1915,23 @@ err_t tcp_output(struct tcp_pcb *pcb)
             tcp_split_rexmit(pcb, seg);
         }
 
-        /* Split the segment in case of a small window */
-        if ((NULL == pcb->unacked) && (wnd) && ((seg->len + seg->seqno - pcb->lastack) > wnd)) {
+        /* Split the segment in case of a small window. SYN with data is never split,
+         * the window is not known before the handshake.
+         */
+        if ((NULL == pcb->unacked) && (wnd) && ((seg->len + seg->seqno - pcb->lastack) > wnd) &&
+            !(seg->tcp_flags & TCP_SYN)) {
             LWIP_ASSERT("tcp_output: no window for dummy packet", !LWIP_IS_DUMMY_SEGMENT(seg));
             tcp_split_segment(pcb, seg, wnd);
         }
 
         /* data available and window allows it to be sent? */
-        if (((seg->seqno - pcb->lastack + seg->len) <= wnd)) {
+        if (((seg->seqno - pcb->lastack + seg->len) <= wnd) || (seg->tcp_flags & TCP_SYN)) {
             LWIP_ASSERT("RST not expected here!", (TCPH_FLAGS(seg->tcphdr) & TCP_RST) == 0);
 
+            if (tcp_cork_hold(pcb, seg)) {
+                break;
+            }
+
             /* Stop sending if the nagle algorithm would prevent it
              * Don't stop:
              * - if tcp_write had a memory error before (prevent delayed ACK timeout) or
@@ -1943,6 +2053,7 @@ err_t tcp_output(struct tcp_pcb *pcb)
     if (pcb->unsent == NULL) {
         /* We have sent all pending segments, reset last_unsent */
         pcb->last_unsent = NULL;
+        pcb->flags &= ~TF_CORK_HELD;
 #if TCP_OVERSIZE
         pcb->unsent_oversize = 0;
 #endif /* TCP_OVERSIZE */
@@ -1998,6 +2109,19 @@ static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
     if (!LWIP_IS_DUMMY_SEGMENT(seg)) {
         pcb->rcv_ann_right_edge = pcb->rcv_nxt + pcb->rcv_ann_wnd;
     }
+
+    /* ECN flags reflect the current state, a retransmission may carry stale ones. CWR goes
+       with the first new data segment after the window reduction (RFC 3168 6.1.2). */
+    if ((pcb->flags & TF_ECN) && !(seg->tcp_flags & TCP_SYN)) {
+        u16_t ecn = (pcb->flags & TF_ECN_SND_ECE) ? TCP_ECE : 0;
+        if ((pcb->flags & TF_ECN_SND_CWR) && seg->len && !LWIP_IS_DUMMY_SEGMENT(seg) &&
+            !TCP_SEQ_LT(seg->seqno, pcb->snd_nxt)) {
+            ecn |= TCP_CWR;
+            pcb->flags &= ~TF_ECN_SND_CWR;
+        }
+        TCPH_ECN_SET(seg->tcphdr, ecn);
+    }
+
     /* Add any requested options.  NB MSS option is only set on SYN
        packets, so ignore it here */
     LWIP_ASSERT("seg->tcphdr not aligned", ((uintptr_t)(seg->tcphdr + 1) % 4) == 0);
@@ -2015,6 +2139,19 @@ static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
                 // we added 1 byte NOOP padding => total 4 bytes
     }
 
+    /* TCP Fast Open cookie or cookie request, NOOP padding goes first */
+    if (seg->flags & TF_SEG_OPTS_TFO) {
+        u8_t *tfo = (u8_t *)opts;
+        u8_t tfo_len = LWIP_TCP_OPT_LEN_TFO(pcb->tfo_cookie_len);
+        u8_t pad = tfo_len - 2 - pcb->tfo_cookie_len;
+
+        memset(tfo, 0x01, pad);
+        tfo[pad] = LWIP_TCP_OPT_KIND_TFO;
+        tfo[pad + 1] = 2 + pcb->tfo_cookie_len;
+        memcpy(tfo + pad + 2, pcb->tfo_cookie, pcb->tfo_cookie_len);
+        opts += tfo_len / 4;
+    }
+
 #if LWIP_TCP_TIMESTAMPS
     if (!LWIP_IS_DUMMY_SEGMENT(seg)) {
         pcb->ts_lastacksent = pcb->rcv_nxt;
@@ -2084,6 +2221,13 @@ static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
     flags |= (TCP_SEQ_LT(seg->seqno, pcb->snd_nxt) ? TCP_WRITE_REXMIT : 0);
     flags |= seg->flags & TF_SEG_OPTS_ZEROCOPY;
 
+    /* Only new data goes ECN capable. Not pure ACKs, a SYN, window probes or retransmissions
+       (RFC 3168 6.1.1, 6.1.4, 6.1.5), unless DCTCP sends every segment ECN capable. */
+    if ((pcb->flags & TF_ECN) && !(seg->tcp_flags & TCP_SYN) &&
+        ((seg->len && !(flags & TCP_WRITE_REXMIT)) || tcp_ecn_needed(pcb))) {
+        flags |= TCP_WRITE_ECT;
+    }
+
     return pcb->ip_output(p, seg, pcb, flags);
 }
 
@@ -45,6 +45,7 @@
 #include <execinfo.h>
 #include <libgen.h>
 #include <linux/igmp.h>
+#include <thread>
 
 #include "vlogger/vlogger.h"
 #include "utils/compiler.h"
@@ -73,6 +74,7 @@
 #include "sock/sockinfo_tcp.h"
 #include "sock/sockinfo_udp.h"
 #include "sock/bind_no_port.h"
+#include "sock/tcp_fastopen.h"
 #include "iomux/io_mux_call.h"
 
 #include "util/instrumentation.h"
@@ -110,6 +112,7 @@ static command_netlink *s_cmd_nl = nullptr;
 #define MAX_VERSION_STR_LEN 128
 
 global_stats_t g_global_stat_static;
+global_stats_t *g_p_global_stat = &g_global_stat_static;
 static uint32_t g_ec_pool_size = 0U;
 static uint32_t g_ec_pool_no_objs = 0U;
 
@@ -163,6 +166,11 @@ static int free_libxlio_resources()
     }
     g_bind_no_port = nullptr;
 
+    if (g_tcp_fastopen) {
+        delete g_tcp_fastopen;
+    }
+    g_tcp_fastopen = nullptr;
+
     if (g_p_rule_table_mgr) {
         delete g_p_rule_table_mgr;
     }
@@ -486,6 +494,8 @@ void print_xlio_global_settings()
                       SYS_VAR_LOG_DETAILS);
     VLOG_PARAM_STRING("Log Colors", safe_mce_sys().log_colors, MCE_DEFAULT_LOG_COLORS,
                       SYS_VAR_LOG_COLORS, safe_mce_sys().log_colors ? "Enabled " : "Disabled");
+    VLOG_PARAM_NUMBER("Log Async", safe_mce_sys().log_async, MCE_DEFAULT_LOG_ASYNC,
+                      SYS_VAR_LOG_ASYNC);
     VLOG_STR_PARAM_STRING("Log File", safe_mce_sys().log_filename, MCE_DEFAULT_LOG_FILE,
                           SYS_VAR_LOG_FILENAME, safe_mce_sys().log_filename);
     VLOG_STR_PARAM_STRING("Stats File", safe_mce_sys().stats_filename, MCE_DEFAULT_STATS_FILE,
@@ -498,6 +508,16 @@ void print_xlio_global_settings()
                           safe_mce_sys().service_notify_dir);
     VLOG_PARAM_NUMBER("Stats FD Num (max)", safe_mce_sys().stats_fd_num_max,
                       MCE_DEFAULT_STATS_FD_NUM, SYS_VAR_STATS_FD_NUM);
+    VLOG_STR_PARAM_STRING("Stats latency histograms",
+                          option_stats_latency::to_str(safe_mce_sys().stats_latency),
+                          option_stats_latency::to_str(MCE_DEFAULT_STATS_LATENCY),
+                          SYS_VAR_STATS_LATENCY,
+                          option_stats_latency::to_str(safe_mce_sys().stats_latency));
+    VLOG_PARAM_STRING("Stats lock contention", safe_mce_sys().stats_locks,
+                      MCE_DEFAULT_STATS_LOCKS, SYS_VAR_STATS_LOCKS,
+                      safe_mce_sys().stats_locks ? "Enabled " : "Disabled");
+    VLOG_PARAM_NUMBER("Trace events per thread", safe_mce_sys().trace_events,
+                      MCE_DEFAULT_TRACE_EVENTS, SYS_VAR_TRACE_EVENTS);
     VLOG_STR_PARAM_STRING("Conf File", safe_mce_sys().conf_filename, MCE_DEFAULT_CONF_FILE,
                           SYS_VAR_CONF_FILENAME, safe_mce_sys().conf_filename);
     VLOG_STR_PARAM_STRING("Application ID", safe_mce_sys().app_id, MCE_DEFAULT_APP_ID,
@@ -513,6 +533,12 @@ void print_xlio_global_settings()
                       safe_mce_sys().handle_segfault ? "Enabled " : "Disabled");
     VLOG_PARAM_STRING("Print a report", safe_mce_sys().print_report, MCE_DEFAULT_PRINT_REPORT,
                       SYS_VAR_PRINT_REPORT, safe_mce_sys().print_report ? "Enabled " : "Disabled");
+    VLOG_PARAM_STRING("Startup profile", safe_mce_sys().startup_profile,
+                      MCE_DEFAULT_STARTUP_PROFILE, SYS_VAR_STARTUP_PROFILE,
+                      safe_mce_sys().startup_profile ? "Enabled " : "Disabled");
+    VLOG_PARAM_STRING("Parallel init", safe_mce_sys().parallel_init, MCE_DEFAULT_PARALLEL_INIT,
+                      SYS_VAR_PARALLEL_INIT,
+                      safe_mce_sys().parallel_init ? "Enabled " : "Disabled");
 
     VLOG_PARAM_NUMSTR("Ring allocation logic TX", safe_mce_sys().ring_allocation_logic_tx,
                       MCE_DEFAULT_RING_ALLOCATION_LOGIC_TX, SYS_VAR_RING_ALLOCATION_LOGIC_TX,
@@ -563,6 +589,11 @@ void print_xlio_global_settings()
     VLOG_PARAM_STRING("Zerocopy Cache Threshold", safe_mce_sys().zc_cache_threshold,
                       MCE_DEFAULT_ZC_CACHE_THRESHOLD, SYS_VAR_ZC_CACHE_THRESHOLD,
                       option_size::to_str(safe_mce_sys().zc_cache_threshold));
+    VLOG_PARAM_STRING("Zerocopy Cache Window", safe_mce_sys().zc_cache_window,
+                      MCE_DEFAULT_ZC_CACHE_WINDOW, SYS_VAR_ZC_CACHE_WINDOW,
+                      safe_mce_sys().zc_cache_window
+                          ? option_size::to_str(safe_mce_sys().zc_cache_window)
+                          : "Whole file");
     VLOG_PARAM_NUMBER("Tx Mem Bufs", safe_mce_sys().tx_num_bufs, MCE_DEFAULT_TX_NUM_BUFS,
                       SYS_VAR_TX_NUM_BUFS);
     VLOG_PARAM_STRING("Tx Mem Buf size", safe_mce_sys().tx_buf_size, MCE_DEFAULT_TX_BUF_SIZE,
@@ -581,6 +612,13 @@ void print_xlio_global_settings()
                       safe_mce_sys().tx_nonblocked_eagains ? "Enabled " : "Disabled");
     VLOG_PARAM_NUMBER("Tx Prefetch Bytes", safe_mce_sys().tx_prefetch_bytes,
                       MCE_DEFAULT_TX_PREFETCH_BYTES, SYS_VAR_TX_PREFETCH_BYTES);
+    if (safe_mce_sys().tx_txtime_drop_late_usec) {
+        VLOG_PARAM_NUMBER("Tx Txtime Drop Late (usec)", safe_mce_sys().tx_txtime_drop_late_usec,
+                          MCE_DEFAULT_TX_TXTIME_DROP_LATE, SYS_VAR_TX_TXTIME_DROP_LATE);
+    } else {
+        VLOG_PARAM_STRING("Tx Txtime Drop Late (usec)", safe_mce_sys().tx_txtime_drop_late_usec,
+                          MCE_DEFAULT_TX_TXTIME_DROP_LATE, SYS_VAR_TX_TXTIME_DROP_LATE, "Disabled");
+    }
     VLOG_PARAM_NUMBER("Tx Bufs Batch TCP", safe_mce_sys().tx_bufs_batch_tcp,
                       MCE_DEFAULT_TX_BUFS_BATCH_TCP, SYS_VAR_TX_BUFS_BATCH_TCP);
     VLOG_PARAM_NUMBER("Tx Segs Batch TCP", safe_mce_sys().tx_segs_batch_tcp,
@@ -627,6 +665,12 @@ void print_xlio_global_settings()
         VLOG_PARAM_STRING("Rx Poll Yield", safe_mce_sys().rx_poll_yield_loops,
                           MCE_DEFAULT_RX_POLL_YIELD, SYS_VAR_RX_POLL_YIELD, "Disabled");
     }
+    VLOG_PARAM_STRING("Adaptive Poll", safe_mce_sys().adaptive_poll, MCE_DEFAULT_ADAPTIVE_POLL,
+                      SYS_VAR_ADAPTIVE_POLL, safe_mce_sys().adaptive_poll ? "Enabled " : "Disabled");
+    if (safe_mce_sys().adaptive_poll) {
+        VLOG_PARAM_NUMBER("Adaptive Poll Target (usec)", safe_mce_sys().adaptive_poll_target_usec,
+                          MCE_DEFAULT_ADAPTIVE_POLL_TARGET_USEC, SYS_VAR_ADAPTIVE_POLL_TARGET_USEC);
+    }
     VLOG_PARAM_NUMBER("Rx Prefetch Bytes", safe_mce_sys().rx_prefetch_bytes,
                       MCE_DEFAULT_RX_PREFETCH_BYTES, SYS_VAR_RX_PREFETCH_BYTES);
 
@@ -644,11 +688,16 @@ void print_xlio_global_settings()
 
     VLOG_PARAM_NUMBER("GRO max streams", safe_mce_sys().gro_streams_max,
                       MCE_DEFAULT_GRO_STREAMS_MAX, SYS_VAR_GRO_STREAMS_MAX);
+    VLOG_PARAM_STRING("UDP GRO", safe_mce_sys().udp_gro, MCE_DEFAULT_UDP_GRO, SYS_VAR_UDP_GRO,
+                      safe_mce_sys().udp_gro ? "Enabled " : "Disabled");
     VLOG_PARAM_NUMBER("Disable flow tag", safe_mce_sys().disable_flow_tag,
                       MCE_DEFAULT_DISABLE_FLOW_TAG, SYS_VAR_DISABLE_FLOW_TAG);
 
     VLOG_PARAM_STRING("TCP 3T rules", safe_mce_sys().tcp_3t_rules, MCE_DEFAULT_TCP_3T_RULES,
                       SYS_VAR_TCP_3T_RULES, safe_mce_sys().tcp_3t_rules ? "Enabled " : "Disabled");
+    VLOG_PARAM_STRING("TCP reuseport sharding", safe_mce_sys().tcp_reuseport_sharding,
+                      MCE_DEFAULT_TCP_REUSEPORT_SHARDING, SYS_VAR_TCP_REUSEPORT_SHARDING,
+                      safe_mce_sys().tcp_reuseport_sharding ? "Enabled " : "Disabled");
     VLOG_PARAM_STRING("UDP 3T rules", safe_mce_sys().udp_3t_rules, MCE_DEFAULT_UDP_3T_RULES,
                       SYS_VAR_UDP_3T_RULES, safe_mce_sys().udp_3t_rules ? "Enabled " : "Disabled");
     VLOG_PARAM_STRING("ETH MC L2 only rules", safe_mce_sys().eth_mc_l2_only_rules,
@@ -691,6 +740,9 @@ void print_xlio_global_settings()
         VLOG_PARAM_STRING("Select Skip OS", safe_mce_sys().select_skip_os_fd_check,
                           MCE_DEFAULT_SELECT_SKIP_OS, SYS_VAR_SELECT_SKIP_OS, "Disabled");
     }
+    VLOG_PARAM_STRING("Epoll OS io_uring", safe_mce_sys().epoll_os_uring,
+                      MCE_DEFAULT_EPOLL_OS_URING, SYS_VAR_EPOLL_OS_URING,
+                      safe_mce_sys().epoll_os_uring ? "Enabled " : "Disabled");
 
     if (safe_mce_sys().progress_engine_interval_msec == MCE_CQ_DRAIN_INTERVAL_DISABLED ||
         safe_mce_sys().progress_engine_wce_max == 0) {
@@ -725,6 +777,16 @@ void print_xlio_global_settings()
     VLOG_PARAM_NUMBER(
         "CQ AIM Interrupts Rate (per sec)", safe_mce_sys().cq_aim_interrupts_rate_per_sec,
         MCE_DEFAULT_CQ_AIM_INTERRUPTS_RATE_PER_SEC, SYS_VAR_CQ_AIM_INTERRUPTS_RATE_PER_SEC);
+    VLOG_STR_PARAM_STRING("CQ AIM Policy",
+                          option_cq_aim_policy::to_str(safe_mce_sys().cq_aim_policy),
+                          option_cq_aim_policy::to_str(MCE_DEFAULT_CQ_AIM_POLICY),
+                          SYS_VAR_CQ_AIM_POLICY,
+                          option_cq_aim_policy::to_str(safe_mce_sys().cq_aim_policy));
+    if (safe_mce_sys().cq_aim_policy == option_cq_aim_policy::CQ_AIM_AIMD) {
+        VLOG_PARAM_NUMBER("CQ AIM Latency Target (usec)", safe_mce_sys().cq_aim_latency_target_usec,
+                          MCE_DEFAULT_CQ_AIM_LATENCY_TARGET_USEC,
+                          SYS_VAR_CQ_AIM_LATENCY_TARGET_USEC);
+    }
 
     VLOG_PARAM_NUMBER("CQ Poll Batch (max)", safe_mce_sys().cq_poll_batch_max,
                       MCE_DEFAULT_CQ_POLL_BATCH, SYS_VAR_CQ_POLL_BATCH_MAX);
@@ -752,8 +814,17 @@ void print_xlio_global_settings()
                       SYS_VAR_TCP_NODELAY);
     VLOG_PARAM_NUMBER("TCP nodelay treshold", safe_mce_sys().tcp_nodelay_treshold,
                       MCE_DEFAULT_TCP_NODELAY_TRESHOLD, SYS_VAR_TCP_NODELAY_TRESHOLD);
+    VLOG_PARAM_NUMBER("TCP cork timeout (msec)", safe_mce_sys().tcp_cork_timeout_msec,
+                      MCE_DEFAULT_TCP_CORK_TIMEOUT_MSEC, SYS_VAR_TCP_CORK_TIMEOUT_MSEC);
+    VLOG_PARAM_NUMBER("TCP ACK every segments", safe_mce_sys().tcp_ack_segs,
+                      MCE_DEFAULT_TCP_ACK_SEGS, SYS_VAR_TCP_ACK_SEGS);
+    VLOG_PARAM_NUMBER("TCP ACK every bytes", safe_mce_sys().tcp_ack_bytes,
+                      MCE_DEFAULT_TCP_ACK_BYTES, SYS_VAR_TCP_ACK_BYTES);
+    VLOG_PARAM_NUMBER("TCP ECN", safe_mce_sys().tcp_ecn, MCE_DEFAULT_TCP_ECN, SYS_VAR_TCP_ECN);
     VLOG_PARAM_NUMBER("TCP quickack", safe_mce_sys().tcp_quickack, MCE_DEFAULT_TCP_QUICKACK,
                       SYS_VAR_TCP_QUICKACK);
+    VLOG_PARAM_NUMBER("TCP fastopen", safe_mce_sys().tcp_fastopen, MCE_DEFAULT_TCP_FASTOPEN,
+                      SYS_VAR_TCP_FASTOPEN);
     VLOG_PARAM_NUMSTR(xlio_exception_handling::getName(), (int)safe_mce_sys().exception_handling,
                       xlio_exception_handling::MODE_DEFAULT, xlio_exception_handling::getSysVar(),
                       safe_mce_sys().exception_handling.to_str());
@@ -789,6 +860,14 @@ void print_xlio_global_settings()
     VLOG_PARAM_STRING("Memory limit (user allocator)", safe_mce_sys().memory_limit_user,
                       MCE_DEFAULT_MEMORY_LIMIT_USER, SYS_VAR_MEMORY_LIMIT_USER,
                       option_size::to_str(safe_mce_sys().memory_limit_user));
+    VLOG_PARAM_STRING("Memory block", safe_mce_sys().memory_block, MCE_DEFAULT_MEMORY_BLOCK,
+                      SYS_VAR_MEMORY_BLOCK, option_size::to_str(safe_mce_sys().memory_block));
+    VLOG_PARAM_STRING("Memory reclaim high", safe_mce_sys().memory_reclaim_high,
+                      MCE_DEFAULT_MEMORY_RECLAIM_HIGH, SYS_VAR_MEMORY_RECLAIM_HIGH,
+                      option_size::to_str(safe_mce_sys().memory_reclaim_high));
+    VLOG_PARAM_STRING("Memory reclaim low", safe_mce_sys().memory_reclaim_low,
+                      MCE_DEFAULT_MEMORY_RECLAIM_LOW, SYS_VAR_MEMORY_RECLAIM_LOW,
+                      option_size::to_str(safe_mce_sys().memory_reclaim_low));
     VLOG_PARAM_STRING("Hugepage size", safe_mce_sys().hugepage_size, MCE_DEFAULT_HUGEPAGE_SIZE,
                       SYS_VAR_HUGEPAGE_SIZE, option_size::to_str(safe_mce_sys().hugepage_size));
 
@@ -810,6 +889,15 @@ void print_xlio_global_settings()
     VLOG_STR_PARAM_STRING("LRO support", option_3::to_str(safe_mce_sys().enable_lro),
                           option_3::to_str(MCE_DEFAULT_LRO), SYS_VAR_LRO,
                           option_3::to_str(safe_mce_sys().enable_lro));
+#ifdef DEFINED_XDP
+    VLOG_STR_PARAM_STRING("AF_XDP ring", option_xdp::to_str(safe_mce_sys().xdp_mode),
+                          option_xdp::to_str(MCE_DEFAULT_XDP), SYS_VAR_XDP,
+                          option_xdp::to_str(safe_mce_sys().xdp_mode));
+    VLOG_PARAM_NUMBER("AF_XDP queue", safe_mce_sys().xdp_queue_id, MCE_DEFAULT_XDP_QUEUE,
+                      SYS_VAR_XDP_QUEUE);
+    VLOG_PARAM_NUMBER("AF_XDP UMEM frames", safe_mce_sys().xdp_num_frames,
+                      MCE_DEFAULT_XDP_NUM_FRAMES, SYS_VAR_XDP_NUM_FRAMES);
+#endif /* DEFINED_XDP */
     VLOG_PARAM_STRING("BF (Blue Flame)", safe_mce_sys().handle_bf, MCE_DEFAULT_BF_FLAG, SYS_VAR_BF,
                       safe_mce_sys().handle_bf ? "Enabled " : "Disabled");
 #ifdef DEFINED_UTLS
@@ -961,10 +1049,12 @@ extern "C" void sock_redirect_exit(void)
     vlog_printf(VLOG_DEBUG, "%s()\n", __FUNCTION__);
 
     if (g_init_global_ctors_done) {
-        xlio_stats_instance_remove_global_block(&g_global_stat_static);
+        g_p_global_stat = xlio_stats_instance_remove_global_block(g_p_global_stat);
     }
 
+    lock_stats_fini();
     xlio_shmem_stats_close();
+    xlio_trace_close();
 }
 
 #define NEW_CTOR(ptr, ctor)                                                                        \
@@ -1003,16 +1093,62 @@ static size_t calc_rx_wqe_buff_size()
     return buff_size;
 }
 
+static alloc_t get_user_memalloc(int flag)
+{
+    return safe_mce_sys().m_ioctl.user_alloc.flags & flag
+        ? safe_mce_sys().m_ioctl.user_alloc.memalloc
+        : nullptr;
+}
+
+static free_t get_user_memfree(int flag)
+{
+    return safe_mce_sys().m_ioctl.user_alloc.flags & flag
+        ? safe_mce_sys().m_ioctl.user_alloc.memfree
+        : nullptr;
+}
+
+static void parse_config_file()
+{
+    startup_phase phase("config file");
+
+    if (check_if_regular_file(safe_mce_sys().conf_filename)) {
+        vlog_printf(VLOG_WARNING,
+                    "FAILED to read library configuration file. %s is not a regular file.\n",
+                    safe_mce_sys().conf_filename);
+        if (strcmp(MCE_DEFAULT_CONF_FILE, safe_mce_sys().conf_filename)) {
+            vlog_printf(VLOG_INFO, "Please see README section regarding %s\n",
+                        SYS_VAR_CONF_FILENAME);
+        }
+    } else if (__xlio_parse_config_file(safe_mce_sys().conf_filename)) {
+        vlog_printf(VLOG_DEBUG, "FAILED to read library configuration file: %s\n",
+                    safe_mce_sys().conf_filename);
+    }
+}
+
+// Helper thread of the parallel initialization, joined on any exit from the initialization.
+struct init_thread_guard {
+    std::thread thread;
+
+    ~init_thread_guard()
+    {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+};
+
 static void do_global_ctors_helper()
 {
     static lock_spin_recursive g_globals_lock;
     std::lock_guard<decltype(g_globals_lock)> lock(g_globals_lock);
+    init_thread_guard config_thread;
 
     if (g_init_global_ctors_done) {
         return;
     }
     PROFILE_BLOCK("xlio_ctors")
 
+    startup_profile_start();
     g_init_global_ctors_done = true;
     set_env_params();
     prepare_fork();
@@ -1027,6 +1163,11 @@ static void do_global_ctors_helper()
 
     xlio_heap::initialize();
 
+    if (safe_mce_sys().parallel_init) {
+        // Configuration is used only by sockets, parse it while the subsystems are built.
+        config_thread.thread = std::thread(parse_config_file);
+    }
+
 #if defined(DEFINED_NGINX) || defined(DEFINED_ENVOY)
     NEW_CTOR(g_p_app, app_conf());
 #endif
@@ -1041,7 +1182,7 @@ static void do_global_ctors_helper()
     }
 
     // Create all global management objects
-    NEW_CTOR(g_p_event_handler_manager, event_handler_manager());
+    STARTUP_PHASE("event handler", NEW_CTOR(g_p_event_handler_manager, event_handler_manager()));
 
     xlio_shmem_stats_open(&g_p_vlogger_level, &g_p_vlogger_details);
     *g_p_vlogger_level = g_vlogger_level;
@@ -1050,71 +1191,85 @@ static void do_global_ctors_helper()
     sock_stats::instance().init_sock_stats(safe_mce_sys().stats_fd_num_max);
 
     g_global_stat_static.init();
-    xlio_stats_instance_create_global_block(&g_global_stat_static);
+    g_p_global_stat = xlio_stats_instance_create_global_block(&g_global_stat_static);
+    lat_stats_init();
+    lock_stats_init();
+    trace_init();
 
     // Create new netlink listener
-    NEW_CTOR(g_p_netlink_handler, netlink_wrapper());
+    STARTUP_PHASE("netlink", NEW_CTOR(g_p_netlink_handler, netlink_wrapper()));
+
+    STARTUP_PHASE("ib contexts",
+                  NEW_CTOR(g_p_ib_ctx_handler_collection, ib_ctx_handler_collection()));
 
-    NEW_CTOR(g_p_ib_ctx_handler_collection, ib_ctx_handler_collection());
+    if (safe_mce_sys().parallel_init) {
+        // Devices are known, allocate and register buffer memory while the tables are built.
+        // Buffer pools wait for the memory on demand.
+        xlio_heap::prefetch(get_user_memalloc(IOCTL_USER_ALLOC_RX),
+                            get_user_memfree(IOCTL_USER_ALLOC_RX));
+        xlio_heap::prefetch(get_user_memalloc(IOCTL_USER_ALLOC_TX),
+                            get_user_memfree(IOCTL_USER_ALLOC_TX));
+    }
 
-    NEW_CTOR(g_p_net_device_table_mgr, net_device_table_mgr());
+    STARTUP_PHASE("net devices", NEW_CTOR(g_p_net_device_table_mgr, net_device_table_mgr()));
 
-    NEW_CTOR(g_p_neigh_table_mgr, neigh_table_mgr());
+    STARTUP_PHASE("neigh table", NEW_CTOR(g_p_neigh_table_mgr, neigh_table_mgr()));
 
-    NEW_CTOR(g_p_rule_table_mgr, rule_table_mgr());
+    STARTUP_PHASE("rule table", NEW_CTOR(g_p_rule_table_mgr, rule_table_mgr()));
 
-    NEW_CTOR(g_p_route_table_mgr, route_table_mgr());
+    STARTUP_PHASE("route table", NEW_CTOR(g_p_route_table_mgr, route_table_mgr()));
 
     NEW_CTOR(g_bind_no_port, bind_no_port());
 
-    NEW_CTOR(g_zc_cache, mapping_cache(safe_mce_sys().zc_cache_threshold));
-
-    safe_mce_sys().rx_buf_size = std::min(safe_mce_sys().rx_buf_size, 0xFF00U);
-    if (safe_mce_sys().rx_buf_size <=
-        get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(), safe_mce_sys().lwip_mss)) {
-        safe_mce_sys().rx_buf_size = 0;
+    if (safe_mce_sys().tcp_fastopen) {
+        NEW_CTOR(g_tcp_fastopen, tcp_fastopen());
     }
 
-    NEW_CTOR(g_buffer_pool_rx_rwqe,
-             buffer_pool(BUFFER_POOL_RX, calc_rx_wqe_buff_size(),
-                         (safe_mce_sys().m_ioctl.user_alloc.flags & IOCTL_USER_ALLOC_RX
-                              ? safe_mce_sys().m_ioctl.user_alloc.memalloc
-                              : nullptr),
-                         (safe_mce_sys().m_ioctl.user_alloc.flags & IOCTL_USER_ALLOC_RX
-                              ? safe_mce_sys().m_ioctl.user_alloc.memfree
-                              : nullptr)));
+    NEW_CTOR(g_zc_cache,
+             mapping_cache(safe_mce_sys().zc_cache_threshold, safe_mce_sys().zc_cache_window));
 
-    if (safe_mce_sys().enable_striding_rq) {
-        NEW_CTOR(g_buffer_pool_rx_stride, buffer_pool(BUFFER_POOL_RX, 0));
-        g_buffer_pool_rx_ptr = g_buffer_pool_rx_stride;
-    } else {
-        g_buffer_pool_rx_ptr = g_buffer_pool_rx_rwqe;
-    }
+    {
+        // Waits for the background registration of the buffer memory if it's still running.
+        startup_phase phase("buffer pools");
 
-    safe_mce_sys().tx_buf_size = std::min(safe_mce_sys().tx_buf_size, 0xFF00U);
-    if (safe_mce_sys().tx_buf_size <=
-        get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(), safe_mce_sys().lwip_mss)) {
-        safe_mce_sys().tx_buf_size = 0;
-    }
-    NEW_CTOR(g_buffer_pool_tx,
-             buffer_pool(BUFFER_POOL_TX,
-                         TX_BUF_SIZE(safe_mce_sys().tx_buf_size
-                                         ? safe_mce_sys().tx_buf_size
-                                         : get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(),
-                                                            safe_mce_sys().lwip_mss)),
-                         (safe_mce_sys().m_ioctl.user_alloc.flags & IOCTL_USER_ALLOC_TX
-                              ? safe_mce_sys().m_ioctl.user_alloc.memalloc
-                              : nullptr),
-                         (safe_mce_sys().m_ioctl.user_alloc.flags & IOCTL_USER_ALLOC_TX
-                              ? safe_mce_sys().m_ioctl.user_alloc.memfree
-                              : nullptr)));
+        safe_mce_sys().rx_buf_size = std::min(safe_mce_sys().rx_buf_size, 0xFF00U);
+        if (safe_mce_sys().rx_buf_size <=
+            get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(), safe_mce_sys().lwip_mss)) {
+            safe_mce_sys().rx_buf_size = 0;
+        }
+
+        NEW_CTOR(g_buffer_pool_rx_rwqe,
+                 buffer_pool(BUFFER_POOL_RX, calc_rx_wqe_buff_size(),
+                             get_user_memalloc(IOCTL_USER_ALLOC_RX),
+                             get_user_memfree(IOCTL_USER_ALLOC_RX)));
+
+        if (safe_mce_sys().enable_striding_rq) {
+            NEW_CTOR(g_buffer_pool_rx_stride, buffer_pool(BUFFER_POOL_RX, 0));
+            g_buffer_pool_rx_ptr = g_buffer_pool_rx_stride;
+        } else {
+            g_buffer_pool_rx_ptr = g_buffer_pool_rx_rwqe;
+        }
+
+        safe_mce_sys().tx_buf_size = std::min(safe_mce_sys().tx_buf_size, 0xFF00U);
+        if (safe_mce_sys().tx_buf_size <=
+            get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(), safe_mce_sys().lwip_mss)) {
+            safe_mce_sys().tx_buf_size = 0;
+        }
+        size_t tx_buf_size = safe_mce_sys().tx_buf_size
+            ? safe_mce_sys().tx_buf_size
+            : get_lwip_tcp_mss(g_p_net_device_table_mgr->get_max_mtu(), safe_mce_sys().lwip_mss);
+        NEW_CTOR(g_buffer_pool_tx,
+                 buffer_pool(BUFFER_POOL_TX, TX_BUF_SIZE(tx_buf_size),
+                             get_user_memalloc(IOCTL_USER_ALLOC_TX),
+                             get_user_memfree(IOCTL_USER_ALLOC_TX)));
 
-    NEW_CTOR(g_buffer_pool_zc, buffer_pool(BUFFER_POOL_TX, 0));
+        NEW_CTOR(g_buffer_pool_zc, buffer_pool(BUFFER_POOL_TX, 0));
+    }
 
     NEW_CTOR(g_tcp_seg_pool,
              tcp_seg_pool("TCP segments", safe_mce_sys().tx_segs_pool_batch_tcp,
-                          g_global_stat_static.n_tcp_seg_pool_size,
-                          g_global_stat_static.n_tcp_seg_pool_no_segs));
+                          g_p_global_stat->n_tcp_seg_pool_size,
+                          g_p_global_stat->n_tcp_seg_pool_no_segs));
 
     NEW_CTOR(g_socketxtreme_ec_pool,
              socketxtreme_ec_pool("Socketxtreme ec", 512, g_ec_pool_size, g_ec_pool_no_objs));
@@ -1128,23 +1283,16 @@ static void do_global_ctors_helper()
 
     NEW_CTOR(g_p_ip_frag_manager, ip_frag_manager());
 
-    NEW_CTOR(g_p_fd_collection, fd_collection());
+    STARTUP_PHASE("fd collection", NEW_CTOR(g_p_fd_collection, fd_collection()));
 
-    if (check_if_regular_file(safe_mce_sys().conf_filename)) {
-        vlog_printf(VLOG_WARNING,
-                    "FAILED to read library configuration file. %s is not a regular file.\n",
-                    safe_mce_sys().conf_filename);
-        if (strcmp(MCE_DEFAULT_CONF_FILE, safe_mce_sys().conf_filename)) {
-            vlog_printf(VLOG_INFO, "Please see README section regarding %s\n",
-                        SYS_VAR_CONF_FILENAME);
-        }
-    } else if (__xlio_parse_config_file(safe_mce_sys().conf_filename)) {
-        vlog_printf(VLOG_DEBUG, "FAILED to read library configuration file: %s\n",
-                    safe_mce_sys().conf_filename);
+    if (config_thread.thread.joinable()) {
+        config_thread.thread.join();
+    } else {
+        parse_config_file();
     }
 
     // initialize LWIP tcp/ip stack
-    NEW_CTOR(g_p_lwip, xlio_lwip());
+    STARTUP_PHASE("lwip", NEW_CTOR(g_p_lwip, xlio_lwip()));
 
     if (g_p_netlink_handler) {
         // Open netlink socket
@@ -1172,6 +1320,8 @@ static void do_global_ctors_helper()
 #ifdef DEFINED_UTLS
     xlio_tls_api_setup();
 #endif /* DEFINED_UTLS */
+
+    startup_profile_print();
 }
 
 int do_global_ctors()
@@ -1209,6 +1359,7 @@ void reset_globals()
     g_p_agent = nullptr;
     g_p_route_table_mgr = nullptr;
     g_bind_no_port = nullptr;
+    g_tcp_fastopen = nullptr;
     g_p_rule_table_mgr = nullptr;
     g_stats_file = nullptr;
     g_p_net_device_table_mgr = nullptr;
@@ -1301,7 +1452,7 @@ extern "C" int xlio_init(void)
     g_init_global_ctors_done = false;
 
     vlog_start(PRODUCT_NAME, safe_mce_sys().log_level, safe_mce_sys().log_filename,
-               safe_mce_sys().log_details, safe_mce_sys().log_colors);
+               safe_mce_sys().log_details, safe_mce_sys().log_colors, safe_mce_sys().log_async);
 
     print_xlio_global_settings();
 
@@ -78,6 +78,7 @@ struct xlio_send_attr {
     uint16_t mss;
     size_t length;
     xlio_tis *tis;
+    const xlio_txtime *txtime; // SO_TXTIME launch time, nullptr to send immediately
 };
 
 class dst_entry : public cache_observer, public tostr {
@@ -186,6 +187,7 @@ protected:
     bool m_b_is_offloaded;
     bool m_b_force_os;
     uint8_t m_src_sel_prefs;
+    const xlio_txtime *m_p_txtime = nullptr; // Launch time of the packet being sent
 
     virtual transport_t get_transport(const sock_addr &to) = 0;
     virtual uint8_t get_protocol_type() const = 0;
@@ -234,6 +236,8 @@ protected:
                 mem_buf_desc_t *p_mem_buf_desc = (mem_buf_desc_t *)(p_send_wqe->wr_id);
                 m_p_ring->mem_buf_tx_release(p_mem_buf_desc, true);
             }
+        } else if (unlikely(is_set(attr, XLIO_TX_PACKET_TXTIME))) {
+            m_p_ring->send_ring_buffer_at(id, p_send_wqe, attr, *m_p_txtime);
         } else {
             m_p_ring->send_ring_buffer(id, p_send_wqe, attr);
         }
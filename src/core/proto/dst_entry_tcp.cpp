@@ -76,6 +76,7 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
     size_t hdr_alignment_diff = 0;
 
     bool is_zerocopy = is_set(attr.flags, XLIO_TX_PACKET_ZEROCOPY);
+    bool is_ect = is_set(attr.flags, XLIO_TX_PACKET_ECT);
 
     /* The header is aligned for fast copy but we need to maintain this diff
      * in order to get the real header pointer easily
@@ -87,7 +88,9 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
     /* Suppress flags that should not be used anymore
      * to avoid conflicts with XLIO_TX_PACKET_L3_CSUM and XLIO_TX_PACKET_L4_CSUM
      */
-    attr.flags = (xlio_wr_tx_packet_attr)(attr.flags & ~(XLIO_TX_PACKET_ZEROCOPY | XLIO_TX_FILE));
+    attr.flags = (xlio_wr_tx_packet_attr)(attr.flags &
+                                          ~(XLIO_TX_PACKET_ZEROCOPY | XLIO_TX_FILE |
+                                            XLIO_TX_PACKET_ECT));
 
     /* ZC uses multiple IOVs, only the mlx5 TSO path supports that */
     /* for small (< mss) ZC sends, must turn off CX5.SXP.disable_lso_on_only_packets
@@ -144,9 +147,15 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
         if (get_sa_family() == AF_INET6) {
             fill_hdrs<tx_ipv6_hdr_template_t>(p_pkt, p_ip_hdr, p_tcp_hdr);
             set_ipv6_len(p_ip_hdr, htons(payload_length_ipv4 - IPV6_HLEN));
+            if (is_ect) {
+                set_ipv6_ect(p_ip_hdr);
+            }
         } else {
             fill_hdrs<tx_ipv4_hdr_template_t>(p_pkt, p_ip_hdr, p_tcp_hdr);
             set_ipv4_len(p_ip_hdr, htons(payload_length_ipv4));
+            if (is_ect) {
+                set_ipv4_ect(p_ip_hdr);
+            }
         }
 
         tcp_hdr_len = (static_cast<tcphdr *>(p_tcp_hdr))->doff * 4;
@@ -177,6 +186,8 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
             p_tcp_iov[0].iovec.iov_len = total_packet_len;
         }
 
+        // Data stays in the original buffer even if a fake descriptor replaces it below
+        uint32_t first_lkey = p_tcp_iov[0].p_desc->lkey;
         if (unlikely(p_tcp_iov[0].p_desc->lwip_pbuf.ref > 1)) {
             /*
              * First buffer in the vector is used for reference counting.
@@ -249,7 +260,7 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
                         m_p_ring->get_tx_user_lkey(masked_addr, m_n_sysvar_user_huge_page_size);
                 }
             } else {
-                m_sge[i].lkey = (i == 0 ? m_p_ring->get_tx_lkey(m_id) : m_sge[0].lkey);
+                m_sge[i].lkey = i ? p_tcp_iov[i].p_desc->lkey : first_lkey;
             }
         }
 
@@ -278,7 +289,7 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
 
         m_sge[0].addr = (uintptr_t)(p_mem_buf_desc->p_buffer + hdr_alignment_diff);
         m_sge[0].length = total_packet_len - hdr_alignment_diff;
-        m_sge[0].lkey = m_p_ring->get_tx_lkey(m_id);
+        m_sge[0].lkey = p_mem_buf_desc->lkey;
 
         p_pkt = static_cast<void *>(p_mem_buf_desc->p_buffer);
 
@@ -286,9 +297,15 @@ ssize_t dst_entry_tcp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
         if (get_sa_family() == AF_INET6) {
             fill_hdrs<tx_ipv6_hdr_template_t>(p_pkt, p_ip_hdr, p_tcp_hdr);
             set_ipv6_len(p_ip_hdr, htons(payload_length_ipv4 - IPV6_HLEN));
+            if (is_ect) {
+                set_ipv6_ect(p_ip_hdr);
+            }
         } else {
             fill_hdrs<tx_ipv4_hdr_template_t>(p_pkt, p_ip_hdr, p_tcp_hdr);
             set_ipv4_len(p_ip_hdr, htons(payload_length_ipv4));
+            if (is_ect) {
+                set_ipv4_ect(p_ip_hdr);
+            }
         }
 
         p_mem_buf_desc->tx.p_ip_h = p_ip_hdr;
@@ -30,6 +30,8 @@
  * SOFTWARE.
  */
 
+#include <vector>
+
 #include "utils/bullseye.h"
 #include "core/util/utils.h"
 #include "dst_entry_udp.h"
@@ -45,6 +47,9 @@
 #define dst_udp_logfunc    __log_info_func
 #define dst_udp_logfuncall __log_info_funcall
 
+// Max number of datagrams in a single UDP_SEGMENT send (Linux UDP_MAX_SEGMENTS)
+#define UDP_MAX_SEGMENTS (1 << 6)
+
 dst_entry_udp::dst_entry_udp(const sock_addr &dst, uint16_t src_port, socket_data &sock_data,
                              resource_allocation_key &ring_alloc_logic)
     : dst_entry(dst, src_port, sock_data, ring_alloc_logic)
@@ -169,7 +174,7 @@ bool dst_entry_udp::fast_send_fragmented_ipv6(mem_buf_desc_t *p_mem_buf_desc, co
         p_sge[0].addr =
             (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)p_header->m_transport_header_tx_offset);
         p_sge[0].length = sz_user_data_to_copy + hdr_len;
-        p_sge[0].lkey = p_ring->get_tx_lkey(user_id);
+        p_sge[0].lkey = p_mem_buf_desc->lkey;
         p_send_wqe->wr_id = (uintptr_t)p_mem_buf_desc;
 
         vlog_printf(VLOG_DEBUG, "packet_sz=%d, payload_sz=%zu, ip_offset=%u id=%u\n",
@@ -234,8 +239,9 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
 
     // Check if inline is possible
     // Skip inlining in case of L4 SW checksum because headers and data are not contiguous in memory
+    // and in case of SO_TXTIME because the user buffer is not copied before the launch time
     if (sz_iov == 1 && ((sz_data_payload + m_header->m_total_hdr_len) < m_max_inline) &&
-        !is_set(attr, XLIO_TX_SW_L4_CSUM)) {
+        !is_set(attr, (xlio_wr_tx_packet_attr)(XLIO_TX_SW_L4_CSUM | XLIO_TX_PACKET_TXTIME))) {
         p_send_wqe = &m_inline_send_wqe;
 
         m_header->get_udp_hdr()->len = htons((uint16_t)sz_udp_payload);
@@ -285,7 +291,7 @@ inline ssize_t dst_entry_udp::fast_send_not_fragmented(const iovec *p_iov, const
         m_sge[1].length = sz_data_payload + hdr_len;
         m_sge[1].addr =
             (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)m_header->m_transport_header_tx_offset);
-        m_sge[1].lkey = m_p_ring->get_tx_lkey(m_id);
+        m_sge[1].lkey = p_mem_buf_desc->lkey;
 
         // Calc payload start point (after the udp header if present else just after ip header)
         uint8_t *p_payload =
@@ -398,7 +404,7 @@ inline bool dst_entry_udp::fast_send_fragmented_ipv4(mem_buf_desc_t *p_mem_buf_d
         m_sge[1].addr =
             (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)m_header->m_transport_header_tx_offset);
         m_sge[1].length = sz_user_data_to_copy + hdr_len;
-        m_sge[1].lkey = m_p_ring->get_tx_lkey(m_id);
+        m_sge[1].lkey = p_mem_buf_desc->lkey;
         p_send_wqe->wr_id = (uintptr_t)p_mem_buf_desc;
 
         dst_udp_logfunc("packet_sz=%d, payload_sz=%d, ip_offset=%d id=%d",
@@ -461,6 +467,8 @@ ssize_t dst_entry_udp::fast_send_fragmented(const iovec *p_iov, const ssize_t sz
 
     bool ret;
     if (is_ipv6) {
+        // The shared IPv6 fragmentation path sends the fragments immediately, without SO_TXTIME
+        attr = (xlio_wr_tx_packet_attr)(attr & ~XLIO_TX_PACKET_TXTIME);
         ret = dst_entry_udp::fast_send_fragmented_ipv6(
             p_mem_buf_desc, p_iov, sz_iov, attr, sz_udp_payload, n_num_frags,
             &m_fragmented_send_wqe, m_id, &m_sge[1], m_header, m_max_ip_payload_size, m_p_ring,
@@ -477,6 +485,111 @@ ssize_t dst_entry_udp::fast_send_fragmented(const iovec *p_iov, const ssize_t sz
     return sz_data_payload;
 }
 
+ssize_t dst_entry_udp::fast_send_gso(const iovec *p_iov, const ssize_t sz_iov,
+                                     xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                     ssize_t sz_data_payload)
+{
+    bool b_blocked = is_set(attr, XLIO_TX_PACKET_BLOCK);
+    bool is_ipv6 = (get_sa_family() == AF_INET6);
+    int n_num_segs = (sz_data_payload + gso_size - 1) / gso_size;
+
+    // Every segment must fit into a single IP packet (meet Linux kernel behavior)
+    if (unlikely(gso_size + sizeof(struct udphdr) > (size_t)m_max_udp_payload_size ||
+                 n_num_segs > UDP_MAX_SEGMENTS)) {
+        dst_udp_logdbg("Invalid UDP_SEGMENT size=%u for payload_sz=%zd", gso_size,
+                       sz_data_payload);
+        errno = EINVAL;
+        return -1;
+    }
+
+    dst_udp_logfunc("udp info: IPv%s, payload_sz=%zd, gso_size=%u, segs=%d, blocked=%s",
+                    (is_ipv6) ? "6" : "4", sz_data_payload, gso_size, n_num_segs,
+                    b_blocked ? "true" : "false");
+
+    // Get all needed tx buf descriptors and data buffers at once
+    mem_buf_desc_t *p_mem_buf_desc =
+        m_p_ring->mem_buf_tx_get(m_id, b_blocked, PBUF_RAM, n_num_segs);
+
+    if (unlikely(!p_mem_buf_desc)) {
+        if (b_blocked) {
+            dst_udp_logdbg("Error when blocking for next tx buffer (errno=%d %m)", errno);
+        } else {
+            dst_udp_logfunc(
+                "Packet dropped. NonBlocked call but not enough tx buffers. Returning OK");
+            if (!m_b_sysvar_tx_nonblocked_eagains) {
+                return sz_data_payload;
+            }
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+
+    xlio_ibv_send_wr *p_send_wqe = &m_not_inline_send_wqe;
+    size_t hdr_len = m_header->m_transport_header_len + m_header->m_ip_header_len + UDP_HLEN;
+    size_t sz_user_data_offset = 0;
+
+    while (n_num_segs--) {
+        // The last segment may be shorter than gso_size
+        size_t sz_user_data_to_copy =
+            std::min((size_t)gso_size, (size_t)sz_data_payload - sz_user_data_offset);
+        size_t sz_udp_payload = sz_user_data_to_copy + UDP_HLEN;
+        void *p_pkt = p_mem_buf_desc->p_buffer;
+        void *p_ip_hdr;
+        void *p_udp_hdr;
+
+        m_header->copy_l2_ip_udp_hdr(p_pkt);
+
+        uint16_t payload_length_ipv4 = m_header->m_ip_header_len + sz_udp_payload;
+        if (is_ipv6) {
+            fill_hdrs<tx_ipv6_hdr_template_t>(p_pkt, p_ip_hdr, p_udp_hdr);
+            set_ipv6_len(p_ip_hdr, htons(payload_length_ipv4 - IPV6_HLEN));
+        } else {
+            fill_hdrs<tx_ipv4_hdr_template_t>(p_pkt, p_ip_hdr, p_udp_hdr);
+            set_ipv4_len(p_ip_hdr, htons(payload_length_ipv4));
+            reinterpret_cast<iphdr *>(p_ip_hdr)->frag_off = htons(0);
+            reinterpret_cast<iphdr *>(p_ip_hdr)->id = 0;
+        }
+        reinterpret_cast<udphdr *>(p_udp_hdr)->len = htons((uint16_t)sz_udp_payload);
+
+        uint8_t *p_payload =
+            p_mem_buf_desc->p_buffer + m_header->m_transport_header_tx_offset + hdr_len;
+
+        // Copy user data to our tx buffers
+        int ret =
+            memcpy_fromiovec(p_payload, p_iov, sz_iov, sz_user_data_offset, sz_user_data_to_copy);
+        BULLSEYE_EXCLUDE_BLOCK_START
+        if (ret != (int)sz_user_data_to_copy) {
+            dst_udp_logerr("memcpy_fromiovec error (sz_user_data_to_copy=%lu, ret=%d)",
+                           sz_user_data_to_copy, ret);
+            m_p_ring->mem_buf_tx_release(p_mem_buf_desc, true);
+            errno = EINVAL;
+            return -1;
+        }
+        BULLSEYE_EXCLUDE_BLOCK_END
+
+        p_mem_buf_desc->tx.p_ip_h = p_ip_hdr;
+        p_mem_buf_desc->tx.p_udp_h = reinterpret_cast<udphdr *>(p_udp_hdr);
+
+        m_sge[1].addr =
+            (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)m_header->m_transport_header_tx_offset);
+        m_sge[1].length = sz_user_data_to_copy + hdr_len;
+        m_sge[1].lkey = p_mem_buf_desc->lkey;
+        p_send_wqe->wr_id = (uintptr_t)p_mem_buf_desc;
+
+        mem_buf_desc_t *tmp = p_mem_buf_desc->p_next_desc;
+        p_mem_buf_desc->p_next_desc = nullptr;
+
+        // A single doorbell is rung for the last segment
+        send_ring_buffer(m_id, p_send_wqe,
+                         n_num_segs ? (xlio_wr_tx_packet_attr)(attr | XLIO_TX_PACKET_MORE) : attr);
+
+        p_mem_buf_desc = tmp;
+        sz_user_data_offset += sz_user_data_to_copy;
+    }
+
+    return sz_data_payload;
+}
+
 ssize_t dst_entry_udp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_send_attr attr)
 {
     /* Suppress flags that should not be used anymore
@@ -484,6 +597,19 @@ ssize_t dst_entry_udp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
      */
     attr.flags = (xlio_wr_tx_packet_attr)(attr.flags & ~(XLIO_TX_PACKET_ZEROCOPY | XLIO_TX_FILE));
 
+    // SO_TXTIME: the ring holds the buffers until the launch time
+    if (unlikely(attr.txtime)) {
+        attr.flags = (xlio_wr_tx_packet_attr)(attr.flags | XLIO_TX_PACKET_TXTIME);
+        m_p_txtime = attr.txtime;
+    }
+
+    // UDP_SEGMENT: split the payload into attr.mss sized datagrams
+    if (unlikely(attr.mss) && attr.length > attr.mss) {
+        attr.flags =
+            (xlio_wr_tx_packet_attr)(attr.flags | XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM);
+        return fast_send_gso(p_iov, sz_iov, attr.flags, attr.mss, attr.length);
+    }
+
     // Calc udp payload size
     size_t sz_udp_payload = attr.length + sizeof(struct udphdr);
     if (sz_udp_payload <= (size_t)m_max_udp_payload_size) {
@@ -514,7 +640,11 @@ ssize_t dst_entry_udp::slow_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
                               to_saddr.get_socklen());
     } else {
         if (!is_valid()) { // That means that the neigh is not resolved yet
-            ret_val = pass_buff_to_neigh(p_iov, sz_iov);
+            if (unlikely(attr.mss) && attr.length > attr.mss) {
+                ret_val = pass_buff_to_neigh_gso(p_iov, sz_iov, attr.mss, attr.length);
+            } else {
+                ret_val = pass_buff_to_neigh(p_iov, sz_iov);
+            }
         } else {
             ret_val = fast_send(p_iov, sz_iov, attr);
         }
@@ -523,6 +653,40 @@ ssize_t dst_entry_udp::slow_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
     return ret_val;
 }
 
+// Queue UDP_SEGMENT datagrams one by one until the neigh is resolved
+ssize_t dst_entry_udp::pass_buff_to_neigh_gso(const iovec *p_iov, size_t sz_iov, uint16_t gso_size,
+                                              size_t sz_data_payload)
+{
+    std::vector<iovec> seg_iov;
+    size_t sz_left = sz_data_payload;
+    size_t iov_offset = 0;
+    size_t i = 0;
+
+    while (sz_left) {
+        size_t sz_seg = std::min((size_t)gso_size, sz_left);
+
+        seg_iov.clear();
+        for (size_t sz_copy = sz_seg; sz_copy && i < sz_iov;) {
+            size_t len = std::min(sz_copy, p_iov[i].iov_len - iov_offset);
+            seg_iov.push_back({(uint8_t *)p_iov[i].iov_base + iov_offset, len});
+            sz_copy -= len;
+            iov_offset += len;
+            if (iov_offset == p_iov[i].iov_len) {
+                iov_offset = 0;
+                ++i;
+            }
+        }
+
+        ssize_t ret = pass_buff_to_neigh(seg_iov.data(), seg_iov.size());
+        if (ret < 0) {
+            return ret;
+        }
+        sz_left -= sz_seg;
+    }
+
+    return sz_data_payload;
+}
+
 void dst_entry_udp::init_sge()
 {
     m_sge[0].length = m_header->m_total_hdr_len;
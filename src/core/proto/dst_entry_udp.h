@@ -93,6 +93,10 @@ private:
     ssize_t fast_send_fragmented(const iovec *p_iov, const ssize_t sz_iov,
                                  xlio_wr_tx_packet_attr attr, size_t sz_udp_payload,
                                  ssize_t sz_data_payload);
+    ssize_t fast_send_gso(const iovec *p_iov, const ssize_t sz_iov, xlio_wr_tx_packet_attr attr,
+                          uint16_t gso_size, ssize_t sz_data_payload);
+    ssize_t pass_buff_to_neigh_gso(const iovec *p_iov, size_t sz_iov, uint16_t gso_size,
+                                   size_t sz_data_payload);
 
     const uint32_t m_n_sysvar_tx_bufs_batch_udp;
     const bool m_b_sysvar_tx_nonblocked_eagains;
@@ -274,4 +274,16 @@ inline void set_ipv6_len(void *ip, uint16_t len)
 {
     reinterpret_cast<ip6_hdr *>(ip)->ip6_plen = len;
 }
+
+// The header template stays Not-ECT, ECT(0) is set in the copy of a single packet.
+inline void set_ipv4_ect(void *ip)
+{
+    reinterpret_cast<iphdr *>(ip)->tos |= IPTOS_ECN_ECT0;
+}
+
+inline void set_ipv6_ect(void *ip)
+{
+    // The traffic class follows the 4 bits of the version in the first word
+    reinterpret_cast<ip6_hdr *>(ip)->ip6_flow |= htonl(IPTOS_ECN_ECT0 << 20);
+}
 #endif /* HEADER_H */
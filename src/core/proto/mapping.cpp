@@ -36,9 +36,12 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <sys/mman.h>
 
+#include <vector>
+
 #define MODULE_NAME "map:"
 
 #define map_logpanic   __log_panic
@@ -58,16 +61,19 @@
 
 mapping_cache *g_zc_cache = nullptr;
 
-mapping_t::mapping_t(file_uid_t &uid, mapping_cache *cache, ib_ctx_handler *p_ib_ctx)
+mapping_t::mapping_t(mapping_file_t *file, uint64_t index, mapping_cache *cache,
+                     ib_ctx_handler *p_ib_ctx)
     : m_registrator()
 {
     m_state = MAPPING_STATE_UNMAPPED;
-    m_fd = -1;
-    m_uid = uid;
+    m_file = file;
+    m_index = index;
+    m_offset = (off_t)(index * cache->get_window_size());
     m_addr = nullptr;
     m_size = 0;
     m_ref = 0;
-    m_owners = 0;
+    m_ref_time = 0;
+    m_ref_time_prev = 0;
     m_ib_ctx = p_ib_ctx;
     p_cache = cache;
 
@@ -87,9 +93,12 @@ mapping_t::~mapping_t()
 int mapping_t::map(int fd)
 {
     struct stat st;
+    size_t window;
+    size_t size;
     bool result;
     bool rw;
     int flags;
+    int map_fd;
     int rc;
 
     assert(m_state == MAPPING_STATE_UNMAPPED);
@@ -100,17 +109,34 @@ int mapping_t::map(int fd)
         goto failed;
     }
 
-    result = p_cache->memory_reserve_unlocked(st.st_size);
+    if (m_offset >= st.st_size) {
+        /* The file may grow later, so keep the window unmapped rather than failed. */
+        map_logdbg("Window offset=%lld is beyond the file size=%lld", (long long)m_offset,
+                   (long long)st.st_size);
+        errno = EOVERFLOW;
+        return -1;
+    }
+    window = p_cache->get_window_size();
+    size = st.st_size - m_offset;
+    if (window > 0 && size > window) {
+        size = window;
+    }
+
+    result = p_cache->memory_reserve_unlocked(size);
     if (!result) {
         map_logdbg("Not enough space in the mapping cache %p", p_cache);
         errno = ENOMEM;
+        if (window > 0) {
+            /* Retry later, a window fits once windows in use are released. */
+            return -1;
+        }
         goto failed;
     }
 
     /* On success, rw flag indicates whether new fd is opened for writing. */
-    m_fd = duplicate_fd(fd, rw);
-    if (m_fd < 0) {
-        goto failed;
+    map_fd = duplicate_fd(fd, rw);
+    if (map_fd < 0) {
+        goto failed_free;
     }
 
     /*
@@ -119,17 +145,19 @@ int mapping_t::map(int fd)
      * hand, ibv_reg_mr() requires PROT_WRITE, registration fails otherwise.
      * Therefore, for read-only fd we have to create a private mapping.
      */
-    m_size = st.st_size;
+    m_size = size;
     /*
      * XXX For some reason, with MAP_SHARED NGINX benchmark shows worse
      * performance results. For now, use only MAP_PRIVATE mappings.
      */
     flags = /* rw ? MAP_SHARED :*/ MAP_PRIVATE;
     m_addr = mmap64(nullptr, m_size, PROT_WRITE | PROT_READ, flags | MAP_NORESERVE | MAP_POPULATE,
-                    m_fd, 0);
+                    map_fd, m_offset);
+    /* The mapping keeps a reference to the file, so the fd isn't needed anymore. */
+    SYSCALL(close, map_fd);
     if (MAP_FAILED == m_addr) {
         map_logerr("mmap64() errno=%d (%s)", errno, strerror(errno));
-        goto failed_close_fd;
+        goto failed_reset;
     }
 
     result = m_registrator.register_memory(m_addr, m_size, m_ib_ctx);
@@ -139,17 +167,17 @@ int mapping_t::map(int fd)
     }
     m_state = MAPPING_STATE_MAPPED;
 
-    map_logdbg("Mapped: pid=%u fd=%d addr=%p size=%zu rw=%d.", (unsigned)getpid(), m_fd, m_addr,
-               m_size, !!rw);
+    map_logdbg("Mapped: pid=%u offset=%lld addr=%p size=%zu rw=%d.", (unsigned)getpid(),
+               (long long)m_offset, m_addr, m_size, !!rw);
     return 0;
 
 failed_unmap:
     (void)munmap(m_addr, m_size);
-failed_close_fd:
-    SYSCALL(close, m_fd);
+failed_reset:
     m_addr = nullptr;
     m_size = 0;
-    m_fd = -1;
+failed_free:
+    p_cache->memory_free(size);
 failed:
     m_state = MAPPING_STATE_FAILED;
     return -1;
@@ -162,8 +190,8 @@ int mapping_t::unmap(void)
     assert(m_state == MAPPING_STATE_MAPPED);
     assert(is_free());
 
-    map_logdbg("Unmapped: pid=%u fd=%d addr=%p size=%zu.", (unsigned)getpid(), m_fd, m_addr,
-               m_size);
+    map_logdbg("Unmapped: pid=%u offset=%lld addr=%p size=%zu.", (unsigned)getpid(),
+               (long long)m_offset, m_addr, m_size);
 
     m_registrator.deregister_memory();
     rc = munmap(m_addr, m_size);
@@ -171,8 +199,6 @@ int mapping_t::unmap(void)
         map_logerr("munmap() errno=%d (%s)", errno, strerror(errno));
     }
     p_cache->memory_free(m_size);
-    SYSCALL(close, m_fd);
-    m_fd = -1;
     m_addr = nullptr;
     m_size = 0;
     m_state = MAPPING_STATE_UNMAPPED;
@@ -259,15 +285,17 @@ int mapping_t::duplicate_fd(int fd, bool &rw)
     return result;
 }
 
-mapping_cache::mapping_cache(size_t threshold)
+mapping_cache::mapping_cache(size_t threshold, size_t window)
     : lock_spin("mapping_cache_lock")
+    , m_stats(g_p_global_stat->mapping_cache)
     , m_cache_uid()
     , m_cache_fd()
     , m_lru_list()
 {
-    memset(&m_stats, 0, sizeof(m_stats));
     m_used = 0;
     m_threshold = threshold;
+    m_window = window;
+    m_ref_clock = 0;
 }
 
 mapping_cache::~mapping_cache()
@@ -287,55 +315,74 @@ mapping_cache::~mapping_cache()
 
     mapping_uid_map_iter_t uid_map_iter;
     for (uid_map_iter = m_cache_uid.begin(); uid_map_iter != m_cache_uid.end(); ++uid_map_iter) {
-        mapping = uid_map_iter->second;
-        map_loginfo("Cache not empty: fd=%d ref=%u owners=%u", mapping->m_fd,
-                    (unsigned)mapping->m_ref, (unsigned)mapping->m_owners);
+        mapping_file_t *file = uid_map_iter->second;
+        for (auto &window : file->windows) {
+            mapping = window.second;
+            map_loginfo("Cache not empty: offset=%lld ref=%u owners=%u",
+                        (long long)mapping->m_offset, (unsigned)mapping->m_ref,
+                        (unsigned)file->owners);
+        }
     }
+
+    map_logdbg("Mapping cache statistics: hits=%u misses=%u evicts=%u readaheads=%u",
+               m_stats.n_hits, m_stats.n_misses, m_stats.n_evicts, m_stats.n_readaheads);
 }
 
-mapping_t *mapping_cache::get_mapping(int local_fd, void *p_ctx)
+mapping_t *mapping_cache::get_mapping(int local_fd, off_t offset, void *p_ctx)
 {
     mapping_t *mapping = nullptr;
+    mapping_file_t *file = nullptr;
     mapping_fd_map_iter_t iter;
     file_uid_t uid;
     struct stat st;
+    uint64_t index;
     ib_ctx_handler *p_ib_ctx = (ib_ctx_handler *)p_ctx;
 
     lock();
 
     iter = m_cache_fd.find(local_fd);
     if (iter != m_cache_fd.end()) {
-        mapping = iter->second;
-        if (mapping->is_free() && mapping->m_state == MAPPING_STATE_MAPPED) {
-            m_lru_list.erase(mapping);
-        }
-    }
-
-    if (!mapping) {
+        file = iter->second;
+    } else {
         if (fstat(local_fd, &st) != 0) {
             map_logerr("fstat() errno=%d (%s)", errno, strerror(errno));
             goto quit;
         }
         uid.dev = st.st_dev;
         uid.ino = st.st_ino;
-        mapping = get_mapping_by_uid_unlocked(uid, p_ib_ctx);
-        m_cache_fd[local_fd] = mapping;
-        ++mapping->m_owners;
+        file = get_file_by_uid_unlocked(uid);
+        if (!file) {
+            goto quit;
+        }
+        m_cache_fd[local_fd] = file;
+        ++file->owners;
     }
 
-quit:
+    index = m_window ? (uint64_t)offset / m_window : 0;
+    mapping = get_window_unlocked(file, index, p_ib_ctx);
     if (mapping) {
+        if (mapping->is_free() && mapping->m_state == MAPPING_STATE_MAPPED) {
+            m_lru_list.erase(mapping);
+        }
         mapping->get();
 
         /* Mapping object may be unmapped, call mmap() in this case */
         if (mapping->m_state == MAPPING_STATE_UNMAPPED) {
+            ++m_stats.n_misses;
             mapping->map(local_fd);
+        } else if (mapping->m_state == MAPPING_STATE_MAPPED) {
+            ++m_stats.n_hits;
+        }
+        if (mapping->m_state == MAPPING_STATE_MAPPED) {
+            readahead_unlocked(file, local_fd, index);
+            touch_window_unlocked(mapping);
         }
     }
 
+quit:
     unlock();
 
-    if (mapping && mapping->m_state == MAPPING_STATE_FAILED) {
+    if (mapping && mapping->m_state != MAPPING_STATE_MAPPED) {
         mapping->put();
         mapping = nullptr;
     }
@@ -347,7 +394,7 @@ void mapping_cache::release_mapping(mapping_t *mapping)
     assert(mapping->is_free());
 
     /* TODO Rework */
-    if (mapping->m_state == MAPPING_STATE_FAILED) {
+    if (mapping->m_state != MAPPING_STATE_MAPPED) {
         return;
     }
 
@@ -356,23 +403,34 @@ void mapping_cache::release_mapping(mapping_t *mapping)
 
 void mapping_cache::handle_close(int local_fd)
 {
-    mapping_t *mapping;
+    mapping_file_t *file;
     mapping_fd_map_iter_t iter;
 
     lock();
     iter = m_cache_fd.find(local_fd);
     if (iter != m_cache_fd.end()) {
-        mapping = iter->second;
-        assert(mapping->m_owners > 0);
-        --mapping->m_owners;
-        if (mapping->m_owners == 0 &&
-            (mapping->m_state != MAPPING_STATE_MAPPED &&
-             mapping->m_state != MAPPING_STATE_UNKNOWN)) {
-            m_cache_uid.erase(mapping->m_uid);
-            mapping->m_state = MAPPING_STATE_UNKNOWN;
-            delete mapping;
-        }
+        file = iter->second;
         m_cache_fd.erase(iter);
+        assert(file->owners > 0);
+        --file->owners;
+        if (file->owners == 0) {
+            /* Mapped windows stay in the cache until they are evicted. */
+            std::vector<mapping_t *> unmapped;
+            for (auto &window : file->windows) {
+                mapping_t *mapping = window.second;
+                if (mapping->is_free() && mapping->m_state != MAPPING_STATE_MAPPED) {
+                    unmapped.push_back(mapping);
+                }
+            }
+            for (mapping_t *mapping : unmapped) {
+                /* The file object is destroyed together with its last window. */
+                delete_mapping_unlocked(mapping);
+            }
+            if (unmapped.empty() && file->windows.empty()) {
+                m_cache_uid.erase(file->uid);
+                delete file;
+            }
+        }
     }
     unlock();
 }
@@ -401,29 +459,112 @@ void mapping_cache::memory_free(size_t size)
     m_used -= size;
 }
 
-mapping_t *mapping_cache::get_mapping_by_uid_unlocked(file_uid_t &uid, ib_ctx_handler *p_ib_ctx)
+mapping_file_t *mapping_cache::get_file_by_uid_unlocked(file_uid_t &uid)
 {
-    mapping_t *mapping = nullptr;
+    mapping_file_t *file = nullptr;
     mapping_uid_map_iter_t iter;
 
     iter = m_cache_uid.find(uid);
     if (iter != m_cache_uid.end()) {
-        mapping = iter->second;
-        if (mapping->is_free() && mapping->m_state == MAPPING_STATE_MAPPED) {
-            m_lru_list.erase(mapping);
+        file = iter->second;
+    } else {
+        file = new (std::nothrow) mapping_file_t();
+        if (file) {
+            file->uid = uid;
+            file->owners = 0;
+            file->last_index = 0;
+            file->readahead_index = 0;
+            m_cache_uid[uid] = file;
         }
     }
 
-    if (!mapping) {
-        mapping = new (std::nothrow) mapping_t(uid, this, p_ib_ctx);
+    return file;
+}
+
+mapping_t *mapping_cache::get_window_unlocked(mapping_file_t *file, uint64_t index,
+                                              ib_ctx_handler *p_ib_ctx)
+{
+    mapping_t *mapping = nullptr;
+    mapping_window_map_t::iterator iter;
+
+    iter = file->windows.find(index);
+    if (iter != file->windows.end()) {
+        mapping = iter->second;
+    } else {
+        mapping = new (std::nothrow) mapping_t(file, index, this, p_ib_ctx);
         if (mapping) {
-            m_cache_uid[uid] = mapping;
+            file->windows[index] = mapping;
         }
     }
 
     return mapping;
 }
 
+void mapping_cache::touch_window_unlocked(mapping_t *mapping)
+{
+    mapping_file_t *file = mapping->m_file;
+
+    /*
+     * Consecutive references to the same window of a file are correlated,
+     * e.g. a large sendfile() split into chunks. Such references refresh only
+     * the last reference time, so a single pass over a file doesn't look
+     * like a reuse and doesn't push frequently used windows out.
+     */
+    ++m_ref_clock;
+    if (mapping->m_ref_time == 0 || file->last_index != mapping->m_index) {
+        mapping->m_ref_time_prev = mapping->m_ref_time;
+    }
+    mapping->m_ref_time = m_ref_clock;
+    file->last_index = mapping->m_index;
+}
+
+void mapping_cache::readahead_unlocked(mapping_file_t *file, int local_fd, uint64_t index)
+{
+    mapping_window_map_t::iterator iter;
+    uint64_t next = index + 1;
+    int rc;
+
+    /* Sequential access is a reference to the window after the last referenced one. */
+    if (m_window == 0 || file->last_index + 1 != index || file->readahead_index == next) {
+        return;
+    }
+
+    iter = file->windows.find(next);
+    if (iter != file->windows.end() && iter->second->m_state == MAPPING_STATE_MAPPED) {
+        return;
+    }
+
+    /*
+     * The next window isn't mapped yet, so ask the kernel to read it into the
+     * page cache asynchronously. This shortens mmap() and registration of the
+     * window when the sequential reader gets there.
+     */
+    file->readahead_index = next;
+    rc = posix_fadvise(local_fd, (off_t)(next * m_window), (off_t)m_window, POSIX_FADV_WILLNEED);
+    if (rc == 0) {
+        ++m_stats.n_readaheads;
+    } else {
+        map_logdbg("posix_fadvise() rc=%d (%s)", rc, strerror(rc));
+    }
+}
+
+void mapping_cache::delete_mapping_unlocked(mapping_t *mapping)
+{
+    mapping_file_t *file = mapping->m_file;
+
+    assert(mapping->is_free());
+    assert(mapping->m_state != MAPPING_STATE_MAPPED);
+
+    file->windows.erase(mapping->m_index);
+    mapping->m_state = MAPPING_STATE_UNKNOWN;
+    delete mapping;
+
+    if (file->owners == 0 && file->windows.empty()) {
+        m_cache_uid.erase(file->uid);
+        delete file;
+    }
+}
+
 void mapping_cache::evict_mapping_unlocked(mapping_t *mapping)
 {
     assert(mapping->is_free());
@@ -431,13 +572,32 @@ void mapping_cache::evict_mapping_unlocked(mapping_t *mapping)
     if (mapping->m_state == MAPPING_STATE_MAPPED) {
         mapping->unmap();
     }
-    if (mapping->m_owners == 0 && (mapping->m_state != MAPPING_STATE_UNKNOWN)) {
-        m_cache_uid.erase(mapping->m_uid);
-        mapping->m_state = MAPPING_STATE_UNKNOWN;
-        delete mapping;
+    if (mapping->m_file->owners == 0) {
+        delete_mapping_unlocked(mapping);
     }
 }
 
+mapping_t *mapping_cache::select_victim_unlocked(void)
+{
+    mapping_t *victim = nullptr;
+
+    /*
+     * LRU-2: evict the window with the oldest previous reference, windows
+     * referenced once go first. Ties are broken by the last reference.
+     * The linear scan is cheap compared to munmap() and deregistration.
+     */
+    for (auto iter = m_lru_list.begin(); iter != m_lru_list.end(); ++iter) {
+        mapping_t *mapping = *iter;
+        if (!victim || mapping->m_ref_time_prev < victim->m_ref_time_prev ||
+            (mapping->m_ref_time_prev == victim->m_ref_time_prev &&
+             mapping->m_ref_time < victim->m_ref_time)) {
+            victim = mapping;
+        }
+    }
+
+    return victim;
+}
+
 bool mapping_cache::cache_evict_unlocked(size_t toFree)
 {
     size_t freed = 0;
@@ -449,7 +609,8 @@ bool mapping_cache::cache_evict_unlocked(size_t toFree)
         if (m_lru_list.empty()) {
             return false;
         }
-        mapping = m_lru_list.get_and_pop_front();
+        mapping = select_victim_unlocked();
+        m_lru_list.erase(mapping);
         freed += mapping->m_size;
         evict_mapping_unlocked(mapping);
         ++m_stats.n_evicts;
@@ -36,6 +36,7 @@
 #include "dev/allocator.h"
 #include "proto/mem_desc.h"
 #include "util/xlio_list.h"
+#include "util/xlio_stats.h"
 #include "utils/lock_wrapper.h"
 
 #include <stddef.h>
@@ -45,6 +46,7 @@
 
 /* Forward declaration */
 class mapping_cache;
+struct mapping_file_t;
 
 /* Identifier which must uniquely identify a file within the system. */
 struct file_uid_t {
@@ -72,10 +74,16 @@ typedef enum {
     MAPPING_STATE_FAILED
 } mapping_state_t;
 
+/*
+ * Mapping of a file window. With zero window size of the cache the window
+ * covers the whole file, otherwise windows are fixed-size ranges of the file
+ * which are mapped and registered on demand.
+ */
 /* TODO replace with rwlock */
 class mapping_t : public mem_desc, lock_spin {
 public:
-    mapping_t(file_uid_t &uid, mapping_cache *cache, ib_ctx_handler *p_ib_ctx);
+    mapping_t(mapping_file_t *file, uint64_t index, mapping_cache *cache,
+              ib_ctx_handler *p_ib_ctx);
     ~mapping_t();
 
     int map(int fd);
@@ -98,12 +106,15 @@ private:
 
 public:
     mapping_state_t m_state;
-    int m_fd;
-    file_uid_t m_uid;
+    mapping_file_t *m_file;
+    uint64_t m_index;
+    off_t m_offset;
     void *m_addr;
     size_t m_size;
     uint32_t m_ref;
-    uint32_t m_owners;
+    /* Logical time of the last and the previous uncorrelated references (LRU-2) */
+    uint64_t m_ref_time;
+    uint64_t m_ref_time_prev;
 
 private:
     mapping_cache *p_cache;
@@ -112,40 +123,62 @@ private:
     list_node<mapping_t, mapping_t::mapping_node_offset> m_node;
 };
 
-struct mapping_cache_stats {
-    uint32_t n_evicts;
+typedef std::unordered_map<uint64_t, mapping_t *> mapping_window_map_t;
+
+/* File known to the cache and its windows. */
+struct mapping_file_t {
+    file_uid_t uid;
+    /* Number of local fds which refer to the file */
+    uint32_t owners;
+    /* Index of the last referenced window and of the last readahead window */
+    uint64_t last_index;
+    uint64_t readahead_index;
+    mapping_window_map_t windows;
 };
 
-typedef std::unordered_map<int, mapping_t *> mapping_fd_map_t;
-typedef std::unordered_map<int, mapping_t *>::iterator mapping_fd_map_iter_t;
-typedef std::unordered_map<file_uid_t, mapping_t *> mapping_uid_map_t;
-typedef std::unordered_map<file_uid_t, mapping_t *>::iterator mapping_uid_map_iter_t;
+typedef std::unordered_map<int, mapping_file_t *> mapping_fd_map_t;
+typedef std::unordered_map<int, mapping_file_t *>::iterator mapping_fd_map_iter_t;
+typedef std::unordered_map<file_uid_t, mapping_file_t *> mapping_uid_map_t;
+typedef std::unordered_map<file_uid_t, mapping_file_t *>::iterator mapping_uid_map_iter_t;
 typedef xlio_list_t<mapping_t, mapping_t::mapping_node_offset> mapping_list_t;
 
 class mapping_cache : public lock_spin {
 public:
-    mapping_cache(size_t threshold);
+    mapping_cache(size_t threshold, size_t window = 0);
     ~mapping_cache();
 
-    mapping_t *get_mapping(int local_fd, void *p_ctx = nullptr);
+    /* Returns referenced mapping of the window which contains the offset. */
+    mapping_t *get_mapping(int local_fd, off_t offset = 0, void *p_ctx = nullptr);
     void release_mapping(mapping_t *mapping);
     void handle_close(int local_fd);
 
     bool memory_reserve_unlocked(size_t size);
     void memory_free(size_t size);
 
-    struct mapping_cache_stats m_stats;
+    size_t get_window_size(void) const { return m_window; }
+
+    // Published in the global statistics block
+    struct mapping_cache_stats &m_stats;
 
 private:
-    mapping_t *get_mapping_by_uid_unlocked(file_uid_t &uid, ib_ctx_handler *p_ib_ctx = nullptr);
+    mapping_file_t *get_file_by_uid_unlocked(file_uid_t &uid);
+    mapping_t *get_window_unlocked(mapping_file_t *file, uint64_t index,
+                                   ib_ctx_handler *p_ib_ctx);
+    void touch_window_unlocked(mapping_t *mapping);
+    void readahead_unlocked(mapping_file_t *file, int local_fd, uint64_t index);
+    void delete_mapping_unlocked(mapping_t *mapping);
     void evict_mapping_unlocked(mapping_t *mapping);
+    mapping_t *select_victim_unlocked(void);
     bool cache_evict_unlocked(size_t toFree);
 
     mapping_uid_map_t m_cache_uid;
     mapping_fd_map_t m_cache_fd;
+    /* Mapped windows which are not in use, the eviction candidates */
     mapping_list_t m_lru_list;
     size_t m_used;
     size_t m_threshold;
+    size_t m_window;
+    uint64_t m_ref_clock;
 };
 
 extern mapping_cache *g_zc_cache;
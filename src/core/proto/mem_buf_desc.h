@@ -42,6 +42,7 @@
 
 // Forward declarations
 class ring_slave;
+struct bpool_block;
 struct iphdr;
 struct ip6_hdr;
 
@@ -77,7 +78,7 @@ public:
         , sz_buffer(size)
         , sz_data(0)
         , p_desc_owner(nullptr)
-        , unused_padding(0)
+        , p_block(nullptr)
     {
         memset(&lwip_pbuf, 0, sizeof(lwip_pbuf));
         clear_transport_data();
@@ -147,6 +148,7 @@ public:
             size_t sz_payload; // This is the total amount of data of the packet, if
                                // (sz_payload>sz_data) means fragmented packet.
             timestamps_t timestamps;
+            uint64_t poll_tsc; // CQ poll time, set only for XLIO_STATS_LATENCY
             void *context;
 
             union {
@@ -160,6 +162,7 @@ public:
                 } tcp;
                 struct {
                     int ifindex; // Incoming interface index
+                    uint16_t gro_size; // Segment size of a UDP GRO chain, 0 otherwise
                 } udp;
             };
 
@@ -220,7 +223,9 @@ private:
     atomic_t n_ref_count; // number of interested receivers (sockinfo) [can be modified only in
                           // cq_mgr_rx context]
 public:
-    uint64_t unused_padding; // Align the structure to the cache line boundary
+    // Buffer pool memory block which holds the buffer. Also aligns the structure to
+    // the cache line boundary.
+    bpool_block *p_block;
 };
 
 typedef xlio_list_t<mem_buf_desc_t, mem_buf_desc_t::buffer_node_offset> descq_t;
@@ -544,7 +544,7 @@ bool neigh_entry::post_send_udp_ipv4(neigh_send_data *n_send_data)
         m_sge.addr =
             (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)h->m_transport_header_tx_offset);
         m_sge.length = sz_user_data_to_copy + hdr_len;
-        m_sge.lkey = m_p_ring->get_tx_lkey(m_id);
+        m_sge.lkey = p_mem_buf_desc->lkey;
         m_send_wqe.wr_id = (uintptr_t)p_mem_buf_desc;
 
         neigh_logdbg("packet_sz=%d, payload_sz=%zd, ip_offset=%d id=%d",
@@ -647,7 +647,7 @@ bool neigh_entry::post_send_udp_ipv6_not_fragmented(neigh_send_data *n_send_data
 
     m_sge.addr = (uintptr_t)(p_mem_buf_desc->p_buffer + (uint8_t)h->m_transport_header_tx_offset);
     m_sge.length = sz_data_payload + hdr_len;
-    m_sge.lkey = m_p_ring->get_tx_lkey(m_id);
+    m_sge.lkey = p_mem_buf_desc->lkey;
     m_send_wqe.wr_id = reinterpret_cast<uintptr_t>(p_mem_buf_desc);
 
     neigh_logdbg("packet_sz=%d, payload_sz=%zd, id=%d", m_sge.length - h->m_transport_header_len,
@@ -705,7 +705,7 @@ bool neigh_entry::post_send_tcp(neigh_send_data *p_data)
     size_t hdr_alignment_diff = h->m_aligned_l2_l3_len - h->m_total_hdr_len;
     m_sge.addr = (uintptr_t)((uint8_t *)p_pkt + hdr_alignment_diff);
     m_sge.length = total_packet_len;
-    m_sge.lkey = m_p_ring->get_tx_lkey(m_id);
+    m_sge.lkey = p_mem_buf_desc->lkey;
 
     /* for DEBUG */
     if ((uint8_t *)m_sge.addr < p_mem_buf_desc->p_buffer) {
@@ -102,6 +102,10 @@ xlio_lwip::xlio_lwip()
     lwip_tcp_mss = get_lwip_tcp_mss(safe_mce_sys().mtu, safe_mce_sys().lwip_mss);
     lwip_tcp_snd_buf = safe_mce_sys().tcp_send_buffer_size;
     lwip_tcp_nodelay_treshold = safe_mce_sys().tcp_nodelay_treshold;
+    lwip_tcp_cork_timeout = safe_mce_sys().tcp_cork_timeout_msec;
+    lwip_tcp_ack_segs = safe_mce_sys().tcp_ack_segs;
+    lwip_tcp_ack_bytes = safe_mce_sys().tcp_ack_bytes;
+    lwip_tcp_ecn = safe_mce_sys().tcp_ecn;
     BULLSEYE_EXCLUDE_BLOCK_END
 
     enable_push_flag = !!safe_mce_sys().tcp_push_flag;
@@ -131,6 +135,9 @@ xlio_lwip::xlio_lwip()
     register_tcp_tx_pbuf_free(sockinfo_tcp::tcp_tx_pbuf_free);
     register_tcp_rx_pbuf_free(sockinfo_tcp::tcp_rx_pbuf_free);
     register_tcp_state_observer(sockinfo_tcp::tcp_state_observer);
+    if (safe_mce_sys().tcp_fastopen & TCP_FASTOPEN_SERVER) {
+        register_tcp_fastopen_cookie(sockinfo_tcp::tcp_fastopen_cookie);
+    }
     register_ip_route_mtu(sockinfo_tcp::get_route_mtu);
     register_sys_now(sys_now);
     set_tmr_resolution(safe_mce_sys().tcp_timer_resolution_msec);
@@ -41,6 +41,8 @@ typedef enum xlio_wr_tx_packet_attr {
     /* 8 bits are reserved for TCP flags (see lwip/tcp.h)
      * this option should be synchronized with lwip/tcp value
      */
+    /* ECN capable transport, ECT(0), for this packet only. */
+    XLIO_TX_PACKET_ECT = TCP_WRITE_ECT, /* 0x04 */
     /* retransmit operation. */
     XLIO_TX_PACKET_REXMIT = TCP_WRITE_REXMIT, /* 0x08 */
     /* nop send operation. */
@@ -72,6 +74,10 @@ typedef enum xlio_wr_tx_packet_attr {
     XLIO_TX_PACKET_BLOCK = (1 << 8),
     /* Force SW checksum */
     XLIO_TX_SW_L4_CSUM = (1 << 9),
+    /* launch time scheduled send (SO_TXTIME), consumed by the ring */
+    XLIO_TX_PACKET_TXTIME = (1 << 10),
+    /* more packets of the same send follow, the ring may defer the doorbell to the last one */
+    XLIO_TX_PACKET_MORE = (1 << 11),
 } xlio_wr_tx_packet_attr;
 
 static inline bool is_set(xlio_wr_tx_packet_attr state_, xlio_wr_tx_packet_attr tx_mode_)
@@ -86,6 +92,8 @@ static inline const char *lwip_cc_algo_str(uint32_t algo)
         return "(CUBIC)";
     case CC_MOD_NONE:
         return "(NONE)";
+    case CC_MOD_DCTCP:
+        return "(DCTCP)";
     case CC_MOD_LWIP:
     default:
         return "(LWIP)";
@@ -151,7 +151,7 @@ void fd_collection::clear()
         p_sfd_api->clean_socket_obj();
     }
 
-    g_global_stat_static.n_pending_sockets = 0;
+    g_p_global_stat->n_pending_sockets = 0;
 
     /* Clean up all left overs sockinfo
      */
@@ -493,7 +493,7 @@ int fd_collection::del_sockfd(int fd, bool is_for_udp_pool /*=false*/)
             // so closed UDP sockets will be deleted at the end of the world
             if (m_p_sockfd_map[fd] == p_sfd_api) {
                 if (!is_for_udp_pool) {
-                    ++g_global_stat_static.n_pending_sockets;
+                    ++g_p_global_stat->n_pending_sockets;
                 }
                 m_p_sockfd_map[fd] = nullptr;
                 m_pending_to_remove_lst.push_front(p_sfd_api);
@@ -61,7 +61,7 @@ typedef std::unordered_map<pthread_t, int> offload_thread_rule_t;
     } while (0)
 #endif /* MAX_DEFINED_LOG_LEVEL */
 
-extern global_stats_t g_global_stat_static;
+extern global_stats_t *g_p_global_stat;
 
 class cq_channel_info : public cleanable_obj {
 public:
@@ -275,14 +275,14 @@ inline void fd_collection::reuse_sockfd(int fd, sockinfo *p_sfd_api_obj)
     lock();
     m_pending_to_remove_lst.erase(p_sfd_api_obj);
     m_p_sockfd_map[fd] = p_sfd_api_obj;
-    --g_global_stat_static.n_pending_sockets;
+    --g_p_global_stat->n_pending_sockets;
     unlock();
 }
 
 inline void fd_collection::destroy_sockfd(sockinfo *p_sfd_api_obj)
 {
     lock();
-    --g_global_stat_static.n_pending_sockets;
+    --g_p_global_stat->n_pending_sockets;
     m_pending_to_remove_lst.erase(p_sfd_api_obj);
     p_sfd_api_obj->clean_socket_obj();
     unlock();
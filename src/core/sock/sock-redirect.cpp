@@ -411,47 +411,71 @@ static ssize_t sendfile_helper(sockinfo *p_socket_object, int in_fd, __off64_t *
 
     if (PROTO_TCP == s->get_protocol()) {
         mapping_t *mapping;
+        size_t window = g_zc_cache->get_window_size();
         int rc;
 
-        /* Get mapping from the cache */
-        mapping = g_zc_cache->get_mapping(in_fd);
-        if (!mapping) {
-            srdr_logdbg("Couldn't allocate mapping object");
-            goto fallback;
-        }
-
-        if ((__off64_t)mapping->m_size < (__off64_t)(cur_offset + count)) {
-            struct stat st_buf;
+        /* Send window by window, a request may span several windows */
+        while (count > 0) {
+            __off64_t pos = cur_offset + totSent;
+            __off64_t avail;
+            ssize_t numSent;
 
-            /*
-             * This is slow path, we check fstat(2) to handle the
-             * scenario when user changes the file while respective
-             * mapping exists and the file becomes larger.
-             * As workaround, fallback to preadv() implementation.
-             */
-            mapping->put();
-            rc = fstat(in_fd, &st_buf);
-            if ((rc == 0) && (st_buf.st_size >= (off_t)(cur_offset + count))) {
-                s->get_sock_stats()->counters.n_tx_sendfile_overflows++;
+            /* Get mapping of the window from the cache */
+            mapping = g_zc_cache->get_mapping(in_fd, pos);
+            if (!mapping) {
+                srdr_logdbg("Couldn't allocate mapping object");
                 goto fallback;
-            } else {
-                errno = EOVERFLOW;
-                return -1;
             }
-        }
 
-        piov[0].iov_base = (char *)mapping->m_addr + cur_offset;
-        piov[0].iov_len = count;
+            avail = (__off64_t)mapping->m_offset + (__off64_t)mapping->m_size - pos;
+            if (avail < (__off64_t)count && (window == 0 || mapping->m_size < window)) {
+                struct stat st_buf;
+
+                /*
+                 * This is slow path, we check fstat(2) to handle the
+                 * scenario when user changes the file while respective
+                 * mapping exists and the file becomes larger.
+                 * As workaround, fallback to preadv() implementation.
+                 */
+                mapping->put();
+                if (totSent > 0) {
+                    break;
+                }
+                rc = fstat(in_fd, &st_buf);
+                if ((rc == 0) && (st_buf.st_size >= (off_t)(cur_offset + count))) {
+                    s->get_sock_stats()->counters.n_tx_sendfile_overflows++;
+                    goto fallback;
+                } else {
+                    errno = EOVERFLOW;
+                    return -1;
+                }
+            }
 
-        tx_arg.opcode = TX_FILE;
-        tx_arg.attr.iov = piov;
-        tx_arg.attr.sz_iov = 1;
-        tx_arg.attr.flags = MSG_ZEROCOPY;
-        tx_arg.priv.attr = PBUF_DESC_MDESC;
-        tx_arg.priv.mdesc = (void *)mapping;
-        totSent = p_socket_object->tx(tx_arg);
+            piov[0].iov_base = (char *)mapping->m_addr + (pos - mapping->m_offset);
+            piov[0].iov_len = min((size_t)avail, count);
 
-        mapping->put();
+            tx_arg.clear();
+            tx_arg.opcode = TX_FILE;
+            tx_arg.attr.iov = piov;
+            tx_arg.attr.sz_iov = 1;
+            tx_arg.attr.flags = MSG_ZEROCOPY;
+            tx_arg.priv.attr = PBUF_DESC_MDESC;
+            tx_arg.priv.mdesc = (void *)mapping;
+            numSent = p_socket_object->tx(tx_arg);
+
+            mapping->put();
+            if (numSent <= 0) {
+                if (totSent == 0) {
+                    totSent = numSent;
+                }
+                break;
+            }
+            totSent += numSent;
+            count -= numSent;
+            if ((size_t)numSent < piov[0].iov_len) {
+                break;
+            }
+        }
     fallback:
         /* Fallback to readv() implementation */
         if (totSent == 0) {
@@ -714,6 +738,7 @@ inline int epoll_wait_helper(int __epfd, struct epoll_event *__events, int __max
     }
 
     epoll_event extra_events_buffer[__maxevents];
+    tscval_t trace_tsc = trace_start();
 
     try {
         epoll_wait_call epcall(extra_events_buffer, nullptr, __epfd, __events, __maxevents,
@@ -724,9 +749,12 @@ inline int epoll_wait_helper(int __epfd, struct epoll_event *__events, int __max
             // if no ready nfds available then check all lower level queues (XLIO ring's and OS
             // queues)
             epcall.init_offloaded_fds();
+            tscval_t lat_start = lat_stats_start();
             rc = epcall.call();
+            lat_stats_record(LAT_EPOLL_WAIT, lat_start, nullptr);
         }
 
+        trace_event(TRACE_EPOLL_WAKEUP, trace_tsc, std::max(rc, 0));
         srdr_logfunc_exit("rc = %d", rc);
         return rc;
     } catch (io_mux_call::io_error &) {
@@ -2277,7 +2305,8 @@ EXPORT_SYMBOL pid_t XLIO_SYMBOL(fork)(void)
 
         safe_mce_sys().get_env_params();
         vlog_start(PRODUCT_NAME, safe_mce_sys().log_level, safe_mce_sys().log_filename,
-                   safe_mce_sys().log_details, safe_mce_sys().log_colors);
+                   safe_mce_sys().log_details, safe_mce_sys().log_colors,
+                   safe_mce_sys().log_async);
         if (xlio_rdma_lib_reset()) {
             srdr_logerr("Child Process: rdma_lib_reset failed %d %s", errno, strerror(errno));
         }
@@ -2358,7 +2387,8 @@ EXPORT_SYMBOL int XLIO_SYMBOL(daemon)(int __nochdir, int __noclose)
 
         safe_mce_sys().get_env_params();
         vlog_start(PRODUCT_NAME, safe_mce_sys().log_level, safe_mce_sys().log_filename,
-                   safe_mce_sys().log_details, safe_mce_sys().log_colors);
+                   safe_mce_sys().log_details, safe_mce_sys().log_colors,
+                   safe_mce_sys().log_async);
         if (xlio_rdma_lib_reset()) {
             srdr_logerr("Child Process: rdma_lib_reset failed %d %s", errno, strerror(errno));
         }
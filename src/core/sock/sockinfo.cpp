@@ -66,6 +66,8 @@ const char *sockinfo::setsockopt_so_opt_to_str(int opt)
         return "SO_REUSEADDR";
     case SO_REUSEPORT:
         return "SO_REUSEPORT";
+    case SO_INCOMING_CPU:
+        return "SO_INCOMING_CPU";
     case SO_BROADCAST:
         return "SO_BROADCAST";
     case SO_RCVBUF:
@@ -162,7 +164,8 @@ sockinfo::~sockinfo()
     }
 
     if (m_has_stats) {
-        xlio_stats_instance_remove_socket_block(m_p_socket_stats);
+        m_p_socket_stats_seq = nullptr;
+        m_p_socket_stats = xlio_stats_instance_remove_socket_block(m_p_socket_stats);
         sock_stats::instance().return_stats_obj(m_p_socket_stats);
     }
 
@@ -190,10 +193,18 @@ void sockinfo::socket_stats_init()
         }
 
         m_has_stats = true;
-        // Save stats as local copy and allow state publisher to copy from this location
-        xlio_stats_instance_create_socket_block(m_p_socket_stats);
+        // Update the shared memory block directly, local copy is used if no block is available
+        socket_stats_t *p_local_stats = m_p_socket_stats;
+        m_p_socket_stats = xlio_stats_instance_create_socket_block(p_local_stats);
+        if (m_p_socket_stats != p_local_stats) {
+            m_p_socket_stats_seq = socket_stats_block_seq(m_p_socket_stats);
+        }
     }
 
+    // A reader must not see a half reset block
+    if (m_p_socket_stats_seq) {
+        stats_seq_write_begin(m_p_socket_stats_seq);
+    }
     m_p_socket_stats->reset();
     m_p_socket_stats->fd = m_fd;
     m_p_socket_stats->inode = fd2inode(m_fd);
@@ -204,6 +215,9 @@ void sockinfo::socket_stats_init()
     m_p_socket_stats->ring_user_id_tx =
         ring_allocation_logic_tx(get_fd(), m_ring_alloc_log_tx).calc_res_key_by_logic();
     m_p_socket_stats->sa_family = m_family;
+    if (m_p_socket_stats_seq) {
+        stats_seq_write_end(m_p_socket_stats_seq);
+    }
 }
 
 ring_ec *sockinfo::pop_next_ec()
@@ -485,6 +499,15 @@ int sockinfo::setsockopt(int __level, int __optname, const void *__optval, sockl
             }
             break;
 
+        case SO_INCOMING_CPU:
+            // The option is passed to OS as well, getsockopt() is answered by the kernel
+            if (__optval && __optlen >= sizeof(int)) {
+                m_incoming_cpu = *(int *)__optval;
+                si_logdbg("SOL_SOCKET, %s=%d", setsockopt_so_opt_to_str(__optname),
+                          m_incoming_cpu);
+            }
+            break;
+
         case SO_TIMESTAMP:
         case SO_TIMESTAMPNS:
             if (__optval) {
@@ -1536,6 +1559,17 @@ void sockinfo::statistics_print(vlog_levels_t log_level /* = VLOG_DEBUG */)
                     m_p_socket_stats->counters.n_rx_poll_hit, rx_poll_hit_percentage);
         b_any_activity = true;
     }
+    if (m_p_socket_stats->counters.n_rx_adaptive_spin ||
+        m_p_socket_stats->counters.n_rx_adaptive_yield ||
+        m_p_socket_stats->counters.n_rx_adaptive_block) {
+        vlog_printf(log_level,
+                    "Rx adaptive poll : %u / %u / %u [spin/yield/block], avg wait %u usec\n",
+                    m_p_socket_stats->counters.n_rx_adaptive_spin,
+                    m_p_socket_stats->counters.n_rx_adaptive_yield,
+                    m_p_socket_stats->counters.n_rx_adaptive_block,
+                    m_p_socket_stats->n_rx_adaptive_wait_usec);
+        b_any_activity = true;
+    }
     if (b_any_activity == false) {
         vlog_printf(log_level, "Socket activity : Rx and Tx where not active\n");
     }
@@ -2260,6 +2294,9 @@ void sockinfo::handle_cmsg(struct msghdr *msg, int flags)
     if (m_b_pktinfo) {
         handle_ip_pktinfo(&cm_state);
     }
+    if (m_b_udp_gro) {
+        handle_udp_gro(&cm_state);
+    }
     if (m_b_rcvtstamp || m_n_tsing_flags) {
         handle_recv_timestamping(&cm_state);
     }
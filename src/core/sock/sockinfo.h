@@ -46,6 +46,7 @@
 #include "util/xlio_stats.h"
 #include "util/sys_vars.h"
 #include "util/wakeup_pipe.h"
+#include "util/adaptive_poll.h"
 #include "iomux/epfd_info.h"
 #include "proto/flow_tuple.h"
 #include "proto/mem_buf_desc.h"
@@ -89,6 +90,10 @@
 #define SO_REUSEPORT 15
 #endif
 
+#ifndef SO_INCOMING_CPU
+#define SO_INCOMING_CPU 49
+#endif
+
 #ifndef SO_EE_ORIGIN_ZEROCOPY
 #define SO_EE_ORIGIN_ZEROCOPY 5
 #endif
@@ -342,6 +347,7 @@ public:
     sa_family_t get_family() { return m_family; }
     bool get_reuseaddr(void) { return m_reuseaddr; }
     bool get_reuseport(void) { return m_reuseport; }
+    int get_incoming_cpu(void) const { return m_incoming_cpu; }
     int get_rx_epfd(void) { return m_rx_epfd; }
     bool is_blocking(void) { return m_b_blocking; }
     bool flow_in_reuse(void) { return m_reuseaddr | m_reuseport; }
@@ -398,6 +404,7 @@ protected:
     virtual int os_epoll_wait(epoll_event *ep_events, int maxevents);
     virtual int zero_copy_rx(iovec *p_iov, mem_buf_desc_t *pdesc, int *p_flags) = 0;
     virtual void handle_ip_pktinfo(struct cmsg_state *cm_state) = 0;
+    virtual void handle_udp_gro(struct cmsg_state *cm_state) = 0;
     virtual bool try_un_offloading(); // un-offload the socket if possible
 
     virtual size_t handle_msg_trunc(size_t total_rx, size_t payload_size, int in_flags,
@@ -409,6 +416,8 @@ protected:
 
     inline void set_rx_reuse_pending(bool is_pending = true);
     inline void reuse_buffer(mem_buf_desc_t *buff);
+    inline void adaptive_wait_begin();
+    inline void adaptive_wait_end();
     inline xlio_socketxtreme_completion_t *set_events_socketxtreme(uint64_t events,
                                                                    bool full_transaction);
     inline void set_events(uint64_t events);
@@ -492,6 +501,7 @@ protected:
     void *m_fd_context; // Context data stored with socket
     mem_buf_desc_t *m_last_zcdesc = nullptr;
     socket_stats_t *m_p_socket_stats = nullptr;
+    uint32_t *m_p_socket_stats_seq = nullptr; // Set while the stats live in the shared memory
 
     /* Socket error queue that keeps local errors and internal data required
      * to provide notification ability.
@@ -542,9 +552,13 @@ protected:
     // used to mark threshold was reached, but free was not done yet
     bool m_rx_reuse_buf_postponed = false;
     bool m_skip_cq_poll_in_rx;
+    bool m_b_adaptive_poll = safe_mce_sys().adaptive_poll;
+    adaptive_poll m_adaptive_poll; // Spin, yield or block decision of blocking receive calls
     bool m_reuseaddr = false; // to track setsockopt with SO_REUSEADDR
     bool m_reuseport = false; // to track setsockopt with SO_REUSEPORT
+    int m_incoming_cpu = -1; // to track setsockopt with SO_INCOMING_CPU
     bool m_b_pktinfo = false;
+    bool m_b_udp_gro = false;
     bool m_bind_no_port = false;
     bool m_is_ipv6only;
 
@@ -654,6 +668,27 @@ void sockinfo::save_strq_stats(uint32_t packet_strides)
     }
 }
 
+void sockinfo::adaptive_wait_begin()
+{
+    switch (m_adaptive_poll.begin_wait()) {
+    case ADAPTIVE_POLL_SPIN:
+        m_p_socket_stats->counters.n_rx_adaptive_spin++;
+        break;
+    case ADAPTIVE_POLL_YIELD:
+        m_p_socket_stats->counters.n_rx_adaptive_yield++;
+        break;
+    default:
+        m_p_socket_stats->counters.n_rx_adaptive_block++;
+        break;
+    }
+}
+
+void sockinfo::adaptive_wait_end()
+{
+    m_adaptive_poll.end_wait();
+    m_p_socket_stats->n_rx_adaptive_wait_usec = m_adaptive_poll.get_wait_avg_usec();
+}
+
 int sockinfo::dequeue_packet(iovec *p_iov, ssize_t sz_iov, sockaddr *__from, socklen_t *__fromlen,
                              int in_flags, int *p_out_flags)
 {
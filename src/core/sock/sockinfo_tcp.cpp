@@ -56,6 +56,7 @@
 #include "fd_collection.h"
 #include "sockinfo_tcp.h"
 #include "bind_no_port.h"
+#include "tcp_fastopen.h"
 #include "xlio.h"
 
 #define UNLOCK_RET(_ret)                                                                           \
@@ -78,7 +79,7 @@
 #define si_tcp_logfunc    __log_info_func
 #define si_tcp_logfuncall __log_info_funcall
 
-extern global_stats_t g_global_stat_static;
+extern global_stats_t *g_p_global_stat;
 
 tcp_timers_collection *g_tcp_timers_collection = nullptr;
 thread_local thread_local_tcp_timers g_thread_local_tcp_timers;
@@ -117,6 +118,7 @@ static bool is_inherited_option(int __level, int __optname)
         case TCP_KEEPCNT:
 #endif
         case TCP_USER_TIMEOUT:
+        case TCP_NOTSENT_LOWAT:
             ret = true;
         }
     } else if (__level == IPPROTO_IP) {
@@ -519,7 +521,13 @@ void sockinfo_tcp::err_lwip_cb_xlio_socket(void *pcb_container, err_t err)
 sockinfo_tcp::~sockinfo_tcp()
 {
     si_tcp_logfunc("");
-    g_global_stat_static.socket_tcp_destructor_counter.fetch_add(1, std::memory_order_relaxed);
+    g_p_global_stat->thread_slot().n_tcp_destructed.fetch_add(1U, std::memory_order_relaxed);
+
+    tcp_timers_collection *p_timer_collection = get_timer_collection();
+    if (p_timer_collection) {
+        // The socket is deleted directly, without UNREGISTER_TCP_SOCKET_TIMER_AND_DELETE.
+        p_timer_collection->remove_timer(this);
+    }
 
     lock_tcp_con();
 
@@ -850,6 +858,18 @@ void sockinfo_tcp::unlock_rx_q()
     unlock_tcp_con();
 }
 
+/**
+ * Raises EPOLLOUT postponed by TCP_NOTSENT_LOWAT. LwIP sends new data after the ACK callback
+ * or from the timers, so the check runs after the input processing and the timers.
+ */
+inline void sockinfo_tcp::notsent_lowat_check()
+{
+    if (unlikely(m_b_notsent_lowat_wait) && is_notsent_lowat_ok()) {
+        m_b_notsent_lowat_wait = false;
+        NOTIFY_ON_EVENTS(this, EPOLLOUT);
+    }
+}
+
 void sockinfo_tcp::tcp_timer()
 {
     if (m_state == SOCKINFO_DESTROYING) {
@@ -857,6 +877,7 @@ void sockinfo_tcp::tcp_timer()
     }
 
     tcp_tmr(&m_pcb);
+    notsent_lowat_check();
 
     return_pending_rx_buffs();
     return_pending_tx_buffs();
@@ -1001,6 +1022,7 @@ void sockinfo_tcp::put_agent_msg(void *arg)
 
 ssize_t sockinfo_tcp::tx(xlio_tx_call_attr_t &tx_arg)
 {
+    lat_tx_scope lat_tx(has_stats() ? m_p_socket_stats : nullptr);
     return m_ops->tx(tx_arg);
 }
 
@@ -1023,6 +1045,19 @@ static inline bool is_invalid_iovec(const iovec *iov, size_t sz_iov)
     return !iov || sz_iov == 0;
 }
 
+/**
+ * Corks the pcb if TCP_CORK option is set or the current send() has MSG_MORE flag.
+ * A send() without MSG_MORE on a socket without TCP_CORK releases the held data.
+ */
+inline void sockinfo_tcp::update_cork(int flags)
+{
+    if (m_b_tcp_cork || (flags & MSG_MORE)) {
+        tcp_cork_enable(&m_pcb);
+    } else {
+        tcp_cork_disable(&m_pcb);
+    }
+}
+
 /**
  * Handles transmission operations on a TCP socket, supporting various user actions such as
  * write, send, sendv, sendmsg, and sendfile. This function operates on both blocking and
@@ -1056,6 +1091,10 @@ ssize_t sockinfo_tcp::tcp_tx(xlio_tx_call_attr_t &tx_arg)
         return ret;
     }
 
+    if (unlikely(!is_rts()) && (m_tfo_pending || (flags & MSG_FASTOPEN))) {
+        return tcp_tx_fastopen(tx_arg);
+    }
+
     if (unlikely(!is_connected_and_ready_to_send())) {
         return -1;
     }
@@ -1082,6 +1121,7 @@ ssize_t sockinfo_tcp::tcp_tx(xlio_tx_call_attr_t &tx_arg)
         std::accumulate(&p_iov[0], &p_iov[sz_iov], 0U,
                         [](size_t sum, const iovec &curr) { return sum + curr.iov_len; });
     lock_tcp_con();
+    update_cork(flags);
 
     if (cannot_do_requested_partial_write(sndbuf_available(), tx_arg, total_iov_len) ||
         TCP_WND_UNAVALABLE(m_pcb, total_iov_len)) {
@@ -1154,6 +1194,106 @@ ssize_t sockinfo_tcp::tcp_tx(xlio_tx_call_attr_t &tx_arg)
     return tcp_tx_handle_done_and_unlock(total_tx, errno_tmp, is_dummy, is_non_file_zerocopy);
 }
 
+/**
+ * Starts a TCP Fast Open connection and sends the first data within SYN.
+ * The socket is either connected implicitly by sendto() with MSG_FASTOPEN flag or its
+ * connect() was deferred by TCP_FASTOPEN_CONNECT option.
+ * Without a cached cookie, SYN carries a cookie request only. In this case a blocking
+ * socket sends the data after the handshake and a non-blocking one reports EINPROGRESS.
+ *
+ * @param tx_arg    The TCP transmission arguments and parameters.
+ * @return          Returns the number of bytes transmitted, or -1 on error with the errno set.
+ */
+ssize_t sockinfo_tcp::tcp_tx_fastopen(xlio_tx_call_attr_t &tx_arg)
+{
+    bool is_blocking = BLOCK_THIS_RUN(m_b_blocking, tx_arg.attr.flags);
+
+    if (!m_tfo_pending) {
+        if (!(safe_mce_sys().tcp_fastopen & TCP_FASTOPEN_CLIENT)) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        if (!tx_arg.attr.addr) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        bool tfo_connect = m_tfo_connect;
+        m_tfo_connect = true;
+        int ret = connect(tx_arg.attr.addr, tx_arg.attr.len);
+        m_tfo_connect = tfo_connect;
+        if (m_sock_offload != TCP_SOCK_LWIP) {
+            // Not offloaded destination, the kernel handles MSG_FASTOPEN itself
+            ret = tx_os(tx_arg.opcode, tx_arg.attr.iov, tx_arg.attr.sz_iov, tx_arg.attr.flags,
+                        tx_arg.attr.addr, tx_arg.attr.len);
+            save_stats_tx_os(ret);
+            return ret;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    lock_tcp_con();
+
+    if (!m_tfo_pending) {
+        // Another thread has already started the connection
+        unlock_tcp_con();
+        return is_connected_and_ready_to_send() ? tcp_tx(tx_arg) : -1;
+    }
+    m_tfo_pending = false;
+
+    const ip_address &ip = m_connected.get_ip_addr();
+    g_tcp_fastopen->get_cookie(ip, m_pcb.tfo_cookie, m_pcb.tfo_cookie_len, m_pcb.tfo_mss);
+    m_pcb.tfo_flags |= TCP_TFO_CLIENT;
+
+    int err = tcp_connect_fastopen(&m_pcb, reinterpret_cast<const ip_addr_t *>(&ip),
+                                   ntohs(m_connected.get_in_port()), m_pcb.is_ipv6,
+                                   sockinfo_tcp::connect_lwip_cb, tx_arg.attr.iov,
+                                   tx_arg.attr.sz_iov);
+    if (err != ERR_OK) {
+        destructor_helper();
+        m_conn_state = TCP_CONN_FAILED;
+        errno = ECONNREFUSED;
+        si_tcp_logerr("bad connect, err=%d", err);
+        unlock_tcp_con();
+        return -1;
+    }
+
+    register_timer();
+
+    ssize_t ret = m_pcb.tfo_syn_len;
+    if (ret > 0 && unlikely(has_stats())) {
+        m_p_socket_stats->n_tx_ready_byte_count += ret;
+    }
+    si_tcp_logdbg("TCP Fast Open SYN with %zd bytes, cookie len %u", ret, m_pcb.tfo_cookie_len);
+
+    if (!is_blocking) {
+        m_error_status = EINPROGRESS;
+        unlock_tcp_con();
+        if (ret == 0) {
+            errno = EINPROGRESS;
+            ret = -1;
+        }
+        return ret;
+    }
+
+    if (wait_for_conn_ready_blocking() < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+            m_conn_state = TCP_CONN_FAILED;
+        }
+        int keep_errno = errno;
+        tcp_close(&m_pcb);
+        destructor_helper();
+        unlock_tcp_con();
+        errno = keep_errno;
+        return -1;
+    }
+    unlock_tcp_con();
+
+    return ret > 0 ? ret : tcp_tx(tx_arg);
+}
+
 /**
  * Handles transmission operations on a TCP socket similar to tcp_tx.
  * This is a fallback function when the operation is either blocking, not zero-copy, or the socket
@@ -1209,6 +1349,9 @@ ssize_t sockinfo_tcp::tcp_tx_slow_path(xlio_tx_call_attr_t &tx_arg)
     if (cannot_do_requested_dummy_send(m_pcb, tx_arg)) {
         return tcp_tx_handle_errno_and_unlock(EAGAIN);
     }
+    if (likely(!is_dummy)) {
+        update_cork(flags);
+    }
 
     int total_tx = 0;
     off64_t file_offset = 0;
@@ -1353,9 +1496,11 @@ err_t sockinfo_tcp::ip_output(struct pbuf *p, struct tcp_seg *seg, void *v_p_con
     dst_entry *p_dst = p_si_tcp->m_p_connected_dst_entry;
     int max_count = p_si_tcp->m_pcb.tso.max_send_sge;
     tcp_iovec lwip_iovec[max_count];
-    xlio_send_attr attr = {(xlio_wr_tx_packet_attr)flags, p_si_tcp->m_pcb.mss, 0, nullptr};
+    xlio_send_attr attr = {(xlio_wr_tx_packet_attr)flags, p_si_tcp->m_pcb.mss, 0, nullptr,
+                           nullptr};
     int count = 0;
     void *cur_end;
+    tscval_t trace_tsc = trace_start();
 
     int rc = p_si_tcp->m_ops->postrouting(p, seg, attr);
     if (rc != 0) {
@@ -1435,6 +1580,7 @@ send_iov:
         p_si_tcp->m_p_socket_stats->counters.n_tx_retransmits++;
     }
 
+    trace_event(TRACE_LWIP_OUTPUT, trace_tsc, attr.length);
     return (ret >= 0 ? ERR_OK : ERR_WOULDBLOCK);
 }
 
@@ -1506,6 +1652,12 @@ err_t sockinfo_tcp::ip_output_syn_ack(struct pbuf *p, struct tcp_seg *seg, void
     }
 }
 
+/*static*/ void sockinfo_tcp::tcp_fastopen_cookie(const ip_addr_t *addr, bool is_ipv6,
+                                                  u8_t *cookie)
+{
+    g_tcp_fastopen->gen_cookie(addr, is_ipv6, cookie);
+}
+
 uint16_t sockinfo_tcp::get_route_mtu(struct tcp_pcb *pcb)
 {
     sockinfo_tcp *tcp_sock = (sockinfo_tcp *)pcb->my_container;
@@ -1896,7 +2048,11 @@ err_t sockinfo_tcp::ack_recvd_lwip_cb(void *arg, struct tcp_pcb *tpcb, u16_t ack
     }
 
     if (conn->sndbuf_available() >= conn->m_required_send_block) {
-        NOTIFY_ON_EVENTS(conn, EPOLLOUT);
+        if (likely(conn->is_notsent_lowat_ok())) {
+            NOTIFY_ON_EVENTS(conn, EPOLLOUT);
+        } else {
+            conn->m_b_notsent_lowat_wait = true;
+        }
     }
     vlog_func_exit();
 
@@ -2108,6 +2264,8 @@ inline void sockinfo_tcp::save_packet_info_in_ready_list(pbuf *p)
     m_rx_pkt_ready_list.push_back(reinterpret_cast<mem_buf_desc_t *>(p));
     m_n_rx_pkt_ready_list_count++;
     m_rx_ready_byte_count += p->tot_len;
+    lat_stats_record(LAT_RX_CQ_TO_READY, reinterpret_cast<mem_buf_desc_t *>(p)->rx.poll_tsc,
+                     has_stats() ? m_p_socket_stats : nullptr);
 
     if (unlikely(has_stats())) {
         m_p_socket_stats->n_rx_ready_byte_count += p->tot_len;
@@ -2351,6 +2509,7 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
     int out_flags = 0;
     int in_flags = *p_flags;
     bool block_this_run = BLOCK_THIS_RUN(m_b_blocking, in_flags);
+    tscval_t lat_start = lat_stats_start();
 
     m_loops_timer.start();
 
@@ -2402,9 +2561,18 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
     return_reuse_buffers_postponed();
     unlock_tcp_con();
 
+    bool adaptive_wait =
+        m_b_adaptive_poll && block_this_run && m_rx_ready_byte_count < total_iov_sz;
+    if (adaptive_wait) {
+        adaptive_wait_begin();
+    }
+
     while (m_rx_ready_byte_count < total_iov_sz) {
         if (unlikely(g_b_exit || !is_rtr() || (m_skip_cq_poll_in_rx && (errno = EAGAIN)) ||
                      (rx_wait_lockless(poll_count, block_this_run) < 0))) {
+            if (adaptive_wait) {
+                adaptive_wait_end();
+            }
             int ret = handle_rx_error(block_this_run);
             if (__msg && ret == 0) {
                 /* We don't return a control message in this case. */
@@ -2414,6 +2582,10 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
         }
     }
 
+    if (adaptive_wait) {
+        adaptive_wait_end();
+    }
+
     lock_tcp_con();
 
     si_tcp_logfunc("something in rx queues: %d %p", m_n_rx_pkt_ready_list_count,
@@ -2474,6 +2646,7 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
     unlock_tcp_con();
 
     si_tcp_logfunc("rx completed, %d bytes sent", total_rx);
+    lat_stats_record(LAT_RX_RECV_WAIT, lat_start, has_stats() ? m_p_socket_stats : nullptr);
 
     /* Restore errno on function entry in case success */
     errno = errno_tmp;
@@ -2495,6 +2668,15 @@ void sockinfo_tcp::register_timer()
     }
 }
 
+void sockinfo_tcp::adopt_tcp_timer()
+{
+    // The timer follows the socket when another thread starts to drive it, or when the thread
+    // which registered it has exited.
+    if (m_timer_registered && get_timer_collection() != &g_thread_local_tcp_timers) {
+        g_thread_local_tcp_timers.add_new_timer(this);
+    }
+}
+
 void sockinfo_tcp::queue_rx_ctl_packet(struct tcp_pcb *pcb, mem_buf_desc_t *p_desc)
 {
     /* in tcp_ctl_thread mode, always lock the child first*/
@@ -2589,7 +2771,11 @@ bool sockinfo_tcp::rx_input_cb(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info, void
     }
 
     sock->m_xlio_thr = p_rx_pkt_mem_buf_desc_info->rx.is_xlio_thr;
+    tscval_t trace_tsc = trace_start();
+    uint32_t trace_len = p_rx_pkt_mem_buf_desc_info->lwip_pbuf.tot_len;
     L3_level_tcp_input((pbuf *)p_rx_pkt_mem_buf_desc_info, pcb);
+    trace_event(TRACE_LWIP_INPUT, trace_tsc, trace_len);
+    sock->notsent_lowat_check();
     sock->m_xlio_thr = false;
 
     if (sock != this) {
@@ -2727,6 +2913,15 @@ int sockinfo_tcp::connect(const sockaddr *__to, socklen_t __tolen)
     fit_rcv_wnd(true);
     report_connected = true;
 
+    if (m_tfo_connect && (safe_mce_sys().tcp_fastopen & TCP_FASTOPEN_CLIENT)) {
+        // SYN is sent by the first send() together with data (TCP_FASTOPEN_CONNECT)
+        m_tfo_pending = true;
+        m_sock_state = TCP_SOCK_ASYNC_CONNECT;
+        unlock_tcp_con();
+        si_tcp_logdbg("TCP Fast Open connect, SYN is deferred");
+        return 0;
+    }
+
     const ip_address &ip = m_connected.get_ip_addr();
     int err =
         tcp_connect(&m_pcb, reinterpret_cast<const ip_addr_t *>(&ip),
@@ -3807,6 +4002,16 @@ err_t sockinfo_tcp::connect_lwip_cb(void *arg, struct tcp_pcb *tpcb, err_t err)
             conn->m_rcvbuff_max = 2 * conn->m_pcb.mss;
         }
         conn->fit_rcv_wnd(false);
+        if (conn->m_pcb.tfo_flags & TCP_TFO_CLIENT) {
+            const ip_address &ip = conn->m_connected.get_ip_addr();
+            if (conn->m_pcb.tfo_flags & TCP_TFO_COOKIE_RCVD) {
+                g_tcp_fastopen->set_cookie(ip, conn->m_pcb.tfo_cookie, conn->m_pcb.tfo_cookie_len,
+                                           conn->m_pcb.mss);
+            } else if (conn->m_pcb.tfo_cookie_len && !conn->m_pcb.tfo_syn_len) {
+                // The server ignored SYN data, don't try the cookie again
+                g_tcp_fastopen->remove_cookie(ip);
+            }
+        }
     } else {
         conn->m_error_status = ECONNREFUSED;
         conn->m_conn_state = TCP_CONN_FAILED;
@@ -3995,6 +4200,10 @@ bool sockinfo_tcp::is_readable(uint64_t *p_poll_sn, fd_array_t *p_fd_array)
 
 bool sockinfo_tcp::is_writeable()
 {
+    if (unlikely(m_tfo_pending)) {
+        // TCP_FASTOPEN_CONNECT socket waits for data to send SYN
+        goto noblock;
+    }
     if (m_sock_state == TCP_SOCK_ASYNC_CONNECT) {
         if (m_conn_state == TCP_CONN_CONNECTED) {
             si_tcp_logdbg("++++ async connect ready");
@@ -4017,7 +4226,7 @@ bool sockinfo_tcp::is_writeable()
         goto noblock;
     }
 
-    if (sndbuf_available() > m_required_send_block) {
+    if (sndbuf_available() > m_required_send_block && is_notsent_lowat_ok()) {
         goto noblock;
     }
 
@@ -4322,14 +4531,41 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
         }
     } else if (__level == IPPROTO_TCP) {
         switch (__optname) {
+        case TCP_NOTSENT_LOWAT:
+            val = *(int *)__optval;
+            lock_tcp_con();
+            m_notsent_lowat = static_cast<uint32_t>(val);
+            // A higher threshold can make the socket writeable right away
+            m_b_notsent_lowat_wait = true;
+            notsent_lowat_check();
+            unlock_tcp_con();
+            si_tcp_logdbg("(TCP_NOTSENT_LOWAT) value: %u", m_notsent_lowat);
+            break;
         case TCP_CORK:
-            // We don't support TCP_CORK.
+            val = *(int *)__optval;
+            lock_tcp_con();
+            m_b_tcp_cork = !!val;
+            if (m_b_tcp_cork) {
+                tcp_cork_enable(&m_pcb);
+            } else {
+                // Uncork sends the held partial segment right away
+                tcp_cork_disable(&m_pcb);
+                tcp_output(&m_pcb);
+            }
+            unlock_tcp_con();
+            si_tcp_logdbg("(TCP_CORK) value: %d", val);
             break;
         case TCP_NODELAY:
             val = *(int *)__optval;
             lock_tcp_con();
             if (val) {
                 tcp_nagle_disable(&m_pcb);
+                if (tcp_corked(&m_pcb)) {
+                    // Setting TCP_NODELAY pushes pending data out once, even if corked
+                    tcp_cork_disable(&m_pcb);
+                    tcp_output(&m_pcb);
+                    tcp_cork_enable(&m_pcb);
+                }
             } else {
                 tcp_nagle_enable(&m_pcb);
             }
@@ -4343,6 +4579,28 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             unlock_tcp_con();
             si_tcp_logdbg("(TCP_QUICKACK) value: %d", val);
             break;
+        case TCP_FASTOPEN:
+            // The queue length only enables TFO, pending connections are limited by backlog
+            val = *(int *)__optval;
+            lock_tcp_con();
+            if (val > 0 && (safe_mce_sys().tcp_fastopen & TCP_FASTOPEN_SERVER)) {
+                m_pcb.tfo_flags |= TCP_TFO_SERVER;
+            } else {
+                m_pcb.tfo_flags &= ~TCP_TFO_SERVER;
+            }
+            unlock_tcp_con();
+            si_tcp_logdbg("(TCP_FASTOPEN) qlen: %d", val);
+            break;
+        case TCP_FASTOPEN_CONNECT:
+            val = *(int *)__optval;
+            if (val < 0 || val > 1 || m_sock_state > TCP_SOCK_BOUND) {
+                errno = EINVAL;
+                ret = -1;
+                break;
+            }
+            m_tfo_connect = !!val;
+            si_tcp_logdbg("(TCP_FASTOPEN_CONNECT) value: %d", val);
+            break;
         case TCP_ULP: {
             sockinfo_tcp_ops *ops {nullptr};
             if (__optval && __optlen >= 4 && strncmp((char *)__optval, "nvme", 4) == 0) {
@@ -4402,6 +4660,8 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
                     algo = &cubic_cc_algo;
                 } else if (cc_name == "none") {
                     algo = &none_cc_algo;
+                } else if (cc_name == "dctcp") {
+                    algo = &dctcp_cc_algo;
                 }
                 if (algo) {
                     lock_tcp_con();
@@ -4782,6 +5042,24 @@ int sockinfo_tcp::getsockopt_offload(int __level, int __optname, void *__optval,
                 errno = EINVAL;
             }
             break;
+        case TCP_NOTSENT_LOWAT:
+            if (*__optlen >= sizeof(int)) {
+                *(int *)__optval = static_cast<int>(m_notsent_lowat);
+                si_tcp_logdbg("(TCP_NOTSENT_LOWAT) value: %d", *(int *)__optval);
+                ret = 0;
+            } else {
+                errno = EINVAL;
+            }
+            break;
+        case TCP_CORK:
+            if (*__optlen >= sizeof(int)) {
+                *(int *)__optval = m_b_tcp_cork;
+                si_tcp_logdbg("(TCP_CORK) value: %d", *(int *)__optval);
+                ret = 0;
+            } else {
+                errno = EINVAL;
+            }
+            break;
         case TCP_QUICKACK:
             if (*__optlen >= sizeof(int)) {
                 *(int *)__optval = m_pcb.quickack;
@@ -5140,6 +5418,7 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
         // There are scenarios when rx_wait_helper is called in an infinite loop but exits before
         // OS epoll_wait. Delegated TCP timers must be attempted in such case.
         // This is a slow path. So calling chrono::now(), even with every iteration, is OK here.
+        adopt_tcp_timer();
         g_event_handler_manager_local.do_tasks();
     }
 
@@ -5149,7 +5428,11 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
         return -1;
     }
 
-    if (poll_count < safe_mce_sys().rx_poll_num || safe_mce_sys().rx_poll_num == -1) {
+    if (m_adaptive_poll.is_waiting()) {
+        if (m_adaptive_poll.keep_polling()) {
+            return 0;
+        }
+    } else if (poll_count < safe_mce_sys().rx_poll_num || safe_mce_sys().rx_poll_num == -1) {
         return 0;
     }
 
@@ -5927,6 +6210,7 @@ tcp_timers_collection::tcp_timers_collection()
 }
 
 tcp_timers_collection::tcp_timers_collection(int intervals)
+    : m_lock("tcp_timers")
 {
     m_n_intervals_size = intervals;
     m_p_intervals.resize(m_n_intervals_size);
@@ -5962,6 +6246,18 @@ void tcp_timers_collection::free_tta_resources()
     }
 }
 
+void tcp_timers_collection::detach_all()
+{
+    m_lock.lock();
+    for (auto &bucket : m_p_intervals) {
+        while (!bucket.empty()) {
+            bucket.get_and_pop_front()->set_timer_collection(nullptr, 0U);
+        }
+    }
+    m_n_count = 0;
+    m_lock.unlock();
+}
+
 void tcp_timers_collection::clean_obj()
 {
     if (is_cleaned()) {
@@ -5982,15 +6278,21 @@ void tcp_timers_collection::clean_obj()
 void tcp_timers_collection::handle_timer_expired(void *user_data)
 {
     NOT_IN_USE(user_data);
-    sock_list &bucket = m_p_intervals[m_n_location];
+    tscval_t lat_start = lat_stats_start();
+    uint32_t n_sockets = 0U;
+
+    m_lock.lock();
+    m_b_in_tick = true;
+    timer_list_t &bucket = m_p_intervals[m_n_location];
     m_n_location = (m_n_location + 1) % m_n_intervals_size;
 
-    auto iter = bucket.begin();
+    timer_list_t::iterator iter = bucket.begin();
     while (iter != bucket.end()) {
         sockinfo_tcp *p_sock = *iter;
-        // Must inc iter first bacause handle_timer_expired can erase
+        // Must inc iter first bacause handle_timer_expired can unlink
         // the socket that the iter points to, with delegated timers.
         iter++;
+        n_sockets++;
 
         /* It is not guaranteed that the same sockinfo object is met once
          * in this loop.
@@ -6010,6 +6312,20 @@ void tcp_timers_collection::handle_timer_expired(void *user_data)
             }
         }
     }
+    m_b_in_tick = false;
+    m_lock.unlock();
+
+    global_thread_stats_t &thread_stats = g_p_global_stat->thread_slot();
+    thread_stats.n_tcp_timer_ticks.fetch_add(1U, std::memory_order_relaxed);
+    if (n_sockets) {
+        thread_stats.n_tcp_timer_sockets.fetch_add(n_sockets, std::memory_order_relaxed);
+        if (unlikely(lat_start)) {
+            tscval_t now;
+            gettimeoftsc(&now);
+            g_p_global_stat->lat_hist[LAT_TCP_TIMER_SOCKET].add_atomic(
+                now > lat_start ? (now - lat_start) / n_sockets : 0U);
+        }
+    }
 
     /* Processing all messages for the daemon */
     if (g_p_agent) {
@@ -6024,51 +6340,110 @@ void tcp_timers_collection::add_new_timer(sockinfo_tcp *sock)
         return;
     }
 
-    sock_list &bucket = m_p_intervals[m_n_next_insert_bucket];
-    bucket.emplace_back(sock);
-    auto rc =
-        m_sock_remove_map.emplace(sock, std::make_tuple(m_n_next_insert_bucket, --(bucket.end())));
+    tcp_timers_collection *p_owner;
+    while (true) {
+        p_owner = sock->get_timer_collection();
+        if (unlikely(p_owner == this)) {
+            // Mainly for sanity check, we dont expect it.
+            __log_warn("Trying to add timer twice for TCP socket %p", sock);
+            return;
+        }
+        // A migration from the collection of another thread locks both collections, so a
+        // concurrent removal never finds the socket between the two.
+        lock_with(p_owner);
+        if (likely(sock->get_timer_collection() == p_owner)) {
+            break;
+        }
+        // Migrated by another thread before the locks were taken
+        unlock_with(p_owner);
+    }
 
-    // If the socket already exists in m_sock_remove_map, emplace returns false in rc.second
-    // Mainly for sanity check, we dont expect it.
-    if (unlikely(!rc.second)) {
-        __log_warn("Trying to add timer twice for TCP socket %p", sock);
-        bucket.pop_back();
-        return;
+    if (p_owner) {
+        p_owner->unlink_timer(sock);
     }
+    m_p_intervals[m_n_next_insert_bucket].push_back(sock);
+    sock->set_timer_collection(this, static_cast<uint32_t>(m_n_next_insert_bucket));
+    sock->set_timer_registered(true);
 
     m_n_next_insert_bucket = (m_n_next_insert_bucket + 1) % m_n_intervals_size;
-    if (0 == m_n_count++) {
-        m_timer_handle = get_event_mgr()->register_timer_event(safe_mce_sys().timer_resolution_msec,
-                                                               this, PERIODIC_TIMER, nullptr);
+    ++m_n_count;
+    if (!m_timer_handle) {
+        m_p_timer_mgr = get_event_mgr();
+        m_timer_handle = m_p_timer_mgr->register_timer_event(safe_mce_sys().timer_resolution_msec,
+                                                             this, PERIODIC_TIMER, nullptr);
     }
+    unlock_with(p_owner);
 
     __log_dbg("New TCP socket [%p] timer was added", sock);
 }
 
 void tcp_timers_collection::remove_timer(sockinfo_tcp *sock)
 {
-    auto node = m_sock_remove_map.find(sock);
-    if (node != m_sock_remove_map.end()) {
-        m_p_intervals[std::get<0>(node->second)].erase(std::get<1>(node->second));
-        m_sock_remove_map.erase(node);
-        sock->set_timer_registered(false);
+    tcp_timers_collection *p_owner = sock->get_timer_collection();
+    if (p_owner && p_owner != this) {
+        // The socket is closed by a thread other than the one which registered its timer.
+        p_owner->remove_timer(sock);
+        return;
+    }
 
-        if (!(--m_n_count)) {
-            if (m_timer_handle) {
-                get_event_mgr()->unregister_timer_event(this, m_timer_handle);
-                m_timer_handle = nullptr;
-            }
-        }
+    m_lock.lock();
+    p_owner = sock->get_timer_collection();
+    if (p_owner == this) {
+        unlink_timer(sock);
+        m_lock.unlock();
 
         __log_dbg("TCP socket [%p] timer was removed", sock);
     } else {
+        m_lock.unlock();
+        if (p_owner) {
+            // Migrated by another thread meanwhile, follow it.
+            p_owner->remove_timer(sock);
+            return;
+        }
         // Listen sockets are not added to timers.
         // As part of socket general unregister and destroy they will get here and will no be found.
         __log_dbg("TCP socket [%p] timer was not found (listen socket)", sock);
     }
 }
 
+void tcp_timers_collection::unlink_timer(sockinfo_tcp *sock)
+{
+    m_p_intervals[sock->get_timer_bucket()].erase(sock);
+    sock->set_timer_collection(nullptr, 0U);
+    sock->set_timer_registered(false);
+
+    /* The timer can be unregistered only through the manager it is registered in. A thread
+     * local manager is not thread safe and it cannot drop the timer in the middle of its
+     * expiration. Otherwise, the idle timer stays armed until the collection gets a new socket.
+     */
+    if (!(--m_n_count) && m_timer_handle && !m_b_in_tick && m_p_timer_mgr == get_event_mgr()) {
+        m_p_timer_mgr->unregister_timer_event(this, m_timer_handle);
+        m_timer_handle = nullptr;
+    }
+}
+
+// Two collections are always locked in the order of their addresses.
+void tcp_timers_collection::lock_with(tcp_timers_collection *other)
+{
+    if (!other) {
+        m_lock.lock();
+    } else if (reinterpret_cast<uintptr_t>(other) < reinterpret_cast<uintptr_t>(this)) {
+        other->m_lock.lock();
+        m_lock.lock();
+    } else {
+        m_lock.lock();
+        other->m_lock.lock();
+    }
+}
+
+void tcp_timers_collection::unlock_with(tcp_timers_collection *other)
+{
+    if (other) {
+        other->m_lock.unlock();
+    }
+    m_lock.unlock();
+}
+
 void tcp_timers_collection::register_wakeup_event()
 {
     g_p_event_handler_manager->wakeup_timer_event(this, m_timer_handle);
@@ -6081,6 +6456,8 @@ thread_local_tcp_timers::thread_local_tcp_timers()
 
 thread_local_tcp_timers::~thread_local_tcp_timers()
 {
+    // Sockets outlive the thread, the next thread which drives a socket adopts its timer.
+    detach_all();
     m_timer_handle = nullptr;
 }
 
@@ -6360,6 +6737,7 @@ ssize_t sockinfo_tcp::tcp_tx_handle_sndbuf_unavailable(ssize_t total_tx, bool is
                 option_tcp_ctl_thread::CTL_THREAD_DELEGATE_TCP_TIMERS) {
                 // Slow path. We must attempt TCP timers here for applications that
                 // do not check for EV_OUT.
+                adopt_tcp_timer();
                 g_event_handler_manager_local.do_tasks();
             }
             // in case of zero sndbuf and non-blocking just try once polling CQ for
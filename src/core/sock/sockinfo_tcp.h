@@ -50,6 +50,7 @@
 /* Forward declarations */
 struct xlio_socket_attr;
 class poll_group;
+class tcp_timers_collection;
 
 #define BLOCK_THIS_RUN(blocking, flags) (blocking && !(flags & MSG_DONTWAIT))
 
@@ -124,51 +125,6 @@ struct socket_option_t {
     }
 };
 
-class tcp_timers_collection : public timer_handler, public cleanable_obj {
-public:
-    tcp_timers_collection();
-    tcp_timers_collection(int intervals);
-    ~tcp_timers_collection() override;
-
-    void clean_obj() override;
-
-    void handle_timer_expired(void *user_data) override;
-
-    void register_wakeup_event();
-
-    void add_new_timer(sockinfo_tcp *sock);
-
-    void remove_timer(sockinfo_tcp *sock);
-
-    void set_group(poll_group *group) { m_p_group = group; }
-    inline event_handler_manager *get_event_mgr();
-
-private:
-    void free_tta_resources();
-
-protected:
-    void *m_timer_handle = nullptr;
-
-private:
-    typedef std::list<sockinfo_tcp *> sock_list;
-    typedef typename sock_list::iterator sock_list_itr;
-    std::vector<sock_list> m_p_intervals;
-    std::unordered_map<sockinfo_tcp *, std::tuple<uint32_t, sock_list_itr>> m_sock_remove_map;
-    int m_n_intervals_size;
-    int m_n_location = 0;
-    int m_n_count = 0;
-    int m_n_next_insert_bucket = 0;
-    poll_group *m_p_group = nullptr;
-};
-
-class thread_local_tcp_timers : public tcp_timers_collection {
-public:
-    thread_local_tcp_timers();
-    ~thread_local_tcp_timers() override;
-};
-
-extern tcp_timers_collection *g_tcp_timers_collection;
-
 typedef std::deque<socket_option_t *> socket_options_list_t;
 typedef std::map<tcp_pcb *, int> ready_pcb_map_t;
 typedef std::map<flow_tuple, tcp_pcb *> syn_received_map_t;
@@ -190,6 +146,7 @@ public:
         return NODE_OFFSET(sockinfo_tcp, accepted_conns_node);
     }
     typedef xlio_list_t<sockinfo_tcp, sockinfo_tcp::accepted_conns_node_offset> sock_list_t;
+    static inline size_t timer_node_offset() { return NODE_OFFSET(sockinfo_tcp, timer_node); }
     sockinfo_tcp(int fd, int domain);
     ~sockinfo_tcp() override;
 
@@ -251,6 +208,15 @@ public:
 
     inline unsigned get_mss() { return m_pcb.mss; }
 
+    // Bytes queued by the application which have not been sent yet
+    inline uint32_t notsent_bytes() { return m_pcb.snd_lbb - m_pcb.snd_nxt; }
+
+    // TCP_NOTSENT_LOWAT: socket is writeable only when notsent bytes drop below the threshold
+    inline bool is_notsent_lowat_ok()
+    {
+        return !m_notsent_lowat || notsent_bytes() < m_notsent_lowat;
+    }
+
     ssize_t tx(xlio_tx_call_attr_t &tx_arg) override;
     ssize_t tcp_tx(xlio_tx_call_attr_t &tx_arg);
     ssize_t rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov, int *p_flags,
@@ -260,6 +226,7 @@ public:
     static err_t ip_output_syn_ack(struct pbuf *p, struct tcp_seg *seg, void *v_p_conn,
                                    uint16_t flags);
     static void tcp_state_observer(void *pcb_container, enum tcp_state new_state);
+    static void tcp_fastopen_cookie(const ip_addr_t *addr, bool is_ipv6, u8_t *cookie);
     static uint16_t get_route_mtu(struct tcp_pcb *pcb);
 
     void update_header_field(data_updater *updater) override;
@@ -322,6 +289,18 @@ public:
     bool is_incoming() override { return m_b_incoming; }
     bool is_timer_registered() const { return m_timer_registered; }
     void set_timer_registered(bool v) { m_timer_registered = v; }
+    // Read without the collection lock to find the collection to lock
+    tcp_timers_collection *get_timer_collection() const
+    {
+        return __atomic_load_n(&m_timer_collection, __ATOMIC_ACQUIRE);
+    }
+    uint32_t get_timer_bucket() const { return m_timer_bucket; }
+    // Called under the lock of the collection the socket leaves or joins
+    void set_timer_collection(tcp_timers_collection *collection, uint32_t bucket)
+    {
+        m_timer_bucket = bucket;
+        __atomic_store_n(&m_timer_collection, collection, __ATOMIC_RELEASE);
+    }
 
     bool is_connected() { return m_sock_state == TCP_SOCK_CONNECTED_RDWR; }
 
@@ -489,6 +468,9 @@ private:
     ssize_t tcp_tx_handle_sndbuf_unavailable(ssize_t total_tx, bool is_dummy, bool is_send_zerocopy,
                                              int errno_to_restore);
     ssize_t tcp_tx_slow_path(xlio_tx_call_attr_t &tx_arg);
+    ssize_t tcp_tx_fastopen(xlio_tx_call_attr_t &tx_arg);
+    inline void update_cork(int flags);
+    inline void notsent_lowat_check();
     inline err_t handle_fin(struct tcp_pcb *pcb, err_t err);
     inline void handle_rx_lwip_cb_error(pbuf *p);
     inline void rx_lwip_cb_error(pbuf *p);
@@ -501,6 +483,8 @@ private:
     void passthrough_unlock(const char *dbg);
     // Register to timer
     void register_timer();
+    // Delegated timers: move the timer to the collection of the calling thread
+    void adopt_tcp_timer();
 
     void handle_socket_linger();
 
@@ -508,6 +492,7 @@ private:
      * Supported only for UDP
      */
     void handle_ip_pktinfo(struct cmsg_state *) override {};
+    void handle_udp_gro(struct cmsg_state *) override {};
 
     int handle_rx_error(bool blocking);
 
@@ -611,6 +596,7 @@ public:
     static const int CONNECT_DEFAULT_TIMEOUT_MS = 10000;
 
     list_node<sockinfo_tcp, sockinfo_tcp::accepted_conns_node_offset> accepted_conns_node;
+    list_node<sockinfo_tcp, sockinfo_tcp::timer_node_offset> timer_node;
 
 private:
     sockinfo_tcp_ops *m_ops;
@@ -629,6 +615,9 @@ private:
     bool m_b_incoming;
     bool m_b_attached;
     bool m_timer_registered = false;
+    // Collection the socket timer is linked to, maintained by tcp_timers_collection
+    uint32_t m_timer_bucket = 0U;
+    tcp_timers_collection *m_timer_collection = nullptr;
     /* connection state machine */
     int m_conn_timeout;
     /* RCVBUF acconting */
@@ -661,6 +650,16 @@ private:
     // used for reporting 'connected' on second non-blocking call to connect or
     // second call to failed connect blocking socket.
     bool report_connected;
+    // TCP_FASTOPEN_CONNECT option value
+    bool m_tfo_connect = false;
+    // connect() deferred SYN to the first send()
+    bool m_tfo_pending = false;
+    // TCP_CORK option value
+    bool m_b_tcp_cork = false;
+    // EPOLLOUT is postponed until notsent bytes drop below TCP_NOTSENT_LOWAT
+    bool m_b_notsent_lowat_wait = false;
+    // TCP_NOTSENT_LOWAT option value, 0 means unlimited
+    uint32_t m_notsent_lowat = 0U;
     bool m_is_cleaned = false; // If this socket registered deletion on internal thread.
     int m_error_status;
 
@@ -696,4 +695,69 @@ private:
     poll_group *m_p_group = nullptr;
 };
 
+/*
+ * TCP timers of a set of sockets. The sockets are spread over a wheel of intervals, one bucket
+ * is serviced per timer tick. Sockets are linked through an intrusive node, so adding and
+ * removing a socket is O(1) and never allocates.
+ *
+ * A socket belongs to a single collection at a time and remembers it, so removal works from any
+ * context. Adding a socket which belongs to another collection migrates it. With delegated
+ * timers, every thread owns a collection and a socket follows the thread which drives it.
+ */
+class tcp_timers_collection : public timer_handler, public cleanable_obj {
+public:
+    tcp_timers_collection();
+    tcp_timers_collection(int intervals);
+    ~tcp_timers_collection() override;
+
+    void clean_obj() override;
+
+    void handle_timer_expired(void *user_data) override;
+
+    void register_wakeup_event();
+
+    void add_new_timer(sockinfo_tcp *sock);
+
+    void remove_timer(sockinfo_tcp *sock);
+
+    void set_group(poll_group *group) { m_p_group = group; }
+    inline event_handler_manager *get_event_mgr();
+
+private:
+    void free_tta_resources();
+    // The socket must be in this collection, which is locked
+    void unlink_timer(sockinfo_tcp *sock);
+    void lock_with(tcp_timers_collection *other);
+    void unlock_with(tcp_timers_collection *other);
+
+protected:
+    typedef xlio_list_t<sockinfo_tcp, sockinfo_tcp::timer_node_offset> timer_list_t;
+
+    // Unlinks all the sockets, they stay registered and can be adopted by another collection.
+    void detach_all();
+
+    void *m_timer_handle = nullptr;
+    // Manager the periodic timer is registered in, timers are unregistered through it.
+    event_handler_manager *m_p_timer_mgr = nullptr;
+
+private:
+    std::vector<timer_list_t> m_p_intervals;
+    // Protects the buckets against removal or migration from a foreign thread.
+    lock_spin_recursive m_lock;
+    int m_n_intervals_size;
+    int m_n_location = 0;
+    int m_n_count = 0;
+    int m_n_next_insert_bucket = 0;
+    bool m_b_in_tick = false;
+    poll_group *m_p_group = nullptr;
+};
+
+class thread_local_tcp_timers : public tcp_timers_collection {
+public:
+    thread_local_tcp_timers();
+    ~thread_local_tcp_timers() override;
+};
+
+extern tcp_timers_collection *g_tcp_timers_collection;
+
 #endif
@@ -40,6 +40,7 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <algorithm>
 
 #include "utils/bullseye.h"
@@ -150,7 +151,11 @@ inline int sockinfo_udp::rx_wait(bool blocking)
         }
 
         loops++;
-        if (!blocking || safe_mce_sys().rx_poll_num != -1) {
+        if (blocking && m_adaptive_poll.is_waiting()) {
+            if (!m_adaptive_poll.keep_polling()) {
+                loops_to_go = 0;
+            }
+        } else if (!blocking || safe_mce_sys().rx_poll_num != -1) {
             loops_to_go--;
         }
         if (m_loops_timer.is_timeout()) {
@@ -435,7 +440,7 @@ sockinfo_udp::sockinfo_udp(int fd, int domain)
 sockinfo_udp::~sockinfo_udp()
 {
     si_udp_logfunc("");
-    g_global_stat_static.socket_udp_destructor_counter.fetch_add(1, std::memory_order_relaxed);
+    g_p_global_stat->thread_slot().n_udp_destructed.fetch_add(1U, std::memory_order_relaxed);
 
     // Remove all RX ready queue buffers (Push into reuse queue per ring)
     si_udp_logdbg("Releasing %d ready rx packets (total of %lu bytes)", m_n_rx_pkt_ready_list_count,
@@ -934,6 +939,22 @@ int sockinfo_udp::setsockopt(int __level, int __optname, __const void *__optval,
                 return -1;
             }
             break;
+
+        case SO_TXTIME:
+            // The kernel validates the clock and the flags, datagrams sent by the OS use them too
+            ret = setsockopt_kernel(__level, __optname, __optval, __optlen, true, false);
+            if (ret == 0 && __optval && __optlen >= sizeof(struct sock_txtime)) {
+                const struct sock_txtime *so_txtime =
+                    reinterpret_cast<const struct sock_txtime *>(__optval);
+                m_so_txtime.time_ns = 0U;
+                m_so_txtime.clockid = so_txtime->clockid;
+                m_so_txtime.deadline_mode = so_txtime->flags & SOF_TXTIME_DEADLINE_MODE;
+                m_b_so_txtime = true;
+            }
+            si_udp_logdbg("SOL_SOCKET, SO_TXTIME clockid=%d deadline_mode=%d (ret=%d)",
+                          m_so_txtime.clockid, m_so_txtime.deadline_mode, ret);
+            return ret;
+
         default:
             si_udp_logdbg("SOL_SOCKET, optname=%s (%d)", setsockopt_so_opt_to_str(__optname),
                           __optname);
@@ -1292,6 +1313,22 @@ int sockinfo_udp::setsockopt(int __level, int __optname, __const void *__optval,
             m_port_map_lock.unlock();
             return 0;
         }
+        case UDP_SEGMENT:
+            // Invalid values are rejected by the kernel below
+            if (__optval && __optlen >= sizeof(int)) {
+                int val = *(const int *)__optval;
+                if (val >= 0 && val <= USHRT_MAX) {
+                    m_gso_size = static_cast<uint16_t>(val);
+                }
+            }
+            si_udp_logdbg("IPPROTO_UDP, UDP_SEGMENT=%u", m_gso_size);
+            break;
+        case UDP_GRO:
+            if (__optval && __optlen >= sizeof(int)) {
+                m_b_udp_gro = *(const int *)__optval != 0;
+            }
+            si_udp_logdbg("IPPROTO_UDP, UDP_GRO=%d", m_b_udp_gro);
+            break;
         default:
             si_udp_logdbg("IPPROTO_UDP, optname=%s (%d)", setsockopt_ip_opt_to_str(__optname),
                           __optname);
@@ -1690,6 +1727,23 @@ int sockinfo_udp::getsockopt(int __level, int __optname, void *__optval, socklen
     } // case SOL_SOCKET
     break;
 
+    case IPPROTO_UDP:
+        switch (__optname) {
+        case UDP_SEGMENT:
+            // The value is returned by the kernel, it is always in sync with m_gso_size
+            si_udp_logdbg("IPPROTO_UDP, UDP_SEGMENT=%u", m_gso_size);
+            break;
+        case UDP_GRO:
+            // The value is returned by the kernel, it is always in sync with m_b_udp_gro
+            si_udp_logdbg("IPPROTO_UDP, UDP_GRO=%d", m_b_udp_gro);
+            break;
+        default:
+            si_udp_logdbg("IPPROTO_UDP, optname=%d", __optname);
+            supported = false;
+            break;
+        }
+        break;
+
     default: {
         si_udp_logdbg("level = %d, optname = %d", __level, __optname);
         supported = false;
@@ -1761,6 +1815,8 @@ ssize_t sockinfo_udp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
     uint64_t poll_sn = 0;
     int out_flags = 0;
     int in_flags = *p_flags;
+    bool adaptive_wait = false;
+    tscval_t lat_start = lat_stats_start();
 
     si_udp_logfunc("");
 
@@ -1827,6 +1883,10 @@ wait:
      * Wait for RX to become ready.
      */
     si_udp_logfunc("rx_wait: %d", m_fd);
+    if (m_b_adaptive_poll && !adaptive_wait && m_b_blocking && !(in_flags & MSG_DONTWAIT)) {
+        adaptive_wait = true;
+        adaptive_wait_begin();
+    }
     rx_wait_ret = rx_wait(m_b_blocking && !(in_flags & MSG_DONTWAIT));
 
     m_lock_rcv.lock();
@@ -1875,6 +1935,10 @@ out:
     /* coverity[double_unlock] TODO: RM#1049980 */
     m_lock_rcv.unlock();
 
+    if (adaptive_wait) {
+        adaptive_wait_end();
+    }
+
     if (__msg) {
         __msg->msg_flags |= out_flags & MSG_TRUNC;
     }
@@ -1882,6 +1946,7 @@ out:
     if (ret < 0) {
         si_udp_logfunc("returning with: %d (errno=%d %m)", ret, errno);
     } else {
+        lat_stats_record(LAT_RX_RECV_WAIT, lat_start, has_stats() ? m_p_socket_stats : nullptr);
         /* Restore errno on function entry in case success */
         errno = errno_tmp;
 
@@ -1930,6 +1995,17 @@ void sockinfo_udp::handle_ip_pktinfo(struct cmsg_state *cm_state)
     }
 }
 
+void sockinfo_udp::handle_udp_gro(struct cmsg_state *cm_state)
+{
+    mem_buf_desc_t *p_desc = m_rx_pkt_ready_list.front();
+
+    // Same as the kernel, the segment size is reported only for coalesced datagrams
+    if (p_desc && p_desc->rx.udp.gro_size) {
+        int gro_size = p_desc->rx.udp.gro_size;
+        insert_cmsg(cm_state, SOL_UDP, UDP_GRO, &gro_size, sizeof(gro_size));
+    }
+}
+
 // This function is relevant only for non-blocking socket
 void sockinfo_udp::set_immediate_os_sample()
 {
@@ -2049,6 +2125,35 @@ int sockinfo_udp::rx_request_notification(uint64_t poll_sn)
     return ring_ready_count;
 }
 
+// UDP_SEGMENT control message overrides the socket option for a single sendmsg()
+static inline uint16_t get_gso_size_cmsg(const struct msghdr *msg, uint16_t gso_size)
+{
+    struct msghdr *__msg = const_cast<struct msghdr *>(msg);
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(__msg); cmsg; cmsg = CMSG_NXTHDR(__msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_SEGMENT &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(uint16_t))) {
+            gso_size = *reinterpret_cast<uint16_t *>(CMSG_DATA(cmsg));
+        }
+    }
+    return gso_size;
+}
+
+// SCM_TXTIME control message carries the launch time of a single sendmsg()
+static inline bool get_txtime_cmsg(const struct msghdr *msg, uint64_t &txtime)
+{
+    struct msghdr *__msg = const_cast<struct msghdr *>(msg);
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(__msg); cmsg; cmsg = CMSG_NXTHDR(__msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TXTIME &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(uint64_t))) {
+            memcpy(&txtime, CMSG_DATA(cmsg), sizeof(txtime));
+            return true;
+        }
+    }
+    return false;
+}
+
 ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
 {
     const iovec *p_iov = tx_arg.attr.iov;
@@ -2061,6 +2166,7 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
     bool is_dummy = IS_DUMMY_PACKET(__flags);
     dst_entry *p_dst_entry = m_p_connected_dst_entry; // Default for connected() socket but we'll
                                                       // update it on a specific sendTO(__to) call
+    lat_tx_scope lat_tx(has_stats() ? m_p_socket_stats : nullptr);
 
     si_udp_logfunc("");
 
@@ -2177,7 +2283,8 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
     }
 
     {
-        xlio_send_attr attr = {(xlio_wr_tx_packet_attr)0, 0, 0, nullptr};
+        xlio_send_attr attr = {(xlio_wr_tx_packet_attr)0, 0, 0, nullptr, nullptr};
+        xlio_txtime txtime = m_so_txtime;
         bool b_blocking = m_b_blocking;
         if (unlikely(__flags & MSG_DONTWAIT)) {
             b_blocking = false;
@@ -2186,6 +2293,14 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
         attr.length = static_cast<size_t>(sz_data_payload);
         attr.flags = (xlio_wr_tx_packet_attr)((b_blocking * XLIO_TX_PACKET_BLOCK) |
                                               (is_dummy * XLIO_TX_PACKET_DUMMY));
+        attr.mss = m_gso_size;
+        if (tx_arg.opcode == TX_SENDMSG && tx_arg.attr.hdr &&
+            tx_arg.attr.hdr->msg_controllen > 0) {
+            attr.mss = get_gso_size_cmsg(tx_arg.attr.hdr, attr.mss);
+            if (m_b_so_txtime && get_txtime_cmsg(tx_arg.attr.hdr, txtime.time_ns)) {
+                attr.txtime = &txtime;
+            }
+        }
         if (likely(p_dst_entry->is_valid())) {
             // All set for fast path packet sending - this is our best performance flow
             ret = p_dst_entry->fast_send(p_iov, sz_iov, attr);
@@ -2376,6 +2491,8 @@ inline void sockinfo_udp::update_ready(mem_buf_desc_t *p_desc, void *pv_fd_ready
         m_rx_pkt_ready_list.push_back(p_desc);
         m_n_rx_pkt_ready_list_count++;
         m_rx_ready_byte_count += p_desc->rx.sz_payload;
+        lat_stats_record(LAT_RX_CQ_TO_READY, p_desc->rx.poll_tsc,
+                         has_stats() ? m_p_socket_stats : nullptr);
         if (unlikely(has_stats())) {
             m_p_socket_stats->n_rx_ready_byte_count += p_desc->rx.sz_payload;
             m_p_socket_stats->n_rx_ready_pkt_count++;
@@ -113,6 +113,7 @@ public:
     int getpeername(sockaddr *__name, socklen_t *__namelen) override;
     int setsockopt(int __level, int __optname, const void *__optval, socklen_t __optlen) override;
     int getsockopt(int __level, int __optname, void *__optval, socklen_t *__optlen) override;
+    bool is_udp_gro() const { return m_b_udp_gro; }
 
     int resolve_if_ip(const int if_index, const ip_address &ip, ip_address &resolved_ip);
     int fill_mc_structs_ip6(int optname, const void *optval, mc_pending_pram *mcpram);
@@ -278,6 +279,7 @@ private:
     size_t handle_msg_trunc(size_t total_rx, size_t payload_size, int in_flags,
                             int *p_out_flags) override;
     void handle_ip_pktinfo(struct cmsg_state *cm_state) override;
+    void handle_udp_gro(struct cmsg_state *cm_state) override;
 
     mem_buf_desc_t *get_front_m_rx_pkt_ready_list() override;
     size_t get_size_m_rx_pkt_ready_list() override;
@@ -327,6 +329,9 @@ private:
     const uint32_t m_n_sysvar_rx_delta_tsc_between_cq_polls;
 
     bool m_sockopt_mapped; // setsockopt IPPROTO_UDP UDP_MAP_ADD
+    uint16_t m_gso_size = 0U; // setsockopt IPPROTO_UDP UDP_SEGMENT
+    bool m_b_so_txtime = false; // setsockopt SOL_SOCKET SO_TXTIME
+    xlio_txtime m_so_txtime = {0U, CLOCK_MONOTONIC, false}; // Clock and mode of SCM_TXTIME
     bool m_is_connected; // to inspect for in_addr.src
     bool m_multicast; // true when socket set MC rule
 };
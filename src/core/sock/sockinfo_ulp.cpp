@@ -254,7 +254,7 @@ public:
         const uintptr_t ubuf = (uintptr_t)m_p_buf->p_buffer;
 
         if (ubuf <= uaddr && uaddr < ubuf + m_p_buf->sz_buffer) {
-            return LKEY_TX_DEFAULT;
+            return m_p_buf->lkey;
         } else {
             return m_p_zc_owner->get_lkey(desc, ib_ctx, addr, len);
         }
@@ -891,7 +891,7 @@ int sockinfo_tcp_ops_tls::postrouting(struct pbuf *p, struct tcp_seg *seg, xlio_
                 bool is_zerocopy = rec->m_p_zc_owner;
                 unsigned mss = m_p_sock->get_mss();
                 uint32_t totlen = seg->seqno - rec->m_seqno;
-                uint32_t lkey = LKEY_TX_DEFAULT;
+                uint32_t lkey = rec->m_p_buf->lkey;
                 uint32_t hdrlen = 0;
                 uint32_t taillen = 0;
 
@@ -945,7 +945,7 @@ int sockinfo_tcp_ops_tls::postrouting(struct pbuf *p, struct tcp_seg *seg, xlio_
                     if (is_zerocopy) {
                         /* hdrlen and taillen are prepared above. */
                         m_p_tx_ring->tls_tx_post_dump_wqe(m_p_tis, (void *)addr, hdrlen,
-                                                          LKEY_TX_DEFAULT, true);
+                                                          rec->m_p_buf->lkey, true);
                         addr_tail = addr + hdrlen;
                         addr = rec->m_p_zc_data;
                         totlen = totlen - hdrlen - taillen; /* Remaining ZC part. */
@@ -967,7 +967,7 @@ int sockinfo_tcp_ops_tls::postrouting(struct pbuf *p, struct tcp_seg *seg, xlio_
 
                     if (is_zerocopy && taillen) {
                         m_p_tx_ring->tls_tx_post_dump_wqe(m_p_tis, (void *)addr_tail, taillen,
-                                                          LKEY_TX_DEFAULT, false);
+                                                          rec->m_p_buf->lkey, false);
                         --dump_nr;
                     }
                 }
@@ -1299,7 +1299,7 @@ err_t sockinfo_tcp_ops_tls::recv(struct pbuf *p)
         if (likely(m_rx_psv_buf->sz_buffer >= (size_t)(payload - m_rx_psv_buf->p_buffer + 64))) {
             memset(m_rx_psv_buf->lwip_pbuf.payload, 0, 64);
             m_rx_resync_recno = m_next_recno_rx;
-            m_p_tx_ring->tls_get_progress_params_rx(m_p_tir, payload, LKEY_TX_DEFAULT);
+            m_p_tx_ring->tls_get_progress_params_rx(m_p_tir, payload, m_rx_psv_buf->lkey);
             ++m_p_sock->get_sock_stats()->tls_counters.n_tls_rx_resync;
         }
     }
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "tcp_fastopen.h"
+#include <mutex>
+#include <random>
+#include <string.h>
+
+tcp_fastopen *g_tcp_fastopen = nullptr;
+
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND(v0, v1, v2, v3)                                                                   \
+    do {                                                                                           \
+        v0 += v1;                                                                                  \
+        v1 = ROTL64(v1, 13);                                                                       \
+        v1 ^= v0;                                                                                  \
+        v0 = ROTL64(v0, 32);                                                                       \
+        v2 += v3;                                                                                  \
+        v3 = ROTL64(v3, 16);                                                                       \
+        v3 ^= v2;                                                                                  \
+        v0 += v3;                                                                                  \
+        v3 = ROTL64(v3, 21);                                                                       \
+        v3 ^= v0;                                                                                  \
+        v2 += v1;                                                                                  \
+        v1 = ROTL64(v1, 17);                                                                       \
+        v1 ^= v2;                                                                                  \
+        v2 = ROTL64(v2, 32);                                                                       \
+    } while (0)
+
+/* SipHash-2-4 of a message which is up to 16 bytes long. */
+static uint64_t siphash24(const uint64_t key[2], const uint8_t *data, size_t len)
+{
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ key[1];
+    uint8_t block[24] = {0};
+    size_t nblocks = len / 8U + 1U;
+
+    memcpy(block, data, len);
+    block[nblocks * 8U - 1U] = (uint8_t)len;
+
+    for (size_t i = 0; i < nblocks; ++i) {
+        uint64_t m = 0;
+        for (int j = 7; j >= 0; --j) {
+            m = (m << 8) | block[i * 8U + j];
+        }
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+tcp_fastopen::tcp_fastopen()
+{
+    std::random_device rd;
+
+    for (uint64_t &k : m_key) {
+        k = ((uint64_t)rd() << 32) | rd();
+    }
+}
+
+bool tcp_fastopen::get_cookie(const ip_address &addr, u8_t *cookie, u8_t &cookie_len, u16_t &mss)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    auto iter = m_cookies.find(addr);
+    if (iter == m_cookies.end()) {
+        return false;
+    }
+    memcpy(cookie, iter->second.data, iter->second.len);
+    cookie_len = iter->second.len;
+    mss = iter->second.mss;
+    return true;
+}
+
+void tcp_fastopen::set_cookie(const ip_address &addr, const u8_t *cookie, u8_t cookie_len,
+                              u16_t mss)
+{
+    cached_cookie entry;
+
+    entry.mss = mss;
+    entry.len = std::min<u8_t>(cookie_len, TCP_TFO_COOKIE_MAX);
+    memcpy(entry.data, cookie, entry.len);
+
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    if (m_cookies.size() >= MAX_CACHED_COOKIES && m_cookies.find(addr) == m_cookies.end()) {
+        m_cookies.clear();
+    }
+    m_cookies[addr] = entry;
+}
+
+void tcp_fastopen::remove_cookie(const ip_address &addr)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    m_cookies.erase(addr);
+}
+
+void tcp_fastopen::gen_cookie(const ip_addr_t *addr, bool is_ipv6, u8_t *cookie) const
+{
+    static_assert(TCP_TFO_COOKIE_LEN == sizeof(uint64_t), "Cookie is a single SipHash output");
+
+    uint64_t hash = siphash24(m_key, reinterpret_cast<const uint8_t *>(addr),
+                              is_ipv6 ? sizeof(addr->ip6) : sizeof(addr->ip4));
+    memcpy(cookie, &hash, TCP_TFO_COOKIE_LEN);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef TCP_FASTOPEN_H
+#define TCP_FASTOPEN_H
+
+#include "lwip/tcp.h"
+#include "util/ip_address.h"
+#include "utils/lock_wrapper.h"
+#include <unordered_map>
+
+#ifndef TCP_FASTOPEN
+#define TCP_FASTOPEN 23
+#endif
+
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
+
+#ifndef MSG_FASTOPEN
+#define MSG_FASTOPEN 0x20000000
+#endif
+
+/*
+ * TCP Fast Open (RFC 7413) state shared by all sockets.
+ *
+ * Client side keeps cookies received from servers, so the following connections
+ * to the same destination carry data within SYN. Server side generates cookies
+ * as a keyed hash (SipHash-2-4) of the client address.
+ */
+class tcp_fastopen {
+public:
+    tcp_fastopen();
+
+    bool get_cookie(const ip_address &addr, u8_t *cookie, u8_t &cookie_len, u16_t &mss);
+    void set_cookie(const ip_address &addr, const u8_t *cookie, u8_t cookie_len, u16_t mss);
+    void remove_cookie(const ip_address &addr);
+
+    void gen_cookie(const ip_addr_t *addr, bool is_ipv6, u8_t *cookie) const;
+
+private:
+    // Bounds memory used by the client cache, the whole cache is dropped on overflow
+    static const size_t MAX_CACHED_COOKIES = 4096U;
+
+    struct cached_cookie {
+        u16_t mss;
+        u8_t len;
+        u8_t data[TCP_TFO_COOKIE_MAX];
+    };
+
+    lock_spin m_lock;
+    std::unordered_map<ip_address, cached_cookie> m_cookies;
+    uint64_t m_key[2];
+};
+
+extern tcp_fastopen *g_tcp_fastopen;
+
+#endif /* TCP_FASTOPEN_H */
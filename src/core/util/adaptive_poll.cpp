@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include "adaptive_poll.h"
+#include "util/sys_vars.h"
+
+// Spin while the next arrival is expected within the latency target,
+// spin with sched_yield() up to this factor of the target and sleep beyond it.
+#define ADAPTIVE_POLL_SPIN_MAX_FACTOR  4
+#define ADAPTIVE_POLL_YIELD_MAX_FACTOR 8
+
+adaptive_poll::adaptive_poll()
+{
+    m_target = safe_mce_sys().adaptive_poll_target_usec * get_tsc_rate_per_second() / USEC_PER_SEC;
+}
+
+adaptive_poll_mode_t adaptive_poll::begin_wait()
+{
+    gettimeoftsc(&m_wait_start);
+
+    /* The last wait reacts to the start of a burst immediately,
+     * the average keeps a single short wait of an idle socket from spinning.
+     */
+    tscval_t predicted = std::min(m_wait_avg, m_last_wait);
+
+    if (predicted <= m_target) {
+        m_mode = ADAPTIVE_POLL_SPIN;
+        m_budget = std::min(std::max(m_wait_avg + 2 * m_wait_dev, m_target),
+                            ADAPTIVE_POLL_SPIN_MAX_FACTOR * m_target);
+    } else if (predicted <= ADAPTIVE_POLL_YIELD_MAX_FACTOR * m_target) {
+        m_mode = ADAPTIVE_POLL_YIELD;
+        m_budget = std::min(predicted + m_wait_dev, ADAPTIVE_POLL_YIELD_MAX_FACTOR * m_target);
+    } else {
+        m_mode = ADAPTIVE_POLL_BLOCK;
+        m_budget = 0;
+    }
+
+    return m_mode;
+}
+
+void adaptive_poll::end_wait()
+{
+    if (!m_wait_start) {
+        return;
+    }
+
+    tscval_t now;
+    gettimeoftsc(&now);
+    tscval_t wait = now > m_wait_start ? now - m_wait_start : 0;
+    m_wait_start = 0;
+
+    // Same gains as the TCP RTT estimator: 1/8 for the average and 1/4 for the deviation
+    int64_t diff = static_cast<int64_t>(wait) - static_cast<int64_t>(m_wait_avg);
+    m_wait_avg = static_cast<tscval_t>(static_cast<int64_t>(m_wait_avg) + diff / 8);
+    int64_t dev_diff = std::abs(diff) - static_cast<int64_t>(m_wait_dev);
+    m_wait_dev = static_cast<tscval_t>(static_cast<int64_t>(m_wait_dev) + dev_diff / 4);
+    m_last_wait = wait;
+}
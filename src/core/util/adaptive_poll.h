@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ADAPTIVE_POLL_H
+#define ADAPTIVE_POLL_H
+
+#include <sched.h>
+#include "utils/rdtsc.h"
+
+typedef enum {
+    ADAPTIVE_POLL_SPIN = 0,
+    ADAPTIVE_POLL_YIELD,
+    ADAPTIVE_POLL_BLOCK
+} adaptive_poll_mode_t;
+
+/**
+ * @class adaptive_poll
+ *
+ * Chooses how a blocking call waits for the next arrival (XLIO_ADAPTIVE_POLL):
+ * busy poll, busy poll with sched_yield() or arm the CQ and sleep right away.
+ * The choice is based on the durations of the previous waits, so a socket with
+ * back to back traffic keeps spinning and an idle socket goes to sleep.
+ * The state is a heuristic, concurrent waiters on the same object may race on it.
+ */
+class adaptive_poll {
+public:
+    adaptive_poll();
+
+    // Starts a wait and returns the chosen mode
+    adaptive_poll_mode_t begin_wait();
+    // Ends the wait and learns its duration
+    void end_wait();
+
+    // Whether the caller should poll again instead of going to sleep
+    inline bool keep_polling()
+    {
+        if (m_mode == ADAPTIVE_POLL_BLOCK) {
+            return false;
+        }
+        tscval_t now;
+        gettimeoftsc(&now);
+        if (now - m_wait_start >= m_budget) {
+            return false;
+        }
+        if (m_mode == ADAPTIVE_POLL_YIELD) {
+            sched_yield();
+        }
+        return true;
+    }
+
+    bool is_waiting() const { return m_wait_start != 0; }
+    uint32_t get_budget_usec() const { return ticks_to_usec(m_budget); }
+    uint32_t get_wait_avg_usec() const { return ticks_to_usec(m_wait_avg); }
+
+private:
+    static uint32_t ticks_to_usec(tscval_t ticks)
+    {
+        return static_cast<uint32_t>(ticks * USEC_PER_SEC / get_tsc_rate_per_second());
+    }
+
+    tscval_t m_target; // Latency target in TSC ticks
+    tscval_t m_wait_start = 0;
+    tscval_t m_budget = 0;
+    tscval_t m_last_wait = 0;
+    tscval_t m_wait_avg = 0; // EWMA of the wait duration
+    tscval_t m_wait_dev = 0; // EWMA of the absolute deviation from m_wait_avg
+    adaptive_poll_mode_t m_mode = ADAPTIVE_POLL_SPIN;
+};
+
+#endif /* ADAPTIVE_POLL_H */
@@ -33,26 +33,111 @@
 #ifndef CACHED_OBJ_POOL_H
 #define CACHED_OBJ_POOL_H
 
+#include <atomic>
+#include <mutex>
+#include <new>
 #include <utility>
 #include "dev/allocator.h"
 #include "utils/lock_wrapper.h"
 
-template <typename T> class cached_obj_pool : lock_spin {
+/*
+ * Pool of objects chained through their 'next' member.
+ *
+ * Free objects are kept in a shared depot, a lock-free stack of object batches. The
+ * depot head packs the index of the top batch descriptor with a tag which is incremented
+ * by every update, so a batch popped and pushed back between the load and the CAS of
+ * another thread can't be taken for the unchanged head (ABA). Descriptors live as long
+ * as the pool, which keeps the speculative read of the next index safe.
+ *
+ * Every thread has a front cache of up to 2 * CACHED_OBJ_POOL_BATCH objects per pool,
+ * so small requests touch no shared cache line. Lists of at least a batch go to the
+ * depot as a single batch, and a request larger than the cache pops whole batches.
+ * Only the expansion of the pool takes a lock.
+ *
+ * The statistics are folded in from the front caches when they access the depot or after
+ * a batch of allocations, so they lag by at most a front cache of objects per thread.
+ *
+ * The front caches of a thread are registered on its first use of a pool. The registry
+ * lock keeps a pool alive while an exiting thread flushes its caches, and lets a pool
+ * being destroyed drain the caches of the threads which outlive it.
+ */
+#define CACHED_OBJ_POOL_BATCH     64U
+#define CACHED_OBJ_POOL_MAX_POOLS 8U
+
+template <typename T> class cached_obj_pool {
 public:
     cached_obj_pool(const char *pool_name, size_t alloc_batch, uint32_t &global_obj_pool_size_ref,
                     uint32_t &global_obj_pool_no_objs_ref);
-    ~cached_obj_pool() override;
+    ~cached_obj_pool();
 
     std::pair<T *, T *> get_obj_list(uint32_t amount);
     T *get_objs(uint32_t amount);
     void put_objs(T *obj_list);
+    // Bulk return of a nullptr terminated list of known tail and length, without a walk.
+    void put_obj_list(T *head, T *tail, uint32_t count);
 
-    static T *split_obj_list(uint32_t count, T *&obj_list, uint32_t &total_count);
+    static T *split_obj_list(uint32_t count, T *&obj_list, uint32_t &total_count,
+                             T **tail = nullptr);
 
 protected:
-    bool expand();
+    struct obj_batch {
+        T *head;
+        T *tail;
+        uint32_t count;
+        std::atomic<uint32_t> next;
+    };
+
+    struct obj_cache {
+        uint64_t pool_gen;
+        T *head;
+        T *tail;
+        uint32_t count;
+        uint32_t spare_batch; // Descriptor kept to push without a free stack access
+        int32_t size_delta;
+        uint32_t allocations;
+    };
+
+    struct thread_caches {
+        obj_cache caches[CACHED_OBJ_POOL_MAX_POOLS];
+        thread_caches *prev;
+        thread_caches *next;
+        bool registered;
+        ~thread_caches();
+    };
+
+    static const uint32_t BATCH_NONE = UINT32_MAX;
+    static const uint32_t BATCH_CHUNK_SHIFT = 10U;
+    static const uint32_t BATCH_CHUNK_SIZE = 1U << BATCH_CHUNK_SHIFT;
+    static const uint32_t BATCH_MAX_CHUNKS = 4096U;
 
-    T *m_p_head = nullptr;
+    obj_batch *batch_at(uint32_t idx)
+    {
+        return &m_batch_chunks[idx >> BATCH_CHUNK_SHIFT][idx & (BATCH_CHUNK_SIZE - 1U)];
+    }
+
+    uint32_t stack_pop(std::atomic<uint64_t> &stack);
+    void stack_push(std::atomic<uint64_t> &stack, uint32_t idx);
+
+    obj_cache *get_cache();
+    static void register_caches(thread_caches &caches);
+    void cache_push(obj_cache &cache, T *head, T *tail, uint32_t count);
+    void cache_trim(obj_cache &cache);
+    void cache_flush(obj_cache &cache);
+    void fold_stats(obj_cache &cache);
+    void take_batch(obj_cache &cache, uint32_t idx);
+    bool push_batch(obj_cache &cache, T *head, T *tail, uint32_t count);
+    bool refill(obj_cache &cache);
+    bool expand(obj_cache &cache);
+    uint32_t expand_batches();
+
+    std::atomic<uint64_t> m_depot;
+    char m_depot_pad[64];
+    std::atomic<uint64_t> m_free_batches;
+    char m_free_batches_pad[64];
+    obj_batch *m_batch_chunks[BATCH_MAX_CHUNKS];
+    uint32_t m_batch_chunks_nr;
+
+    lock_spin m_expand_lock;
     xlio_allocator_heap m_allocator;
 
     struct {
@@ -65,25 +150,279 @@ protected:
 
     const size_t m_alloc_batch;
     const char *m_pool_name;
+    const uint64_t m_gen;
+    uint32_t m_slot;
+
+    static std::atomic<cached_obj_pool<T> *> s_pools[CACHED_OBJ_POOL_MAX_POOLS];
+    static std::atomic<uint64_t> s_gen;
+    static thread_local thread_caches t_caches;
+    // Constant initialized, thread exit may run before the dynamic initializers
+    static std::mutex s_caches_lock;
+    static thread_caches *s_caches_list;
 };
 
+template <typename T>
+std::atomic<cached_obj_pool<T> *> cached_obj_pool<T>::s_pools[CACHED_OBJ_POOL_MAX_POOLS];
+template <typename T> std::atomic<uint64_t> cached_obj_pool<T>::s_gen(0U);
+template <typename T>
+thread_local typename cached_obj_pool<T>::thread_caches cached_obj_pool<T>::t_caches;
+template <typename T> std::mutex cached_obj_pool<T>::s_caches_lock;
+template <typename T>
+typename cached_obj_pool<T>::thread_caches *cached_obj_pool<T>::s_caches_list = nullptr;
+
 template <typename T>
 cached_obj_pool<T>::cached_obj_pool(const char *pool_name, size_t alloc_batch,
                                     uint32_t &global_obj_pool_size_ref,
                                     uint32_t &global_obj_pool_no_objs_ref)
-    : m_allocator(false)
+    : m_depot(BATCH_NONE)
+    , m_free_batches(BATCH_NONE)
+    , m_batch_chunks {}
+    , m_batch_chunks_nr(0U)
+    , m_expand_lock("cached_obj_pool")
+    , m_allocator(false)
     , m_stats {0U, 0U, 0U, global_obj_pool_size_ref, global_obj_pool_no_objs_ref}
     , m_alloc_batch(alloc_batch)
     , m_pool_name(pool_name)
+    , m_gen(s_gen.fetch_add(1U) + 1U)
+    , m_slot(CACHED_OBJ_POOL_MAX_POOLS)
 {
-    expand();
+    // Pools beyond the slots of the front caches work directly on the depot.
+    for (uint32_t i = 0; i < CACHED_OBJ_POOL_MAX_POOLS; i++) {
+        cached_obj_pool<T> *expected = nullptr;
+        if (s_pools[i].compare_exchange_strong(expected, this)) {
+            m_slot = i;
+            break;
+        }
+    }
+    if (m_slot == CACHED_OBJ_POOL_MAX_POOLS) {
+        vlog_printf(VLOG_WARNING,
+                    "Cached pool %s has no front cache slot, all %u are taken. "
+                    "Every request goes to the shared depot\n",
+                    m_pool_name, CACHED_OBJ_POOL_MAX_POOLS);
+    }
+
+    obj_cache cache = {m_gen, nullptr, nullptr, 0U, BATCH_NONE, 0, 0U};
+    expand(cache);
+    cache_flush(cache);
 }
 
 template <typename T> cached_obj_pool<T>::~cached_obj_pool()
 {
+    uint32_t stranded = 0U;
+
+    if (m_slot < CACHED_OBJ_POOL_MAX_POOLS) {
+        std::lock_guard<std::mutex> lock(s_caches_lock);
+
+        // Objects cached by the threads which outlive the pool go away with its memory.
+        for (thread_caches *caches = s_caches_list; caches; caches = caches->next) {
+            obj_cache &cache = caches->caches[m_slot];
+            if (cache.pool_gen == m_gen) {
+                stranded += cache.count;
+                fold_stats(cache);
+                cache = {0U, nullptr, nullptr, 0U, BATCH_NONE, 0, 0U};
+            }
+        }
+        s_pools[m_slot].store(nullptr, std::memory_order_release);
+    }
+
     vlog_printf(VLOG_DEBUG, "%s pool statistics:\n", m_pool_name);
-    vlog_printf(VLOG_DEBUG, "  allocations=%u expands=%u total_segs=%u\n", m_stats.allocations,
-                m_stats.expands, m_stats.total_objs);
+    vlog_printf(VLOG_DEBUG, "  allocations=%u expands=%u total_segs=%u stranded=%u\n",
+                m_stats.allocations, m_stats.expands, m_stats.total_objs, stranded);
+
+    for (uint32_t i = 0; i < m_batch_chunks_nr; i++) {
+        delete[] m_batch_chunks[i];
+    }
+}
+
+// Flushes the front caches of an exiting thread to the pools which are still alive.
+template <typename T> cached_obj_pool<T>::thread_caches::~thread_caches()
+{
+    if (!registered) {
+        return;
+    }
+
+    // A pool can't be destroyed before the flush is done
+    std::lock_guard<std::mutex> lock(s_caches_lock);
+
+    for (uint32_t i = 0; i < CACHED_OBJ_POOL_MAX_POOLS; i++) {
+        cached_obj_pool<T> *pool = s_pools[i].load(std::memory_order_acquire);
+        if (pool && caches[i].pool_gen == pool->m_gen) {
+            pool->cache_flush(caches[i]);
+        }
+    }
+
+    if (prev) {
+        prev->next = next;
+    } else {
+        s_caches_list = next;
+    }
+    if (next) {
+        next->prev = prev;
+    }
+    registered = false;
+}
+
+template <typename T> void cached_obj_pool<T>::register_caches(thread_caches &caches)
+{
+    std::lock_guard<std::mutex> lock(s_caches_lock);
+
+    caches.prev = nullptr;
+    caches.next = s_caches_list;
+    if (s_caches_list) {
+        s_caches_list->prev = &caches;
+    }
+    s_caches_list = &caches;
+    caches.registered = true;
+}
+
+template <typename T> uint32_t cached_obj_pool<T>::stack_pop(std::atomic<uint64_t> &stack)
+{
+    uint64_t head = stack.load(std::memory_order_acquire);
+    uint32_t idx;
+
+    do {
+        idx = (uint32_t)head;
+        if (idx == BATCH_NONE) {
+            return BATCH_NONE;
+        }
+        // The descriptor may be popped and reused meanwhile, the tag fails the CAS then.
+        uint64_t next = batch_at(idx)->next.load(std::memory_order_relaxed);
+        if (stack.compare_exchange_weak(head, (((head >> 32) + 1U) << 32) | next,
+                                        std::memory_order_acquire, std::memory_order_acquire)) {
+            return idx;
+        }
+    } while (true);
+}
+
+template <typename T>
+void cached_obj_pool<T>::stack_push(std::atomic<uint64_t> &stack, uint32_t idx)
+{
+    obj_batch *batch = batch_at(idx);
+    uint64_t head = stack.load(std::memory_order_relaxed);
+
+    do {
+        batch->next.store((uint32_t)head, std::memory_order_relaxed);
+    } while (!stack.compare_exchange_weak(head, (((head >> 32) + 1U) << 32) | idx,
+                                          std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <typename T> typename cached_obj_pool<T>::obj_cache *cached_obj_pool<T>::get_cache()
+{
+    if (unlikely(m_slot >= CACHED_OBJ_POOL_MAX_POOLS)) {
+        return nullptr;
+    }
+
+    obj_cache *cache = &t_caches.caches[m_slot];
+    if (unlikely(cache->pool_gen != m_gen)) {
+        if (!t_caches.registered) {
+            register_caches(t_caches);
+        }
+        // Objects left by a destroyed pool of this slot may be gone with its memory.
+        *cache = {m_gen, nullptr, nullptr, 0U, BATCH_NONE, 0, 0U};
+    }
+    return cache;
+}
+
+template <typename T>
+void cached_obj_pool<T>::cache_push(obj_cache &cache, T *head, T *tail, uint32_t count)
+{
+    tail->next = cache.head;
+    cache.head = head;
+    if (!cache.tail) {
+        cache.tail = tail;
+    }
+    cache.count += count;
+}
+
+// Keeps a batch of the most recently used objects and moves the rest to the depot.
+template <typename T> void cached_obj_pool<T>::cache_trim(obj_cache &cache)
+{
+    T *last = cache.head;
+    for (uint32_t i = 1U; i < CACHED_OBJ_POOL_BATCH; i++) {
+        last = last->next;
+    }
+
+    if (push_batch(cache, last->next, cache.tail, cache.count - CACHED_OBJ_POOL_BATCH)) {
+        last->next = nullptr;
+        cache.tail = last;
+        cache.count = CACHED_OBJ_POOL_BATCH;
+    }
+}
+
+template <typename T> void cached_obj_pool<T>::cache_flush(obj_cache &cache)
+{
+    if (cache.count && push_batch(cache, cache.head, cache.tail, cache.count)) {
+        cache.head = cache.tail = nullptr;
+        cache.count = 0U;
+    }
+    if (cache.spare_batch != BATCH_NONE) {
+        stack_push(m_free_batches, cache.spare_batch);
+        cache.spare_batch = BATCH_NONE;
+    }
+    fold_stats(cache);
+}
+
+template <typename T> void cached_obj_pool<T>::fold_stats(obj_cache &cache)
+{
+    if (cache.size_delta) {
+        __atomic_fetch_add(&m_stats.global_obj_pool_size, (uint32_t)cache.size_delta,
+                           __ATOMIC_RELAXED);
+        cache.size_delta = 0;
+    }
+    if (cache.allocations) {
+        __atomic_fetch_add(&m_stats.allocations, cache.allocations, __ATOMIC_RELAXED);
+        cache.allocations = 0U;
+    }
+}
+
+template <typename T> void cached_obj_pool<T>::take_batch(obj_cache &cache, uint32_t idx)
+{
+    obj_batch *batch = batch_at(idx);
+
+    cache_push(cache, batch->head, batch->tail, batch->count);
+    if (cache.spare_batch == BATCH_NONE) {
+        cache.spare_batch = idx;
+    } else {
+        stack_push(m_free_batches, idx);
+    }
+    fold_stats(cache);
+}
+
+template <typename T>
+bool cached_obj_pool<T>::push_batch(obj_cache &cache, T *head, T *tail, uint32_t count)
+{
+    uint32_t idx = cache.spare_batch;
+
+    if (idx != BATCH_NONE) {
+        cache.spare_batch = BATCH_NONE;
+    } else {
+        idx = stack_pop(m_free_batches);
+        if (unlikely(idx == BATCH_NONE)) {
+            idx = expand_batches();
+            if (idx == BATCH_NONE) {
+                return false;
+            }
+        }
+    }
+
+    obj_batch *batch = batch_at(idx);
+    batch->head = head;
+    batch->tail = tail;
+    batch->count = count;
+    stack_push(m_depot, idx);
+    fold_stats(cache);
+    return true;
+}
+
+template <typename T> bool cached_obj_pool<T>::refill(obj_cache &cache)
+{
+    uint32_t idx = stack_pop(m_depot);
+
+    if (unlikely(idx == BATCH_NONE)) {
+        return expand(cache);
+    }
+    take_batch(cache, idx);
+    return true;
 }
 
 template <typename T> T *cached_obj_pool<T>::get_objs(uint32_t amount)
@@ -93,37 +432,45 @@ template <typename T> T *cached_obj_pool<T>::get_objs(uint32_t amount)
 
 template <typename T> std::pair<T *, T *> cached_obj_pool<T>::get_obj_list(uint32_t amount)
 {
-    uint32_t count;
-    T *head, *next, *prev;
+    obj_cache local_cache = {m_gen, nullptr, nullptr, 0U, BATCH_NONE, 0, 0U};
+    T *head, *last = nullptr;
+
     if (unlikely(amount <= 0)) {
         return std::make_pair(nullptr, nullptr);
     }
-    lock();
-repeat:
-    count = amount;
-    head = next = m_p_head;
-    prev = nullptr;
-    while (count > 0 && next) {
-        prev = next;
-        next = next->next;
-        count--;
+
+    obj_cache *cache = get_cache();
+    if (unlikely(!cache)) {
+        cache = &local_cache;
     }
-    if (count) {
-        // Ran out of objects
-        if (expand()) {
-            goto repeat;
+
+    while (cache->count < amount) {
+        if (!refill(*cache)) {
+            // Ran out of objects
+            __atomic_fetch_add(&m_stats.global_obj_pool_no_objs, 1U, __ATOMIC_RELAXED);
+            if (cache == &local_cache) {
+                cache_flush(local_cache);
+            }
+            return std::make_pair(nullptr, nullptr);
         }
-        m_stats.global_obj_pool_no_objs++;
-        unlock();
-        return std::make_pair(nullptr, nullptr);
     }
-    prev->next = nullptr;
-    m_p_head = next;
-    m_stats.allocations++;
-    m_stats.global_obj_pool_size -= amount;
-    unlock();
 
-    return std::make_pair(head, prev);
+    head = split_obj_list(amount, cache->head, cache->count, &last);
+    if (!cache->head) {
+        cache->tail = nullptr;
+    }
+    cache->size_delta -= (int32_t)amount;
+    if (unlikely(++cache->allocations >= CACHED_OBJ_POOL_BATCH)) {
+        fold_stats(*cache);
+    }
+    if (unlikely(cache->count > 2U * CACHED_OBJ_POOL_BATCH)) {
+        cache_trim(*cache);
+    }
+    if (unlikely(cache == &local_cache)) {
+        cache_flush(local_cache);
+    }
+
+    return std::make_pair(head, last);
 }
 
 template <typename T> void cached_obj_pool<T>::put_objs(T *obj_list)
@@ -133,23 +480,45 @@ template <typename T> void cached_obj_pool<T>::put_objs(T *obj_list)
     }
 
     T *next = obj_list;
-    int i;
+    uint32_t i;
     for (i = 1; next->next; i++) {
         next = next->next;
     }
 
-    lock();
-    next->next = m_p_head;
-    m_p_head = obj_list;
-    m_stats.global_obj_pool_size += i;
-    unlock();
+    put_obj_list(obj_list, next, i);
+}
+
+template <typename T> void cached_obj_pool<T>::put_obj_list(T *head, T *tail, uint32_t count)
+{
+    obj_cache local_cache = {m_gen, nullptr, nullptr, 0U, BATCH_NONE, 0, 0U};
+
+    if (unlikely(!head)) {
+        return;
+    }
+
+    obj_cache *cache = get_cache();
+    if (unlikely(!cache)) {
+        cache = &local_cache;
+    }
+
+    cache->size_delta += (int32_t)count;
+    if (count < CACHED_OBJ_POOL_BATCH || !push_batch(*cache, head, tail, count)) {
+        cache_push(*cache, head, tail, count);
+        if (unlikely(cache->count > 2U * CACHED_OBJ_POOL_BATCH)) {
+            cache_trim(*cache);
+        }
+    }
+    if (unlikely(cache == &local_cache)) {
+        cache_flush(local_cache);
+    }
 }
 
 // Splitting obj list such that first 'count' objs are returned and 'obj_list'
-// is updated to point to the remaining objs.
+// is updated to point to the remaining objs. The last returned obj is stored in 'tail'.
 // The length of obj_list is assumed to be at least 'count' long.
 template <typename T>
-T *cached_obj_pool<T>::split_obj_list(uint32_t count, T *&obj_list, uint32_t &total_count)
+T *cached_obj_pool<T>::split_obj_list(uint32_t count, T *&obj_list, uint32_t &total_count,
+                                      T **tail)
 {
     T *head = obj_list;
     T *last = head;
@@ -160,11 +529,53 @@ T *cached_obj_pool<T>::split_obj_list(uint32_t count, T *&obj_list, uint32_t &to
 
     obj_list = last->next;
     last->next = nullptr;
+    if (tail) {
+        *tail = last;
+    }
     return head;
 }
 
-template <typename T> bool cached_obj_pool<T>::expand()
+// Allocates a chunk of batch descriptors, returns one and frees the others.
+template <typename T> uint32_t cached_obj_pool<T>::expand_batches()
+{
+    std::lock_guard<decltype(m_expand_lock)> lock(m_expand_lock);
+
+    // Another thread may have expanded meanwhile.
+    uint32_t idx = stack_pop(m_free_batches);
+    if (idx != BATCH_NONE) {
+        return idx;
+    }
+    if (m_batch_chunks_nr == BATCH_MAX_CHUNKS) {
+        vlog_printf(VLOG_DEBUG, "Cached pool is out of batch descriptors (%s)\n", m_pool_name);
+        return BATCH_NONE;
+    }
+
+    obj_batch *chunk = new (std::nothrow) obj_batch[BATCH_CHUNK_SIZE];
+    if (!chunk) {
+        vlog_printf(VLOG_DEBUG, "Cached pool failed to allocate batches (%s)\n", m_pool_name);
+        return BATCH_NONE;
+    }
+
+    // The chunk is published to other threads by the release of the pushes below.
+    idx = m_batch_chunks_nr << BATCH_CHUNK_SHIFT;
+    m_batch_chunks[m_batch_chunks_nr++] = chunk;
+    for (uint32_t i = 1U; i < BATCH_CHUNK_SIZE; i++) {
+        stack_push(m_free_batches, idx + i);
+    }
+    return idx;
+}
+
+template <typename T> bool cached_obj_pool<T>::expand(obj_cache &cache)
 {
+    std::lock_guard<decltype(m_expand_lock)> lock(m_expand_lock);
+
+    // Another thread may have refilled the depot while we waited.
+    uint32_t idx = stack_pop(m_depot);
+    if (idx != BATCH_NONE) {
+        take_batch(cache, idx);
+        return true;
+    }
+
     size_t size = sizeof(T) * m_alloc_batch;
     T *objs_array = (T *)m_allocator.alloc(size);
     if (!objs_array) {
@@ -180,13 +591,13 @@ template <typename T> bool cached_obj_pool<T>::expand()
         for (size_t i = 0; i < objs_nr - 1; i++) {
             objs_array[i].next = &objs_array[i + 1];
         }
-        objs_array[objs_nr - 1].next = m_p_head;
-        m_p_head = &objs_array[0];
+        objs_array[objs_nr - 1].next = nullptr;
+        cache_push(cache, &objs_array[0], &objs_array[objs_nr - 1], (uint32_t)objs_nr);
         m_stats.total_objs += objs_nr;
         m_stats.expands++;
-        m_stats.global_obj_pool_size += objs_nr;
+        __atomic_fetch_add(&m_stats.global_obj_pool_size, (uint32_t)objs_nr, __ATOMIC_RELAXED);
     }
-    return true;
+    return objs_nr > 0;
 }
 
 #endif
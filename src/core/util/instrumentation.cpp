@@ -32,7 +32,258 @@
 
 #include "config.h"
 #include "instrumentation.h"
+#include "sys_vars.h"
+#include "vlogger/vlogger.h"
+#include "utils/clock.h"
+#include "utils/lock_wrapper.h"
+
+#include <inttypes.h>
+#include <time.h>
+#include <algorithm>
 
 #if defined(DEFINED_PROF)
 atomic_t ibprof_handle::m_current_id = atomic_t {1};
 #endif /* DEFINED_PROF */
+
+bool g_b_lat_stats = false;
+bool g_b_lat_stats_socket = false;
+thread_local lat_tx_ctx_t g_lat_tx_ctx = {0, nullptr};
+
+void lat_stats_init()
+{
+    g_b_lat_stats = safe_mce_sys().stats_latency != option_stats_latency::LAT_STATS_DISABLE;
+    g_b_lat_stats_socket = safe_mce_sys().stats_latency == option_stats_latency::LAT_STATS_SOCKET;
+}
+
+trace_shm_t *g_p_trace_shm = nullptr;
+uint32_t g_trace_gen = 0;
+thread_local trace_thread_t g_trace_thread = {nullptr, nullptr, 0, 0};
+
+void trace_init()
+{
+    g_p_trace_shm = xlio_trace_open(safe_mce_sys().trace_events);
+    g_trace_gen++;
+}
+
+void trace_thread_attach()
+{
+    trace_shm_t *p_trace = g_p_trace_shm;
+
+    g_trace_thread.gen = g_trace_gen;
+    g_trace_thread.hdr = nullptr;
+    if (!p_trace) {
+        return;
+    }
+
+    // Threads above TRACE_MAX_THREADS are not traced, the reader reports their number
+    uint32_t idx = __atomic_fetch_add(&p_trace->n_threads, 1, __ATOMIC_RELAXED);
+    if (idx < TRACE_MAX_THREADS) {
+        g_trace_thread.hdr = &p_trace->rings[idx];
+        g_trace_thread.hdr->tid = gettid();
+        g_trace_thread.events = p_trace->ring_events(idx);
+        g_trace_thread.mask = p_trace->capacity - 1;
+    }
+}
+
+#define LOCK_STATS_FLUSH_BATCH 256 // acquisitions counted per thread before a flush
+#define LOCK_STATS_HOLD_SAMPLE 64 // one of that many acquisitions is timed till release
+
+struct lock_stats_thread_t {
+    uint32_t n_pending;
+    uint32_t n_until_hold_sample;
+    uint32_t n_acquired[NUM_OF_SUPPORTED_LOCKS];
+    uint32_t n_contended[NUM_OF_SUPPORTED_LOCKS];
+
+    // Counters of an exiting thread which did not reach a flush batch
+    ~lock_stats_thread_t();
+};
+
+bool g_b_lock_stats = false;
+/* Published after the block is set up and cleared before the statistics are closed.
+ * The hooks load it with acquire and skip the update once it is gone.
+ */
+static lock_stats_block_t *g_p_lock_stats = nullptr;
+static lock_spin_simple g_lock_stats_names;
+static thread_local lock_stats_thread_t g_lock_stats_thread;
+
+void lock_stats_init()
+{
+    if (!safe_mce_sys().stats_locks) {
+        return;
+    }
+    lock_stats_block_t *p_block = xlio_stats_instance_get_lock_block();
+    p_block->hold_sample_rate = LOCK_STATS_HOLD_SAMPLE;
+    __atomic_store_n(&g_p_lock_stats, p_block, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_b_lock_stats, true, __ATOMIC_RELEASE);
+}
+
+void lock_stats_fini()
+{
+    // New acquisitions stop profiling first, hooks in flight see the block gone
+    __atomic_store_n(&g_b_lock_stats, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_p_lock_stats, nullptr, __ATOMIC_RELEASE);
+}
+
+int lock_stats_get_slot(const char *name)
+{
+    lock_stats_block_t *p_block = __atomic_load_n(&g_p_lock_stats, __ATOMIC_ACQUIRE);
+    int slot = LOCK_STATS_SLOT_NONE;
+
+    if (!p_block) {
+        return slot;
+    }
+    if (!name) {
+        name = "unnamed";
+    }
+
+    g_lock_stats_names.lock();
+    for (uint32_t i = 0; i < p_block->n_locks; i++) {
+        if (strncmp(p_block->locks[i].name, name, LOCK_STATS_NAME_LEN - 1) == 0) {
+            slot = (int)i;
+            break;
+        }
+    }
+    if (slot == LOCK_STATS_SLOT_NONE) {
+        if (p_block->n_locks < NUM_OF_SUPPORTED_LOCKS) {
+            slot = (int)p_block->n_locks;
+            strncpy(p_block->locks[slot].name, name, LOCK_STATS_NAME_LEN - 1);
+            // The reader walks the entries below n_locks, publish the name first
+            __atomic_store_n(&p_block->n_locks, p_block->n_locks + 1, __ATOMIC_RELEASE);
+        } else {
+            p_block->n_names_dropped++;
+        }
+    }
+    if (slot != LOCK_STATS_SLOT_NONE) {
+        __atomic_fetch_add(&p_block->locks[slot].n_instances, 1, __ATOMIC_RELAXED);
+    }
+    g_lock_stats_names.unlock();
+
+    return slot;
+}
+
+static void lock_stats_flush(lock_stats_thread_t &thr, lock_stats_block_t *p_block)
+{
+    for (uint32_t i = 0; i < NUM_OF_SUPPORTED_LOCKS; i++) {
+        if (thr.n_acquired[i]) {
+            lock_stats_t &entry = p_block->locks[i];
+            __atomic_fetch_add(&entry.n_acquired, thr.n_acquired[i], __ATOMIC_RELAXED);
+            __atomic_fetch_add(&entry.n_contended, thr.n_contended[i], __ATOMIC_RELAXED);
+            thr.n_acquired[i] = 0;
+            thr.n_contended[i] = 0;
+        }
+    }
+    thr.n_pending = 0;
+}
+
+lock_stats_thread_t::~lock_stats_thread_t()
+{
+    lock_stats_block_t *p_block = __atomic_load_n(&g_p_lock_stats, __ATOMIC_ACQUIRE);
+
+    if (n_pending && p_block) {
+        lock_stats_flush(*this, p_block);
+    }
+}
+
+bool lock_stats_acquired(int slot, tscval_t wait)
+{
+    lock_stats_block_t *p_block = __atomic_load_n(&g_p_lock_stats, __ATOMIC_ACQUIRE);
+    lock_stats_thread_t &thr = g_lock_stats_thread;
+
+    if (unlikely(!p_block)) {
+        return false;
+    }
+    thr.n_acquired[slot]++;
+    if (wait) {
+        // Contended waits are expensive anyway, update the shared histogram right away
+        thr.n_contended[slot]++;
+        p_block->locks[slot].wait_hist.add_atomic(wait);
+    }
+    if (unlikely(++thr.n_pending >= LOCK_STATS_FLUSH_BATCH)) {
+        lock_stats_flush(thr, p_block);
+    }
+    if (thr.n_until_hold_sample) {
+        thr.n_until_hold_sample--;
+        return false;
+    }
+    thr.n_until_hold_sample = LOCK_STATS_HOLD_SAMPLE - 1;
+    return true;
+}
+
+void lock_stats_released(int slot, tscval_t hold)
+{
+    lock_stats_block_t *p_block = __atomic_load_n(&g_p_lock_stats, __ATOMIC_ACQUIRE);
+
+    if (likely(p_block)) {
+        p_block->locks[slot].hold_hist.add_atomic(hold);
+    }
+}
+
+struct startup_phase_rec_t {
+    const char *name;
+    pid_t tid;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+static startup_phase_rec_t s_startup_phases[STARTUP_PROFILE_MAX_PHASES];
+static int s_startup_phases_num = 0;
+static uint64_t s_startup_base_ns = 0;
+
+static uint64_t startup_now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+startup_phase::startup_phase(const char *name)
+{
+    // Phases may run on helper threads concurrently.
+    m_idx = __atomic_fetch_add(&s_startup_phases_num, 1, __ATOMIC_RELAXED);
+    if (m_idx < STARTUP_PROFILE_MAX_PHASES) {
+        s_startup_phases[m_idx].name = name;
+        s_startup_phases[m_idx].tid = gettid();
+        s_startup_phases[m_idx].end_ns = 0;
+        s_startup_phases[m_idx].start_ns = startup_now_ns();
+    }
+}
+
+startup_phase::~startup_phase()
+{
+    if (m_idx < STARTUP_PROFILE_MAX_PHASES) {
+        s_startup_phases[m_idx].end_ns = startup_now_ns();
+    }
+}
+
+void startup_profile_start()
+{
+    // Support re-initialization after fork().
+    s_startup_phases_num = 0;
+    s_startup_base_ns = startup_now_ns();
+}
+
+void startup_profile_print()
+{
+    vlog_levels_t level = safe_mce_sys().startup_profile ? VLOG_INFO : VLOG_DEBUG;
+    int num = std::min(s_startup_phases_num, STARTUP_PROFILE_MAX_PHASES);
+    uint64_t total_ns = startup_now_ns() - s_startup_base_ns;
+
+    vlog_printf(level, "Startup profile: %d phases in %" PRIu64 " usec\n", num,
+                total_ns / 1000U);
+    vlog_printf(level, "  %-24s %8s %12s %12s\n", "Phase", "Thread", "Start(usec)",
+                "Time(usec)");
+    for (int i = 0; i < num; ++i) {
+        const startup_phase_rec_t &rec = s_startup_phases[i];
+        uint64_t start_us = (rec.start_ns - s_startup_base_ns) / 1000U;
+
+        if (rec.end_ns) {
+            vlog_printf(level, "  %-24s %8d %12" PRIu64 " %12" PRIu64 "\n", rec.name, rec.tid,
+                        start_us, (rec.end_ns - rec.start_ns) / 1000U);
+        } else {
+            // The phase is still running in background.
+            vlog_printf(level, "  %-24s %8d %12" PRIu64 " %12s\n", rec.name, rec.tid, start_us,
+                        "running");
+        }
+    }
+}
@@ -35,6 +35,9 @@
 
 #include <stdint.h>
 #include "utils/atomic.h"
+#include "utils/rdtsc.h"
+#include "core/util/vtypes.h"
+#include "core/util/xlio_stats.h"
 
 #if defined(DEFINED_PROF)
 #include <ibprof_api.h>
@@ -64,4 +67,149 @@ private:
 #define PROFILE_BLOCK(name)
 #endif /* DEFINED_PROF */
 
+/*
+ * Latency histograms (XLIO_STATS_LATENCY).
+ * A measurement starts with a TSC stamp which stays zero while histograms are disabled,
+ * so the disabled cost is a single predictable branch.
+ */
+extern bool g_b_lat_stats;
+extern bool g_b_lat_stats_socket;
+extern global_stats_t *g_p_global_stat;
+
+void lat_stats_init();
+
+static inline tscval_t lat_stats_start()
+{
+    tscval_t tsc = 0;
+    if (unlikely(g_b_lat_stats)) {
+        gettimeoftsc(&tsc);
+    }
+    return tsc;
+}
+
+static inline void lat_stats_record(lat_hist_type_t type, tscval_t start,
+                                    socket_stats_t *p_socket_stats)
+{
+    if (unlikely(start)) {
+        tscval_t now;
+        gettimeoftsc(&now);
+        uint64_t ticks = now > start ? now - start : 0;
+        g_p_global_stat->lat_hist[type].add_atomic(ticks);
+        if (p_socket_stats && g_b_lat_stats_socket) {
+            p_socket_stats->lat_hist[type].add(ticks);
+        }
+    }
+}
+
+/*
+ * Send call to doorbell: the send call opens a scope on the calling thread and the first
+ * doorbell rung by the thread inside the scope closes the measurement.
+ */
+struct lat_tx_ctx_t {
+    tscval_t start;
+    socket_stats_t *p_socket_stats;
+};
+
+extern thread_local lat_tx_ctx_t g_lat_tx_ctx;
+
+class lat_tx_scope {
+public:
+    lat_tx_scope(socket_stats_t *p_socket_stats)
+    {
+        g_lat_tx_ctx.start = lat_stats_start();
+        g_lat_tx_ctx.p_socket_stats = p_socket_stats;
+    }
+    ~lat_tx_scope() { g_lat_tx_ctx.start = 0; }
+};
+
+static inline void lat_stats_doorbell()
+{
+    if (unlikely(g_lat_tx_ctx.start)) {
+        lat_stats_record(LAT_TX_SEND_TO_DOORBELL, g_lat_tx_ctx.start, g_lat_tx_ctx.p_socket_stats);
+        g_lat_tx_ctx.start = 0;
+    }
+}
+
+/*
+ * Hot-path trace rings (XLIO_TRACE_EVENTS).
+ * Every thread attaches to a ring of the trace file on its first event and re-attaches
+ * when the generation changes, i.e. after the trace file is reopened in a forked child.
+ * Events are exported to the Chrome trace format by 'xlio_stats --trace=<file>'.
+ */
+struct trace_thread_t {
+    trace_ring_hdr_t *hdr;
+    trace_event_t *events;
+    uint32_t mask;
+    uint32_t gen;
+};
+
+extern trace_shm_t *g_p_trace_shm;
+extern uint32_t g_trace_gen;
+extern thread_local trace_thread_t g_trace_thread;
+
+void trace_init();
+void trace_thread_attach();
+
+static inline tscval_t trace_start()
+{
+    tscval_t tsc = 0;
+    if (unlikely(g_p_trace_shm)) {
+        gettimeoftsc(&tsc);
+    }
+    return tsc;
+}
+
+static inline void trace_event(trace_event_type_t type, tscval_t start, uint64_t arg)
+{
+    if (unlikely(start)) {
+        if (unlikely(g_trace_thread.gen != g_trace_gen)) {
+            trace_thread_attach();
+        }
+        if (likely(g_trace_thread.hdr)) {
+            tscval_t now;
+            gettimeoftsc(&now);
+            trace_event_t ev;
+            ev.tsc = start;
+            ev.dur = (uint32_t)std::min<uint64_t>(now > start ? now - start : 0, UINT32_MAX);
+            ev.type = (uint16_t)type;
+            ev.arg = (uint16_t)std::min<uint64_t>(arg, UINT16_MAX);
+            trace_ring_push(g_trace_thread.hdr, g_trace_thread.events, g_trace_thread.mask, ev);
+        }
+    }
+}
+
+/*
+ * Lock contention profiler (XLIO_STATS_LOCKS), the lock side lives in utils/lock_wrapper.h.
+ * Enabled once the shared memory statistics are open, locks constructed earlier start
+ * reporting at their next acquisition.
+ */
+void lock_stats_init();
+// Stops the profiler, must be called before the shared memory statistics are closed
+void lock_stats_fini();
+
+/*
+ * Startup timeline (XLIO_STARTUP_PROFILE).
+ * Every initialization phase records its start and end time and the thread it ran on.
+ * The timeline is printed when the library initialization completes.
+ */
+#define STARTUP_PROFILE_MAX_PHASES 32
+
+class startup_phase {
+public:
+    startup_phase(const char *name);
+    ~startup_phase();
+
+private:
+    int m_idx;
+};
+
+#define STARTUP_PHASE(name, ...)                                                                   \
+    do {                                                                                           \
+        startup_phase startup_phase_scope(name);                                                   \
+        __VA_ARGS__;                                                                               \
+    } while (0)
+
+void startup_profile_start();
+void startup_profile_print();
+
 #endif // INSTRUMENTATION
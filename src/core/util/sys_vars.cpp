@@ -324,6 +324,31 @@ static option_t<mode_t> options[] = {{ANON, "Regular pages", {"ANON", "ANONYMOUS
 OPTION_FROM_TO_STR_IMPL
 } // namespace option_alloc_type
 
+namespace option_stats_latency {
+static option_t<mode_t> options[] = {
+    {LAT_STATS_DISABLE, "Disabled", {"disable", "disabled", "off"}},
+    {LAT_STATS_GLOBAL, "Global", {"global", NULL, NULL}},
+    {LAT_STATS_SOCKET, "Global and per socket", {"socket", "per_socket", NULL}}};
+OPTION_FROM_TO_STR_IMPL
+} // namespace option_stats_latency
+
+namespace option_cq_aim_policy {
+static option_t<mode_t> options[] = {{CQ_AIM_RATE, "Interrupts rate", {"rate", NULL, NULL}},
+                                     {CQ_AIM_AIMD, "Latency target AIMD", {"aimd", NULL, NULL}}};
+OPTION_FROM_TO_STR_IMPL
+} // namespace option_cq_aim_policy
+
+#ifdef DEFINED_XDP
+namespace option_xdp {
+static option_t<mode_t> options[] = {
+    {XDP_DISABLE, "Disabled", {"disable", "disabled", "off"}},
+    {XDP_AUTO, "Auto", {"auto", NULL, NULL}},
+    {XDP_NATIVE, "Native", {"native", "drv", NULL}},
+    {XDP_GENERIC, "Generic", {"generic", "skb", NULL}}};
+OPTION_FROM_TO_STR_IMPL
+} // namespace option_xdp
+#endif /* DEFINED_XDP */
+
 int mce_sys_var::list_to_cpuset(char *cpulist, cpu_set_t *cpu_set)
 {
     char comma[] = ",";
@@ -756,13 +781,19 @@ void mce_sys_var::get_env_params()
     service_enable = MCE_DEFAULT_SERVICE_ENABLE;
 
     print_report = MCE_DEFAULT_PRINT_REPORT;
+    startup_profile = MCE_DEFAULT_STARTUP_PROFILE;
+    parallel_init = MCE_DEFAULT_PARALLEL_INIT;
     log_level = VLOG_DEFAULT;
     log_details = MCE_DEFAULT_LOG_DETAILS;
     log_colors = MCE_DEFAULT_LOG_COLORS;
+    log_async = MCE_DEFAULT_LOG_ASYNC;
     handle_sigintr = MCE_DEFAULT_HANDLE_SIGINTR;
     handle_segfault = MCE_DEFAULT_HANDLE_SIGFAULT;
     stats_fd_num_max = MCE_DEFAULT_STATS_FD_NUM;
     stats_fd_num_monitor = MCE_DEFAULT_STATS_FD_NUM;
+    stats_latency = MCE_DEFAULT_STATS_LATENCY;
+    stats_locks = MCE_DEFAULT_STATS_LOCKS;
+    trace_events = MCE_DEFAULT_TRACE_EVENTS;
 
     ring_allocation_logic_tx = MCE_DEFAULT_RING_ALLOCATION_LOGIC_TX;
     ring_allocation_logic_rx = MCE_DEFAULT_RING_ALLOCATION_LOGIC_RX;
@@ -774,15 +805,21 @@ void mce_sys_var::get_env_params()
     tcp_max_syn_rate = MCE_DEFAULT_TCP_MAX_SYN_RATE;
 
     zc_cache_threshold = MCE_DEFAULT_ZC_CACHE_THRESHOLD;
+    zc_cache_window = MCE_DEFAULT_ZC_CACHE_WINDOW;
     tx_num_bufs = MCE_DEFAULT_TX_NUM_BUFS;
     tx_buf_size = MCE_DEFAULT_TX_BUF_SIZE;
     tcp_nodelay_treshold = MCE_DEFAULT_TCP_NODELAY_TRESHOLD;
+    tcp_cork_timeout_msec = MCE_DEFAULT_TCP_CORK_TIMEOUT_MSEC;
+    tcp_ack_segs = MCE_DEFAULT_TCP_ACK_SEGS;
+    tcp_ack_bytes = MCE_DEFAULT_TCP_ACK_BYTES;
+    tcp_ecn = MCE_DEFAULT_TCP_ECN;
     tx_num_wr = MCE_DEFAULT_TX_NUM_WRE;
     tx_num_wr_to_signal = MCE_DEFAULT_TX_NUM_WRE_TO_SIGNAL;
     tx_max_inline = MCE_DEFAULT_TX_MAX_INLINE;
     tx_mc_loopback_default = MCE_DEFAULT_TX_MC_LOOPBACK;
     tx_nonblocked_eagains = MCE_DEFAULT_TX_NONBLOCKED_EAGAINS;
     tx_prefetch_bytes = MCE_DEFAULT_TX_PREFETCH_BYTES;
+    tx_txtime_drop_late_usec = MCE_DEFAULT_TX_TXTIME_DROP_LATE;
     tx_bufs_batch_udp = MCE_DEFAULT_TX_BUFS_BATCH_UDP;
     tx_bufs_batch_tcp = MCE_DEFAULT_TX_BUFS_BATCH_TCP;
     tx_segs_batch_tcp = MCE_DEFAULT_TX_SEGS_BATCH_TCP;
@@ -798,6 +835,8 @@ void mce_sys_var::get_env_params()
     rx_udp_poll_os_ratio = MCE_DEFAULT_RX_UDP_POLL_OS_RATIO;
     hw_ts_conversion_mode = MCE_DEFAULT_HW_TS_CONVERSION_MODE;
     rx_poll_yield_loops = MCE_DEFAULT_RX_POLL_YIELD;
+    adaptive_poll = MCE_DEFAULT_ADAPTIVE_POLL;
+    adaptive_poll_target_usec = MCE_DEFAULT_ADAPTIVE_POLL_TARGET_USEC;
     select_handle_cpu_usage_stats = MCE_DEFAULT_SELECT_CPU_USAGE_STATS;
     rx_ready_byte_min_limit = MCE_DEFAULT_RX_BYTE_MIN_LIMIT;
     rx_prefetch_bytes = MCE_DEFAULT_RX_PREFETCH_BYTES;
@@ -812,9 +851,11 @@ void mce_sys_var::get_env_params()
     strq_strides_compensation_level = MCE_DEFAULT_STRQ_STRIDES_COMPENSATION_LEVEL;
 
     gro_streams_max = MCE_DEFAULT_GRO_STREAMS_MAX;
+    udp_gro = MCE_DEFAULT_UDP_GRO;
     disable_flow_tag = MCE_DEFAULT_DISABLE_FLOW_TAG;
 
     tcp_3t_rules = MCE_DEFAULT_TCP_3T_RULES;
+    tcp_reuseport_sharding = MCE_DEFAULT_TCP_REUSEPORT_SHARDING;
     udp_3t_rules = MCE_DEFAULT_UDP_3T_RULES;
     eth_mc_l2_only_rules = MCE_DEFAULT_ETH_MC_L2_ONLY_RULES;
     mc_force_flowtag = MCE_DEFAULT_MC_FORCE_FLOWTAG;
@@ -823,6 +864,7 @@ void mce_sys_var::get_env_params()
     select_poll_os_force = MCE_DEFAULT_SELECT_POLL_OS_FORCE;
     select_poll_os_ratio = MCE_DEFAULT_SELECT_POLL_OS_RATIO;
     select_skip_os_fd_check = MCE_DEFAULT_SELECT_SKIP_OS;
+    epoll_os_uring = MCE_DEFAULT_EPOLL_OS_URING;
 
     cq_moderation_enable = MCE_DEFAULT_CQ_MODERATION_ENABLE;
     cq_moderation_count = MCE_DEFAULT_CQ_MODERATION_COUNT;
@@ -831,6 +873,8 @@ void mce_sys_var::get_env_params()
     cq_aim_max_period_usec = MCE_DEFAULT_CQ_AIM_MAX_PERIOD_USEC;
     cq_aim_interval_msec = MCE_DEFAULT_CQ_AIM_INTERVAL_MSEC;
     cq_aim_interrupts_rate_per_sec = MCE_DEFAULT_CQ_AIM_INTERRUPTS_RATE_PER_SEC;
+    cq_aim_policy = MCE_DEFAULT_CQ_AIM_POLICY;
+    cq_aim_latency_target_usec = MCE_DEFAULT_CQ_AIM_LATENCY_TARGET_USEC;
 
     cq_poll_batch_max = MCE_DEFAULT_CQ_POLL_BATCH;
     progress_engine_interval_msec = MCE_DEFAULT_PROGRESS_ENGINE_INTERVAL_MSEC;
@@ -848,6 +892,7 @@ void mce_sys_var::get_env_params()
     tcp_ts_opt = MCE_DEFAULT_TCP_TIMESTAMP_OPTION;
     tcp_nodelay = MCE_DEFAULT_TCP_NODELAY;
     tcp_quickack = MCE_DEFAULT_TCP_QUICKACK;
+    tcp_fastopen = MCE_DEFAULT_TCP_FASTOPEN;
     tcp_push_flag = MCE_DEFAULT_TCP_PUSH_FLAG;
     //	exception_handling is handled by its CTOR
     avoid_sys_calls_on_tcp_fd = MCE_DEFAULT_AVOID_SYS_CALLS_ON_TCP_FD;
@@ -859,6 +904,9 @@ void mce_sys_var::get_env_params()
     memory_limit = MCE_DEFAULT_MEMORY_LIMIT;
     memory_limit_user = MCE_DEFAULT_MEMORY_LIMIT_USER;
     heap_metadata_block = MCE_DEFAULT_HEAP_METADATA_BLOCK;
+    memory_block = MCE_DEFAULT_MEMORY_BLOCK;
+    memory_reclaim_high = MCE_DEFAULT_MEMORY_RECLAIM_HIGH;
+    memory_reclaim_low = MCE_DEFAULT_MEMORY_RECLAIM_LOW;
     hugepage_size = MCE_DEFAULT_HUGEPAGE_SIZE;
     enable_socketxtreme = MCE_DEFAULT_SOCKETXTREME;
     enable_tso = MCE_DEFAULT_TSO;
@@ -869,6 +917,11 @@ void mce_sys_var::get_env_params()
     utls_low_wmark_dek_cache_size = MCE_DEFAULT_UTLS_LOW_WMARK_DEK_CACHE_SIZE;
 #endif /* DEFINED_UTLS */
     enable_lro = MCE_DEFAULT_LRO;
+#ifdef DEFINED_XDP
+    xdp_mode = MCE_DEFAULT_XDP;
+    xdp_queue_id = MCE_DEFAULT_XDP_QUEUE;
+    xdp_num_frames = MCE_DEFAULT_XDP_NUM_FRAMES;
+#endif /* DEFINED_XDP */
     handle_fork = MCE_DEFAULT_FORK_SUPPORT;
     handle_bf = MCE_DEFAULT_BF_FLAG;
     close_on_dup2 = MCE_DEFAULT_CLOSE_ON_DUP2;
@@ -1190,6 +1243,14 @@ void mce_sys_var::get_env_params()
         print_report = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_STARTUP_PROFILE))) {
+        startup_profile = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_PARALLEL_INIT))) {
+        parallel_init = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_LOG_FILENAME))) {
         read_env_variable_with_pid(log_filename, sizeof(log_filename), env_ptr);
     }
@@ -1235,6 +1296,13 @@ void mce_sys_var::get_env_params()
         log_colors = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_LOG_ASYNC))) {
+        log_async = std::min((uint32_t)atoi(env_ptr), MAX_LOG_ASYNC);
+        if (log_async) {
+            log_async = align32pow2(log_async);
+        }
+    }
+
     if ((env_ptr = getenv(SYS_VAR_APPLICATION_ID))) {
         read_env_variable_with_pid(app_id, sizeof(app_id), env_ptr);
     }
@@ -1256,6 +1324,21 @@ void mce_sys_var::get_env_params()
         }
     }
 
+    if ((env_ptr = getenv(SYS_VAR_STATS_LATENCY))) {
+        stats_latency = option_stats_latency::from_str(env_ptr, MCE_DEFAULT_STATS_LATENCY);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_STATS_LOCKS))) {
+        stats_locks = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TRACE_EVENTS))) {
+        trace_events = std::min((uint32_t)atoi(env_ptr), MAX_TRACE_EVENTS);
+        if (trace_events) {
+            trace_events = align32pow2(trace_events);
+        }
+    }
+
     read_strq_strides_num();
     read_strq_stride_size_bytes();
 
@@ -1271,6 +1354,14 @@ void mce_sys_var::get_env_params()
         zc_cache_threshold = option_size::from_str(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_ZC_CACHE_WINDOW))) {
+        size_t page_size = (size_t)sysconf(_SC_PAGE_SIZE);
+
+        /* Windows are mapped at their offsets, so they must be page aligned */
+        zc_cache_window = option_size::from_str(env_ptr);
+        zc_cache_window = (zc_cache_window + page_size - 1) & ~(page_size - 1);
+    }
+
     bool tx_num_bufs_set = false;
     if ((env_ptr = getenv(SYS_VAR_TX_NUM_BUFS))) {
         tx_num_bufs = (uint32_t)atoi(env_ptr);
@@ -1285,6 +1376,31 @@ void mce_sys_var::get_env_params()
         tcp_nodelay_treshold = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_CORK_TIMEOUT_MSEC))) {
+        tcp_cork_timeout_msec = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_ACK_SEGS))) {
+        tcp_ack_segs = (uint32_t)atoi(env_ptr);
+        if (tcp_ack_segs == 0) {
+            vlog_printf(VLOG_WARNING, "%s must be positive, using %d\n", SYS_VAR_TCP_ACK_SEGS,
+                        MCE_DEFAULT_TCP_ACK_SEGS);
+            tcp_ack_segs = MCE_DEFAULT_TCP_ACK_SEGS;
+        } else if (tcp_ack_segs > MAX_TCP_ACK_SEGS) {
+            vlog_printf(VLOG_WARNING, "%s is limited to %u\n", SYS_VAR_TCP_ACK_SEGS,
+                        MAX_TCP_ACK_SEGS);
+            tcp_ack_segs = MAX_TCP_ACK_SEGS;
+        }
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_ACK_BYTES))) {
+        tcp_ack_bytes = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_ECN))) {
+        tcp_ecn = (uint32_t)atoi(env_ptr);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TX_NUM_WRE))) {
         tx_num_wr = (uint32_t)atoi(env_ptr);
     }
@@ -1318,6 +1434,10 @@ void mce_sys_var::get_env_params()
         tx_prefetch_bytes = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TX_TXTIME_DROP_LATE))) {
+        tx_txtime_drop_late_usec = (uint32_t)std::max<int32_t>(atoi(env_ptr), 0);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TX_BUFS_BATCH_TCP))) {
         tx_bufs_batch_tcp = (uint32_t)std::max<int32_t>(atoi(env_ptr), 1);
     }
@@ -1460,6 +1580,14 @@ void mce_sys_var::get_env_params()
         rx_poll_yield_loops = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_ADAPTIVE_POLL))) {
+        adaptive_poll = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_ADAPTIVE_POLL_TARGET_USEC))) {
+        adaptive_poll_target_usec = (uint32_t)std::max(atoi(env_ptr), 1);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_SELECT_CPU_USAGE_STATS))) {
         select_handle_cpu_usage_stats = atoi(env_ptr) ? true : false;
     }
@@ -1502,10 +1630,23 @@ void mce_sys_var::get_env_params()
         gro_streams_max = std::max(atoi(env_ptr), 0);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_UDP_GRO))) {
+        udp_gro = atoi(env_ptr) ? true : false;
+    }
+    if (enable_socketxtreme && udp_gro) {
+        udp_gro = false;
+        vlog_printf(VLOG_DEBUG, "%s parameter is forced to %d in case %s is enabled\n",
+                    SYS_VAR_UDP_GRO, udp_gro, SYS_VAR_SOCKETXTREME);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TCP_3T_RULES))) {
         tcp_3t_rules = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_REUSEPORT_SHARDING))) {
+        tcp_reuseport_sharding = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_UDP_3T_RULES))) {
         udp_3t_rules = atoi(env_ptr) ? true : false;
     }
@@ -1555,6 +1696,10 @@ void mce_sys_var::get_env_params()
         select_skip_os_fd_check = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_EPOLL_OS_URING))) {
+        epoll_os_uring = atoi(env_ptr) ? true : false;
+    }
+
 #ifdef DEFINED_IBV_CQ_ATTR_MODERATE
     if ((mce_spec != MCE_SPEC_NVME_BF2) && (rx_poll_num < 0 || select_poll_num < 0)) {
         cq_moderation_enable = false;
@@ -1601,6 +1746,14 @@ void mce_sys_var::get_env_params()
     if ((env_ptr = getenv(SYS_VAR_CQ_AIM_INTERRUPTS_RATE_PER_SEC))) {
         cq_aim_interrupts_rate_per_sec = (uint32_t)atoi(env_ptr);
     }
+
+    if ((env_ptr = getenv(SYS_VAR_CQ_AIM_POLICY))) {
+        cq_aim_policy = option_cq_aim_policy::from_str(env_ptr, MCE_DEFAULT_CQ_AIM_POLICY);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_CQ_AIM_LATENCY_TARGET_USEC))) {
+        cq_aim_latency_target_usec = (uint32_t)atoi(env_ptr);
+    }
 #else
     if ((env_ptr = getenv(SYS_VAR_CQ_MODERATION_ENABLE)) != NULL) {
         vlog_printf(VLOG_WARNING, "'%s' is not supported on this environment\n",
@@ -1630,6 +1783,14 @@ void mce_sys_var::get_env_params()
         vlog_printf(VLOG_WARNING, "'%s' is not supported on this environment\n",
                     SYS_VAR_CQ_AIM_INTERRUPTS_RATE_PER_SEC);
     }
+    if ((env_ptr = getenv(SYS_VAR_CQ_AIM_POLICY)) != NULL) {
+        vlog_printf(VLOG_WARNING, "'%s' is not supported on this environment\n",
+                    SYS_VAR_CQ_AIM_POLICY);
+    }
+    if ((env_ptr = getenv(SYS_VAR_CQ_AIM_LATENCY_TARGET_USEC)) != NULL) {
+        vlog_printf(VLOG_WARNING, "'%s' is not supported on this environment\n",
+                    SYS_VAR_CQ_AIM_LATENCY_TARGET_USEC);
+    }
 #endif /* DEFINED_IBV_CQ_ATTR_MODERATE */
 
     if ((env_ptr = getenv(SYS_VAR_CQ_POLL_BATCH_MAX))) {
@@ -1728,6 +1889,10 @@ void mce_sys_var::get_env_params()
         tcp_quickack = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_FASTOPEN))) {
+        tcp_fastopen = (uint32_t)atoi(env_ptr) & (TCP_FASTOPEN_CLIENT | TCP_FASTOPEN_SERVER);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TCP_PUSH_FLAG))) {
         tcp_push_flag = atoi(env_ptr) ? true : false;
     }
@@ -1867,6 +2032,21 @@ void mce_sys_var::get_env_params()
     if ((env_ptr = getenv(SYS_VAR_HEAP_METADATA_BLOCK))) {
         heap_metadata_block = option_size::from_str(env_ptr) ?: MCE_DEFAULT_HEAP_METADATA_BLOCK;
     }
+    if ((env_ptr = getenv(SYS_VAR_MEMORY_BLOCK))) {
+        memory_block = std::min(option_size::from_str(env_ptr), memory_limit);
+    }
+    if ((env_ptr = getenv(SYS_VAR_MEMORY_RECLAIM_HIGH))) {
+        memory_reclaim_high = option_size::from_str(env_ptr);
+    }
+    if ((env_ptr = getenv(SYS_VAR_MEMORY_RECLAIM_LOW))) {
+        memory_reclaim_low = option_size::from_str(env_ptr);
+    }
+    if (memory_reclaim_low > memory_reclaim_high) {
+        vlog_printf(VLOG_WARNING, "%s is higher than %s, using %s=%zu\n",
+                    SYS_VAR_MEMORY_RECLAIM_LOW, SYS_VAR_MEMORY_RECLAIM_HIGH,
+                    SYS_VAR_MEMORY_RECLAIM_LOW, memory_reclaim_high);
+        memory_reclaim_low = memory_reclaim_high;
+    }
     if ((env_ptr = getenv(SYS_VAR_HUGEPAGE_SIZE))) {
         hugepage_size = option_size::from_str(env_ptr);
         if (hugepage_size & (hugepage_size - 1)) {
@@ -1930,6 +2110,26 @@ void mce_sys_var::get_env_params()
         enable_lro = option_3::from_str(env_ptr, MCE_DEFAULT_LRO);
     }
 
+#ifdef DEFINED_XDP
+    if ((env_ptr = getenv(SYS_VAR_XDP))) {
+        xdp_mode = option_xdp::from_str(env_ptr, MCE_DEFAULT_XDP);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_XDP_QUEUE))) {
+        xdp_queue_id = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_XDP_NUM_FRAMES))) {
+        xdp_num_frames = (uint32_t)atoi(env_ptr);
+        /* AF_XDP rings require power of two sizes and the UMEM is split between Rx and Tx */
+        if (xdp_num_frames < 64 || (xdp_num_frames & (xdp_num_frames - 1))) {
+            vlog_printf(VLOG_WARNING, "%s=%u must be a power of two >= 64, using %d\n",
+                        SYS_VAR_XDP_NUM_FRAMES, xdp_num_frames, MCE_DEFAULT_XDP_NUM_FRAMES);
+            xdp_num_frames = MCE_DEFAULT_XDP_NUM_FRAMES;
+        }
+    }
+#endif /* DEFINED_XDP */
+
     if ((env_ptr = getenv(SYS_VAR_CLOSE_ON_DUP2))) {
         close_on_dup2 = atoi(env_ptr) ? true : false;
     }
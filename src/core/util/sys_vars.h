@@ -164,6 +164,12 @@ typedef enum {
     TCP_TS_OPTION_LAST
 } tcp_ts_opt_t;
 
+// XLIO_TCP_FASTOPEN bits, same as net.ipv4.tcp_fastopen sysctl
+enum {
+    TCP_FASTOPEN_CLIENT = 0x1,
+    TCP_FASTOPEN_SERVER = 0x2,
+};
+
 typedef enum {
     SKIP_POLL_IN_RX_DISABLE = 0,
     SKIP_POLL_IN_RX_ENABLE = 1,
@@ -229,6 +235,35 @@ typedef enum {
 OPTIONS_FROM_TO_STR_DEF;
 } // namespace option_alloc_type
 
+namespace option_stats_latency {
+typedef enum {
+    LAT_STATS_DISABLE = 0,
+    LAT_STATS_GLOBAL, /* Process wide histograms */
+    LAT_STATS_SOCKET, /* Process wide and per socket histograms */
+} mode_t;
+OPTIONS_FROM_TO_STR_DEF;
+} // namespace option_stats_latency
+
+namespace option_cq_aim_policy {
+typedef enum {
+    CQ_AIM_RATE = 0, /* Target the interrupts rate */
+    CQ_AIM_AIMD, /* Bound the completion delay, adapt the count with AIMD */
+} mode_t;
+OPTIONS_FROM_TO_STR_DEF;
+} // namespace option_cq_aim_policy
+
+#ifdef DEFINED_XDP
+namespace option_xdp {
+typedef enum {
+    XDP_DISABLE = 0,
+    XDP_AUTO, /* Try driver (native) mode and fall back to generic (skb) mode */
+    XDP_NATIVE,
+    XDP_GENERIC,
+} mode_t;
+OPTIONS_FROM_TO_STR_DEF;
+} // namespace option_xdp
+#endif /* DEFINED_XDP */
+
 typedef enum {
     ALLOC_TYPE_ANON = option_alloc_type::ANON,
     ALLOC_TYPE_HUGEPAGES = option_alloc_type::HUGE,
@@ -347,6 +382,8 @@ public:
     uint32_t mce_spec;
 
     bool print_report;
+    bool startup_profile;
+    bool parallel_init;
     vlog_levels_t log_level;
     uint32_t log_details;
     char log_filename[PATH_MAX];
@@ -356,10 +393,14 @@ public:
     char service_notify_dir[PATH_MAX];
     bool service_enable;
     bool log_colors;
+    uint32_t log_async;
     bool handle_sigintr;
     bool handle_segfault;
     uint32_t stats_fd_num_max;
     uint32_t stats_fd_num_monitor;
+    option_stats_latency::mode_t stats_latency;
+    bool stats_locks;
+    uint32_t trace_events;
 
     ring_logic_t ring_allocation_logic_tx;
     ring_logic_t ring_allocation_logic_rx;
@@ -370,15 +411,21 @@ public:
     int tcp_max_syn_rate;
 
     size_t zc_cache_threshold;
+    size_t zc_cache_window;
     uint32_t tx_num_bufs;
     uint32_t tx_buf_size;
     uint32_t tcp_nodelay_treshold;
+    uint32_t tcp_cork_timeout_msec;
+    uint32_t tcp_ack_segs;
+    uint32_t tcp_ack_bytes;
+    uint32_t tcp_ecn;
     uint32_t tx_num_wr;
     uint32_t tx_num_wr_to_signal;
     uint32_t tx_max_inline;
     bool tx_mc_loopback_default;
     bool tx_nonblocked_eagains;
     uint32_t tx_prefetch_bytes;
+    uint32_t tx_txtime_drop_late_usec;
     uint32_t tx_bufs_batch_udp;
     uint32_t tx_bufs_batch_tcp;
     uint32_t tx_segs_batch_tcp;
@@ -393,6 +440,8 @@ public:
     uint32_t rx_udp_poll_os_ratio;
     ts_conversion_mode_t hw_ts_conversion_mode;
     uint32_t rx_poll_yield_loops;
+    bool adaptive_poll;
+    uint32_t adaptive_poll_target_usec;
     uint32_t rx_ready_byte_min_limit;
     uint32_t rx_prefetch_bytes;
     uint32_t rx_prefetch_bytes_before_poll;
@@ -407,10 +456,12 @@ public:
     uint32_t strq_strides_compensation_level;
 
     uint32_t gro_streams_max;
+    bool udp_gro;
     bool disable_flow_tag;
 
     bool enable_striding_rq;
     bool tcp_3t_rules;
+    bool tcp_reuseport_sharding;
     bool udp_3t_rules;
     bool eth_mc_l2_only_rules;
     bool mc_force_flowtag;
@@ -419,6 +470,7 @@ public:
     bool select_poll_os_force;
     uint32_t select_poll_os_ratio;
     uint32_t select_skip_os_fd_check;
+    bool epoll_os_uring;
     bool select_handle_cpu_usage_stats;
 
     bool cq_moderation_enable;
@@ -428,6 +480,8 @@ public:
     uint32_t cq_aim_max_period_usec;
     uint32_t cq_aim_interval_msec;
     uint32_t cq_aim_interrupts_rate_per_sec;
+    option_cq_aim_policy::mode_t cq_aim_policy;
+    uint32_t cq_aim_latency_target_usec;
 
     uint32_t cq_poll_batch_max;
     uint32_t progress_engine_interval_msec;
@@ -444,6 +498,7 @@ public:
     tcp_ts_opt_t tcp_ts_opt;
     bool tcp_nodelay;
     bool tcp_quickack;
+    uint32_t tcp_fastopen;
     bool tcp_push_flag;
     xlio_exception_handling exception_handling;
     bool avoid_sys_calls_on_tcp_fd;
@@ -455,6 +510,9 @@ public:
     size_t memory_limit;
     size_t memory_limit_user;
     size_t heap_metadata_block;
+    size_t memory_block;
+    size_t memory_reclaim_high;
+    size_t memory_reclaim_low;
     size_t hugepage_size;
     bool handle_fork;
     bool close_on_dup2;
@@ -472,6 +530,11 @@ public:
     bool enable_socketxtreme;
     option_3::mode_t enable_tso;
     option_3::mode_t enable_lro;
+#ifdef DEFINED_XDP
+    option_xdp::mode_t xdp_mode;
+    uint32_t xdp_queue_id;
+    uint32_t xdp_num_frames;
+#endif /* DEFINED_XDP */
     option_3::mode_t enable_strq_env;
 #ifdef DEFINED_UTLS
     bool enable_utls_rx;
@@ -554,6 +617,8 @@ extern mce_sys_var &safe_mce_sys();
  * environment variables
  */
 #define SYS_VAR_PRINT_REPORT        "XLIO_PRINT_REPORT"
+#define SYS_VAR_STARTUP_PROFILE     "XLIO_STARTUP_PROFILE"
+#define SYS_VAR_PARALLEL_INIT       "XLIO_PARALLEL_INIT"
 #define SYS_VAR_LOG_LEVEL           "XLIO_TRACELEVEL"
 #define SYS_VAR_LOG_DETAILS         "XLIO_LOG_DETAILS"
 #define SYS_VAR_LOG_FILENAME        "XLIO_LOG_FILE"
@@ -563,10 +628,14 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_SERVICE_ENABLE      "XLIO_SERVICE_ENABLE"
 #define SYS_VAR_CONF_FILENAME       "XLIO_CONFIG_FILE"
 #define SYS_VAR_LOG_COLORS          "XLIO_LOG_COLORS"
+#define SYS_VAR_LOG_ASYNC           "XLIO_LOG_ASYNC"
 #define SYS_VAR_APPLICATION_ID      "XLIO_APPLICATION_ID"
 #define SYS_VAR_HANDLE_SIGINTR      "XLIO_HANDLE_SIGINTR"
 #define SYS_VAR_HANDLE_SIGSEGV      "XLIO_HANDLE_SIGSEGV"
 #define SYS_VAR_STATS_FD_NUM        "XLIO_STATS_FD_NUM"
+#define SYS_VAR_STATS_LATENCY       "XLIO_STATS_LATENCY"
+#define SYS_VAR_STATS_LOCKS         "XLIO_STATS_LOCKS"
+#define SYS_VAR_TRACE_EVENTS        "XLIO_TRACE_EVENTS"
 
 #define SYS_VAR_RING_ALLOCATION_LOGIC_TX "XLIO_RING_ALLOCATION_LOGIC_TX"
 #define SYS_VAR_RING_ALLOCATION_LOGIC_RX "XLIO_RING_ALLOCATION_LOGIC_RX"
@@ -576,15 +645,21 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RING_DEV_MEM_TX          "XLIO_RING_DEV_MEM_TX"
 
 #define SYS_VAR_ZC_CACHE_THRESHOLD    "XLIO_ZC_CACHE_THRESHOLD"
+#define SYS_VAR_ZC_CACHE_WINDOW       "XLIO_ZC_CACHE_WINDOW"
 #define SYS_VAR_TX_NUM_BUFS           "XLIO_TX_BUFS"
 #define SYS_VAR_TX_BUF_SIZE           "XLIO_TX_BUF_SIZE"
 #define SYS_VAR_TCP_NODELAY_TRESHOLD  "XLIO_TCP_NODELAY_TRESHOLD"
+#define SYS_VAR_TCP_CORK_TIMEOUT_MSEC "XLIO_TCP_CORK_TIMEOUT_MSEC"
+#define SYS_VAR_TCP_ACK_SEGS          "XLIO_TCP_ACK_SEGS"
+#define SYS_VAR_TCP_ACK_BYTES         "XLIO_TCP_ACK_BYTES"
+#define SYS_VAR_TCP_ECN               "XLIO_TCP_ECN"
 #define SYS_VAR_TX_NUM_WRE            "XLIO_TX_WRE"
 #define SYS_VAR_TX_NUM_WRE_TO_SIGNAL  "XLIO_TX_WRE_BATCHING"
 #define SYS_VAR_TX_MAX_INLINE         "XLIO_TX_MAX_INLINE"
 #define SYS_VAR_TX_MC_LOOPBACK        "XLIO_TX_MC_LOOPBACK"
 #define SYS_VAR_TX_NONBLOCKED_EAGAINS "XLIO_TX_NONBLOCKED_EAGAINS"
 #define SYS_VAR_TX_PREFETCH_BYTES     "XLIO_TX_PREFETCH_BYTES"
+#define SYS_VAR_TX_TXTIME_DROP_LATE   "XLIO_TX_TXTIME_DROP_LATE_USEC"
 #define SYS_VAR_TX_BUFS_BATCH_TCP     "XLIO_TX_BUFS_BATCH_TCP"
 #define SYS_VAR_TX_SEGS_BATCH_TCP     "XLIO_TX_SEGS_BATCH_TCP"
 
@@ -606,13 +681,17 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RX_POLL_OS_RATIO              "XLIO_RX_POLL_OS_RATIO"
 #define SYS_VAR_RX_SKIP_OS                    "XLIO_RX_SKIP_OS"
 #define SYS_VAR_RX_POLL_YIELD                 "XLIO_RX_POLL_YIELD"
+#define SYS_VAR_ADAPTIVE_POLL                 "XLIO_ADAPTIVE_POLL"
+#define SYS_VAR_ADAPTIVE_POLL_TARGET_USEC     "XLIO_ADAPTIVE_POLL_TARGET_USEC"
 #define SYS_VAR_RX_BYTE_MIN_LIMIT             "XLIO_RX_BYTES_MIN"
 #define SYS_VAR_RX_PREFETCH_BYTES             "XLIO_RX_PREFETCH_BYTES"
 #define SYS_VAR_RX_PREFETCH_BYTES_BEFORE_POLL "XLIO_RX_PREFETCH_BYTES_BEFORE_POLL"
 #define SYS_VAR_RX_CQ_DRAIN_RATE_NSEC         "XLIO_RX_CQ_DRAIN_RATE_NSEC"
 #define SYS_VAR_GRO_STREAMS_MAX               "XLIO_GRO_STREAMS_MAX"
+#define SYS_VAR_UDP_GRO                       "XLIO_UDP_GRO"
 #define SYS_VAR_DISABLE_FLOW_TAG              "XLIO_DISABLE_FLOW_TAG"
 #define SYS_VAR_TCP_3T_RULES                  "XLIO_TCP_3T_RULES"
+#define SYS_VAR_TCP_REUSEPORT_SHARDING        "XLIO_TCP_REUSEPORT_SHARDING"
 #define SYS_VAR_UDP_3T_RULES                  "XLIO_UDP_3T_RULES"
 #define SYS_VAR_ETH_MC_L2_ONLY_RULES          "XLIO_ETH_MC_L2_ONLY_RULES"
 #define SYS_VAR_MC_FORCE_FLOWTAG              "XLIO_MC_FORCE_FLOWTAG"
@@ -624,6 +703,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_SELECT_POLL_OS_FORCE   "XLIO_SELECT_POLL_OS_FORCE"
 #define SYS_VAR_SELECT_POLL_OS_RATIO   "XLIO_SELECT_POLL_OS_RATIO"
 #define SYS_VAR_SELECT_SKIP_OS         "XLIO_SELECT_SKIP_OS"
+#define SYS_VAR_EPOLL_OS_URING         "XLIO_EPOLL_OS_URING"
 
 #define SYS_VAR_CQ_MODERATION_ENABLE           "XLIO_CQ_MODERATION_ENABLE"
 #define SYS_VAR_CQ_MODERATION_COUNT            "XLIO_CQ_MODERATION_COUNT"
@@ -632,6 +712,8 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_CQ_AIM_MAX_PERIOD_USEC         "XLIO_CQ_AIM_MAX_PERIOD_USEC"
 #define SYS_VAR_CQ_AIM_INTERVAL_MSEC           "XLIO_CQ_AIM_INTERVAL_MSEC"
 #define SYS_VAR_CQ_AIM_INTERRUPTS_RATE_PER_SEC "XLIO_CQ_AIM_INTERRUPTS_RATE_PER_SEC"
+#define SYS_VAR_CQ_AIM_POLICY                  "XLIO_CQ_AIM_POLICY"
+#define SYS_VAR_CQ_AIM_LATENCY_TARGET_USEC     "XLIO_CQ_AIM_LATENCY_TARGET_USEC"
 
 #define SYS_VAR_CQ_POLL_BATCH_MAX         "XLIO_CQ_POLL_BATCH_MAX"
 #define SYS_VAR_PROGRESS_ENGINE_INTERVAL  "XLIO_PROGRESS_ENGINE_INTERVAL"
@@ -647,6 +729,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_TCP_TIMESTAMP_OPTION      "XLIO_TCP_TIMESTAMP_OPTION"
 #define SYS_VAR_TCP_NODELAY               "XLIO_TCP_NODELAY"
 #define SYS_VAR_TCP_QUICKACK              "XLIO_TCP_QUICKACK"
+#define SYS_VAR_TCP_FASTOPEN              "XLIO_TCP_FASTOPEN"
 #define SYS_VAR_TCP_PUSH_FLAG             "XLIO_TCP_PUSH_FLAG"
 #define SYS_VAR_AVOID_SYS_CALLS_ON_TCP_FD "XLIO_AVOID_SYS_CALLS_ON_TCP_FD"
 #define SYS_VAR_ALLOW_PRIVILEGED_SOCK_OPT "XLIO_ALLOW_PRIVILEGED_SOCK_OPT"
@@ -657,6 +740,9 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_MEMORY_LIMIT              "XLIO_MEMORY_LIMIT"
 #define SYS_VAR_MEMORY_LIMIT_USER         "XLIO_MEMORY_LIMIT_USER"
 #define SYS_VAR_HEAP_METADATA_BLOCK       "XLIO_HEAP_METADATA_BLOCK"
+#define SYS_VAR_MEMORY_BLOCK              "XLIO_MEMORY_BLOCK"
+#define SYS_VAR_MEMORY_RECLAIM_HIGH       "XLIO_MEMORY_RECLAIM_HIGH"
+#define SYS_VAR_MEMORY_RECLAIM_LOW        "XLIO_MEMORY_RECLAIM_LOW"
 #define SYS_VAR_HUGEPAGE_SIZE             "XLIO_HUGEPAGE_SIZE"
 #define SYS_VAR_FORK                      "XLIO_FORK"
 #define SYS_VAR_BF                        "XLIO_BF"
@@ -690,6 +776,12 @@ extern mce_sys_var &safe_mce_sys();
 
 #define SYS_VAR_LRO "XLIO_LRO"
 
+#ifdef DEFINED_XDP
+#define SYS_VAR_XDP            "XLIO_XDP"
+#define SYS_VAR_XDP_QUEUE      "XLIO_XDP_QUEUE"
+#define SYS_VAR_XDP_NUM_FRAMES "XLIO_XDP_NUM_FRAMES"
+#endif /* DEFINED_XDP */
+
 #define SYS_VAR_INTERNAL_THREAD_AFFINITY "XLIO_INTERNAL_THREAD_AFFINITY"
 #define SYS_VAR_INTERNAL_THREAD_CPUSET   "XLIO_INTERNAL_THREAD_CPUSET"
 #define SYS_VAR_INTERNAL_THREAD_ARM_CQ   "XLIO_INTERNAL_THREAD_ARM_CQ"
@@ -714,6 +806,8 @@ extern mce_sys_var &safe_mce_sys();
  * configuration variables
  */
 #define MCE_DEFAULT_PRINT_REPORT             (false)
+#define MCE_DEFAULT_STARTUP_PROFILE          (false)
+#define MCE_DEFAULT_PARALLEL_INIT            (true)
 #define MCE_DEFAULT_TCP_SEND_BUFFER_SIZE     (1024 * 1024)
 #define MCE_DEFAULT_LOG_FILE                 ("")
 #define MCE_DEFAULT_CONF_FILE                ("/etc/libxlio.conf")
@@ -723,10 +817,14 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_SERVICE_ENABLE           (false)
 #define MCE_DEFAULT_LOG_DETAILS              (0)
 #define MCE_DEFAULT_LOG_COLORS               (true)
+#define MCE_DEFAULT_LOG_ASYNC                (0)
 #define MCE_DEFAULT_APP_ID                   ("XLIO_DEFAULT_APPLICATION_ID")
 #define MCE_DEFAULT_HANDLE_SIGINTR           (true)
 #define MCE_DEFAULT_HANDLE_SIGFAULT          (false)
 #define MCE_DEFAULT_STATS_FD_NUM             0
+#define MCE_DEFAULT_STATS_LATENCY            (option_stats_latency::LAT_STATS_DISABLE)
+#define MCE_DEFAULT_STATS_LOCKS              (false)
+#define MCE_DEFAULT_TRACE_EVENTS             (0)
 #define MCE_DEFAULT_RING_ALLOCATION_LOGIC_TX (RING_LOGIC_PER_INTERFACE)
 #define MCE_DEFAULT_RING_ALLOCATION_LOGIC_RX (RING_LOGIC_PER_INTERFACE)
 #define MCE_DEFAULT_RING_MIGRATION_RATIO_TX  (-1)
@@ -735,7 +833,12 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_RING_DEV_MEM_TX          (0)
 #define MCE_DEFAULT_TCP_MAX_SYN_RATE         (0)
 #define MCE_DEFAULT_TCP_NODELAY_TRESHOLD     (0)
+#define MCE_DEFAULT_TCP_CORK_TIMEOUT_MSEC    (200)
+#define MCE_DEFAULT_TCP_ACK_SEGS             (2)
+#define MCE_DEFAULT_TCP_ACK_BYTES            (0)
+#define MCE_DEFAULT_TCP_ECN                  (0)
 #define MCE_DEFAULT_ZC_CACHE_THRESHOLD       (10LU * 1024 * 1024 * 1024) // 10GB
+#define MCE_DEFAULT_ZC_CACHE_WINDOW          (0) // Whole file
 #define MCE_DEFAULT_TX_NUM_BUFS              (200000)
 #define MCE_DEFAULT_TX_BUF_SIZE              (0)
 #define MCE_DEFAULT_TX_NUM_WRE               (32768)
@@ -745,6 +848,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TX_MC_LOOPBACK           (true)
 #define MCE_DEFAULT_TX_NONBLOCKED_EAGAINS    (false)
 #define MCE_DEFAULT_TX_PREFETCH_BYTES        (256)
+#define MCE_DEFAULT_TX_TXTIME_DROP_LATE      (0)
 #define MCE_DEFAULT_TX_BUFS_BATCH_UDP        (8)
 #define MCE_DEFAULT_TX_BUFS_BATCH_TCP        (16)
 #define MCE_DEFAULT_TX_SEGS_BATCH_TCP        (64)
@@ -773,13 +877,17 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_RX_UDP_POLL_OS_RATIO          (100)
 #define MCE_DEFAULT_HW_TS_CONVERSION_MODE         (TS_CONVERSION_MODE_SYNC)
 #define MCE_DEFAULT_RX_POLL_YIELD                 (0)
+#define MCE_DEFAULT_ADAPTIVE_POLL                 (false)
+#define MCE_DEFAULT_ADAPTIVE_POLL_TARGET_USEC     (50)
 #define MCE_DEFAULT_RX_BYTE_MIN_LIMIT             (65536)
 #define MCE_DEFAULT_RX_PREFETCH_BYTES             (256)
 #define MCE_DEFAULT_RX_PREFETCH_BYTES_BEFORE_POLL (0)
 #define MCE_DEFAULT_RX_CQ_DRAIN_RATE              (MCE_RX_CQ_DRAIN_RATE_DISABLED)
 #define MCE_DEFAULT_GRO_STREAMS_MAX               (32)
+#define MCE_DEFAULT_UDP_GRO                       (false)
 #define MCE_DEFAULT_DISABLE_FLOW_TAG              (false)
 #define MCE_DEFAULT_TCP_3T_RULES                  (false)
+#define MCE_DEFAULT_TCP_REUSEPORT_SHARDING        (true)
 #define MCE_DEFAULT_UDP_3T_RULES                  (true)
 #define MCE_DEFAULT_ETH_MC_L2_ONLY_RULES          (false)
 #define MCE_DEFAULT_MC_FORCE_FLOWTAG              (false)
@@ -787,6 +895,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_SELECT_POLL_OS_FORCE          (0)
 #define MCE_DEFAULT_SELECT_POLL_OS_RATIO          (10)
 #define MCE_DEFAULT_SELECT_SKIP_OS                (4)
+#define MCE_DEFAULT_EPOLL_OS_URING                (false)
 #define MCE_DEFAULT_SELECT_CPU_USAGE_STATS        (false)
 #ifdef DEFINED_IBV_CQ_ATTR_MODERATE
 #define MCE_DEFAULT_CQ_MODERATION_ENABLE (true)
@@ -799,6 +908,8 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_CQ_AIM_MAX_PERIOD_USEC         (250)
 #define MCE_DEFAULT_CQ_AIM_INTERVAL_MSEC           (250)
 #define MCE_DEFAULT_CQ_AIM_INTERRUPTS_RATE_PER_SEC (5000)
+#define MCE_DEFAULT_CQ_AIM_POLICY                  (option_cq_aim_policy::CQ_AIM_RATE)
+#define MCE_DEFAULT_CQ_AIM_LATENCY_TARGET_USEC     (50)
 #define MCE_DEFAULT_CQ_POLL_BATCH                  (16)
 #define MCE_DEFAULT_PROGRESS_ENGINE_INTERVAL_MSEC  (10)
 #define MCE_DEFAULT_PROGRESS_ENGINE_WCE_MAX        (10000)
@@ -814,6 +925,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TCP_TIMESTAMP_OPTION           (TCP_TS_OPTION_DISABLE)
 #define MCE_DEFAULT_TCP_NODELAY                    (false)
 #define MCE_DEFAULT_TCP_QUICKACK                   (false)
+#define MCE_DEFAULT_TCP_FASTOPEN                   (TCP_FASTOPEN_CLIENT)
 #define MCE_DEFAULT_TCP_PUSH_FLAG                  (true)
 #define MCE_DEFAULT_AVOID_SYS_CALLS_ON_TCP_FD      (false)
 #define MCE_DEFAULT_ALLOW_PRIVILEGED_SOCK_OPT      (true)
@@ -824,6 +936,9 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_MEMORY_LIMIT                   (2LU * 1024 * 1024 * 1024)
 #define MCE_DEFAULT_MEMORY_LIMIT_USER              (0)
 #define MCE_DEFAULT_HEAP_METADATA_BLOCK            (32LU * 1024 * 1024)
+#define MCE_DEFAULT_MEMORY_BLOCK                   (0)
+#define MCE_DEFAULT_MEMORY_RECLAIM_HIGH            (0)
+#define MCE_DEFAULT_MEMORY_RECLAIM_LOW             (0)
 #define MCE_DEFAULT_HUGEPAGE_SIZE                  (0)
 #define MCE_MAX_HUGEPAGE_SIZE                      (1ULL << 63ULL)
 #define MCE_DEFAULT_FORK_SUPPORT                   (true)
@@ -872,6 +987,11 @@ extern mce_sys_var &safe_mce_sys();
 #endif /* DEFINED_UTLS */
 
 #define MCE_DEFAULT_LRO                            (option_3::AUTO)
+#ifdef DEFINED_XDP
+#define MCE_DEFAULT_XDP            (option_xdp::XDP_DISABLE)
+#define MCE_DEFAULT_XDP_QUEUE      (0)
+#define MCE_DEFAULT_XDP_NUM_FRAMES (4096)
+#endif /* DEFINED_XDP */
 #define MCE_DEFAULT_DEFERRED_CLOSE                 (false)
 #define MCE_DEFAULT_TCP_ABORT_ON_CLOSE             (false)
 #define MCE_DEFAULT_RX_POLL_ON_TX_TCP              (false)
@@ -919,6 +1039,9 @@ extern mce_sys_var &safe_mce_sys();
 #define NETVSC_ID                "{f8615163-df3e-46c5-913f-f2d2f965ed0e}\n"
 
 #define MAX_STATS_FD_NUM   1024U
+#define MAX_TRACE_EVENTS   (1U << 20)
+#define MAX_LOG_ASYNC      (1U << 20)
+#define MAX_TCP_ACK_SEGS   256U
 #define MAX_WINDOW_SCALING 14
 
 #define STRQ_MIN_STRIDES_NUM       512
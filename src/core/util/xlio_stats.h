@@ -46,6 +46,7 @@
 #include <core/util/sock_addr.h>
 #include <assert.h>
 #include <atomic>
+#include <algorithm>
 
 #define NUM_OF_SUPPORTED_CQS         16
 #define NUM_OF_SUPPORTED_RINGS       16
@@ -61,6 +62,8 @@
     STATS_PUBLISHER_TIMER_PERIOD + 5 // reader will wait for xlio to wakeup and write statistics to
                                      // shmem (with extra 5 msec overhead)
 #define STATS_FD_STATISTICS_LOG_LEVEL_DEFAULT VLOG_DEFAULT
+#define STATS_CACHE_LINE_SIZE                 64
+#define STATS_SEQ_READ_RETRIES                1000 // Before a sample is given up
 
 // statistic file
 extern FILE *g_stats_file;
@@ -82,6 +85,9 @@ typedef struct {
     uint32_t n_iomux_rx_ready;
     uint32_t n_iomux_os_rx_ready;
     uint32_t n_iomux_polling_time;
+    uint32_t n_iomux_adaptive_spin;
+    uint32_t n_iomux_adaptive_yield;
+    uint32_t n_iomux_adaptive_block;
 } iomux_func_stats_t;
 
 typedef enum { e_totals = 1, e_deltas } print_details_mode_t;
@@ -106,24 +112,181 @@ struct user_params_t {
     vlog_levels_t fd_dump_log_level;
     std::string xlio_stats_path;
     std::ofstream csv_stream;
+    std::string trace_file;
+    int lock_top_n;
 };
 
 extern user_params_t user_params;
 
+/*
+ * Statistics blocks live in the shared memory and are updated in place by their owners.
+ * Every instance block carries a sequence number which the publisher makes odd while
+ * the block is being (re)initialized or released. The reader copies a block and retries
+ * if the sequence was odd or has changed meanwhile, so a snapshot never contains a half
+ * reset block.
+ *
+ * The sequence does not cover counter updates, they are plain stores on the data path.
+ * The counters of a socket, ring, CQ or buffer pool block are written by the thread
+ * which holds the lock of that object. Global counters which any thread updates on its
+ * hot path are split into per thread slots (global_thread_stats_t) updated with relaxed
+ * atomics and summed by the reader with global_stats_t::aggregate(). The other global
+ * counters are updated atomically or under the lock of their pool or cache. A counter
+ * read outside the sequence may miss the latest updates, but an aligned counter is
+ * never torn.
+ *
+ * Every block ends with a cache line of padding, so counters of neighbouring blocks
+ * which are updated from different threads do not share a cache line.
+ */
+static inline void stats_seq_write_begin(uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void stats_seq_write_end(uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Returns false if a block was still being written after STATS_SEQ_READ_RETRIES attempts.
+ * The copy of such block is torn, so the caller has to skip the sample.
+ */
+template <typename T> static inline bool stats_seq_read(T *dst, const T *src, size_t count)
+{
+    bool consistent = true;
+
+    for (size_t i = 0; i < count; i++) {
+        int retry;
+        for (retry = 0; retry < STATS_SEQ_READ_RETRIES; retry++) {
+            uint32_t seq = __atomic_load_n(&src[i].seq, __ATOMIC_ACQUIRE);
+            if (seq & 1) {
+                continue;
+            }
+            memcpy((void *)&dst[i], (const void *)&src[i], sizeof(T));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (seq == __atomic_load_n(&src[i].seq, __ATOMIC_RELAXED)) {
+                break;
+            }
+        }
+        consistent = consistent && retry < STATS_SEQ_READ_RETRIES;
+    }
+    return consistent;
+}
+
 // Epoll group stats
 typedef struct {
     bool enabled;
+    uint32_t seq;
     int epfd;
     iomux_func_stats_t stats;
+    char pad[STATS_CACHE_LINE_SIZE];
 } epoll_stats_t;
 
 // iomux function stat info
 typedef struct {
     iomux_func_stats_t poll;
+    char pad_poll[STATS_CACHE_LINE_SIZE];
     iomux_func_stats_t select;
+    char pad_select[STATS_CACHE_LINE_SIZE];
     epoll_stats_t epoll[NUM_OF_SUPPORTED_EPFDS];
 } iomux_stats_t;
 
+// Latency histograms
+#define LAT_HIST_SUB_BITS 3 // 8 linear sub-buckets per power of two, ~12% precision
+#define LAT_HIST_MAX_BITS 36 // samples of 2^36 TSC ticks and above share the last bucket
+#define LAT_HIST_BUCKETS  ((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS)
+
+typedef enum {
+    LAT_RX_CQ_TO_READY = 0, // packet polled from a CQ until it is queued to the socket
+    LAT_RX_RECV_WAIT, // receive call entry until data is returned
+    LAT_TX_SEND_TO_DOORBELL, // send call entry until the first doorbell is rung
+    LAT_SOCKET_NUM,
+    LAT_EPOLL_WAIT = LAT_SOCKET_NUM, // epoll_wait() blocking time, process wide only
+    LAT_TCP_TIMER_SOCKET, // TCP timer tick cost divided by the sockets it serviced
+    LAT_GLOBAL_NUM
+} lat_hist_type_t;
+
+/*
+ * Log-linear (HDR style) histogram of TSC tick intervals. Values below 2^LAT_HIST_SUB_BITS
+ * are counted exactly, every next power of two is split into 2^LAT_HIST_SUB_BITS buckets.
+ */
+typedef struct {
+    uint64_t n_samples;
+    uint64_t n_sum;
+    uint64_t n_max;
+    uint64_t buckets[LAT_HIST_BUCKETS];
+
+    static inline uint32_t bucket_index(uint64_t ticks)
+    {
+        if (ticks < (1ULL << LAT_HIST_SUB_BITS)) {
+            return (uint32_t)ticks;
+        }
+        uint32_t msb = 63 - __builtin_clzll(ticks);
+        if (msb >= LAT_HIST_MAX_BITS) {
+            return LAT_HIST_BUCKETS - 1;
+        }
+        uint32_t sub = (ticks >> (msb - LAT_HIST_SUB_BITS)) & ((1U << LAT_HIST_SUB_BITS) - 1);
+        return ((msb - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS) + sub;
+    }
+
+    // Highest value which falls into the bucket
+    static inline uint64_t bucket_value(uint32_t idx)
+    {
+        if (idx < (1U << LAT_HIST_SUB_BITS)) {
+            return idx;
+        }
+        uint32_t shift = (idx >> LAT_HIST_SUB_BITS) - 1;
+        uint64_t sub = idx & ((1U << LAT_HIST_SUB_BITS) - 1);
+        return (((1ULL << LAT_HIST_SUB_BITS) + sub + 1) << shift) - 1;
+    }
+
+    // Single writer update, used for per socket histograms
+    inline void add(uint64_t ticks)
+    {
+        buckets[bucket_index(ticks)]++;
+        n_samples++;
+        n_sum += ticks;
+        if (ticks > n_max) {
+            n_max = ticks;
+        }
+    }
+
+    // Update for histograms shared between threads
+    inline void add_atomic(uint64_t ticks)
+    {
+        __atomic_fetch_add(&buckets[bucket_index(ticks)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&n_samples, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&n_sum, ticks, __ATOMIC_RELAXED);
+        uint64_t max = __atomic_load_n(&n_max, __ATOMIC_RELAXED);
+        while (ticks > max &&
+               !__atomic_compare_exchange_n(&n_max, &max, ticks, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+
+    // Upper bound of the bucket holding the given percentile, 0 for an empty histogram
+    uint64_t percentile(double pct) const
+    {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+            total += buckets[i];
+        }
+        if (!total) {
+            return 0;
+        }
+        uint64_t rank = std::min((uint64_t)(total * pct / 100.0), total - 1);
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+            count += buckets[i];
+            if (count > rank) {
+                return bucket_value(i);
+            }
+        }
+        return bucket_value(LAT_HIST_BUCKETS - 1);
+    }
+} lat_hist_t;
+
 // multicast stat info
 typedef struct {
     uint32_t sock_num;
@@ -169,6 +332,9 @@ typedef struct {
     uint32_t n_rx_data_pkts;
     uint32_t n_rx_frags;
     uint32_t n_gro;
+    uint32_t n_rx_adaptive_spin;
+    uint32_t n_rx_adaptive_yield;
+    uint32_t n_rx_adaptive_block;
 } socket_counters_t;
 
 #ifdef DEFINED_UTLS
@@ -236,6 +402,7 @@ struct socket_stats_t {
     socket_tls_counters_t tls_counters;
 #endif /* DEFINED_UTLS */
     socket_listen_counters_t listen_counters;
+    lat_hist_t lat_hist[LAT_SOCKET_NUM];
 
     // Control Path
     std::bitset<MC_TABLE_SIZE> mc_grp_map;
@@ -248,6 +415,7 @@ struct socket_stats_t {
     uint32_t inode;
     uint32_t tcp_state; // enum tcp_state
     uint32_t n_rx_zcopy_pkt_count;
+    uint32_t n_rx_adaptive_wait_usec; // Average wait of XLIO_ADAPTIVE_POLL
     pid_t threadid_last_rx;
     pid_t threadid_last_tx;
     uint64_t ring_user_id_rx;
@@ -279,6 +447,7 @@ struct socket_stats_t {
         threadid_last_rx = threadid_last_tx = pid_t(0);
         n_rx_ready_pkt_count = n_rx_ready_byte_count = n_rx_zcopy_pkt_count =
             n_tx_ready_byte_count = 0;
+        n_rx_adaptive_wait_usec = 0;
         memset(&counters, 0, sizeof(counters));
 #ifdef DEFINED_UTLS
         tls_tx_offload = tls_rx_offload = false;
@@ -287,6 +456,7 @@ struct socket_stats_t {
 #endif /* DEFINED_UTLS */
         memset(&strq_counters, 0, sizeof(strq_counters));
         memset(&listen_counters, 0, sizeof(listen_counters));
+        memset(lat_hist, 0, sizeof(lat_hist));
         mc_grp_map.reset();
         ring_user_id_rx = ring_user_id_tx = 0;
         ring_alloc_logic_rx = ring_alloc_logic_tx = RING_LOGIC_PER_INTERFACE;
@@ -322,7 +492,9 @@ struct socket_stats_t {
 
 typedef struct {
     bool b_enabled;
+    uint32_t seq;
     socket_stats_t skt_stats;
+    char pad[STATS_CACHE_LINE_SIZE];
 
     void reset()
     {
@@ -331,6 +503,14 @@ typedef struct {
     }
 } socket_instance_block_t;
 
+/* Sequence number of the shared memory block which holds the socket statistics */
+static inline uint32_t *socket_stats_block_seq(socket_stats_t *p_skt_stats)
+{
+    return &((socket_instance_block_t *)((char *)p_skt_stats -
+                                         offsetof(socket_instance_block_t, skt_stats)))
+                ->seq;
+}
+
 // CQ stat info
 typedef struct {
     uint64_t n_rx_stride_count;
@@ -351,12 +531,14 @@ typedef struct {
 
 typedef struct {
     bool b_enabled;
+    uint32_t seq;
     cq_stats_t cq_stats;
+    char pad[STATS_CACHE_LINE_SIZE];
 } cq_instance_block_t;
 
-typedef enum { RING_ETH = 0, RING_TAP } ring_type_t;
+typedef enum { RING_ETH = 0, RING_TAP, RING_XDP } ring_type_t;
 
-static const char *const ring_type_str[] = {"RING_ETH", "RING_TAP"};
+static const char *const ring_type_str[] = {"RING_ETH", "RING_TAP", "RING_XDP"};
 
 // Ring stat info
 typedef struct {
@@ -365,6 +547,8 @@ typedef struct {
     uint64_t n_tx_pkt_count;
     uint64_t n_tx_byte_count;
     uint64_t n_tx_retransmits;
+    uint64_t n_tx_txtime_queued;
+    uint64_t n_tx_txtime_dropped;
     void *p_ring_master;
 #ifdef DEFINED_UTLS
     uint32_t n_tx_tls_contexts;
@@ -389,12 +573,24 @@ typedef struct {
             uint32_t n_rx_buffers;
             uint32_t n_vf_plugouts;
         } tap;
+        struct {
+            char s_if_name[IFNAMSIZ];
+            uint32_t n_xsk_fd;
+            uint32_t n_queue_id;
+            uint32_t n_rx_buffers;
+            uint32_t n_tx_free_frames;
+            uint64_t n_rx_dropped;
+            uint64_t n_tx_dropped;
+            uint64_t n_wakeups;
+        } xdp;
     };
 } ring_stats_t;
 
 typedef struct {
     bool b_enabled;
+    uint32_t seq;
     ring_stats_t ring_stats;
+    char pad[STATS_CACHE_LINE_SIZE];
 } ring_instance_block_t;
 
 // Buffer Pool stat info
@@ -404,33 +600,101 @@ typedef struct {
     uint32_t n_buffer_pool_size;
     uint32_t n_buffer_pool_no_bufs;
     uint32_t n_buffer_pool_expands;
+    uint32_t n_buffer_pool_reclaims;
+    uint64_t n_buffer_pool_registered;
 } bpool_stats_t;
 
 typedef struct {
     bool b_enabled;
+    uint32_t seq;
     bpool_stats_t bpool_stats;
+    char pad[STATS_CACHE_LINE_SIZE];
 } bpool_instance_block_t;
 
+// Global counters which any thread updates, every thread adds to its own slot
+#define NUM_OF_GLOBAL_STATS_SLOTS 16
+
+typedef struct alignas(STATS_CACHE_LINE_SIZE) {
+    std::atomic<uint64_t> n_tcp_destructed;
+    std::atomic<uint64_t> n_udp_destructed;
+    std::atomic<uint64_t> n_tcp_timer_ticks;
+    std::atomic<uint64_t> n_tcp_timer_sockets;
+} global_thread_stats_t;
+
+/*
+ * Slot of the calling thread. Threads beyond NUM_OF_GLOBAL_STATS_SLOTS share slots,
+ * so the slot counters are still updated atomically.
+ */
+inline uint32_t global_stats_thread_slot()
+{
+    static std::atomic<uint32_t> s_next_slot(0);
+    static thread_local uint32_t t_slot =
+        s_next_slot.fetch_add(1U, std::memory_order_relaxed) % NUM_OF_GLOBAL_STATS_SLOTS;
+    return t_slot;
+}
+
+// Zero copy file mapping cache, updated under the cache lock
+struct mapping_cache_stats {
+    uint32_t n_hits;
+    uint32_t n_misses;
+    uint32_t n_evicts;
+    uint32_t n_readaheads;
+};
+
 // Global stat info
 typedef struct {
     uint32_t n_tcp_seg_pool_size;
     uint32_t n_tcp_seg_pool_no_segs;
+    struct mapping_cache_stats mapping_cache;
     int n_pending_sockets;
-    std::atomic<int> socket_tcp_destructor_counter;
-    std::atomic<int> socket_udp_destructor_counter;
+    // Sums of the thread slots, filled by the reader with aggregate()
+    int socket_tcp_destructor_counter;
+    int socket_udp_destructor_counter;
+    uint64_t n_tcp_timer_ticks;
+    uint64_t n_tcp_timer_sockets; // sockets serviced by all the ticks
+    global_thread_stats_t threads[NUM_OF_GLOBAL_STATS_SLOTS];
+    lat_hist_t lat_hist[LAT_GLOBAL_NUM];
     void init()
     {
         n_tcp_seg_pool_size = 0;
         n_tcp_seg_pool_no_segs = 0;
+        memset(&mapping_cache, 0, sizeof(mapping_cache));
         n_pending_sockets = 0;
         socket_tcp_destructor_counter = 0;
         socket_udp_destructor_counter = 0;
+        n_tcp_timer_ticks = 0;
+        n_tcp_timer_sockets = 0;
+        for (global_thread_stats_t &slot : threads) {
+            slot.n_tcp_destructed = 0;
+            slot.n_udp_destructed = 0;
+            slot.n_tcp_timer_ticks = 0;
+            slot.n_tcp_timer_sockets = 0;
+        }
+        memset(lat_hist, 0, sizeof(lat_hist));
+    }
+    global_thread_stats_t &thread_slot() { return threads[global_stats_thread_slot()]; }
+    uint64_t thread_sum(std::atomic<uint64_t> global_thread_stats_t::*counter) const
+    {
+        uint64_t sum = 0;
+        for (const global_thread_stats_t &slot : threads) {
+            sum += (slot.*counter).load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+    void aggregate()
+    {
+        socket_tcp_destructor_counter = (int)thread_sum(&global_thread_stats_t::n_tcp_destructed);
+        socket_udp_destructor_counter = (int)thread_sum(&global_thread_stats_t::n_udp_destructed);
+        n_tcp_timer_ticks = thread_sum(&global_thread_stats_t::n_tcp_timer_ticks);
+        n_tcp_timer_sockets = thread_sum(&global_thread_stats_t::n_tcp_timer_sockets);
     }
 } global_stats_t;
 
 typedef struct {
     bool b_enabled;
+    uint32_t seq;
     global_stats_t global_stats;
+    char pad[STATS_CACHE_LINE_SIZE];
     void init()
     {
         b_enabled = false;
@@ -438,6 +702,26 @@ typedef struct {
     };
 } global_instance_block_t;
 
+// Lock contention profiler (XLIO_STATS_LOCKS), locks sharing a name share an entry
+#define NUM_OF_SUPPORTED_LOCKS 32
+#define LOCK_STATS_NAME_LEN    32
+
+typedef struct {
+    char name[LOCK_STATS_NAME_LEN];
+    uint32_t n_instances; // lock objects which resolved to this entry
+    uint64_t n_acquired; // flushed from per thread counters in batches
+    uint64_t n_contended;
+    lat_hist_t wait_hist; // contended acquisitions only
+    lat_hist_t hold_hist; // sampled acquisitions, see hold_sample_rate
+} lock_stats_t;
+
+typedef struct {
+    uint32_t n_locks; // entries in use, published after the entry name
+    uint32_t n_names_dropped; // lock names which did not fit into the table
+    uint32_t hold_sample_rate; // one of every hold_sample_rate acquisitions is timed
+    lock_stats_t locks[NUM_OF_SUPPORTED_LOCKS];
+} lock_stats_block_t;
+
 // Version info
 typedef struct {
     uint8_t xlio_lib_maj;
@@ -461,6 +745,7 @@ typedef struct sh_mem_t {
     global_instance_block_t global_inst_arr[NUM_OF_SUPPORTED_GLOBALS];
     mc_grp_info_t mc_info;
     iomux_stats_t iomux;
+    lock_stats_block_t lock_stats;
     size_t max_skt_inst_num; // number of elements allocated in 'socket_instance_block_t
                              // skt_inst_arr[]'
 
@@ -509,12 +794,102 @@ typedef struct sh_mem_t {
             mc_info.mc_grp_tbl[i].sock_num = 0;
         }
         memset(&iomux, 0, sizeof(iomux));
+        memset(&lock_stats, 0, sizeof(lock_stats));
         for (uint32_t i = 0; i < max_skt_inst_num; i++) {
             skt_inst_arr[i].reset();
         }
     }
 } sh_mem_t;
 
+/*
+ * Hot-path trace rings are published in a separate "xliotrace.<pid>" file next to the
+ * statistics. Every thread owns one ring of TSC stamped events which it overwrites
+ * in a circle and publishes by a release store of the head. The reader never blocks
+ * the writer: it copies the ring and drops the events which could have been overwritten
+ * meanwhile.
+ */
+#define TRACE_MAX_THREADS 64
+#define TRACE_SHM_SIZE(capacity)                                                                   \
+    (sizeof(trace_shm_t) + (size_t)TRACE_MAX_THREADS * (capacity) * sizeof(trace_event_t))
+
+typedef enum {
+    TRACE_CQ_POLL = 0, // CQ poll which returned completions, arg: number of completions
+    TRACE_LWIP_INPUT, // TCP segment processing by lwIP, arg: segment length
+    TRACE_LWIP_OUTPUT, // TCP segment transmission from lwIP, arg: segment length
+    TRACE_TIMER_TICK, // internal thread timers processing
+    TRACE_EPOLL_WAKEUP, // epoll_wait() call, arg: number of returned events
+    TRACE_EVENT_NUM
+} trace_event_type_t;
+
+typedef struct {
+    uint64_t tsc; // event start
+    uint32_t dur; // duration in TSC ticks
+    uint16_t type;
+    uint16_t arg;
+} trace_event_t;
+
+typedef struct {
+    pid_t tid;
+    uint64_t head; // number of events ever written to the ring
+    char pad[STATS_CACHE_LINE_SIZE];
+} trace_ring_hdr_t;
+
+typedef struct {
+    char stats_protocol_ver[32];
+    uint64_t tsc_per_second;
+    uint32_t capacity; // events per ring, power of 2
+    uint32_t n_threads; // rings claimed so far, may exceed TRACE_MAX_THREADS
+    trace_ring_hdr_t rings[TRACE_MAX_THREADS];
+
+    trace_event_t *ring_events(uint32_t idx)
+    {
+        return (trace_event_t *)(this + 1) + (size_t)idx * capacity;
+    }
+    const trace_event_t *ring_events(uint32_t idx) const
+    {
+        return (const trace_event_t *)(this + 1) + (size_t)idx * capacity;
+    }
+} trace_shm_t;
+
+// Single writer push, the event becomes visible to the reader with the head update
+static inline void trace_ring_push(trace_ring_hdr_t *hdr, trace_event_t *events, uint32_t mask,
+                                   const trace_event_t &ev)
+{
+    uint64_t head = hdr->head;
+    events[head & mask] = ev;
+    __atomic_store_n(&hdr->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Copy the events of a ring oldest first and return their number. The writer may
+ * overwrite the oldest slots during the copy, such events are dropped according to the
+ * head value read after the copy.
+ */
+static inline uint32_t trace_ring_snapshot(const trace_ring_hdr_t *hdr,
+                                           const trace_event_t *events, uint32_t capacity,
+                                           trace_event_t *out)
+{
+    uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    uint64_t first = (head > capacity) ? head - capacity : 0;
+
+    for (uint64_t i = first; i < head; i++) {
+        out[i - first] = events[i & (capacity - 1)];
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    // The slot of event 'head_after' may be under rewrite as well
+    uint64_t head_after = __atomic_load_n(&hdr->head, __ATOMIC_RELAXED);
+    uint64_t valid = (head_after + 1 > capacity) ? head_after + 1 - capacity : 0;
+    if (valid <= first) {
+        return (uint32_t)(head - first);
+    }
+    if (valid >= head) {
+        return 0;
+    }
+    memmove(out, out + (valid - first), (head - valid) * sizeof(*out));
+    return (uint32_t)(head - valid);
+}
+
 typedef struct sh_mem_info {
     char filename_sh_stats[PATH_MAX];
     size_t shmem_size;
@@ -526,33 +901,44 @@ typedef struct sh_mem_info {
 // publisher functions
 void xlio_shmem_stats_open(vlog_levels_t **p_p_xlio_log_level, uint8_t **p_p_xlio_log_details);
 void xlio_shmem_stats_close();
+trace_shm_t *xlio_trace_open(uint32_t capacity);
+void xlio_trace_close();
 
-void xlio_stats_instance_create_socket_block(socket_stats_t *);
-void xlio_stats_instance_remove_socket_block(socket_stats_t *);
+/*
+ * Instance block API: create() initializes a free shared memory block with the content
+ * of the owner's local block and returns the block the owner should update from now on
+ * (the local block itself if no shared block is available). remove() copies the final
+ * values back to the local block, releases the shared one and returns the local block.
+ */
+socket_stats_t *xlio_stats_instance_create_socket_block(socket_stats_t *);
+socket_stats_t *xlio_stats_instance_remove_socket_block(socket_stats_t *);
 
 void xlio_stats_mc_group_add(const ip_address &mc_grp, socket_stats_t *p_socket_stats);
 void xlio_stats_mc_group_remove(const ip_address &mc_grp, socket_stats_t *p_socket_stats);
 
-void xlio_stats_instance_create_ring_block(ring_stats_t *);
-void xlio_stats_instance_remove_ring_block(ring_stats_t *);
+ring_stats_t *xlio_stats_instance_create_ring_block(ring_stats_t *);
+ring_stats_t *xlio_stats_instance_remove_ring_block(ring_stats_t *);
+
+cq_stats_t *xlio_stats_instance_create_cq_block(cq_stats_t *);
+cq_stats_t *xlio_stats_instance_remove_cq_block(cq_stats_t *);
 
-void xlio_stats_instance_create_cq_block(cq_stats_t *);
-void xlio_stats_instance_remove_cq_block(cq_stats_t *);
+bpool_stats_t *xlio_stats_instance_create_bpool_block(bpool_stats_t *);
+bpool_stats_t *xlio_stats_instance_remove_bpool_block(bpool_stats_t *);
 
-void xlio_stats_instance_create_bpool_block(bpool_stats_t *);
-void xlio_stats_instance_remove_bpool_block(bpool_stats_t *);
+global_stats_t *xlio_stats_instance_create_global_block(global_stats_t *);
+global_stats_t *xlio_stats_instance_remove_global_block(global_stats_t *);
 
-void xlio_stats_instance_create_global_block(global_stats_t *);
-void xlio_stats_instance_remove_global_block(global_stats_t *);
+iomux_func_stats_t *xlio_stats_instance_get_poll_block(iomux_func_stats_t *);
+iomux_func_stats_t *xlio_stats_instance_get_select_block(iomux_func_stats_t *);
 
-void xlio_stats_instance_get_poll_block(iomux_func_stats_t *);
-void xlio_stats_instance_get_select_block(iomux_func_stats_t *);
+epoll_stats_t *xlio_stats_instance_create_epoll_block(int, epoll_stats_t *);
+epoll_stats_t *xlio_stats_instance_remove_epoll_block(epoll_stats_t *ep_stats);
 
-void xlio_stats_instance_create_epoll_block(int, iomux_func_stats_t *);
-void xlio_stats_instance_remove_epoll_block(iomux_func_stats_t *ep_stats);
+lock_stats_block_t *xlio_stats_instance_get_lock_block();
 
 // reader functions
 void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info, FILE *filename);
+void print_lat_hist_stats(const lat_hist_t *p_hist, int num, FILE *file);
 void print_netstat_like(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info, FILE *file,
                         int pid);
 void print_netstat_like_headers(FILE *file);
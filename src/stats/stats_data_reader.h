@@ -56,8 +56,8 @@ public:
     stats_data_reader();
     void handle_timer_expired(void *ctx);
     void register_to_timer();
-    void add_data_reader(void *local_addr, void *shm_addr, int size);
-    void *pop_data_reader(void *local_addr);
+    void add_data_reader(void *shm_addr, void *local_addr, int size);
+    void *pop_data_reader(void *shm_addr);
 
 private:
     void *m_timer_handler;
@@ -128,8 +128,10 @@ struct global_counters_show {
         auto count_if_enabled = [](destructed_sockets &val,
                                    const global_instance_block_t &global_stat) {
             if (global_stat.b_enabled) {
-                val.tcp += global_stat.global_stats.socket_tcp_destructor_counter.load();
-                val.udp += global_stat.global_stats.socket_udp_destructor_counter.load();
+                val.tcp += global_stat.global_stats.thread_sum(
+                    &global_thread_stats_t::n_tcp_destructed);
+                val.udp += global_stat.global_stats.thread_sum(
+                    &global_thread_stats_t::n_udp_destructed);
             }
             return val;
         };
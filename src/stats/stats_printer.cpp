@@ -77,6 +77,29 @@ const char *to_str_socket_type_netstat_like(int type, sa_family_t family)
     return "???";
 }
 
+// Print percentiles of the latency histograms which have samples
+void print_lat_hist_stats(const lat_hist_t *p_hist, int num, FILE *file)
+{
+    static const char *names[LAT_GLOBAL_NUM] = {"CQ poll to ready", "Recv wait",
+                                                "Send to doorbell", "Epoll wait",
+                                                "TCP timer per socket"};
+    double usec_per_tick = 1e6 / (double)get_tsc_rate_per_second();
+
+    for (int i = 0; i < num && i < LAT_GLOBAL_NUM; i++) {
+        if (!p_hist[i].n_samples) {
+            continue;
+        }
+        fprintf(file,
+                "Latency %s: %" PRIu64 " / %.2f / %.2f / %.2f / %.2f / %.2f / %.2f "
+                "[samples/avg/p50/p90/p99/p99.9/max usec]\n",
+                names[i], p_hist[i].n_samples,
+                p_hist[i].n_sum * usec_per_tick / p_hist[i].n_samples,
+                p_hist[i].percentile(50) * usec_per_tick, p_hist[i].percentile(90) * usec_per_tick,
+                p_hist[i].percentile(99) * usec_per_tick,
+                p_hist[i].percentile(99.9) * usec_per_tick, p_hist[i].n_max * usec_per_tick);
+    }
+}
+
 // Print statistics for offloaded sockets
 void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info, FILE *filename)
 {
@@ -229,6 +252,14 @@ void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info,
                 rx_poll_hit_percentage);
         b_any_activiy = true;
     }
+    if (p_si_stats->counters.n_rx_adaptive_spin || p_si_stats->counters.n_rx_adaptive_yield ||
+        p_si_stats->counters.n_rx_adaptive_block) {
+        fprintf(filename, "Rx adaptive poll: %u / %u / %u [spin/yield/block]%s, avg wait %u usec\n",
+                p_si_stats->counters.n_rx_adaptive_spin, p_si_stats->counters.n_rx_adaptive_yield,
+                p_si_stats->counters.n_rx_adaptive_block, post_fix,
+                p_si_stats->n_rx_adaptive_wait_usec);
+        b_any_activiy = true;
+    }
 
     if (p_si_stats->counters.n_rx_migrations || p_si_stats->counters.n_tx_migrations) {
         fprintf(filename, "Ring migrations Rx: %u, Tx: %u\n", p_si_stats->counters.n_rx_migrations,
@@ -300,6 +331,8 @@ void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info,
             p_si_stats->listen_counters.n_conn_dropped;
     }
 
+    print_lat_hist_stats(p_si_stats->lat_hist, LAT_SOCKET_NUM, filename);
+
     if (b_any_activiy == false) {
         fprintf(filename, "Rx and Tx where not active\n");
     }
@@ -38,6 +38,7 @@
 #include "core/util/xlio_stats.h"
 #include "core/sock/sock-redirect.h"
 #include "core/event/event_handler_manager.h"
+#include "utils/rdtsc.h"
 
 #define MODULE_NAME "STATS: "
 
@@ -52,6 +53,7 @@ static lock_spin g_lock_iomux("g_lock_iomux");
 static sh_mem_info_t g_sh_mem_info;
 static sh_mem_t *g_sh_mem;
 static sh_mem_t g_local_sh_mem;
+static sh_mem_info_t g_trace_info = {{0}, 0, -1, MAP_FAILED, 0};
 
 // statistic file
 FILE *g_stats_file = NULL;
@@ -76,8 +78,8 @@ stats_data_reader::stats_data_reader()
 {
 }
 
-#define LOCAL_OBJECT_DATA iter->first
-#define SHM_DATA_ADDRESS  iter->second.first
+#define LOCAL_OBJECT_DATA iter->second.first
+#define SHM_DATA_ADDRESS  iter->first
 #define COPY_SIZE         iter->second.second
 
 bool should_write()
@@ -120,12 +122,6 @@ void stats_data_reader::handle_timer_expired(void *ctx)
         g_sh_mem->fd_dump = 0;
         g_sh_mem->fd_dump_log_level = STATS_FD_STATISTICS_LOG_LEVEL_DEFAULT;
     }
-    stats_read_map_t::iterator iter;
-    m_lock_data_map.lock();
-    for (iter = m_data_map.begin(); iter != m_data_map.end(); iter++) {
-        memcpy(SHM_DATA_ADDRESS, LOCAL_OBJECT_DATA, COPY_SIZE);
-    }
-    m_lock_data_map.unlock();
 }
 
 void stats_data_reader::register_to_timer()
@@ -134,26 +130,48 @@ void stats_data_reader::register_to_timer()
         STATS_PUBLISHER_TIMER_PERIOD, g_p_stats_data_reader, PERIODIC_TIMER, 0);
 }
 
-void stats_data_reader::add_data_reader(void *local_addr, void *shm_addr, int size)
+void stats_data_reader::add_data_reader(void *shm_addr, void *local_addr, int size)
 {
     m_lock_data_map.lock();
-    m_data_map[local_addr] = std::make_pair(shm_addr, size);
+    m_data_map[shm_addr] = std::make_pair(local_addr, size);
     m_lock_data_map.unlock();
 }
 
-void *stats_data_reader::pop_data_reader(void *local_addr)
+/* Copy the final values back to the owner's local block and forget the shared one */
+void *stats_data_reader::pop_data_reader(void *shm_addr)
 {
     void *rv = NULL;
     m_lock_data_map.lock();
-    stats_read_map_t::iterator iter = m_data_map.find(local_addr);
+    stats_read_map_t::iterator iter = m_data_map.find(shm_addr);
     if (iter != m_data_map.end()) { // found
-        rv = SHM_DATA_ADDRESS;
-        m_data_map.erase(local_addr);
+        rv = LOCAL_OBJECT_DATA;
+        memcpy(LOCAL_OBJECT_DATA, SHM_DATA_ADDRESS, COPY_SIZE);
+        m_data_map.erase(iter);
     }
     m_lock_data_map.unlock();
     return rv;
 }
 
+/* Initialize a shared block with the owner's local data, the owner updates it in place */
+template <typename T>
+static T *shm_block_attach(bool &b_enabled, uint32_t &seq, T *p_shm_stats, T *p_local_stats)
+{
+    stats_seq_write_begin(&seq);
+    memcpy((void *)p_shm_stats, (void *)p_local_stats, sizeof(T));
+    b_enabled = true;
+    stats_seq_write_end(&seq);
+
+    g_p_stats_data_reader->add_data_reader(p_shm_stats, p_local_stats, sizeof(T));
+    return p_shm_stats;
+}
+
+static void shm_block_detach(bool &b_enabled, uint32_t &seq)
+{
+    stats_seq_write_begin(&seq);
+    b_enabled = false;
+    stats_seq_write_end(&seq);
+}
+
 void write_version_details_to_shmem(version_info_t *p_ver_info)
 {
     p_ver_info->xlio_lib_maj = PRJ_LIBRARY_MAJOR;
@@ -182,8 +200,8 @@ void xlio_shmem_stats_open(vlog_levels_t **p_p_xlio_log_level, uint8_t **p_p_xli
     BULLSEYE_EXCLUDE_BLOCK_END
 
     shmem_size = SHMEM_STATS_SIZE(safe_mce_sys().stats_fd_num_monitor);
-    buf = malloc(shmem_size);
-    if (buf == NULL) {
+    // Thread slots of the global block are cache line aligned
+    if (posix_memalign(&buf, STATS_CACHE_LINE_SIZE, shmem_size)) {
         goto shmem_error;
     }
     memset(buf, 0, shmem_size);
@@ -303,7 +321,25 @@ shmem_error:
 
 void xlio_shmem_stats_close()
 {
-    if (g_sh_mem_info.p_sh_stats && g_sh_mem_info.p_sh_stats != MAP_FAILED) {
+    /* Objects inherited from the parent keep pointers to the stats blocks and may still be
+     * used by the child (e.g. nginx listen sockets). Detach the blocks from the parent's file
+     * and leave them accessible instead of releasing.
+     */
+    if (g_is_forked_child) {
+        if (g_sh_mem_info.p_sh_stats && g_sh_mem_info.p_sh_stats != MAP_FAILED) {
+            if (mmap(g_sh_mem_info.p_sh_stats,
+                     SHMEM_STATS_SIZE(safe_mce_sys().stats_fd_num_monitor),
+                     PROT_WRITE | PROT_READ, MAP_PRIVATE | MAP_FIXED, g_sh_mem_info.fd_sh_stats,
+                     0) == MAP_FAILED) {
+                vlog_printf(VLOG_ERROR, "%s: failed to detach parent shared memory (errno=%d)\n",
+                            __func__, errno);
+            }
+            if (g_sh_mem_info.fd_sh_stats) {
+                close(g_sh_mem_info.fd_sh_stats);
+            }
+        }
+        g_sh_mem_info.p_sh_stats = MAP_FAILED;
+    } else if (g_sh_mem_info.p_sh_stats && g_sh_mem_info.p_sh_stats != MAP_FAILED) {
         __log_dbg("file '%s' fd %d shared memory at %p with %d max blocks",
                   g_sh_mem_info.filename_sh_stats, g_sh_mem_info.fd_sh_stats,
                   g_sh_mem_info.p_sh_stats, safe_mce_sys().stats_fd_num_monitor);
@@ -324,9 +360,7 @@ void xlio_shmem_stats_close()
             close(g_sh_mem_info.fd_sh_stats);
         }
 
-        if (!g_is_forked_child) {
-            unlink(g_sh_mem_info.filename_sh_stats);
-        }
+        unlink(g_sh_mem_info.filename_sh_stats);
     } else if (g_sh_mem_info.p_sh_stats != MAP_FAILED) {
         free(g_sh_mem);
     }
@@ -337,24 +371,23 @@ void xlio_shmem_stats_close()
     g_p_stats_data_reader = NULL;
 }
 
-void xlio_stats_instance_create_socket_block(socket_stats_t *local_stats_addr)
+socket_stats_t *xlio_stats_instance_create_socket_block(socket_stats_t *local_stats_addr)
 {
-    socket_stats_t *p_skt_stats = NULL;
+    socket_instance_block_t *p_instance = NULL;
+    socket_stats_t *p_skt_stats = local_stats_addr;
     g_lock_skt_inst_arr.lock();
 
     // search the first free sh_mem block
     for (uint32_t i = 0; i < g_sh_mem->max_skt_inst_num; i++) {
         if (g_sh_mem->skt_inst_arr[i].b_enabled == false) {
             // found free slot ,enabled and returning to the user
-            p_skt_stats = &g_sh_mem->skt_inst_arr[i].skt_stats;
-            g_sh_mem->skt_inst_arr[i].b_enabled = true;
+            p_instance = &g_sh_mem->skt_inst_arr[i];
             goto out;
         }
     }
     if (g_sh_mem->max_skt_inst_num + 1 < safe_mce_sys().stats_fd_num_monitor) {
         // allocate next sh_mem block
-        p_skt_stats = &g_sh_mem->skt_inst_arr[g_sh_mem->max_skt_inst_num].skt_stats;
-        g_sh_mem->skt_inst_arr[g_sh_mem->max_skt_inst_num].b_enabled = true;
+        p_instance = &g_sh_mem->skt_inst_arr[g_sh_mem->max_skt_inst_num];
         g_sh_mem->max_skt_inst_num++;
         goto out;
     } else {
@@ -369,50 +402,43 @@ void xlio_stats_instance_create_socket_block(socket_stats_t *local_stats_addr)
     }
 
 out:
-    if (p_skt_stats) {
-        p_skt_stats->reset();
-        g_p_stats_data_reader->add_data_reader(local_stats_addr, p_skt_stats,
-                                               sizeof(socket_stats_t));
+    if (p_instance) {
+        p_skt_stats = shm_block_attach(p_instance->b_enabled, p_instance->seq,
+                                       &p_instance->skt_stats, local_stats_addr);
     }
     g_lock_skt_inst_arr.unlock();
+    return p_skt_stats;
 }
 
-void xlio_stats_instance_remove_socket_block(socket_stats_t *local_addr)
+socket_stats_t *xlio_stats_instance_remove_socket_block(socket_stats_t *stats_addr)
 {
 
     g_lock_skt_inst_arr.lock();
 
-    print_full_stats(local_addr, NULL, safe_mce_sys().stats_file);
-    socket_stats_t *p_skt_stats =
-        (socket_stats_t *)g_p_stats_data_reader->pop_data_reader(local_addr);
+    print_full_stats(stats_addr, NULL, safe_mce_sys().stats_file);
+    socket_stats_t *p_local_stats =
+        (socket_stats_t *)g_p_stats_data_reader->pop_data_reader(stats_addr);
 
-    if (p_skt_stats == NULL) {
+    if (p_local_stats == NULL) {
         __log_dbg("application xlio_stats pointer is NULL");
         g_lock_skt_inst_arr.unlock();
-        return;
-    }
-
-    // coverity - g_sh_mem->skt_inst_arr cannot be null
-    /*BULLSEYE_EXCLUDE_BLOCK_START
-    if (g_sh_mem->skt_inst_arr == NULL) {
-        vlog_printf(VLOG_ERROR,"%s:%d: g_sh_mem->instances_arr not init\n", __func__, __LINE__);
-        g_lock_skt_stats.unlock();
-        return;
+        return stats_addr;
     }
-    BULLSEYE_EXCLUDE_BLOCK_END*/
 
     // Search sh_mem block to release
     for (uint32_t i = 0; i < g_sh_mem->max_skt_inst_num; i++) {
-        if (&g_sh_mem->skt_inst_arr[i].skt_stats == p_skt_stats) {
-            g_sh_mem->skt_inst_arr[i].b_enabled = false;
+        socket_instance_block_t *p_block = &g_sh_mem->skt_inst_arr[i];
+        if (&p_block->skt_stats == stats_addr) {
+            shm_block_detach(p_block->b_enabled, p_block->seq);
             g_lock_skt_inst_arr.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                p_skt_stats);
+                stats_addr);
     g_lock_skt_inst_arr.unlock();
+    return p_local_stats;
 }
 
 void xlio_stats_mc_group_add(const ip_address &mc_grp, socket_stats_t *p_socket_stats)
@@ -476,15 +502,15 @@ void xlio_stats_mc_group_remove(const ip_address &mc_grp, socket_stats_t *p_sock
     g_lock_mc_info.unlock();
 }
 
-void xlio_stats_instance_create_ring_block(ring_stats_t *local_stats_addr)
+ring_stats_t *xlio_stats_instance_create_ring_block(ring_stats_t *local_stats_addr)
 {
     ring_stats_t *p_instance_ring = NULL;
     g_lock_ring_inst_arr.lock();
     for (int i = 0; i < NUM_OF_SUPPORTED_RINGS; i++) {
-        if (!g_sh_mem->ring_inst_arr[i].b_enabled) {
-            g_sh_mem->ring_inst_arr[i].b_enabled = true;
-            p_instance_ring = &g_sh_mem->ring_inst_arr[i].ring_stats;
-            memset(p_instance_ring, 0, sizeof(*p_instance_ring));
+        ring_instance_block_t *p_block = &g_sh_mem->ring_inst_arr[i];
+        if (!p_block->b_enabled) {
+            p_instance_ring = shm_block_attach(p_block->b_enabled, p_block->seq,
+                                               &p_block->ring_stats, local_stats_addr);
             break;
         }
     }
@@ -494,60 +520,53 @@ void xlio_stats_instance_create_ring_block(ring_stats_t *local_stats_addr)
             vlog_printf(VLOG_INFO, "Statistics can monitor up to %d ring elements\n",
                         NUM_OF_SUPPORTED_RINGS);
         }
+        p_instance_ring = local_stats_addr;
     } else {
-        g_p_stats_data_reader->add_data_reader(local_stats_addr, p_instance_ring,
-                                               sizeof(ring_stats_t));
         __log_dbg("Added ring local=%p shm=%p", local_stats_addr, p_instance_ring);
     }
     g_lock_ring_inst_arr.unlock();
+    return p_instance_ring;
 }
 
-void xlio_stats_instance_remove_ring_block(ring_stats_t *local_stats_addr)
+ring_stats_t *xlio_stats_instance_remove_ring_block(ring_stats_t *stats_addr)
 {
     g_lock_ring_inst_arr.lock();
-    __log_dbg("Remove ring local=%p", local_stats_addr);
+    __log_dbg("Remove ring %p", stats_addr);
 
-    ring_stats_t *p_ring_stats =
-        (ring_stats_t *)g_p_stats_data_reader->pop_data_reader(local_stats_addr);
+    ring_stats_t *p_local_stats =
+        (ring_stats_t *)g_p_stats_data_reader->pop_data_reader(stats_addr);
 
-    if (p_ring_stats == NULL) { // happens on the tx cq (why don't we keep tx cq stats?)
+    if (p_local_stats == NULL) {
         __log_dbg("application xlio_stats pointer is NULL");
         g_lock_ring_inst_arr.unlock();
-        return;
+        return stats_addr;
     }
 
-    // coverity - g_sh_mem->ring_inst_arr cannot be null
-    /*BULLSEYE_EXCLUDE_BLOCK_START
-    if (g_sh_mem->ring_inst_arr == NULL) {
-        vlog_printf(VLOG_ERROR,"%s:%d: g_sh_mem->instances_arr not init\n", __func__, __LINE__);
-                g_lock_skt_stats.unlock();
-        return;
-    }
-    BULLSEYE_EXCLUDE_BLOCK_END*/
-
     // Search sh_mem block to release
     for (int i = 0; i < NUM_OF_SUPPORTED_RINGS; i++) {
-        if (&g_sh_mem->ring_inst_arr[i].ring_stats == p_ring_stats) {
-            g_sh_mem->ring_inst_arr[i].b_enabled = false;
+        ring_instance_block_t *p_block = &g_sh_mem->ring_inst_arr[i];
+        if (&p_block->ring_stats == stats_addr) {
+            shm_block_detach(p_block->b_enabled, p_block->seq);
             g_lock_ring_inst_arr.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                p_ring_stats);
+                stats_addr);
     g_lock_ring_inst_arr.unlock();
+    return p_local_stats;
 }
 
-void xlio_stats_instance_create_cq_block(cq_stats_t *local_stats_addr)
+cq_stats_t *xlio_stats_instance_create_cq_block(cq_stats_t *local_stats_addr)
 {
     cq_stats_t *p_instance_cq = NULL;
     g_lock_cq_inst_arr.lock();
     for (int i = 0; i < NUM_OF_SUPPORTED_CQS; i++) {
-        if (!g_sh_mem->cq_inst_arr[i].b_enabled) {
-            g_sh_mem->cq_inst_arr[i].b_enabled = true;
-            p_instance_cq = &g_sh_mem->cq_inst_arr[i].cq_stats;
-            memset(p_instance_cq, 0, sizeof(*p_instance_cq));
+        cq_instance_block_t *p_block = &g_sh_mem->cq_inst_arr[i];
+        if (!p_block->b_enabled) {
+            p_instance_cq = shm_block_attach(p_block->b_enabled, p_block->seq,
+                                             &p_block->cq_stats, local_stats_addr);
             break;
         }
     }
@@ -557,58 +576,52 @@ void xlio_stats_instance_create_cq_block(cq_stats_t *local_stats_addr)
             vlog_printf(VLOG_INFO, "Statistics can monitor up to %d cq elements\n",
                         NUM_OF_SUPPORTED_CQS);
         }
+        p_instance_cq = local_stats_addr;
     } else {
-        g_p_stats_data_reader->add_data_reader(local_stats_addr, p_instance_cq, sizeof(cq_stats_t));
         __log_dbg("Added cq local=%p shm=%p", local_stats_addr, p_instance_cq);
     }
     g_lock_cq_inst_arr.unlock();
+    return p_instance_cq;
 }
 
-void xlio_stats_instance_remove_cq_block(cq_stats_t *local_stats_addr)
+cq_stats_t *xlio_stats_instance_remove_cq_block(cq_stats_t *stats_addr)
 {
     g_lock_cq_inst_arr.lock();
-    __log_dbg("Remove cq local=%p", local_stats_addr);
+    __log_dbg("Remove cq %p", stats_addr);
 
-    cq_stats_t *p_cq_stats = (cq_stats_t *)g_p_stats_data_reader->pop_data_reader(local_stats_addr);
+    cq_stats_t *p_local_stats = (cq_stats_t *)g_p_stats_data_reader->pop_data_reader(stats_addr);
 
-    if (p_cq_stats == NULL) { // happens on the tx cq (why don't we keep tx cq stats?)
+    if (p_local_stats == NULL) {
         __log_dbg("application xlio_stats pointer is NULL");
         g_lock_cq_inst_arr.unlock();
-        return;
+        return stats_addr;
     }
 
-    // coverity - g_sh_mem->cq_inst_arr cannot be null
-    /*BULLSEYE_EXCLUDE_BLOCK_START
-    if (g_sh_mem->cq_inst_arr == NULL) {
-        vlog_printf(VLOG_ERROR,"%s:%d: g_sh_mem->instances_arr not init\n", __func__, __LINE__);
-                g_lock_skt_stats.unlock();
-        return;
-    }
-    BULLSEYE_EXCLUDE_BLOCK_END*/
-
     // Search sh_mem block to release
     for (int i = 0; i < NUM_OF_SUPPORTED_CQS; i++) {
-        if (&g_sh_mem->cq_inst_arr[i].cq_stats == p_cq_stats) {
-            g_sh_mem->cq_inst_arr[i].b_enabled = false;
+        cq_instance_block_t *p_block = &g_sh_mem->cq_inst_arr[i];
+        if (&p_block->cq_stats == stats_addr) {
+            shm_block_detach(p_block->b_enabled, p_block->seq);
             g_lock_cq_inst_arr.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                p_cq_stats);
+                stats_addr);
     g_lock_cq_inst_arr.unlock();
+    return p_local_stats;
 }
 
-void xlio_stats_instance_create_bpool_block(bpool_stats_t *local_stats_addr)
+bpool_stats_t *xlio_stats_instance_create_bpool_block(bpool_stats_t *local_stats_addr)
 {
     bpool_stats_t *p_instance_bpool = NULL;
     g_lock_bpool_inst_arr.lock();
     for (int i = 0; i < NUM_OF_SUPPORTED_BPOOLS; i++) {
-        if (!g_sh_mem->bpool_inst_arr[i].b_enabled) {
-            g_sh_mem->bpool_inst_arr[i].b_enabled = true;
-            p_instance_bpool = &g_sh_mem->bpool_inst_arr[i].bpool_stats;
-            memset(p_instance_bpool, 0, sizeof(bpool_stats_t));
+        bpool_instance_block_t *p_block = &g_sh_mem->bpool_inst_arr[i];
+        if (!p_block->b_enabled) {
+            p_instance_bpool = shm_block_attach(p_block->b_enabled, p_block->seq,
+                                                &p_block->bpool_stats, local_stats_addr);
             break;
         }
     }
@@ -618,153 +631,255 @@ void xlio_stats_instance_create_bpool_block(bpool_stats_t *local_stats_addr)
             vlog_printf(VLOG_INFO, "Statistics can monitor up to %d buffer pools\n",
                         NUM_OF_SUPPORTED_BPOOLS);
         }
+        p_instance_bpool = local_stats_addr;
     } else {
-        g_p_stats_data_reader->add_data_reader(local_stats_addr, p_instance_bpool,
-                                               sizeof(bpool_stats_t));
         __log_dbg("Added bpool local=%p shm=%p", local_stats_addr, p_instance_bpool);
     }
     g_lock_bpool_inst_arr.unlock();
+    return p_instance_bpool;
 }
 
-void xlio_stats_instance_remove_bpool_block(bpool_stats_t *local_stats_addr)
+bpool_stats_t *xlio_stats_instance_remove_bpool_block(bpool_stats_t *stats_addr)
 {
     g_lock_bpool_inst_arr.lock();
-    __log_dbg("Remove bpool local=%p", local_stats_addr);
+    __log_dbg("Remove bpool %p", stats_addr);
 
-    bpool_stats_t *p_bpool_stats =
-        (bpool_stats_t *)g_p_stats_data_reader->pop_data_reader(local_stats_addr);
+    bpool_stats_t *p_local_stats =
+        (bpool_stats_t *)g_p_stats_data_reader->pop_data_reader(stats_addr);
 
-    if (p_bpool_stats == NULL) {
+    if (p_local_stats == NULL) {
         __log_dbg("application xlio_stats pointer is NULL");
         g_lock_bpool_inst_arr.unlock();
-        return;
+        return stats_addr;
     }
 
     // Search sh_mem block to release
     for (int i = 0; i < NUM_OF_SUPPORTED_BPOOLS; i++) {
-        if (&g_sh_mem->bpool_inst_arr[i].bpool_stats == p_bpool_stats) {
-            g_sh_mem->bpool_inst_arr[i].b_enabled = false;
+        bpool_instance_block_t *p_block = &g_sh_mem->bpool_inst_arr[i];
+        if (&p_block->bpool_stats == stats_addr) {
+            shm_block_detach(p_block->b_enabled, p_block->seq);
             g_lock_bpool_inst_arr.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                p_bpool_stats);
+                stats_addr);
     g_lock_bpool_inst_arr.unlock();
+    return p_local_stats;
 }
 
-void xlio_stats_instance_create_global_block(global_stats_t *local_stats_addr)
+global_stats_t *xlio_stats_instance_create_global_block(global_stats_t *local_stats_addr)
 {
     global_stats_t *p_instance_global = NULL;
     g_lock_global_inst.lock();
     for (int i = 0; i < NUM_OF_SUPPORTED_GLOBALS; i++) {
-        if (!g_sh_mem->global_inst_arr[i].b_enabled) {
-            g_sh_mem->global_inst_arr[i].b_enabled = true;
-            p_instance_global = &g_sh_mem->global_inst_arr[i].global_stats;
-            p_instance_global->init();
+        global_instance_block_t *p_block = &g_sh_mem->global_inst_arr[i];
+        if (!p_block->b_enabled) {
+            p_instance_global = shm_block_attach(p_block->b_enabled, p_block->seq,
+                                                 &p_block->global_stats, local_stats_addr);
             break;
         }
     }
-
     if (p_instance_global == NULL) {
         if (!printed_global_limit_info) {
             printed_global_limit_info = true;
             vlog_printf(VLOG_INFO, "Statistics can monitor up to %d globals\n",
                         NUM_OF_SUPPORTED_GLOBALS);
         }
+        p_instance_global = local_stats_addr;
     } else {
-        g_p_stats_data_reader->add_data_reader(local_stats_addr, p_instance_global,
-                                               sizeof(global_stats_t));
         __log_dbg("Added global local=%p shm=%p", local_stats_addr, p_instance_global);
     }
     g_lock_global_inst.unlock();
+    return p_instance_global;
 }
 
-void xlio_stats_instance_remove_global_block(global_stats_t *local_stats_addr)
+global_stats_t *xlio_stats_instance_remove_global_block(global_stats_t *stats_addr)
 {
     g_lock_global_inst.lock();
-    __log_dbg("Remove global local=%p", local_stats_addr);
+    __log_dbg("Remove global %p", stats_addr);
 
-    global_stats_t *p_global_stats =
-        (global_stats_t *)g_p_stats_data_reader->pop_data_reader(local_stats_addr);
+    global_stats_t *p_local_stats =
+        (global_stats_t *)g_p_stats_data_reader->pop_data_reader(stats_addr);
 
-    if (p_global_stats == NULL) {
-        __log_dbg("application p_global_stats pointer is NULL");
+    if (p_local_stats == NULL) {
+        __log_dbg("application xlio_stats pointer is NULL");
         g_lock_global_inst.unlock();
-        return;
+        return stats_addr;
     }
 
     // Search sh_mem block to release
     for (int i = 0; i < NUM_OF_SUPPORTED_GLOBALS; i++) {
-        if (&g_sh_mem->global_inst_arr[i].global_stats == p_global_stats) {
-            g_sh_mem->global_inst_arr[i].b_enabled = false;
+        global_instance_block_t *p_block = &g_sh_mem->global_inst_arr[i];
+        if (&p_block->global_stats == stats_addr) {
+            shm_block_detach(p_block->b_enabled, p_block->seq);
             g_lock_global_inst.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                p_global_stats);
+                stats_addr);
     g_lock_global_inst.unlock();
+    return p_local_stats;
+}
+
+iomux_func_stats_t *xlio_stats_instance_get_poll_block(iomux_func_stats_t *local_stats_addr)
+{
+    NOT_IN_USE(local_stats_addr);
+    return &g_sh_mem->iomux.poll;
 }
 
-void xlio_stats_instance_get_poll_block(iomux_func_stats_t *local_stats_addr)
+iomux_func_stats_t *xlio_stats_instance_get_select_block(iomux_func_stats_t *local_stats_addr)
 {
-    g_p_stats_data_reader->add_data_reader(local_stats_addr, &g_sh_mem->iomux.poll,
-                                           sizeof(iomux_func_stats_t));
+    NOT_IN_USE(local_stats_addr);
+    return &g_sh_mem->iomux.select;
 }
 
-void xlio_stats_instance_get_select_block(iomux_func_stats_t *local_stats_addr)
+lock_stats_block_t *xlio_stats_instance_get_lock_block()
 {
-    g_p_stats_data_reader->add_data_reader(local_stats_addr, &g_sh_mem->iomux.select,
-                                           sizeof(iomux_func_stats_t));
+    return &g_sh_mem->lock_stats;
 }
 
-void xlio_stats_instance_create_epoll_block(int fd, iomux_func_stats_t *local_stats_addr)
+epoll_stats_t *xlio_stats_instance_create_epoll_block(int fd, epoll_stats_t *local_stats_addr)
 {
     g_lock_iomux.lock();
 
     for (unsigned i = 0; i < NUM_OF_SUPPORTED_EPFDS; ++i) {
         epoll_stats_t *ep_stats = &g_sh_mem->iomux.epoll[i];
         if (!ep_stats->enabled) {
-            ep_stats->enabled = true;
+            stats_seq_write_begin(&ep_stats->seq);
             ep_stats->epfd = fd;
-            g_p_stats_data_reader->add_data_reader(local_stats_addr, &ep_stats->stats,
-                                                   sizeof(iomux_func_stats_t));
+            ep_stats->stats = local_stats_addr->stats;
+            ep_stats->enabled = true;
+            stats_seq_write_end(&ep_stats->seq);
+            g_p_stats_data_reader->add_data_reader(ep_stats, local_stats_addr,
+                                                   sizeof(epoll_stats_t));
             g_lock_iomux.unlock();
-            return;
+            return ep_stats;
         }
     }
 
     vlog_printf(VLOG_INFO, "Statistics can monitor up to %d epoll fds\n", NUM_OF_SUPPORTED_EPFDS);
     g_lock_iomux.unlock();
-    return;
+    return local_stats_addr;
 }
 
-void xlio_stats_instance_remove_epoll_block(iomux_func_stats_t *local_stats_addr)
+epoll_stats_t *xlio_stats_instance_remove_epoll_block(epoll_stats_t *ep_stats)
 {
     g_lock_iomux.lock();
-    iomux_func_stats_t *ep_func_stats =
-        (iomux_func_stats_t *)g_p_stats_data_reader->pop_data_reader(local_stats_addr);
+    epoll_stats_t *p_local_stats =
+        (epoll_stats_t *)g_p_stats_data_reader->pop_data_reader(ep_stats);
 
-    if (NULL == ep_func_stats) {
+    if (NULL == p_local_stats) {
         __log_dbg("application xlio_stats pointer is NULL");
         g_lock_iomux.unlock();
-        return;
+        return ep_stats;
     }
 
     // Search ep_mem block to release
     for (int i = 0; i < NUM_OF_SUPPORTED_EPFDS; i++) {
-        if (&g_sh_mem->iomux.epoll[i].stats == ep_func_stats) {
-            g_sh_mem->iomux.epoll[i].enabled = false;
+        if (&g_sh_mem->iomux.epoll[i] == ep_stats) {
+            shm_block_detach(g_sh_mem->iomux.epoll[i].enabled, g_sh_mem->iomux.epoll[i].seq);
             g_lock_iomux.unlock();
-            return;
+            return p_local_stats;
         }
     }
 
     vlog_printf(VLOG_ERROR, "%s:%d: Could not find user pointer (%p)\n", __func__, __LINE__,
-                ep_func_stats);
+                ep_stats);
     g_lock_iomux.unlock();
-    return;
+    return p_local_stats;
+}
+
+trace_shm_t *xlio_trace_open(uint32_t capacity)
+{
+    int ret;
+    mode_t saved_mode;
+    trace_shm_t *p_trace;
+    const char *dir_path = safe_mce_sys().stats_shmem_dirname;
+
+    if (!capacity || strlen(dir_path) == 0) {
+        return NULL;
+    }
+
+    if ((mkdir(dir_path, 0777) != 0) && (errno != EEXIST)) {
+        vlog_printf(VLOG_DEBUG, "Failed to create folder %s (errno = %d)\n", dir_path, errno);
+        return NULL;
+    }
+
+    ret = snprintf(g_trace_info.filename_sh_stats, sizeof(g_trace_info.filename_sh_stats),
+                   "%s/xliotrace.%d", dir_path, getpid());
+    if (!((0 < ret) && (ret < (int)sizeof(g_trace_info.filename_sh_stats)))) {
+        vlog_printf(VLOG_ERROR, "%s: Could not create file under %s %s\n", __func__, dir_path,
+                    strerror(errno));
+        return NULL;
+    }
+
+    g_trace_info.shmem_size = TRACE_SHM_SIZE(capacity);
+    saved_mode = umask(0);
+    g_trace_info.fd_sh_stats = open(g_trace_info.filename_sh_stats, O_CREAT | O_TRUNC | O_RDWR,
+                                    S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    umask(saved_mode);
+
+    BULLSEYE_EXCLUDE_BLOCK_START
+    if (g_trace_info.fd_sh_stats < 0) {
+        vlog_printf(VLOG_ERROR, "%s: Could not open %s %s\n", __func__,
+                    g_trace_info.filename_sh_stats, strerror(errno));
+        return NULL;
+    }
+    if (ftruncate(g_trace_info.fd_sh_stats, g_trace_info.shmem_size) != 0) {
+        vlog_printf(VLOG_ERROR, "%s: Could not resize %s - %s\n", __func__,
+                    g_trace_info.filename_sh_stats, strerror(errno));
+        goto trace_error;
+    }
+    g_trace_info.p_sh_stats = mmap(0, g_trace_info.shmem_size, PROT_WRITE | PROT_READ, MAP_SHARED,
+                                   g_trace_info.fd_sh_stats, 0);
+    if (g_trace_info.p_sh_stats == MAP_FAILED) {
+        vlog_printf(VLOG_ERROR, "%s: MAP_FAILED for %s - %s\n", __func__,
+                    g_trace_info.filename_sh_stats, strerror(errno));
+        goto trace_error;
+    }
+    BULLSEYE_EXCLUDE_BLOCK_END
+
+    p_trace = (trace_shm_t *)g_trace_info.p_sh_stats;
+    memcpy(p_trace->stats_protocol_ver, STATS_PROTOCOL_VER,
+           std::min(sizeof(p_trace->stats_protocol_ver), sizeof(STATS_PROTOCOL_VER)));
+    p_trace->tsc_per_second = get_tsc_rate_per_second();
+    p_trace->capacity = capacity;
+    p_trace->n_threads = 0;
+    __log_dbg("file '%s' fd %d trace rings at %p with %u events per thread",
+              g_trace_info.filename_sh_stats, g_trace_info.fd_sh_stats, g_trace_info.p_sh_stats,
+              capacity);
+    return p_trace;
+
+trace_error:
+    close(g_trace_info.fd_sh_stats);
+    unlink(g_trace_info.filename_sh_stats);
+    g_trace_info.fd_sh_stats = -1;
+    return NULL;
+}
+
+void xlio_trace_close()
+{
+    if (g_trace_info.p_sh_stats == MAP_FAILED) {
+        return;
+    }
+
+    /* Other threads can still be writing to their rings, so the mapping is never released.
+     * A forked child detaches from the parent's file and opens a trace file of its own.
+     */
+    if (g_is_forked_child) {
+        if (mmap(g_trace_info.p_sh_stats, g_trace_info.shmem_size, PROT_WRITE | PROT_READ,
+                 MAP_PRIVATE | MAP_FIXED, g_trace_info.fd_sh_stats, 0) == MAP_FAILED) {
+            vlog_printf(VLOG_ERROR, "%s: failed to detach parent trace rings (errno=%d)\n",
+                        __func__, errno);
+        }
+    } else {
+        unlink(g_trace_info.filename_sh_stats);
+    }
+    close(g_trace_info.fd_sh_stats);
+    g_trace_info.fd_sh_stats = -1;
+    g_trace_info.p_sh_stats = MAP_FAILED;
 }
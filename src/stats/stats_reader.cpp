@@ -58,6 +58,7 @@
 #include <list>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 
 #include "utils/rdtsc.h"
 #include "core/util/utils.h"
@@ -78,6 +79,7 @@ typedef struct {
 typedef enum { e_K = 1024, e_M = 1048576 } units_t;
 
 #define MODULE_NAME                   "xliostat"
+#define TRACE_MODULE_NAME             "xliotrace"
 #define PRODUCT_NAME                  "XLIO"
 #define log_msg(log_fmt, log_args...) printf(MODULE_NAME ": " log_fmt "\n", ##log_args)
 #define log_err(log_fmt, log_args...) fprintf(stderr, MODULE_NAME ": " log_fmt "\n", ##log_args)
@@ -180,10 +182,27 @@ void usage(const char *argv0)
     printf("  -s, --sockets=<list|range>\tLog only sockets that match <list> or <range>, format: "
            "4-16 or 1,9 (or combination)\n");
     printf("  -C, --csv_file=<file path>\tA path to the statics CSV file\n");
+    printf("  -t, --trace=<file path>\tExport hot-path trace events (XLIO_TRACE_EVENTS) to a "
+           "Chrome trace JSON file and exit\n");
+    printf("  -L, --locks=<n>\t\tShow the <n> most contended locks (XLIO_STATS_LOCKS) on every "
+           "report\n");
     printf("  -V, --version\t\t\tPrint version\n");
     printf("  -h, --help\t\t\tPrint this help message\n");
 }
 
+// Histogram deltas are samples of the last interval, the maximum is kept since start
+void update_delta_lat_hist(lat_hist_t *p_curr_hist, lat_hist_t *p_prev_hist, int num)
+{
+    for (int i = 0; i < num; i++) {
+        p_prev_hist[i].n_samples = p_curr_hist[i].n_samples - p_prev_hist[i].n_samples;
+        p_prev_hist[i].n_sum = p_curr_hist[i].n_sum - p_prev_hist[i].n_sum;
+        p_prev_hist[i].n_max = p_curr_hist[i].n_max;
+        for (int j = 0; j < LAT_HIST_BUCKETS; j++) {
+            p_prev_hist[i].buckets[j] = p_curr_hist[i].buckets[j] - p_prev_hist[i].buckets[j];
+        }
+    }
+}
+
 void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
 {
     int delay = user_params.interval;
@@ -231,6 +250,16 @@ void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
         (p_curr_stat->counters.n_rx_poll_miss - p_prev_stat->counters.n_rx_poll_miss) / delay;
     p_prev_stat->counters.n_rx_poll_hit =
         (p_curr_stat->counters.n_rx_poll_hit - p_prev_stat->counters.n_rx_poll_hit) / delay;
+    p_prev_stat->counters.n_rx_adaptive_spin =
+        (p_curr_stat->counters.n_rx_adaptive_spin - p_prev_stat->counters.n_rx_adaptive_spin) /
+        delay;
+    p_prev_stat->counters.n_rx_adaptive_yield =
+        (p_curr_stat->counters.n_rx_adaptive_yield - p_prev_stat->counters.n_rx_adaptive_yield) /
+        delay;
+    p_prev_stat->counters.n_rx_adaptive_block =
+        (p_curr_stat->counters.n_rx_adaptive_block - p_prev_stat->counters.n_rx_adaptive_block) /
+        delay;
+    p_prev_stat->n_rx_adaptive_wait_usec = p_curr_stat->n_rx_adaptive_wait_usec;
     p_prev_stat->n_rx_ready_byte_count = p_curr_stat->n_rx_ready_byte_count;
     p_prev_stat->n_tx_ready_byte_count = p_curr_stat->n_tx_ready_byte_count;
     p_prev_stat->counters.n_rx_ready_byte_max = p_curr_stat->counters.n_rx_ready_byte_max;
@@ -318,6 +347,7 @@ void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
     p_prev_stat->listen_counters.n_conn_dropped = (p_curr_stat->listen_counters.n_conn_dropped -
                                                    p_prev_stat->listen_counters.n_conn_dropped) /
         delay;
+    update_delta_lat_hist(p_curr_stat->lat_hist, p_prev_stat->lat_hist, LAT_SOCKET_NUM);
 }
 
 void update_delta_iomux_stat(iomux_func_stats_t *p_curr_stats, iomux_func_stats_t *p_prev_stats)
@@ -336,6 +366,12 @@ void update_delta_iomux_stat(iomux_func_stats_t *p_curr_stats, iomux_func_stats_
             (p_curr_stats->n_iomux_rx_ready - p_prev_stats->n_iomux_rx_ready) / delay;
         p_prev_stats->n_iomux_timeouts =
             (p_curr_stats->n_iomux_timeouts - p_prev_stats->n_iomux_timeouts) / delay;
+        p_prev_stats->n_iomux_adaptive_spin =
+            (p_curr_stats->n_iomux_adaptive_spin - p_prev_stats->n_iomux_adaptive_spin) / delay;
+        p_prev_stats->n_iomux_adaptive_yield =
+            (p_curr_stats->n_iomux_adaptive_yield - p_prev_stats->n_iomux_adaptive_yield) / delay;
+        p_prev_stats->n_iomux_adaptive_block =
+            (p_curr_stats->n_iomux_adaptive_block - p_prev_stats->n_iomux_adaptive_block) / delay;
         p_prev_stats->threadid_last = p_curr_stats->threadid_last;
     }
 }
@@ -354,6 +390,12 @@ void update_delta_ring_stat(ring_stats_t *p_curr_ring_stats, ring_stats_t *p_pre
             (p_curr_ring_stats->n_tx_pkt_count - p_prev_ring_stats->n_tx_pkt_count) / delay;
         p_prev_ring_stats->n_tx_retransmits =
             (p_curr_ring_stats->n_tx_retransmits - p_prev_ring_stats->n_tx_retransmits) / delay;
+        p_prev_ring_stats->n_tx_txtime_queued =
+            (p_curr_ring_stats->n_tx_txtime_queued - p_prev_ring_stats->n_tx_txtime_queued) /
+            delay;
+        p_prev_ring_stats->n_tx_txtime_dropped =
+            (p_curr_ring_stats->n_tx_txtime_dropped - p_prev_ring_stats->n_tx_txtime_dropped) /
+            delay;
         p_prev_ring_stats->simple.n_tx_dropped_wqes =
             (p_curr_ring_stats->simple.n_tx_dropped_wqes -
              p_prev_ring_stats->simple.n_tx_dropped_wqes) /
@@ -372,6 +414,21 @@ void update_delta_ring_stat(ring_stats_t *p_curr_ring_stats, ring_stats_t *p_pre
             p_prev_ring_stats->tap.n_rx_buffers = p_curr_ring_stats->tap.n_rx_buffers;
             p_prev_ring_stats->tap.n_vf_plugouts =
                 (p_curr_ring_stats->tap.n_vf_plugouts - p_prev_ring_stats->tap.n_vf_plugouts);
+        } else if (p_prev_ring_stats->n_type == RING_XDP) {
+            memcpy(p_prev_ring_stats->xdp.s_if_name, p_curr_ring_stats->xdp.s_if_name,
+                   sizeof(p_curr_ring_stats->xdp.s_if_name));
+            p_prev_ring_stats->xdp.n_xsk_fd = p_curr_ring_stats->xdp.n_xsk_fd;
+            p_prev_ring_stats->xdp.n_queue_id = p_curr_ring_stats->xdp.n_queue_id;
+            p_prev_ring_stats->xdp.n_rx_buffers = p_curr_ring_stats->xdp.n_rx_buffers;
+            p_prev_ring_stats->xdp.n_tx_free_frames = p_curr_ring_stats->xdp.n_tx_free_frames;
+            p_prev_ring_stats->xdp.n_rx_dropped =
+                (p_curr_ring_stats->xdp.n_rx_dropped - p_prev_ring_stats->xdp.n_rx_dropped) /
+                delay;
+            p_prev_ring_stats->xdp.n_tx_dropped =
+                (p_curr_ring_stats->xdp.n_tx_dropped - p_prev_ring_stats->xdp.n_tx_dropped) /
+                delay;
+            p_prev_ring_stats->xdp.n_wakeups =
+                (p_curr_ring_stats->xdp.n_wakeups - p_prev_ring_stats->xdp.n_wakeups) / delay;
         } else {
             p_prev_ring_stats->simple.n_rx_interrupt_received =
                 (p_curr_ring_stats->simple.n_rx_interrupt_received -
@@ -456,17 +513,62 @@ void update_delta_global_stat(global_stats_t *p_curr_global_stats,
             (p_curr_global_stats->n_tcp_seg_pool_no_segs -
              p_prev_global_stats->n_tcp_seg_pool_no_segs) /
             delay;
+        p_prev_global_stats->mapping_cache.n_hits =
+            (p_curr_global_stats->mapping_cache.n_hits -
+             p_prev_global_stats->mapping_cache.n_hits) /
+            delay;
+        p_prev_global_stats->mapping_cache.n_misses =
+            (p_curr_global_stats->mapping_cache.n_misses -
+             p_prev_global_stats->mapping_cache.n_misses) /
+            delay;
+        p_prev_global_stats->mapping_cache.n_evicts =
+            (p_curr_global_stats->mapping_cache.n_evicts -
+             p_prev_global_stats->mapping_cache.n_evicts) /
+            delay;
+        p_prev_global_stats->mapping_cache.n_readaheads =
+            (p_curr_global_stats->mapping_cache.n_readaheads -
+             p_prev_global_stats->mapping_cache.n_readaheads) /
+            delay;
         p_prev_global_stats->n_pending_sockets =
             (p_curr_global_stats->n_pending_sockets - p_prev_global_stats->n_pending_sockets) /
             delay;
         p_prev_global_stats->socket_tcp_destructor_counter =
-            (p_curr_global_stats->socket_tcp_destructor_counter.load() -
-             p_prev_global_stats->socket_tcp_destructor_counter.load()) /
+            (p_curr_global_stats->socket_tcp_destructor_counter -
+             p_prev_global_stats->socket_tcp_destructor_counter) /
             delay;
         p_prev_global_stats->socket_udp_destructor_counter =
-            (p_curr_global_stats->socket_udp_destructor_counter.load() -
-             p_prev_global_stats->socket_udp_destructor_counter.load()) /
+            (p_curr_global_stats->socket_udp_destructor_counter -
+             p_prev_global_stats->socket_udp_destructor_counter) /
+            delay;
+        p_prev_global_stats->n_tcp_timer_ticks =
+            (p_curr_global_stats->n_tcp_timer_ticks -
+             p_prev_global_stats->n_tcp_timer_ticks) /
             delay;
+        p_prev_global_stats->n_tcp_timer_sockets =
+            (p_curr_global_stats->n_tcp_timer_sockets -
+             p_prev_global_stats->n_tcp_timer_sockets) /
+            delay;
+        update_delta_lat_hist(p_curr_global_stats->lat_hist, p_prev_global_stats->lat_hist,
+                              LAT_GLOBAL_NUM);
+    }
+}
+
+void update_delta_lock_stats(lock_stats_block_t *p_curr_lock_stats,
+                             lock_stats_block_t *p_prev_lock_stats)
+{
+    int delay = user_params.interval;
+    p_prev_lock_stats->n_locks = p_curr_lock_stats->n_locks;
+    p_prev_lock_stats->n_names_dropped = p_curr_lock_stats->n_names_dropped;
+    p_prev_lock_stats->hold_sample_rate = p_curr_lock_stats->hold_sample_rate;
+    for (int i = 0; i < NUM_OF_SUPPORTED_LOCKS; i++) {
+        lock_stats_t *p_curr = &p_curr_lock_stats->locks[i];
+        lock_stats_t *p_prev = &p_prev_lock_stats->locks[i];
+        memcpy(p_prev->name, p_curr->name, sizeof(p_prev->name));
+        p_prev->n_instances = p_curr->n_instances;
+        p_prev->n_acquired = (p_curr->n_acquired - p_prev->n_acquired) / delay;
+        p_prev->n_contended = (p_curr->n_contended - p_prev->n_contended) / delay;
+        update_delta_lat_hist(&p_curr->wait_hist, &p_prev->wait_hist, 1);
+        update_delta_lat_hist(&p_curr->hold_hist, &p_prev->hold_hist, 1);
     }
 }
 
@@ -502,7 +604,14 @@ void print_ring_stats(ring_instance_block_t *p_ring_inst_arr)
                        post_fix);
             }
 
-            if (p_ring_stats->simple.n_tx_dropped_wqes) {
+            if (p_ring_stats->n_tx_txtime_queued || p_ring_stats->n_tx_txtime_dropped) {
+                printf(FORMAT_STATS_64bit, "TX Launch Time Queued:",
+                       p_ring_stats->n_tx_txtime_queued, post_fix);
+                printf(FORMAT_STATS_64bit, "TX Launch Time Dropped:",
+                       p_ring_stats->n_tx_txtime_dropped, post_fix);
+            }
+
+            if (p_ring_stats->n_type == RING_ETH && p_ring_stats->simple.n_tx_dropped_wqes) {
                 printf(FORMAT_STATS_64bit,
                        "TX Dropped Send Reqs:", p_ring_stats->simple.n_tx_dropped_wqes, post_fix);
             }
@@ -527,6 +636,22 @@ void print_ring_stats(ring_instance_block_t *p_ring_inst_arr)
                 }
                 printf(FORMAT_STATS_32bit, "Tap fd:", p_ring_stats->tap.n_tap_fd);
                 printf(FORMAT_RING_TAP_NAME, "Tap Device:", p_ring_stats->tap.s_tap_name);
+            } else if (p_ring_stats->n_type == RING_XDP) {
+                printf(FORMAT_RING_TAP_NAME, "XDP Device:", p_ring_stats->xdp.s_if_name);
+                printf(FORMAT_STATS_32bit, "XDP Queue:", p_ring_stats->xdp.n_queue_id);
+                printf(FORMAT_STATS_32bit, "XSK fd:", p_ring_stats->xdp.n_xsk_fd);
+                printf(FORMAT_STATS_32bit, "Rx Buffers:", p_ring_stats->xdp.n_rx_buffers);
+                printf(FORMAT_STATS_32bit, "Tx Free Frames:", p_ring_stats->xdp.n_tx_free_frames);
+                if (p_ring_stats->xdp.n_rx_dropped) {
+                    printf(FORMAT_STATS_64bit, "Rx Dropped:", p_ring_stats->xdp.n_rx_dropped,
+                           post_fix);
+                }
+                if (p_ring_stats->xdp.n_tx_dropped) {
+                    printf(FORMAT_STATS_64bit, "Tx Dropped:", p_ring_stats->xdp.n_tx_dropped,
+                           post_fix);
+                }
+                printf(FORMAT_STATS_64bit, "Kernel Wakeups:", p_ring_stats->xdp.n_wakeups,
+                       post_fix);
             } else {
                 if (p_ring_stats->simple.n_rx_interrupt_requests ||
                     p_ring_stats->simple.n_rx_interrupt_received) {
@@ -632,6 +757,13 @@ void print_bpool_stats(bpool_instance_block_t *p_bpool_inst_arr)
             if (p_bpool_stats->n_buffer_pool_expands) {
                 printf(FORMAT_STATS_32bit, "Expands:", p_bpool_stats->n_buffer_pool_expands);
             }
+            if (p_bpool_stats->n_buffer_pool_reclaims) {
+                printf(FORMAT_STATS_32bit, "Reclaims:", p_bpool_stats->n_buffer_pool_reclaims);
+            }
+            if (p_bpool_stats->n_buffer_pool_registered) {
+                printf(FORMAT_STATS_64bit, "Registered memory:",
+                       p_bpool_stats->n_buffer_pool_registered / 1024U, "KB");
+            }
         }
     }
     printf("======================================================\n");
@@ -655,17 +787,80 @@ void print_global_stats(global_instance_block_t *p_global_inst_arr)
             printf(FORMAT_STATS_32bit,
                    "No segments error:", p_global_stats->n_tcp_seg_pool_no_segs);
             printf("======================================================\n");
+            printf("\tZC_CACHE\n");
+            printf(FORMAT_STATS_32bit, "Hits:", p_global_stats->mapping_cache.n_hits);
+            printf(FORMAT_STATS_32bit, "Misses:", p_global_stats->mapping_cache.n_misses);
+            printf(FORMAT_STATS_32bit, "Evictions:", p_global_stats->mapping_cache.n_evicts);
+            printf(FORMAT_STATS_32bit, "Readaheads:", p_global_stats->mapping_cache.n_readaheads);
+            printf("======================================================\n");
             printf("\tGLOBAL\n");
             printf(FORMAT_STATS_s_32bit, "Pending sockets:", p_global_stats->n_pending_sockets);
             printf(FORMAT_STATS_s_32bit,
-                   "Destructed TCP sockets:", p_global_stats->socket_tcp_destructor_counter.load());
+                   "Destructed TCP sockets:", p_global_stats->socket_tcp_destructor_counter);
             printf(FORMAT_STATS_s_32bit,
-                   "Destructed UDP sockets:", p_global_stats->socket_udp_destructor_counter.load());
+                   "Destructed UDP sockets:", p_global_stats->socket_udp_destructor_counter);
+            printf(FORMAT_STATS_64bit, "TCP timer ticks:", p_global_stats->n_tcp_timer_ticks,
+                   post_fix);
+            printf(FORMAT_STATS_64bit,
+                   "TCP timer sockets:", p_global_stats->n_tcp_timer_sockets, post_fix);
+            print_lat_hist_stats(p_global_stats->lat_hist, LAT_GLOBAL_NUM, stdout);
         }
     }
     printf("======================================================\n");
 }
 
+// Locks ordered by the number of contended acquisitions, the top user_params.lock_top_n
+void print_lock_stats(lock_stats_block_t *p_lock_stats)
+{
+    uint32_t n_locks = std::min<uint32_t>(p_lock_stats->n_locks, NUM_OF_SUPPORTED_LOCKS);
+    double usec_per_tick = 1e6 / (double)get_tsc_rate_per_second();
+    std::vector<lock_stats_t *> locks;
+    const char *post_fix = (user_params.print_details_mode == e_deltas) ? "/s" : "";
+
+    for (uint32_t i = 0; i < n_locks; i++) {
+        if (p_lock_stats->locks[i].n_acquired || p_lock_stats->locks[i].n_contended) {
+            locks.push_back(&p_lock_stats->locks[i]);
+        }
+    }
+    std::sort(locks.begin(), locks.end(), [](const lock_stats_t *a, const lock_stats_t *b) {
+        return (a->n_contended != b->n_contended) ? a->n_contended > b->n_contended
+                                                  : a->wait_hist.n_sum > b->wait_hist.n_sum;
+    });
+    if (locks.size() > (size_t)user_params.lock_top_n) {
+        locks.resize(user_params.lock_top_n);
+    }
+
+    printf("======================================================\n");
+    printf("\tLOCKS (top %d contended, hold time sampled 1/%u)\n", user_params.lock_top_n,
+           p_lock_stats->hold_sample_rate);
+    if (locks.empty()) {
+        printf("No lock activity, is XLIO_STATS_LOCKS enabled?\n");
+    } else {
+        printf("%-24s %5s %12s %12s %6s %9s %9s %9s %9s %9s\n", "Name", "Objs", "Acquired",
+               "Contended", "Cont%", "Wait p50", "Wait p99", "Wait max", "Hold p50", "Hold p99");
+    }
+    for (lock_stats_t *p_lock : locks) {
+        double contended_pct =
+            p_lock->n_acquired ? 100.0 * p_lock->n_contended / p_lock->n_acquired : 0;
+        printf("%-24.24s %5u %10" PRIu64 "%-2s %10" PRIu64 "%-2s %6.2f %9.2f %9.2f %9.2f %9.2f "
+               "%9.2f\n",
+               p_lock->name, p_lock->n_instances, p_lock->n_acquired, post_fix,
+               p_lock->n_contended, post_fix, contended_pct,
+               p_lock->wait_hist.percentile(50) * usec_per_tick,
+               p_lock->wait_hist.percentile(99) * usec_per_tick,
+               p_lock->wait_hist.n_max * usec_per_tick,
+               p_lock->hold_hist.percentile(50) * usec_per_tick,
+               p_lock->hold_hist.percentile(99) * usec_per_tick);
+    }
+    if (!locks.empty()) {
+        printf("%-24s (wait and hold times in usec)\n", "");
+    }
+    if (p_lock_stats->n_names_dropped) {
+        printf(FORMAT_STATS_32bit, "Untracked names:", p_lock_stats->n_names_dropped);
+    }
+    printf("======================================================\n");
+}
+
 void print_basic_stats(socket_stats_t *p_stats)
 {
     //
@@ -930,6 +1125,12 @@ void print_full_iomux_stats(const char *func_name, iomux_func_stats_t *p_iomux_s
             printf("Polls [miss/hit]%s: %u / %u (%2.2f%%)\n", post_fix,
                    p_iomux_stats->n_iomux_poll_miss, p_iomux_stats->n_iomux_poll_hit,
                    iomux_poll_hit_percentage);
+            if (p_iomux_stats->n_iomux_adaptive_spin || p_iomux_stats->n_iomux_adaptive_yield ||
+                p_iomux_stats->n_iomux_adaptive_block) {
+                printf("Adaptive poll [spin/yield/block]%s: %u / %u / %u\n", post_fix,
+                       p_iomux_stats->n_iomux_adaptive_spin, p_iomux_stats->n_iomux_adaptive_yield,
+                       p_iomux_stats->n_iomux_adaptive_block);
+            }
             if (p_iomux_stats->n_iomux_timeouts) {
                 printf("Timeouts%s: %u\n", post_fix, p_iomux_stats->n_iomux_timeouts);
             }
@@ -1125,9 +1326,17 @@ void show_bpool_stats(bpool_instance_block_t *p_curr_bpool_blocks,
 void show_global_stats(global_instance_block_t *p_curr_global_blocks,
                        global_instance_block_t *p_prev_global_blocks)
 {
+    global_instance_block_t global_blocks[NUM_OF_SUPPORTED_GLOBALS];
+
     switch (user_params.print_details_mode) {
     case e_totals:
-        print_global_stats(p_curr_global_blocks);
+        // Thread counters are summed in a private copy, the shared memory is read only
+        if (stats_seq_read(global_blocks, p_curr_global_blocks, NUM_OF_SUPPORTED_GLOBALS)) {
+            for (int i = 0; i < NUM_OF_SUPPORTED_GLOBALS; i++) {
+                global_blocks[i].global_stats.aggregate();
+            }
+            print_global_stats(global_blocks);
+        }
         break;
     default:
         print_global_deltas(p_curr_global_blocks, p_prev_global_blocks);
@@ -1135,6 +1344,19 @@ void show_global_stats(global_instance_block_t *p_curr_global_blocks,
     }
 }
 
+void show_lock_stats(lock_stats_block_t *p_curr_lock_stats, lock_stats_block_t *p_prev_lock_stats)
+{
+    switch (user_params.print_details_mode) {
+    case e_totals:
+        print_lock_stats(p_curr_lock_stats);
+        break;
+    default:
+        update_delta_lock_stats(p_curr_lock_stats, p_prev_lock_stats);
+        print_lock_stats(p_prev_lock_stats);
+        break;
+    }
+}
+
 void show_basic_iomux_stats(iomux_stats_t *p_curr_stats, iomux_stats_t *p_prev_stats,
                             int *p_printed_lines_num)
 {
@@ -1342,6 +1564,7 @@ void set_defaults()
     user_params.fd_dump = 0;
     user_params.fd_dump_log_level = STATS_FD_STATISTICS_LOG_LEVEL_DEFAULT;
     user_params.xlio_stats_path = MCE_DEFAULT_STATS_SHMEM_DIR;
+    user_params.lock_top_n = 0;
 
     alloc_fd_mask();
     if (g_fd_mask) {
@@ -1374,6 +1597,27 @@ bool check_if_process_running(int pid)
     return false;
 }
 
+// Snapshot of the blocks which are shown as deltas, false if the sample has to be skipped
+static bool read_delta_blocks(sh_mem_t *p_sh_mem, socket_instance_block_t *p_instance_blocks,
+                              cq_instance_block_t *p_cq_blocks,
+                              ring_instance_block_t *p_ring_blocks,
+                              bpool_instance_block_t *p_bpool_blocks,
+                              global_instance_block_t *p_global_blocks)
+{
+    bool consistent =
+        stats_seq_read(p_instance_blocks, p_sh_mem->skt_inst_arr, p_sh_mem->max_skt_inst_num);
+    consistent &= stats_seq_read(p_cq_blocks, p_sh_mem->cq_inst_arr, NUM_OF_SUPPORTED_CQS);
+    consistent &= stats_seq_read(p_ring_blocks, p_sh_mem->ring_inst_arr, NUM_OF_SUPPORTED_RINGS);
+    consistent &=
+        stats_seq_read(p_bpool_blocks, p_sh_mem->bpool_inst_arr, NUM_OF_SUPPORTED_BPOOLS);
+    consistent &=
+        stats_seq_read(p_global_blocks, p_sh_mem->global_inst_arr, NUM_OF_SUPPORTED_GLOBALS);
+    for (int i = 0; i < NUM_OF_SUPPORTED_GLOBALS; i++) {
+        p_global_blocks[i].global_stats.aggregate();
+    }
+    return consistent;
+}
+
 void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
 {
     int ret;
@@ -1394,6 +1638,8 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
     global_instance_block_t curr_global_blocks[NUM_OF_SUPPORTED_GLOBALS];
     iomux_stats_t prev_iomux_blocks;
     iomux_stats_t curr_iomux_blocks;
+    lock_stats_block_t *prev_lock_stats = NULL;
+    lock_stats_block_t *curr_lock_stats = NULL;
     socket_listen_counter_aggregate socket_counters {user_params.print_details_mode == e_deltas};
     tls_context_counters_show tls_counters {user_params.print_details_mode == e_deltas};
     global_counters_show global_counters {user_params.print_details_mode == e_deltas};
@@ -1429,6 +1675,13 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
            sizeof(socket_instance_block_t) * p_sh_mem->max_skt_inst_num);
     memset((void *)curr_instance_blocks, 0,
            sizeof(socket_instance_block_t) * p_sh_mem->max_skt_inst_num);
+    if (user_params.lock_top_n) {
+        prev_lock_stats = (lock_stats_block_t *)calloc(1, sizeof(*prev_lock_stats));
+        curr_lock_stats = (lock_stats_block_t *)calloc(1, sizeof(*curr_lock_stats));
+        if (NULL == prev_lock_stats || NULL == curr_lock_stats) {
+            goto out;
+        }
+    }
     memset((void *)prev_cq_blocks, 0, sizeof(cq_instance_block_t) * NUM_OF_SUPPORTED_CQS);
     memset((void *)curr_cq_blocks, 0, sizeof(cq_instance_block_t) * NUM_OF_SUPPORTED_CQS);
     memset((void *)prev_ring_blocks, 0, sizeof(ring_instance_block_t) * NUM_OF_SUPPORTED_RINGS);
@@ -1447,17 +1700,16 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
     memset(&curr_iomux_blocks, 0, sizeof(curr_iomux_blocks));
 
     if (user_params.print_details_mode == e_deltas) {
-        memcpy((void *)prev_instance_blocks, (void *)p_sh_mem->skt_inst_arr,
-               p_sh_mem->max_skt_inst_num * sizeof(socket_instance_block_t));
-        memcpy((void *)prev_cq_blocks, (void *)p_sh_mem->cq_inst_arr,
-               NUM_OF_SUPPORTED_CQS * sizeof(cq_instance_block_t));
-        memcpy((void *)prev_ring_blocks, (void *)p_sh_mem->ring_inst_arr,
-               NUM_OF_SUPPORTED_RINGS * sizeof(ring_instance_block_t));
-        memcpy((void *)prev_bpool_blocks, (void *)p_sh_mem->bpool_inst_arr,
-               NUM_OF_SUPPORTED_BPOOLS * sizeof(bpool_instance_block_t));
-        memcpy((void *)prev_global_blocks, (void *)p_sh_mem->global_inst_arr,
-               NUM_OF_SUPPORTED_GLOBALS * sizeof(global_instance_block_t));
+        // Deltas need a consistent base sample
+        while (!read_delta_blocks(p_sh_mem, prev_instance_blocks, prev_cq_blocks,
+                                  prev_ring_blocks, prev_bpool_blocks, prev_global_blocks) &&
+               !g_b_exit && check_if_process_running(pid)) {
+            usleep(STATS_PUBLISHER_TIMER_PERIOD * 1000);
+        }
         prev_iomux_blocks = curr_iomux_blocks;
+        if (prev_lock_stats) {
+            memcpy(prev_lock_stats, &p_sh_mem->lock_stats, sizeof(*prev_lock_stats));
+        }
         uint64_t delay_int_micro = SEC_TO_MICRO(user_params.interval);
         if (!g_b_exit && check_if_process_running(pid)) {
             usleep(delay_int_micro);
@@ -1480,17 +1732,19 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
         }
 
         if (user_params.print_details_mode == e_deltas) {
-            memcpy((void *)curr_instance_blocks, (void *)p_sh_mem->skt_inst_arr,
-                   p_sh_mem->max_skt_inst_num * sizeof(socket_instance_block_t));
-            memcpy((void *)curr_cq_blocks, (void *)p_sh_mem->cq_inst_arr,
-                   NUM_OF_SUPPORTED_CQS * sizeof(cq_instance_block_t));
-            memcpy((void *)curr_ring_blocks, (void *)p_sh_mem->ring_inst_arr,
-                   NUM_OF_SUPPORTED_RINGS * sizeof(ring_instance_block_t));
-            memcpy((void *)curr_bpool_blocks, (void *)p_sh_mem->bpool_inst_arr,
-                   NUM_OF_SUPPORTED_BPOOLS * sizeof(bpool_instance_block_t));
-            memcpy((void *)curr_global_blocks, (void *)p_sh_mem->global_inst_arr,
-                   NUM_OF_SUPPORTED_GLOBALS * sizeof(global_instance_block_t));
+            bool consistent = read_delta_blocks(p_sh_mem, curr_instance_blocks, curr_cq_blocks,
+                                                curr_ring_blocks, curr_bpool_blocks,
+                                                curr_global_blocks);
             curr_iomux_blocks = p_sh_mem->iomux;
+            consistent &= stats_seq_read(curr_iomux_blocks.epoll, p_sh_mem->iomux.epoll,
+                                         NUM_OF_SUPPORTED_EPFDS);
+            if (!consistent) {
+                // A block was being reset all the time, the previous sample stays the base
+                goto next_sample;
+            }
+        }
+        if (curr_lock_stats) {
+            memcpy(curr_lock_stats, &p_sh_mem->lock_stats, sizeof(*curr_lock_stats));
         }
 
         if (user_params.csv_stream.is_open()) {
@@ -1555,6 +1809,10 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
         default:
             break;
         }
+        if (curr_lock_stats) {
+            show_lock_stats(curr_lock_stats, prev_lock_stats);
+            memcpy(prev_lock_stats, curr_lock_stats, sizeof(*prev_lock_stats));
+        }
         if (user_params.view_mode == e_netstat_like) {
             break;
         }
@@ -1562,6 +1820,7 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
             printf(CYCLES_SEPARATOR);
             printed_line_num++;
         }
+    next_sample:
         if (gettime(&end)) {
             log_system_err("gettime()");
             goto out;
@@ -1583,6 +1842,8 @@ void stats_reader_handler(sh_mem_t *p_sh_mem, int pid)
 out:
     free(prev_instance_blocks);
     free(curr_instance_blocks);
+    free(prev_lock_stats);
+    free(curr_lock_stats);
 }
 
 bool check_if_app_match(char *app_name, char *pid_str)
@@ -1613,6 +1874,7 @@ void clean_inactive_sh_ibj()
     struct dirent *dirent;
     int module_name_size = strlen(MODULE_NAME);
     int pid_offset = module_name_size + 1;
+    int trace_name_size = strlen(TRACE_MODULE_NAME ".");
 
     dir = opendir(user_params.xlio_stats_path.c_str());
     if (dir == NULL) {
@@ -1634,6 +1896,15 @@ void clean_inactive_sh_ibj()
                     unlink(to_delete);
                 }
             }
+        } else if (!strncmp(TRACE_MODULE_NAME ".", dirent->d_name, trace_name_size)) {
+            if (!check_if_process_running(dirent->d_name + trace_name_size)) {
+                char to_delete[PATH_MAX + 1] = {0};
+                int n = snprintf(to_delete, sizeof(to_delete), "%s/%s",
+                                 user_params.xlio_stats_path.c_str(), dirent->d_name);
+                if (likely((0 < n) && (n < (int)sizeof(to_delete)))) {
+                    unlink(to_delete);
+                }
+            }
         }
         dirent = readdir(dir);
     }
@@ -1776,12 +2047,18 @@ void zero_ring_stats(ring_stats_t *p_ring_stats)
     p_ring_stats->n_tx_pkt_count = 0;
     p_ring_stats->n_tx_byte_count = 0;
     p_ring_stats->n_tx_retransmits = 0;
+    p_ring_stats->n_tx_txtime_queued = 0;
+    p_ring_stats->n_tx_txtime_dropped = 0;
 #ifdef DEFINED_UTLS
     p_ring_stats->n_tx_tls_contexts = 0;
     p_ring_stats->n_rx_tls_contexts = 0;
 #endif /* DEFINED_UTLS */
     if (p_ring_stats->n_type == RING_TAP) {
         p_ring_stats->tap.n_vf_plugouts = 0;
+    } else if (p_ring_stats->n_type == RING_XDP) {
+        p_ring_stats->xdp.n_rx_dropped = 0;
+        p_ring_stats->xdp.n_tx_dropped = 0;
+        p_ring_stats->xdp.n_wakeups = 0;
     } else {
         p_ring_stats->simple.n_rx_interrupt_received = 0;
         p_ring_stats->simple.n_rx_interrupt_requests = 0;
@@ -1825,6 +2102,103 @@ void zero_counters(sh_mem_t *p_sh_mem)
     }
 }
 
+static const char *trace_event_names[TRACE_EVENT_NUM] = {"cq_poll", "lwip_input", "lwip_output",
+                                                         "timer_tick", "epoll_wakeup"};
+
+void write_trace_events(const trace_shm_t *p_trace, int pid, FILE *file)
+{
+    uint32_t n_rings = std::min<uint32_t>(p_trace->n_threads, TRACE_MAX_THREADS);
+    double usec_per_tick = 1000000.0 / (double)p_trace->tsc_per_second;
+    std::vector<std::vector<trace_event_t>> rings(n_rings);
+    uint64_t base_tsc = UINT64_MAX;
+
+    for (uint32_t i = 0; i < n_rings; i++) {
+        rings[i].resize(p_trace->capacity);
+        uint32_t n = trace_ring_snapshot(&p_trace->rings[i], p_trace->ring_events(i),
+                                         p_trace->capacity, rings[i].data());
+        rings[i].resize(n);
+        if (n) {
+            base_tsc = std::min(base_tsc, rings[i][0].tsc);
+        }
+    }
+
+    const char *sep = "";
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (uint32_t i = 0; i < n_rings; i++) {
+        pid_t tid = p_trace->rings[i].tid;
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                      "\"args\":{\"name\":\"thread %d\"}}",
+                sep, pid, tid, tid);
+        sep = ",\n";
+        for (const trace_event_t &ev : rings[i]) {
+            const char *name = (ev.type < TRACE_EVENT_NUM) ? trace_event_names[ev.type] : "unknown";
+            fprintf(file,
+                    "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,"
+                    "\"tid\":%d,\"args\":{\"arg\":%u}}",
+                    sep, name, (double)(ev.tsc - base_tsc) * usec_per_tick,
+                    (double)ev.dur * usec_per_tick, pid, tid, ev.arg);
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+int export_trace(int pid)
+{
+    char filename[PATH_MAX];
+    struct stat st;
+    int ret = 1;
+
+    snprintf(filename, sizeof(filename), "%s/" TRACE_MODULE_NAME ".%d",
+             user_params.xlio_stats_path.c_str(), pid);
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        log_err(PRODUCT_NAME " trace data for process id %d not found (XLIO_TRACE_EVENTS is not "
+                             "set?)\n",
+                pid);
+        return 1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_shm_t)) {
+        log_err("Invalid trace file %s\n", filename);
+        close(fd);
+        return 1;
+    }
+
+    void *p_map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p_map == MAP_FAILED) {
+        log_system_err("MAP_FAILED - %s\n", strerror(errno));
+        close(fd);
+        return 1;
+    }
+
+    const trace_shm_t *p_trace = (const trace_shm_t *)p_map;
+    uint32_t capacity = p_trace->capacity;
+    FILE *file = NULL;
+    if (sizeof(STATS_PROTOCOL_VER) > 1 &&
+        memcmp(p_trace->stats_protocol_ver, STATS_PROTOCOL_VER,
+               min(sizeof(p_trace->stats_protocol_ver), sizeof(STATS_PROTOCOL_VER)))) {
+        log_err("Version %s is not compatible with stats protocol version %s\n",
+                STATS_PROTOCOL_VER, p_trace->stats_protocol_ver);
+    } else if (!capacity || (capacity & (capacity - 1)) || !p_trace->tsc_per_second ||
+               TRACE_SHM_SIZE(capacity) > (size_t)st.st_size) {
+        log_err("Invalid trace file %s\n", filename);
+    } else if (!(file = fopen(user_params.trace_file.c_str(), "w"))) {
+        log_system_err("Unable to open file: %s\n", user_params.trace_file.c_str());
+    } else {
+        write_trace_events(p_trace, pid, file);
+        fclose(file);
+        if (p_trace->n_threads > TRACE_MAX_THREADS) {
+            printf("%u threads were not traced, only %d threads are supported\n",
+                   p_trace->n_threads - TRACE_MAX_THREADS, TRACE_MAX_THREADS);
+        }
+        printf("Trace of process %d was written to %s\n", pid, user_params.trace_file.c_str());
+        ret = 0;
+    }
+
+    munmap(p_map, st.st_size);
+    close(fd);
+    return ret;
+}
+
 int get_pid(char *proc_desc, char *argv0)
 {
     char *app_name = NULL;
@@ -1919,9 +2293,11 @@ int main(int argc, char **argv)
                                                {"forbid_clean", 0, NULL, 'F'},
                                                {"help", 0, NULL, 'h'},
                                                {"csv_file", 1, NULL, 'C'},
+                                               {"trace", 1, NULL, 't'},
+                                               {"locks", 1, NULL, 'L'},
                                                {0, 0, 0, 0}};
 
-        if ((c = getopt_long(argc, argv, "i:c:v:d:p:k:s:Vzl:S:C:D:n:fFh?", long_options,
+        if ((c = getopt_long(argc, argv, "i:c:v:d:p:k:s:Vzl:S:C:D:n:t:L:fFh?", long_options,
                              &option_index)) == -1) {
             break;
         }
@@ -2054,6 +2430,20 @@ int main(int argc, char **argv)
                 return 1;
             }
         } break;
+        case 't':
+            user_params.trace_file = std::string((char *)optarg);
+            break;
+        case 'L': {
+            errno = 0;
+            int top_n = strtol(optarg, NULL, 0);
+            if (errno != 0 || top_n <= 0) {
+                log_err("'-%c' Invalid number of locks: %s", c, optarg);
+                usage(argv[0]);
+                cleanup(NULL);
+                return 1;
+            }
+            user_params.lock_top_n = std::min(top_n, NUM_OF_SUPPORTED_LOCKS);
+        } break;
         case 'D': {
             errno = 0;
             int details_level = 0;
@@ -2092,6 +2482,13 @@ int main(int argc, char **argv)
 
     clean_inactive_sh_ibj();
 
+    if (!user_params.trace_file.empty()) {
+        int pid = get_pid(proc_desc, argv[0]);
+        int ret = (pid != -1) ? export_trace(pid) : 1;
+        free(g_fd_mask);
+        return ret;
+    }
+
     std::vector<int> pids;
     if (user_params.view_mode == e_netstat_like) {
         get_all_processes_pids(pids);
@@ -74,11 +74,97 @@
 #define LOCK_BASE_END_LOCK_WAIT   end_lock_wait(timeval);
 #endif
 
+/*
+ * Lock contention profiler (XLIO_STATS_LOCKS).
+ * Every named lock resolves its name to an entry of the shared memory lock table at the
+ * first acquisition after the profiler is enabled. Uncontended acquisitions cost a trylock
+ * and per thread counters; the TSC is read only for contended waits and sampled holds.
+ */
+#define LOCK_STATS_SLOT_UNKNOWN (-2)
+#define LOCK_STATS_SLOT_NONE    (-1)
+
+extern bool g_b_lock_stats;
+
+// Pairs with the release stores of lock_stats_init() and lock_stats_fini()
+static inline bool lock_stats_enabled()
+{
+    return __atomic_load_n(&g_b_lock_stats, __ATOMIC_ACQUIRE);
+}
+
+int lock_stats_get_slot(const char *name);
+// Returns true if the hold time of this acquisition should be measured
+bool lock_stats_acquired(int slot, tscval_t wait);
+void lock_stats_released(int slot, tscval_t hold);
+
+class lock_profiler {
+protected:
+    lock_profiler()
+        : m_stats_slot(LOCK_STATS_SLOT_UNKNOWN)
+        , m_hold_start(0)
+    {
+    }
+
+    template <typename TRYLOCK, typename LOCK>
+    inline int lock_profiled(const char *name, TRYLOCK trylock_fn, LOCK lock_fn)
+    {
+        int slot = __atomic_load_n(&m_stats_slot, __ATOMIC_RELAXED);
+        if (unlikely(slot < 0)) {
+            int ret = lock_fn();
+            // Resolve under the lock, so the entry counts every lock object once
+            if (slot == LOCK_STATS_SLOT_UNKNOWN && ret == 0) {
+                __atomic_store_n(&m_stats_slot, lock_stats_get_slot(name), __ATOMIC_RELAXED);
+            }
+            return ret;
+        }
+
+        tscval_t start = 0;
+        tscval_t now = 0;
+        int ret = trylock_fn();
+        if (ret != 0) {
+            gettimeoftsc(&start);
+            ret = lock_fn();
+            gettimeoftsc(&now);
+        }
+        if (likely(ret == 0) && lock_stats_acquired(slot, now - start)) {
+            if (!now) {
+                gettimeoftsc(&now);
+            }
+            m_hold_start = now;
+        }
+        return ret;
+    }
+
+    template <typename TRYLOCK> inline int trylock_profiled(TRYLOCK trylock_fn)
+    {
+        int slot = __atomic_load_n(&m_stats_slot, __ATOMIC_RELAXED);
+        int ret = trylock_fn();
+        if (slot >= 0 && ret == 0 && lock_stats_acquired(slot, 0)) {
+            gettimeoftsc(&m_hold_start);
+        }
+        return ret;
+    }
+
+    // Must be called while the lock is still held
+    inline void unlock_profiled()
+    {
+        if (unlikely(m_hold_start)) {
+            tscval_t now;
+            gettimeoftsc(&now);
+            lock_stats_released(m_stats_slot, now - m_hold_start);
+            m_hold_start = 0;
+        }
+    }
+
+private:
+    int m_stats_slot;
+    tscval_t m_hold_start;
+};
+
 #ifdef NO_LOCK_STATS
 
 // pthread lock stats counter for debugging
 /* coverity[missing_move_assignment] */
-class lock_base {
+class lock_base : public lock_profiler {
 public:
     lock_base(const char *_lock_name = NULL)
         : m_lock_name(_lock_name) {};
@@ -106,7 +192,7 @@ private:
 //
 // pthread counting mutex
 //
-class lock_base {
+class lock_base : public lock_profiler {
 public:
     lock_base(const char *name)
     {
@@ -196,6 +282,11 @@ public:
     inline int lock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        if (unlikely(lock_stats_enabled())) {
+            return lock_profiled(
+                to_str(), [this]() { return pthread_spin_trylock(&m_lock); },
+                [this]() { return pthread_spin_lock(&m_lock); });
+        }
         LOCK_BASE_START_LOCK_WAIT
         int ret = pthread_spin_lock(&m_lock);
         LOCK_BASE_LOCK
@@ -205,6 +296,9 @@ public:
     inline int trylock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        if (unlikely(lock_stats_enabled())) {
+            return trylock_profiled([this]() { return pthread_spin_trylock(&m_lock); });
+        }
         int ret = pthread_spin_trylock(&m_lock);
         LOCK_BASE_TRYLOCK
         return ret;
@@ -212,6 +306,7 @@ public:
     inline int unlock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        unlock_profiled();
         LOCK_BASE_UNLOCK
         return pthread_spin_unlock(&m_lock);
     };
@@ -344,6 +439,11 @@ public:
     inline int lock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        if (unlikely(lock_stats_enabled())) {
+            return lock_profiled(
+                to_str(), [this]() { return pthread_mutex_trylock(&m_lock); },
+                [this]() { return pthread_mutex_lock(&m_lock); });
+        }
         LOCK_BASE_START_LOCK_WAIT
         int ret = pthread_mutex_lock(&m_lock);
         LOCK_BASE_LOCK
@@ -353,6 +453,9 @@ public:
     inline int trylock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        if (unlikely(lock_stats_enabled())) {
+            return trylock_profiled([this]() { return pthread_mutex_trylock(&m_lock); });
+        }
         int ret = pthread_mutex_trylock(&m_lock);
         LOCK_BASE_TRYLOCK
         return ret;
@@ -360,6 +463,7 @@ public:
     inline int unlock()
     {
         DEFINED_NO_THREAD_LOCK_RETURN_0
+        unlock_profiled();
         LOCK_BASE_UNLOCK
         return pthread_mutex_unlock(&m_lock);
     };
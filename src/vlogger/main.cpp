@@ -31,6 +31,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 #include "vlogger.h"
 
@@ -38,8 +45,150 @@
 #pragma BullseyeCoverage off
 #endif
 
+#define BENCH_DEFAULT_CALLS   100000
+#define BENCH_DEFAULT_RECORDS 4096
+#define BENCH_DEFAULT_FILE    "/tmp/vlogger_bench.log"
+
+/*
+ * Cost of a debug log call in the calling thread, synchronous vs asynchronous output.
+ * Usage: vlogger_test bench [calls] [async records] [log file]
+ */
+static void bench_run(const char *name, int calls, uint32_t async_records, const char *file)
+{
+    std::vector<uint64_t> ticks(calls);
+    vlog_async_stats_t async_stats = {0, 0, 0};
+
+    vlog_start("BENCH", VLOG_DEBUG, file, 3, false, async_records);
+    for (int i = 0; i < calls; i++) {
+        tscval_t start, end;
+        gettimeoftsc(&start);
+        vlog_printf(VLOG_DEBUG, "bench:%d:%s() fd=%d len=%zu ptr=%p rtt=%.3f\n", __LINE__,
+                    __func__, i, (size_t)i * 64, (void *)&ticks, i / 7.0);
+        gettimeoftsc(&end);
+        ticks[i] = end - start;
+    }
+    if (async_records) {
+        vlog_async_get_stats(&async_stats);
+    }
+    vlog_stop();
+
+    std::sort(ticks.begin(), ticks.end());
+    double nsec_per_tick = 1e9 / (double)get_tsc_rate_per_second();
+    uint64_t sum = 0;
+    for (uint64_t t : ticks) {
+        sum += t;
+    }
+    printf("%-6s calls=%d avg=%.0fns p50=%.0fns p99=%.0fns p99.9=%.0fns max=%.0fns", name, calls,
+           (double)sum / calls * nsec_per_tick, ticks[calls / 2] * nsec_per_tick,
+           ticks[(size_t)(calls * 0.99)] * nsec_per_tick,
+           ticks[(size_t)(calls * 0.999)] * nsec_per_tick, ticks[calls - 1] * nsec_per_tick);
+    if (async_records) {
+        // Written count excludes records drained by vlog_stop()
+        printf(" dropped=%" PRIu64 " preformatted=%" PRIu64, async_stats.n_dropped,
+               async_stats.n_preformatted);
+    }
+    printf("\n");
+}
+
+static int bench(int argc, char **argv)
+{
+    int calls = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_CALLS;
+    uint32_t records = (argc > 3) ? (uint32_t)atoi(argv[3]) : BENCH_DEFAULT_RECORDS;
+    const char *file = (argc > 4) ? argv[4] : BENCH_DEFAULT_FILE;
+
+    if (calls <= 0 || !records || (records & (records - 1))) {
+        printf("calls must be positive and async records a power of 2\n");
+        return 1;
+    }
+    bench_run("sync", calls, 0, file);
+    bench_run("async", calls, records, file);
+    return 0;
+}
+
+// Logs from a TLS destructor which runs after the one of the logger context
+struct check_tls_logger {
+    ~check_tls_logger() { vlog_printf(VLOG_INFO, "thread: logged at exit\n"); }
+};
+
+static void *check_thread(void *)
+{
+    static thread_local check_tls_logger s_logger;
+    (void)s_logger;
+    vlog_printf(VLOG_INFO, "thread: %d\n", 1);
+    return NULL;
+}
+
+static void check_run(const char *file, uint32_t async_records)
+{
+    std::string long_str(300, 'x');
+    const char unterminated[4] = {'a', 'b', 'c', 'd'};
+    const char dump[4] = {1, 2, 3, 4};
+    pthread_t tid;
+
+    vlog_start("CHECK", VLOG_INFO, file, 0, false, async_records);
+    vlog_printf(VLOG_INFO, "long: %s\n", long_str.c_str());
+    vlog_printf(VLOG_INFO, "precision: %.3s %.*s\n", unterminated, 2, unterminated);
+    vlog_print_buffer(VLOG_INFO, "dump: ", "\n", dump, sizeof(dump));
+    vlog_printf(VLOG_INFO, "after dump: %d\n", 2);
+    pthread_create(&tid, NULL, check_thread, NULL);
+    pthread_join(tid, NULL);
+    vlog_stop();
+}
+
+static std::vector<std::string> check_read(const char *file)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(file);
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/*
+ * Asynchronous output must be the same as the synchronous one. Lines of different threads
+ * can be reordered, so the threads are compared separately.
+ * Usage: vlogger_test check [log file]
+ */
+static int check(int argc, char **argv)
+{
+    std::string file = (argc > 2) ? argv[2] : BENCH_DEFAULT_FILE;
+    std::string async_file = file + ".async";
+
+    check_run(file.c_str(), 0);
+    check_run(async_file.c_str(), BENCH_DEFAULT_RECORDS);
+
+    std::vector<std::string> sync_lines = check_read(file.c_str());
+    std::vector<std::string> async_lines = check_read(async_file.c_str());
+    auto is_thread = [](const std::string &line) {
+        return line.find("thread: ") != std::string::npos;
+    };
+    std::stable_partition(sync_lines.begin(), sync_lines.end(), is_thread);
+    std::stable_partition(async_lines.begin(), async_lines.end(), is_thread);
+
+    bool ok = sync_lines.size() == 7 && sync_lines == async_lines;
+    for (size_t i = 0; i < std::max(sync_lines.size(), async_lines.size()); i++) {
+        printf("%s sync:  %s\n      async: %s\n",
+               (i < sync_lines.size() && i < async_lines.size() &&
+                sync_lines[i] == async_lines[i])
+                   ? "  "
+                   : "!!",
+               i < sync_lines.size() ? sync_lines[i].c_str() : "",
+               i < async_lines.size() ? async_lines[i].c_str() : "");
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
+    if (argc > 1 && !strcmp(argv[1], "bench")) {
+        return bench(argc, argv);
+    }
+    if (argc > 1 && !strcmp(argv[1], "check")) {
+        return check(argc, argv);
+    }
+
     vlog_levels_t vlog_levels_init = VLOG_WARNING;
     if (argc > 1) {
         vlog_levels_init = (vlog_levels_t)atoi(argv[1]);
@@ -31,6 +31,7 @@
  */
 
 #include "vlogger.h"
+#include "vlogger_async.h"
 
 #include <sys/types.h>
 #include <sys/syscall.h>
@@ -58,6 +59,7 @@ uint8_t *g_p_vlogger_details = NULL;
 uint32_t g_vlogger_usec_on_startup = 0;
 bool g_vlogger_log_in_colors = MCE_DEFAULT_LOG_COLORS;
 xlio_log_cb_t g_vlogger_cb = NULL;
+bool g_vlogger_async = false;
 
 namespace log_level {
 typedef struct {
@@ -233,7 +235,7 @@ static xlio_log_cb_t xlio_log_get_cb_func()
 }
 
 void vlog_start(const char *log_module_name, vlog_levels_t log_level, const char *log_filename,
-                int log_details, bool log_in_colors)
+                int log_details, bool log_in_colors, uint32_t async_records)
 {
     g_vlogger_file = stderr;
 
@@ -272,12 +274,22 @@ void vlog_start(const char *log_module_name, vlog_levels_t log_level, const char
     if (file_fd >= 0 && isatty(file_fd) && log_in_colors) {
         g_vlogger_log_in_colors = log_in_colors;
     }
+
+    if (async_records) {
+        g_vlogger_async = vlog_async_start(async_records);
+    }
 }
 
 void vlog_stop(void)
 {
     // Closing logger
 
+    // Write out deferred messages while the output stream is still open
+    if (g_vlogger_async) {
+        g_vlogger_async = false;
+        vlog_async_stop();
+    }
+
     // Allow only really extreme (PANIC) logs to go out
     g_vlogger_level = VLOG_PANIC;
 
@@ -294,12 +306,9 @@ void vlog_stop(void)
     unsetenv(XLIO_LOG_CB_ENV_VAR);
 }
 
-void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
+int vlog_format_header(char *buf, vlog_levels_t log_level, uint32_t usec, pid_t tid)
 {
     int len = 0;
-    char buf[VLOGGER_STR_SIZE];
-
-    // Format header
 
     // Set color scheme
     if (g_vlogger_log_in_colors) {
@@ -310,32 +319,26 @@ void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
     switch (g_vlogger_details) {
     case 3: // Time
         len += snprintf(buf + len, VLOGGER_STR_SIZE - len - 1, " Time: %9.3f",
-                        ((float)vlog_get_usec_since_start()) / 1000); // fallthrough
+                        ((float)usec) / 1000); // fallthrough
     case 2: // Pid
         len +=
             snprintf(buf + len, VLOGGER_STR_SIZE - len - 1, " Pid: %5u", getpid()); // fallthrough
     case 1: // Tid
-        len +=
-            snprintf(buf + len, VLOGGER_STR_SIZE - len - 1, " Tid: %5u", gettid()); // fallthrough
+        len += snprintf(buf + len, VLOGGER_STR_SIZE - len - 1, " Tid: %5u", tid); // fallthrough
     case 0: // Func
     default:
         len += snprintf(buf + len, VLOGGER_STR_SIZE - len - 1, " %s %s: ", g_vlogger_module_name,
                         log_level::to_str(log_level));
     }
 
-    if (len < 0) {
-        return;
+    if (len >= 0) {
+        buf[len + 1] = '\0';
     }
-    buf[len + 1] = '\0';
-
-    // Format body
-    va_list ap;
-    va_start(ap, fmt);
-    if (fmt != NULL) {
-        len += vsnprintf(buf + len, VLOGGER_STR_SIZE - len, fmt, ap);
-    }
-    va_end(ap);
+    return len;
+}
 
+int vlog_format_tail(char *buf, int len)
+{
     // Reset color scheme
     if (g_vlogger_log_in_colors) {
         // Save enough room for color code termination and EOL
@@ -344,18 +347,59 @@ void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
         }
 
         len = snprintf(buf + len, VLOGGER_STR_TERMINATION_SIZE, VLOGGER_STR_COLOR_TERMINATION_STR);
-        if (len < 0) {
-            return;
-        }
     }
+    return len;
+}
 
+void vlog_write(vlog_levels_t log_level, const char *buf, bool flush)
+{
     if (g_vlogger_cb) {
         g_vlogger_cb(log_level, buf);
     } else if (g_vlogger_file) {
         // Print out
-        fprintf(g_vlogger_file, "%s", buf);
-        fflush(g_vlogger_file);
+        fputs(buf, g_vlogger_file);
+        if (flush) {
+            fflush(g_vlogger_file);
+        }
     } else {
         printf("%s", buf);
     }
 }
+
+void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
+{
+    va_list ap;
+
+    // Panic messages precede termination, they are never deferred
+    if (g_vlogger_async && log_level > VLOG_PANIC) {
+        va_start(ap, fmt);
+        bool queued = vlog_async_push(log_level, fmt, ap);
+        va_end(ap);
+        if (likely(queued)) {
+            return;
+        }
+    }
+
+    char buf[VLOGGER_STR_SIZE];
+    uint32_t usec = (g_vlogger_details == 3) ? vlog_get_usec_since_start() : 0;
+    pid_t tid = (g_vlogger_details >= 1 && g_vlogger_details <= 3) ? gettid() : 0;
+
+    // Format header
+    int len = vlog_format_header(buf, log_level, usec, tid);
+    if (len < 0) {
+        return;
+    }
+
+    // Format body
+    va_start(ap, fmt);
+    if (fmt != NULL) {
+        len += vsnprintf(buf + len, VLOGGER_STR_SIZE - len, fmt, ap);
+    }
+    va_end(ap);
+
+    if (vlog_format_tail(buf, len) < 0) {
+        return;
+    }
+
+    vlog_write(log_level, buf, true);
+}
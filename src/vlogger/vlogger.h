@@ -340,6 +340,7 @@ extern uint8_t *g_p_vlogger_details;
 extern uint32_t g_vlogger_usec_on_startup;
 extern bool g_vlogger_log_in_colors;
 extern xlio_log_cb_t g_vlogger_cb;
+extern bool g_vlogger_async;
 
 #define vlog_func_enter() vlog_printf(VLOG_FINE, "ENTER %s\n", __PRETTY_FUNCTION__);
 #define vlog_func_exit()  vlog_printf(VLOG_FINE, "EXIT %s\n", __PRETTY_FUNCTION__);
@@ -354,9 +355,21 @@ pid_t gettid(void); // Check vlogger.cpp for implementation
 void printf_backtrace(void);
 
 void vlog_start(const char *log_module_name, vlog_levels_t log_level = VLOG_DEFAULT,
-                const char *log_filename = NULL, int log_details = 0, bool colored_log = true);
+                const char *log_filename = NULL, int log_details = 0, bool colored_log = true,
+                uint32_t async_records = 0);
 void vlog_stop(void);
 
+// Asynchronous logging counters, totals since vlog_start()
+typedef struct {
+    uint64_t n_written;
+    uint64_t n_dropped; // ring of the logging thread was full
+    uint64_t n_preformatted; // formatted by the logging thread, see vlogger_async.h
+} vlog_async_stats_t;
+
+void vlog_async_get_stats(vlog_async_stats_t *p_stats);
+// Queues a formatted line, returns false when the caller must write it synchronously
+bool vlog_async_push_line(int log_level, const char *buf);
+
 static inline uint32_t vlog_get_usec_since_start()
 {
     struct timespec ts_now;
@@ -379,6 +392,11 @@ static inline uint32_t vlog_get_usec_since_start()
 
 void vlog_output(vlog_levels_t log_level, const char *fmt, ...);
 
+// Line formatting shared by the synchronous and the asynchronous output
+int vlog_format_header(char *buf, vlog_levels_t log_level, uint32_t usec, pid_t tid);
+int vlog_format_tail(char *buf, int len);
+void vlog_write(vlog_levels_t log_level, const char *buf, bool flush);
+
 static inline void vlog_print_buffer(vlog_levels_t log_level, const char *msg_header,
                                      const char *msg_tail, const char *buf_user, int buf_len)
 {
@@ -420,6 +438,11 @@ static inline void vlog_print_buffer(vlog_levels_t log_level, const char *msg_he
 
     buf[len + 1] = '\0';
 
+    // Keep the order with the deferred messages
+    if (g_vlogger_async && vlog_async_push_line(log_level, buf)) {
+        return;
+    }
+
     // Print out
     if (g_vlogger_cb) {
         g_vlogger_cb(log_level, buf);
@@ -0,0 +1,681 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vlogger.h"
+#include "vlogger_async.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cinttypes>
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "utils/types.h"
+
+#define VLOG_ASYNC_CACHE_LINE 64
+
+enum vlog_arg_type {
+    VLOG_ARG_INT,
+    VLOG_ARG_LONG,
+    VLOG_ARG_LLONG,
+    VLOG_ARG_DOUBLE,
+    VLOG_ARG_LDOUBLE,
+    VLOG_ARG_PTR,
+    VLOG_ARG_STR,
+    VLOG_ARG_ERRNO, // %m
+    VLOG_ARG_PERCENT, // %%
+    VLOG_ARG_UNSUPPORTED,
+};
+
+#define VLOG_PRECISION_ARG (-2) // '.*', the precision is the last star argument
+
+struct vlog_spec {
+    const char *start;
+    size_t len;
+    int n_stars;
+    int precision; // -1 when not set
+    vlog_arg_type type;
+};
+
+/*
+ * Single producer ring of a logging thread. The owner thread advances 'head' and the
+ * background thread advances 'tail', each on its own cache line.
+ */
+struct vlog_async_ring {
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> n_dropped;
+    char pad_head[VLOG_ASYNC_CACHE_LINE - 2 * sizeof(uint64_t)];
+    std::atomic<uint64_t> tail;
+    uint64_t n_dropped_reported;
+    char pad_tail[VLOG_ASYNC_CACHE_LINE - 2 * sizeof(uint64_t)];
+    std::atomic<bool> detached; // the owner thread has exited
+    pid_t tid;
+    uint32_t mask;
+    vlog_async_ring *next;
+    vlog_async_record *records;
+};
+
+struct vlog_async_thread_ctx {
+    vlog_async_ring *ring;
+    uint32_t gen;
+    bool dead; // the TLS destructor has run, later TLS destructors log synchronously
+    ~vlog_async_thread_ctx();
+};
+
+static pthread_mutex_t g_async_lock = PTHREAD_MUTEX_INITIALIZER; // protects the rings list
+static vlog_async_ring *g_async_rings = NULL;
+static uint32_t g_async_records = 0;
+static std::atomic<uint32_t> g_async_gen(0);
+static std::atomic<bool> g_async_running(false);
+static pthread_t g_async_tid;
+static pid_t g_async_pid = 0;
+static std::atomic<uint64_t> g_async_n_written(0);
+static std::atomic<uint64_t> g_async_n_dropped(0);
+static std::atomic<uint64_t> g_async_n_preformatted(0);
+static thread_local vlog_async_thread_ctx g_async_thread_ctx = {NULL, 0, false};
+
+vlog_async_thread_ctx::~vlog_async_thread_ctx()
+{
+    // The background thread releases the ring once it is drained
+    if (ring && gen == g_async_gen.load(std::memory_order_relaxed)) {
+        ring->detached.store(true, std::memory_order_release);
+    }
+    ring = NULL;
+    dead = true;
+}
+
+// 'p' points to '%', returns the position after the conversion specifier
+static const char *vlog_parse_spec(const char *p, vlog_spec *spec)
+{
+    int n_long = 0;
+    bool long_double = false;
+
+    spec->start = p++;
+    spec->n_stars = 0;
+    spec->precision = -1;
+    while (*p && strchr("-+ #0'", *p)) {
+        p++;
+    }
+    if (*p == '*') {
+        spec->n_stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->n_stars++;
+            spec->precision = VLOG_PRECISION_ARG;
+            p++;
+        } else {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9') {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+    for (;; p++) {
+        if (*p == 'h') {
+            continue;
+        } else if (*p == 'l') {
+            n_long++;
+        } else if (*p == 'z' || *p == 't') {
+            n_long = 1;
+        } else if (*p == 'j' || *p == 'q') {
+            n_long = 2;
+        } else if (*p == 'L') {
+            long_double = true;
+        } else {
+            break;
+        }
+    }
+
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        spec->type = (n_long == 0) ? VLOG_ARG_INT : (n_long == 1 ? VLOG_ARG_LONG : VLOG_ARG_LLONG);
+        break;
+    case 'c':
+        spec->type = n_long ? VLOG_ARG_UNSUPPORTED : VLOG_ARG_INT;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->type = long_double ? VLOG_ARG_LDOUBLE : VLOG_ARG_DOUBLE;
+        break;
+    case 'p':
+        spec->type = VLOG_ARG_PTR;
+        break;
+    case 's':
+        spec->type = n_long ? VLOG_ARG_UNSUPPORTED : VLOG_ARG_STR;
+        break;
+    case 'm':
+        spec->type = VLOG_ARG_ERRNO;
+        break;
+    case '%':
+        spec->type = VLOG_ARG_PERCENT;
+        break;
+    default:
+        spec->type = VLOG_ARG_UNSUPPORTED; // %n, wide characters or a broken format
+        break;
+    }
+    if (*p) {
+        p++;
+    }
+    spec->len = p - spec->start;
+    return p;
+}
+
+template <typename T> static inline bool vlog_put(char *&out, const char *end, T val)
+{
+    if (out + sizeof(val) > end) {
+        return false;
+    }
+    memcpy(out, &val, sizeof(val));
+    out += sizeof(val);
+    return true;
+}
+
+template <typename T> static inline T vlog_get(const char *&in)
+{
+    T val;
+    memcpy(&val, in, sizeof(val));
+    in += sizeof(val);
+    return val;
+}
+
+bool vlog_async_encode(vlog_async_record *rec, const char *fmt, va_list ap, int saved_errno)
+{
+    char *out = rec->data;
+    const char *end = rec->data + sizeof(rec->data);
+    vlog_spec spec;
+    int stars[2];
+    bool ok = true;
+
+    for (const char *p = strchr(fmt, '%'); p && ok; p = strchr(p, '%')) {
+        p = vlog_parse_spec(p, &spec);
+        for (int i = 0; i < spec.n_stars; i++) {
+            stars[i] = va_arg(ap, int);
+            ok = ok && vlog_put(out, end, stars[i]);
+        }
+        switch (spec.type) {
+        case VLOG_ARG_INT:
+            ok = ok && vlog_put(out, end, va_arg(ap, int));
+            break;
+        case VLOG_ARG_LONG:
+            ok = ok && vlog_put(out, end, va_arg(ap, long));
+            break;
+        case VLOG_ARG_LLONG:
+            ok = ok && vlog_put(out, end, va_arg(ap, long long));
+            break;
+        case VLOG_ARG_DOUBLE:
+            ok = ok && vlog_put(out, end, va_arg(ap, double));
+            break;
+        case VLOG_ARG_LDOUBLE:
+            ok = ok && vlog_put(out, end, va_arg(ap, long double));
+            break;
+        case VLOG_ARG_PTR:
+            ok = ok && vlog_put(out, end, va_arg(ap, void *));
+            break;
+        case VLOG_ARG_STR: {
+            // A string printed with a precision does not have to be terminated
+            const char *str = va_arg(ap, const char *);
+            int precision =
+                (spec.precision == VLOG_PRECISION_ARG) ? stars[spec.n_stars - 1] : spec.precision;
+            size_t max_len = sizeof(rec->data);
+            if (precision >= 0) {
+                max_len = std::min(max_len, (size_t)precision);
+            }
+            size_t len = str ? strnlen(str, max_len) : 0;
+            ok = ok && str && vlog_put(out, end, (uint16_t)len) && (out + len <= end);
+            if (ok) {
+                memcpy(out, str, len);
+                out += len;
+            }
+        } break;
+        case VLOG_ARG_ERRNO:
+            ok = ok && vlog_put(out, end, saved_errno);
+            break;
+        case VLOG_ARG_PERCENT:
+            break;
+        default:
+            ok = false;
+            break;
+        }
+    }
+
+    rec->fmt = fmt;
+    rec->data_len = (uint16_t)(out - rec->data);
+    return ok;
+}
+
+template <typename T>
+static inline int vlog_format_arg(char *buf, size_t size, const char *spec, int n_stars,
+                                  const int *stars, T val)
+{
+    switch (n_stars) {
+    case 0:
+        return snprintf(buf, size, spec, val);
+    case 1:
+        return snprintf(buf, size, spec, stars[0], val);
+    default:
+        return snprintf(buf, size, spec, stars[0], stars[1], val);
+    }
+}
+
+int vlog_async_format(const vlog_async_record *rec, char *buf, size_t size)
+{
+    const char *in = rec->data;
+    const char *p = rec->fmt;
+    size_t len = 0;
+    vlog_spec spec;
+    char spec_fmt[32];
+    int stars[2];
+    int n = 0;
+
+    if (!size) {
+        return 0;
+    }
+    if (!p) {
+        return snprintf(buf, size, "%.*s", (int)rec->data_len, rec->data);
+    }
+
+    while (*p && len < size - 1) {
+        const char *pct = strchr(p, '%');
+        size_t literal = pct ? (size_t)(pct - p) : strlen(p);
+        size_t copy = std::min(literal, size - 1 - len);
+        memcpy(buf + len, p, copy);
+        len += copy;
+        if (!pct) {
+            break;
+        }
+
+        p = vlog_parse_spec(pct, &spec);
+        if (spec.len >= sizeof(spec_fmt)) {
+            break;
+        }
+        memcpy(spec_fmt, spec.start, spec.len);
+        spec_fmt[spec.len] = '\0';
+        for (int i = 0; i < spec.n_stars; i++) {
+            stars[i] = vlog_get<int>(in);
+        }
+
+        char *out = buf + len;
+        size_t room = size - len;
+        switch (spec.type) {
+        case VLOG_ARG_INT:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, vlog_get<int>(in));
+            break;
+        case VLOG_ARG_LONG:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, vlog_get<long>(in));
+            break;
+        case VLOG_ARG_LLONG:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars,
+                                vlog_get<long long>(in));
+            break;
+        case VLOG_ARG_DOUBLE:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, vlog_get<double>(in));
+            break;
+        case VLOG_ARG_LDOUBLE:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars,
+                                vlog_get<long double>(in));
+            break;
+        case VLOG_ARG_PTR:
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, vlog_get<void *>(in));
+            break;
+        case VLOG_ARG_STR: {
+            // Copied strings are not terminated, print them with an explicit precision
+            uint16_t str_len = vlog_get<uint16_t>(in);
+            char str[sizeof(rec->data)];
+            memcpy(str, in, str_len);
+            str[str_len] = '\0';
+            in += str_len;
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, (const char *)str);
+        } break;
+        case VLOG_ARG_ERRNO: {
+            char err_buf[64];
+            spec_fmt[spec.len - 1] = 's';
+            const char *err_str = strerror_r(vlog_get<int>(in), err_buf, sizeof(err_buf));
+            n = vlog_format_arg(out, room, spec_fmt, spec.n_stars, stars, err_str);
+        } break;
+        case VLOG_ARG_PERCENT:
+            n = snprintf(out, room, "%%");
+            break;
+        default:
+            n = 0;
+            break;
+        }
+        if (n > 0) {
+            len += std::min((size_t)n, room - 1);
+        }
+    }
+
+    buf[len] = '\0';
+    return (int)len;
+}
+
+static vlog_async_ring *vlog_async_ring_create()
+{
+    vlog_async_ring *ring = new (std::nothrow) vlog_async_ring;
+    if (!ring) {
+        return NULL;
+    }
+    ring->records = new (std::nothrow) vlog_async_record[g_async_records];
+    if (!ring->records) {
+        delete ring;
+        return NULL;
+    }
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->n_dropped.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->n_dropped_reported = 0;
+    ring->detached.store(false, std::memory_order_relaxed);
+    ring->tid = gettid();
+    ring->mask = g_async_records - 1;
+
+    pthread_mutex_lock(&g_async_lock);
+    ring->next = g_async_rings;
+    g_async_rings = ring;
+    pthread_mutex_unlock(&g_async_lock);
+    return ring;
+}
+
+static void vlog_async_ring_destroy(vlog_async_ring *ring)
+{
+    delete[] ring->records;
+    delete ring;
+}
+
+/*
+ * Returns the next free record of the calling thread, or NULL if the message is not queued.
+ * Then '*p_sync' tells whether the caller writes it synchronously or it is dropped.
+ */
+static inline vlog_async_record *vlog_async_reserve(vlog_async_ring **p_ring, bool *p_sync)
+{
+    vlog_async_thread_ctx &ctx = g_async_thread_ctx;
+
+    *p_sync = ctx.dead;
+    if (unlikely(ctx.dead)) {
+        return NULL;
+    }
+    if (unlikely(ctx.gen != g_async_gen.load(std::memory_order_acquire))) {
+        ctx.gen = g_async_gen.load(std::memory_order_relaxed);
+        ctx.ring = vlog_async_ring_create();
+    }
+    vlog_async_ring *ring = ctx.ring;
+    if (unlikely(!ring)) {
+        g_async_n_dropped.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (unlikely(head - ring->tail.load(std::memory_order_acquire) > ring->mask)) {
+        ring->n_dropped.store(ring->n_dropped.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+        return NULL;
+    }
+
+    *p_ring = ring;
+    return &ring->records[head & ring->mask];
+}
+
+static inline void vlog_async_commit(vlog_async_ring *ring)
+{
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool vlog_async_push(int log_level, const char *fmt, va_list ap)
+{
+    int saved_errno = errno;
+    vlog_async_ring *ring = NULL;
+    bool sync;
+
+    vlog_async_record *rec = vlog_async_reserve(&ring, &sync);
+    if (unlikely(!rec)) {
+        errno = saved_errno;
+        return !sync;
+    }
+    rec->level = (uint8_t)log_level;
+    rec->raw = 0;
+    rec->usec = (g_vlogger_details == 3) ? vlog_get_usec_since_start() : 0;
+
+    va_list aq;
+    va_copy(aq, ap);
+    bool encoded = fmt && vlog_async_encode(rec, fmt, aq, saved_errno);
+    va_end(aq);
+    if (unlikely(!encoded)) {
+        errno = saved_errno; // for %m
+        int len = fmt ? vsnprintf(rec->data, sizeof(rec->data), fmt, ap) : 0;
+        rec->fmt = NULL;
+        rec->data_len = (uint16_t)std::max(0, std::min(len, (int)sizeof(rec->data) - 1));
+        g_async_n_preformatted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    vlog_async_commit(ring);
+    return true;
+}
+
+bool vlog_async_push_line(int log_level, const char *buf)
+{
+    vlog_async_ring *ring = NULL;
+    bool sync;
+
+    vlog_async_record *rec = vlog_async_reserve(&ring, &sync);
+    if (unlikely(!rec)) {
+        return !sync;
+    }
+    rec->level = (uint8_t)log_level;
+    rec->raw = 1;
+    rec->usec = 0;
+    rec->fmt = NULL;
+    rec->data_len = (uint16_t)strnlen(buf, sizeof(rec->data) - 1);
+    memcpy(rec->data, buf, rec->data_len);
+
+    vlog_async_commit(ring);
+    return true;
+}
+
+static void vlog_async_write_record(vlog_levels_t log_level, const vlog_async_record *rec,
+                                    pid_t tid)
+{
+    char buf[VLOGGER_STR_SIZE];
+
+    if (rec && rec->raw) {
+        memcpy(buf, rec->data, rec->data_len);
+        buf[rec->data_len] = '\0';
+        vlog_write(log_level, buf, false);
+        return;
+    }
+
+    int len = vlog_format_header(buf, log_level, rec ? rec->usec : 0, tid);
+    if (len < 0) {
+        return;
+    }
+    if (rec) {
+        len += vlog_async_format(rec, buf + len, VLOGGER_STR_SIZE - len);
+    }
+    if (vlog_format_tail(buf, len) >= 0) {
+        vlog_write(log_level, buf, false);
+    }
+}
+
+// Returns the number of written records
+static uint64_t vlog_async_drain_ring(vlog_async_ring *ring)
+{
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t written = head - tail;
+
+    for (; tail != head; tail++) {
+        const vlog_async_record *rec = &ring->records[tail & ring->mask];
+        vlog_async_write_record((vlog_levels_t)rec->level, rec, ring->tid);
+        ring->tail.store(tail + 1, std::memory_order_release);
+    }
+
+    uint64_t dropped = ring->n_dropped.load(std::memory_order_relaxed);
+    if (unlikely(dropped != ring->n_dropped_reported)) {
+        char buf[VLOGGER_STR_SIZE];
+        int len = vlog_format_header(buf, VLOG_WARNING, vlog_get_usec_since_start(), ring->tid);
+        if (len >= 0) {
+            len += snprintf(buf + len, VLOGGER_STR_SIZE - len,
+                            "%" PRIu64 " log messages were dropped, the ring of thread %d is "
+                            "full (XLIO_LOG_ASYNC=%u)\n",
+                            dropped - ring->n_dropped_reported, ring->tid, ring->mask + 1);
+            if (vlog_format_tail(buf, len) >= 0) {
+                vlog_write(VLOG_WARNING, buf, false);
+            }
+        }
+        g_async_n_dropped.fetch_add(dropped - ring->n_dropped_reported, std::memory_order_relaxed);
+        ring->n_dropped_reported = dropped;
+    }
+
+    g_async_n_written.fetch_add(written, std::memory_order_relaxed);
+    return written;
+}
+
+static uint64_t vlog_async_drain()
+{
+    uint64_t written = 0;
+
+    pthread_mutex_lock(&g_async_lock);
+    vlog_async_ring **pp_ring = &g_async_rings;
+    while (*pp_ring) {
+        vlog_async_ring *ring = *pp_ring;
+        bool detached = ring->detached.load(std::memory_order_acquire);
+        written += vlog_async_drain_ring(ring);
+        if (detached) {
+            *pp_ring = ring->next;
+            vlog_async_ring_destroy(ring);
+        } else {
+            pp_ring = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&g_async_lock);
+
+    if (written && g_vlogger_file && !g_vlogger_cb) {
+        fflush(g_vlogger_file);
+    }
+    return written;
+}
+
+static void *vlog_async_thread(void *)
+{
+    while (g_async_running.load(std::memory_order_acquire)) {
+        if (!vlog_async_drain()) {
+            usleep(VLOG_ASYNC_IDLE_USEC);
+        }
+    }
+    return NULL;
+}
+
+bool vlog_async_start(uint32_t records)
+{
+    sigset_t sigset_all, sigset_orig;
+
+    // Fixed size records are addressed by a mask
+    if (records & (records - 1)) {
+        return false;
+    }
+    g_async_records = records;
+    g_async_n_written.store(0, std::memory_order_relaxed);
+    g_async_n_dropped.store(0, std::memory_order_relaxed);
+    g_async_n_preformatted.store(0, std::memory_order_relaxed);
+    g_async_gen.fetch_add(1, std::memory_order_release);
+    g_async_running.store(true, std::memory_order_release);
+
+    // Signals are handled by the application threads
+    sigfillset(&sigset_all);
+    pthread_sigmask(SIG_SETMASK, &sigset_all, &sigset_orig);
+    int ret = pthread_create(&g_async_tid, NULL, vlog_async_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &sigset_orig, NULL);
+    if (ret) {
+        g_async_running.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    g_async_pid = getpid();
+    return true;
+}
+
+void vlog_async_stop()
+{
+    g_async_running.store(false, std::memory_order_release);
+
+    if (g_async_pid == getpid()) {
+        pthread_join(g_async_tid, NULL);
+        vlog_async_drain();
+
+        /* Live threads can still hold their rings, so the remaining rings are
+         * abandoned rather than released.
+         */
+        pthread_mutex_lock(&g_async_lock);
+        g_async_rings = NULL;
+        pthread_mutex_unlock(&g_async_lock);
+    } else {
+        /* Forked child: the background thread does not exist and the lock could be taken
+         * by a parent thread at the moment of fork. The calling thread is the only one,
+         * so the inherited rings are released without writing the parent's messages.
+         */
+        pthread_mutex_init(&g_async_lock, NULL);
+        while (g_async_rings) {
+            vlog_async_ring *ring = g_async_rings;
+            g_async_rings = ring->next;
+            vlog_async_ring_destroy(ring);
+        }
+        g_async_thread_ctx.ring = NULL;
+    }
+    g_async_pid = 0;
+    g_async_gen.fetch_add(1, std::memory_order_release);
+}
+
+void vlog_async_get_stats(vlog_async_stats_t *p_stats)
+{
+    p_stats->n_written = g_async_n_written.load(std::memory_order_relaxed);
+    p_stats->n_dropped = g_async_n_dropped.load(std::memory_order_relaxed);
+    p_stats->n_preformatted = g_async_n_preformatted.load(std::memory_order_relaxed);
+}
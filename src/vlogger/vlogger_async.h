@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VLOGGER_ASYNC_H
+#define VLOGGER_ASYNC_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "vlogger.h"
+
+/*
+ * Asynchronous logging backend (XLIO_LOG_ASYNC).
+ *
+ * A logging thread does not format the message. It copies the format pointer and the
+ * arguments into a fixed size record of its own single producer ring, and a background
+ * thread formats and writes the records. Messages which can not be encoded (e.g. a long
+ * string argument) are formatted by the calling thread and only the I/O is deferred.
+ * A record holds a whole line, so such messages are not cut shorter than synchronous ones.
+ * A message is dropped and counted when the ring of the thread is full.
+ *
+ * The output, including the application log callback (g_vlogger_cb), is called from the
+ * background thread. A thread whose ring is already released by its TLS destructor logs
+ * synchronously.
+ */
+#define VLOG_ASYNC_RECORD_SIZE (VLOGGER_STR_SIZE + 16)
+#define VLOG_ASYNC_IDLE_USEC   1000
+
+struct vlog_async_record {
+    const char *fmt; // NULL when 'data' holds the formatted message
+    uint32_t usec;
+    uint8_t level;
+    uint8_t raw; // 'data' is a complete line which is written without the header
+    uint16_t data_len;
+    char data[VLOG_ASYNC_RECORD_SIZE - 16];
+};
+
+bool vlog_async_start(uint32_t records);
+void vlog_async_stop();
+// Returns false when the caller must write the message synchronously
+bool vlog_async_push(int log_level, const char *fmt, va_list ap);
+
+// Exposed for vlogger_test
+bool vlog_async_encode(vlog_async_record *rec, const char *fmt, va_list ap, int saved_errno);
+int vlog_async_format(const vlog_async_record *rec, char *buf, size_t size);
+
+#endif // VLOGGER_ASYNC_H
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * UDP ping-pong with bursty arrivals for XLIO_ADAPTIVE_POLL evaluation.
+ *
+ * The client sends bursts of back to back requests separated by idle gaps
+ * and reports the round trip percentiles together with the CPU time it
+ * consumed. Compare runs with XLIO_ADAPTIVE_POLL=0 and XLIO_ADAPTIVE_POLL=1,
+ * short gaps should keep the latency of the busy poll and long gaps should
+ * cut the CPU time:
+ *
+ *   server: LD_PRELOAD=libxlio.so burst_test -s [-p port] [-e]
+ *   client: LD_PRELOAD=libxlio.so burst_test -c <server ip> [-p port] [-e]
+ *           [-b burst] [-g gap usec] [-n bursts]
+ *
+ * With -e the receive side waits in epoll_wait() instead of recvfrom().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define DEFAULT_PORT    17272
+#define DEFAULT_BURST   32
+#define DEFAULT_GAP     1000
+#define DEFAULT_BURSTS  1000
+#define MSG_LEN         64
+
+static int g_epfd = -1;
+
+static double now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double cpu_usec(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+	return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e6 + ru.ru_utime.tv_usec +
+	       ru.ru_stime.tv_usec;
+}
+
+static int use_epoll(int fd)
+{
+	struct epoll_event ev;
+
+	g_epfd = epoll_create1(0);
+	if (g_epfd < 0) {
+		perror("epoll_create1");
+		return -1;
+	}
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = fd;
+	if (epoll_ctl(g_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		perror("epoll_ctl");
+		return -1;
+	}
+	return 0;
+}
+
+static ssize_t recv_msg(int fd, char *buf, struct sockaddr_in *from)
+{
+	socklen_t len = sizeof(*from);
+	struct epoll_event ev;
+
+	if (g_epfd >= 0) {
+		do {
+			if (epoll_wait(g_epfd, &ev, 1, -1) < 0 && errno != EINTR) {
+				perror("epoll_wait");
+				return -1;
+			}
+		} while (!(ev.events & EPOLLIN));
+	}
+	return recvfrom(fd, buf, MSG_LEN, 0, (struct sockaddr *)from, &len);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static int server(int port, int epoll)
+{
+	char buf[MSG_LEN];
+	struct sockaddr_in addr;
+	ssize_t ret;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return 1;
+	}
+	if (epoll && use_epoll(fd) < 0) {
+		return 1;
+	}
+
+	while ((ret = recv_msg(fd, buf, &addr)) >= 0) {
+		if (sendto(fd, buf, ret, 0, (struct sockaddr *)&addr, sizeof(addr)) != ret) {
+			perror("sendto");
+			return 1;
+		}
+	}
+
+	perror("recvfrom");
+	close(fd);
+	return 1;
+}
+
+static int client(const char *ip, int port, int epoll, long burst, long gap, long bursts)
+{
+	char buf[MSG_LEN];
+	struct sockaddr_in addr, from;
+	double *rtt;
+	double start, cpu_start, t, wall, cpu;
+	long i, j, n = 0;
+	int fd;
+
+	rtt = malloc(sizeof(*rtt) * burst * bursts);
+	if (!rtt) {
+		perror("malloc");
+		return 1;
+	}
+	memset(buf, 'b', sizeof(buf));
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+		fprintf(stderr, "Invalid address %s\n", ip);
+		return 1;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		return 1;
+	}
+	if (epoll && use_epoll(fd) < 0) {
+		return 1;
+	}
+
+	start = now_usec();
+	cpu_start = cpu_usec();
+	for (i = 0; i < bursts; i++) {
+		for (j = 0; j < burst; j++) {
+			t = now_usec();
+			if (send(fd, buf, sizeof(buf), 0) != sizeof(buf)) {
+				perror("send");
+				return 1;
+			}
+			if (recv_msg(fd, buf, &from) < 0) {
+				perror("recv");
+				return 1;
+			}
+			rtt[n++] = now_usec() - t;
+		}
+		// Idle gap, the server side learns it as a long wait
+		if (gap > 0) {
+			usleep(gap);
+		}
+	}
+	wall = now_usec() - start;
+	cpu = cpu_usec() - cpu_start;
+
+	qsort(rtt, n, sizeof(*rtt), cmp_double);
+	printf("burst: %ld gap: %ld usec requests: %ld rtt p50: %.3f p99: %.3f p99.9: %.3f usec "
+	       "cpu: %.1f%%\n",
+	       burst, gap, n, rtt[n / 2], rtt[n * 99 / 100], rtt[n * 999 / 1000],
+	       100.0 * cpu / wall);
+
+	free(rtt);
+	close(fd);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: burst_test -s [-p port] [-e]\n"
+			"       burst_test -c <ip> [-p port] [-e] [-b burst] [-g gap usec] "
+			"[-n bursts]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *ip = NULL;
+	long burst = DEFAULT_BURST;
+	long gap = DEFAULT_GAP;
+	long bursts = DEFAULT_BURSTS;
+	int port = DEFAULT_PORT;
+	int is_server = 0;
+	int epoll = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "sc:p:eb:g:n:h")) != -1) {
+		switch (opt) {
+		case 's':
+			is_server = 1;
+			break;
+		case 'c':
+			ip = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'e':
+			epoll = 1;
+			break;
+		case 'b':
+			burst = atol(optarg);
+			break;
+		case 'g':
+			gap = atol(optarg);
+			break;
+		case 'n':
+			bursts = atol(optarg);
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (is_server) {
+		return server(port, epoll);
+	}
+	if (!ip || burst <= 0 || bursts <= 0 || gap < 0) {
+		usage();
+		return 1;
+	}
+	return client(ip, port, epoll, burst, gap, bursts);
+}
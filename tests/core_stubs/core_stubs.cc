@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Stand-ins for the libxlio globals used by core_sources.cc. The real ones
+ * drag in the configuration, statistics and device layers of the library.
+ * The gtest and microbench binaries do not export them, so they do not
+ * interpose the preloaded library.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "dev/ib_ctx_handler_collection.h"
+#include "event/event_handler_manager.h"
+#include "util/hugepage_mgr.h"
+#include "util/instrumentation.h"
+#include "util/sys_vars.h"
+#include "util/utils.h"
+#include "util/xlio_stats.h"
+#include "vlogger/vlogger.h"
+
+#include "core_stubs.h"
+
+vlog_levels_t g_vlogger_level = VLOG_NONE;
+
+void vlog_output(vlog_levels_t log_level, const char *fmt, ...)
+{
+    NOT_IN_USE(log_level);
+    NOT_IN_USE(fmt);
+}
+
+void mce_sys_var::get_env_params()
+{
+}
+
+mce_sys_var &safe_mce_sys()
+{
+    return mce_sys_var::instance();
+}
+
+void stub_mce_sys_reset()
+{
+    mce_sys_var &sys = safe_mce_sys();
+
+    sys.mem_alloc_type = option_alloc_type::ANON;
+    sys.memory_limit = 64U * 1024U * 1024U;
+    sys.memory_limit_user = 0;
+    sys.heap_metadata_block = 4U * 1024U * 1024U;
+    sys.memory_block = 0;
+    sys.memory_reclaim_high = 0;
+    sys.memory_reclaim_low = 0;
+    sys.rx_num_wr = 256;
+    sys.strq_strides_compensation_level = 256;
+    sys.tx_bufs_batch_tcp = 1;
+
+    g_stub_mem_reg_delay_usec = 0;
+    g_stub_mem_reg_fail = false;
+}
+
+// Used by the sysctl reader of mce_sys_var
+int read_file_to_int(const char *path, int default_value, vlog_levels_t log_level)
+{
+    NOT_IN_USE(path);
+    NOT_IN_USE(log_level);
+    return default_value;
+}
+
+xlio_error::xlio_error(const char *_message, const char *_function, const char *_filename,
+                       int _lineno, int _errnum) throw()
+    : message(_message)
+    , function(_function)
+    , filename(_filename)
+    , lineno(_lineno)
+    , errnum(_errnum)
+{
+    snprintf(formatted_message, sizeof(formatted_message), "xlio_error <%s> in %s:%d", message,
+             filename, lineno);
+}
+
+xlio_error::~xlio_error() throw()
+{
+}
+
+const char *xlio_error::what() const throw()
+{
+    return formatted_message;
+}
+
+const char *option_size::to_str(size_t size, char *s, size_t len)
+{
+    snprintf(s, len, "%zu", size);
+    return s;
+}
+
+hugepage_mgr g_hugepage_mgr;
+
+hugepage_mgr::hugepage_mgr()
+{
+}
+
+void *hugepage_mgr::alloc_hugepages(size_t &size, size_t &hugepage_size)
+{
+    NOT_IN_USE(size);
+    NOT_IN_USE(hugepage_size);
+    return nullptr;
+}
+
+void hugepage_mgr::dealloc_hugepages(void *ptr, size_t size)
+{
+    NOT_IN_USE(ptr);
+    NOT_IN_USE(size);
+}
+
+void hugepage_mgr::print_report(bool short_report)
+{
+    NOT_IN_USE(short_report);
+}
+
+// Only the address is used, as a key of the registrations
+alignas(ib_ctx_handler) static char s_ib_ctx[sizeof(ib_ctx_handler)];
+ib_ctx_handler *g_stub_ib_ctx = reinterpret_cast<ib_ctx_handler *>(s_ib_ctx);
+std::atomic<int> g_stub_mem_regs(0);
+unsigned g_stub_mem_reg_delay_usec = 0;
+bool g_stub_mem_reg_fail = false;
+static std::atomic<uint32_t> s_last_lkey(0);
+
+uint32_t ib_ctx_handler::mem_reg(void *addr, size_t length, uint64_t access)
+{
+    NOT_IN_USE(addr);
+    NOT_IN_USE(length);
+    NOT_IN_USE(access);
+    if (g_stub_mem_reg_delay_usec) {
+        usleep(g_stub_mem_reg_delay_usec);
+    }
+    if (g_stub_mem_reg_fail) {
+        return LKEY_ERROR;
+    }
+    ++g_stub_mem_regs;
+    return ++s_last_lkey;
+}
+
+void ib_ctx_handler::mem_dereg(uint32_t lkey)
+{
+    NOT_IN_USE(lkey);
+    --g_stub_mem_regs;
+}
+
+ib_ctx_handler_collection::ib_ctx_handler_collection()
+{
+    m_ib_ctx_map[nullptr] = g_stub_ib_ctx;
+}
+
+ib_ctx_handler_collection::~ib_ctx_handler_collection()
+{
+}
+
+static ib_ctx_handler_collection s_ib_ctx_collection;
+ib_ctx_handler_collection *g_p_ib_ctx_handler_collection = &s_ib_ctx_collection;
+
+event_handler_manager *g_p_event_handler_manager = nullptr;
+
+void *event_handler_manager::register_timer_event(int timeout_msec, timer_handler *handler,
+                                                  timer_req_type_t req_type, void *user_data)
+{
+    NOT_IN_USE(timeout_msec);
+    NOT_IN_USE(handler);
+    NOT_IN_USE(req_type);
+    NOT_IN_USE(user_data);
+    return nullptr;
+}
+
+void event_handler_manager::unregister_timer_event(timer_handler *handler, void *node)
+{
+    NOT_IN_USE(handler);
+    NOT_IN_USE(node);
+}
+
+bpool_stats_t *xlio_stats_instance_create_bpool_block(bpool_stats_t *local_stats)
+{
+    return local_stats;
+}
+
+bpool_stats_t *xlio_stats_instance_remove_bpool_block(bpool_stats_t *local_stats)
+{
+    NOT_IN_USE(local_stats);
+    return nullptr;
+}
+
+lock_stats_block_t g_stub_lock_stats;
+
+lock_stats_block_t *xlio_stats_instance_get_lock_block()
+{
+    return &g_stub_lock_stats;
+}
+
+trace_shm_t *xlio_trace_open(uint32_t capacity)
+{
+    NOT_IN_USE(capacity);
+    return nullptr;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TESTS_CORE_STUBS_CORE_STUBS_H_
+#define TESTS_CORE_STUBS_CORE_STUBS_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "util/xlio_stats.h"
+
+class ib_ctx_handler;
+
+/* The only device of the stubbed ib_ctx_handler_collection. Its mem_reg()
+ * hands out increasing lkeys and counts the active registrations. It can
+ * be slowed down or failed to exercise the background heap registration.
+ */
+extern ib_ctx_handler *g_stub_ib_ctx;
+extern std::atomic<int> g_stub_mem_regs;
+extern unsigned g_stub_mem_reg_delay_usec;
+extern bool g_stub_mem_reg_fail;
+
+// The block behind the lock profiler, see lock_stats_init()
+extern lock_stats_block_t g_stub_lock_stats;
+
+// Resets the configuration used by the stubbed safe_mce_sys() to the test defaults
+void stub_mce_sys_reset();
+
+#endif /* TESTS_CORE_STUBS_CORE_STUBS_H_ */
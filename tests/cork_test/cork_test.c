@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Counts TCP data segments per request for the header-then-body write pattern.
+ *
+ * Each request is written by two send() calls (header and body) and the
+ * client waits for a 1 byte response. The server counts received data
+ * segments with TCP_INFO (tcpi_data_segs_in), so it must run without
+ * XLIO, while the client runs with or without XLIO:
+ *
+ *   server: cork_test -s [-p port]
+ *   client: LD_PRELOAD=libxlio.so cork_test -c <server ip> [-m mode] [-n requests]
+ *
+ * Modes:
+ *   plain   - two send() calls, Nagle algorithm enabled
+ *   nodelay - two send() calls with TCP_NODELAY
+ *   cork    - TCP_NODELAY, TCP_CORK around the two send() calls
+ *   more    - TCP_NODELAY, header is sent with MSG_MORE flag
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/tcp.h>
+
+#define DEFAULT_PORT     17171
+#define DEFAULT_REQUESTS 10000
+#define HEADER_LEN       64
+#define BODY_LEN         512
+
+enum { MODE_PLAIN, MODE_NODELAY, MODE_CORK, MODE_MORE };
+
+static const char *mode_names[] = {"plain", "nodelay", "cork", "more"};
+
+static int set_opt(int fd, int opt, int val)
+{
+	if (setsockopt(fd, IPPROTO_TCP, opt, &val, sizeof(val)) < 0) {
+		perror("setsockopt");
+		return -1;
+	}
+	return 0;
+}
+
+static int recv_all(int fd, char *buf, size_t len)
+{
+	size_t pos = 0;
+
+	while (pos < len) {
+		ssize_t ret = recv(fd, buf + pos, len - pos, 0);
+		if (ret <= 0) {
+			return -1;
+		}
+		pos += ret;
+	}
+	return 0;
+}
+
+static double now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int server(int port)
+{
+	char buf[HEADER_LEN + BODY_LEN];
+	struct sockaddr_in addr;
+	struct tcp_info ti;
+	socklen_t len;
+	int one = 1;
+	long requests = 0;
+	int l_fd, fd;
+
+	l_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (l_fd < 0) {
+		perror("socket");
+		return 1;
+	}
+	setsockopt(l_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(l_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(l_fd, 1) < 0) {
+		perror("bind/listen");
+		return 1;
+	}
+
+	while ((fd = accept(l_fd, NULL, NULL)) >= 0) {
+		set_opt(fd, TCP_NODELAY, 1);
+		for (requests = 0; recv_all(fd, buf, sizeof(buf)) == 0; requests++) {
+			if (send(fd, buf, 1, 0) != 1) {
+				break;
+			}
+		}
+
+		len = sizeof(ti);
+		memset(&ti, 0, sizeof(ti));
+		if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0) {
+			perror("getsockopt(TCP_INFO)");
+		} else if (requests) {
+			printf("requests: %ld data segments: %u packets per request: %.3f\n", requests,
+			       ti.tcpi_data_segs_in, (double)ti.tcpi_data_segs_in / requests);
+		}
+		fflush(stdout);
+		close(fd);
+	}
+
+	close(l_fd);
+	return 0;
+}
+
+static int client(const char *ip, int port, int mode, long requests)
+{
+	char header[HEADER_LEN];
+	char body[BODY_LEN];
+	char resp;
+	struct sockaddr_in addr;
+	double start;
+	long i;
+	int fd;
+
+	memset(header, 'h', sizeof(header));
+	memset(body, 'b', sizeof(body));
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+	if (mode != MODE_PLAIN && set_opt(fd, TCP_NODELAY, 1) < 0) {
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+		fprintf(stderr, "Invalid address %s\n", ip);
+		return 1;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		return 1;
+	}
+
+	start = now_usec();
+	for (i = 0; i < requests; i++) {
+		if (mode == MODE_CORK) {
+			set_opt(fd, TCP_CORK, 1);
+		}
+		if (send(fd, header, sizeof(header), mode == MODE_MORE ? MSG_MORE : 0) !=
+		    sizeof(header) ||
+		    send(fd, body, sizeof(body), 0) != sizeof(body)) {
+			perror("send");
+			return 1;
+		}
+		if (mode == MODE_CORK) {
+			set_opt(fd, TCP_CORK, 0);
+		}
+		if (recv_all(fd, &resp, 1) < 0) {
+			fprintf(stderr, "Connection closed\n");
+			return 1;
+		}
+	}
+
+	printf("mode: %s requests: %ld avg rtt: %.3f usec\n", mode_names[mode], requests,
+	       (now_usec() - start) / requests);
+	close(fd);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: cork_test -s [-p port]\n"
+			"       cork_test -c <ip> [-p port] [-m plain|nodelay|cork|more] "
+			"[-n requests]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *ip = NULL;
+	long requests = DEFAULT_REQUESTS;
+	int port = DEFAULT_PORT;
+	int mode = MODE_CORK;
+	int is_server = 0;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "sc:p:m:n:h")) != -1) {
+		switch (opt) {
+		case 's':
+			is_server = 1;
+			break;
+		case 'c':
+			ip = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'm':
+			for (i = 0; i < (int)(sizeof(mode_names) / sizeof(mode_names[0])); i++) {
+				if (strcmp(optarg, mode_names[i]) == 0) {
+					break;
+				}
+			}
+			if (i == (int)(sizeof(mode_names) / sizeof(mode_names[0]))) {
+				usage();
+				return 1;
+			}
+			mode = i;
+			break;
+		case 'n':
+			requests = atol(optarg);
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (is_server) {
+		return server(port);
+	}
+	if (!ip || requests <= 0) {
+		usage();
+		return 1;
+	}
+	return client(ip, port, mode, requests);
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Offline simulator of adaptive CQ interrupt moderation (XLIO_CQ_AIM_POLICY).
+ *
+ * Replays per ring packet arrival traces through a model of the NIC interrupt
+ * moderation and the libxlio policies, so policies can be compared without
+ * hardware. The model raises an interrupt when the moderation count of
+ * completions is pending or when the oldest pending completion was held for
+ * the moderation period; all pending completions are handled as one batch.
+ *
+ * Trace format, one packet per line, non decreasing time per ring:
+ *   <ring id> <arrival time usec> <bytes>
+ * Lines starting with '#' are ignored. A trace can be generated from a packet
+ * capture, e.g. with tshark -T fields -e frame.interface_id -e frame.time_epoch
+ * -e frame.len after converting the time to usec, or synthesized with -g.
+ *
+ *   cq_moderation_sim [-p static|rate|aimd|all] [options] <trace file>
+ *   cq_moderation_sim -g <pps>:<burst>:<bytes>:<seconds>[,...] > trace
+ *
+ * Options follow the XLIO_CQ_MODERATION_* and XLIO_CQ_AIM_* parameters:
+ *   -c count  -d period usec  -m max count  -M max period usec
+ *   -i interval msec  -r interrupts rate per sec  -t latency target usec
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// The policies are built from the libxlio sources
+#include "core/dev/cq_moderation_policy.cpp"
+
+struct trace_packet {
+    uint64_t usec;
+    uint32_t bytes;
+};
+
+typedef std::map<int, std::vector<trace_packet>> trace_t;
+
+enum { SIM_STATIC = -1 };
+
+struct sim_result {
+    uint64_t packets = 0;
+    uint64_t interrupts = 0;
+    uint64_t adaptations = 0;
+    uint64_t duration_usec = 0;
+    std::vector<uint32_t> delays; // Added latency of every packet
+};
+
+static cq_moderation_config g_config = {{50, 48}, 250, 560, 5000, 50};
+static uint32_t g_interval_msec = 250;
+
+static const char *policy_name(int policy)
+{
+    switch (policy) {
+    case SIM_STATIC:
+        return "static";
+    case CQ_MODERATION_POLICY_RATE:
+        return "rate";
+    default:
+        return "aimd";
+    }
+}
+
+class sim_cq {
+public:
+    sim_cq(cq_moderation_params params, sim_result &result)
+        : m_params(params)
+        , m_result(result)
+    {
+    }
+
+    void set_params(cq_moderation_params params)
+    {
+        // Same hysteresis as ring_simple::modify_cq_moderation()
+        uint32_t period_diff = std::max(params.period, m_params.period) -
+            std::min(params.period, m_params.period);
+        uint32_t count_diff =
+            std::max(params.count, m_params.count) - std::min(params.count, m_params.count);
+        if (period_diff < m_params.period / 20 && count_diff < m_params.count / 20) {
+            return;
+        }
+        m_params = params;
+        ++m_result.adaptations;
+    }
+
+    // Fires the period timer if it expires before the given time
+    void advance(uint64_t usec)
+    {
+        if (!m_pending.empty() && m_pending.front() + m_params.period <= usec) {
+            interrupt(m_pending.front() + m_params.period);
+        }
+    }
+
+    void arrive(uint64_t usec)
+    {
+        m_pending.push_back(usec);
+        if (m_params.count == 0 || m_params.period == 0 || m_pending.size() >= m_params.count) {
+            interrupt(usec);
+        }
+    }
+
+    void flush()
+    {
+        if (!m_pending.empty()) {
+            interrupt(m_pending.front() + m_params.period);
+        }
+    }
+
+    uint64_t batches() const { return m_batches; }
+
+private:
+    void interrupt(uint64_t usec)
+    {
+        for (uint64_t arrival : m_pending) {
+            m_result.delays.push_back(static_cast<uint32_t>(usec - arrival));
+        }
+        m_pending.clear();
+        ++m_result.interrupts;
+        ++m_batches;
+    }
+
+    cq_moderation_params m_params;
+    sim_result &m_result;
+    std::vector<uint64_t> m_pending;
+    uint64_t m_batches = 0;
+};
+
+static void simulate_ring(const std::vector<trace_packet> &packets, int policy, sim_result &result)
+{
+    cq_moderation_policy *p_policy = nullptr;
+    if (policy != SIM_STATIC) {
+        p_policy =
+            cq_moderation_policy::create(static_cast<cq_moderation_policy_t>(policy), g_config);
+    }
+
+    sim_cq cq(g_config.defaults, result);
+    cq_moderation_sample sample = {0, 0, 0, (uint64_t)g_interval_msec * 1000U};
+    uint64_t start = packets.front().usec;
+    uint64_t next_adapt = start + sample.interval_usec;
+    uint64_t prev_batches = 0;
+
+    for (const trace_packet &packet : packets) {
+        while (p_policy && packet.usec >= next_adapt) {
+            cq.advance(next_adapt);
+            sample.batches = cq.batches() - prev_batches;
+            prev_batches = cq.batches();
+            cq.set_params(p_policy->update(sample));
+            sample.packets = sample.bytes = 0;
+            next_adapt += sample.interval_usec;
+        }
+        cq.advance(packet.usec);
+        cq.arrive(packet.usec);
+        ++sample.packets;
+        sample.bytes += packet.bytes;
+    }
+    cq.flush();
+
+    result.packets += packets.size();
+    result.duration_usec = std::max(result.duration_usec, packets.back().usec - start);
+    delete p_policy;
+}
+
+static void report(int policy, sim_result &result)
+{
+    std::vector<uint32_t> &d = result.delays;
+    uint64_t sum = 0;
+
+    if (d.empty()) {
+        return;
+    }
+    std::sort(d.begin(), d.end());
+    for (uint32_t delay : d) {
+        sum += delay;
+    }
+
+    printf("%-6s packets: %lu interrupts: %lu (%.0f/sec) avg batch: %.1f adaptations: %lu "
+           "delay usec avg: %.1f p50: %u p99: %u max: %u\n",
+           policy_name(policy), result.packets, result.interrupts,
+           result.duration_usec ? result.interrupts * 1e6 / result.duration_usec : 0.0,
+           (double)result.packets / result.interrupts, result.adaptations,
+           (double)sum / d.size(), d[d.size() / 2], d[d.size() * 99 / 100], d.back());
+}
+
+static int load_trace(const char *path, trace_t &trace)
+{
+    char line[256];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int ring;
+        unsigned long usec;
+        unsigned bytes;
+
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (sscanf(line, "%d %lu %u", &ring, &usec, &bytes) != 3) {
+            fprintf(stderr, "Invalid trace line: %s", line);
+            fclose(f);
+            return -1;
+        }
+        std::vector<trace_packet> &packets = trace[ring];
+        if (!packets.empty() && usec < packets.back().usec) {
+            fprintf(stderr, "Trace time goes back on ring %d: %s", ring, line);
+            fclose(f);
+            return -1;
+        }
+        packets.push_back({usec, bytes});
+    }
+    fclose(f);
+    return trace.empty() ? -1 : 0;
+}
+
+// Writes a single ring trace of back to back phases <pps>:<burst>:<bytes>:<seconds>
+static int generate(char *spec)
+{
+    uint64_t usec = 0;
+
+    srand(1);
+    for (char *phase = strtok(spec, ","); phase; phase = strtok(nullptr, ",")) {
+        unsigned long pps, burst, bytes, seconds;
+        if (sscanf(phase, "%lu:%lu:%lu:%lu", &pps, &burst, &bytes, &seconds) != 4 || !pps ||
+            !burst) {
+            fprintf(stderr, "Invalid phase: %s\n", phase);
+            return 1;
+        }
+        // Bursts start at exponentially distributed gaps to keep the average rate
+        double mean_gap = 1e6 * burst / pps;
+        uint64_t end = usec + seconds * 1000000UL;
+        while (usec < end) {
+            for (unsigned long i = 0; i < burst; i++) {
+                printf("0 %lu %lu\n", usec, bytes);
+            }
+            double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+            usec += std::max<uint64_t>(1, (uint64_t)(-mean_gap * log(u)));
+        }
+    }
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: cq_moderation_sim [-p static|rate|aimd|all] [-c count] [-d period] "
+            "[-m max count] [-M max period] [-i interval msec] [-r irq rate] "
+            "[-t target usec] <trace>\n"
+            "       cq_moderation_sim -g <pps>:<burst>:<bytes>:<seconds>[,...]\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<int> policies = {SIM_STATIC, CQ_MODERATION_POLICY_RATE, CQ_MODERATION_POLICY_AIMD};
+    trace_t trace;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:c:d:m:M:i:r:t:g:h")) != -1) {
+        switch (opt) {
+        case 'p':
+            if (!strcmp(optarg, "static")) {
+                policies = {SIM_STATIC};
+            } else if (!strcmp(optarg, "rate")) {
+                policies = {CQ_MODERATION_POLICY_RATE};
+            } else if (!strcmp(optarg, "aimd")) {
+                policies = {CQ_MODERATION_POLICY_AIMD};
+            } else if (strcmp(optarg, "all")) {
+                usage();
+                return 1;
+            }
+            break;
+        case 'c':
+            g_config.defaults.count = atoi(optarg);
+            break;
+        case 'd':
+            g_config.defaults.period = atoi(optarg);
+            break;
+        case 'm':
+            g_config.max_count = atoi(optarg);
+            break;
+        case 'M':
+            g_config.max_period = atoi(optarg);
+            break;
+        case 'i':
+            g_interval_msec = atoi(optarg);
+            break;
+        case 'r':
+            g_config.interrupts_rate_per_sec = std::max(atoi(optarg), 1);
+            break;
+        case 't':
+            g_config.latency_target_usec = atoi(optarg);
+            break;
+        case 'g':
+            return generate(optarg);
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if (optind != argc - 1 || g_interval_msec == 0 || load_trace(argv[optind], trace) < 0) {
+        usage();
+        return 1;
+    }
+
+    for (int policy : policies) {
+        sim_result result;
+        for (auto &ring : trace) {
+            simulate_ring(ring.second, policy, result);
+        }
+        report(policy, result);
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+#include "core_stubs/core_stubs.h"
+
+#include "src/core/dev/buffer_pool.h"
+
+#define BPOOL_TEST_BUF_SIZE  1024U
+#define BPOOL_TEST_BLOCK     (1024U * 1024U)
+#define BPOOL_TEST_BLOCK_BUF (BPOOL_TEST_BLOCK / BPOOL_TEST_BUF_SIZE)
+
+/**
+ * Tx pool which exposes the elastic mode internals. The first block holds
+ * the initial 1024 buffers (XLIO_TX_BUFS_BATCH_TCP=1).
+ */
+class bpool_test_pool : public buffer_pool {
+public:
+    bpool_test_pool()
+        : buffer_pool(BUFFER_POOL_TX, BPOOL_TEST_BUF_SIZE)
+    {
+    }
+
+    using buffer_pool::expand_block;
+    using buffer_pool::find_block_lkey;
+    using buffer_pool::reclaim;
+};
+
+class buffer_pool_test : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        stub_mce_sys_reset();
+        safe_mce_sys().memory_block = BPOOL_TEST_BLOCK;
+        safe_mce_sys().memory_reclaim_high = BPOOL_TEST_BLOCK;
+        safe_mce_sys().memory_reclaim_low = BPOOL_TEST_BLOCK;
+        xlio_heap::initialize();
+    }
+    void TearDown()
+    {
+        xlio_heap::finalize();
+        EXPECT_EQ(0, g_stub_mem_regs);
+        mix_base::TearDown();
+    }
+
+    // Pools of the default allocator share the HW heap
+    size_t registered() { return xlio_heap::get(nullptr, nullptr, true)->get_registered_size(); }
+};
+
+/**
+ * @test buffer_pool_test.ti_1
+ * @brief
+ *    Grow the pool by blocks and reclaim the idle ones
+ * @details
+ */
+TEST_F(buffer_pool_test, ti_1)
+{
+    bpool_test_pool pool;
+    descq_t bufs;
+
+    ASSERT_EQ(BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+    EXPECT_EQ(BPOOL_TEST_BLOCK, registered());
+
+    // The request is rounded up to whole blocks
+    ASSERT_TRUE(pool.expand_block(BPOOL_TEST_BLOCK_BUF + 1));
+    EXPECT_EQ(3 * BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+    EXPECT_EQ(3 * BPOOL_TEST_BLOCK, registered());
+    EXPECT_EQ(2, g_stub_mem_regs);
+
+    // A block with buffers in use stays
+    ASSERT_TRUE(pool.get_buffers_thread_safe(bufs, nullptr, 3 * BPOOL_TEST_BLOCK_BUF, 0));
+    EXPECT_EQ(0U, pool.get_free_count());
+    pool.reclaim();
+    EXPECT_EQ(3 * BPOOL_TEST_BLOCK, registered());
+
+    pool.put_buffers_thread_safe(&bufs, bufs.size());
+    EXPECT_EQ(3 * BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+
+    // Idle memory drops to the low watermark, the first block is kept
+    pool.reclaim();
+    EXPECT_EQ(BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+    EXPECT_EQ(BPOOL_TEST_BLOCK, registered());
+    EXPECT_EQ(1, g_stub_mem_regs);
+
+    pool.reclaim();
+    EXPECT_EQ(BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+
+    // The pool grows again on demand
+    ASSERT_TRUE(pool.get_buffers_thread_safe(bufs, nullptr, 2 * BPOOL_TEST_BLOCK_BUF, 0));
+    EXPECT_EQ(2 * BPOOL_TEST_BLOCK_BUF, bufs.size());
+    EXPECT_EQ(3 * BPOOL_TEST_BLOCK, registered());
+    pool.put_buffers_thread_safe(&bufs, bufs.size());
+}
+
+/**
+ * @test buffer_pool_test.ti_2
+ * @brief
+ *    The pool does not grow over the memory limit
+ * @details
+ */
+TEST_F(buffer_pool_test, ti_2)
+{
+    safe_mce_sys().memory_limit = 2 * BPOOL_TEST_BLOCK;
+    bpool_test_pool pool;
+
+    EXPECT_TRUE(pool.expand_block(BPOOL_TEST_BLOCK_BUF));
+    EXPECT_FALSE(pool.expand_block(BPOOL_TEST_BLOCK_BUF));
+    EXPECT_EQ(2 * BPOOL_TEST_BLOCK_BUF, pool.get_free_count());
+    EXPECT_EQ(2 * BPOOL_TEST_BLOCK, registered());
+}
+
+/**
+ * @test buffer_pool_test.ti_3
+ * @brief
+ *    Lkeys of the buffers from an expanded block
+ * @details
+ *    The ring lkey covers only the first block, other blocks are found by
+ *    the device of the owner. Without an owner there is no device.
+ */
+TEST_F(buffer_pool_test, ti_3)
+{
+    bpool_test_pool pool;
+    descq_t bufs;
+    bpool_block *first_block = nullptr;
+    bpool_block *block = nullptr;
+
+    uint32_t ring_lkey = pool.find_lkey_by_ib_ctx_thread_safe(g_stub_ib_ctx);
+    ASSERT_NE(LKEY_ERROR, ring_lkey);
+    ASSERT_TRUE(pool.expand_block(BPOOL_TEST_BLOCK_BUF));
+
+    // Both blocks, the buffers of the expanded one come first
+    ASSERT_TRUE(pool.get_buffers_thread_safe(bufs, nullptr, 2 * BPOOL_TEST_BLOCK_BUF, ring_lkey));
+    for (mem_buf_desc_t *desc : bufs) {
+        ASSERT_NE(nullptr, desc->p_block);
+        if (desc->lkey == ring_lkey) {
+            first_block = first_block ?: desc->p_block;
+            EXPECT_EQ(first_block, desc->p_block);
+        } else {
+            EXPECT_EQ(LKEY_ERROR, desc->lkey);
+            block = block ?: desc->p_block;
+            EXPECT_EQ(block, desc->p_block);
+        }
+    }
+    ASSERT_NE(nullptr, first_block);
+    ASSERT_NE(nullptr, block);
+    ASSERT_NE(first_block, block);
+
+    EXPECT_EQ(ring_lkey, pool.find_block_lkey(first_block, g_stub_ib_ctx));
+    uint32_t lkey = pool.find_block_lkey(block, g_stub_ib_ctx);
+    EXPECT_NE(LKEY_ERROR, lkey);
+    EXPECT_NE(ring_lkey, lkey);
+    EXPECT_EQ(LKEY_ERROR, pool.find_block_lkey(block, nullptr));
+
+    // Buffers from the pool without an lkey keep it unset
+    pool.put_buffers_thread_safe(&bufs, bufs.size());
+    ASSERT_TRUE(pool.get_buffers_thread_safe(bufs, nullptr, 2 * BPOOL_TEST_BLOCK_BUF, 0));
+    for (mem_buf_desc_t *desc : bufs) {
+        EXPECT_EQ(0U, desc->lkey);
+    }
+    pool.put_buffers_thread_safe(&bufs, bufs.size());
+}
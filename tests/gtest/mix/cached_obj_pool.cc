@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+
+#include "mix_base.h"
+#include "core_stubs/core_stubs.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/core/util/cached_obj_pool.h"
+
+#define OBJ_POOL_TEST_BATCH   1024U
+#define OBJ_POOL_TEST_THREADS 8
+
+struct obj_pool_test_obj {
+    obj_pool_test_obj *next;
+    int owner; // 0 while the object is in the pool
+    char pad[48];
+};
+
+class obj_pool_test_pool : public cached_obj_pool<obj_pool_test_obj> {
+public:
+    obj_pool_test_pool(uint32_t &size, uint32_t &no_objs)
+        : cached_obj_pool<obj_pool_test_obj>("gtest objects", OBJ_POOL_TEST_BATCH, size, no_objs)
+    {
+    }
+
+    unsigned total_objs() const { return m_stats.total_objs; }
+    uint32_t slot() const { return m_slot; }
+};
+
+class cached_obj_pool_test : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        stub_mce_sys_reset();
+        xlio_heap::initialize();
+        m_size = 0U;
+        m_no_objs = 0U;
+    }
+    void TearDown()
+    {
+        xlio_heap::finalize();
+        mix_base::TearDown();
+    }
+
+    // Takes 'amount' objects and marks them with the owner, false if any is not free
+    static bool take(obj_pool_test_pool &pool, uint32_t amount, int owner,
+                     obj_pool_test_obj *&list)
+    {
+        bool ok = true;
+
+        list = pool.get_objs(amount);
+        for (obj_pool_test_obj *obj = list; obj; obj = obj->next) {
+            int expected = 0;
+            ok = __atomic_compare_exchange_n(&obj->owner, &expected, owner, false,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED) &&
+                ok;
+            amount--;
+        }
+        return ok && amount == 0U;
+    }
+
+    static void give(obj_pool_test_pool &pool, obj_pool_test_obj *list)
+    {
+        for (obj_pool_test_obj *obj = list; obj; obj = obj->next) {
+            __atomic_store_n(&obj->owner, 0, __ATOMIC_RELAXED);
+        }
+        pool.put_objs(list);
+    }
+
+    uint32_t m_size;
+    uint32_t m_no_objs;
+};
+
+/**
+ * @test cached_obj_pool_test.ti_1
+ * @brief
+ *    Concurrent get/put never hands out an object twice or loses one
+ * @details
+ *    Threads take lists of varying length, below and above a batch, and give
+ *    them back in a different order. The front caches are flushed when the
+ *    threads exit, then a single request gets every object of the pool.
+ */
+TEST_F(cached_obj_pool_test, ti_1)
+{
+    obj_pool_test_pool pool(m_size, m_no_objs);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 1; t <= OBJ_POOL_TEST_THREADS; t++) {
+        threads.emplace_back([&pool, &failures, t]() {
+            obj_pool_test_obj *held[4] = {nullptr, nullptr, nullptr, nullptr};
+
+            for (uint32_t i = 0; i < 20000U; i++) {
+                uint32_t idx = i % 4U;
+                if (held[idx]) {
+                    give(pool, held[idx]);
+                }
+                uint32_t amount = 1U + (i * 7U + (uint32_t)t * 13U) % 150U;
+                if (!take(pool, amount, t, held[idx])) {
+                    failures++;
+                }
+            }
+            for (uint32_t idx = 0; idx < 4U; idx++) {
+                give(pool, held[idx]);
+            }
+        });
+    }
+    for (auto &thr : threads) {
+        thr.join();
+    }
+
+    EXPECT_EQ(0, failures);
+    EXPECT_EQ(0U, m_no_objs);
+    EXPECT_EQ(pool.total_objs(), m_size);
+
+    // The main thread cache is empty, so every object comes from the depot
+    uint32_t total = pool.total_objs();
+    obj_pool_test_obj *all = nullptr;
+    std::thread([&]() {
+        EXPECT_TRUE(take(pool, total, -1, all));
+        give(pool, all);
+    }).join();
+    EXPECT_EQ(pool.total_objs(), total);
+}
+
+/**
+ * @test cached_obj_pool_test.ti_2
+ * @brief
+ *    A pool destroyed while another thread caches its objects
+ * @details
+ *    The destruction drains the cache of the thread, so the pool size counts
+ *    the objects the thread still holds. A new pool reuses the slot, and the
+ *    exit of the thread must not flush the stale cache into it.
+ */
+TEST_F(cached_obj_pool_test, ti_2)
+{
+    std::unique_ptr<obj_pool_test_pool> pool(new obj_pool_test_pool(m_size, m_no_objs));
+    std::atomic<int> state(0);
+    uint32_t slot = pool->slot();
+    uint32_t total = pool->total_objs();
+    bool ok = false;
+
+    ASSERT_LT(slot, CACHED_OBJ_POOL_MAX_POOLS);
+
+    std::thread thr([&]() {
+        obj_pool_test_obj *list;
+        ok = take(*pool, 10U, 1, list);
+        // Half of the objects go back to the front cache, half stay out
+        obj_pool_test_obj *rest = list->next->next->next->next->next;
+        list->next->next->next->next->next = nullptr;
+        give(*pool, rest);
+        state = 1;
+        while (state != 2) {
+            std::this_thread::yield();
+        }
+    });
+    while (state != 1) {
+        std::this_thread::yield();
+    }
+
+    pool.reset();
+    EXPECT_EQ(total - 5U, m_size);
+
+    uint32_t size2 = 0U;
+    uint32_t no_objs2 = 0U;
+    obj_pool_test_pool pool2(size2, no_objs2);
+    EXPECT_EQ(slot, pool2.slot());
+
+    state = 2;
+    thr.join();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(pool2.total_objs(), size2);
+}
+
+/**
+ * @test cached_obj_pool_test.ti_3
+ * @brief
+ *    Pools beyond the front cache slots work on the depot
+ * @details
+ *    The pool without a slot still serves get/put from several threads.
+ */
+TEST_F(cached_obj_pool_test, ti_3)
+{
+    std::vector<std::unique_ptr<obj_pool_test_pool>> pools;
+    uint32_t sizes[CACHED_OBJ_POOL_MAX_POOLS + 1U] = {0U};
+
+    for (uint32_t i = 0; i <= CACHED_OBJ_POOL_MAX_POOLS; i++) {
+        pools.emplace_back(new obj_pool_test_pool(sizes[i], m_no_objs));
+    }
+    obj_pool_test_pool &last = *pools.back();
+    ASSERT_EQ(CACHED_OBJ_POOL_MAX_POOLS, last.slot());
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 1; t <= 4; t++) {
+        threads.emplace_back([&last, &failures, t]() {
+            for (uint32_t i = 0; i < 1000U; i++) {
+                obj_pool_test_obj *list;
+                if (!take(last, 1U + i % 100U, t, list)) {
+                    failures++;
+                }
+                give(last, list);
+            }
+        });
+    }
+    for (auto &thr : threads) {
+        thr.join();
+    }
+
+    EXPECT_EQ(0, failures);
+    EXPECT_EQ(last.total_objs(), sizes[CACHED_OBJ_POOL_MAX_POOLS]);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/xlio_stats.h"
+
+class lat_hist_test : public mix_base {
+public:
+    lat_hist_t hist;
+    lat_hist_test() { memset(&hist, 0, sizeof(hist)); }
+};
+
+//! Small values are counted exactly
+TEST_F(lat_hist_test, lat_hist_small_values)
+{
+    for (uint64_t v = 0; v < 16; v++) {
+        EXPECT_EQ(v, lat_hist_t::bucket_index(v));
+        EXPECT_EQ(v, lat_hist_t::bucket_value(v));
+    }
+}
+
+//! Every value lands in a bucket whose bounds contain it
+TEST_F(lat_hist_test, lat_hist_bucket_bounds)
+{
+    uint32_t prev_idx = 0;
+    for (uint64_t v = 1; v < (1ULL << LAT_HIST_MAX_BITS); v += v / 7 + 1) {
+        uint32_t idx = lat_hist_t::bucket_index(v);
+        ASSERT_LT(idx, (uint32_t)LAT_HIST_BUCKETS);
+        EXPECT_GE(idx, prev_idx);
+        EXPECT_GE(lat_hist_t::bucket_value(idx), v);
+        if (idx) {
+            EXPECT_LT(lat_hist_t::bucket_value(idx - 1), v);
+        }
+        /* Relative error of the log-linear buckets */
+        EXPECT_LE(lat_hist_t::bucket_value(idx) - v, v >> (LAT_HIST_SUB_BITS - 1));
+        prev_idx = idx;
+    }
+    EXPECT_EQ((uint32_t)LAT_HIST_BUCKETS - 1, lat_hist_t::bucket_index(UINT64_MAX));
+}
+
+//! Percentiles and totals
+TEST_F(lat_hist_test, lat_hist_percentiles)
+{
+    EXPECT_EQ(0U, hist.percentile(50));
+
+    for (uint64_t v = 1; v <= 1000; v++) {
+        hist.add(v);
+    }
+    hist.add_atomic(100000);
+
+    EXPECT_EQ(1001U, hist.n_samples);
+    EXPECT_EQ(500500U + 100000U, hist.n_sum);
+    EXPECT_EQ(100000U, hist.n_max);
+
+    uint64_t p50 = hist.percentile(50);
+    EXPECT_GE(p50, 500U);
+    EXPECT_LE(p50, 500U + 500U / 4);
+    uint64_t p99 = hist.percentile(99);
+    EXPECT_GE(p99, 990U);
+    EXPECT_LE(p99, 990U + 990U / 4);
+    EXPECT_GE(hist.percentile(100), 100000U);
+}
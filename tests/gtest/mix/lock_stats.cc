@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+
+#include "mix_base.h"
+#include "core_stubs/core_stubs.h"
+
+#include <atomic>
+#include <thread>
+
+#include "src/core/util/instrumentation.h"
+#include "src/utils/lock_wrapper.h"
+
+/**
+ * Lock contention profiler (XLIO_STATS_LOCKS) over the lock_wrapper locks.
+ * Profiled acquisitions run on helper threads only: their per thread counters
+ * reach the shared block when the thread exits.
+ */
+class lock_stats : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        stub_mce_sys_reset();
+        g_stub_lock_stats = lock_stats_block_t();
+        safe_mce_sys().stats_locks = true;
+        lock_stats_init();
+    }
+    void TearDown()
+    {
+        lock_stats_fini();
+        safe_mce_sys().stats_locks = false;
+        mix_base::TearDown();
+    }
+};
+
+/**
+ * @test lock_stats.ti_1
+ * @brief
+ *    Uncontended acquisitions are counted and sampled for the hold time
+ * @details
+ *    The first acquisition only resolves the entry. The remaining ones are
+ *    below a multiple of the flush batch, the rest is flushed at thread exit.
+ */
+TEST_F(lock_stats, ti_1)
+{
+    const int n = 1000;
+    lock_spin lock("gtest_lock_spin");
+
+    std::thread thr([&lock]() {
+        for (int i = 0; i < n; i++) {
+            lock.lock();
+            lock.unlock();
+        }
+    });
+    thr.join();
+
+    ASSERT_EQ(1U, g_stub_lock_stats.n_locks);
+    const lock_stats_t &entry = g_stub_lock_stats.locks[0];
+    EXPECT_STREQ("gtest_lock_spin", entry.name);
+    EXPECT_EQ(1U, entry.n_instances);
+    EXPECT_EQ((uint64_t)(n - 1), entry.n_acquired);
+    EXPECT_EQ(0U, entry.n_contended);
+    EXPECT_EQ(0U, entry.wait_hist.n_samples);
+    uint32_t rate = g_stub_lock_stats.hold_sample_rate;
+    ASSERT_LT(0U, rate);
+    EXPECT_EQ((uint64_t)((n - 1 + rate - 1) / rate), entry.hold_hist.n_samples);
+}
+
+/**
+ * @test lock_stats.ti_2
+ * @brief
+ *    A contended acquisition lands in the wait histogram
+ * @details
+ *    One thread holds the lock for 20 msec, the other one blocks on it
+ *    meanwhile. Both the hold and the wait are far above a millisecond.
+ */
+TEST_F(lock_stats, ti_2)
+{
+    const uint64_t msec = get_tsc_rate_per_second() / 1000U;
+    lock_mutex lock("gtest_lock_mutex");
+    std::atomic<bool> held(false);
+
+    std::thread holder([&lock, &held]() {
+        lock.lock();
+        lock.unlock();
+        lock.lock();
+        held = true;
+        usleep(20000);
+        lock.unlock();
+    });
+    std::thread waiter([&lock, &held]() {
+        while (!held) {
+            std::this_thread::yield();
+        }
+        lock.lock();
+        lock.unlock();
+    });
+    holder.join();
+    waiter.join();
+
+    ASSERT_EQ(1U, g_stub_lock_stats.n_locks);
+    const lock_stats_t &entry = g_stub_lock_stats.locks[0];
+    EXPECT_EQ(2U, entry.n_acquired);
+    EXPECT_EQ(1U, entry.n_contended);
+    EXPECT_EQ(1U, entry.wait_hist.n_samples);
+    EXPECT_LT(msec, entry.wait_hist.n_max);
+    EXPECT_LT(0U, entry.wait_hist.percentile(50));
+    // The first acquisition of each thread is sampled
+    EXPECT_EQ(2U, entry.hold_hist.n_samples);
+    EXPECT_LT(10 * msec, entry.hold_hist.n_max);
+}
+
+/**
+ * @test lock_stats.ti_3
+ * @brief
+ *    A thread exiting after lock_stats_fini() leaves the block alone
+ * @details
+ *    The counters pending in the thread are dropped instead of being flushed
+ *    into the statistics which are about to be closed. Acquisitions after the
+ *    profiler is stopped are not profiled.
+ */
+TEST_F(lock_stats, ti_3)
+{
+    lock_spin lock("gtest_lock_fini");
+    std::atomic<bool> counted(false);
+    std::atomic<bool> stopped(false);
+
+    std::thread thr([&]() {
+        for (int i = 0; i < 10; i++) {
+            lock.lock();
+            lock.unlock();
+        }
+        counted = true;
+        while (!stopped) {
+            std::this_thread::yield();
+        }
+        lock.lock();
+        lock.unlock();
+    });
+    while (!counted) {
+        std::this_thread::yield();
+    }
+    lock_stats_fini();
+    stopped = true;
+    thr.join();
+
+    ASSERT_EQ(1U, g_stub_lock_stats.n_locks);
+    const lock_stats_t &entry = g_stub_lock_stats.locks[0];
+    EXPECT_EQ(0U, entry.n_acquired);
+    EXPECT_EQ(1U, entry.hold_hist.n_samples);
+    EXPECT_FALSE(g_b_lock_stats);
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+#include "core_stubs/core_stubs.h"
+
+#include <stdlib.h>
+#include <string>
+#include <thread>
+
+#include "src/core/dev/allocator.h"
+#include "src/core/util/libxlio.h"
+
+#define PARALLEL_INIT_HEAP_SIZE (8U * 1024U * 1024U)
+
+/**
+ * Work which XLIO_PARALLEL_INIT moves off the initialization thread: the
+ * configuration file parsing and the HW heap registration.
+ */
+class parallel_init : public mix_base {
+protected:
+    void SetUp()
+    {
+        mix_base::SetUp();
+        stub_mce_sys_reset();
+        safe_mce_sys().memory_limit = PARALLEL_INIT_HEAP_SIZE;
+        xlio_heap::initialize();
+    }
+    void TearDown()
+    {
+        xlio_heap::finalize();
+        EXPECT_EQ(0, g_stub_mem_regs);
+        mix_base::TearDown();
+    }
+
+    struct heap_state {
+        bool alloc_ok;
+        size_t registered;
+        bool lkey_ok;
+        int mem_regs;
+    };
+
+    // Allocates the whole heap, so the memory must be registered
+    heap_state check_heap(xlio_heap *heap)
+    {
+        heap_state state;
+        size_t size = PARALLEL_INIT_HEAP_SIZE;
+        void *data = heap->alloc(size);
+
+        state.alloc_ok = data && size == PARALLEL_INIT_HEAP_SIZE;
+        if (data) {
+            memset(data, 0xa5, size);
+            state.alloc_ok = state.alloc_ok && ((uint8_t *)data)[size - 1] == 0xa5;
+        }
+        state.registered = heap->get_registered_size();
+        state.lkey_ok = heap->find_lkey_by_ib_ctx(g_stub_ib_ctx) != LKEY_ERROR;
+        state.mem_regs = g_stub_mem_regs;
+        return state;
+    }
+};
+
+/**
+ * @test parallel_init.ti_1
+ * @brief
+ *    The HW heap registered in background matches the serial one
+ * @details
+ */
+TEST_F(parallel_init, ti_1)
+{
+    heap_state serial = check_heap(xlio_heap::get(nullptr, nullptr, true));
+    xlio_heap::finalize();
+    ASSERT_EQ(0, g_stub_mem_regs);
+
+    xlio_heap::initialize();
+    xlio_heap::prefetch(nullptr, nullptr);
+    // Pools get the heap which is being registered
+    heap_state parallel = check_heap(xlio_heap::get(nullptr, nullptr, true));
+
+    EXPECT_TRUE(serial.alloc_ok);
+    EXPECT_TRUE(serial.lkey_ok);
+    EXPECT_EQ(PARALLEL_INIT_HEAP_SIZE, serial.registered);
+    EXPECT_EQ(1, serial.mem_regs);
+
+    EXPECT_EQ(serial.alloc_ok, parallel.alloc_ok);
+    EXPECT_EQ(serial.lkey_ok, parallel.lkey_ok);
+    EXPECT_EQ(serial.registered, parallel.registered);
+    EXPECT_EQ(serial.mem_regs, parallel.mem_regs);
+}
+
+/**
+ * @test parallel_init.ti_2
+ * @brief
+ *    Memory requested while the registration runs
+ * @details
+ *    The request waits for the registration and gets registered memory.
+ */
+TEST_F(parallel_init, ti_2)
+{
+    g_stub_mem_reg_delay_usec = 100000;
+    xlio_heap::prefetch(nullptr, nullptr);
+    xlio_heap *heap = xlio_heap::get(nullptr, nullptr, true);
+    EXPECT_EQ(0, g_stub_mem_regs);
+
+    size_t size = 4096;
+    uint8_t *data = (uint8_t *)heap->alloc(size);
+    ASSERT_NE(nullptr, data);
+    EXPECT_EQ(1, g_stub_mem_regs);
+    EXPECT_NE(LKEY_ERROR, heap->find_lkey_by_ib_ctx(g_stub_ib_ctx));
+    memset(data, 0x5a, size);
+    EXPECT_EQ(0x5a, data[size - 1]);
+
+    // The rest of the heap is still available
+    size = PARALLEL_INIT_HEAP_SIZE - 4096;
+    EXPECT_NE(nullptr, heap->alloc(size));
+}
+
+/**
+ * @test parallel_init.ti_3
+ * @brief
+ *    Failed background registration
+ * @details
+ *    The failure is reported once, like a failure of the serial
+ *    initialization, and the heap stays empty.
+ */
+TEST_F(parallel_init, ti_3)
+{
+    g_stub_mem_reg_fail = true;
+    EXPECT_THROW(xlio_heap::get(nullptr, nullptr, true), xlio_error);
+    xlio_heap::finalize();
+
+    xlio_heap::initialize();
+    xlio_heap::prefetch(nullptr, nullptr);
+    xlio_heap *heap = xlio_heap::get(nullptr, nullptr, true);
+
+    size_t size = 4096;
+    EXPECT_THROW(heap->alloc(size), xlio_error);
+    EXPECT_EQ(nullptr, heap->alloc(size));
+    EXPECT_EQ(LKEY_ERROR, heap->find_lkey_by_ib_ctx(g_stub_ib_ctx));
+}
+
+static std::string config_dump()
+{
+    std::string dump;
+    char buf[256];
+
+    for (dbl_lst_node *node = __instance_list.head; node; node = node->next) {
+        struct instance *inst = (struct instance *)node->data;
+        const dbl_lst *lists[] = {&inst->tcp_clt_rules_lst, &inst->tcp_srv_rules_lst,
+                                  &inst->udp_snd_rules_lst, &inst->udp_rcv_rules_lst,
+                                  &inst->udp_con_rules_lst};
+
+        dump += std::string(inst->id.prog_name_expr) + " " + inst->id.user_defined_id + "\n";
+        for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); ++i) {
+            for (dbl_lst_node *rnode = lists[i]->head; rnode; rnode = rnode->next) {
+                struct use_family_rule *rule = (struct use_family_rule *)rnode->data;
+                const address_port_rule *addr = &rule->first;
+
+                snprintf(buf, sizeof(buf), "%zu %d %d", i, rule->target_transport,
+                         rule->protocol);
+                dump += buf;
+                // Fields of a wildcard are left unset by the parser
+                if (addr->match_by_addr) {
+                    snprintf(buf, sizeof(buf), " %x/%u", addr->ipv4.s_addr, addr->prefixlen);
+                    dump += buf;
+                }
+                if (addr->match_by_port) {
+                    snprintf(buf, sizeof(buf), " %u-%u", addr->sport, addr->eport);
+                    dump += buf;
+                }
+                dump += rule->use_second ? " second\n" : "\n";
+            }
+        }
+    }
+    return dump;
+}
+
+/**
+ * @test parallel_init.ti_4
+ * @brief
+ *    Configuration file parsed by the helper thread
+ * @details
+ *    The rules match the ones parsed by the initialization thread.
+ */
+TEST_F(parallel_init, ti_4)
+{
+    char path[] = "/tmp/xlio_conf_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_LE(0, fd);
+
+    const char conf[] = "application-id * *\n"
+                        "use os udp_connect *:53\n"
+                        "use os tcp_server 10.0.0.0/8:8000-8100\n"
+                        "use os tcp_client 192.168.1.1:*\n"
+                        "application-id gtest* 1\n"
+                        "use os udp_receiver *:5001\n";
+    ASSERT_EQ((ssize_t)sizeof(conf) - 1, write(fd, conf, sizeof(conf) - 1));
+    close(fd);
+
+    ASSERT_EQ(0, __xlio_parse_config_file(path));
+    std::string serial = config_dump();
+
+    int rc = -1;
+    std::thread parser([&rc, &path]() { rc = __xlio_parse_config_file(path); });
+    parser.join();
+    std::string parallel = config_dump();
+    unlink(path);
+
+    EXPECT_EQ(0, rc);
+    EXPECT_NE(std::string::npos, serial.find("gtest* 1"));
+    EXPECT_EQ(serial, parallel);
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+
+#include <thread>
+
+#include "src/core/util/xlio_stats.h"
+
+#define SEQ_TEST_VALUES 32
+
+static global_stats_t s_global_stats; // Cache line aligned, which new does not ensure in C++11
+
+struct seq_test_block {
+    bool b_enabled;
+    uint32_t seq;
+    uint64_t values[SEQ_TEST_VALUES];
+};
+
+class stats_seq_test : public mix_base {
+public:
+    seq_test_block blocks[2];
+    seq_test_block copy[2];
+    stats_seq_test()
+    {
+        memset(blocks, 0, sizeof(blocks));
+        memset(copy, 0, sizeof(copy));
+    }
+    static void fill(seq_test_block &block, uint64_t value)
+    {
+        for (int i = 0; i < SEQ_TEST_VALUES; i++) {
+            block.values[i] = value;
+        }
+    }
+    static bool is_torn(const seq_test_block &block)
+    {
+        for (int i = 1; i < SEQ_TEST_VALUES; i++) {
+            if (block.values[i] != block.values[0]) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+//! Stable blocks are copied as is
+TEST_F(stats_seq_test, stats_seq_stable)
+{
+    fill(blocks[0], 7);
+    fill(blocks[1], 9);
+    stats_seq_write_begin(&blocks[1].seq);
+    stats_seq_write_end(&blocks[1].seq);
+
+    EXPECT_EQ(2U, blocks[1].seq);
+    ASSERT_TRUE(stats_seq_read(copy, blocks, 2));
+    EXPECT_EQ(0, memcmp(copy, blocks, sizeof(blocks)));
+}
+
+//! A block which stays in a write section fails the read instead of returning a torn copy
+TEST_F(stats_seq_test, stats_seq_writer_stuck)
+{
+    stats_seq_write_begin(&blocks[1].seq);
+    fill(blocks[1], 3);
+
+    EXPECT_FALSE(stats_seq_read(copy, blocks, 2));
+
+    stats_seq_write_end(&blocks[1].seq);
+    EXPECT_TRUE(stats_seq_read(copy, blocks, 2));
+    EXPECT_EQ(3U, copy[1].values[SEQ_TEST_VALUES - 1]);
+}
+
+//! A concurrent writer never exposes a half written block to a successful read
+TEST_F(stats_seq_test, stats_seq_concurrent)
+{
+    std::atomic<bool> stop(false);
+    std::thread writer([&] {
+        for (uint64_t value = 1; !stop.load(std::memory_order_relaxed); value++) {
+            stats_seq_write_begin(&blocks[0].seq);
+            for (int i = 0; i < SEQ_TEST_VALUES; i++) {
+                __atomic_store_n(&blocks[0].values[i], value, __ATOMIC_RELAXED);
+            }
+            stats_seq_write_end(&blocks[0].seq);
+        }
+    });
+
+    int consistent = 0;
+    for (int i = 0; i < 20000; i++) {
+        if (stats_seq_read(copy, blocks, 1)) {
+            consistent++;
+            ASSERT_FALSE(is_torn(copy[0])) << "read " << i;
+            ASSERT_EQ(0U, copy[0].seq & 1);
+        }
+    }
+    stop = true;
+    writer.join();
+    EXPECT_GT(consistent, 0);
+}
+
+//! Socket statistics find the sequence of their shared memory block
+TEST_F(stats_seq_test, stats_seq_socket_block)
+{
+    socket_instance_block_t *p_block = new socket_instance_block_t;
+    EXPECT_EQ(&p_block->seq, socket_stats_block_seq(&p_block->skt_stats));
+    delete p_block;
+}
+
+//! Global counters are updated in thread slots and summed by the reader
+TEST_F(stats_seq_test, stats_seq_global_slots)
+{
+    const int n_threads = NUM_OF_GLOBAL_STATS_SLOTS + 4;
+    const uint64_t n_incs = 10000;
+    global_stats_t *p_stats = &s_global_stats;
+    std::vector<std::thread> threads;
+
+    p_stats->init();
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([p_stats, n_incs] {
+            for (uint64_t i = 0; i < n_incs; i++) {
+                p_stats->thread_slot().n_tcp_timer_ticks.fetch_add(1U, std::memory_order_relaxed);
+                p_stats->thread_slot().n_tcp_timer_sockets.fetch_add(2U,
+                                                                     std::memory_order_relaxed);
+            }
+            p_stats->thread_slot().n_tcp_destructed.fetch_add(1U, std::memory_order_relaxed);
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(0U, p_stats->n_tcp_timer_ticks);
+    p_stats->aggregate();
+    EXPECT_EQ(n_threads * n_incs, p_stats->n_tcp_timer_ticks);
+    EXPECT_EQ(2 * n_threads * n_incs, p_stats->n_tcp_timer_sockets);
+    EXPECT_EQ(n_threads, p_stats->socket_tcp_destructor_counter);
+    EXPECT_EQ(0, p_stats->socket_udp_destructor_counter);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/xlio_stats.h"
+
+#define TRACE_TEST_CAPACITY 8
+
+class trace_ring_test : public mix_base {
+public:
+    trace_ring_hdr_t hdr;
+    trace_event_t events[TRACE_TEST_CAPACITY];
+    trace_event_t out[TRACE_TEST_CAPACITY];
+    trace_ring_test()
+    {
+        memset(&hdr, 0, sizeof(hdr));
+        memset(events, 0, sizeof(events));
+    }
+    void push(uint64_t tsc)
+    {
+        trace_event_t ev = {tsc, 1, TRACE_CQ_POLL, 0};
+        trace_ring_push(&hdr, events, TRACE_TEST_CAPACITY - 1, ev);
+    }
+};
+
+//! Empty and partially filled ring
+TEST_F(trace_ring_test, trace_ring_partial)
+{
+    EXPECT_EQ(0U, trace_ring_snapshot(&hdr, events, TRACE_TEST_CAPACITY, out));
+
+    for (uint64_t i = 0; i < 5; i++) {
+        push(100 + i);
+    }
+    ASSERT_EQ(5U, trace_ring_snapshot(&hdr, events, TRACE_TEST_CAPACITY, out));
+    for (uint64_t i = 0; i < 5; i++) {
+        EXPECT_EQ(100 + i, out[i].tsc);
+    }
+}
+
+//! Wrapped ring is returned oldest first, the slot which is next to be written is dropped
+TEST_F(trace_ring_test, trace_ring_wrap)
+{
+    for (uint64_t i = 0; i < 3 * TRACE_TEST_CAPACITY + 3; i++) {
+        push(i);
+    }
+    uint32_t n = trace_ring_snapshot(&hdr, events, TRACE_TEST_CAPACITY, out);
+    ASSERT_EQ((uint32_t)TRACE_TEST_CAPACITY - 1, n);
+    for (uint32_t i = 0; i < n; i++) {
+        EXPECT_EQ(hdr.head - n + i, out[i].tsc);
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "common/def.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/txtime_queue.h"
+
+class txtime_queue_test : public mix_base {
+public:
+    txtime_queue<int> queue;
+    uint64_t clock_ns; // Software clock which drives the queue
+    txtime_queue_test()
+        : clock_ns(1000)
+    {
+    }
+    int release(std::vector<int> &out)
+    {
+        uint64_t txtime;
+        int item;
+        int n = 0;
+        while (queue.pop_expired(clock_ns, txtime, item)) {
+            EXPECT_LE(txtime, clock_ns);
+            out.push_back(item);
+            n++;
+        }
+        return n;
+    }
+};
+
+//! Packets are not released before their launch time
+TEST_F(txtime_queue_test, txtime_queue_not_before_launch)
+{
+    std::vector<int> out;
+
+    EXPECT_EQ(0, release(out));
+    queue.push(clock_ns + 500, 1);
+    EXPECT_EQ(clock_ns + 500, queue.next_txtime());
+
+    EXPECT_EQ(0, release(out));
+    clock_ns += 499;
+    EXPECT_EQ(0, release(out));
+    clock_ns += 1;
+    EXPECT_EQ(1, release(out));
+    EXPECT_TRUE(queue.empty());
+}
+
+//! Release follows the launch times, not the send order
+TEST_F(txtime_queue_test, txtime_queue_time_order)
+{
+    std::vector<int> out;
+
+    queue.push(clock_ns + 300, 3);
+    queue.push(clock_ns + 100, 1);
+    queue.push(clock_ns + 200, 2);
+    EXPECT_EQ(3U, queue.size());
+    EXPECT_EQ(clock_ns + 100, queue.next_txtime());
+
+    clock_ns += 250;
+    EXPECT_EQ(2, release(out));
+    clock_ns += 50;
+    EXPECT_EQ(1, release(out));
+
+    ASSERT_EQ(3U, out.size());
+    EXPECT_EQ(1, out[0]);
+    EXPECT_EQ(2, out[1]);
+    EXPECT_EQ(3, out[2]);
+}
+
+//! Packets with the same launch time keep their send order
+TEST_F(txtime_queue_test, txtime_queue_stable)
+{
+    std::vector<int> out;
+
+    for (int i = 0; i < 64; i++) {
+        queue.push(clock_ns + 100 * (i % 2), i);
+    }
+    clock_ns += 100;
+    EXPECT_EQ(64, release(out));
+
+    ASSERT_EQ(64U, out.size());
+    for (int i = 0; i < 32; i++) {
+        EXPECT_EQ(2 * i, out[i]);
+        EXPECT_EQ(2 * i + 1, out[32 + i]);
+    }
+}
+
+//! Launch times in the past are released immediately
+TEST_F(txtime_queue_test, txtime_queue_late)
+{
+    std::vector<int> out;
+
+    queue.push(clock_ns - 10, 1);
+    queue.push(0, 2);
+    EXPECT_EQ(2, release(out));
+    ASSERT_EQ(2U, out.size());
+    EXPECT_EQ(2, out[0]);
+    EXPECT_EQ(1, out[1]);
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "sock_base.h"
+
+/**
+ * Non offloaded fds in an epoll set. Under XLIO with XLIO_EPOLL_OS_URING=1
+ * they are watched by the io_uring poller instead of the OS epoll fd.
+ */
+class sock_epoll : public sock_base {
+protected:
+    void SetUp()
+    {
+        sock_base::SetUp();
+        m_epfd = epoll_create1(0);
+        ASSERT_LE(0, m_epfd);
+        ASSERT_EQ(0, pipe(m_pipe));
+    }
+    void TearDown()
+    {
+        if (m_pipe[0] >= 0) {
+            close(m_pipe[0]);
+        }
+        if (m_pipe[1] >= 0) {
+            close(m_pipe[1]);
+        }
+        close(m_epfd);
+        sock_base::TearDown();
+    }
+
+    int ctl(int op, int fd, uint32_t events, uint64_t data)
+    {
+        struct epoll_event event;
+
+        event.events = events;
+        event.data.u64 = data;
+        return epoll_ctl(m_epfd, op, fd, &event);
+    }
+
+    // Returns the number of events, the first one is stored in m_event
+    int wait(int timeout)
+    {
+        struct epoll_event events[4];
+        int rc = epoll_wait(m_epfd, events, 4, timeout);
+        if (rc > 0) {
+            m_event = events[0];
+        }
+        return rc;
+    }
+
+    void fill() { EXPECT_EQ(1, write(m_pipe[1], "x", 1)); }
+
+    void drain()
+    {
+        char buf[64];
+        EXPECT_LT(0, read(m_pipe[0], buf, sizeof(buf)));
+    }
+
+    int m_epfd = -1;
+    int m_pipe[2] = {-1, -1};
+    struct epoll_event m_event;
+};
+
+static const uint64_t s_data = 0x1234567890abcdefULL;
+
+/**
+ * @test sock_epoll.ti_1
+ * @brief
+ *    Add a pipe and check level triggered reports
+ * @details
+ */
+TEST_F(sock_epoll, ti_1)
+{
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data));
+    EXPECT_EQ(0, wait(10));
+
+    fill();
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ((uint32_t)EPOLLIN, m_event.events);
+    EXPECT_EQ(s_data, m_event.data.u64);
+
+    // Still readable, a level triggered fd is reported again
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ(s_data, m_event.data.u64);
+
+    drain();
+    EXPECT_EQ(0, wait(10));
+
+    errno = EOK;
+    EXPECT_EQ(-1, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data));
+    EXPECT_EQ(EEXIST, errno);
+}
+
+/**
+ * @test sock_epoll.ti_2
+ * @brief
+ *    Modify the events and data of a pipe
+ * @details
+ *    EPOLLONESHOT disarms the fd after the first report until EPOLL_CTL_MOD.
+ */
+TEST_F(sock_epoll, ti_2)
+{
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN | EPOLLONESHOT, s_data));
+
+    fill();
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ(s_data, m_event.data.u64);
+    EXPECT_EQ(0, wait(10));
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_MOD, m_pipe[0], EPOLLIN | EPOLLONESHOT, s_data + 1));
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ((uint32_t)EPOLLIN, m_event.events);
+    EXPECT_EQ(s_data + 1, m_event.data.u64);
+    EXPECT_EQ(0, wait(10));
+
+    // A readable fd which is not watched for EPOLLIN any more
+    ASSERT_EQ(0, ctl(EPOLL_CTL_MOD, m_pipe[0], EPOLLPRI, s_data + 2));
+    EXPECT_EQ(0, wait(10));
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_MOD, m_pipe[0], EPOLLIN, s_data + 3));
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ(s_data + 3, m_event.data.u64);
+}
+
+/**
+ * @test sock_epoll.ti_3
+ * @brief
+ *    Delete a ready pipe and add it again
+ * @details
+ */
+TEST_F(sock_epoll, ti_3)
+{
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data));
+    fill();
+    ASSERT_EQ(1, wait(100));
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_DEL, m_pipe[0], 0, 0));
+    EXPECT_EQ(0, wait(10));
+
+    errno = EOK;
+    EXPECT_EQ(-1, ctl(EPOLL_CTL_DEL, m_pipe[0], 0, 0));
+    EXPECT_EQ(ENOENT, errno);
+    errno = EOK;
+    EXPECT_EQ(-1, ctl(EPOLL_CTL_MOD, m_pipe[0], EPOLLIN, s_data));
+    EXPECT_EQ(ENOENT, errno);
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data + 1));
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ(s_data + 1, m_event.data.u64);
+}
+
+/**
+ * @test sock_epoll.ti_4
+ * @brief
+ *    Close a ready pipe while it is in the set
+ * @details
+ *    The fd number is reused by a new pipe, which must not inherit
+ *    the report of the closed one.
+ */
+TEST_F(sock_epoll, ti_4)
+{
+    int fd = m_pipe[0];
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data));
+    fill();
+    ASSERT_EQ(1, wait(100));
+
+    close(m_pipe[0]);
+    close(m_pipe[1]);
+    m_pipe[0] = m_pipe[1] = -1;
+    EXPECT_EQ(0, wait(10));
+
+    ASSERT_EQ(0, pipe(m_pipe));
+    EXPECT_EQ(fd, m_pipe[0]);
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data + 1));
+    EXPECT_EQ(0, wait(10));
+
+    fill();
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ((uint32_t)EPOLLIN, m_event.events);
+    EXPECT_EQ(s_data + 1, m_event.data.u64);
+}
+
+/**
+ * @test sock_epoll.ti_5
+ * @brief
+ *    Edge triggered pipe
+ * @details
+ */
+TEST_F(sock_epoll, ti_5)
+{
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN | EPOLLET, s_data));
+
+    fill();
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ((uint32_t)EPOLLIN, m_event.events);
+    EXPECT_EQ(0, wait(10));
+
+    fill();
+    ASSERT_EQ(1, wait(100));
+    EXPECT_EQ(s_data, m_event.data.u64);
+    EXPECT_EQ(0, wait(10));
+}
+
+static void *_fill_later(void *arg)
+{
+    int fd = *(int *)arg;
+
+    usleep(50000);
+    if (write(fd, "x", 1) != 1) {
+        return arg;
+    }
+    return nullptr;
+}
+
+/**
+ * @test sock_epoll.ti_6
+ * @brief
+ *    Wake a blocking wait
+ * @details
+ *    Another thread makes the pipe readable while epoll_wait() sleeps.
+ */
+TEST_F(sock_epoll, ti_6)
+{
+    pthread_t thread;
+    void *ret = nullptr;
+
+    ASSERT_EQ(0, ctl(EPOLL_CTL_ADD, m_pipe[0], EPOLLIN, s_data));
+    ASSERT_EQ(0, pthread_create(&thread, nullptr, _fill_later, &m_pipe[1]));
+
+    EXPECT_EQ(1, wait(5000));
+    EXPECT_EQ(s_data, m_event.data.u64);
+
+    pthread_join(thread, &ret);
+    EXPECT_EQ(nullptr, ret);
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/mman.h>
+#include <poll.h>
 #include "common/def.h"
 #include "common/log.h"
 #include "common/sys.h"
@@ -148,3 +149,96 @@ TEST_F(tcp_accept, mapped_ipv4_accept)
     log_trace("Checking accept4()\n");
     check_accpet(true);
 }
+
+/**
+ * @test tcp_accept.reuseport_sharding
+ * @brief
+ *    Connections are distributed between SO_REUSEPORT listeners
+ *
+ * @details
+ *    Two listeners share the port. Every connection is accepted by
+ *    exactly one of them and both of them get a share.
+ */
+TEST_F(tcp_accept, reuseport_sharding)
+{
+    const int conn_num = 32;
+
+    int pid = fork();
+
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fds[conn_num];
+        for (int i = 0; i < conn_num; ++i) {
+            fds[i] = tcp_base::sock_create();
+            EXPECT_LE_ERRNO(0, fds[i]);
+            if (0 <= fds[i]) {
+                int rc = connect(fds[i], &server_addr.addr, sizeof(server_addr));
+                EXPECT_EQ_ERRNO(0, rc);
+            }
+        }
+
+        for (int i = 0; i < conn_num; ++i) {
+            if (0 <= fds[i]) {
+                peer_wait(fds[i]);
+                close(fds[i]);
+            }
+        }
+
+        // This exit is very important, otherwise the fork
+        // keeps running and may duplicate other tests.
+        exit(testing::Test::HasFailure());
+    } else { // Parent
+        int l_fds[2];
+        int accepted[2] = {0, 0};
+        int fds[conn_num];
+        int fd_count = 0;
+
+        for (int i = 0; i < 2; ++i) {
+            int opt_val = 1;
+            l_fds[i] = tcp_base::sock_create();
+            EXPECT_LE_ERRNO(0, l_fds[i]);
+            int rc = setsockopt(l_fds[i], SOL_SOCKET, SO_REUSEPORT, &opt_val, sizeof(opt_val));
+            EXPECT_EQ_ERRNO(0, rc);
+            rc = bind(l_fds[i], &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            rc = listen(l_fds[i], conn_num);
+            EXPECT_EQ_ERRNO(0, rc);
+        }
+
+        barrier_fork(pid);
+
+        while (fd_count < conn_num) {
+            struct pollfd pfds[2] = {{l_fds[0], POLLIN, 0}, {l_fds[1], POLLIN, 0}};
+            int rc = poll(pfds, 2, 5000);
+            EXPECT_LT(0, rc);
+            if (rc <= 0) {
+                break;
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (pfds[i].revents & POLLIN) {
+                    int fd = accept(l_fds[i], nullptr, nullptr);
+                    EXPECT_LE_ERRNO(0, fd);
+                    if (0 <= fd) {
+                        fds[fd_count++] = fd;
+                        accepted[i]++;
+                    }
+                }
+            }
+        }
+
+        EXPECT_EQ(conn_num, accepted[0] + accepted[1]);
+        EXPECT_LT(0, accepted[0]);
+        EXPECT_LT(0, accepted[1]);
+        log_trace("Accepted connections: %d by fd=%d, %d by fd=%d\n", accepted[0], l_fds[0],
+                  accepted[1], l_fds[1]);
+
+        for (int i = 0; i < fd_count; ++i) {
+            close(fds[i]);
+        }
+        close(l_fds[0]);
+        close(l_fds[1]);
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fstream>
+
+#include <sys/socket.h>
+#include <sys/types.h> /* See NOTES */
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "googletest/include/gtest/gtest.h"
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "tcp_base.h"
+
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
+
+#ifndef MSG_FASTOPEN
+#define MSG_FASTOPEN 0x20000000
+#endif
+
+#define HELLO_STR "hello"
+
+class tcp_fastopen : public tcp_base {
+protected:
+    void SetUp() override
+    {
+        tcp_base::SetUp();
+
+        /* Connections which are not offloaded are handled by the kernel,
+         * so both client and server roles must be enabled there as well.
+         */
+        int mode = 0;
+        std::ifstream sysctl("/proc/sys/net/ipv4/tcp_fastopen");
+        sysctl >> mode;
+        SKIP_TRUE((mode & 0x3) == 0x3, "TCP Fast Open is disabled in net.ipv4.tcp_fastopen");
+    }
+
+    int server_create()
+    {
+        int qlen = 5;
+        int l_fd = tcp_base::sock_create();
+        EXPECT_LE(0, l_fd);
+
+        EXPECT_EQ(0, bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)));
+        EXPECT_EQ(0, setsockopt(l_fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)));
+        EXPECT_EQ(0, listen(l_fd, 5));
+
+        return l_fd;
+    }
+
+    /* Accepts the given number of connections, each carrying HELLO_STR */
+    void server_receive(int l_fd, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            char buf[sizeof(HELLO_STR) + 1];
+
+            int fd = accept(l_fd, nullptr, nullptr);
+            ASSERT_LE(0, fd);
+
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            EXPECT_EQ(static_cast<ssize_t>(sizeof(HELLO_STR)), len);
+            EXPECT_EQ(0, strncmp(HELLO_STR, buf, sizeof(HELLO_STR)));
+
+            peer_wait(fd);
+            close(fd);
+        }
+    }
+};
+
+/**
+ * @test tcp_fastopen.tfo_1_connect_option
+ * @brief
+ *    TCP_FASTOPEN_CONNECT defers SYN to the first send().
+ * @details
+ *    The first connection requests a cookie, the second one carries
+ *    data within SYN. Data must be delivered in both cases.
+ */
+TEST_F(tcp_fastopen, tfo_1_connect_option)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        barrier_fork(pid);
+
+        for (int i = 0; i < 2; ++i) {
+            int val = 1;
+            int fd = tcp_base::sock_create();
+            ASSERT_LE(0, fd);
+
+            int rc = setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &val, sizeof(val));
+            ASSERT_EQ(0, rc);
+
+            rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+            ASSERT_EQ(0, rc);
+
+            static char buf[] = HELLO_STR;
+            ssize_t len = send(fd, (void *)buf, sizeof(buf), 0);
+            EXPECT_EQ(static_cast<ssize_t>(sizeof(buf)), len);
+
+            close(fd);
+        }
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = server_create();
+
+        barrier_fork(pid);
+
+        server_receive(l_fd, 2);
+        close(l_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+/**
+ * @test tcp_fastopen.tfo_2_sendto_msg_fastopen
+ * @brief
+ *    sendto() with MSG_FASTOPEN connects the socket implicitly.
+ * @details
+ */
+TEST_F(tcp_fastopen, tfo_2_sendto_msg_fastopen)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        barrier_fork(pid);
+
+        for (int i = 0; i < 2; ++i) {
+            int fd = tcp_base::sock_create();
+            ASSERT_LE(0, fd);
+
+            static char buf[] = HELLO_STR;
+            ssize_t len = sendto(fd, (void *)buf, sizeof(buf), MSG_FASTOPEN,
+                                 (struct sockaddr *)&server_addr, sizeof(server_addr));
+            EXPECT_EQ(static_cast<ssize_t>(sizeof(buf)), len);
+
+            close(fd);
+        }
+
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = server_create();
+
+        barrier_fork(pid);
+
+        server_receive(l_fd, 2);
+        close(l_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+/**
+ * @test tcp_fastopen.tfo_3_connect_option_connected
+ * @brief
+ *    TCP_FASTOPEN_CONNECT is rejected on a connected socket.
+ * @details
+ */
+TEST_F(tcp_fastopen, tfo_3_connect_option_connected)
+{
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        barrier_fork(pid);
+
+        int val = 1;
+        int fd = tcp_base::sock_create();
+        ASSERT_LE(0, fd);
+
+        int rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &val, sizeof(val));
+        EXPECT_EQ(-1, rc);
+        EXPECT_EQ(EINVAL, errno);
+
+        static char buf[] = HELLO_STR;
+        ssize_t len = send(fd, (void *)buf, sizeof(buf), 0);
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(buf)), len);
+
+        close(fd);
+
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = server_create();
+
+        barrier_fork(pid);
+
+        server_receive(l_fd, 1);
+        close(l_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/mman.h>
+#include <algorithm>
 
 #include "common/def.h"
 #include "common/log.h"
@@ -316,3 +317,112 @@ TEST_F(tcp_sendfile, ti_2_vary_size)
         munmap(file_ptr, test_file_size);
     }
 }
+
+/**
+ * @test tcp_sendfile.ti_3
+ * @brief
+ *    Exchange data by sendfile() requests which cross window boundaries
+ *
+ * @details
+ *    With XLIO_ZC_CACHE_WINDOW=1MB some requests span two windows of
+ *    the mapping cache and the last window is shorter than the others.
+ */
+TEST_F(tcp_sendfile, ti_3_window_boundary)
+{
+    int rc = EOK;
+    void *file_ptr = NULL;
+    int test_chunk = 700 * 1024 + 3000;
+    int test_file_size = 3 * 1024 * 1024 + 1000;
+    int test_file = create_tmp_file(test_file_size);
+    ASSERT_GE(test_file, 0);
+
+    file_ptr = mmap(NULL, test_file_size, PROT_READ, MAP_SHARED | MAP_NORESERVE, test_file, 0);
+    ASSERT_TRUE(file_ptr != MAP_FAILED);
+
+    int pid = fork();
+    if (0 == pid) { /* I am the child */
+        off_t test_file_offset = 0;
+
+        barrier_fork(pid);
+
+        m_fd = tcp_base::sock_create();
+        ASSERT_LE(0, m_fd);
+
+        rc = bind(m_fd, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = connect(m_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        log_trace("Established connection: fd=%d to %s\n", m_fd,
+                  sys_addr2str((struct sockaddr *)&server_addr));
+
+        while (test_file_size > 0) {
+            rc = sendfile(m_fd, test_file, &test_file_offset, std::min(test_chunk, test_file_size));
+            EXPECT_GT(rc, 0);
+            if (rc <= 0) {
+                break;
+            }
+            test_file_size -= rc;
+        }
+        EXPECT_EQ(0, test_file_size);
+
+        peer_wait(m_fd);
+
+        close(m_fd);
+        close(test_file);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd;
+        struct sockaddr peer_addr;
+        socklen_t socklen;
+        char *test_buf = NULL;
+
+        test_buf = (char *)create_tmp_buffer(test_file_size);
+        ASSERT_TRUE(test_buf);
+
+        l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        socklen = sizeof(peer_addr);
+        m_fd = accept(l_fd, &peer_addr, &socklen);
+        ASSERT_LE(0, m_fd);
+        close(l_fd);
+
+        log_trace("Accepted connection: fd=%d from %s\n", m_fd,
+                  sys_addr2str((struct sockaddr *)&peer_addr));
+
+        int s = test_file_size;
+        while (s > 0 && !child_fork_exit()) {
+            rc = recv(m_fd, (void *)(test_buf + test_file_size - s), s, MSG_WAITALL);
+            EXPECT_GT(rc, 0);
+            if (rc <= 0) {
+                break;
+            }
+            s -= rc;
+        }
+        EXPECT_EQ(0, s);
+        EXPECT_EQ(memcmp(test_buf, file_ptr, test_file_size), 0);
+
+        close(m_fd);
+        free_tmp_buffer(test_buf, test_file_size);
+        test_buf = NULL;
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+
+    munmap(file_ptr, test_file_size);
+    close(test_file);
+}
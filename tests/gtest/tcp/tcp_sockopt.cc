@@ -526,6 +526,189 @@ TEST_F(tcp_sockopt, ti_3_setsockopt_isolate)
     }
 }
 
+/**
+ * @test tcp_sockopt.ti_4_tcp_cork
+ * @brief
+ *    TCP_CORK and MSG_MORE coalesce header and body writes.
+ * @details
+ *    Data is held while the socket is corked and is delivered
+ *    once the socket is uncorked or a send() comes without MSG_MORE.
+ *    The receiver sees nothing while the sender waits between the writes,
+ *    then the header and the body arrive together in one segment.
+ */
+TEST_F(tcp_sockopt, ti_4_tcp_cork)
+{
+    static const char header[] = "header:";
+    static const char body[] = "body";
+    const size_t msg_len = sizeof(header) + sizeof(body);
+    /* Below XLIO_TCP_CORK_TIMEOUT_MSEC and the kernel limit which release a held segment */
+    const int hold_usec = 100000;
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        barrier_fork(pid);
+
+        int fd = tcp_base::sock_create();
+        ASSERT_LE(0, fd);
+
+        int rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        int val = 1;
+        rc = setsockopt(fd, IPPROTO_TCP, TCP_CORK, &val, sizeof(val));
+        ASSERT_EQ(0, rc);
+
+        val = 0;
+        socklen_t optlen = sizeof(val);
+        rc = getsockopt(fd, IPPROTO_TCP, TCP_CORK, &val, &optlen);
+        ASSERT_EQ(0, rc);
+        EXPECT_EQ(1, val);
+
+        /* Case #1. TCP_CORK */
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(header)), send(fd, header, sizeof(header), 0));
+        usleep(hold_usec);
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(body)), send(fd, body, sizeof(body), 0));
+        val = 0;
+        rc = setsockopt(fd, IPPROTO_TCP, TCP_CORK, &val, sizeof(val));
+        ASSERT_EQ(0, rc);
+
+        /* Case #2. MSG_MORE */
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(header)),
+                  send(fd, header, sizeof(header), MSG_MORE));
+        usleep(hold_usec);
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(body)), send(fd, body, sizeof(body), 0));
+
+        peer_wait(fd);
+        close(fd);
+
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        int rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        int fd = accept(l_fd, nullptr, nullptr);
+        ASSERT_LE(0, fd);
+
+        for (int i = 0; i < 2; ++i) {
+            struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+            char buf[msg_len];
+
+            /* The header is held while the sender waits */
+            EXPECT_EQ(0, poll(&pfd, 1, hold_usec / 2000));
+
+            rc = poll(&pfd, 1, 1000);
+            ASSERT_EQ(1, rc);
+            /* Header and body are coalesced, so they are received at once.
+             * The peer_wait() probes of the sender may follow them.
+             */
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            ASSERT_EQ(static_cast<ssize_t>(msg_len), len);
+            EXPECT_EQ(0, memcmp(buf, header, sizeof(header)));
+            EXPECT_EQ(0, memcmp(buf + sizeof(header), body, sizeof(body)));
+        }
+
+        close(fd);
+        close(l_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
+/**
+ * @test tcp_sockopt.ti_5_tcp_notsent_lowat
+ * @brief
+ *    TCP_NOTSENT_LOWAT bounds the amount of unsent data.
+ * @details
+ *    The receiver doesn't read, so all the data beyond its window stays
+ *    in the sender queue. The sender writes while POLLOUT is reported and
+ *    the amount of queued data (and therefore the queueing delay) must stay
+ *    within the receive buffer plus the threshold. POLLOUT is raised again
+ *    once the receiver drains the data.
+ */
+TEST_F(tcp_sockopt, ti_5_tcp_notsent_lowat)
+{
+    const int lowat = 16384;
+    const int rcvbuf = 8192;
+    char buf[4096] = {0};
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        barrier_fork(pid);
+
+        int fd = tcp_base::sock_create_nb();
+        ASSERT_LE(0, fd);
+
+        int rc = setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat));
+        ASSERT_EQ(0, rc);
+
+        int val = 0;
+        socklen_t optlen = sizeof(val);
+        rc = getsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &val, &optlen);
+        ASSERT_EQ(0, rc);
+        EXPECT_EQ(lowat, val);
+
+        rc = connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_TRUE(rc == 0 || errno == EINPROGRESS);
+
+        struct pollfd pfd = {.fd = fd, .events = POLLOUT, .revents = 0};
+        size_t total = 0;
+
+        while (total < (64U << 20U) && poll(&pfd, 1, 100) > 0) {
+            ssize_t len = send(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (len > 0) {
+                total += len;
+            }
+        }
+        log_trace("Queued %zu bytes\n", total);
+        /* Receive buffer is doubled by the kernel */
+        EXPECT_GE(static_cast<size_t>(2 * rcvbuf + lowat + sizeof(buf)), total);
+
+        /* The receiver starts to read after a delay */
+        pfd.revents = 0;
+        rc = poll(&pfd, 1, 5000);
+        EXPECT_EQ(1, rc);
+        EXPECT_TRUE(pfd.revents & POLLOUT);
+
+        close(fd);
+
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        int rc = setsockopt(l_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        ASSERT_EQ(0, rc);
+
+        rc = bind(l_fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(l_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        barrier_fork(pid);
+
+        int fd = accept(l_fd, nullptr, nullptr);
+        ASSERT_LE(0, fd);
+
+        sleep(1);
+        while (recv(fd, buf, sizeof(buf), 0) > 0) {
+        }
+
+        close(fd);
+        close(l_fd);
+
+        ASSERT_EQ(0, wait_fork(pid));
+    }
+}
+
 class tcp_set_get_sockopt : public ::testing::Test {
 protected:
     void SetUp() override
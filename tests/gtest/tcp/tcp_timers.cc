@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+#include "tcp_base.h"
+
+class tcp_timers : public tcp_base {
+protected:
+    // Sends a byte and waits for its echo
+    static bool round_trip(int fd, char val)
+    {
+        char echo = 0;
+
+        if (send(fd, &val, sizeof(val), 0) != sizeof(val)) {
+            return false;
+        }
+        return recv(fd, &echo, sizeof(echo), 0) == sizeof(echo) && echo == val;
+    }
+};
+
+/**
+ * @test tcp_timers.ti_1
+ * @brief
+ *    Migrate a socket with an armed timer between threads, then remove it
+ * @details
+ *    With delegated TCP timers every thread owns a timer collection. The
+ *    thread which connects registers the timer, a blocking receive in another
+ *    thread adopts it while the sent byte is still unacknowledged. The socket
+ *    bounces between the threads and is closed from a third one, before the
+ *    threads exit and detach what is left in their collections.
+ */
+TEST_F(tcp_timers, ti_1)
+{
+    const char *mode = getenv("XLIO_TCP_CTL_THREAD");
+    SKIP_TRUE(mode && (!strcmp(mode, "delegate") || !strcmp(mode, "1")),
+              "Requires XLIO_TCP_CTL_THREAD=delegate");
+
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        int lfd = tcp_base::sock_create();
+        EXPECT_LE_ERRNO(0, lfd);
+        if (0 <= lfd) {
+            int rc = bind(lfd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                rc = listen(lfd, 5);
+                EXPECT_EQ_ERRNO(0, rc);
+                if (0 == rc) {
+                    barrier_fork(pid, true);
+
+                    int fd = accept(lfd, nullptr, nullptr);
+                    EXPECT_LE_ERRNO(0, fd);
+                    if (0 <= fd) {
+                        char buf[64];
+                        ssize_t n;
+                        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+                            EXPECT_EQ(n, send(fd, buf, n, 0));
+                        }
+                        close(fd);
+                    }
+                }
+            }
+            close(lfd);
+        }
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        const int rounds = 100;
+        std::atomic<int> turn(-1);
+        std::atomic<bool> closed(false);
+        std::atomic<int> failures(0);
+        int fd = tcp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        int rc = set_socket_rcv_timeout(fd, 5);
+        EXPECT_EQ_ERRNO(0, rc);
+
+        barrier_fork(pid, true);
+
+        // Each thread drives the socket on its turns and stays alive till the socket is closed
+        auto driver = [&](int id) {
+            if (id == 0) {
+                int ret = connect(fd, &server_addr.addr, sizeof(server_addr));
+                EXPECT_EQ_ERRNO(0, ret);
+                turn = 0;
+            }
+            for (int i = id; i < rounds; i += 2) {
+                while (turn != i) {
+                    std::this_thread::yield();
+                }
+                if (!round_trip(fd, (char)i)) {
+                    failures++;
+                }
+                turn = i + 1;
+            }
+            while (!closed) {
+                std::this_thread::yield();
+            }
+        };
+
+        std::thread thr0(driver, 0);
+        std::thread thr1(driver, 1);
+
+        while (turn != rounds) {
+            std::this_thread::yield();
+        }
+        // Leaves an unacknowledged byte, so the timer is armed in the owner collection
+        char val = 0;
+        EXPECT_EQ(1, send(fd, &val, sizeof(val), 0));
+        EXPECT_EQ_ERRNO(0, close(fd));
+        closed = true;
+
+        thr0.join();
+        thr1.join();
+        EXPECT_EQ(0, failures);
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+
+    sleep(1U); // XLIO timers to clean fd.
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/mman.h>
+#include <netinet/udp.h>
 #include "common/def.h"
 #include "common/log.h"
 #include "common/sys.h"
@@ -148,3 +149,107 @@ TEST_F(udp_recv, mapped_ipv4_recv)
         EXPECT_EQ(0, wait_fork(pid));
     }
 }
+
+/**
+ * @test udp_recv.udp_gro
+ * @brief
+ *    UDP_GRO delivers same-size datagrams of one flow as a single chain.
+ *
+ * @details
+ *    Coalescing is optional, so every delivery is checked to be a sequence
+ *    of whole datagrams. When the UDP_GRO control message is present, it must
+ *    carry the datagram size.
+ */
+TEST_F(udp_recv, udp_gro)
+{
+    const size_t dgram_size = 100U;
+    const int dgram_count = 8;
+    char data[dgram_size * dgram_count];
+
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<char>(i);
+    }
+
+    int pid = fork();
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = connect(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+
+            for (int i = 0; i < dgram_count; ++i) {
+                ssize_t rcs = send(fd, data + i * dgram_size, dgram_size, 0);
+                EXPECT_EQ_ERRNO(static_cast<ssize_t>(dgram_size), rcs);
+            }
+
+            close(fd);
+        }
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = set_socket_rcv_timeout(fd, 5);
+            EXPECT_EQ_ERRNO(0, rc);
+
+            int val = 1;
+            rc = setsockopt(fd, IPPROTO_UDP, UDP_GRO, &val, sizeof(val));
+            EXPECT_EQ_ERRNO(0, rc);
+
+            val = 0;
+            socklen_t optlen = sizeof(val);
+            rc = getsockopt(fd, IPPROTO_UDP, UDP_GRO, &val, &optlen);
+            EXPECT_EQ_ERRNO(0, rc);
+            EXPECT_EQ(1, val);
+
+            rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                barrier_fork(pid);
+
+                char buff[sizeof(data)];
+                size_t offset = 0;
+
+                while (offset < sizeof(data)) {
+                    char control[CMSG_SPACE(sizeof(int))] = {0};
+                    iovec vec = {.iov_base = buff, .iov_len = sizeof(buff)};
+                    msghdr msg = {};
+                    msg.msg_iov = &vec;
+                    msg.msg_iovlen = 1U;
+                    msg.msg_control = control;
+                    msg.msg_controllen = sizeof(control);
+
+                    ssize_t rcr = recvmsg(fd, &msg, 0);
+                    EXPECT_LT(0, rcr);
+                    if (rcr <= 0) {
+                        break;
+                    }
+                    EXPECT_EQ(0U, rcr % dgram_size);
+                    EXPECT_TRUE(0 == memcmp(buff, data + offset, rcr));
+                    offset += rcr;
+
+                    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+                    if (cmsg) {
+                        EXPECT_EQ(SOL_UDP, cmsg->cmsg_level);
+                        EXPECT_EQ(UDP_GRO, cmsg->cmsg_type);
+                        int gro_size = 0;
+                        memcpy(&gro_size, CMSG_DATA(cmsg), sizeof(gro_size));
+                        EXPECT_EQ(static_cast<int>(dgram_size), gro_size);
+                    }
+                }
+                EXPECT_EQ(sizeof(data), offset);
+            }
+
+            close(fd);
+        }
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/uio.h>
+#include <netinet/udp.h>
 #include <string>
 #include "common/def.h"
 #include "common/log.h"
@@ -785,3 +786,110 @@ TEST_F(udp_send, DISABLED_null_iov_elements_fragmented)
         EXPECT_EQ(0, wait_fork(pid));
     }
 }
+
+/**
+ * @test udp_send.udp_segment
+ * @brief
+ *    UDP_SEGMENT splits a single send into gso_size datagrams.
+ *
+ * @details
+ *    The segment size is taken from the socket option or from
+ *    the UDP_SEGMENT control message which overrides the option.
+ *    The last datagram carries the remainder.
+ */
+TEST_F(udp_send, udp_segment)
+{
+    const uint16_t gso_size = 100U;
+    const uint16_t gso_size_cmsg = 60U;
+    char data[250];
+
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<char>(i);
+    }
+
+    int pid = fork();
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = connect(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+
+            int val = gso_size;
+            rc = setsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &val, sizeof(val));
+            EXPECT_EQ_ERRNO(0, rc);
+
+            val = 0;
+            socklen_t optlen = sizeof(val);
+            rc = getsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &val, &optlen);
+            EXPECT_EQ_ERRNO(0, rc);
+            EXPECT_EQ(gso_size, val);
+
+            iovec vec[2];
+            vec[0].iov_base = data;
+            vec[0].iov_len = sizeof(data) / 2;
+            vec[1].iov_base = data + sizeof(data) / 2;
+            vec[1].iov_len = sizeof(data) - sizeof(data) / 2;
+
+            ssize_t rcs = writev(fd, vec, sizeof(vec) / sizeof(iovec));
+            EXPECT_EQ_ERRNO(static_cast<ssize_t>(sizeof(data)), rcs);
+
+            char control[CMSG_SPACE(sizeof(uint16_t))] = {0};
+            msghdr msg = {};
+            msg.msg_iov = vec;
+            msg.msg_iovlen = 1U;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cmsg), &gso_size_cmsg, sizeof(gso_size_cmsg));
+
+            rcs = sendmsg(fd, &msg, 0);
+            EXPECT_EQ_ERRNO(static_cast<ssize_t>(vec[0].iov_len), rcs);
+
+            close(fd);
+        }
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = set_socket_rcv_timeout(fd, 5);
+            EXPECT_EQ_ERRNO(0, rc);
+
+            rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                barrier_fork(pid);
+
+                const size_t expected[] = {100U, 100U, 50U, 60U, 60U, 5U};
+                size_t offset = 0;
+                char buff[sizeof(data)];
+
+                for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+                    if (i == 3) {
+                        offset = 0;
+                    }
+                    ssize_t rcz = recv(fd, buff, sizeof(buff), 0);
+                    EXPECT_EQ_ERRNO(static_cast<ssize_t>(expected[i]), rcz);
+                    if (rcz > 0) {
+                        EXPECT_TRUE(0 == memcmp(buff, data + offset, rcz));
+                        offset += rcz;
+                    }
+                }
+            }
+
+            close(fd);
+        }
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
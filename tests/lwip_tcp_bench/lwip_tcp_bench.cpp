@@ -0,0 +1,1303 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Hardware free benchmark and conformance harness of the libxlio TCP stack.
+ *
+ * Two lwIP pcbs are wired back to back through an in-memory link driven by a
+ * virtual clock, so the stack is measured without an offloaded NIC. A client
+ * pcb connects to a listening pcb and streams a byte pattern which the accepted
+ * pcb verifies. The link models one way delay, rate with a drop-tail queue,
+ * random loss, reordering, a scripted list of dropped data segments and CE
+ * marking of ECN capable data segments, either random or above a queue
+ * threshold as a data center switch does for DCTCP. Timers
+ * follow XLIO_TCP_TIMER_RESOLUTION_MSEC on the virtual clock, so a run is
+ * deterministic for a given seed and can be compared across commits.
+ *
+ * Reported are the segments per CPU second and the CPU ns per byte spent in the
+ * stack and the harness, the virtual completion time and goodput, the
+ * retransmissions, the pure ACKs per received MB, the CE marks and echoes and
+ * the time to recover every dropped data segment.
+ *
+ *   lwip_tcp_bench [options] [-w out.pcap]
+ *   lwip_tcp_bench -r in.pcap [-w out.pcap] [stack options]
+ *   lwip_tcp_bench --check
+ *
+ * Stack options:
+ *   -m mtu  -c lwip|cubic|none|dctcp  -b send buffer bytes  -s window scale
+ *   -T (timestamps)  -t timer resolution msec
+ *   -a ACK every segments  -A ACK every bytes[k|m]
+ *   -E ECN mode (XLIO_TCP_ECN)
+ * Link and traffic options, loss, reordering and marking apply to client data segments:
+ *   -n bytes[k|m|g]  -d one way delay usec  -B rate Mbit/s  -q queue packets
+ *   -l loss %  -o reorder %  -O reorder delay usec  -S seed
+ *   -K queue packets above which ECN capable segments are CE marked (with -B)
+ *   -M CE mark % of ECN capable segments
+ *   -D n[-m][,...]  data segment transmissions to drop, retransmissions included
+ *
+ * -w writes the frames as delivered by the link, raw IPv4 with virtual
+ * nanosecond timestamps. -r replays the client to server frames of such a
+ * capture (or any IPv4 TCP capture) into a listening pcb at their captured
+ * times; acknowledgment numbers are shifted to the ISN of the new server pcb.
+ * --check runs the conformance scenarios and exits with 1 on a corrupted or
+ * stalled transfer, to be used in CI.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+// The stack is built from the libxlio sources, see lwip_sources.c
+#include "core/lwip/tcp_impl.h"
+
+// Normally defined by the libxlio lwIP glue layer
+int32_t enable_wnd_scale = 0;
+u32_t rcv_wnd_scale = 0;
+
+#define BENCH_HEADROOM  128U
+#define PATTERN_PERIOD  65521U
+#define NSEC_PER_USEC   1000ULL
+#define NSEC_PER_MSEC   1000000ULL
+#define NSEC_PER_SEC    1000000000ULL
+#define STALL_NSEC      (300ULL * NSEC_PER_SEC)
+#define PCAP_MAGIC_USEC 0xa1b2c3d4U
+#define PCAP_MAGIC_NSEC 0xa1b23c4dU
+#define LINKTYPE_ETHER  1U
+#define LINKTYPE_RAW    101U
+
+struct bench_config {
+    uint64_t bytes = 64ULL << 20;
+    uint16_t mtu = 1500;
+    cc_algo_mod cc = CC_MOD_LWIP;
+    uint32_t sndbuf = 1024 * 1024;
+    uint32_t wnd_scale = 0;
+    bool timestamps = false;
+    uint32_t tmr_msec = 100;
+    uint32_t ack_segs = 2;
+    uint32_t ack_bytes = 0;
+    uint32_t ecn = 0;
+    uint64_t delay_ns = 50 * NSEC_PER_USEC;
+    uint64_t rate_mbps = 0;
+    uint32_t queue_pkts = 0;
+    double loss = 0;
+    double reorder = 0;
+    uint64_t reorder_ns = 100 * NSEC_PER_USEC;
+    uint32_t mark_pkts = 0;
+    double mark = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> drops;
+    uint64_t seed = 1;
+};
+
+struct bench_result {
+    uint64_t segments = 0;
+    uint64_t data_segments = 0;
+    uint64_t rexmits = 0;
+    uint64_t dropped = 0;
+    uint64_t reordered = 0;
+    uint64_t acks = 0; // Pure ACKs sent by the server
+    uint64_t marked = 0; // Client data segments marked CE by the link
+    uint64_t ece = 0; // Server segments echoing CE
+    uint64_t ect_acks = 0; // Pure ACKs sent ECN capable
+    uint64_t ect_rexmits = 0; // Retransmitted data segments sent ECN capable
+    uint64_t rx_bytes = 0;
+    uint64_t mismatch = 0; // Stream offset + 1 of the first corrupted byte
+    uint64_t virt_ns = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t recoveries = 0;
+    uint64_t recovery_sum_ns = 0;
+    uint64_t recovery_max_ns = 0;
+    bool stalled = false;
+};
+
+struct sim_frame {
+    uint64_t ns;
+    uint64_t id;
+    bool to_server;
+    std::vector<uint8_t> data; // IPv4 packet
+};
+
+struct frame_later {
+    bool operator()(const sim_frame *a, const sim_frame *b) const
+    {
+        return a->ns != b->ns ? a->ns > b->ns : a->id > b->id;
+    }
+};
+
+// pbuf with its buffer, lwIP hands the pbuf pointer back on free
+struct sim_buf {
+    struct pbuf p;
+    sim_buf *next;
+    uint8_t *data;
+};
+
+static bench_config g_config;
+static bench_result g_result;
+static uint64_t g_now_ns;
+static uint64_t g_next_tmr_ns;
+static uint64_t g_tmr_calls;
+static uint64_t g_frame_id;
+static uint64_t g_link_busy_ns[2];
+static uint64_t g_rand;
+static std::priority_queue<sim_frame *, std::vector<sim_frame *>, frame_later> g_wire;
+static std::vector<sim_frame *> g_free_frames;
+static std::vector<tcp_seg *> g_free_segs;
+static sim_buf *g_free_bufs;
+static uint32_t g_buf_size;
+// Stream end offset of every dropped data segment not delivered yet -> drop time
+static std::multimap<uint64_t, uint64_t> g_unrecovered;
+
+static struct tcp_pcb g_client, g_listen, g_server;
+static bool g_server_open;
+static uint32_t g_client_isn, g_server_isn;
+static uint64_t g_tx_bytes;
+static uint8_t g_pattern[2 * PATTERN_PERIOD];
+
+static bool g_replay;
+static uint32_t g_capture_server_isn;
+static FILE *g_pcap_out;
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static inline void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, v >> 16);
+    put16(p + 2, v & 0xffff);
+}
+
+static inline const uint8_t *tcp_header(const sim_frame *f)
+{
+    return f->data.data() + (f->data[0] & 0x0f) * 4;
+}
+
+static inline uint32_t tcp_payload_len(const sim_frame *f)
+{
+    const uint8_t *tcp = tcp_header(f);
+    return (uint32_t)(f->data.data() + f->data.size() - tcp) - (tcp[12] >> 4) * 4;
+}
+
+// xorshift64*, uniform in [0, 1)
+static double sim_random(void)
+{
+    g_rand ^= g_rand >> 12;
+    g_rand ^= g_rand << 25;
+    g_rand ^= g_rand >> 27;
+    return (g_rand * 0x2545F4914F6CDD1DULL >> 11) * (1.0 / (1ULL << 53));
+}
+
+static uint64_t cpu_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/*
+ * In-memory buffers and segments, registered in place of the ring buffer
+ * pools of libxlio.
+ */
+
+static sim_buf *buf_get(void)
+{
+    sim_buf *b = g_free_bufs;
+
+    if (b) {
+        g_free_bufs = b->next;
+    } else {
+        b = (sim_buf *)malloc(sizeof(*b) + g_buf_size);
+        if (!b) {
+            return nullptr;
+        }
+        b->data = (uint8_t *)(b + 1);
+    }
+    memset(&b->p, 0, sizeof(b->p));
+    b->p.payload = b->data + BENCH_HEADROOM;
+    return b;
+}
+
+static void buf_put(struct pbuf *p)
+{
+    sim_buf *b = (sim_buf *)p;
+
+    b->next = g_free_bufs;
+    g_free_bufs = b;
+}
+
+static struct pbuf *tx_pbuf_alloc(void *p_conn, pbuf_type type, pbuf_desc *desc,
+                                  struct pbuf *p_buff)
+{
+    sim_buf *b = buf_get();
+
+    (void)p_conn;
+    (void)desc;
+    (void)p_buff;
+    if (!b) {
+        return nullptr;
+    }
+    b->p.type = type;
+    return &b->p;
+}
+
+static void tx_pbuf_free(void *p_conn, struct pbuf *p)
+{
+    (void)p_conn;
+    if (p->ref) {
+        p->ref--;
+    }
+    if (!p->ref) {
+        buf_put(p);
+    }
+}
+
+static void rx_pbuf_free(struct pbuf *p)
+{
+    buf_put(p);
+}
+
+static struct tcp_seg *seg_alloc(void *p_conn)
+{
+    struct tcp_seg *seg;
+
+    (void)p_conn;
+    if (g_free_segs.empty()) {
+        seg = (struct tcp_seg *)malloc(sizeof(*seg));
+        if (!seg) {
+            return nullptr;
+        }
+    } else {
+        seg = g_free_segs.back();
+        g_free_segs.pop_back();
+    }
+    memset(seg, 0, sizeof(*seg));
+    return seg;
+}
+
+static void seg_free(void *p_conn, struct tcp_seg *seg)
+{
+    (void)p_conn;
+    g_free_segs.push_back(seg);
+}
+
+static void state_observer(void *pcb_container, enum tcp_state new_state)
+{
+    (void)pcb_container;
+    (void)new_state;
+}
+
+static u16_t route_mtu(struct tcp_pcb *pcb)
+{
+    (void)pcb;
+    return g_config.mtu;
+}
+
+static u32_t virtual_now_ms(void)
+{
+    return (u32_t)(g_now_ns / NSEC_PER_MSEC);
+}
+
+static sim_frame *frame_get(void)
+{
+    if (g_free_frames.empty()) {
+        return new sim_frame;
+    }
+    sim_frame *f = g_free_frames.back();
+    g_free_frames.pop_back();
+    return f;
+}
+
+static void frame_put(sim_frame *f)
+{
+    g_free_frames.push_back(f);
+}
+
+/*
+ * pcap trace.
+ */
+
+static uint32_t csum_add(uint32_t sum, const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += get16(buf + i);
+    }
+    if (len & 1) {
+        sum += buf[len - 1] << 8;
+    }
+    return sum;
+}
+
+static uint16_t csum_fold(uint32_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+// lwIP does not compute checksums on this path, fill them for the capture tools
+static void fill_checksums(sim_frame *f)
+{
+    uint8_t *ip = f->data.data();
+    uint32_t ip_hlen = (ip[0] & 0x0f) * 4;
+    uint8_t *tcp = ip + ip_hlen;
+    uint32_t tcp_len = f->data.size() - ip_hlen;
+
+    put16(ip + 10, 0);
+    put16(ip + 10, csum_fold(csum_add(0, ip, ip_hlen)));
+    put16(tcp + 16, 0);
+    put16(tcp + 16,
+          csum_fold(csum_add(csum_add(IPPROTO_TCP + tcp_len, ip + 12, 8), tcp, tcp_len)));
+}
+
+static FILE *pcap_open(const char *path)
+{
+    uint8_t hdr[24];
+    FILE *f = fopen(path, "wb");
+
+    if (!f) {
+        perror(path);
+        return nullptr;
+    }
+    uint32_t magic = PCAP_MAGIC_NSEC, snaplen = 65535, linktype = LINKTYPE_RAW;
+    uint16_t major = 2, minor = 4;
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, &magic, 4);
+    memcpy(hdr + 4, &major, 2);
+    memcpy(hdr + 6, &minor, 2);
+    memcpy(hdr + 16, &snaplen, 4);
+    memcpy(hdr + 20, &linktype, 4);
+    fwrite(hdr, sizeof(hdr), 1, f);
+    return f;
+}
+
+static void pcap_write(sim_frame *f)
+{
+    uint32_t rec[4] = {(uint32_t)(f->ns / NSEC_PER_SEC), (uint32_t)(f->ns % NSEC_PER_SEC),
+                       (uint32_t)f->data.size(), (uint32_t)f->data.size()};
+
+    fill_checksums(f);
+    fwrite(rec, sizeof(rec), 1, g_pcap_out);
+    fwrite(f->data.data(), f->data.size(), 1, g_pcap_out);
+}
+
+struct capture_packet {
+    uint64_t ns;
+    std::vector<uint8_t> data;
+};
+
+// Loads the IPv4 TCP packets of a raw IP or Ethernet capture, times relative to the first
+static int pcap_load(const char *path, std::vector<capture_packet> &packets)
+{
+    uint32_t hdr[6], rec[4];
+    uint64_t first_ns = 0, skipped = 0;
+    std::vector<uint8_t> buf;
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    if (fread(hdr, sizeof(hdr), 1, f) != 1 ||
+        (hdr[0] != PCAP_MAGIC_USEC && hdr[0] != PCAP_MAGIC_NSEC) ||
+        (hdr[5] != LINKTYPE_RAW && hdr[5] != LINKTYPE_ETHER)) {
+        fprintf(stderr, "%s: unsupported capture, expected native order raw IP or Ethernet\n",
+                path);
+        fclose(f);
+        return -1;
+    }
+    uint64_t frac_ns = hdr[0] == PCAP_MAGIC_NSEC ? 1 : NSEC_PER_USEC;
+    uint32_t l2_len = hdr[5] == LINKTYPE_ETHER ? 14 : 0;
+
+    while (fread(rec, sizeof(rec), 1, f) == 1) {
+        buf.resize(rec[2]);
+        if (rec[2] && fread(buf.data(), rec[2], 1, f) != 1) {
+            break;
+        }
+        const uint8_t *ip = buf.data() + l2_len;
+        if (rec[2] < l2_len + IP_HLEN + TCP_HLEN || (l2_len && get16(buf.data() + 12) != 0x0800) ||
+            (ip[0] >> 4) != IPV4_VERSION || ip[9] != IPPROTO_TCP ||
+            get16(ip + 2) > rec[2] - l2_len) {
+            skipped++;
+            continue;
+        }
+        uint64_t ns = rec[0] * NSEC_PER_SEC + rec[1] * frac_ns;
+        if (packets.empty()) {
+            first_ns = ns;
+        }
+        packets.push_back({ns - std::min(ns, first_ns), {ip, ip + get16(ip + 2)}});
+    }
+    fclose(f);
+    if (skipped) {
+        fprintf(stderr, "%s: skipped %lu non IPv4 TCP or truncated packets\n", path,
+                (unsigned long)skipped);
+    }
+    return packets.empty() ? -1 : 0;
+}
+
+/*
+ * Link model.
+ */
+
+static void record_drop(const sim_frame *f)
+{
+    g_result.dropped++;
+    if (f->to_server && !g_replay) {
+        uint64_t end = (uint32_t)(get32(tcp_header(f) + 4) - g_client_isn - 1) +
+            (uint64_t)tcp_payload_len(f);
+        // Offsets wrap at 4GB, unwrap them around the received stream
+        end += (g_result.rx_bytes >> 32) << 32;
+        if (end < g_result.rx_bytes) {
+            end += 1ULL << 32;
+        }
+        g_unrecovered.emplace(end, g_now_ns);
+    }
+}
+
+static bool scripted_drop(uint64_t n)
+{
+    for (auto &range : g_config.drops) {
+        if (n >= range.first && n <= range.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void mark_ce(sim_frame *f)
+{
+    if ((f->data[1] & IP_ECN_MASK) != IP_ECN_CE) {
+        f->data[1] |= IP_ECN_CE;
+        g_result.marked++;
+    }
+}
+
+static void link_send(sim_frame *f, bool rexmit)
+{
+    const uint8_t *tcp = tcp_header(f);
+    uint32_t data_len = tcp_payload_len(f);
+    int dir = f->to_server ? 0 : 1;
+    uint64_t ns = g_now_ns;
+
+    g_result.segments++;
+    if (tcp[13] & TCP_SYN) {
+        (f->to_server ? g_client_isn : g_server_isn) = get32(tcp + 4);
+    }
+    if (!data_len && !f->to_server && !(tcp[13] & (TCP_SYN | TCP_FIN | TCP_RST))) {
+        g_result.acks++;
+    }
+    if (!data_len && !(tcp[13] & (TCP_SYN | TCP_FIN | TCP_RST)) && (f->data[1] & IP_ECN_MASK)) {
+        g_result.ect_acks++;
+    }
+    if (!f->to_server && (tcp[13] & (TCP_SYN | TCP_ECE)) == TCP_ECE) {
+        g_result.ece++;
+    }
+    if (data_len && f->to_server) {
+        g_result.data_segments++;
+        g_result.rexmits += rexmit;
+        g_result.ect_rexmits += rexmit && (f->data[1] & IP_ECN_MASK);
+        if (!g_replay &&
+            (scripted_drop(g_result.data_segments) ||
+             (g_config.loss > 0 && sim_random() * 100 < g_config.loss))) {
+            record_drop(f);
+            frame_put(f);
+            return;
+        }
+    }
+    bool ect = data_len && f->to_server && !g_replay && (f->data[1] & IP_ECN_MASK);
+    if (ect && g_config.mark > 0 && sim_random() * 100 < g_config.mark) {
+        mark_ce(f);
+    }
+
+    if (g_config.rate_mbps) {
+        uint64_t start = std::max(ns, g_link_busy_ns[dir]);
+        uint64_t backlog = (start - ns) * g_config.rate_mbps / 8000;
+        if (g_config.queue_pkts && backlog > (uint64_t)g_config.queue_pkts * g_config.mtu) {
+            record_drop(f);
+            frame_put(f);
+            return;
+        }
+        if (ect && g_config.mark_pkts && backlog > (uint64_t)g_config.mark_pkts * g_config.mtu) {
+            mark_ce(f);
+        }
+        ns = g_link_busy_ns[dir] = start + f->data.size() * 8000 / g_config.rate_mbps;
+    }
+    f->ns = ns + g_config.delay_ns;
+    if (data_len && f->to_server && g_config.reorder > 0 &&
+        sim_random() * 100 < g_config.reorder) {
+        f->ns += g_config.reorder_ns;
+        g_result.reordered++;
+    }
+    f->id = ++g_frame_id;
+    g_wire.push(f);
+}
+
+static err_t ip_output(struct pbuf *p, struct tcp_seg *seg, void *p_conn, u16_t flags)
+{
+    struct tcp_pcb *pcb = (struct tcp_pcb *)p_conn;
+    sim_frame *f = frame_get();
+    uint32_t len = IP_HLEN + p->tot_len;
+
+    (void)seg;
+    f->to_server = (pcb == &g_client);
+    f->data.resize(len);
+
+    uint8_t *ip = f->data.data();
+    ip[0] = 0x45;
+    ip[1] = pcb->tos | ((flags & TCP_WRITE_ECT) ? IP_ECN_ECT_0 : 0);
+    put16(ip + 2, len);
+    put16(ip + 4, (uint16_t)g_frame_id);
+    put16(ip + 6, 0x4000); // DF
+    ip[8] = pcb->ttl;
+    ip[9] = IPPROTO_TCP;
+    put16(ip + 10, 0);
+    memcpy(ip + 12, &pcb->local_ip.ip4.addr, 4);
+    memcpy(ip + 16, &pcb->remote_ip.ip4.addr, 4);
+
+    // lwIP keeps the segment for retransmission, the wire gets a copy
+    uint8_t *pos = ip + IP_HLEN;
+    for (struct pbuf *q = p; q && pos < ip + len; q = q->next) {
+        uint32_t n = std::min<uint32_t>(q->len, ip + len - pos);
+        memcpy(pos, q->payload, n);
+        pos += n;
+    }
+
+    link_send(f, flags & TCP_WRITE_REXMIT);
+    return ERR_OK;
+}
+
+static void deliver(sim_frame *f)
+{
+    struct tcp_pcb *pcb;
+
+    if (g_replay && f->to_server && (tcp_header(f)[13] & TCP_ACK)) {
+        uint8_t *ack = f->data.data() + (f->data[0] & 0x0f) * 4 + 8;
+        put32(ack, get32(ack) - g_capture_server_isn + g_server_isn);
+    }
+    if (g_pcap_out) {
+        pcap_write(f);
+    }
+    if (f->to_server) {
+        pcb = g_server_open ? &g_server : &g_listen;
+    } else if (!g_replay) {
+        pcb = &g_client;
+    } else {
+        return;
+    }
+
+    sim_buf *b = f->data.size() + BENCH_HEADROOM <= g_buf_size ? buf_get() : nullptr;
+    if (!b) {
+        g_result.dropped++;
+        return;
+    }
+    memcpy(b->p.payload, f->data.data(), f->data.size());
+    b->p.len = b->p.tot_len = f->data.size();
+    b->p.type = PBUF_RAM;
+    b->p.ref = 1;
+    L3_level_tcp_input(&b->p, pcb);
+}
+
+/*
+ * Applications.
+ */
+
+static void send_pump(void)
+{
+    // snd_buf goes negative when the window is overcommitted
+    while (g_tx_bytes < g_config.bytes && tcp_sndbuf(&g_client) > 0) {
+        uint32_t len = (uint32_t)std::min<uint64_t>(
+            {(uint64_t)tcp_sndbuf(&g_client), g_config.bytes - g_tx_bytes, PATTERN_PERIOD});
+        pbuf_desc desc = {};
+
+        desc.attr = PBUF_DESC_NONE;
+        if (tcp_write(&g_client, g_pattern + g_tx_bytes % PATTERN_PERIOD, len,
+                      TCP_WRITE_FLAG_COPY, &desc) != ERR_OK) {
+            break;
+        }
+        g_tx_bytes += len;
+    }
+}
+
+static err_t client_connected_cb(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    (void)arg;
+    (void)pcb;
+    if (err == ERR_OK) {
+        send_pump();
+    }
+    return err;
+}
+
+static err_t client_sent_cb(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    (void)arg;
+    (void)pcb;
+    (void)len;
+    send_pump();
+    return ERR_OK;
+}
+
+static err_t server_recv_cb(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    uint32_t left;
+
+    (void)arg;
+    (void)err;
+    if (!p) {
+        return ERR_OK;
+    }
+    left = p->tot_len;
+    for (struct pbuf *q = p; q && left; q = q->next) {
+        uint32_t len = std::min(q->len, left);
+        const uint8_t *expected = g_pattern + g_result.rx_bytes % PATTERN_PERIOD;
+        if (!g_replay && !g_result.mismatch && memcmp(q->payload, expected, len)) {
+            const uint8_t *data = (const uint8_t *)q->payload;
+            uint32_t i = 0;
+            while (data[i] == expected[i]) {
+                i++;
+            }
+            g_result.mismatch = g_result.rx_bytes + i + 1;
+        }
+        g_result.rx_bytes += len;
+        left -= len;
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    while (!g_unrecovered.empty() && g_unrecovered.begin()->first <= g_result.rx_bytes) {
+        uint64_t ns = g_now_ns - g_unrecovered.begin()->second;
+        g_result.recoveries++;
+        g_result.recovery_sum_ns += ns;
+        g_result.recovery_max_ns = std::max(g_result.recovery_max_ns, ns);
+        g_unrecovered.erase(g_unrecovered.begin());
+    }
+    return ERR_OK;
+}
+
+static void server_err_cb(void *arg, err_t err)
+{
+    (void)arg;
+    fprintf(stderr, "server connection error %d\n", err);
+    g_server_open = false;
+}
+
+static err_t listen_clone_conn_cb(void *arg, struct tcp_pcb **newpcb)
+{
+    (void)arg;
+    // A single connection is benchmarked
+    if (g_server_open) {
+        *newpcb = nullptr;
+        return ERR_MEM;
+    }
+    tcp_pcb_init(&g_server, TCP_PRIO_NORMAL, &g_server);
+    tcp_ip_output(&g_server, ip_output);
+    tcp_recv(&g_server, server_recv_cb);
+    tcp_err(&g_server, server_err_cb);
+    g_server_open = true;
+    *newpcb = &g_server;
+    return ERR_OK;
+}
+
+static err_t listen_syn_handled_cb(void *arg, struct tcp_pcb *newpcb)
+{
+    (void)arg;
+    (void)newpcb;
+    return ERR_OK;
+}
+
+static err_t listen_accept_cb(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    (void)arg;
+    (void)newpcb;
+    return err;
+}
+
+/*
+ * Simulation.
+ */
+
+static void sim_init(void)
+{
+    static bool registered = false;
+
+    if (!registered) {
+        register_tcp_tx_pbuf_alloc(tx_pbuf_alloc);
+        register_tcp_tx_pbuf_free(tx_pbuf_free);
+        register_tcp_rx_pbuf_free(rx_pbuf_free);
+        register_tcp_seg_alloc(seg_alloc);
+        register_tcp_seg_free(seg_free);
+        register_tcp_state_observer(state_observer);
+        register_ip_route_mtu(route_mtu);
+        register_sys_now(virtual_now_ms);
+        for (uint32_t i = 0; i < sizeof(g_pattern); i++) {
+            uint32_t v = i % PATTERN_PERIOD;
+            g_pattern[i] = (uint8_t)(v * 31 + (v >> 8));
+        }
+        registered = true;
+    }
+
+    // Buffers are kept across runs, so they are sized for the largest MTU
+    g_buf_size = std::max<uint32_t>(g_buf_size, BENCH_HEADROOM + 9216 + 256);
+    while (!g_wire.empty()) {
+        frame_put(g_wire.top());
+        g_wire.pop();
+    }
+    g_unrecovered.clear();
+    g_result = bench_result();
+    g_now_ns = 0;
+    g_next_tmr_ns = g_config.tmr_msec * NSEC_PER_MSEC;
+    g_tmr_calls = 0;
+    g_frame_id = 0;
+    g_link_busy_ns[0] = g_link_busy_ns[1] = 0;
+    g_rand = g_config.seed ? g_config.seed : 1;
+    g_server_open = false;
+    g_client_isn = g_server_isn = 0;
+    g_tx_bytes = 0;
+    tcp_ticks = 0;
+
+    lwip_tcp_mss = g_config.mtu - IP_HLEN - TCP_HLEN;
+    lwip_tcp_snd_buf = g_config.sndbuf;
+    lwip_cc_algo_module = g_config.cc;
+    enable_ts_option = g_config.timestamps;
+    enable_wnd_scale = g_config.wnd_scale ? 1 : 0;
+    rcv_wnd_scale = g_config.wnd_scale;
+    lwip_tcp_ack_segs = g_config.ack_segs;
+    lwip_tcp_ack_bytes = g_config.ack_bytes;
+    lwip_tcp_ecn = g_config.ecn;
+    set_tmr_resolution(g_config.tmr_msec);
+}
+
+static void sim_listen(const ip_addr_t *ip, u16_t port)
+{
+    tcp_pcb_init(&g_listen, TCP_PRIO_NORMAL, &g_listen);
+    tcp_bind(&g_listen, ip, port, false);
+    tcp_listen(&g_listen, &g_listen);
+    tcp_ip_output(&g_listen, ip_output);
+    tcp_accept(&g_listen, listen_accept_cb);
+    tcp_syn_handled(&g_listen, listen_syn_handled_cb);
+    tcp_clone_conn(&g_listen, listen_clone_conn_cb);
+}
+
+static void sim_timers(void)
+{
+    if (!g_replay && get_tcp_state(&g_client) != CLOSED) {
+        tcp_tmr(&g_client);
+    }
+    if (g_server_open) {
+        tcp_tmr(&g_server);
+    }
+    // tcp_ticks runs at the slow timer rate
+    if (!(++g_tmr_calls & 1)) {
+        tcp_ticks++;
+    }
+}
+
+// Runs the wire and the timers until done() or, if stall detection is on,
+// until no data is received for STALL_NSEC of virtual time
+template <typename F> static bool sim_run(F done, bool detect_stall)
+{
+    uint64_t progress_ns = g_now_ns, rx_bytes = g_result.rx_bytes;
+
+    while (!done()) {
+        if (g_result.rx_bytes != rx_bytes) {
+            rx_bytes = g_result.rx_bytes;
+            progress_ns = g_now_ns;
+        } else if (detect_stall && g_now_ns - progress_ns > STALL_NSEC) {
+            return false;
+        }
+        if (!g_wire.empty() && g_wire.top()->ns < g_next_tmr_ns) {
+            sim_frame *f = g_wire.top();
+            g_wire.pop();
+            g_now_ns = f->ns;
+            deliver(f);
+            frame_put(f);
+        } else {
+            g_now_ns = g_next_tmr_ns;
+            g_next_tmr_ns += g_config.tmr_msec * NSEC_PER_MSEC;
+            sim_timers();
+        }
+    }
+    return true;
+}
+
+static void run_bench(void)
+{
+    ip_addr_t client_ip, server_ip;
+    uint64_t cpu_start;
+
+    g_replay = false;
+    sim_init();
+    client_ip.ip4.addr = htonl(0x0a000001);
+    server_ip.ip4.addr = htonl(0x0a000002);
+    sim_listen(&server_ip, 5001);
+
+    cpu_start = cpu_now_ns();
+    tcp_pcb_init(&g_client, TCP_PRIO_NORMAL, &g_client);
+    tcp_ip_output(&g_client, ip_output);
+    tcp_sent(&g_client, client_sent_cb);
+    tcp_bind(&g_client, &client_ip, 40000, false);
+    tcp_connect(&g_client, &server_ip, 5001, false, client_connected_cb);
+
+    g_result.stalled = !sim_run(
+        [] { return g_result.rx_bytes >= g_config.bytes || g_result.mismatch; }, true);
+    g_result.cpu_ns = cpu_now_ns() - cpu_start;
+    g_result.virt_ns = g_now_ns;
+
+    tcp_pcb_recycle(&g_client);
+    if (g_server_open) {
+        tcp_pcb_recycle(&g_server);
+    }
+}
+
+static int run_replay(const char *path)
+{
+    std::vector<capture_packet> packets;
+    const uint8_t *syn = nullptr;
+    uint64_t cpu_start, replayed = 0;
+    ip_addr_t server_ip;
+
+    if (pcap_load(path, packets) < 0) {
+        return -1;
+    }
+    // The client is the sender of the first SYN, the server answers with SYN-ACK
+    for (auto &pkt : packets) {
+        const uint8_t *tcp = pkt.data.data() + (pkt.data[0] & 0x0f) * 4;
+        if (!syn && (tcp[13] & (TCP_SYN | TCP_ACK)) == TCP_SYN) {
+            syn = pkt.data.data();
+        } else if (syn && (tcp[13] & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK) &&
+                   !memcmp(pkt.data.data() + 12, syn + 16, 4)) {
+            g_capture_server_isn = get32(tcp + 4);
+            break;
+        }
+    }
+    if (!syn) {
+        fprintf(stderr, "%s: no connection setup found\n", path);
+        return -1;
+    }
+    uint32_t client_addr = get32(syn + 12), server_addr = get32(syn + 16);
+    uint16_t client_port = get16(syn + (syn[0] & 0x0f) * 4);
+    uint16_t server_port = get16(syn + (syn[0] & 0x0f) * 4 + 2);
+
+    g_replay = true;
+    sim_init();
+    server_ip.ip4.addr = htonl(server_addr);
+    sim_listen(&server_ip, server_port);
+
+    // Client frames are delivered as captured, the link model shapes the responses
+    for (auto &pkt : packets) {
+        const uint8_t *tcp = pkt.data.data() + (pkt.data[0] & 0x0f) * 4;
+        if (get32(pkt.data.data() + 12) != client_addr || get16(tcp) != client_port ||
+            get32(pkt.data.data() + 16) != server_addr || get16(tcp + 2) != server_port) {
+            continue;
+        }
+        sim_frame *f = frame_get();
+        f->ns = pkt.ns;
+        f->id = ++g_frame_id;
+        f->to_server = true;
+        f->data.swap(pkt.data);
+        g_wire.push(f);
+        replayed++;
+    }
+
+    cpu_start = cpu_now_ns();
+    sim_run([] { return g_wire.empty(); }, false);
+    g_result.cpu_ns = cpu_now_ns() - cpu_start;
+    g_result.virt_ns = g_now_ns;
+    if (g_server_open) {
+        tcp_pcb_recycle(&g_server);
+    }
+
+    printf("replayed %lu frames in %.3f s virtual: %lu bytes in order, %lu response "
+           "segments\n",
+           (unsigned long)replayed, (double)g_result.virt_ns / NSEC_PER_SEC,
+           (unsigned long)g_result.rx_bytes, (unsigned long)g_result.segments);
+    printf("cpu %.3f s: %.0f frames/s\n", (double)g_result.cpu_ns / NSEC_PER_SEC,
+           g_result.cpu_ns ? replayed * (double)NSEC_PER_SEC / g_result.cpu_ns : 0);
+    return 0;
+}
+
+static void report(const char *name)
+{
+    const bench_result &r = g_result;
+    double virt_sec = (double)r.virt_ns / NSEC_PER_SEC;
+
+    if (name) {
+        printf("%-12s ", name);
+    }
+    printf("%lu bytes in %.3f s virtual, goodput %.1f Mbit/s\n", (unsigned long)r.rx_bytes,
+           virt_sec, virt_sec > 0 ? r.rx_bytes * 8 / virt_sec / 1e6 : 0);
+    printf("%*ssegments %lu (data %lu, retransmitted %lu, dropped %lu, reordered %lu)\n",
+           name ? 13 : 0, "", (unsigned long)r.segments, (unsigned long)r.data_segments,
+           (unsigned long)r.rexmits, (unsigned long)r.dropped, (unsigned long)r.reordered);
+    printf("%*sacks %lu (%.1f per MB)\n", name ? 13 : 0, "", (unsigned long)r.acks,
+           r.rx_bytes ? r.acks * 1048576.0 / r.rx_bytes : 0);
+    if (r.marked || r.ece) {
+        printf("%*secn marked %lu, ece %lu, ect acks %lu, ect retransmitted %lu\n", name ? 13 : 0,
+               "", (unsigned long)r.marked, (unsigned long)r.ece, (unsigned long)r.ect_acks,
+               (unsigned long)r.ect_rexmits);
+    }
+    printf("%*scpu %.3f s: %.0f segments/s, %.2f ns/byte\n", name ? 13 : 0, "",
+           (double)r.cpu_ns / NSEC_PER_SEC,
+           r.cpu_ns ? r.segments * (double)NSEC_PER_SEC / r.cpu_ns : 0,
+           r.rx_bytes ? (double)r.cpu_ns / r.rx_bytes : 0);
+    if (r.recoveries) {
+        printf("%*srecovery of %lu drops: avg %.3f ms, max %.3f ms\n", name ? 13 : 0, "",
+               (unsigned long)r.recoveries, r.recovery_sum_ns / 1e6 / r.recoveries,
+               r.recovery_max_ns / 1e6);
+    }
+    if (r.mismatch) {
+        printf("%*sdata mismatch at stream offset %lu\n", name ? 13 : 0, "",
+               (unsigned long)r.mismatch - 1);
+    }
+    if (r.stalled) {
+        printf("%*sstalled after %lu bytes\n", name ? 13 : 0, "", (unsigned long)r.rx_bytes);
+    }
+}
+
+static int parse_drops(char *spec)
+{
+    for (char *range = strtok(spec, ","); range; range = strtok(nullptr, ",")) {
+        unsigned long first, last;
+        int n = sscanf(range, "%lu-%lu", &first, &last);
+        if (n < 1 || !first || (n == 2 && last < first)) {
+            fprintf(stderr, "Invalid drop range: %s\n", range);
+            return -1;
+        }
+        g_config.drops.push_back({first, n == 2 ? last : first});
+    }
+    return 0;
+}
+
+static uint64_t parse_size(const char *str)
+{
+    char *end;
+    uint64_t v = strtoull(str, &end, 0);
+
+    switch (*end) {
+    case 'g':
+    case 'G':
+        v <<= 10;
+        /* fallthrough */
+    case 'm':
+    case 'M':
+        v <<= 10;
+        /* fallthrough */
+    case 'k':
+    case 'K':
+        v <<= 10;
+        break;
+    default:
+        break;
+    }
+    return v;
+}
+
+// Conformance scenarios, every transfer must complete with intact data
+static int run_check(void)
+{
+    struct scenario {
+        const char *name;
+        void (*setup)(bench_config &);
+        bool vs_ack2 = false; // Compare with an ACK for every second segment
+    };
+    static const scenario scenarios[] = {
+        {"clean", [](bench_config &) {}},
+        {"loss", [](bench_config &c) { c.loss = 1; }},
+        {"burst", [](bench_config &c) { c.drops = {{100, 115}}; }},
+        {"reorder", [](bench_config &c) { c.reorder = 5; }},
+        {"rexmit-drop", [](bench_config &c) { c.drops = {{50, 50}, {51, 60}, {700, 702}}; }},
+        {"bottleneck",
+         [](bench_config &c) {
+             c.rate_mbps = 1000;
+             c.queue_pkts = 64;
+             c.cc = CC_MOD_CUBIC;
+         }},
+        {"scaled",
+         [](bench_config &c) {
+             c.wnd_scale = 7;
+             c.timestamps = true;
+             c.sndbuf = 4 * 1024 * 1024;
+             c.loss = 0.5;
+         }},
+        {"jumbo", [](bench_config &c) { c.mtu = 9000; }},
+        {"ack-stride",
+         [](bench_config &c) {
+             c.ack_segs = 16;
+             c.ack_bytes = 64 * 1024;
+             c.wnd_scale = 7;
+             c.sndbuf = 4 * 1024 * 1024;
+         },
+         true},
+        {"ack-coalesce",
+         [](bench_config &c) {
+             c.ack_segs = 16;
+             c.ack_bytes = 64 * 1024;
+             c.wnd_scale = 7;
+             c.sndbuf = 4 * 1024 * 1024;
+             c.loss = 0.5;
+         },
+         true},
+        {"ecn",
+         [](bench_config &c) {
+             c.ecn = 1;
+             c.mark = 1;
+             c.loss = 0.5;
+         }},
+        {"dctcp",
+         [](bench_config &c) {
+             c.rate_mbps = 1000;
+             c.queue_pkts = 64;
+             c.mark_pkts = 20;
+             c.cc = CC_MOD_DCTCP;
+             c.wnd_scale = 7;
+             c.sndbuf = 4 * 1024 * 1024;
+         }},
+    };
+    char trace[] = "/tmp/lwip_tcp_bench_XXXXXX";
+    int failed = 0;
+
+    for (const scenario &s : scenarios) {
+        bench_result ref;
+        if (s.vs_ack2) {
+            g_config = bench_config();
+            g_config.bytes = 8ULL << 20;
+            s.setup(g_config);
+            g_config.ack_segs = 2;
+            g_config.ack_bytes = 0;
+            run_bench();
+            ref = g_result;
+        }
+        g_config = bench_config();
+        g_config.bytes = 8ULL << 20;
+        s.setup(g_config);
+        run_bench();
+        bool ok = !g_result.stalled && !g_result.mismatch && g_result.rx_bytes == g_config.bytes;
+        // Fewer ACKs must not cost the sender much of its goodput
+        if (s.vs_ack2) {
+            ok = ok && ref.rx_bytes == g_result.rx_bytes && g_result.acks * 2 <= ref.acks &&
+                g_result.virt_ns * 7 <= ref.virt_ns * 10;
+        }
+        // Marks are echoed and marking below the queue limit avoids drops
+        if (g_config.mark > 0 || g_config.mark_pkts) {
+            ok = ok && g_result.marked && g_result.ece;
+        }
+        if (g_config.mark_pkts) {
+            ok = ok && !g_result.dropped;
+        }
+        // Classic ECN sends only new data ECN capable (RFC 3168 6.1.4, 6.1.5)
+        if (g_config.ecn && g_config.cc != CC_MOD_DCTCP) {
+            ok = ok && g_result.rexmits && !g_result.ect_acks && !g_result.ect_rexmits;
+        }
+        printf("%s ", ok ? "PASS" : "FAIL");
+        report(s.name);
+        failed += !ok;
+    }
+
+    // A trace replayed into a fresh pcb delivers the same stream
+    int fd = mkstemp(trace);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    g_config = bench_config();
+    g_config.bytes = 8ULL << 20;
+    g_config.loss = 1;
+    g_pcap_out = pcap_open(trace);
+    run_bench();
+    fclose(g_pcap_out);
+    g_pcap_out = nullptr;
+    uint64_t expected = g_result.rx_bytes;
+    bool ok = run_replay(trace) == 0 && expected == g_config.bytes &&
+        g_result.rx_bytes == expected;
+    printf("%s replay\n", ok ? "PASS" : "FAIL");
+    failed += !ok;
+    unlink(trace);
+
+    return failed ? 1 : 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: lwip_tcp_bench [-n bytes] [-m mtu] [-c lwip|cubic|none|dctcp] [-b sndbuf] "
+            "[-s wnd scale] [-T] [-t timer msec] [-a ack segs] [-A ack bytes] "
+            "[-E ecn] [-d delay usec] [-B Mbit/s] [-q packets] "
+            "[-l loss %%] [-o reorder %%] [-O reorder usec] [-K mark packets] [-M mark %%] "
+            "[-D n[-m][,...]] [-S seed] "
+            "[-w out.pcap]\n"
+            "       lwip_tcp_bench -r in.pcap [-w out.pcap] [stack options]\n"
+            "       lwip_tcp_bench --check\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {{"check", no_argument, nullptr, 'C'},
+                                                 {"help", no_argument, nullptr, 'h'},
+                                                 {nullptr, 0, nullptr, 0}};
+    const char *pcap_in = nullptr, *pcap_out = nullptr;
+    int opt, rc;
+
+    while ((opt = getopt_long(argc, argv, "n:m:c:b:s:Tt:a:A:E:d:B:q:l:o:O:K:M:D:S:w:r:h",
+                              long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'n':
+            g_config.bytes = parse_size(optarg);
+            break;
+        case 'm':
+            g_config.mtu = atoi(optarg);
+            break;
+        case 'c':
+            if (!strcmp(optarg, "lwip")) {
+                g_config.cc = CC_MOD_LWIP;
+            } else if (!strcmp(optarg, "cubic")) {
+                g_config.cc = CC_MOD_CUBIC;
+            } else if (!strcmp(optarg, "none")) {
+                g_config.cc = CC_MOD_NONE;
+            } else if (!strcmp(optarg, "dctcp")) {
+                g_config.cc = CC_MOD_DCTCP;
+            } else {
+                usage();
+                return 1;
+            }
+            break;
+        case 'b':
+            g_config.sndbuf = parse_size(optarg);
+            break;
+        case 's':
+            g_config.wnd_scale = std::min(atoi(optarg), 14);
+            break;
+        case 'T':
+            g_config.timestamps = true;
+            break;
+        case 't':
+            g_config.tmr_msec = atoi(optarg);
+            break;
+        case 'a':
+            g_config.ack_segs = atoi(optarg);
+            break;
+        case 'A':
+            g_config.ack_bytes = parse_size(optarg);
+            break;
+            break;
+        case 'E':
+            g_config.ecn = atoi(optarg);
+            break;
+        case 'd':
+            g_config.delay_ns = strtoull(optarg, nullptr, 0) * NSEC_PER_USEC;
+            break;
+        case 'B':
+            g_config.rate_mbps = strtoull(optarg, nullptr, 0);
+            break;
+        case 'q':
+            g_config.queue_pkts = atoi(optarg);
+            break;
+        case 'l':
+            g_config.loss = atof(optarg);
+            break;
+        case 'o':
+            g_config.reorder = atof(optarg);
+            break;
+        case 'O':
+            g_config.reorder_ns = strtoull(optarg, nullptr, 0) * NSEC_PER_USEC;
+            break;
+        case 'K':
+            g_config.mark_pkts = atoi(optarg);
+            break;
+        case 'M':
+            g_config.mark = atof(optarg);
+            break;
+        case 'D':
+            if (parse_drops(optarg) < 0) {
+                return 1;
+            }
+            break;
+        case 'S':
+            g_config.seed = strtoull(optarg, nullptr, 0);
+            break;
+        case 'w':
+            pcap_out = optarg;
+            break;
+        case 'r':
+            pcap_in = optarg;
+            break;
+        case 'C':
+            return run_check();
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if (optind != argc || !g_config.bytes || !g_config.tmr_msec || !g_config.ack_segs ||
+        g_config.mtu < 576 ||
+        g_config.mtu > 9000) {
+        usage();
+        return 1;
+    }
+    if (pcap_out && !(g_pcap_out = pcap_open(pcap_out))) {
+        return 1;
+    }
+
+    if (pcap_in) {
+        rc = run_replay(pcap_in) < 0 ? 1 : 0;
+    } else {
+        run_bench();
+        report(nullptr);
+        rc = (g_result.stalled || g_result.mismatch) ? 1 : 0;
+    }
+    if (g_pcap_out) {
+        fclose(g_pcap_out);
+    }
+    return rc;
+}
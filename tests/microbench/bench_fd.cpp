@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * fd_collection lookups which every call of the preloaded library does on its
+ * fd. The sockets are placeholders, only their addresses go through the map.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "sock/fd_collection.h"
+
+#include "microbench.h"
+
+using namespace microbench;
+
+#define BENCH_FD_SOCKETS 16384
+
+// Memory of a socket in the map, only its node of the pending to remove list is initialized.
+struct bench_fd_socket {
+    alignas(sockinfo) char data[sizeof(sockinfo)];
+};
+
+static std::vector<bench_fd_socket> s_sockets;
+
+// The collection is never destroyed, its destructor would close the placeholders.
+static fd_collection *bench_fd_collection()
+{
+    static fd_collection *fdc = []() {
+        fd_collection *p_fdc = new fd_collection();
+        int count = std::min(BENCH_FD_SOCKETS, p_fdc->get_fd_map_size() / 2);
+
+        s_sockets.resize(count);
+        for (int fd = 0; fd < count; fd++) {
+            sockinfo *si = reinterpret_cast<sockinfo *>(s_sockets[fd].data);
+            new (&si->pendig_to_remove_node) decltype(si->pendig_to_remove_node)();
+            p_fdc->reuse_sockfd(fd, si);
+        }
+        g_p_fd_collection = p_fdc;
+        return p_fdc;
+    }();
+    return fdc;
+}
+
+// Lookups of range() offloaded sockets in a random order, as the socket calls of an application.
+static void fd_collection_lookup(state &st)
+{
+    bench_fd_collection();
+    int count = (int)std::min<int64_t>(st.range(), (int64_t)s_sockets.size());
+    std::vector<int> fds(count);
+    size_t i = 0;
+
+    for (int fd = 0; fd < count; fd++) {
+        fds[fd] = fd;
+    }
+    std::shuffle(fds.begin(), fds.end(), std::mt19937(st.thread_index()));
+    while (st.keep_running()) {
+        sockinfo *si = fd_collection_get_sockfd(fds[i]);
+        do_not_optimize(si);
+        if (++i == fds.size()) {
+            i = 0;
+        }
+    }
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(fd_collection_lookup)->arg(16)->arg(1024)->arg(16384)->thread_range();
+
+// Fds which are not offloaded, the collection only sees a null entry or an fd out of the map.
+static void fd_collection_lookup_miss(state &st)
+{
+    fd_collection *fdc = bench_fd_collection();
+    const int fds[] = {fdc->get_fd_map_size() - 1, -1, fdc->get_fd_map_size()};
+    size_t i = 0;
+
+    while (st.keep_running()) {
+        sockinfo *si = fd_collection_get_sockfd(fds[i]);
+        do_not_optimize(si);
+        if (++i == sizeof(fds) / sizeof(fds[0])) {
+            i = 0;
+        }
+    }
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(fd_collection_lookup_miss);
+
+// Reads on OS fds check for a tap or an epoll fd under the collection lock.
+static void fd_collection_os_sample(state &st)
+{
+    fd_collection *fdc = bench_fd_collection();
+    int fd = fdc->get_fd_map_size() - 1;
+
+    while (st.keep_running()) {
+        bool found = fdc->set_immediate_os_sample(fd);
+        do_not_optimize(found);
+    }
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(fd_collection_os_sample)->thread_range();
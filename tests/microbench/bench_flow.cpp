@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Flow tuple hashing and the hash map lookup which steers received packets
+ * to rings and sockets.
+ */
+
+#include <arpa/inet.h>
+#include <unordered_map>
+#include <vector>
+
+#include "proto/flow_tuple.h"
+
+#include "microbench.h"
+
+using namespace microbench;
+
+static flow_tuple_with_local_if make_flow(uint32_t i, sa_family_t family)
+{
+    if (family == AF_INET) {
+        return flow_tuple_with_local_if(ip_address(htonl(0x0a000001)), htons(5001),
+                                        ip_address(htonl(0x0b000000 + (i >> 10))),
+                                        htons(1024 + (i & 1023)), PROTO_TCP, AF_INET,
+                                        ip_address(htonl(0x0a000001)));
+    }
+    in6_addr dst = IN6ADDR_LOOPBACK_INIT;
+    in6_addr src = IN6ADDR_LOOPBACK_INIT;
+    src.s6_addr32[2] = htonl(i >> 10);
+    return flow_tuple_with_local_if(ip_address(dst), htons(5001), ip_address(src),
+                                    htons(1024 + (i & 1023)), PROTO_TCP, AF_INET6,
+                                    ip_address(dst));
+}
+
+static void flow_tuple_hash(state &st, sa_family_t family)
+{
+    std::vector<flow_tuple_with_local_if> flows;
+    size_t i = 0;
+
+    for (uint32_t n = 0; n < 1024; n++) {
+        flows.push_back(make_flow(n, family));
+    }
+    while (st.keep_running()) {
+        size_t hash = flows[i++ & 1023].hash();
+        do_not_optimize(hash);
+    }
+    st.set_items_processed(st.iterations());
+}
+
+static void flow_tuple_hash_ipv4(state &st)
+{
+    flow_tuple_hash(st, AF_INET);
+}
+MICROBENCH(flow_tuple_hash_ipv4);
+
+static void flow_tuple_hash_ipv6(state &st)
+{
+    flow_tuple_hash(st, AF_INET6);
+}
+MICROBENCH(flow_tuple_hash_ipv6);
+
+// Lookup of established flows in a map of range() entries, as rx_flow_map_t is used.
+static void flow_map_lookup(state &st, sa_family_t family)
+{
+    std::unordered_map<flow_tuple_with_local_if, void *> map;
+    std::vector<flow_tuple_with_local_if> keys;
+    uint32_t count = (uint32_t)st.range();
+    size_t i = 0;
+
+    for (uint32_t n = 0; n < count; n++) {
+        keys.push_back(make_flow(n, family));
+        map[keys.back()] = &keys;
+    }
+    while (st.keep_running()) {
+        auto iter = map.find(keys[i]);
+        do_not_optimize(iter->second);
+        if (++i == count) {
+            i = 0;
+        }
+    }
+    st.set_items_processed(st.iterations());
+}
+
+static void flow_map_lookup_ipv4(state &st)
+{
+    flow_map_lookup(st, AF_INET);
+}
+MICROBENCH(flow_map_lookup_ipv4)->arg(16)->arg(1024)->arg(65536);
+
+static void flow_map_lookup_ipv6(state &st)
+{
+    flow_map_lookup(st, AF_INET6);
+}
+MICROBENCH(flow_map_lookup_ipv6)->arg(16)->arg(65536);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Intrusive and chunked FIFOs used for buffer and socket queues, and the
+ * scatter/gather walk of the TX copy path.
+ */
+
+#include <vector>
+
+#include "util/vtypes.h"
+#include "util/xlio_list.h"
+#include "util/chunk_list.h"
+#include "util/sg_array.h"
+
+#include "microbench.h"
+
+using namespace microbench;
+
+struct list_obj {
+    static inline size_t node_offset(void) { return NODE_OFFSET(list_obj, node); }
+
+    list_node<list_obj, list_obj::node_offset> node;
+    uint64_t payload;
+};
+
+typedef xlio_list_t<list_obj, list_obj::node_offset> list_obj_list_t;
+
+// Rotate a queue of the given depth: pop the oldest element and append it.
+static void xlio_list_fifo(state &st)
+{
+    std::vector<list_obj> objs(st.range());
+    list_obj_list_t list;
+
+    for (list_obj &obj : objs) {
+        list.push_back(&obj);
+    }
+    while (st.keep_running()) {
+        list_obj *obj = list.get_and_pop_front();
+        do_not_optimize(obj->payload);
+        list.push_back(obj);
+    }
+    list.clear_without_cleanup();
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(xlio_list_fifo)->arg(1)->arg(64)->arg(4096);
+
+// Move a batch between two lists the way completion processing hands descriptors over.
+static void xlio_list_splice(state &st)
+{
+    std::vector<list_obj> objs(st.range());
+    list_obj_list_t from, to;
+
+    for (list_obj &obj : objs) {
+        from.push_back(&obj);
+    }
+    while (st.keep_running()) {
+        to.splice_tail(from);
+        from.splice_tail(to);
+    }
+    from.clear_without_cleanup();
+    st.set_items_processed(st.iterations() * 2);
+}
+MICROBENCH(xlio_list_splice)->arg(64);
+
+static void chunk_list_fifo(state &st)
+{
+    chunk_list_t<void *> list;
+    int64_t depth = st.range();
+
+    for (int64_t i = 0; i < depth; i++) {
+        list.push_back((void *)(i + 1));
+    }
+    while (st.keep_running()) {
+        void *obj = list.get_and_pop_front();
+        do_not_optimize(obj);
+        list.push_back(obj);
+    }
+    while (!list.empty()) {
+        list.pop_front();
+    }
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(chunk_list_fifo)->arg(1)->arg(CHUNK_LIST_CONTAINER_SIZE)->arg(4096);
+
+// Push and drain a burst, which allocates and recycles containers.
+static void chunk_list_burst(state &st)
+{
+    chunk_list_t<void *> list;
+    int64_t burst = st.range();
+
+    while (st.keep_running()) {
+        for (int64_t i = 0; i < burst; i++) {
+            list.push_back((void *)(i + 1));
+        }
+        while (!list.empty()) {
+            void *obj = list.get_and_pop_front();
+            do_not_optimize(obj);
+        }
+    }
+    st.set_items_processed(st.iterations() * burst);
+}
+MICROBENCH(chunk_list_burst)->arg(256);
+
+// Copy out a message of range() SGEs of 1500 bytes in 256 bytes chunks.
+static void sg_array_get_data(state &st)
+{
+    const int sge_len = 1500;
+    const int chunk = 256;
+    int num_sge = (int)st.range();
+    std::vector<uint8_t> data((size_t)num_sge * sge_len, 0xa5);
+    std::vector<ibv_sge> sge(num_sge);
+    uint64_t chunks = 0;
+
+    for (int i = 0; i < num_sge; i++) {
+        sge[i].addr = (uintptr_t)&data[(size_t)i * sge_len];
+        sge[i].length = sge_len;
+        sge[i].lkey = 0;
+    }
+    while (st.keep_running()) {
+        sg_array sa(sge.data(), num_sge);
+        int len = chunk;
+        uint8_t *p;
+        while ((p = sa.get_data(&len))) {
+            do_not_optimize(*p);
+            chunks++;
+            len = chunk;
+        }
+    }
+    st.set_items_processed(chunks);
+}
+MICROBENCH(sg_array_get_data)->arg(1)->arg(16);
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Object pools and the locks protecting them. The tcp_seg pool and the buffer
+ * pools are shared by all rings, so the multi threaded runs show the cost of
+ * their contention.
+ */
+
+#include "dev/buffer_pool.h"
+#include "util/cached_obj_pool.h"
+#include "lwip/tcp_impl.h"
+
+#include "microbench.h"
+
+using namespace microbench;
+
+static uint32_t s_seg_pool_size;
+static uint32_t s_seg_pool_no_segs;
+
+static cached_obj_pool<tcp_seg> &seg_pool()
+{
+    static cached_obj_pool<tcp_seg> pool("microbench tcp_seg", 16384, s_seg_pool_size,
+                                         s_seg_pool_no_segs);
+    return pool;
+}
+
+// Ring style bulk get and return of a tcp_seg list.
+static void cached_obj_pool_get_put(state &st)
+{
+    cached_obj_pool<tcp_seg> &pool = seg_pool();
+    uint32_t batch = (uint32_t)st.range();
+
+    while (st.keep_running()) {
+        tcp_seg *segs = pool.get_objs(batch);
+        if (!segs) {
+            st.skip_with_error("tcp_seg pool exhausted");
+            continue;
+        }
+        do_not_optimize(segs);
+        pool.put_objs(segs);
+    }
+    st.set_items_processed(st.iterations() * batch);
+}
+MICROBENCH(cached_obj_pool_get_put)->arg(1)->arg(16)->arg(64)->thread_range();
+
+// Bulk transfer of a list whose tail and length are known, as rings return their surplus.
+static void cached_obj_pool_bulk(state &st)
+{
+    cached_obj_pool<tcp_seg> &pool = seg_pool();
+    uint32_t batch = (uint32_t)st.range();
+
+    while (st.keep_running()) {
+        std::pair<tcp_seg *, tcp_seg *> list = pool.get_obj_list(batch);
+        if (!list.first) {
+            st.skip_with_error("tcp_seg pool exhausted");
+            continue;
+        }
+        pool.put_obj_list(list.first, list.second, batch);
+    }
+    st.set_items_processed(st.iterations() * batch);
+}
+MICROBENCH(cached_obj_pool_bulk)->arg(64)->arg(1024)->thread_range();
+
+// Per ring cache refilled from the global pool in batches, as ring::get_tcp_segs() does.
+static void cached_obj_pool_ring_cache(state &st)
+{
+    cached_obj_pool<tcp_seg> &pool = seg_pool();
+    const uint32_t batch = 256;
+    uint32_t want = (uint32_t)st.range();
+    tcp_seg *cache = nullptr;
+    uint32_t count = 0;
+
+    while (st.keep_running()) {
+        if (count < want) {
+            std::pair<tcp_seg *, tcp_seg *> list = pool.get_obj_list(batch);
+            if (!list.first) {
+                st.skip_with_error("tcp_seg pool exhausted");
+                continue;
+            }
+            list.second->next = cache;
+            cache = list.first;
+            count += batch;
+        }
+        tcp_seg *segs = cached_obj_pool<tcp_seg>::split_obj_list(want, cache, count);
+        do_not_optimize(segs);
+        // Give the segments back to the local cache and return the surplus.
+        tcp_seg *last = segs;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = cache;
+        cache = segs;
+        count += want;
+        if (count > 2 * batch) {
+            pool.put_objs(cached_obj_pool<tcp_seg>::split_obj_list(batch, cache, count));
+        }
+    }
+    if (cache) {
+        pool.put_objs(cache);
+    }
+    st.set_items_processed(st.iterations() * want);
+}
+MICROBENCH(cached_obj_pool_ring_cache)->arg(1)->arg(16)->thread_range();
+
+static buffer_pool &rx_pool()
+{
+    // Receive buffers of a standard MTU, the pool grows over the first 512 with the threads.
+    static buffer_pool pool(BUFFER_POOL_RX, 2048);
+    return pool;
+}
+
+// Ring style refill of the receive queue and return of the consumed buffers.
+static void buffer_pool_get_put(state &st)
+{
+    buffer_pool &pool = rx_pool();
+    size_t batch = (size_t)st.range();
+    descq_t bufs;
+
+    while (st.keep_running()) {
+        if (!pool.get_buffers_thread_safe(bufs, nullptr, batch, 0)) {
+            st.skip_with_error("Rx buffer pool exhausted");
+            continue;
+        }
+        do_not_optimize(bufs.front());
+        pool.put_buffers_thread_safe(&bufs, batch);
+    }
+    st.set_items_processed(st.iterations() * batch);
+}
+MICROBENCH(buffer_pool_get_put)->arg(1)->arg(16)->arg(64)->thread_range();
+
+template <typename LOCK> static void lock_unlock(state &st)
+{
+    static LOCK s_lock("microbench");
+
+    while (st.keep_running()) {
+        s_lock.lock();
+        clobber_memory();
+        s_lock.unlock();
+    }
+    st.set_items_processed(st.iterations());
+}
+
+static void lock_spin_lock_unlock(state &st)
+{
+    lock_unlock<lock_spin>(st);
+}
+MICROBENCH(lock_spin_lock_unlock)->thread_range();
+
+static void lock_mutex_lock_unlock(state &st)
+{
+    lock_unlock<lock_mutex>(st);
+}
+MICROBENCH(lock_mutex_lock_unlock)->thread_range();
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * The delta list timer of the event handler manager. Insertion walks the
+ * list, so it is measured against the number of registered timers.
+ */
+
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+#include "event/delta_timer.h"
+#include "event/timer_handler.h"
+
+#include "microbench.h"
+
+using namespace microbench;
+
+class count_handler : public timer_handler {
+public:
+    void handle_timer_expired(void *user_data) override
+    {
+        NOT_IN_USE(user_data);
+        m_expired++;
+    }
+
+    uint64_t m_expired = 0;
+};
+
+// Allocated like event_handler_manager::register_timer_event() does.
+static timer_node_t *new_timer_node()
+{
+    timer_node_t *node = (timer_node_t *)calloc(1, sizeof(timer_node_t));
+    if (node) {
+        new (&node->lock_timer) lock_spin_recursive("timer");
+    }
+    return node;
+}
+
+static bool add_periodic_timers(timer &tmr, count_handler &handler, int64_t count)
+{
+    for (int64_t i = 0; i < count; i++) {
+        timer_node_t *node = new_timer_node();
+        if (!node) {
+            return false;
+        }
+        // Spread over a second, like TCP and neighbour timers of many sockets.
+        tmr.add_new_timer(1 + (unsigned)((i * 7919) % 1000), node, &handler, nullptr,
+                          PERIODIC_TIMER);
+    }
+    return true;
+}
+
+// Register and cancel a one shot timer while range() periodic timers are armed.
+static void delta_timer_add_remove(state &st)
+{
+    timer tmr;
+    count_handler background, handler;
+
+    if (!add_periodic_timers(tmr, background, st.range())) {
+        st.skip_with_error("timer node allocation failed");
+    }
+    while (st.keep_running()) {
+        timer_node_t *node = new_timer_node();
+        tmr.add_new_timer(500, node, &handler, nullptr, ONE_SHOT_TIMER);
+        tmr.remove_timer(node, &handler);
+    }
+    tmr.remove_all_timers(&background);
+    st.set_items_processed(st.iterations());
+}
+MICROBENCH(delta_timer_add_remove)->arg(0)->arg(64)->arg(1024);
+
+// Expire range() one shot timers in one pass.
+static void delta_timer_expire(state &st)
+{
+    timer tmr;
+    count_handler handler;
+    int64_t count = st.range();
+
+    while (st.keep_running()) {
+        st.pause_timing();
+        for (int64_t i = 0; i < count; i++) {
+            tmr.add_new_timer(0, new_timer_node(), &handler, nullptr, ONE_SHOT_TIMER);
+        }
+        st.resume_timing();
+        tmr.process_registered_timers();
+    }
+    if (handler.m_expired != st.iterations() * count) {
+        st.skip_with_error("timers were not expired");
+    }
+    st.set_items_processed(handler.m_expired);
+}
+MICROBENCH(delta_timer_expire)->arg(16)->arg(256);
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Microbenchmarks of the libxlio core containers, pools, timers and flow
+ * lookups. They run without a NIC, so they can be used in CI to track the
+ * cost of the data path building blocks across commits.
+ *
+ *   microbench [--benchmark_filter=regex] [--benchmark_min_time=sec]
+ *              [--benchmark_format=console|json] [--benchmark_out=file]
+ *              [--benchmark_list_tests]
+ *
+ * --benchmark_out always writes JSON in the Google Benchmark schema, so two
+ * runs can be compared with its tools/compare.py. Multi threaded benchmarks
+ * report the per thread iterations and time per iteration of a thread;
+ * items_per_second is the aggregate rate of all threads.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <regex>
+#include <thread>
+
+#include "core_stubs/core_stubs.h"
+#include "dev/allocator.h"
+#include "microbench.h"
+
+namespace microbench {
+
+void barrier::wait()
+{
+    int gen = m_generation.load(std::memory_order_acquire);
+    if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+        m_waiting.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (m_generation.load(std::memory_order_acquire) == gen) {
+        if (m_count > 1) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+state::state(uint64_t iterations, int64_t arg, int thread_index, int threads, barrier &start)
+    : m_remaining(0)
+    , m_iterations(iterations)
+    , m_arg(arg)
+    , m_thread_index(thread_index)
+    , m_threads(threads)
+    , m_start(start)
+{
+}
+
+bool state::finish()
+{
+    if (!m_started) {
+        m_started = true;
+        m_start.wait();
+        m_remaining = m_iterations - 1;
+        m_cpu_start = now_nsec(CLOCK_THREAD_CPUTIME_ID);
+        m_real_start = now_nsec(CLOCK_MONOTONIC);
+        return true;
+    }
+    m_real_nsec += now_nsec(CLOCK_MONOTONIC) - m_real_start;
+    m_cpu_nsec += now_nsec(CLOCK_THREAD_CPUTIME_ID) - m_cpu_start;
+    return false;
+}
+
+void state::pause_timing()
+{
+    m_real_nsec += now_nsec(CLOCK_MONOTONIC) - m_real_start;
+    m_cpu_nsec += now_nsec(CLOCK_THREAD_CPUTIME_ID) - m_cpu_start;
+}
+
+void state::resume_timing()
+{
+    m_cpu_start = now_nsec(CLOCK_THREAD_CPUTIME_ID);
+    m_real_start = now_nsec(CLOCK_MONOTONIC);
+}
+
+benchmark::benchmark(const char *name, bench_fn fn)
+    : m_name(name)
+    , m_fn(fn)
+{
+}
+
+benchmark *benchmark::arg(int64_t value)
+{
+    m_args.push_back(value);
+    return this;
+}
+
+benchmark *benchmark::range(int64_t lo, int64_t hi, int mult)
+{
+    for (int64_t v = lo; v < hi; v *= mult) {
+        m_args.push_back(v);
+    }
+    m_args.push_back(hi);
+    return this;
+}
+
+benchmark *benchmark::threads(int count)
+{
+    m_threads.push_back(count);
+    return this;
+}
+
+benchmark *benchmark::thread_range(int max_threads)
+{
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_threads <= 0 || max_threads > cpus) {
+        max_threads = std::max(cpus, 1);
+    }
+    for (int t = 1; t < max_threads; t *= 2) {
+        m_threads.push_back(t);
+    }
+    m_threads.push_back(max_threads);
+    return this;
+}
+
+static std::vector<benchmark *> &benchmarks()
+{
+    static std::vector<benchmark *> list;
+    return list;
+}
+
+benchmark *register_benchmark(benchmark *bench)
+{
+    benchmarks().push_back(bench);
+    return bench;
+}
+
+} // namespace microbench
+
+using namespace microbench;
+
+struct run_result {
+    std::string name;
+    int threads;
+    uint64_t iterations;
+    double real_nsec; // wall time of the slowest thread
+    double cpu_nsec; // summed over threads
+    uint64_t items;
+    const char *error;
+};
+
+static double g_min_time = 0.5;
+
+static run_result run_once(benchmark *bench, int64_t arg, int threads, uint64_t iterations)
+{
+    barrier start(threads);
+    std::vector<state *> states;
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++) {
+        states.push_back(new state(iterations, arg, i, threads, start));
+    }
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back([bench, &states, i]() { bench->m_fn(*states[i]); });
+    }
+    bench->m_fn(*states[0]);
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    run_result res = {std::string(), threads, iterations, 0.0, 0.0, 0, nullptr};
+    for (state *st : states) {
+        res.real_nsec = std::max(res.real_nsec, (double)st->m_real_nsec);
+        res.cpu_nsec += st->m_cpu_nsec;
+        res.items += st->m_items;
+        if (st->m_error) {
+            res.error = st->m_error;
+        }
+        delete st;
+    }
+    return res;
+}
+
+// Grow the iteration count the way Google Benchmark does until the run is long enough.
+static run_result run_calibrated(benchmark *bench, int64_t arg, int threads)
+{
+    const uint64_t max_iterations = 1000000000ULL;
+    uint64_t iterations = 1;
+
+    while (true) {
+        run_result res = run_once(bench, arg, threads, iterations);
+        double seconds = res.real_nsec / 1e9;
+        if (res.error || seconds >= g_min_time || iterations >= max_iterations) {
+            return res;
+        }
+        double multiplier = g_min_time * 1.4 / std::max(seconds, 1e-9);
+        if (seconds / g_min_time <= 0.1) {
+            multiplier = std::min(multiplier, 10.0);
+        }
+        uint64_t next = (uint64_t)(iterations * std::max(multiplier, 1.0));
+        iterations = std::min(std::max(next, iterations + 1), max_iterations);
+    }
+}
+
+static std::string run_name(benchmark *bench, int64_t arg, bool has_arg, int threads,
+                            bool has_threads)
+{
+    std::string name = bench->m_name;
+    if (has_arg) {
+        name += "/" + std::to_string(arg);
+    }
+    if (has_threads) {
+        name += "/threads:" + std::to_string(threads);
+    }
+    return name;
+}
+
+static std::string human_rate(double value)
+{
+    static const char *units[] = {"", "k", "M", "G", "T"};
+    int u = 0;
+    while (value >= 1000.0 && u < 4) {
+        value /= 1000.0;
+        u++;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.4g%s/s", value, units[u]);
+    return buf;
+}
+
+static std::string human_time(double nsec)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), nsec < 1000.0 ? "%.3g ns" : "%.0f ns", nsec);
+    return buf;
+}
+
+static void print_console_header(size_t width)
+{
+    printf("%-*s %15s %15s %12s %s\n", (int)width, "Benchmark", "Time", "CPU", "Iterations",
+           "UserCounters...");
+    printf("%s\n", std::string(width + 60, '-').c_str());
+}
+
+static void print_console(const run_result &res, size_t width)
+{
+    if (res.error) {
+        printf("%-*s ERROR OCCURRED: '%s'\n", (int)width, res.name.c_str(), res.error);
+        return;
+    }
+    printf("%-*s %15s %15s %12lu", (int)width, res.name.c_str(),
+           human_time(res.real_nsec / res.iterations).c_str(),
+           human_time(res.cpu_nsec / res.iterations / res.threads).c_str(),
+           (unsigned long)res.iterations);
+    if (res.items) {
+        printf(" items_per_second=%s", human_rate(res.items / (res.real_nsec / 1e9)).c_str());
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static void write_json(FILE *out, const std::vector<run_result> &results, const char *exe)
+{
+    char host[256] = "";
+    char date[64] = "";
+    time_t now = time(nullptr);
+    struct tm tm_now;
+
+    gethostname(host, sizeof(host) - 1);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime_r(&now, &tm_now));
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"host_name\": \"%s\",\n", host);
+    fprintf(out, "    \"executable\": \"%s\",\n", exe);
+    fprintf(out, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(out, "    \"library_build_type\": \"release\"\n");
+    fprintf(out, "  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const run_result &res = results[i];
+        fprintf(out, "%s\n    {\n", i ? "," : "");
+        fprintf(out, "      \"name\": \"%s\",\n", res.name.c_str());
+        fprintf(out, "      \"run_name\": \"%s\",\n", res.name.c_str());
+        fprintf(out, "      \"run_type\": \"iteration\",\n");
+        fprintf(out, "      \"repetitions\": 1,\n");
+        fprintf(out, "      \"repetition_index\": 0,\n");
+        fprintf(out, "      \"threads\": %d,\n", res.threads);
+        if (res.error) {
+            fprintf(out, "      \"error_occurred\": true,\n");
+            fprintf(out, "      \"error_message\": \"%s\"\n    }", res.error);
+            continue;
+        }
+        fprintf(out, "      \"iterations\": %lu,\n", (unsigned long)res.iterations);
+        fprintf(out, "      \"real_time\": %.6e,\n", res.real_nsec / res.iterations);
+        fprintf(out, "      \"cpu_time\": %.6e,\n", res.cpu_nsec / res.iterations / res.threads);
+        if (res.items) {
+            fprintf(out, "      \"items_per_second\": %.6e,\n", res.items / (res.real_nsec / 1e9));
+        }
+        fprintf(out, "      \"time_unit\": \"ns\"\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void usage(const char *exe)
+{
+    fprintf(stderr,
+            "Usage: %s [--benchmark_filter=regex] [--benchmark_min_time=sec]\n"
+            "          [--benchmark_format=console|json] [--benchmark_out=file]\n"
+            "          [--benchmark_list_tests]\n",
+            exe);
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter = ".";
+    std::string format = "console";
+    const char *out_path = nullptr;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (!strncmp(a, "--benchmark_filter=", 19)) {
+            filter = a + 19;
+        } else if (!strncmp(a, "--benchmark_min_time=", 21)) {
+            g_min_time = atof(a + 21);
+        } else if (!strncmp(a, "--benchmark_format=", 19)) {
+            format = a + 19;
+        } else if (!strncmp(a, "--benchmark_out=", 16)) {
+            out_path = a + 16;
+        } else if (!strcmp(a, "--benchmark_list_tests")) {
+            list_only = true;
+        } else {
+            usage(argv[0]);
+            return (strcmp(a, "--help") && strcmp(a, "-h")) ? 1 : 0;
+        }
+    }
+    if ((format != "console" && format != "json") || g_min_time <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // The stubbed library configuration, the xlio heap is sized by its memory limit
+    stub_mce_sys_reset();
+    xlio_heap::initialize();
+
+    std::regex re;
+    try {
+        re = std::regex(filter);
+    } catch (const std::regex_error &e) {
+        fprintf(stderr, "Invalid --benchmark_filter '%s': %s\n", filter.c_str(), e.what());
+        return 1;
+    }
+
+    struct planned_run {
+        benchmark *bench;
+        int64_t arg;
+        int threads;
+        std::string name;
+    };
+    std::vector<planned_run> plan;
+    size_t width = 10;
+    for (benchmark *bench : benchmarks()) {
+        std::vector<int64_t> args = bench->m_args;
+        std::vector<int> threads = bench->m_threads;
+        if (args.empty()) {
+            args.push_back(0);
+        }
+        if (threads.empty()) {
+            threads.push_back(1);
+        }
+        for (int64_t arg : args) {
+            for (int t : threads) {
+                std::string name = run_name(bench, arg, !bench->m_args.empty(), t,
+                                            !bench->m_threads.empty());
+                if (std::regex_search(name, re)) {
+                    plan.push_back({bench, arg, t, name});
+                    width = std::max(width, name.size());
+                }
+            }
+        }
+    }
+
+    if (list_only) {
+        for (const planned_run &p : plan) {
+            printf("%s\n", p.name.c_str());
+        }
+        return 0;
+    }
+    if (plan.empty()) {
+        fprintf(stderr, "No benchmark matches '%s'\n", filter.c_str());
+        return 1;
+    }
+
+    bool console = (format == "console");
+    std::vector<run_result> results;
+    if (console) {
+        print_console_header(width);
+    }
+    for (const planned_run &p : plan) {
+        run_result res = run_calibrated(p.bench, p.arg, p.threads);
+        res.name = p.name;
+        if (console) {
+            print_console(res, width);
+        }
+        results.push_back(res);
+    }
+    if (!console) {
+        write_json(stdout, results, argv[0]);
+    }
+    if (out_path) {
+        FILE *out = fopen(out_path, "w");
+        if (!out) {
+            fprintf(stderr, "Failed to open %s: %s\n", out_path, strerror(errno));
+            return 1;
+        }
+        write_json(out, results, argv[0]);
+        fclose(out);
+    }
+
+    for (const run_result &res : results) {
+        if (res.error) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef TESTS_MICROBENCH_H
+#define TESTS_MICROBENCH_H
+
+/*
+ * Minimal harness with the Google Benchmark conventions: a benchmark is a
+ * function taking a state whose keep_running() loop is timed, iterations are
+ * calibrated until the run lasts --benchmark_min_time, and results can be
+ * written in the Google Benchmark JSON schema so that its compare.py works on
+ * the output. Kept in tree to avoid an external dependency of the tests.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace microbench {
+
+static inline uint64_t now_nsec(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Keep a value or all of memory alive for the compiler.
+template <typename T> inline void do_not_optimize(T const &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory()
+{
+    asm volatile("" : : : "memory");
+}
+
+class barrier {
+public:
+    barrier(int count)
+        : m_count(count)
+        , m_waiting(0)
+        , m_generation(0)
+    {
+    }
+
+    void wait();
+
+private:
+    const int m_count;
+    std::atomic<int> m_waiting;
+    std::atomic<int> m_generation;
+};
+
+class state {
+public:
+    state(uint64_t iterations, int64_t arg, int thread_index, int threads, barrier &start);
+
+    // Timed loop condition, every thread of a run must enter it. The threads start together.
+    inline bool keep_running()
+    {
+        if (__builtin_expect(m_remaining != 0, 1)) {
+            m_remaining--;
+            return true;
+        }
+        return finish();
+    }
+
+    // Exclude setup done inside the loop from the measurement.
+    void pause_timing();
+    void resume_timing();
+
+    int64_t range() const { return m_arg; }
+    int thread_index() const { return m_thread_index; }
+    int threads() const { return m_threads; }
+    uint64_t iterations() const { return m_iterations; }
+
+    void set_items_processed(uint64_t items) { m_items = items; }
+    void skip_with_error(const char *msg) { m_error = msg; }
+
+    uint64_t m_real_nsec = 0;
+    uint64_t m_cpu_nsec = 0;
+    uint64_t m_items = 0;
+    const char *m_error = nullptr;
+
+private:
+    bool finish();
+
+    uint64_t m_remaining;
+    const uint64_t m_iterations;
+    const int64_t m_arg;
+    const int m_thread_index;
+    const int m_threads;
+    bool m_started = false;
+    uint64_t m_real_start = 0;
+    uint64_t m_cpu_start = 0;
+    barrier &m_start;
+};
+
+typedef void (*bench_fn)(state &);
+
+class benchmark {
+public:
+    benchmark(const char *name, bench_fn fn);
+
+    benchmark *arg(int64_t value);
+    benchmark *range(int64_t lo, int64_t hi, int mult = 8);
+    benchmark *threads(int count);
+    // 1, 2, 4 ... up to the number of online CPUs.
+    benchmark *thread_range(int max_threads = 0);
+
+    std::string m_name;
+    bench_fn m_fn;
+    std::vector<int64_t> m_args;
+    std::vector<int> m_threads;
+};
+
+benchmark *register_benchmark(benchmark *bench);
+
+} // namespace microbench
+
+#define MICROBENCH_CONCAT2(a, b) a##b
+#define MICROBENCH_CONCAT(a, b)  MICROBENCH_CONCAT2(a, b)
+
+// MICROBENCH(fn)->arg(64)->threads(4);
+#define MICROBENCH(fn)                                                                             \
+    static microbench::benchmark *MICROBENCH_CONCAT(s_microbench_, __LINE__)                       \
+        __attribute__((unused)) =                                                                  \
+            microbench::register_benchmark(new microbench::benchmark(#fn, fn))
+
+#endif /* TESTS_MICROBENCH_H */
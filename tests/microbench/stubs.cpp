@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/*
+ * Stand-ins for the parts of libxlio behind fd_collection.cpp, on top of the
+ * shared tests/core_stubs. The benchmarks fill the collection with existing
+ * objects, so the socket and epoll objects are never created or closed here.
+ */
+
+#include <stdlib.h>
+
+#include "sock/fd_collection.h"
+#include "sock/sock-redirect.h"
+#include "util/libxlio.h"
+
+bool g_is_forked_child = false;
+
+static global_stats_t s_global_stat;
+global_stats_t *g_p_global_stat = &s_global_stat;
+
+transport_t __xlio_match_by_program(in_protocol_t my_protocol, const char *app_id)
+{
+    NOT_IN_USE(my_protocol);
+    NOT_IN_USE(app_id);
+    return TRANS_XLIO;
+}
+
+bool handle_close(int fd, bool cleanup, bool passthrough)
+{
+    NOT_IN_USE(fd);
+    NOT_IN_USE(cleanup);
+    NOT_IN_USE(passthrough);
+    return false;
+}
+
+void epfd_info::fd_closed(int fd, bool passthrough)
+{
+    NOT_IN_USE(fd);
+    NOT_IN_USE(passthrough);
+}
+
+void epfd_info::statistics_print(vlog_levels_t log_level)
+{
+    NOT_IN_USE(log_level);
+}
+
+void epfd_info::set_os_data_available()
+{
+}
+
+/* The constructors are only reachable from fd_collection::addsocket() and
+ * addepfd(). Defining them would need the whole socket layer, so their
+ * symbols resolve to a function which aborts.
+ */
+extern "C" void microbench_no_constructor()
+{
+    abort();
+}
+
+#define MICROBENCH_NO_CONSTRUCTOR(sym)                                                             \
+    extern "C" void microbench_##sym() __asm__(#sym)                                               \
+        __attribute__((alias("microbench_no_constructor")))
+
+// sockinfo_tcp::sockinfo_tcp(int, int), sockinfo_udp::sockinfo_udp(int, int)
+MICROBENCH_NO_CONSTRUCTOR(_ZN12sockinfo_tcpC1Eii);
+MICROBENCH_NO_CONSTRUCTOR(_ZN12sockinfo_udpC1Eii);
+// epfd_info::epfd_info(int, int)
+MICROBENCH_NO_CONSTRUCTOR(_ZN9epfd_infoC1Eii);
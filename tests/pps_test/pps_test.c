@@ -37,30 +37,40 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <string.h>
 #include <unistd.h>
 
 #define BUFSIZE 258
+#define GRO_BUFSIZE 65535
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
 
 
 /**
  * This is a  simple test, designed to measure UDP multicast send/receive rate.
  * Can be used in sender mode or receiver mode.
+ * In receiver mode "gro" enables UDP_GRO, so a single recvmsg() can return
+ * several datagrams. The rate is counted in datagrams in both cases.
  *  
  */
 int main(int argc, char** argv)
 {
 	int sock, status;
 	socklen_t socklen;
-	char buffer[BUFSIZE];
+	char buffer[GRO_BUFSIZE];
+	int gro = 0;
+	int calls = 0;
 	struct sockaddr_in saddr;
 	int count, realcount, i;
 	struct timeval tv_before, tv_after;
 	double sec;
 
 	if (argc < 3) {
-		fprintf(stderr, "Usage: pps_test <ip> <packet_count> [ srv ]\n");
+		fprintf(stderr, "Usage: pps_test <ip> <packet_count> [ srv [ gro ] ]\n");
 		exit(1);
 	}
 
@@ -126,17 +136,57 @@ int main(int argc, char** argv)
 		status = setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, 
 		                    (const void *)&imreq, sizeof(struct ip_mreq));
 
+		if (argc > 4 && !strcmp(argv[4], "gro")) {
+			gro = 1;
+			status = setsockopt(sock, IPPROTO_UDP, UDP_GRO, &gro, sizeof(gro));
+			if (status < 0)
+				perror("Error enabling UDP_GRO"), exit(0);
+		}
+
 		// first packet
 		status = recvfrom(sock, buffer, BUFSIZE, 0,
 		                (struct sockaddr *) &saddr, &socklen);
 
 		// receive packet from socket
 		gettimeofday(&tv_before, NULL);
-		for (i = 0; i < count; ++i) {
-			status = recvfrom(sock, buffer, BUFSIZE, 0,
-			                (struct sockaddr *) &saddr, &socklen);
-			if (status > 0)
-				++realcount;
+		if (!gro) {
+			for (i = 0; i < count; ++i) {
+				status = recvfrom(sock, buffer, BUFSIZE, 0,
+				                (struct sockaddr *) &saddr, &socklen);
+				if (status > 0)
+					++realcount;
+			}
+			calls = count;
+		}
+		else {
+			char control[CMSG_SPACE(sizeof(int))];
+			struct iovec iov;
+			struct msghdr msg;
+			struct cmsghdr *cmsg;
+			int gro_size;
+
+			while (realcount < count && calls < count) {
+				iov.iov_base = buffer;
+				iov.iov_len = sizeof(buffer);
+				memset(&msg, 0, sizeof(msg));
+				msg.msg_iov = &iov;
+				msg.msg_iovlen = 1;
+				msg.msg_control = control;
+				msg.msg_controllen = sizeof(control);
+
+				status = recvmsg(sock, &msg, 0);
+				++calls;
+				if (status <= 0)
+					continue;
+
+				// every datagram of the chain has gro_size bytes except the last one
+				gro_size = 0;
+				for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+					if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+						memcpy(&gro_size, CMSG_DATA(cmsg), sizeof(gro_size));
+				}
+				realcount += gro_size ? (status + gro_size - 1) / gro_size : 1;
+			}
 		}
 		gettimeofday(&tv_after, NULL);
 	}
@@ -145,6 +195,8 @@ int main(int argc, char** argv)
 	(tv_after.tv_usec - tv_before.tv_usec) / 1000000.0;
 
 	printf("%d packets in %.3f seconds. PPS=%.2f\n", realcount, sec, realcount / sec);
+	if (gro)
+		printf("%d recvmsg calls, %.2f packets per call\n", calls, (double)realcount / calls);
 
 	// close socket
 	close(sock);
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * TCP sendfile() throughput over a large file set.
+ *
+ * The client serves requests over a single connection: every request picks a
+ * file with Zipf distributed popularity and sends a range of it, which starts
+ * at a random multiple of the request size, with sendfile() calls of up to
+ * the chunk size. A zero request size sends whole files. The file set is
+ * created in the directory when the files are missing. The server discards
+ * received data.
+ *
+ * Compare the sendfile() mapping cache configurations, e.g.:
+ *
+ *   server: sendfile_test -s [-p port]
+ *   client: LD_PRELOAD=libxlio.so XLIO_ZC_CACHE_THRESHOLD=2GB XLIO_ZC_CACHE_WINDOW=4MB \
+ *           sendfile_test -c <ip> [-p port] [-d dir] [-n files] [-f file MB] [-r request KB]
+ *           [-k chunk KB] [-z zipf exponent] [-t sec]
+ *
+ * Cache hits, misses and evictions are printed by libxlio on exit with
+ * XLIO_TRACELEVEL=debug.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define DEFAULT_PORT      17173
+#define DEFAULT_DIR       "/tmp"
+#define DEFAULT_FILES     32
+#define DEFAULT_FILE_MB   64
+#define DEFAULT_REQ_KB    1024
+#define DEFAULT_CHUNK_KB  256
+#define DEFAULT_ZIPF      0.8
+#define DEFAULT_TIME      10
+#define MAX_FILES         4096
+#define RECV_BUF_SIZE     (1024 * 1024)
+#define CREATE_BUF_SIZE   (1024 * 1024)
+#define MAX_LATENCIES     (1 << 20)
+
+static double now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static int server(int port)
+{
+	static char buf[RECV_BUF_SIZE];
+	struct sockaddr_in addr;
+	int one = 1;
+	int lfd;
+
+	lfd = socket(AF_INET, SOCK_STREAM, 0);
+	if (lfd < 0) {
+		perror("socket");
+		return 1;
+	}
+	setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return 1;
+	}
+	if (listen(lfd, 16) < 0) {
+		perror("listen");
+		return 1;
+	}
+
+	while (1) {
+		long bytes = 0;
+		double start;
+		int fd;
+
+		fd = accept(lfd, NULL, NULL);
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("accept");
+			return 1;
+		}
+
+		start = now_sec();
+		while (1) {
+			ssize_t ret = recv(fd, buf, sizeof(buf), 0);
+
+			if (ret < 0 && errno == EINTR) {
+				continue;
+			}
+			if (ret <= 0) {
+				break;
+			}
+			bytes += ret;
+		}
+		printf("received: %.3f GB %.3f Gbit/s\n", bytes / 1e9,
+		       bytes * 8 / (now_sec() - start) / 1e9);
+		fflush(stdout);
+		close(fd);
+	}
+
+	return 0;
+}
+
+static int open_file(const char *dir, int idx, off_t size)
+{
+	static char buf[CREATE_BUF_SIZE];
+	char path[4096];
+	struct stat st;
+	off_t off;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/sendfile_test.%d", dir, idx);
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		perror(path);
+		return -1;
+	}
+	if (fstat(fd, &st) == 0 && st.st_size == size) {
+		return fd;
+	}
+
+	/* Real data rather than holes, so page cache and readahead are exercised. */
+	for (off = 0; off < size; off += sizeof(buf)) {
+		size_t len = (size - off) < (off_t)sizeof(buf) ? (size_t)(size - off) : sizeof(buf);
+
+		memset(buf, 'a' + (int)((off / sizeof(buf) + idx) % 26), len);
+		if (pwrite(fd, buf, len, off) != (ssize_t)len) {
+			perror("pwrite");
+			close(fd);
+			return -1;
+		}
+	}
+	if (ftruncate(fd, size) < 0) {
+		perror("ftruncate");
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/* Cumulative Zipf distribution, cdf[i] is the probability of files 0..i. */
+static double *zipf_cdf(int n, double s)
+{
+	double *cdf = malloc(n * sizeof(double));
+	double sum = 0;
+	int i;
+
+	if (!cdf) {
+		return NULL;
+	}
+	for (i = 0; i < n; i++) {
+		sum += 1.0 / pow(i + 1, s);
+		cdf[i] = sum;
+	}
+	for (i = 0; i < n; i++) {
+		cdf[i] /= sum;
+	}
+	return cdf;
+}
+
+static int zipf_pick(const double *cdf, int n)
+{
+	double u = drand48();
+	int lo = 0;
+	int hi = n - 1;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (cdf[mid] < u) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static int client(const char *ip, int port, const char *dir, int nfiles, off_t file_size,
+		  off_t req_size, size_t chunk, double zipf, int sec)
+{
+	struct sockaddr_in addr;
+	static int files[MAX_FILES];
+	double *latencies;
+	double *cdf;
+	long reqs = 0;
+	long calls = 0;
+	long bytes = 0;
+	double start, elapsed;
+	int fd;
+	int i;
+
+	cdf = zipf_cdf(nfiles, zipf);
+	latencies = malloc(MAX_LATENCIES * sizeof(double));
+	if (!cdf || !latencies) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	printf("preparing %d files of %lld MB in %s\n", nfiles, (long long)(file_size >> 20), dir);
+	fflush(stdout);
+	for (i = 0; i < nfiles; i++) {
+		files[i] = open_file(dir, i, file_size);
+		if (files[i] < 0) {
+			return 1;
+		}
+	}
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+		fprintf(stderr, "Invalid address %s\n", ip);
+		return 1;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		return 1;
+	}
+
+	srand48(1);
+	start = now_sec();
+	do {
+		int file = files[zipf_pick(cdf, nfiles)];
+		off_t offset = 0;
+		off_t left = file_size;
+		double req_start = now_sec();
+
+		if (req_size > 0 && req_size < file_size) {
+			offset = (off_t)(drand48() * (file_size / req_size)) * req_size;
+			left = (file_size - offset) < req_size ? file_size - offset : req_size;
+		}
+		while (left > 0) {
+			ssize_t ret = sendfile(fd, file, &offset, left < (off_t)chunk ? (size_t)left : chunk);
+
+			if (ret < 0) {
+				if (errno == EINTR || errno == EAGAIN) {
+					continue;
+				}
+				perror("sendfile");
+				return 1;
+			}
+			calls++;
+			bytes += ret;
+			left -= ret;
+		}
+		if (reqs < MAX_LATENCIES) {
+			latencies[reqs] = now_sec() - req_start;
+		}
+		reqs++;
+	} while (now_sec() - start < sec);
+	elapsed = now_sec() - start;
+
+	qsort(latencies, reqs < MAX_LATENCIES ? reqs : MAX_LATENCIES, sizeof(double), cmp_double);
+	printf("files: %d x %lld MB request: %lld KB chunk: %zu KB zipf: %.2f\n", nfiles,
+	       (long long)(file_size >> 20), (long long)(req_size >> 10), chunk >> 10, zipf);
+	printf("sent: %.0f requests/s %.0f calls/s %.3f Gbit/s\n", reqs / elapsed, calls / elapsed,
+	       bytes * 8 / elapsed / 1e9);
+	printf("request latency: p50 %.1f usec p99 %.1f usec\n",
+	       latencies[(reqs < MAX_LATENCIES ? reqs : MAX_LATENCIES) / 2] * 1e6,
+	       latencies[(reqs < MAX_LATENCIES ? reqs : MAX_LATENCIES) * 99 / 100] * 1e6);
+
+	close(fd);
+	for (i = 0; i < nfiles; i++) {
+		close(files[i]);
+	}
+	free(latencies);
+	free(cdf);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: sendfile_test -s [-p port]\n"
+			"       sendfile_test -c <ip> [-p port] [-d dir] [-n files] [-f file_mb] "
+			"[-r request_kb] [-k chunk_kb] [-z zipf] [-t sec]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *ip = NULL;
+	const char *dir = DEFAULT_DIR;
+	int port = DEFAULT_PORT;
+	int nfiles = DEFAULT_FILES;
+	long file_mb = DEFAULT_FILE_MB;
+	long req_kb = DEFAULT_REQ_KB;
+	long chunk_kb = DEFAULT_CHUNK_KB;
+	double zipf = DEFAULT_ZIPF;
+	int sec = DEFAULT_TIME;
+	int is_server = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "sc:p:d:n:f:r:k:z:t:h")) != -1) {
+		switch (opt) {
+		case 's':
+			is_server = 1;
+			break;
+		case 'c':
+			ip = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'd':
+			dir = optarg;
+			break;
+		case 'n':
+			nfiles = atoi(optarg);
+			break;
+		case 'f':
+			file_mb = atol(optarg);
+			break;
+		case 'r':
+			req_kb = atol(optarg);
+			break;
+		case 'k':
+			chunk_kb = atol(optarg);
+			break;
+		case 'z':
+			zipf = atof(optarg);
+			break;
+		case 't':
+			sec = atoi(optarg);
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (is_server) {
+		return server(port);
+	}
+	if (!ip || nfiles <= 0 || nfiles > MAX_FILES || file_mb <= 0 || req_kb < 0 ||
+	    chunk_kb <= 0 || zipf < 0 || sec <= 0) {
+		usage();
+		return 1;
+	}
+	return client(ip, port, dir, nfiles, (off_t)file_mb << 20, (off_t)req_kb << 10,
+		      (size_t)chunk_kb << 10, zipf, sec);
+}
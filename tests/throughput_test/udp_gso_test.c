@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2001-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * UDP send throughput with and without UDP_SEGMENT (UDP GSO).
+ *
+ * The client sends datagrams of the given size for the given time. With
+ * -g, every sendmsg() carries -b datagrams in a single buffer and the
+ * UDP_SEGMENT control message splits it. Offloaded by XLIO, such a call
+ * posts its datagrams with a single doorbell. The server counts received
+ * datagrams and bytes.
+ *
+ *   server: udp_gso_test -s [-p port]
+ *   client: LD_PRELOAD=libxlio.so udp_gso_test -c <ip> [-p port] [-m size] [-g] [-b segs]
+ *           [-t sec]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#define DEFAULT_PORT     17172
+#define DEFAULT_MSG_SIZE 1400
+#define DEFAULT_SEGS     32
+#define DEFAULT_TIME     5
+#define MAX_SEGS         64
+#define MAX_BUF_SIZE     65507
+
+static double now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int server(int port)
+{
+	static char buf[MAX_BUF_SIZE];
+	struct sockaddr_in addr;
+	long dgrams = 0;
+	long bytes = 0;
+	double start = 0;
+	double last;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return 1;
+	}
+
+	last = now_sec();
+	while (1) {
+		ssize_t ret = recv(fd, buf, sizeof(buf), 0);
+		double now;
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("recv");
+			return 1;
+		}
+		if (!dgrams) {
+			start = last = now_sec();
+		}
+		dgrams++;
+		bytes += ret;
+
+		now = now_sec();
+		if (now - last >= 1.0) {
+			printf("received: %.0f datagrams/s %.3f Gbit/s\n", dgrams / (now - start),
+			       bytes * 8 / (now - start) / 1e9);
+			fflush(stdout);
+			last = now;
+		}
+	}
+
+	return 0;
+}
+
+static int client(const char *ip, int port, int msg_size, int gso, int segs, int sec)
+{
+	static char buf[MAX_BUF_SIZE];
+	char control[CMSG_SPACE(sizeof(uint16_t))];
+	struct sockaddr_in addr;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	struct iovec iov;
+	long calls = 0;
+	long dgrams = 0;
+	long bytes = 0;
+	double start, elapsed;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+		fprintf(stderr, "Invalid address %s\n", ip);
+		return 1;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		return 1;
+	}
+
+	memset(buf, 'u', sizeof(buf));
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = buf;
+	iov.iov_len = gso ? msg_size * segs : msg_size;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	if (gso) {
+		memset(control, 0, sizeof(control));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_UDP;
+		cmsg->cmsg_type = UDP_SEGMENT;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+		*(uint16_t *)CMSG_DATA(cmsg) = msg_size;
+	}
+
+	start = now_sec();
+	do {
+		ssize_t ret = sendmsg(fd, &msg, 0);
+
+		if (ret < 0) {
+			if (errno == EAGAIN || errno == ENOBUFS || errno == ECONNREFUSED) {
+				continue;
+			}
+			perror("sendmsg");
+			return 1;
+		}
+		calls++;
+		bytes += ret;
+		dgrams += gso ? (ret + msg_size - 1) / msg_size : 1;
+	} while ((calls & 0xff) || now_sec() - start < sec);
+	elapsed = now_sec() - start;
+
+	printf("mode: %s msg size: %d segs per call: %d\n", gso ? "gso" : "plain", msg_size,
+	       gso ? segs : 1);
+	printf("sent: %.0f calls/s %.0f datagrams/s %.3f Gbit/s\n", calls / elapsed, dgrams / elapsed,
+	       bytes * 8 / elapsed / 1e9);
+	close(fd);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: udp_gso_test -s [-p port]\n"
+			"       udp_gso_test -c <ip> [-p port] [-m msg_size] [-g] [-b segs] "
+			"[-t sec]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *ip = NULL;
+	int port = DEFAULT_PORT;
+	int msg_size = DEFAULT_MSG_SIZE;
+	int segs = DEFAULT_SEGS;
+	int sec = DEFAULT_TIME;
+	int is_server = 0;
+	int gso = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "sc:p:m:gb:t:h")) != -1) {
+		switch (opt) {
+		case 's':
+			is_server = 1;
+			break;
+		case 'c':
+			ip = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'm':
+			msg_size = atoi(optarg);
+			break;
+		case 'g':
+			gso = 1;
+			break;
+		case 'b':
+			segs = atoi(optarg);
+			break;
+		case 't':
+			sec = atoi(optarg);
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (is_server) {
+		return server(port);
+	}
+	if (!ip || msg_size <= 0 || sec <= 0 || segs <= 0 || segs > MAX_SEGS ||
+	    msg_size * (gso ? segs : 1) > MAX_BUF_SIZE) {
+		usage();
+		return 1;
+	}
+	return client(ip, port, msg_size, gso, segs, sec);
+}